@@ -2,6 +2,7 @@
 // SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
 
 #include "operator_factory.hpp"
+#include <algorithm>                       // for min
 #include <stdexcept>                       // for runtime_error
 #include <fmt/format.h>                        // for format
 #include <scn/scan.h>
@@ -36,6 +37,8 @@ auto ParseReinserter(std::string const& str, ComparisonCallback&& comp) -> std::
     std::unique_ptr<ReinserterBase> reinserter;
     if (str == "keep-best") {
         reinserter = std::make_unique<KeepBestReinserter>(std::move(comp));
+    } else if (str == "select-best") {
+        reinserter = std::make_unique<SelectBestReinserter>(std::move(comp));
     } else if (str == "replace-worst") {
         reinserter = std::make_unique<ReplaceWorstReinserter>(std::move(comp));
     } else {
@@ -44,7 +47,7 @@ auto ParseReinserter(std::string const& str, ComparisonCallback&& comp) -> std::
     return reinserter;
 }
 
-auto ParseSelector(std::string const& str, ComparisonCallback&& comp) -> std::unique_ptr<Operon::SelectorBase>
+auto ParseSelector(std::string const& str, ComparisonCallback&& comp, uint64_t seed) -> std::unique_ptr<Operon::SelectorBase>
 {
     auto tok = Split(str, ':');
     auto name = tok[0];
@@ -59,6 +62,16 @@ auto ParseSelector(std::string const& str, ComparisonCallback&& comp) -> std::un
             tournamentSize = result->value();
         }
         dynamic_cast<Operon::TournamentSelector*>(selector.get())->SetTournamentSize(tournamentSize);
+    } else if (name == "batch") {
+        selector = std::make_unique<Operon::BatchTournamentSelector>(std::move(comp));
+        size_t tournamentSize{defaultTournamentSize};
+        if (tok.size() > 1) {
+            auto result = scn::scan<std::size_t>(tok[1], "{}");
+            ENSURE(result);
+            tournamentSize = result->value();
+        }
+        dynamic_cast<Operon::BatchTournamentSelector*>(selector.get())->SetTournamentSize(tournamentSize);
+        dynamic_cast<Operon::BatchTournamentSelector*>(selector.get())->SetSeed(seed);
     } else if (name == "proportional") {
         selector = std::make_unique<Operon::ProportionalSelector>(std::move(comp));
         dynamic_cast<Operon::ProportionalSelector*>(selector.get())->SetObjIndex(0);
@@ -71,6 +84,16 @@ auto ParseSelector(std::string const& str, ComparisonCallback&& comp) -> std::un
             tournamentSize = result->value();
         }
         dynamic_cast<Operon::RankTournamentSelector*>(selector.get())->SetTournamentSize(tournamentSize);
+    } else if (name == "lexicase") {
+        // the errors of the cases are captured by the evaluator (see --case-rows)
+        auto lexicase = std::make_unique<Operon::LexicaseSelector>();
+        if (tok.size() > 1) {
+            auto result = scn::scan<std::size_t>(tok[1], "{}");
+            ENSURE(result);
+            lexicase->SetCaseCount(result->value());
+        }
+        lexicase->SetSeed(seed);
+        selector = std::move(lexicase);
     } else if (name == "random") {
         selector = std::make_unique<Operon::RandomSelector>();
     } else {
@@ -135,6 +158,16 @@ auto ParseEvaluator(std::string const& str, Problem& problem, DefaultDispatch& d
     return evaluator;
 }
 
+auto CaptureCaseErrors(EvaluatorBase& evaluator, SelectorBase const& female, SelectorBase const& male, std::size_t caseRows, Operon::RandomGenerator& random) -> void
+{
+    auto lexicase = [](SelectorBase const& selector) { return dynamic_cast<LexicaseSelector const*>(&selector) != nullptr; };
+    if (!lexicase(female) && !lexicase(male)) { return; }
+    auto* e = dynamic_cast<Operon::Evaluator<DefaultDispatch>*>(&evaluator);
+    if (e == nullptr) { throw std::runtime_error("the objective does not capture the case errors of the lexicase selector"); }
+    auto const rows = evaluator.GetProblem().TrainingRange().Size();
+    e->SetCaseSample(LexicaseSelector::SampleCases(random, rows, caseRows > 0 ? std::min(caseRows, rows) : rows));
+}
+
 auto ParseGenerator(std::string const& str, EvaluatorBase& eval, CrossoverBase& cx, MutatorBase& mut, SelectorBase& femSel, SelectorBase& maleSel, CoefficientOptimizer const* coeffOptimizer = nullptr) -> std::unique_ptr<OffspringGeneratorBase>
 {
     std::unique_ptr<OffspringGeneratorBase> generator;
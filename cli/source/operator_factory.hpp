@@ -5,6 +5,7 @@
 #define OPERON_CLI_OPERATOR_FACTORY_HPP
 
 #include <cstddef>                            // for size_t
+#include <cstdint>                            // for uint64_t
 #include <memory>                              // for unique_ptr, make_unique
 #include <string>                              // for operator==, string
 #include <utility>                             // for addressof
@@ -34,7 +35,12 @@ namespace Operon {
 
 auto ParseReinserter(std::string const& str, ComparisonCallback&& comp) -> std::unique_ptr<ReinserterBase>;
 
-auto ParseSelector(std::string const& str, ComparisonCallback&& comp) -> std::unique_ptr<SelectorBase>;
+// the selectors that draw their own random numbers (batch, lexicase) are seeded with seed
+auto ParseSelector(std::string const& str, ComparisonCallback&& comp, uint64_t seed) -> std::unique_ptr<SelectorBase>;
+
+// captures the case errors on caseRows training rows (all of them if zero) drawn with random, if one of the selectors
+// is a LexicaseSelector (see Evaluator::SetCaseSample), throws if the evaluator cannot capture them
+auto CaptureCaseErrors(EvaluatorBase& evaluator, SelectorBase const& female, SelectorBase const& male, std::size_t caseRows, Operon::RandomGenerator& random) -> void;
 
 auto ParseCreator(std::string const& str, PrimitiveSet const& pset, std::vector<Operon::Hash> const& inputs) -> std::unique_ptr<CreatorBase>;
 
@@ -0,0 +1,361 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <memory>
+#include <numbers>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <cxxopts.hpp>
+#include <fmt/core.h>
+#include <taskflow/taskflow.hpp>
+
+#include "operon/algorithms/gp.hpp"
+#include "operon/algorithms/nsga2.hpp"
+#include "operon/algorithms/task_trace.hpp"
+#include "operon/core/dataset.hpp"
+#include "operon/core/problem.hpp"
+#include "operon/interpreter/interpreter.hpp"
+#include "operon/operators/creator.hpp"
+#include "operon/operators/crossover.hpp"
+#include "operon/operators/evaluator.hpp"
+#include "operon/operators/generator.hpp"
+#include "operon/operators/initializer.hpp"
+#include "operon/operators/local_search.hpp"
+#include "operon/operators/mutation.hpp"
+#include "operon/operators/non_dominated_sorter.hpp"
+#include "operon/operators/reinserter.hpp"
+#include "operon/operators/selector.hpp"
+#include "operon/optimizer/optimizer.hpp"
+
+#include "util.hpp"
+
+namespace {
+// one point of the grid
+struct Configuration {
+    std::string Algorithm;
+    std::size_t Threads;
+    std::size_t PopulationSize;
+    std::size_t Rows;
+    std::size_t MaxLength;
+};
+
+struct Measurement {
+    Configuration Config;
+    std::size_t Generations;
+    std::size_t Evaluations;
+    double Elapsed; // seconds
+    double Efficiency{0};
+
+    // per-worker load of each generation (only recorded with --worker-load)
+    std::vector<std::vector<Operon::WorkerLoad>> Loads;
+    double Imbalance{1}; // mean over the generations
+    double IdleShare{0}; // share of the worker time spent idle
+
+    [[nodiscard]] auto GenerationsPerSecond() const { return static_cast<double>(Generations) / Elapsed; }
+    [[nodiscard]] auto EvaluationsPerSecond() const { return static_cast<double>(Evaluations) / Elapsed; }
+};
+
+// the Friedman-I problem, y = 10 sin(pi x1 x2) + 20 (x3 - 0.5)^2 + 10 x4 + 5 x5 + noise, with five more inputs
+// that do not contribute to the target
+auto Friedman(std::size_t rows, Operon::RandomGenerator& random) -> Operon::Dataset
+{
+    constexpr auto inputs{10};
+    Operon::Dataset::Matrix values(static_cast<Eigen::Index>(rows), inputs + 1);
+    std::uniform_real_distribution<Operon::Scalar> uniform(0, 1);
+    std::normal_distribution<Operon::Scalar> noise(0, 1);
+    for (auto i = 0L; i < values.rows(); ++i) {
+        for (auto j = 0; j < inputs; ++j) { values(i, j) = uniform(random); }
+        auto const x = values.row(i);
+        values(i, inputs) = 10 * std::sin(std::numbers::pi_v<Operon::Scalar> * x(0) * x(1)) + 20 * (x(2) - 0.5F) * (x(2) - 0.5F) + 10 * x(3) + 5 * x(4) + noise(random); // NOLINT
+    }
+    return Operon::Dataset(std::move(values));
+}
+
+auto ParseList(std::string const& str) -> std::vector<std::size_t>
+{
+    std::vector<std::size_t> values;
+    for (auto const& tok : Operon::Split(str, ',')) {
+        values.push_back(std::stoul(tok));
+    }
+    if (values.empty()) { throw std::invalid_argument(fmt::format("empty list of values: '{}'", str)); }
+    return values;
+}
+
+// runs the algorithm to completion and counts the generations and the evaluations
+auto Run(Configuration const& c, Operon::GeneticAlgorithmConfig config, std::size_t iterations, std::uint64_t seed, bool workerLoad) -> Measurement
+{
+    Operon::RandomGenerator random(seed);
+    auto const rows = c.Rows;
+    Operon::Problem problem(Friedman(rows, random), Operon::Range{0, rows / 2}, Operon::Range{rows / 2, rows});
+    auto const& ds = problem.GetDataset();
+    auto const target = ds.GetVariable(fmt::format("X{}", ds.Cols())).value().Hash;
+    auto inputs = ds.VariableHashes();
+    std::erase(inputs, target);
+    problem.SetTarget(target);
+    problem.SetInputs(inputs);
+    problem.ConfigurePrimitiveSet(Operon::PrimitiveSet::Arithmetic);
+
+    config.PopulationSize = c.PopulationSize;
+    config.PoolSize = c.PopulationSize;
+    config.Iterations = iterations;
+    config.Seed = seed;
+
+    auto const maxDepth{1000UL};
+    Operon::BalancedTreeCreator creator{problem.GetPrimitiveSet(), problem.GetInputs()};
+    auto [amin, amax] = problem.GetPrimitiveSet().FunctionArityLimits();
+    Operon::UniformTreeInitializer treeInitializer(creator);
+    treeInitializer.ParameterizeDistribution(amin + 1, c.MaxLength);
+    treeInitializer.SetMaxDepth(maxDepth);
+    Operon::NormalCoefficientInitializer coeffInitializer;
+    coeffInitializer.ParameterizeDistribution(Operon::Scalar{0}, Operon::Scalar{1});
+
+    Operon::SubtreeCrossover crossover{0.9, maxDepth, c.MaxLength}; // NOLINT
+    Operon::MultiMutation mutator{};
+    Operon::OnePointMutation<std::normal_distribution<Operon::Scalar>> onePoint;
+    onePoint.ParameterizeDistribution(Operon::Scalar{0}, Operon::Scalar{1});
+    Operon::ChangeVariableMutation changeVar{problem.GetInputs()};
+    Operon::ChangeFunctionMutation changeFunc{problem.GetPrimitiveSet()};
+    Operon::ReplaceSubtreeMutation replaceSubtree{creator, coeffInitializer, maxDepth, c.MaxLength};
+    Operon::InsertSubtreeMutation insertSubtree{creator, coeffInitializer, maxDepth, c.MaxLength};
+    Operon::RemoveSubtreeMutation removeSubtree{problem.GetPrimitiveSet()};
+    mutator.Add(onePoint, 1.0);
+    mutator.Add(changeVar, 1.0);
+    mutator.Add(changeFunc, 1.0);
+    mutator.Add(replaceSubtree, 1.0);
+    mutator.Add(insertSubtree, 1.0);
+    mutator.Add(removeSubtree, 1.0);
+
+    Operon::DefaultDispatch dtable;
+    Operon::Evaluator errorEvaluator(problem, dtable, Operon::R2{}, /*linearScaling=*/true);
+    errorEvaluator.SetBudget(config.Evaluations);
+    Operon::LevenbergMarquardtOptimizer<Operon::DefaultDispatch, Operon::OptimizerType::Eigen> optimizer{dtable, problem};
+    optimizer.SetIterations(iterations);
+    Operon::CoefficientOptimizer coeffOptimizer{optimizer, config.LamarckianProbability};
+
+    // the evaluations are counted by the error evaluator (also inside the multi-objective evaluator of NSGA2)
+    tf::Executor executor(c.Threads);
+    auto measure = [&](auto& algorithm) {
+        std::optional<Operon::TaskTrace> trace;
+        if (workerLoad) {
+            trace.emplace(executor);
+            algorithm.SetTaskTrace(&*trace);
+        }
+        auto t0 = std::chrono::steady_clock::now();
+        algorithm.Run(executor, random);
+        auto t1 = std::chrono::steady_clock::now();
+        Measurement m{c, algorithm.Generation(), errorEvaluator.CallCount.load(), std::chrono::duration<double>(t1 - t0).count()};
+        if (trace) {
+            m.Loads = trace->Loads();
+            auto imbalance{0.0};
+            auto idle{0.0};
+            auto total{0.0};
+            for (auto const& loads : m.Loads) {
+                imbalance += Operon::TaskTrace::Imbalance(loads);
+                for (auto const& l : loads) {
+                    idle += l.Idle;
+                    total += l.Busy + l.Idle;
+                }
+            }
+            m.Imbalance = m.Loads.empty() ? 1 : imbalance / static_cast<double>(m.Loads.size());
+            m.IdleShare = total > 0 ? idle / total : 0;
+        }
+        return m;
+    };
+
+    if (c.Algorithm == "gp") {
+        Operon::SingleObjectiveComparison comp{0};
+        Operon::TournamentSelector selector{comp};
+        Operon::KeepBestReinserter reinserter{comp};
+        Operon::BasicOffspringGenerator generator{errorEvaluator, crossover, mutator, selector, selector, &coeffOptimizer};
+        Operon::GeneticProgrammingAlgorithm gp{problem, config, treeInitializer, coeffInitializer, generator, reinserter};
+        return measure(gp);
+    }
+
+    Operon::LengthEvaluator lengthEvaluator(problem, c.MaxLength);
+    Operon::MultiEvaluator evaluator(problem);
+    evaluator.SetBudget(config.Evaluations);
+    evaluator.Add(errorEvaluator);
+    evaluator.Add(lengthEvaluator);
+    Operon::CrowdedComparison comp;
+    Operon::TournamentSelector selector{comp};
+    Operon::KeepBestReinserter reinserter{comp};
+    Operon::BasicOffspringGenerator generator{evaluator, crossover, mutator, selector, selector, &coeffOptimizer};
+    Operon::RankIntersectSorter sorter;
+    Operon::NSGA2 nsga2{problem, config, treeInitializer, coeffInitializer, generator, reinserter, sorter};
+    return measure(nsga2);
+}
+
+// the speedup over the smallest thread count of the same configuration, divided by the ratio of the thread counts
+auto Efficiency(std::vector<Measurement>& measurements) -> void
+{
+    using Key = std::tuple<std::string, std::size_t, std::size_t, std::size_t>;
+    std::map<Key, Measurement const*> base;
+    for (auto const& m : measurements) {
+        auto const& c = m.Config;
+        auto& b = base[{c.Algorithm, c.PopulationSize, c.Rows, c.MaxLength}];
+        if (b == nullptr || c.Threads < b->Config.Threads) { b = &m; }
+    }
+    for (auto& m : measurements) {
+        auto const& c = m.Config;
+        auto const* b = base[{c.Algorithm, c.PopulationSize, c.Rows, c.MaxLength}];
+        auto const speedup = m.EvaluationsPerSecond() / b->EvaluationsPerSecond();
+        m.Efficiency = speedup * static_cast<double>(b->Config.Threads) / static_cast<double>(c.Threads);
+    }
+}
+
+// the load columns are only written if the worker load was recorded
+auto Write(std::FILE* out, std::vector<Measurement> const& measurements, bool json, bool workerLoad) -> void
+{
+    if (json) {
+        fmt::print(out, "[\n");
+        for (auto i = 0UL; i < measurements.size(); ++i) {
+            auto const& m = measurements[i];
+            auto const& c = m.Config;
+            fmt::print(out, R"(  {{"algorithm": "{}", "threads": {}, "population_size": {}, "rows": {}, "max_length": {}, "generations": {}, "evaluations": {}, "elapsed": {:.6f}, "generations_per_second": {:.6g}, "evaluations_per_second": {:.6g}, "efficiency": {:.4f})",
+                c.Algorithm, c.Threads, c.PopulationSize, c.Rows, c.MaxLength, m.Generations, m.Evaluations, m.Elapsed, m.GenerationsPerSecond(), m.EvaluationsPerSecond(), m.Efficiency);
+            if (workerLoad) { fmt::print(out, R"(, "imbalance": {:.4f}, "idle_share": {:.4f})", m.Imbalance, m.IdleShare); }
+            fmt::print(out, "}}{}\n", i + 1 < measurements.size() ? "," : "");
+        }
+        fmt::print(out, "]\n");
+        return;
+    }
+    fmt::print(out, "algorithm,threads,population_size,rows,max_length,generations,evaluations,elapsed,generations_per_second,evaluations_per_second,efficiency{}\n", workerLoad ? ",imbalance,idle_share" : "");
+    for (auto const& m : measurements) {
+        auto const& c = m.Config;
+        fmt::print(out, "{},{},{},{},{},{},{},{:.6f},{:.6g},{:.6g},{:.4f}", c.Algorithm, c.Threads, c.PopulationSize, c.Rows, c.MaxLength, m.Generations, m.Evaluations, m.Elapsed, m.GenerationsPerSecond(), m.EvaluationsPerSecond(), m.Efficiency);
+        if (workerLoad) { fmt::print(out, ",{:.4f},{:.4f}", m.Imbalance, m.IdleShare); }
+        fmt::print(out, "\n");
+    }
+}
+
+// one line per configuration, generation and worker
+auto WriteWorkerLoad(std::FILE* out, std::vector<Measurement> const& measurements) -> void
+{
+    fmt::print(out, "algorithm,threads,population_size,rows,max_length,generation,worker,busy,idle,tasks,offspring\n");
+    for (auto const& m : measurements) {
+        auto const& c = m.Config;
+        for (auto g = 0UL; g < m.Loads.size(); ++g) {
+            for (auto w = 0UL; w < m.Loads[g].size(); ++w) {
+                auto const& l = m.Loads[g][w];
+                fmt::print(out, "{},{},{},{},{},{},{},{:.6f},{:.6f},{},{}\n", c.Algorithm, c.Threads, c.PopulationSize, c.Rows, c.MaxLength, g, w, l.Busy, l.Idle, l.Tasks, l.Offspring);
+            }
+        }
+    }
+}
+
+auto Open(std::string const& path) -> std::unique_ptr<std::FILE, decltype(&std::fclose)>
+{
+    std::unique_ptr<std::FILE, decltype(&std::fclose)> file(std::fopen(path.c_str(), "w"), &std::fclose);
+    if (file == nullptr) { throw std::runtime_error(fmt::format("cannot open {} for writing", path)); }
+    return file;
+}
+} // namespace
+
+auto main(int argc, char** argv) -> int
+{
+    cxxopts::Options opts("operon_bench", "Throughput of full GP and NSGA2 runs on a synthetic dataset over a grid of settings");
+
+    opts.add_options()
+        ("algorithm", "Algorithms to run (gp, nsga2 or both)", cxxopts::value<std::string>()->default_value("both"))
+        ("threads", "Comma-separated list of thread counts", cxxopts::value<std::string>()->default_value("1,2,4,8"))
+        ("population-size", "Comma-separated list of population sizes (the pool has the same size)", cxxopts::value<std::string>()->default_value("1000"))
+        ("rows", "Comma-separated list of row counts (half of the rows are used for training)", cxxopts::value<std::string>()->default_value("1000"))
+        ("maxlength", "Comma-separated list of maximum tree lengths", cxxopts::value<std::string>()->default_value("50"))
+        ("generations", "Number of generations of each run", cxxopts::value<size_t>()->default_value("20"))
+        ("iterations", "Local search iterations", cxxopts::value<size_t>()->default_value("0"))
+        ("repeats", "Number of runs of each configuration (the fastest one is reported)", cxxopts::value<size_t>()->default_value("1"))
+        ("seed", "Random seed", cxxopts::value<size_t>()->default_value("1234"))
+        ("format", "Output format (json or csv)", cxxopts::value<std::string>()->default_value("csv"))
+        ("output", "Output file (standard output if not given)", cxxopts::value<std::string>())
+        ("cost-scheduling", "Evaluate the most expensive groups of individuals first and hand out the offspring slots one at a time (compare the imbalance with --worker-load)", cxxopts::value<bool>()->default_value("true"))
+        ("worker-load", "Record the busy and idle time and the offspring of every worker in each generation and write them to the given csv file", cxxopts::value<std::string>())
+        ("help", "Print help");
+
+    cxxopts::ParseResult result;
+    try {
+        result = opts.parse(argc, argv);
+    } catch (cxxopts::exceptions::parsing const& ex) {
+        fmt::print(stderr, "error: {}. rerun with --help to see available options.\n", ex.what());
+        return EXIT_FAILURE;
+    };
+
+    if (result.count("help") > 0) {
+        fmt::print("{}\n", opts.help());
+        return EXIT_SUCCESS;
+    }
+
+    try {
+        auto const format = result["format"].as<std::string>();
+        if (format != "json" && format != "csv") {
+            throw std::invalid_argument(fmt::format("unknown output format '{}'", format));
+        }
+        auto const algorithm = result["algorithm"].as<std::string>();
+        std::vector<std::string> algorithms;
+        if (algorithm == "both") {
+            algorithms = { "gp", "nsga2" };
+        } else if (algorithm == "gp" || algorithm == "nsga2") {
+            algorithms = { algorithm };
+        } else {
+            throw std::invalid_argument(fmt::format("unknown algorithm '{}'", algorithm));
+        }
+
+        Operon::GeneticAlgorithmConfig config{};
+        config.Generations = result["generations"].as<size_t>();
+        config.Evaluations = ~std::size_t{0};
+        config.CrossoverProbability = 1.0;
+        config.MutationProbability = 0.25; // NOLINT
+        config.CostScheduling = result["cost-scheduling"].as<bool>();
+
+        auto const repeats = std::max(result["repeats"].as<size_t>(), size_t{1});
+        auto const seed = result["seed"].as<size_t>();
+        auto const workerLoad = result.count("worker-load") > 0;
+        std::vector<Measurement> measurements;
+        for (auto const& a : algorithms) {
+            for (auto p : ParseList(result["population-size"].as<std::string>())) {
+                for (auto r : ParseList(result["rows"].as<std::string>())) {
+                    for (auto l : ParseList(result["maxlength"].as<std::string>())) {
+                        for (auto t : ParseList(result["threads"].as<std::string>())) {
+                            Configuration const c{a, t, p, r, l};
+                            // every repeat runs the same search, the fastest one is the least disturbed by the system
+                            std::optional<Measurement> best;
+                            for (auto i = 0UL; i < repeats; ++i) {
+                                auto m = Run(c, config, result["iterations"].as<size_t>(), seed, workerLoad);
+                                if (!best || m.Elapsed < best->Elapsed) { best = m; }
+                            }
+                            fmt::print(stderr, "{} threads={} population={} rows={} maxlength={}: {:.3f}s\n", a, t, p, r, l, best->Elapsed);
+                            measurements.push_back(*best);
+                        }
+                    }
+                }
+            }
+        }
+        Efficiency(measurements);
+
+        if (result.count("output") > 0) {
+            Write(Open(result["output"].as<std::string>()).get(), measurements, format == "json", workerLoad);
+        } else {
+            Write(stdout, measurements, format == "json", workerLoad);
+        }
+        if (workerLoad) {
+            WriteWorkerLoad(Open(result["worker-load"].as<std::string>()).get(), measurements);
+        }
+    } catch (std::exception const& ex) {
+        fmt::print(stderr, "error: {}\n", ex.what());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
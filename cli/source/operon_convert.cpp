@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+#include "operon/core/dataset.hpp"
+#include "util.hpp"
+
+#include <cxxopts.hpp>
+#include <fmt/core.h>
+
+auto main(int argc, char** argv) -> int
+{
+    cxxopts::Options opts("operon_convert", "Convert a csv dataset into the binary format that can be memory-mapped");
+
+    opts.add_options()
+        ("input", "Input file name (csv with header) (required)", cxxopts::value<std::string>())
+        ("output", "Output file name (required)", cxxopts::value<std::string>())
+        ("help", "Print help");
+
+    cxxopts::ParseResult result;
+    try {
+        result = opts.parse(argc, argv);
+    } catch (cxxopts::exceptions::parsing const& ex) {
+        fmt::print(stderr, "error: {}. rerun with --help to see available options.\n", ex.what());
+        return EXIT_FAILURE;
+    };
+
+    if (result.arguments().empty() || result.count("help") > 0) {
+        fmt::print("{}\n", opts.help());
+        return EXIT_SUCCESS;
+    }
+
+    if (result.count("input") == 0 || result.count("output") == 0) {
+        fmt::print(stderr, "error: both the input and the output file must be specified.\n");
+        return EXIT_FAILURE;
+    }
+
+    try {
+        auto const ds = Operon::Dataset::LoadCsv(result["input"].as<std::string>(), { .HasHeader = true, .Columns = {}, .Threads = 0 });
+        ds.WriteBinary(result["output"].as<std::string>());
+        fmt::print("{} rows, {} columns\n", ds.Rows(), ds.Cols());
+    } catch (std::exception const& ex) {
+        fmt::print(stderr, "error: {}\n", ex.what());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
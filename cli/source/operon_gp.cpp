@@ -1,22 +1,37 @@
 // SPDX-License-Identifier: MIT
 // SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cmath>
 #include <cstdlib>
+#include <exception>
 
 #include <fmt/core.h>
 
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
 #include <thread>
+#include <utility>
+#include <vector>
 #include <taskflow/taskflow.hpp>
-#if TF_MINOR_VERSION > 2
-#include <taskflow/algorithm/reduce.hpp>
-#endif
 #include "operon/algorithms/gp.hpp"
+#include "operon/algorithms/task_trace.hpp"
+#include "operon/algorithms/validation.hpp"
+#include "operon/algorithms/worker_limit.hpp"
+#include "operon/core/affinity.hpp"
+#include "operon/core/coreset.hpp"
+#include "operon/core/memory.hpp"
 #include "operon/core/version.hpp"
 #include "operon/core/problem.hpp"
 #include "operon/formatter/formatter.hpp"
+#include "operon/interpreter/approximate_dispatch.hpp"
+#include "operon/interpreter/batch_tuning.hpp"
+#include "operon/interpreter/cpu_dispatch.hpp"
 #include "operon/interpreter/interpreter.hpp"
 #include "operon/operators/creator.hpp"
 #include "operon/operators/crossover.hpp"
@@ -25,9 +40,12 @@
 #include "operon/operators/initializer.hpp"
 #include "operon/operators/mutation.hpp"
 #include "operon/operators/reinserter.hpp"
+#include "operon/operators/throughput.hpp"
 #include "operon/operators/selector.hpp"
 #include "operon/optimizer/optimizer.hpp"
 
+#include "reporter.hpp"
+#include "run_log.hpp"
 #include "util.hpp"
 #include "operator_factory.hpp"
 
@@ -46,6 +64,11 @@ auto main(int argc, char** argv) -> int
     config.CrossoverProbability = result["crossover-probability"].as<Operon::Scalar>();
     config.MutationProbability = result["mutation-probability"].as<Operon::Scalar>();
     config.TimeLimit = result["timelimit"].as<size_t>();
+    config.BatchedLocalSearch = result["batched-local-search"].as<bool>();
+    config.PooledGeneration = result["pooled-generation"].as<bool>();
+    config.Deterministic = result["deterministic"].as<bool>();
+    config.HugePages = result["huge-pages"].as<bool>();
+    Operon::ParseTerminationCriteria(result, config);
     config.Seed = std::random_device {}();
 
     // parse remaining configuration
@@ -69,8 +92,15 @@ auto main(int argc, char** argv) -> int
             const auto& value = kv.value();
 
             if (key == "dataset") {
-                dataset = std::make_unique<Operon::Dataset>(value, true);
-                ENSURE(!dataset->IsView());
+                // shuffling and standardization modify the data, so they need a dataset that owns its values
+                auto const owned = result["shuffle"].as<bool>() || result["standardize"].as<bool>();
+                // when the inputs are given, only the inputs and the target are loaded
+                std::vector<std::string> columns;
+                if (result.count("inputs") > 0) {
+                    columns = Operon::Split(result["inputs"].as<std::string>(), ',');
+                    columns.push_back(result["target"].as<std::string>());
+                }
+                dataset = std::make_unique<Operon::Dataset>(Operon::ReadDataset(value, owned, columns));
             }
             if (key == "seed") {
                 config.Seed = kv.as<size_t>();
@@ -161,23 +191,41 @@ auto main(int argc, char** argv) -> int
                 }
             }
         }
-        Operon::Problem problem(*dataset, trainingRange, testRange);
+        Operon::Range validationRange{ 0, 0 };
+        if (result.count("validation") > 0) {
+            validationRange = Operon::ParseRange(result["validation"].as<std::string>());
+            if (validationRange.End() > rows) {
+                fmt::print(stderr, "error: the validation range {}:{} exceeds the available data range ({} rows)\n", validationRange.Start(), validationRange.End(), rows);
+                return EXIT_FAILURE;
+            }
+        }
+
+        // the lagged variables read the rows before the evaluated range
+        auto const maxLag = result["max-lag"].as<size_t>();
+        if (maxLag > std::numeric_limits<uint8_t>::max()) {
+            fmt::print(stderr, "error: the maximum lag {} exceeds {}\n", maxLag, std::numeric_limits<uint8_t>::max());
+            return EXIT_FAILURE;
+        }
+        if (maxLag > 0 && (trainingRange.Start() < maxLag || testRange.Start() < maxLag || (validationRange.Size() > 0 && validationRange.Start() < maxLag))) {
+            fmt::print(stderr, "error: the data ranges must start at or after row {} (the maximum lag)\n", maxLag);
+            return EXIT_FAILURE;
+        }
+
+        Operon::Problem problem(std::move(*dataset), trainingRange, testRange, validationRange);
         problem.SetTarget(target.Hash);
         problem.SetInputs(inputs);
         problem.ConfigurePrimitiveSet(primitiveSetConfig);
 
         std::unique_ptr<Operon::CreatorBase> creator;
         creator = ParseCreator(result["creator"].as<std::string>(), problem.GetPrimitiveSet(), problem.GetInputs());
+        creator->SetMaxLag(static_cast<uint8_t>(maxLag));
 
         auto [amin, amax] = problem.GetPrimitiveSet().FunctionArityLimits();
-        Operon::UniformTreeInitializer treeInitializer(*creator);
-
         auto const initialMinDepth = result["creator-mindepth"].as<std::size_t>();
         auto const initialMaxDepth = result["creator-mindepth"].as<std::size_t>();
-        treeInitializer.ParameterizeDistribution(amin+1, maxLength);
-        treeInitializer.SetMinDepth(initialMinDepth);
-        treeInitializer.SetMaxDepth(initialMaxDepth); // NOLINT
-                                           //
+        // the duplicates of the initial population are created again (see UniqueTreeInitializer)
+        auto const uniqueInit = result["unique-init"].as<bool>();
+
         std::unique_ptr<Operon::CoefficientInitializerBase> coeffInitializer;
         std::unique_ptr<Operon::MutatorBase> onePoint;
         if (symbolic) {
@@ -215,176 +263,462 @@ auto main(int argc, char** argv) -> int
         mutator.Add(removeSubtree, 1.0);
         mutator.Add(discretePoint, 1.0);
 
-        Operon::DefaultDispatch dtable;
+        // the search may use approximate primitives, the reported models are always evaluated with the exact table
+        auto dtable = Operon::MakeDispatchTable(Operon::ParseDispatchTarget(result["dispatch"].as<std::string>()));
+        auto searchTable = dtable;
+        auto const approximate = result.count("approximate") > 0;
+        auto const approximateTypes = result.count("approximate-symbols") > 0 ? Operon::ParsePrimitiveSetConfig(result["approximate-symbols"].as<std::string>()) : ~Operon::NodeType{};
+        if (approximate) {
+            Operon::ApproximatePrimitives(searchTable, result["approximate"].as<int>(), approximateTypes);
+        }
         auto scale = result["linear-scaling"].as<bool>();
-        auto evaluator = Operon::ParseEvaluator(result["objective"].as<std::string>(), problem, dtable, scale);
-        evaluator->SetBudget(config.Evaluations);
-
-        auto optimizer = std::make_unique<Operon::LevenbergMarquardtOptimizer<decltype(dtable), Operon::OptimizerType::Eigen>>(dtable, problem);
-        optimizer->SetIterations(config.Iterations);
-
-        Operon::CoefficientOptimizer cOpt{*optimizer, config.LamarckianProbability};
+        auto const objective = result["objective"].as<std::string>();
 
         EXPECT(problem.TrainingRange().Size() > 0);
 
-        auto comp = [](auto const& lhs, auto const& rhs) { return lhs[0] < rhs[0]; };
-
-        auto femaleSelector = Operon::ParseSelector(result["female-selector"].as<std::string>(), comp);
-        auto maleSelector = Operon::ParseSelector(result["male-selector"].as<std::string>(), comp);
+        // the runs of a batch share the dataset, the options that follow a single run are not supported
+        auto const runs = std::max(result["runs"].as<size_t>(), size_t{1});
+        if (runs > 1) {
+            for (auto const* option : { "checkpoint", "resume", "trace", "metrics", "profile" }) {
+                if (result.count(option) > 0) {
+                    fmt::print(stderr, "error: --{} cannot be used with --runs\n", option);
+                    return EXIT_FAILURE;
+                }
+            }
+        }
 
-        auto generator = Operon::ParseGenerator(result["offspring-generator"].as<std::string>(), *evaluator, crossover, mutator, *femaleSelector, *maleSelector, &cOpt);
-        auto reinserter = Operon::ParseReinserter(result["reinserter"].as<std::string>(), comp);
+        Operon::SingleObjectiveComparison comp{0};
 
+        // the workers are pinned to their cores when they start (see AffinityPolicy)
+        auto const affinity = Operon::ParseAffinityPolicy(result["affinity"].as<std::string>());
+        auto const pool = Operon::MakeExecutor(threads, affinity);
+        auto& executor = *pool;
         Operon::RandomGenerator random(config.Seed);
         if (result["shuffle"].as<bool>()) {
-            problem.GetDataset().Shuffle(random);
+            problem.GetDataset().Shuffle(random, executor);
         }
         if (result["standardize"].as<bool>()) {
-            problem.StandardizeData(problem.TrainingRange());
+            problem.StandardizeData(problem.TrainingRange(), /*inPlace=*/!result["lazy-standardize"].as<bool>(), executor);
         }
 
-        tf::Executor executor(threads);
+        // the search works on a weighted coreset of the training rows (after shuffling and scaling), the final population
+        // is ranked again and the models are assessed on the whole problem
+        // - the evaluator, the local search and the surrogate are weighted by the coreset
+        std::optional<Operon::Problem> coresetProblem;
+        std::optional<Operon::Hash> coresetWeights;
+        if (auto const coresetRows = result["coreset-rows"].as<size_t>(); coresetRows > 0 && coresetRows < trainingRange.Size()) {
+            auto const coreset = Operon::SelectCoreset(problem, coresetRows, Operon::ParseCoresetMethod(result["coreset-method"].as<std::string>()), random);
+            coresetProblem.emplace(Operon::ReduceProblem(problem, coreset));
+            coresetWeights = coresetProblem->GetDataset().GetVariable("coreset_weight")->Hash;
+        }
+        // the codes are built last, shuffling and standardization drop them (see Dataset::Encode)
+        if (auto const cardinality = result["encode-columns"].as<size_t>(); cardinality > 0) {
+            problem.GetDataset().Encode(cardinality);
+            if (coresetProblem) { coresetProblem->GetDataset().Encode(cardinality); }
+        }
+        auto& searchProblem = coresetProblem ? *coresetProblem : problem;
+
+        // the surrogate works on a copy of the search problem restricted to its first training rows
+        std::optional<Operon::Problem> surrogateProblem;
+        auto const searchRange = searchProblem.TrainingRange();
+        if (auto const surrogateRows = std::min(result["surrogate-rows"].as<size_t>(), searchRange.Size()); surrogateRows > 0) {
+            surrogateProblem.emplace(searchProblem);
+            surrogateProblem->SetTrainingRange(Operon::Range{searchRange.Start(), searchRange.Start() + surrogateRows});
+        }
 
-        auto t0 = std::chrono::steady_clock::now();
+        // the evaluators of all the runs share the batch sizes tuned on the search problem (see BatchSizeTuner)
+        std::unique_ptr<Operon::DefaultBatchSizeTuner> batchTuner;
+        if (result["tune-batch-size"].as<bool>()) {
+            batchTuner = std::make_unique<Operon::DefaultBatchSizeTuner>();
+            if (approximate) {
+                batchTuner->ForEachTable([&](auto& table) { Operon::ApproximatePrimitives(table, result["approximate"].as<int>(), approximateTypes); });
+            }
+            Operon::TuneBatchSize(*batchTuner, searchProblem, *creator, *coeffInitializer, amin + 1, maxLength, maxDepth, config.Seed);
+        }
 
-        Operon::GeneticProgrammingAlgorithm gp { problem, config, treeInitializer, *coeffInitializer, *generator, *reinserter };
+        Operon::Profiler profiler;
+
+        // with a memory limit the evaluation group size and the jacobian of the local search (full or blocked normal
+        // equations) are chosen from the size of the search, for the largest trees (see Operon::PlanMemory)
+        constexpr size_t mib{1UL << 20U};
+        std::optional<Operon::MemoryPlan> memoryPlan;
+        if (auto const limit = result["memory-limit"].as<size_t>(); limit > 0) {
+            auto const& ds = searchProblem.GetDataset();
+            auto const individuals = config.PopulationSize + config.PoolSize;
+            Operon::MemoryRequirements const requirements {
+                .Fixed = (ds.IsView() ? 0 : ds.Rows<size_t>() * ds.Cols<size_t>() * sizeof(Operon::Scalar)) + (individuals * (sizeof(Operon::Individual) + (maxLength * sizeof(Operon::Node)))),
+                .Workers = executor.num_workers(),
+                .Rows = searchProblem.TrainingRange().Size(),
+                .Coefficients = maxLength,
+                .GroupSize = Operon::EvaluatorBase::DefaultEvaluationTileSize,
+            };
+            memoryPlan = Operon::PlanMemory(requirements, limit * mib);
+            if (!memoryPlan->Fits) {
+                fmt::print(stderr, "warning: the estimated memory of the run ({} MiB) exceeds the limit of {} MiB\n", memoryPlan->Bytes / mib, limit);
+            }
+        }
 
-        Operon::Individual best{};
+        // the operators that keep the state of a population (counters, caches, the selected population), one set for each run
+        using LocalOptimizer = Operon::LevenbergMarquardtOptimizer<decltype(dtable), Operon::OptimizerType::Eigen>;
+        using BlockedOptimizer = Operon::LevenbergMarquardtOptimizer<decltype(dtable), Operon::OptimizerType::NormalEquations>;
+        using SeparableOptimizer = Operon::LevenbergMarquardtOptimizer<decltype(dtable), Operon::OptimizerType::VariableProjection>;
+        struct Session {
+            std::unique_ptr<Operon::UniformTreeInitializer> TreeInitializer;
+            std::unique_ptr<Operon::UniqueTreeInitializer> UniqueInitializer;
+            std::unique_ptr<Operon::EvaluatorBase> Evaluator;
+            std::unique_ptr<Operon::SolverStateCache> StateCache;
+            std::unique_ptr<Operon::OptimizerBase> Optimizer;
+            std::unique_ptr<Operon::CoefficientOptimizer> LocalSearch;
+            std::unique_ptr<Operon::SelectorBase> FemaleSelector;
+            std::unique_ptr<Operon::SelectorBase> MaleSelector;
+            std::unique_ptr<Operon::OffspringGeneratorBase> Generator;
+            std::unique_ptr<Operon::ReinserterBase> Reinserter;
+            std::unique_ptr<Operon::EvaluatorBase> Surrogate;
+            std::unique_ptr<Operon::GeneticProgrammingAlgorithm> Algorithm;
+            std::unique_ptr<Operon::EvaluatorBase> Validator;
+            std::unique_ptr<Operon::ValidationMonitor> Validation;
+        };
 
-        auto report = [&]() {
-            auto config = gp.GetConfig();
-            auto pop = gp.Parents();
-            auto off = gp.Offspring();
+        // the concurrent runs share the cores left by the other processes (see LoadAverageLimit)
+        Operon::LoadAverageLimit const elasticLimit;
+        auto makeSession = [&](Operon::RandomGenerator::result_type seed) {
+            auto s = std::make_unique<Session>();
+            s->TreeInitializer = std::make_unique<Operon::UniformTreeInitializer>(*creator);
+            s->TreeInitializer->ParameterizeDistribution(amin+1, maxLength);
+            s->TreeInitializer->SetMinDepth(initialMinDepth);
+            s->TreeInitializer->SetMaxDepth(initialMaxDepth); // NOLINT
+            s->UniqueInitializer = std::make_unique<Operon::UniqueTreeInitializer>(*s->TreeInitializer);
+            s->Evaluator = Operon::ParseEvaluator(objective, searchProblem, searchTable, scale);
+            s->Evaluator->SetBudget(config.Evaluations);
+            if (memoryPlan) { s->Evaluator->SetEvaluationGroupSize(memoryPlan->GroupSize); }
+            if (auto* e = dynamic_cast<Operon::Evaluator<decltype(dtable)>*>(s->Evaluator.get()); e != nullptr) {
+                e->SetSemanticHashing(result["semantic-rows"].as<size_t>());
+                e->SetWeights(coresetWeights);
+                e->SetBatchSizeTuner(batchTuner.get());
+            } else if (coresetProblem) {
+                throw std::runtime_error(fmt::format("the {} objective cannot be weighted (see --coreset-rows)", objective));
+            }
 
-            auto const& problem = gp.GetProblem();
-            auto trainingRange  = problem.TrainingRange();
-            auto testRange      = problem.TestRange();
+            s->StateCache = std::make_unique<Operon::SolverStateCache>(result["structure-cache"].as<size_t>());
+            if (memoryPlan && memoryPlan->BlockedJacobian) {
+                auto optimizer = std::make_unique<BlockedOptimizer>(searchTable, searchProblem);
+                optimizer->SetBlockSize(memoryPlan->BlockSize);
+                s->Optimizer = std::move(optimizer);
+            } else if (result["variable-projection"].as<bool>()) {
+                s->Optimizer = std::make_unique<SeparableOptimizer>(searchTable, searchProblem);
+            } else if (s->StateCache->Enabled()) {
+                // the normal equations solver also carries the trust region of a structure over (see SetStateCache)
+                s->Optimizer = std::make_unique<BlockedOptimizer>(searchTable, searchProblem);
+            } else {
+                s->Optimizer = std::make_unique<LocalOptimizer>(searchTable, searchProblem);
+            }
+            s->Optimizer->SetIterations(config.Iterations);
+            s->Optimizer->SetWeights(coresetWeights);
+            s->Optimizer->SetStateCache(s->StateCache.get());
+            s->LocalSearch = std::make_unique<Operon::CoefficientOptimizer>(*s->Optimizer, config.LamarckianProbability);
+            s->LocalSearch->SetAdaptiveIterations(result["adaptive-iterations"].as<size_t>(), Operon::CoefficientOptimizer::DefaultAdaptiveTolerance);
+            s->LocalSearch->SetStructureWarmStart(s->StateCache->Enabled());
+
+            // the selectors that draw their own random numbers get seeds derived from the seed of the run
+            Operon::RandomGenerator seeds{seed};
+            s->FemaleSelector = Operon::ParseSelector(result["female-selector"].as<std::string>(), comp, seeds());
+            s->MaleSelector = Operon::ParseSelector(result["male-selector"].as<std::string>(), comp, seeds());
+            Operon::CaptureCaseErrors(*s->Evaluator, *s->FemaleSelector, *s->MaleSelector, result["case-rows"].as<size_t>(), seeds);
+            s->Generator = Operon::ParseGenerator(result["offspring-generator"].as<std::string>(), *s->Evaluator, crossover, mutator, *s->FemaleSelector, *s->MaleSelector, s->LocalSearch.get());
+            s->Reinserter = Operon::ParseReinserter(result["reinserter"].as<std::string>(), comp);
+            if (result.count("profile") > 0) {
+                s->Generator->SetProfiler(&profiler);
+            }
+            s->Generator->SetSimplify(result["simplify"].as<bool>());
+            s->Generator->SetDuplicateRejection(result["reject-duplicates"].as<bool>(), result["duplicate-retries"].as<size_t>(), config.PoolSize);
+            if (surrogateProblem) {
+                s->Surrogate = Operon::ParseEvaluator(objective, *surrogateProblem, searchTable, scale);
+                if (auto* e = dynamic_cast<Operon::Evaluator<decltype(dtable)>*>(s->Surrogate.get()); e != nullptr) {
+                    e->SetWeights(coresetWeights);
+                    e->SetBatchSizeTuner(batchTuner.get());
+                }
+                s->Generator->SetSurrogate(s->Surrogate.get(), result["surrogate-tolerance"].as<double>());
+            }
 
-            auto targetValues = problem.TargetValues();
-            auto targetTrain  = targetValues.subspan(trainingRange.Start(), trainingRange.Size());
-            auto targetTest   = targetValues.subspan(testRange.Start(), testRange.Size());
+            Operon::TreeInitializerBase const& initializer = uniqueInit ? static_cast<Operon::TreeInitializerBase const&>(*s->UniqueInitializer) : *s->TreeInitializer;
+            s->Algorithm = std::make_unique<Operon::GeneticProgrammingAlgorithm>(searchProblem, config, initializer, *coeffInitializer, *s->Generator, *s->Reinserter);
+            if (result["elastic"].as<bool>()) {
+                s->Algorithm->SetWorkerLimit(elasticLimit);
+            }
 
-            auto const& evaluator = gp.GetGenerator().Evaluator();
+            // the best models of each generation are validated in the background with the exact primitives
+            if (validationRange.Size() > 0) {
+                constexpr auto validatedModels{10UL};
+                s->Validator = Operon::ParseEvaluator(objective, problem, dtable, scale);
+                s->Validation = std::make_unique<Operon::ValidationMonitor>(*s->Validator, validatedModels, result["validation-patience"].as<size_t>(), seed);
+                s->Algorithm->SetValidation(s->Validation.get());
+            }
+            return s;
+        };
 
-            // some boilerplate for reporting results
-            auto const idx{0UL};
-            auto cmp = Operon::SingleObjectiveComparison(idx);
-            best = *std::min_element(pop.begin(), pop.end(), cmp);
+        // the final population is ranked again using the exact primitives and all the training rows
+        auto rerank = [&](Operon::GeneticProgrammingAlgorithm& gp, Operon::RandomGenerator& rng) {
+            auto exactEvaluator = Operon::ParseEvaluator(objective, problem, dtable, scale);
+            for (auto& ind : gp.Parents()) {
+                ind.Fitness = (*exactEvaluator)(rng, ind, {});
+            }
+        };
 
-            Operon::Vector<Operon::Scalar> estimatedTrain;
-            Operon::Vector<Operon::Scalar> estimatedTest;
+        // the model is scaled (the scaling terms are added to the tree) and evaluated on the training and test data
+        auto targetValues = problem.TargetValues();
+        auto targetTrain = targetValues.subspan(trainingRange.Start(), trainingRange.Size());
+        auto targetTest = targetValues.subspan(testRange.Start(), testRange.Size());
 
-            tf::Taskflow taskflow;
+        struct Scores {
+            double R2Train; double R2Test;
+            double MaeTrain; double MaeTest;
+            double NmseTrain; double NmseTest;
+        };
 
+        auto assess = [&](Operon::Tree& model) -> Scores {
             using DT = Operon::DefaultDispatch;
-
-            auto evalTrain = taskflow.emplace([&]() {
-                estimatedTrain = Operon::Interpreter<Operon::Scalar, DT>::Evaluate(best.Genotype, problem.GetDataset(), trainingRange);
-            });
-
-            auto evalTest = taskflow.emplace([&]() {
-                estimatedTest = Operon::Interpreter<Operon::Scalar, DT>::Evaluate(best.Genotype, problem.GetDataset(), testRange);
-            });
+            // both ranges are evaluated by a single interpreter pass
+            std::array const ranges{ trainingRange, testRange };
+            auto estimated = Operon::Interpreter<Operon::Scalar, DT>{dtable, problem.GetDataset(), model}.Evaluate(model.GetCoefficients(), ranges);
+            auto& estimatedTrain = estimated[0];
+            auto& estimatedTest = estimated[1];
 
             // scale values
-            Operon::Scalar a{1.0};
-            Operon::Scalar b{0.0};
-            auto linearScaling = taskflow.emplace([&]() {
-                auto [a_, b_] = Operon::FitLeastSquares(estimatedTrain, targetTrain);
-                a = static_cast<Operon::Scalar>(a_);
-                b = static_cast<Operon::Scalar>(b_);
-                // add scaling terms to the tree
-                auto& nodes = best.Genotype.Nodes();
-                auto const sz = nodes.size();
-                if (std::abs(a - Operon::Scalar{1}) > std::numeric_limits<Operon::Scalar>::epsilon()) {
-                    nodes.emplace_back(Operon::Node::Constant(a));
-                    nodes.emplace_back(Operon::NodeType::Mul);
-                }
-                if (std::abs(b) > std::numeric_limits<Operon::Scalar>::epsilon()) {
-                    nodes.emplace_back(Operon::Node::Constant(b));
-                    nodes.emplace_back(Operon::NodeType::Add);
-                }
-                if (nodes.size() > sz) {
-                    best.Genotype.UpdateNodes();
-                }
-            });
+            auto [a_, b_] = Operon::FitLeastSquares(estimatedTrain, targetTrain);
+            auto const a = static_cast<Operon::Scalar>(a_);
+            auto const b = static_cast<Operon::Scalar>(b_);
+            // add scaling terms to the tree
+            auto& nodes = model.Nodes();
+            auto const sz = nodes.size();
+            if (std::abs(a - Operon::Scalar{1}) > std::numeric_limits<Operon::Scalar>::epsilon()) {
+                nodes.emplace_back(Operon::Node::Constant(a));
+                nodes.emplace_back(Operon::NodeType::Mul);
+            }
+            if (std::abs(b) > std::numeric_limits<Operon::Scalar>::epsilon()) {
+                nodes.emplace_back(Operon::Node::Constant(b));
+                nodes.emplace_back(Operon::NodeType::Add);
+            }
+            if (nodes.size() > sz) {
+                model.UpdateNodes();
+            }
+            for (auto* values : { &estimatedTrain, &estimatedTest }) {
+                Eigen::Map<Eigen::Array<Operon::Scalar, -1, 1>> estimated(values->data(), std::ssize(*values));
+                estimated = estimated * a + b;
+            }
+
+            // negate the R2 because this is an internal fitness measure (minimization) which we here repurpose
+            return {
+                -Operon::R2{}(estimatedTrain, targetTrain), -Operon::R2{}(estimatedTest, targetTest),
+                Operon::MAE{}(estimatedTrain, targetTrain), Operon::MAE{}(estimatedTest, targetTest),
+                Operon::NMSE{}(estimatedTrain, targetTrain), Operon::NMSE{}(estimatedTest, targetTest)
+            };
+        };
 
-            double r2Train{};
-            double r2Test{};
-            double nmseTrain{};
-            double nmseTest{};
-            double maeTrain{};
-            double maeTest{};
+        using T = std::tuple<std::string, double, std::string>;
+        auto const* format = ":>#8.3g"; // see https://fmt.dev/latest/syntax.html
 
-            auto scaleTrain = taskflow.emplace([&]() {
-                Eigen::Map<Eigen::Array<Operon::Scalar, -1, 1>> estimated(estimatedTrain.data(), std::ssize(estimatedTrain));
-                estimated = estimated * a + b;
-            });
+        auto seconds = [](auto t0) {
+            auto t1 = std::chrono::steady_clock::now();
+            return static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count()) / 1e6;
+        };
 
-            auto scaleTest = taskflow.emplace([&]() {
-                Eigen::Map<Eigen::Array<Operon::Scalar, -1, 1>> estimated(estimatedTest.data(), std::ssize(estimatedTest));
-                estimated = estimated * a + b;
-            });
+        // with --run-log, the statistics of the generations are written by the reporter thread
+        std::unique_ptr<Operon::RunLog> runLog;
+        if (result.count("run-log") > 0) {
+            runLog = std::make_unique<Operon::RunLog>(result["run-log"].as<std::string>());
+        }
+        auto const logScores = [](Scores const& s) { return Operon::RunLog::Scores{ s.R2Train, s.R2Test, s.MaeTrain, s.MaeTest, s.NmseTrain, s.NmseTest }; };
+
+        if (runs > 1) {
+            // coarse-grained parallelism: each thread takes the next run
+            // - run i uses its own operators (including the initializers) and a generator seeded with seed + i, without
+            //   --shuffle and --coreset-rows it reproduces a single run with that seed
+            // - the runs are submitted to the shared executor, the threads only wait for their runs (see
+            //   GeneticProgrammingAlgorithm::Run), so the workers interleave the tasks of all the concurrent runs
+            // - the buffers of the tasks are pooled or are not held across a corun (see RunTaskflow), a worker can run the
+            //   tasks of several runs
+            auto const concurrentRuns = result["concurrent-runs"].as<size_t>();
+            auto const concurrent = std::min(runs, concurrentRuns > 0 ? concurrentRuns : std::max(static_cast<size_t>(threads), size_t{1}));
+            std::atomic<size_t> rejected{0}; // the duplicate trees of the unique initializers
+
+            std::vector<Operon::Individual> bests(runs);
+            std::vector<Scores> scores(runs);
+            std::atomic<size_t> next{0};
+            std::mutex mutex; // serializes the output of the finished runs
+            bool printHeader{true};
+
+            // the generations of all the runs are logged by a single reporter thread
+            std::optional<Operon::AsyncReporter> logger;
+            if (runLog) {
+                logger.emplace([&](Operon::ReportSnapshot& snapshot) {
+                    runLog->Append(snapshot, logScores(assess(snapshot.Best.Genotype)));
+                });
+            }
 
-            auto calcStats = taskflow.emplace([&]() {
-                // negate the R2 because this is an internal fitness measure (minimization) which we here repurpose
-                r2Train = -Operon::R2{}(estimatedTrain, targetTrain);
-                r2Test = -Operon::R2{}(estimatedTest, targetTest);
+            std::vector<std::exception_ptr> errors(concurrent);
+            std::vector<std::thread> workers;
+            workers.reserve(concurrent);
+            for (auto w = 0UL; w < concurrent; ++w) {
+                workers.emplace_back([&, w]() {
+                    try {
+                        for (auto i = next++; i < runs; i = next++) {
+                            auto const seed = static_cast<Operon::RandomGenerator::result_type>(config.Seed + i);
+                            Operon::RandomGenerator rng(seed);
+                            auto session = makeSession(seed);
+                            auto& gp = *session->Algorithm;
+
+                            auto t0 = std::chrono::steady_clock::now();
+                            auto report = [&]() {
+                                if (!logger) { return; }
+                                auto snapshot = Operon::MakeSnapshot(gp.Parents(), 0, *session->Evaluator, gp.Generation(), seconds(t0), executor, /*values=*/true);
+                                snapshot.Run = i;
+                                logger->Submit(std::move(snapshot));
+                            };
+                            gp.Run(executor, rng, report);
+                            if (approximate || coresetProblem) { rerank(gp, rng); }
+                            auto snapshot = Operon::MakeSnapshot(gp.Parents(), 0, *session->Evaluator, gp.Generation(), seconds(t0), executor);
+                            auto const s = assess(snapshot.Best.Genotype);
+
+                            auto const& counters = snapshot.Stats;
+                            std::array stats {
+                                T{ "run", i, ":>" },
+                                T{ "seed", seed, ":>" },
+                                T{ "iteration", snapshot.Generation, ":>" },
+                                T{ "r2_tr", s.R2Train, format },
+                                T{ "r2_te", s.R2Test, format },
+                                T{ "mae_tr", s.MaeTrain, format },
+                                T{ "mae_te", s.MaeTest, format },
+                                T{ "nmse_tr", s.NmseTrain, format },
+                                T{ "nmse_te", s.NmseTest, format },
+                                T{ "avg_len", snapshot.Population.Length.Mean, format },
+                                T{ "eval_cnt", counters.Calls, ":>" },
+                                T{ "res_eval", counters.Residual, ":>" },
+                                T{ "elapsed", snapshot.Elapsed, ":>"},
+                            };
+                            rejected += session->UniqueInitializer->Rejected();
+                            std::scoped_lock lock(mutex);
+                            Operon::PrintStats({ stats.begin(), stats.end() }, std::exchange(printHeader, false));
+                            bests[i] = std::move(snapshot.Best);
+                            scores[i] = s;
+                        }
+                    } catch (...) {
+                        errors[w] = std::current_exception();
+                        next = runs; // the other threads do not start new runs
+                    }
+                });
+            }
+            for (auto& w : workers) { w.join(); }
+            if (logger) { logger->Wait(); }
+            for (auto const& e : errors) {
+                if (e) { std::rethrow_exception(e); }
+            }
 
-                nmseTrain = Operon::NMSE{}(estimatedTrain, targetTrain);
-                nmseTest = Operon::NMSE{}(estimatedTest, targetTest);
+            // the distribution of each score over the runs
+            fmt::print("{:>8} {:>10} {:>10} {:>10} {:>10} {:>10}\n", "score", "median", "mean", "stdev", "min", "max");
+            std::array const summaries {
+                std::pair{ "r2_tr", &Scores::R2Train }, std::pair{ "r2_te", &Scores::R2Test },
+                std::pair{ "mae_tr", &Scores::MaeTrain }, std::pair{ "mae_te", &Scores::MaeTest },
+                std::pair{ "nmse_tr", &Scores::NmseTrain }, std::pair{ "nmse_te", &Scores::NmseTest },
+            };
+            for (auto const& [name, score] : summaries) {
+                std::vector<double> values(runs);
+                std::ranges::transform(scores, values.begin(), [&](auto const& s) { return s.*score; });
+                std::ranges::sort(values);
+                auto const median = runs % 2 == 1 ? values[runs / 2] : (values[runs / 2 - 1] + values[runs / 2]) / 2;
+                auto const mean = std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(runs);
+                auto const var = std::accumulate(values.begin(), values.end(), 0.0, [&](auto acc, auto v) { return acc + (v - mean) * (v - mean); }) / static_cast<double>(runs - 1);
+                fmt::print("{:>8} {:>#10.3g} {:>#10.3g} {:>#10.3g} {:>#10.3g} {:>#10.3g}\n", name, median, mean, std::sqrt(var), values.front(), values.back());
+            }
 
-                maeTrain = Operon::MAE{}(estimatedTrain, targetTrain);
-                maeTest = Operon::MAE{}(estimatedTest, targetTest);
-            });
+            // the model of the run with the best training fitness
+            auto const best = static_cast<size_t>(std::distance(bests.begin(), std::ranges::min_element(bests, std::less{}, [](auto const& ind) { return ind[0]; })));
+            fmt::print("best run: {} (seed {})\n", best, config.Seed + best);
+            if (uniqueInit) { fmt::print("initialization: {} duplicate trees created again\n", rejected.load()); }
+            fmt::print("{}\n", Operon::InfixFormatter::Format(bests[best].Genotype, problem.GetDataset(), 6));
+            return EXIT_SUCCESS;
+        }
 
-            double avgLength = 0;
-            double avgQuality = 0;
-            double totalMemory = 0;
+        auto session = makeSession(config.Seed);
+        auto& gp = *session->Algorithm;
+        auto& generator = *session->Generator;
 
-            auto getSize = [](Operon::Individual const& ind) { return sizeof(ind) + sizeof(ind.Genotype) + sizeof(Operon::Node) * ind.Genotype.Nodes().capacity(); };
-            auto calculateLength = taskflow.transform_reduce(pop.begin(), pop.end(), avgLength, std::plus{}, [](auto const& ind) { return ind.Genotype.Length(); });
-            auto calculateQuality = taskflow.transform_reduce(pop.begin(), pop.end(), avgQuality, std::plus{}, [idx=idx](auto const& ind) { return ind[idx]; });
-            auto calculatePopMemory = taskflow.transform_reduce(pop.begin(), pop.end(), totalMemory, std::plus{}, [&](auto const& ind) { return getSize(ind); });
-            auto calculateOffMemory = taskflow.transform_reduce(off.begin(), off.end(), totalMemory, std::plus{}, [&](auto const& ind) { return getSize(ind); });
+        std::unique_ptr<Operon::TaskTrace> trace;
+        if (result.count("trace") > 0) {
+            trace = std::make_unique<Operon::TaskTrace>(executor);
+        }
 
-            // define task graph
-            linearScaling.succeed(evalTrain, evalTest);
-            linearScaling.precede(scaleTrain, scaleTest);
-            calcStats.succeed(scaleTrain, scaleTest);
-            calcStats.precede(calculateLength, calculateQuality, calculatePopMemory, calculateOffMemory);
+        auto t0 = std::chrono::steady_clock::now();
+        auto checkpoints = Operon::SetupCheckpoints(gp, result);
 
-            executor.corun(taskflow);
+        Operon::Individual best{};
+        bool printHeader{true};
 
-            avgLength /= static_cast<double>(pop.size());
-            avgQuality /= static_cast<double>(pop.size());
+        // the monitor is created at the first report, after a resumed run has restored the evaluator counters
+        auto const metricsPath = result.count("metrics") > 0 ? result["metrics"].as<std::string>() : std::string{};
+        std::optional<Operon::ThroughputMonitor> monitor;
 
-            auto t1 = std::chrono::steady_clock::now();
-            auto elapsed = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count()) / 1e6;
+        // the best model is evaluated on the training and test data and printed by the reporter thread, the workers only take a snapshot
+        Operon::AsyncReporter reporter([&](Operon::ReportSnapshot& snapshot) {
+            auto const s = assess(snapshot.Best.Genotype);
+            if (runLog) { runLog->Append(snapshot, logScores(s)); }
 
-            using T = std::tuple<std::string, double, std::string>;
-            auto const* format = ":>#8.3g";
+            auto const& counters = snapshot.Stats;
             std::array stats {
-                T{ "iteration", gp.Generation(), ":>" },
-                T{ "r2_tr", r2Train, format },
-                T{ "r2_te", r2Test, format },
-                T{ "mae_tr", maeTrain, format },
-                T{ "mae_te", maeTest, format },
-                T{ "nmse_tr", nmseTrain, format },
-                T{ "nmse_te", nmseTest, format },
-                T{ "avg_fit", avgQuality, format },
-                T{ "avg_len", avgLength, format },
-                T{ "eval_cnt", evaluator.CallCount , ":>" },
-                T{ "res_eval", evaluator.ResidualEvaluations, ":>" },
-                T{ "jac_eval", evaluator.JacobianEvaluations, ":>" },
-                T{ "opt_time", evaluator.CostFunctionTime,    ":>" },
+                T{ "iteration", snapshot.Generation, ":>" },
+                T{ "r2_tr", s.R2Train, format },
+                T{ "r2_te", s.R2Test, format },
+                T{ "mae_tr", s.MaeTrain, format },
+                T{ "mae_te", s.MaeTest, format },
+                T{ "nmse_tr", s.NmseTrain, format },
+                T{ "nmse_te", s.NmseTest, format },
+                T{ "avg_fit", snapshot.Population.Fitness.Mean, format },
+                T{ "avg_len", snapshot.Population.Length.Mean, format },
+                T{ "eval_cnt", counters.Calls, ":>" },
+                T{ "res_eval", counters.Residual, ":>" },
+                T{ "jac_eval", counters.Jacobian, ":>" },
+                T{ "opt_time", counters.CostTime, ":>" },
                 T{ "seed", config.Seed, ":>" },
-                T{ "elapsed", elapsed, ":>"},
+                T{ "elapsed", snapshot.Elapsed, ":>"},
             };
-            Operon::PrintStats({ stats.begin(), stats.end() }, gp.Generation() == 0);
+            Operon::PrintStats({ stats.begin(), stats.end() }, std::exchange(printHeader, false));
+            if (snapshot.Throughput) { Operon::WriteOpenMetrics(metricsPath, *snapshot.Throughput); }
+            best = std::move(snapshot.Best);
+        });
+
+        auto report = [&]() {
+            auto snapshot = Operon::MakeSnapshot(gp.Parents(), 0, gp.GetGenerator().Evaluator(), gp.Generation(), seconds(t0), executor, /*values=*/runLog != nullptr);
+            if (!metricsPath.empty()) {
+                if (!monitor) { monitor.emplace(gp.GetGenerator().Evaluator()); }
+                snapshot.Throughput = monitor->Sample(gp.Generation());
+            }
+            reporter.Submit(std::move(snapshot));
         };
 
         gp.Run(executor, random, report);
+        if (checkpoints) { checkpoints->Wait(); }
+        if (trace) { trace->WriteChromeTrace(result["trace"].as<std::string>()); }
+
+        // the last report line shows the result of the exact ranking (on the whole training range with a coreset)
+        if (approximate || coresetProblem) {
+            rerank(gp, random);
+            report();
+        }
+        reporter.Wait();
+        if (generator.GetProfiler() != nullptr) { Operon::PrintProfile(profiler.Total()); }
+        if (auto const& validation = session->Validation; validation) {
+            if (auto const v = validation->Best(); v) {
+                fmt::print("validation: best fitness {} (generation {}), {} generations validated\n", v->Fitness, v->Generation, validation->Count());
+            }
+        }
+        if (session->Surrogate) { fmt::print("surrogate: {} children screened, {} discarded\n", generator.ScreenedChildren(), generator.DiscardedChildren()); }
+        if (generator.DuplicateRejection()) { fmt::print("duplicates: {} children rejected\n", generator.RejectedDuplicates()); }
+        if (uniqueInit) { fmt::print("initialization: {} duplicate trees created again\n", session->UniqueInitializer->Rejected()); }
+        if (memoryPlan) {
+            auto const usage = gp.GetMemoryUsage();
+            fmt::print("memory: {} MiB dataset, {} MiB population, {} MiB buffers, {} MiB jacobian ({}, group size {})\n",
+                usage.Dataset / mib, usage.Population / mib, usage.Buffers / mib, usage.Jacobian / mib,
+                memoryPlan->BlockedJacobian ? fmt::format("blocks of {} rows", memoryPlan->BlockSize) : std::string{"full"}, memoryPlan->GroupSize);
+        }
         fmt::print("{}\n", Operon::InfixFormatter::Format(best.Genotype, problem.GetDataset(), 6));
     } catch (std::exception& e) {
         fmt::print(stderr, "error: {}\n", e.what());
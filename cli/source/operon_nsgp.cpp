@@ -9,16 +9,22 @@
 #include <fmt/core.h>
 #include <fmt/ranges.h>
 
+#include <limits>
 #include <memory>
+#include <optional>
 #include <thread>
+#include <utility>
 #include <taskflow/taskflow.hpp>
-#if TF_MINOR_VERSION > 2
-#include <taskflow/algorithm/reduce.hpp>
-#endif
 #include "operon/algorithms/nsga2.hpp"
+#include "operon/algorithms/task_trace.hpp"
+#include "operon/core/affinity.hpp"
 #include "operon/core/version.hpp"
 #include "operon/core/problem.hpp"
 #include "operon/formatter/formatter.hpp"
+#include "operon/interpreter/approximate_dispatch.hpp"
+#include "operon/interpreter/batch_tuning.hpp"
+#include "operon/interpreter/cost_model.hpp"
+#include "operon/interpreter/cpu_dispatch.hpp"
 #include "operon/interpreter/interpreter.hpp"
 #include "operon/operators/creator.hpp"
 #include "operon/operators/crossover.hpp"
@@ -28,11 +34,14 @@
 #include "operon/operators/mutation.hpp"
 #include "operon/operators/non_dominated_sorter.hpp"
 #include "operon/operators/reinserter.hpp"
+#include "operon/operators/throughput.hpp"
 #include "operon/operators/selector.hpp"
 #include "operon/optimizer/optimizer.hpp"
 #include "operon/optimizer/likelihood/gaussian_likelihood.hpp"
 #include "operon/optimizer/solvers/sgd.hpp"
 
+#include "reporter.hpp"
+#include "run_log.hpp"
 #include "util.hpp"
 #include "operator_factory.hpp"
 
@@ -54,6 +63,10 @@ auto main(int argc, char** argv) -> int
     config.LocalSearchProbability = result["local-search-probability"].as<Operon::Scalar>();
     config.LamarckianProbability = result["lamarckian-probability"].as<Operon::Scalar>();
     config.TimeLimit = result["timelimit"].as<size_t>();
+    config.Deterministic = result["deterministic"].as<bool>();
+    config.PipelinedSorting = result["pipelined"].as<bool>();
+    config.HugePages = result["huge-pages"].as<bool>();
+    Operon::ParseTerminationCriteria(result, config);
     config.Seed = std::random_device {}();
 
     // parse remaining config options
@@ -77,8 +90,15 @@ auto main(int argc, char** argv) -> int
             const auto& value = kv.value();
 
             if (key == "dataset") {
-                dataset = std::make_unique<Operon::Dataset>(value, true);
-                ENSURE(!dataset->IsView());
+                // shuffling and standardization modify the data, so they need a dataset that owns its values
+                auto const owned = result["shuffle"].as<bool>() || result["standardize"].as<bool>();
+                // when the inputs are given, only the inputs and the target are loaded
+                std::vector<std::string> columns;
+                if (result.count("inputs") > 0) {
+                    columns = Operon::Split(result["inputs"].as<std::string>(), ',');
+                    columns.push_back(result["target"].as<std::string>());
+                }
+                dataset = std::make_unique<Operon::Dataset>(Operon::ReadDataset(value, owned, columns));
             }
             if (key == "seed") {
                 config.Seed = kv.as<size_t>();
@@ -169,13 +189,25 @@ auto main(int argc, char** argv) -> int
                 }
             }
         }
-        Operon::Problem problem(*dataset, trainingRange, testRange);
+        // the lagged variables read the rows before the evaluated range
+        auto const maxLag = result["max-lag"].as<size_t>();
+        if (maxLag > std::numeric_limits<uint8_t>::max()) {
+            fmt::print(stderr, "error: the maximum lag {} exceeds {}\n", maxLag, std::numeric_limits<uint8_t>::max());
+            return EXIT_FAILURE;
+        }
+        if (maxLag > 0 && (trainingRange.Start() < maxLag || testRange.Start() < maxLag)) {
+            fmt::print(stderr, "error: the data ranges must start at or after row {} (the maximum lag)\n", maxLag);
+            return EXIT_FAILURE;
+        }
+
+        Operon::Problem problem(std::move(*dataset), trainingRange, testRange);
         problem.SetTarget(target.Hash);
         problem.SetInputs(inputs);
         problem.ConfigurePrimitiveSet(primitiveSetConfig);
 
         std::unique_ptr<Operon::CreatorBase> creator;
         creator = ParseCreator(result["creator"].as<std::string>(), problem.GetPrimitiveSet(), problem.GetInputs());
+        creator->SetMaxLag(static_cast<uint8_t>(maxLag));
 
         auto [amin, amax] = problem.GetPrimitiveSet().FunctionArityLimits();
         Operon::UniformTreeInitializer treeInitializer(*creator);
@@ -187,6 +219,11 @@ auto main(int argc, char** argv) -> int
         treeInitializer.SetMinDepth(initialMinDepth);
         treeInitializer.SetMaxDepth(initialMaxDepth); // NOLINT
 
+        // the duplicates of the initial population are created again (see UniqueTreeInitializer)
+        Operon::UniqueTreeInitializer uniqueInitializer(treeInitializer);
+        auto const uniqueInit = result["unique-init"].as<bool>();
+        Operon::TreeInitializerBase const& initializer = uniqueInit ? static_cast<Operon::TreeInitializerBase const&>(uniqueInitializer) : treeInitializer;
+
         std::unique_ptr<Operon::CoefficientInitializerBase> coeffInitializer;
         std::unique_ptr<Operon::MutatorBase> onePoint;
         if (symbolic) {
@@ -224,44 +261,108 @@ auto main(int argc, char** argv) -> int
         mutator.Add(removeSubtree, 1.0);
         mutator.Add(discretePoint, 1.0);
 
-        Operon::DefaultDispatch dtable;
+        // the search may use approximate primitives, the reported models are always evaluated with the exact table
+        auto dtable = Operon::MakeDispatchTable(Operon::ParseDispatchTarget(result["dispatch"].as<std::string>()));
+        auto searchTable = dtable;
+        auto const approximate = result.count("approximate") > 0;
+        auto const approximateTypes = result.count("approximate-symbols") > 0 ? Operon::ParsePrimitiveSetConfig(result["approximate-symbols"].as<std::string>()) : ~Operon::NodeType{};
+        if (approximate) {
+            Operon::ApproximatePrimitives(searchTable, result["approximate"].as<int>(), approximateTypes);
+        }
         auto scale = result["linear-scaling"].as<bool>();
-        auto errorEvaluator = Operon::ParseEvaluator(result["objective"].as<std::string>(), problem, dtable, scale);
+        auto errorEvaluator = Operon::ParseEvaluator(result["objective"].as<std::string>(), problem, searchTable, scale);
         errorEvaluator->SetBudget(config.Evaluations);
+        if (auto* e = dynamic_cast<Operon::Evaluator<decltype(dtable)>*>(errorEvaluator.get()); e != nullptr) {
+            e->SetSemanticHashing(result["semantic-rows"].as<size_t>());
+        }
 
-        auto optimizer = std::make_unique<Operon::LevenbergMarquardtOptimizer<decltype(dtable), Operon::OptimizerType::Eigen>>(dtable, problem);
+        // the normal equations solver also carries the trust region of a structure over (see SetStateCache)
+        Operon::SolverStateCache stateCache{result["structure-cache"].as<size_t>()};
+        std::unique_ptr<Operon::OptimizerBase> optimizer;
+        if (stateCache.Enabled()) {
+            optimizer = std::make_unique<Operon::LevenbergMarquardtOptimizer<decltype(dtable), Operon::OptimizerType::NormalEquations>>(searchTable, problem);
+        } else {
+            optimizer = std::make_unique<Operon::LevenbergMarquardtOptimizer<decltype(dtable), Operon::OptimizerType::Eigen>>(searchTable, problem);
+        }
         optimizer->SetIterations(config.Iterations);
+        optimizer->SetStateCache(&stateCache);
         Operon::LengthEvaluator lengthEvaluator(problem, maxLength);
 
+        // the costs are measured with the exact primitives, as the models would be evaluated outside of the search
+        auto const maxCost = result["max-cost"].as<double>();
+        std::unique_ptr<Operon::CostEvaluator> costEvaluator;
+        if (result["cost-objective"].as<bool>() || maxCost > 0) {
+            auto const model = Operon::EvaluationCostModel::Calibrate(dtable, primitiveSetConfig);
+            costEvaluator = std::make_unique<Operon::CostEvaluator>(problem, model);
+            if (maxCost > 0) { costEvaluator->SetCostLimit(maxCost); }
+        }
+
         Operon::MultiEvaluator evaluator(problem);
         evaluator.SetBudget(config.Evaluations);
         evaluator.Add(*errorEvaluator);
-        evaluator.Add(lengthEvaluator);
+        if (costEvaluator) {
+            evaluator.Add(*costEvaluator);
+        } else {
+            evaluator.Add(lengthEvaluator);
+        }
 
         EXPECT(problem.TrainingRange().Size() > 0);
 
         Operon::CrowdedComparison comp;
 
-        auto femaleSelector = Operon::ParseSelector(result["female-selector"].as<std::string>(), comp);
-        auto maleSelector = Operon::ParseSelector(result["male-selector"].as<std::string>(), comp);
+        // the selectors that draw their own random numbers get seeds derived from the seed of the run
+        Operon::RandomGenerator seeds{config.Seed};
+        auto femaleSelector = Operon::ParseSelector(result["female-selector"].as<std::string>(), comp, seeds());
+        auto maleSelector = Operon::ParseSelector(result["male-selector"].as<std::string>(), comp, seeds());
+        Operon::CaptureCaseErrors(*errorEvaluator, *femaleSelector, *maleSelector, result["case-rows"].as<size_t>(), seeds);
         Operon::CoefficientOptimizer cOpt{*optimizer, config.LamarckianProbability};
+        cOpt.SetAdaptiveIterations(result["adaptive-iterations"].as<size_t>(), Operon::CoefficientOptimizer::DefaultAdaptiveTolerance);
+        cOpt.SetStructureWarmStart(stateCache.Enabled());
 
         auto generator = Operon::ParseGenerator(result["offspring-generator"].as<std::string>(), evaluator, crossover, mutator, *femaleSelector, *maleSelector, &cOpt);
         auto reinserter = Operon::ParseReinserter(result["reinserter"].as<std::string>(), comp);
 
+        Operon::Profiler profiler;
+        if (result.count("profile") > 0) {
+            generator->SetProfiler(&profiler);
+        }
+        generator->SetSimplify(result["simplify"].as<bool>());
+        generator->SetDuplicateRejection(result["reject-duplicates"].as<bool>(), result["duplicate-retries"].as<size_t>(), config.PoolSize);
+
+        // the workers are pinned to their cores when they start (see AffinityPolicy)
+        auto const pool = Operon::MakeExecutor(threads, Operon::ParseAffinityPolicy(result["affinity"].as<std::string>()));
+        auto& executor = *pool;
         Operon::RandomGenerator random(config.Seed);
         if (result["shuffle"].as<bool>()) {
-            problem.GetDataset().Shuffle(random);
+            problem.GetDataset().Shuffle(random, executor);
         }
         if (result["standardize"].as<bool>()) {
-            problem.StandardizeData(problem.TrainingRange());
+            problem.StandardizeData(problem.TrainingRange(), /*inPlace=*/!result["lazy-standardize"].as<bool>(), executor);
+        }
+        // the codes are built last, shuffling and standardization drop them (see Dataset::Encode)
+        if (auto const cardinality = result["encode-columns"].as<size_t>(); cardinality > 0) {
+            problem.GetDataset().Encode(cardinality);
         }
 
-        tf::Executor executor(threads);
+        // the batch sizes are tuned on the final dataset (see BatchSizeTuner)
+        Operon::DefaultBatchSizeTuner batchTuner;
+        if (result["tune-batch-size"].as<bool>()) {
+            if (approximate) {
+                batchTuner.ForEachTable([&](auto& table) { Operon::ApproximatePrimitives(table, result["approximate"].as<int>(), approximateTypes); });
+            }
+            Operon::TuneBatchSize(batchTuner, problem, *creator, *coeffInitializer, amin + 1, maxLength, maxDepth, config.Seed);
+            if (auto* e = dynamic_cast<Operon::Evaluator<decltype(dtable)>*>(errorEvaluator.get()); e != nullptr) { e->SetBatchSizeTuner(&batchTuner); }
+        }
+
+        std::unique_ptr<Operon::TaskTrace> trace;
+        if (result.count("trace") > 0) {
+            trace = std::make_unique<Operon::TaskTrace>(executor);
+        }
 
         auto t0 = std::chrono::steady_clock::now();
-        Operon::RankIntersectSorter sorter;
-        Operon::NSGA2 gp { problem, config, treeInitializer, *coeffInitializer, *generator, *reinserter, sorter };
+        Operon::AdaptiveSorter sorter;
+        Operon::NSGA2 gp { problem, config, initializer, *coeffInitializer, *generator, *reinserter, sorter };
+        auto checkpoints = Operon::SetupCheckpoints(gp, result);
 
         auto targetValues = problem.TargetValues();
         auto targetTrain = targetValues.subspan(trainingRange.Start(), trainingRange.Size());
@@ -269,135 +370,116 @@ auto main(int argc, char** argv) -> int
 
         // some boilerplate for reporting results
         const size_t idx { 0 };
-        auto getBest = [&](Operon::Span<Operon::Individual const> pop) -> Operon::Individual {
-            const auto minElem = std::min_element(pop.begin(), pop.end(), [&](auto const& lhs, auto const& rhs) { return lhs[idx] < rhs[idx]; });
-            return *minElem;
-        };
-
         Operon::Individual best(1);
-        auto getSize = [](Operon::Individual const& ind) { return sizeof(ind) + sizeof(ind.Genotype) + sizeof(Operon::Node) * ind.Genotype.Nodes().capacity(); };
-
-        auto report = [&]() {
-            auto const& pop = gp.Parents();
-            auto const& off = gp.Offspring();
 
-            best = getBest(pop);
+        // the best model is evaluated on the training and test data and printed by the reporter thread, the workers only take a snapshot
+        bool printHeader{true};
 
-            Operon::Vector<Operon::Scalar> estimatedTrain;
-            Operon::Vector<Operon::Scalar> estimatedTest;
+        // the monitor is created at the first report, after a resumed run has restored the evaluator counters
+        auto const metricsPath = result.count("metrics") > 0 ? result["metrics"].as<std::string>() : std::string{};
+        std::optional<Operon::ThroughputMonitor> monitor;
 
-            tf::Taskflow taskflow;
+        // with --run-log, the statistics of the generations are written by the reporter thread
+        std::unique_ptr<Operon::RunLog> runLog;
+        if (result.count("run-log") > 0) {
+            runLog = std::make_unique<Operon::RunLog>(result["run-log"].as<std::string>());
+        }
 
+        Operon::AsyncReporter reporter([&](Operon::ReportSnapshot& snapshot) {
             using DT = Operon::DefaultDispatch;
-
-            auto evalTrain = taskflow.emplace([&]() {
-                estimatedTrain = Operon::Interpreter<Operon::Scalar, DT>::Evaluate(best.Genotype, problem.GetDataset(), trainingRange);
-            });
-
-            auto evalTest = taskflow.emplace([&]() {
-                estimatedTest = Operon::Interpreter<Operon::Scalar, DT>::Evaluate(best.Genotype, problem.GetDataset(), testRange);
-            });
+            auto& model = snapshot.Best.Genotype;
+            // both ranges are evaluated by a single interpreter pass
+            std::array const ranges{ trainingRange, testRange };
+            auto estimated = Operon::Interpreter<Operon::Scalar, DT>{dtable, problem.GetDataset(), model}.Evaluate(model.GetCoefficients(), ranges);
+            auto& estimatedTrain = estimated[0];
+            auto& estimatedTest = estimated[1];
 
             // scale values
-            Operon::Scalar a{1.0};
-            Operon::Scalar b{0.0};
-            auto linearScaling = taskflow.emplace([&]() {
-                auto [a_, b_] = Operon::FitLeastSquares(estimatedTrain, targetTrain);
-                a = static_cast<Operon::Scalar>(a_);
-                b = static_cast<Operon::Scalar>(b_);
-                // add scaling terms to the tree
-                auto& nodes = best.Genotype.Nodes();
-                auto const sz = nodes.size();
-                if (std::abs(a - Operon::Scalar{1}) > std::numeric_limits<Operon::Scalar>::epsilon()) {
-                    nodes.emplace_back(Operon::Node::Constant(a));
-                    nodes.emplace_back(Operon::NodeType::Mul);
-                }
-                if (std::abs(b) > std::numeric_limits<Operon::Scalar>::epsilon()) {
-                    nodes.emplace_back(Operon::Node::Constant(b));
-                    nodes.emplace_back(Operon::NodeType::Add);
-                }
-                if (nodes.size() > sz) {
-                    best.Genotype.UpdateNodes();
-                }
-            });
-
-            double r2Train{};
-            double r2Test{};
-            double nmseTrain{};
-            double nmseTest{};
-            double maeTrain{};
-            double maeTest{};
-
-            auto scaleTrain = taskflow.emplace([&]() {
-                Eigen::Map<Eigen::Array<Operon::Scalar, -1, 1>> estimated(estimatedTrain.data(), std::ssize(estimatedTrain));
-                estimated = estimated * a + b;
-            });
-
-            auto scaleTest = taskflow.emplace([&]() {
-                Eigen::Map<Eigen::Array<Operon::Scalar, -1, 1>> estimated(estimatedTest.data(), std::ssize(estimatedTest));
+            auto [a_, b_] = Operon::FitLeastSquares(estimatedTrain, targetTrain);
+            auto const a = static_cast<Operon::Scalar>(a_);
+            auto const b = static_cast<Operon::Scalar>(b_);
+            // add scaling terms to the tree
+            auto& nodes = model.Nodes();
+            auto const sz = nodes.size();
+            if (std::abs(a - Operon::Scalar{1}) > std::numeric_limits<Operon::Scalar>::epsilon()) {
+                nodes.emplace_back(Operon::Node::Constant(a));
+                nodes.emplace_back(Operon::NodeType::Mul);
+            }
+            if (std::abs(b) > std::numeric_limits<Operon::Scalar>::epsilon()) {
+                nodes.emplace_back(Operon::Node::Constant(b));
+                nodes.emplace_back(Operon::NodeType::Add);
+            }
+            if (nodes.size() > sz) {
+                model.UpdateNodes();
+            }
+            for (auto* values : { &estimatedTrain, &estimatedTest }) {
+                Eigen::Map<Eigen::Array<Operon::Scalar, -1, 1>> estimated(values->data(), std::ssize(*values));
                 estimated = estimated * a + b;
-            });
-
-            auto calcStats = taskflow.emplace([&]() {
-                // negate the R2 because this is an internal fitness measure (minimization) which we here repurpose
-                r2Train = -Operon::R2{}(estimatedTrain, targetTrain);
-                r2Test = -Operon::R2{}(estimatedTest, targetTest);
-
-                nmseTrain = Operon::NMSE{}(estimatedTrain, targetTrain);
-                nmseTest = Operon::NMSE{}(estimatedTest, targetTest);
-
-                maeTrain = Operon::MAE{}(estimatedTrain, targetTrain);
-                maeTest = Operon::MAE{}(estimatedTest, targetTest);
-            });
-
-            double avgLength = 0;
-            double avgQuality = 0;
-            double totalMemory = 0;
-
-            auto calculateLength = taskflow.transform_reduce(pop.begin(), pop.end(), avgLength, std::plus{}, [](auto const& ind) { return ind.Genotype.Length(); });
-            auto calculateQuality = taskflow.transform_reduce(pop.begin(), pop.end(), avgQuality, std::plus{}, [idx=idx](auto const& ind) { return ind[idx]; });
-            auto calculatePopMemory = taskflow.transform_reduce(pop.begin(), pop.end(), totalMemory, std::plus{}, [&](auto const& ind) { return getSize(ind); });
-            auto calculateOffMemory = taskflow.transform_reduce(off.begin(), off.end(), totalMemory, std::plus{}, [&](auto const& ind) { return getSize(ind); });
-
-            // define task graph
-            linearScaling.succeed(evalTrain, evalTest);
-            linearScaling.precede(scaleTrain, scaleTest);
-            calcStats.succeed(scaleTrain, scaleTest);
-            calcStats.precede(calculateLength, calculateQuality, calculatePopMemory, calculateOffMemory);
-
-            executor.corun(taskflow);
-
-            avgLength /= static_cast<double>(pop.size());
-            avgQuality /= static_cast<double>(pop.size());
+            }
 
-            auto t1 = std::chrono::steady_clock::now();
-            auto elapsed = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count()) / 1e6;
+            // negate the R2 because this is an internal fitness measure (minimization) which we here repurpose
+            auto const r2Train = -Operon::R2{}(estimatedTrain, targetTrain);
+            auto const r2Test = -Operon::R2{}(estimatedTest, targetTest);
+            auto const nmseTrain = Operon::NMSE{}(estimatedTrain, targetTrain);
+            auto const nmseTest = Operon::NMSE{}(estimatedTest, targetTest);
+            auto const maeTrain = Operon::MAE{}(estimatedTrain, targetTrain);
+            auto const maeTest = Operon::MAE{}(estimatedTest, targetTest);
+            if (runLog) { runLog->Append(snapshot, { r2Train, r2Test, maeTrain, maeTest, nmseTrain, nmseTest }); }
 
             using T = std::tuple<std::string, double, std::string>;
             auto const* format = ":>#8.3g"; // see https://fmt.dev/latest/syntax.html
 
-            auto [resEval, jacEval, callCount, cfTime ] = evaluator.Stats();
+            auto const& counters = snapshot.Stats;
             std::array stats {
-                T{ "iteration", gp.Generation(), ":>" },
+                T{ "iteration", snapshot.Generation, ":>" },
                 T{ "r2_tr", r2Train, format },
                 T{ "r2_te", r2Test, format },
                 T{ "mae_tr", maeTrain, format },
                 T{ "mae_te", maeTest, format },
                 T{ "nmse_tr", nmseTrain, format },
                 T{ "nmse_te", nmseTest, format },
-                T{ "avg_fit", avgQuality, format },
-                T{ "avg_len", avgLength, format },
-                T{ "eval_cnt", callCount, ":>" },
-                T{ "res_eval", resEval, ":>" },
-                T{ "jac_eval", jacEval, ":>" },
-                T{ "opt_time", cfTime, ":>" },
+                T{ "avg_fit", snapshot.Population.Fitness.Mean, format },
+                T{ "avg_len", snapshot.Population.Length.Mean, format },
+                T{ "eval_cnt", counters.Calls, ":>" },
+                T{ "res_eval", counters.Residual, ":>" },
+                T{ "jac_eval", counters.Jacobian, ":>" },
+                T{ "jac_saved", counters.SavedJacobians, ":>" },
+                T{ "opt_time", counters.CostTime, ":>" },
                 T{ "seed", config.Seed, ":>" },
-                T{ "elapsed", elapsed, ":>"},
+                T{ "elapsed", snapshot.Elapsed, ":>"},
             };
-            Operon::PrintStats({ stats.begin(), stats.end() }, gp.Generation() == 0);
+            Operon::PrintStats({ stats.begin(), stats.end() }, std::exchange(printHeader, false));
+            if (snapshot.Throughput) { Operon::WriteOpenMetrics(metricsPath, *snapshot.Throughput); }
+            best = std::move(snapshot.Best);
+        });
+
+        auto report = [&]() {
+            auto t1 = std::chrono::steady_clock::now();
+            auto elapsed = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count()) / 1e6;
+            auto snapshot = Operon::MakeSnapshot(gp.Parents(), idx, evaluator, gp.Generation(), elapsed, executor, /*values=*/runLog != nullptr);
+            if (!metricsPath.empty()) {
+                if (!monitor) { monitor.emplace(evaluator); }
+                snapshot.Throughput = monitor->Sample(gp.Generation());
+            }
+            reporter.Submit(std::move(snapshot));
         };
 
         gp.Run(executor, random, report);
+        if (checkpoints) { checkpoints->Wait(); }
+        if (trace) { trace->WriteChromeTrace(result["trace"].as<std::string>()); }
+
+        // the error objective of the final population is computed again using the exact primitives, the last report line shows the result
+        if (approximate) {
+            auto exactEvaluator = Operon::ParseEvaluator(result["objective"].as<std::string>(), problem, dtable, scale);
+            for (auto& ind : gp.Parents()) {
+                ind[idx] = (*exactEvaluator)(random, ind, {}).front();
+            }
+            report();
+        }
+        reporter.Wait();
+        if (generator->GetProfiler() != nullptr) { Operon::PrintProfile(profiler.Total()); }
+        if (generator->DuplicateRejection()) { fmt::print("duplicates: {} children rejected\n", generator->RejectedDuplicates()); }
+        if (uniqueInit) { fmt::print("initialization: {} duplicate trees created again\n", uniqueInitializer.Rejected()); }
         fmt::print("{}\n", Operon::InfixFormatter::Format(best.Genotype, problem.GetDataset(), std::numeric_limits<Operon::Scalar>::digits));
     } catch (std::exception& e) {
         fmt::print(stderr, "error: {}\n", e.what());
@@ -1,7 +1,12 @@
 // SPDX-License-Identifier: MIT
 // SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
 
+#include <array>
+#include <fstream>
+#include <iostream>
+#include <limits>
 #include <string>
+#include <thread>
 
 
 #include "operon/core/dataset.hpp"
@@ -11,24 +16,167 @@
 #include "operon/optimizer/likelihood/gaussian_likelihood.hpp"
 #include "operon/parser/infix.hpp"
 #include "operon/interpreter/interpreter.hpp"
+#include "operon/interpreter/jit.hpp"
 #include "operon/operators/evaluator.hpp"
 #include "util.hpp"
 
 #include <cxxopts.hpp>
 #include <fmt/core.h>
 #include <scn/scan.h>
+#include <taskflow/taskflow.hpp>
+#include <taskflow/algorithm/for_each.hpp>
+
+namespace {
+    // one expression per line, empty lines and lines starting with '#' are skipped
+    auto ReadExpressions(std::istream& in) -> std::vector<std::string>
+    {
+        std::vector<std::string> expressions;
+        for (std::string line; std::getline(in, line);) {
+            auto const first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos || line[first] == '#') { continue; }
+            expressions.push_back(line.substr(first));
+        }
+        return expressions;
+    }
+
+    // writes the c++ source of the models for ahead-of-time compilation (see CppFormatter::FormatModule)
+    auto ExportModels(std::string const& path, Operon::Span<Operon::Tree const> models, Operon::Dataset const& ds) -> bool
+    {
+        Operon::Map<Operon::Hash, std::string> names;
+        for (auto const& v : ds.GetVariables()) {
+            names.insert({ v.Hash, v.Name });
+        }
+        try {
+            auto const source = Operon::CppFormatter::FormatModule(models, names);
+            std::ofstream out(path);
+            if (!(out << source)) { throw std::runtime_error(fmt::format("cannot write {}", path)); }
+        } catch (std::exception const& ex) {
+            fmt::print(stderr, "error: {}\n", ex.what());
+            return false;
+        }
+        return true;
+    }
+
+    // scores many models against the same dataset with a shared executor
+    // - the predictions are written as a binary dataset with one column per model (model_0, model_1, ...)
+    // - the metrics are written as a binary dataset with one row per model, or printed when no path is given
+    // - models that fail to parse are reported on stderr and get nan predictions and metrics
+    // - the exported source has one function per model (model_0, model_1, ...), an empty one for the models that failed
+    auto ScoreBatch(cxxopts::ParseResult const& result, Operon::Dataset const& ds, Operon::Range range) -> int
+    {
+        auto const path = result["batch"].as<std::string>();
+        std::vector<std::string> expressions;
+        if (path == "-") {
+            expressions = ReadExpressions(std::cin);
+        } else {
+            std::ifstream in(path);
+            if (!in) {
+                fmt::print(stderr, "error: cannot open {}\n", path);
+                return EXIT_FAILURE;
+            }
+            expressions = ReadExpressions(in);
+        }
+        if (expressions.empty()) {
+            fmt::print(stderr, "error: no expressions were found in {}\n", path);
+            return EXIT_FAILURE;
+        }
+
+        auto const hasTarget = result["target"].count() > 0;
+        if (!hasTarget && result["output"].count() == 0) {
+            fmt::print(stderr, "error: batch mode needs a target or an output file.\n");
+            return EXIT_FAILURE;
+        }
+
+        Operon::Map<std::string, Operon::Hash> vars;
+        for (auto const& v : ds.GetVariables()) {
+            vars.insert({ v.Name, v.Hash });
+        }
+        Operon::Span<Operon::Scalar const> tgt;
+        if (hasTarget) {
+            tgt = ds.GetValues(result["target"].as<std::string>()).subspan(range.Start(), range.Size());
+        }
+
+        std::vector<std::string> const names{"slope", "intercept", "r2", "rs", "mae", "mse", "rmse", "nmse"};
+        auto const n = expressions.size();
+        auto constexpr nan = std::numeric_limits<Operon::Scalar>::quiet_NaN();
+        std::vector<std::vector<Operon::Scalar>> predictions(n, std::vector<Operon::Scalar>(range.Size(), nan));
+        std::vector<std::vector<Operon::Scalar>> metrics(names.size(), std::vector<Operon::Scalar>(n, nan));
+        std::vector<std::string> errors(n);
+        std::vector<Operon::Tree> models(n);
+
+        auto const& dtable = Operon::SharedDispatchTable();
+        auto threads = result["threads"].as<std::size_t>();
+        if (threads == 0) { threads = std::thread::hardware_concurrency(); }
+        tf::Executor executor(threads);
+        tf::Taskflow taskflow;
+        taskflow.for_each_index(std::size_t{0}, n, std::size_t{1}, [&](auto i) {
+            auto& model = models[i];
+            try {
+                model = Operon::InfixParser::Parse(expressions[i], vars);
+            } catch (std::exception const& ex) {
+                errors[i] = ex.what();
+                return;
+            }
+            auto& est = predictions[i];
+            Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>{dtable, ds, model}.Evaluate(model.GetCoefficients(), range, est);
+            if (!hasTarget) { return; }
+
+            auto const [a, b] = Operon::FitLeastSquares(est, tgt);
+            std::transform(est.begin(), est.end(), est.begin(), [a = a, b = b](auto v) { return static_cast<Operon::Scalar>(v * a + b); });
+            Operon::Span<Operon::Scalar const> x{est};
+            std::array<double, 8> const values{ a, b, -Operon::R2{}(x, tgt), -Operon::C2{}(x, tgt), Operon::MAE{}(x, tgt), Operon::MSE{}(x, tgt), Operon::RMSE{}(x, tgt), Operon::NMSE{}(x, tgt) };
+            for (auto j = 0UL; j < values.size(); ++j) { metrics[j][i] = static_cast<Operon::Scalar>(values[j]); }
+        });
+        executor.run(taskflow).wait();
+
+        for (auto i = 0UL; i < n; ++i) {
+            if (!errors[i].empty()) { fmt::print(stderr, "warning: model {} could not be parsed: {}\n", i, errors[i]); }
+        }
+        if (result["export"].count() > 0 && !ExportModels(result["export"].as<std::string>(), models, ds)) {
+            return EXIT_FAILURE;
+        }
+
+        try {
+            if (result["output"].count() > 0) {
+                std::vector<std::string> columns(n);
+                for (auto i = 0UL; i < n; ++i) { columns[i] = fmt::format("model_{}", i); }
+                Operon::Dataset(columns, predictions).WriteBinary(result["output"].as<std::string>());
+            }
+            if (hasTarget && result["metrics"].count() > 0) {
+                Operon::Dataset(names, metrics).WriteBinary(result["metrics"].as<std::string>());
+            } else if (hasTarget) {
+                auto const format = result["format"].as<std::string>();
+                for (auto i = 0UL; i < n; ++i) {
+                    std::vector<std::tuple<std::string, double, std::string>> stats{{"model", i, ":>8"}};
+                    for (auto j = 0UL; j < names.size(); ++j) { stats.emplace_back(names[j], metrics[j][i], format); }
+                    Operon::PrintStats(stats, /*printHeader=*/i == 0);
+                }
+            }
+        } catch (std::exception const& ex) {
+            fmt::print(stderr, "error: {}\n", ex.what());
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+} // namespace
 
 auto main(int argc, char** argv) -> int
 {
     cxxopts::Options opts("operon_parse_model", "Parse and evaluate a model in infix form");
 
     opts.add_options()
-        ("dataset", "Dataset file name (csv) (required)", cxxopts::value<std::string>())
+        ("dataset", "Dataset file name (csv or binary) (required)", cxxopts::value<std::string>())
         ("target", "Name of the target variable (if none provided, model output will be printed)", cxxopts::value<std::string>())
         ("range", "Data range [A:B)", cxxopts::value<std::string>())
         ("scale", "Linear scaling slope:intercept", cxxopts::value<std::string>())
         ("debug", "Show some debugging information", cxxopts::value<bool>()->default_value("false"))
+        ("jit", "Compile the model to native code with the system compiler before scoring the dataset", cxxopts::value<bool>()->default_value("false"))
+        ("export", "Write the C++ source of the model(s) to a file, for ahead-of-time compilation", cxxopts::value<std::string>())
         ("format", "Format string (see https://fmt.dev/latest/syntax.html)", cxxopts::value<std::string>()->default_value(":>#8.4g"))
+        ("batch", "Score the models read from a file (one infix string per line, - for stdin) instead of a single model", cxxopts::value<std::string>())
+        ("output", "Write the predictions of the batch to a binary dataset (one column per model)", cxxopts::value<std::string>())
+        ("metrics", "Write the metrics of the batch to a binary dataset (one row per model, printed if not given)", cxxopts::value<std::string>())
+        ("threads", "Number of threads used in batch mode (0 = one per hardware thread)", cxxopts::value<std::size_t>()->default_value("0"))
         ("help", "Print help");
 
     opts.allow_unrecognised_options();
@@ -51,12 +199,25 @@ auto main(int argc, char** argv) -> int
         return EXIT_FAILURE;
     }
 
-    if (result.unmatched().empty()) {
+    auto const batch = result.count("batch") > 0;
+    if (!batch && result.unmatched().empty()) {
         fmt::print(stderr, "error: no infix string was provided.\n");
         return EXIT_FAILURE;
     }
 
-    Operon::Dataset ds(result["dataset"].as<std::string>(), /*hasHeader=*/true);
+    auto const ds = Operon::ReadDataset(result["dataset"].as<std::string>(), /*owned=*/false);
+    Operon::Range range{0, ds.Rows<std::size_t>()};
+    if (result["range"].count() > 0) {
+        auto res = scn::scan<std::size_t, std::size_t>(result["range"].as<std::string>(), "{}:{}");
+        ENSURE(res);
+        auto [a, b] = res->values();
+        range = Operon::Range{a, b};
+    }
+
+    if (batch) {
+        return ScoreBatch(result, ds, range);
+    }
+
     auto infix = result.unmatched().front();
     Operon::Map<std::string, Operon::Hash> vars;
     for (auto const& v : ds.GetVariables()) {
@@ -64,15 +225,12 @@ auto main(int argc, char** argv) -> int
     }
     auto model = Operon::InfixParser::Parse(infix, vars);
 
-    Operon::DefaultDispatch dtable;
-    Operon::Range range{0, ds.Rows<std::size_t>()};
-    if (result["range"].count() > 0) {
-        auto res = scn::scan<std::size_t, std::size_t>(result["range"].as<std::string>(), "{}:{}");
-        ENSURE(res);
-        auto [a, b] = res->values();
-        range = Operon::Range{a, b};
+    if (result["export"].count() > 0 && !ExportModels(result["export"].as<std::string>(), { &model, 1 }, ds)) {
+        return EXIT_FAILURE;
     }
 
+    auto const& dtable = Operon::SharedDispatchTable();
+
     int constexpr defaultPrecision{6};
     if (result["debug"].as<bool>()) {
         fmt::print("\nInput string:\n{}\n", infix);
@@ -81,7 +239,17 @@ auto main(int argc, char** argv) -> int
         fmt::print("Scale: {}\n", result["scale"].count() > 0 ? result["scale"].as<std::string>() : std::string("auto"));
     }
 
-    auto est = Operon::Interpreter<Operon::Scalar, decltype(dtable)>::Evaluate(model, ds, range);
+    std::vector<Operon::Scalar> est;
+    if (result["jit"].as<bool>()) {
+        try {
+            est = Operon::JitModel{model}.Evaluate(ds, range);
+        } catch (std::exception const& ex) {
+            fmt::print(stderr, "error: {}\n", ex.what());
+            return EXIT_FAILURE;
+        }
+    } else {
+        est = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>::Evaluate(model, ds, range);
+    }
 
     std::string format = result["format"].as<std::string>();
     if (result["target"].count() > 0) {
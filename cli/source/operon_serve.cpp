@@ -0,0 +1,341 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "operon/core/dataset.hpp"
+#include "operon/core/serialization.hpp"
+#include "operon/core/tree.hpp"
+#include "operon/core/types.hpp"
+#include "operon/hash/hash.hpp"
+#include "operon/interpreter/dispatch_table.hpp"
+#include "operon/interpreter/interpreter.hpp"
+#include "operon/parser/infix.hpp"
+#include "util.hpp"
+
+#include <cxxopts.hpp>
+#include <fmt/core.h>
+
+namespace {
+    // one expression per line, empty lines and lines starting with '#' are skipped
+    auto ReadExpressions(std::istream& in) -> std::vector<std::string>
+    {
+        std::vector<std::string> expressions;
+        for (std::string line; std::getline(in, line);) {
+            auto const first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos || line[first] == '#') { continue; }
+            expressions.push_back(line.substr(first));
+        }
+        return expressions;
+    }
+
+    // collects the rows of all the clients and evaluates them together, so that the interpreter works on full batches
+    // - a batch is evaluated when it has maxRows rows, or when the oldest row waited for the batching window
+    // - the models and the dispatch table stay in memory, the trees are compiled against each batch (the tapes hold
+    //   the addresses of the batch values and must not reuse cached subtrees of another batch)
+    // - the reply of a row holds the prediction of each model, separated by commas
+    class Batcher {
+    public:
+        Batcher(std::vector<Operon::Tree> models, std::vector<std::string> names, std::size_t maxRows, std::chrono::microseconds window)
+            : models_(std::move(models))
+            , names_(std::move(names))
+            , maxRows_(std::max(maxRows, std::size_t{1}))
+            , window_(window)
+            , thread_([this]() { Work(); })
+        {
+        }
+
+        Batcher(Batcher const&) = delete;
+        Batcher(Batcher&&) = delete;
+        auto operator=(Batcher const&) -> Batcher& = delete;
+        auto operator=(Batcher&&) -> Batcher& = delete;
+
+        ~Batcher()
+        {
+            {
+                std::scoped_lock lock(mutex_);
+                stop_ = true;
+            }
+            cv_.notify_all();
+            thread_.join();
+        }
+
+        [[nodiscard]] auto Columns() const -> std::size_t { return names_.size(); }
+
+        auto Submit(std::vector<Operon::Scalar> row) -> std::future<std::string>
+        {
+            Request request{ std::move(row), {} };
+            auto reply = request.Reply.get_future();
+            {
+                std::scoped_lock lock(mutex_);
+                queue_.push_back(std::move(request));
+            }
+            cv_.notify_all();
+            return reply;
+        }
+
+    private:
+        struct Request {
+            std::vector<Operon::Scalar> Row;
+            std::promise<std::string> Reply;
+        };
+
+        auto Work() -> void
+        {
+            std::unique_lock lock(mutex_);
+            while (true) {
+                cv_.wait(lock, [&]() { return stop_ || !queue_.empty(); });
+                if (queue_.empty()) { return; }
+                cv_.wait_for(lock, window_, [&]() { return stop_ || queue_.size() >= maxRows_; });
+
+                auto const n = std::min(queue_.size(), maxRows_);
+                std::vector<Request> batch;
+                batch.reserve(n);
+                for (auto i = 0UL; i < n; ++i) {
+                    batch.push_back(std::move(queue_.front()));
+                    queue_.pop_front();
+                }
+                lock.unlock();
+                Evaluate(batch);
+                lock.lock();
+            }
+        }
+
+        auto Evaluate(std::vector<Request>& batch) const -> void
+        {
+            auto const n = batch.size();
+            auto const m = names_.size();
+            try {
+                Operon::Dataset::Matrix values(static_cast<Eigen::Index>(n), static_cast<Eigen::Index>(m));
+                for (auto i = 0UL; i < n; ++i) {
+                    for (auto j = 0UL; j < m; ++j) {
+                        values(static_cast<Eigen::Index>(i), static_cast<Eigen::Index>(j)) = batch[i].Row[j];
+                    }
+                }
+                Operon::Dataset ds(values.data(), values.rows(), values.cols());
+                ds.SetVariableNames(names_);
+
+                Operon::Range const range{ 0, n };
+                std::vector<std::string> replies(n);
+                std::vector<Operon::Scalar> estimated(n);
+                auto const& dtable = Operon::SharedDispatchTable();
+                for (auto k = 0UL; k < models_.size(); ++k) {
+                    auto const& model = models_[k];
+                    Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>{dtable, ds, model}.Evaluate(model.GetCoefficients(), range, estimated);
+                    for (auto i = 0UL; i < n; ++i) {
+                        if (k > 0) { replies[i].push_back(','); }
+                        fmt::format_to(std::back_inserter(replies[i]), "{:.9g}", estimated[i]);
+                    }
+                }
+                for (auto i = 0UL; i < n; ++i) { batch[i].Reply.set_value(std::move(replies[i])); }
+            } catch (...) {
+                for (auto& request : batch) { request.Reply.set_exception(std::current_exception()); }
+            }
+        }
+
+        std::vector<Operon::Tree> models_;
+        std::vector<std::string> names_;
+        std::size_t maxRows_;
+        std::chrono::microseconds window_;
+        std::deque<Request> queue_;
+        bool stop_{false};
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::thread thread_;
+    };
+
+    // the values of a row, separated by commas
+    auto ParseRow(std::string const& line, std::size_t columns) -> std::vector<Operon::Scalar>
+    {
+        std::vector<Operon::Scalar> row;
+        row.reserve(columns);
+        char const* p = line.c_str();
+        while (*p != '\0') {
+            char* end{nullptr};
+            auto const v = std::strtod(p, &end);
+            if (end == p) { throw std::runtime_error(fmt::format("could not parse a value at column {}", row.size())); }
+            row.push_back(static_cast<Operon::Scalar>(v));
+            p = end;
+            while (*p == ' ' || *p == '\t') { ++p; }
+            if (*p == ',') { ++p; } else if (*p != '\0') { throw std::runtime_error(fmt::format("unexpected character '{}'", *p)); }
+        }
+        if (row.size() != columns) {
+            throw std::runtime_error(fmt::format("expected {} values, got {}", columns, row.size()));
+        }
+        return row;
+    }
+
+#if !defined(_WIN32)
+    auto SendAll(int fd, std::string const& data) -> bool
+    {
+        std::size_t sent{0};
+        while (sent < data.size()) {
+            auto const k = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (k <= 0) { return false; }
+            sent += static_cast<std::size_t>(k);
+        }
+        return true;
+    }
+
+    // the rows of all the complete lines received so far are submitted together, then answered in order
+    auto Serve(int fd, Batcher& batcher) -> void
+    {
+        constexpr std::size_t chunkSize{1UL << 16U};
+        std::vector<char> chunk(chunkSize);
+        std::string buffer;
+        std::vector<std::future<std::string>> pending;
+        std::string out;
+        for (ssize_t k{0}; (k = ::recv(fd, chunk.data(), chunk.size(), 0)) > 0;) {
+            buffer.append(chunk.data(), static_cast<std::size_t>(k));
+            pending.clear();
+            std::size_t begin{0};
+            for (auto end = buffer.find('\n'); end != std::string::npos; begin = end + 1, end = buffer.find('\n', begin)) {
+                auto line = buffer.substr(begin, end - begin);
+                if (!line.empty() && line.back() == '\r') { line.pop_back(); }
+                if (line.find_first_not_of(" \t") == std::string::npos) { continue; }
+                try {
+                    pending.push_back(batcher.Submit(ParseRow(line, batcher.Columns())));
+                } catch (std::exception const&) {
+                    std::promise<std::string> error;
+                    error.set_exception(std::current_exception());
+                    pending.push_back(error.get_future());
+                }
+            }
+            buffer.erase(0, begin);
+
+            out.clear();
+            for (auto& reply : pending) {
+                try {
+                    out += reply.get();
+                } catch (std::exception const& ex) {
+                    out += fmt::format("error: {}", ex.what());
+                }
+                out.push_back('\n');
+            }
+            if (!SendAll(fd, out)) { break; }
+        }
+        ::close(fd);
+    }
+#endif
+} // namespace
+
+auto main(int argc, char** argv) -> int
+{
+    cxxopts::Options opts("operon_serve", "Serve the predictions of models over a socket");
+
+    opts.add_options()
+        ("models", "Model file: one infix string per line, or a binary population (see --binary) (required)", cxxopts::value<std::string>())
+        ("binary", "Read the models from a binary population (eg. a checkpoint, see Serialization::WritePopulation)", cxxopts::value<bool>()->default_value("false"))
+        ("variables", "Comma-separated names of the variables, in the order of the values of a request row (required)", cxxopts::value<std::string>())
+        ("host", "Address to listen on", cxxopts::value<std::string>()->default_value("127.0.0.1"))
+        ("port", "Port to listen on", cxxopts::value<int>()->default_value("8765"))
+        ("batch-size", "Maximum number of rows evaluated together", cxxopts::value<std::size_t>()->default_value("4096"))
+        ("batch-window", "Microseconds a row waits for the rows of the other clients before its batch is evaluated", cxxopts::value<std::size_t>()->default_value("500"))
+        ("help", "Print help");
+
+    cxxopts::ParseResult result;
+    try {
+        result = opts.parse(argc, argv);
+    } catch (cxxopts::exceptions::parsing const& ex) {
+        fmt::print(stderr, "error: {}. rerun with --help to see available options.\n", ex.what());
+        return EXIT_FAILURE;
+    };
+
+    if (result.arguments().empty() || result.count("help") > 0) {
+        fmt::print("{}\n", opts.help());
+        fmt::print("Protocol: each line sent by a client holds the comma-separated values of one row, the server answers\n"
+                   "each line with the comma-separated predictions of the models (or a line starting with 'error:').\n");
+        return EXIT_SUCCESS;
+    }
+
+    if (result.count("models") == 0 || result.count("variables") == 0) {
+        fmt::print(stderr, "error: the models and the variables are required.\n");
+        return EXIT_FAILURE;
+    }
+
+#if defined(_WIN32)
+    fmt::print(stderr, "error: operon_serve is not supported on this platform.\n");
+    return EXIT_FAILURE;
+#else
+    auto const names = Operon::Split(result["variables"].as<std::string>(), ',');
+    Operon::Map<std::string, Operon::Hash> vars;
+    Operon::Set<Operon::Hash> hashes;
+    for (auto const& name : names) {
+        auto const h = Operon::Hasher{}(name);
+        vars.insert({ name, h });
+        hashes.insert(h);
+    }
+
+    std::vector<Operon::Tree> models;
+    try {
+        auto const path = result["models"].as<std::string>();
+        if (result["binary"].as<bool>()) {
+            std::ifstream in(path, std::ios::binary);
+            if (!in) { throw std::runtime_error(fmt::format("cannot open {}", path)); }
+            for (auto& ind : Operon::Serialization::ReadPopulation(in)) { models.push_back(std::move(ind.Genotype)); }
+        } else {
+            std::ifstream in(path);
+            if (!in) { throw std::runtime_error(fmt::format("cannot open {}", path)); }
+            for (auto const& expression : ReadExpressions(in)) { models.push_back(Operon::InfixParser::Parse(expression, vars)); }
+        }
+        if (models.empty()) { throw std::runtime_error(fmt::format("no models were found in {}", path)); }
+        // a model that reads another variable could not be evaluated on the request rows
+        for (auto i = 0UL; i < models.size(); ++i) {
+            for (auto const& node : models[i].Nodes()) {
+                if (node.IsVariable() && !hashes.contains(node.HashValue)) {
+                    throw std::runtime_error(fmt::format("model {} reads a variable that is not in --variables", i));
+                }
+            }
+        }
+    } catch (std::exception const& ex) {
+        fmt::print(stderr, "error: {}\n", ex.what());
+        return EXIT_FAILURE;
+    }
+
+    auto const host = result["host"].as<std::string>();
+    auto const port = result["port"].as<int>();
+    auto const fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    int const yes{1};
+    if (fd < 0 || ::inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1
+        || ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes)) != 0
+        || ::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 // NOLINT
+        || ::listen(fd, SOMAXCONN) != 0) {
+        fmt::print(stderr, "error: cannot listen on {}:{}\n", host, port);
+        return EXIT_FAILURE;
+    }
+
+    Batcher batcher(std::move(models), names, result["batch-size"].as<std::size_t>(), std::chrono::microseconds(result["batch-window"].as<std::size_t>()));
+    fmt::print("listening on {}:{}\n", host, port);
+    std::fflush(stdout);
+
+    // one thread per client, the evaluation itself is done by the batcher
+    while (true) {
+        auto const client = ::accept(fd, nullptr, nullptr);
+        if (client < 0) { continue; }
+        std::thread([client, &batcher]() { Serve(client, batcher); }).detach();
+    }
+#endif
+}
@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include "reporter.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "operon/core/contracts.hpp"
+
+namespace Operon {
+
+auto MakeSnapshot(Operon::Span<Operon::Individual const> pop, std::size_t idx, EvaluatorBase const& evaluator, std::size_t generation, double elapsed, tf::Executor& executor, bool values) -> ReportSnapshot
+{
+    EXPECT(!pop.empty());
+    ReportSnapshot snapshot;
+    snapshot.Generation = generation;
+    snapshot.Elapsed = elapsed;
+    snapshot.Stats = evaluator.Stats();
+
+    snapshot.Population = ComputePopulationStatistics(pop, idx, executor);
+    snapshot.Best = pop[snapshot.Population.Best];
+    if (values) {
+        snapshot.Fitness.resize(pop.size());
+        std::ranges::transform(pop, snapshot.Fitness.begin(), [&](auto const& ind) { return ind[idx]; });
+    }
+    return snapshot;
+}
+
+AsyncReporter::AsyncReporter(Handler handler)
+    : handler_(std::move(handler))
+    , thread_([this]() { Work(); })
+{
+}
+
+AsyncReporter::~AsyncReporter()
+{
+    {
+        std::scoped_lock lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+}
+
+auto AsyncReporter::Rethrow() -> void
+{
+    if (error_) {
+        std::rethrow_exception(std::exchange(error_, nullptr));
+    }
+}
+
+auto AsyncReporter::Submit(ReportSnapshot snapshot) -> void
+{
+    {
+        std::scoped_lock lock(mutex_);
+        Rethrow();
+        queue_.push_back(std::move(snapshot));
+    }
+    cv_.notify_all();
+}
+
+auto AsyncReporter::Wait() -> void
+{
+    std::unique_lock lock(mutex_);
+    cv_.wait(lock, [&]() { return queue_.empty() && !busy_; });
+    Rethrow();
+}
+
+auto AsyncReporter::Work() -> void
+{
+    std::unique_lock lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [&]() { return stop_ || !queue_.empty(); });
+        if (queue_.empty()) { return; } // stopped with nothing left to report
+
+        auto snapshot = std::move(queue_.front());
+        queue_.pop_front();
+        busy_ = true;
+        lock.unlock();
+
+        std::exception_ptr error;
+        try {
+            handler_(snapshot);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        busy_ = false;
+        if (error) {
+            // the remaining snapshots are dropped, the error is reported instead
+            error_ = error;
+            queue_.clear();
+        }
+        cv_.notify_all();
+    }
+}
+
+} // namespace Operon
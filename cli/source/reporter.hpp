@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_CLI_REPORTER_HPP
+#define OPERON_CLI_REPORTER_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "operon/analyzers/population_statistics.hpp"
+#include "operon/core/individual.hpp"
+#include "operon/core/types.hpp"
+#include "operon/operators/evaluator.hpp"
+#include "operon/operators/throughput.hpp"
+
+namespace Operon {
+
+// what the main loop hands over to the reporter at the end of a generation
+struct ReportSnapshot {
+    std::size_t Run{0};       // the index of the run in a batch (see --runs)
+    std::size_t Generation{0};
+    double Elapsed{0};        // seconds since the start of the run
+    PopulationStatistics Population; // fitness of objective idx, lengths, depths and complexity (see MakeSnapshot)
+    Operon::Individual Best;  // copy of the best individual
+    EvaluatorStats Stats{};   // see EvaluatorBase::Stats
+    std::optional<ThroughputSnapshot> Throughput; // with --metrics
+    std::vector<Operon::Scalar> Fitness; // objective idx of each individual, with --run-log
+};
+
+// the best individual (with respect to objective idx), the population statistics and the evaluator counters
+// - the statistics are reduced in parallel on the executor (see ComputePopulationStatistics)
+// - with values, the fitness of each individual is copied as well, so that its quantiles can be computed by the
+//   reporter thread (see RunLog)
+auto MakeSnapshot(Operon::Span<Operon::Individual const> pop, std::size_t idx, EvaluatorBase const& evaluator, std::size_t generation, double elapsed, tf::Executor& executor, bool values = false) -> ReportSnapshot;
+
+// runs the reporting on a separate thread, so that the workers do not wait for the test set evaluation and the output
+// - Submit only queues the snapshot, which is then passed to the handler, the snapshots are handled in order
+// - an error in the handler is rethrown by the next call to Submit or Wait
+class AsyncReporter {
+public:
+    using Handler = std::function<void(ReportSnapshot&)>;
+
+    explicit AsyncReporter(Handler handler);
+    AsyncReporter(AsyncReporter const&) = delete;
+    AsyncReporter(AsyncReporter&&) = delete;
+    auto operator=(AsyncReporter const&) -> AsyncReporter& = delete;
+    auto operator=(AsyncReporter&&) -> AsyncReporter& = delete;
+    ~AsyncReporter(); // handles the queued snapshots
+
+    auto Submit(ReportSnapshot snapshot) -> void;
+
+    // blocks until the queued snapshots are handled
+    auto Wait() -> void;
+
+private:
+    auto Work() -> void;
+    auto Rethrow() -> void;
+
+    Handler handler_;
+    std::deque<ReportSnapshot> queue_;
+    std::exception_ptr error_;
+    bool busy_{false};
+    bool stop_{false};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread thread_;
+};
+
+} // namespace Operon
+
+#endif
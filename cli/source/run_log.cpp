@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include "run_log.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <fmt/core.h>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace Operon {
+
+namespace {
+    constexpr std::array<char, 8> Magic{'O', 'P', 'R', 'N', 'L', 'O', 'G', '1'};
+    constexpr std::uint64_t Alignment{8};
+
+    auto Write(std::ofstream& out, std::uint64_t value) -> void
+    {
+        out.write(reinterpret_cast<char const*>(&value), sizeof(value)); // NOLINT
+    }
+
+    // the value at quantile q of the sorted values (nearest rank)
+    auto Quantile(std::vector<Operon::Scalar> const& sorted, double q) -> double
+    {
+        auto const i = static_cast<std::size_t>(q * static_cast<double>(sorted.size() - 1) + 0.5);
+        return sorted[i];
+    }
+} // namespace
+
+RunLog::RunLog(std::string const& path)
+    : out_(path, std::ios::binary | std::ios::trunc)
+{
+    std::uint64_t size{Magic.size() + 2 * sizeof(std::uint64_t)};
+    for (auto const* name : Columns) { size += sizeof(std::uint64_t) + std::char_traits<char>::length(name); }
+    auto const offset = (size + Alignment - 1) / Alignment * Alignment;
+
+    out_.write(Magic.data(), Magic.size());
+    Write(out_, offset);
+    Write(out_, Columns.size());
+    for (std::string_view name : Columns) {
+        Write(out_, name.size());
+        out_.write(name.data(), static_cast<std::streamsize>(name.size()));
+    }
+    for (auto i = size; i < offset; ++i) { out_.put('\0'); }
+    out_.flush();
+    if (!out_) { throw std::runtime_error(fmt::format("cannot write the run log {}", path)); }
+}
+
+auto RunLog::Append(ReportSnapshot& snapshot, Scores const& scores) -> void
+{
+    auto constexpr nan = std::numeric_limits<double>::quiet_NaN();
+    auto& fitness = snapshot.Fitness;
+    std::ranges::sort(fitness);
+
+    auto const& pop = snapshot.Population;
+    auto const& counters = snapshot.Stats;
+
+    std::array<double, Columns.size()> record {
+        static_cast<double>(snapshot.Run), static_cast<double>(snapshot.Generation), snapshot.Elapsed,
+        pop.Fitness.Min, pop.Fitness.Mean,
+        fitness.empty() ? nan : Quantile(fitness, 0.25),
+        fitness.empty() ? nan : Quantile(fitness, 0.5),
+        fitness.empty() ? nan : Quantile(fitness, 0.75),
+        pop.Length.Mean, pop.Length.Min, pop.Length.Max, pop.Depth.Mean, pop.Depth.Max, pop.Complexity.Mean,
+        static_cast<double>(counters.Calls), static_cast<double>(counters.Residual), static_cast<double>(counters.Jacobian), static_cast<double>(counters.SavedJacobians),
+        static_cast<double>(counters.CostTime), static_cast<double>(counters.CacheHits), static_cast<double>(counters.CacheMisses),
+        scores[0], scores[1], scores[2], scores[3], scores[4], scores[5]
+    };
+
+    std::scoped_lock lock(mutex_);
+    out_.write(reinterpret_cast<char const*>(record.data()), sizeof(record)); // NOLINT
+    out_.flush();
+    if (!out_) { throw std::runtime_error("cannot append to the run log"); }
+}
+
+} // namespace Operon
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_CLI_RUN_LOG_HPP
+#define OPERON_CLI_RUN_LOG_HPP
+
+#include <array>
+#include <cstddef>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+#include "reporter.hpp"
+
+namespace Operon {
+
+// binary log of the generations of one or more runs, one record per report
+// - header: the magic "OPRNLOG1", the offset of the first record and the number of columns (uint64), then the name
+//   of each column (uint64 length followed by the characters), padded with zeros to the offset
+// - records: one float64 per column (native byte order), in the order of Columns, appended as the reports arrive
+// - the records can be read as a matrix with one column per field, eg. with numpy:
+//   np.fromfile(path, dtype='f8', offset=offset).reshape(-1, columns)
+// - the file is only written by the reporter thread, the main loop only copies the snapshot (see MakeSnapshot)
+class RunLog {
+public:
+    static constexpr std::array Columns {
+        "run", "generation", "elapsed",
+        "best_fit", "avg_fit", "q25_fit", "median_fit", "q75_fit",
+        "avg_len", "min_len", "max_len", "avg_depth", "max_depth", "avg_complexity",
+        "eval_cnt", "res_eval", "jac_eval", "jac_saved", "opt_time", "cache_hits", "cache_misses",
+        "r2_tr", "r2_te", "mae_tr", "mae_te", "nmse_tr", "nmse_te"
+    };
+
+    // the scores of the best individual: r2_tr, r2_te, mae_tr, mae_te, nmse_tr, nmse_te
+    using Scores = std::array<double, 6>;
+
+    // creates (or replaces) the file and writes the header, throws std::runtime_error if it cannot be written
+    explicit RunLog(std::string const& path);
+
+    // appends the record of the snapshot, which must have been made with its values (the values are reordered)
+    // - may be called from several threads, the records are written whole
+    auto Append(ReportSnapshot& snapshot, Scores const& scores) -> void;
+
+private:
+    std::ofstream out_;
+    std::mutex mutex_;
+};
+
+} // namespace Operon
+
+#endif
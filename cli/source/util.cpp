@@ -19,6 +19,7 @@
 
 #include "operon/core/node.hpp"
 #include "operon/core/pset.hpp"
+#include "operon/core/profiler.hpp"
 #include "operon/core/version.hpp"
 #include "operon/core/types.hpp"
 
@@ -100,6 +101,27 @@ auto ParseRange(std::string const& str) -> std::pair<size_t, size_t>
     return std::make_pair(a, b);
 }
 
+auto ReadDataset(std::string const& path, bool owned, std::vector<std::string> const& columns) -> Dataset
+{
+#if defined(HAVE_ARROW)
+    if (Dataset::IsArrow(path)) {
+        return Dataset::ReadArrow(path, columns);
+    }
+#endif
+    if (!Dataset::IsBinary(path)) {
+        return Dataset::LoadCsv(path, { .HasHeader = true, .Columns = columns, .Threads = 0 });
+    }
+    // a view is enough when the data is not modified, since only the pages of the used columns are read
+    if (!owned) {
+        return Dataset::ReadBinary(path);
+    }
+    if (!columns.empty()) {
+        return Dataset::ReadBinary(path, columns);
+    }
+    auto ds = Dataset::ReadBinary(path);
+    return ds.IsView() ? ds.Select(ds.VariableHashes()) : ds;
+}
+
 auto ParsePrimitiveSetConfig(const std::string& options) -> PrimitiveSetConfig
 {
     auto config = static_cast<PrimitiveSetConfig>(0);
@@ -113,6 +135,34 @@ auto ParsePrimitiveSetConfig(const std::string& options) -> PrimitiveSetConfig
     return config;
 }
 
+// auto selects the best target supported by the cpu
+auto ParseDispatchTarget(std::string const& str) -> DispatchTarget
+{
+    if (str == "auto") {
+        return BestDispatchTarget();
+    }
+    if (auto target = Operon::ParseDispatchTarget(std::string_view{str}); target) {
+        return *target;
+    }
+    throw std::runtime_error(fmt::format("Unrecognized dispatch target {}\n", str));
+}
+
+auto ParseAffinityPolicy(std::string const& str) -> AffinityPolicy
+{
+    if (str == "none") { return AffinityPolicy::None; }
+    if (str == "compact") { return AffinityPolicy::Compact; }
+    if (str == "scatter") { return AffinityPolicy::Scatter; }
+    throw std::runtime_error(fmt::format("Unrecognized affinity policy {}\n", str));
+}
+
+auto ParseCoresetMethod(std::string const& str) -> CoresetMethod
+{
+    if (str == "stratified") { return CoresetMethod::Stratified; }
+    if (str == "kmeans") { return CoresetMethod::KMeans; }
+    if (str == "leverage") { return CoresetMethod::Leverage; }
+    throw std::runtime_error(fmt::format("Unrecognized coreset method {}\n", str));
+}
+
 auto PrintPrimitives(NodeType config) -> void
 {
     PrimitiveSet tmpSet;
@@ -153,6 +203,22 @@ auto PrintStats(std::vector<std::tuple<std::string, double, std::string>> const&
     fmt::print("\n");
 }
 
+auto PrintProfile(ProfileSummary const& summary) -> void
+{
+    uint64_t total{0};
+    for (auto const& s : summary) { total += s.Nanoseconds; }
+
+    // the times are summed over all the threads
+    fmt::print("{:<16} {:>12} {:>14} {:>8} {:>12}\n", "stage", "calls", "time", "share", "us/call");
+    for (auto i = 0UL; i < StageCount; ++i) {
+        auto const& s = summary[i];
+        if (s.Calls == 0) { continue; }
+        auto const share = 100.0 * static_cast<double>(s.Nanoseconds) / static_cast<double>(std::max(total, uint64_t{1}));
+        auto const perCall = static_cast<double>(s.Nanoseconds) / 1e3 / static_cast<double>(s.Calls);
+        fmt::print("{:<16} {:>12} {:>14} {:>7.2f}% {:>12.3f}\n", StageName(static_cast<Stage>(i)), s.Calls, FormatDuration(std::chrono::duration<double>(s.Seconds())), share, perCall);
+    }
+}
+
 auto InitOptions(std::string const& name, std::string const& desc, int width) -> cxxopts::Options
 {
     cxxopts::Options opts(name, desc);
@@ -161,9 +227,11 @@ auto InitOptions(std::string const& name, std::string const& desc, int width) ->
     std::string const symbols = "add, sub, mul, div, exp, log, square, sqrt, cbrt, sin, cos, tan, asin, acos, atan, sinh, cosh, tanh, abs, aq, ceil, floor, fmin, fmax, log1p, logabs, sqrtabs";
 
     opts.add_options()
-        ("dataset", "Dataset file name (csv) (required)", cxxopts::value<std::string>())
+        ("dataset", "Dataset file name (csv, binary, or arrow/parquet when available, see operon_convert) (required)", cxxopts::value<std::string>())
         ("shuffle", "Shuffle the input data", cxxopts::value<bool>()->default_value("false"))
         ("standardize", "Standardize the training partition (zero mean, unit variance)", cxxopts::value<bool>()->default_value("false"))
+        ("lazy-standardize", "Standardize by transforming the inputs when they are read instead of rewriting the data (with --standardize)", cxxopts::value<bool>()->default_value("false"))
+        ("encode-columns", "Dictionary-encode the variables with at most this many distinct values (up to 65536), the evaluation then reads their codes instead of their columns (0 disables it)", cxxopts::value<size_t>()->default_value("0"))
         ("train", "Training range specified as start:end (required)", cxxopts::value<std::string>())
         ("test", "Test range specified as start:end", cxxopts::value<std::string>())
         ("target", "Name of the target variable (required)", cxxopts::value<std::string>())
@@ -189,16 +257,59 @@ auto InitOptions(std::string const& name, std::string const& desc, int width) ->
         ("creator-maxlength", "Maximum tree length (applies to all tree creators)", cxxopts::value<std::size_t>()->default_value("50"))
         ("female-selector", "Female selection operator, with optional parameters separated by : (eg, --selector tournament:5)", cxxopts::value<std::string>()->default_value("tournament"))
         ("male-selector", "Male selection operator, with optional parameters separated by : (eg, --selector tournament:5)", cxxopts::value<std::string>()->default_value("tournament"))
+        ("case-rows", "The training rows on which the errors are captured for the lexicase selector, which draws lexicase:<cases> of them each generation (eg. --female-selector lexicase:100, 0 = all the training rows)", cxxopts::value<size_t>()->default_value("1000"))
         ("offspring-generator", "OffspringGenerator operator, with optional parameters separated by : (eg --offspring-generator brood:10:10)", cxxopts::value<std::string>()->default_value("basic"))
         ("reinserter", "Reinsertion operator merging offspring in the recombination pool back into the population", cxxopts::value<std::string>()->default_value("keep-best"))
         ("enable-symbols", "Comma-separated list of enabled symbols ("+symbols+")", cxxopts::value<std::string>())
+        ("max-lag", "Read each variable of the created trees up to this many rows before the current row, for time series (0 = no lags)", cxxopts::value<size_t>()->default_value("0"))
         ("local-search-probability", "Probability for local search", cxxopts::value<Operon::Scalar>()->default_value("1.0"))
         ("lamarckian-probability", "Probability that the local search improvements are saved back into the chromosome", cxxopts::value<Operon::Scalar>()->default_value("1.0"))
+        ("adaptive-iterations", "Run the local search in rounds of this many iterations and stop when the relative improvement becomes small (0 = fixed iteration count)", cxxopts::value<size_t>()->default_value("0"))
+        ("structure-cache", "Keep the best coefficients of this many tree structures and start the local search of a tree from those of its structure, a structure whose coefficients no longer improve is not optimized again, the local search then uses the normal equations solver, which also starts from the trust region of the structure (0 = disabled)", cxxopts::value<size_t>()->default_value("0"))
+        ("variable-projection", "Solve for the linear coefficients of the models in closed form and run the local search on the other coefficients only (gp only)", cxxopts::value<bool>()->default_value("false"))
+        ("batched-local-search", "Optimize the coefficients of the offspring of each generation together, after they are generated", cxxopts::value<bool>()->default_value("false"))
+        ("surrogate-rows", "Screen the children of offspring selection by evaluating them on the first rows of the training range (of the coreset, see --coreset-rows) first (0 = disabled)", cxxopts::value<size_t>()->default_value("0"))
+        ("surrogate-tolerance", "Discard a screened child if its predicted fitness is worse than the comparison fitness by more than this fraction", cxxopts::value<double>()->default_value("0.1"))
+        ("coreset-rows", "Run the search on a weighted subset of this many representative training rows, the final models are ranked and assessed on the whole training range (0 = disabled)", cxxopts::value<size_t>()->default_value("0"))
+        ("coreset-method", "Selection of the coreset rows (stratified: on the target, kmeans: D^2 sampling of the inputs, leverage: leverage scores of the inputs)", cxxopts::value<std::string>()->default_value("stratified"))
+        ("semantic-rows", "Hash the outputs of the models on this many training rows and treat models with the same hash as duplicates (0 = disabled, residual error objectives only)", cxxopts::value<size_t>()->default_value("0"))
+        ("simplify", "Simplify the children (constant folding, neutral elements, nested operations) before they are optimized and evaluated", cxxopts::value<bool>()->default_value("false"))
+        ("reject-duplicates", "Generate a child again if its genotype duplicates a parent or an earlier child of the same generation, a duplicate that remains after the retries keeps the fitness of the original", cxxopts::value<bool>()->default_value("false"))
+        ("duplicate-retries", "Number of times a duplicate child is generated again (see reject-duplicates)", cxxopts::value<size_t>()->default_value("3"))
+        ("unique-init", "Create a tree of the initial population again if its genotype (without the coefficients) duplicates another one", cxxopts::value<bool>()->default_value("false"))
+        ("pooled-generation", "Let every worker fill the next free offspring slot until the pool is full, instead of retrying each slot until it is filled (gp only)", cxxopts::value<bool>()->default_value("false"))
+        ("cost-objective", "Minimize the evaluation cost of the models on this machine (calibrated at startup) instead of their length (nsgp only)", cxxopts::value<bool>()->default_value("false"))
+        ("max-cost", "Reject the models whose estimated evaluation cost exceeds this many nanoseconds per row, implies --cost-objective (0 = no limit, nsgp only)", cxxopts::value<double>()->default_value("0"))
+        ("pipelined", "Generate the offspring of the next generation while the population is sorted, selecting from the ranks of the current generation (nsgp only)", cxxopts::value<bool>()->default_value("false"))
+        ("deterministic", "Make the results independent of the number of threads (the termination criteria are only checked between generations)", cxxopts::value<bool>()->default_value("false"))
+        ("huge-pages", "Back the dataset and the evaluation buffers with transparent huge pages (linux)", cxxopts::value<bool>()->default_value("false"))
+        ("memory-limit", "Choose the evaluation group size and the local search (full jacobian or blocked normal equations) to stay within this many MiB, the memory used by the run is printed at the end (0 = no limit, gp only)", cxxopts::value<size_t>()->default_value("0"))
         ("disable-symbols", "Comma-separated list of disabled symbols ("+symbols+")", cxxopts::value<std::string>())
         ("symbolic", "Operate in symbolic mode - no coefficient tuning or coefficient mutation", cxxopts::value<bool>()->default_value("false"))
         ("show-primitives", "Display the primitive set used by the algorithm")
         ("threads", "Number of threads to use for parallelism", cxxopts::value<size_t>()->default_value("0"))
+        ("elastic", "Use fewer workers in a generation when the other processes keep cores busy, from the load average of the machine (gp only)", cxxopts::value<bool>()->default_value("false"))
+        ("affinity", "Pin the worker threads to the cores (none, compact: fill a NUMA node before the next, scatter: alternate between the NUMA nodes)", cxxopts::value<std::string>()->default_value("none"))
+        ("runs", "Number of independent runs (seeds seed, seed + 1, ...) sharing the dataset and the executor, the result of each run and the distribution of the scores are printed (gp only)", cxxopts::value<size_t>()->default_value("1"))
+        ("concurrent-runs", "Number of runs executed at the same time (with --runs, 0 = one per thread)", cxxopts::value<size_t>()->default_value("0"))
+        ("approximate", "Use fast approximations of the transcendental primitives during the search, with the given precision (0, 1 or 2). The reported models are evaluated with exact primitives", cxxopts::value<int>())
+        ("approximate-symbols", "Comma-separated list of the primitives approximated with --approximate (default: all of them), eg. exp,tanh keeps the exact log and pow", cxxopts::value<std::string>())
+        ("dispatch", "Instruction set target for the primitives (auto, baseline, x86-64-v2, x86-64-v3, x86-64-v4)", cxxopts::value<std::string>()->default_value("auto"))
+        ("tune-batch-size", "Time the interpreter with several batch sizes at startup and evaluate each model with the fastest one for its length, the tuned primitives are compiled for the build target (--dispatch does not apply to them)", cxxopts::value<bool>()->default_value("false"))
+        ("checkpoint", "Write checkpoints of the run to this file (binary, written in the background)", cxxopts::value<std::string>())
+        ("checkpoint-interval", "Generations between two checkpoints", cxxopts::value<size_t>()->default_value("10"))
+        ("resume", "Resume the run from a checkpoint (the other options must be the same as for the checkpointed run)", cxxopts::value<std::string>())
         ("timelimit", "Time limit after which the algorithm will terminate", cxxopts::value<size_t>()->default_value(std::to_string(std::numeric_limits<size_t>::max())))
+        ("stagnation", "Stop when the best fitness did not improve for this many generations (0 = disabled)", cxxopts::value<size_t>()->default_value("0"))
+        ("target-fitness", "Stop when the best fitness (first objective) reaches this value", cxxopts::value<double>())
+        ("min-diversity", "Stop when the structural diversity of the population falls below this value (0 = disabled)", cxxopts::value<double>()->default_value("0"))
+        ("diversity-interval", "Generations between two computations of the diversity (quadratic in the population size)", cxxopts::value<size_t>()->default_value("10"))
+        ("validation", "Validation range specified as start:end, the best models of each generation are evaluated on it in the background (gp only)", cxxopts::value<std::string>())
+        ("validation-patience", "Stop when the best validation fitness did not improve for this many validated generations (0 = disabled)", cxxopts::value<size_t>()->default_value("0"))
+        ("profile", "Time the stages of the main loop (selection, crossover, mutation, local search, evaluation, ...) and print a summary at the end")
+        ("trace", "Record on which worker and when the tasks of the run are executed and write the timelines to this file (chrome trace format)", cxxopts::value<std::string>())
+        ("run-log", "Write the statistics of each generation (fitness quantiles, lengths, evaluator counters, scores, timing) to this file as binary records", cxxopts::value<std::string>())
+        ("metrics", "Write the evaluation throughput of each generation to this file (OpenMetrics text format, replaced every generation)", cxxopts::value<std::string>())
         ("debug", "Debug mode (more information displayed)")
         ("help", "Print help")
         ("version", "Print version and program information");
@@ -231,4 +342,39 @@ auto ParseOptions(cxxopts::Options&& opts, int argc, char** argv) -> cxxopts::Pa
     }
     return result;
 }
+auto SetupCheckpoints(GeneticAlgorithmBase& algorithm, cxxopts::ParseResult const& result) -> std::unique_ptr<CheckpointWriter>
+{
+    if (result.count("resume") > 0) {
+        algorithm.Restore(ReadCheckpoint(result["resume"].as<std::string>()));
+    }
+    if (result.count("checkpoint") == 0) { return nullptr; }
+    auto writer = std::make_unique<CheckpointWriter>(result["checkpoint"].as<std::string>(), result["checkpoint-interval"].as<size_t>());
+    algorithm.SetCheckpointWriter(writer.get());
+    return writer;
+}
+
+auto ParseTerminationCriteria(cxxopts::ParseResult const& result, GeneticAlgorithmConfig& config) -> void
+{
+    config.StagnationGenerations = result["stagnation"].as<size_t>();
+    if (result.count("target-fitness") > 0) { config.TargetFitness = result["target-fitness"].as<double>(); }
+    config.MinimumDiversity = result["min-diversity"].as<double>();
+    config.DiversityInterval = result["diversity-interval"].as<size_t>();
+}
+
+auto TuneBatchSize(DefaultBatchSizeTuner& tuner, Problem const& problem, CreatorBase const& creator, CoefficientInitializerBase const& coeffInitializer, std::size_t minLength, std::size_t maxLength, std::size_t maxDepth, RandomGenerator::result_type seed) -> void
+{
+    constexpr std::size_t treesPerLength{4};
+    Operon::RandomGenerator rng{seed};
+    std::vector<Operon::Tree> trees;
+    for (auto length = std::max(minLength, std::size_t{1}); length <= maxLength; ++length) {
+        for (auto i = 0UL; i < treesPerLength; ++i) {
+            auto tree = creator(rng, length, /*minDepth=*/1, maxDepth);
+            coeffInitializer(rng, tree);
+            trees.push_back(std::move(tree));
+        }
+    }
+    auto const range = problem.TrainingRange();
+    tuner.Tune(trees, problem.GetDataset(), Operon::Range{range.Start(), range.Start() + std::min(range.Size(), TuningRows)});
+}
+
 } // namespace Operon
@@ -8,27 +8,58 @@
 #include <cstddef>
 #include <cxxopts.hpp>
 #include <fmt/core.h>
+#include <memory>
 #include <string>
 #include <tuple>
 #include <utility>
 #include <vector>
 
+#include "operon/algorithms/checkpoint.hpp"
+#include "operon/algorithms/ga_base.hpp"
+#include "operon/core/affinity.hpp"
+#include "operon/core/coreset.hpp"
+#include "operon/core/dataset.hpp"
 #include "operon/core/node.hpp"
+#include "operon/core/problem.hpp"
+#include "operon/core/profiler.hpp"
+#include "operon/interpreter/batch_tuning.hpp"
+#include "operon/interpreter/cpu_dispatch.hpp"
+#include "operon/operators/creator.hpp"
+#include "operon/operators/initializer.hpp"
 
 namespace Operon {
 
 constexpr int optionsWidth = 200;
 
 auto ParseRange(std::string const& str) -> std::pair<size_t, size_t>;
+// reads a csv (with header), binary or arrow/parquet dataset, binary datasets are memory-mapped unless owned is true
+// - only the given columns of a csv or arrow/parquet file are loaded (all of them if empty)
+auto ReadDataset(std::string const& path, bool owned, std::vector<std::string> const& columns = {}) -> Dataset;
 auto Split(const std::string& s, char delimiter) -> std::vector<std::string>;
 auto FormatBytes(size_t bytes) -> std::string;
 auto FormatDuration(std::chrono::duration<double> d) -> std::string;
 auto ParsePrimitiveSetConfig(const std::string& options) -> NodeType;
 auto PrintPrimitives(PrimitiveSetConfig config) -> void;
+auto ParseDispatchTarget(std::string const& str) -> DispatchTarget;
+auto ParseAffinityPolicy(std::string const& str) -> AffinityPolicy;
+auto ParseCoresetMethod(std::string const& str) -> CoresetMethod;
 auto PrintStats(std::vector<std::tuple<std::string, double, std::string>> const& stats, bool printHeader = true) -> void;
+// one line per stage with the number of calls, the time and its share of the total time
+auto PrintProfile(ProfileSummary const& summary) -> void;
 
 auto InitOptions(std::string const& name, std::string const& desc, int width = optionsWidth) -> cxxopts::Options;
 auto ParseOptions(cxxopts::Options&& opts, int argc, char** argv) -> cxxopts::ParseResult;
 
+// restores the algorithm from --resume and returns the writer for --checkpoint (null if not given)
+auto SetupCheckpoints(GeneticAlgorithmBase& algorithm, cxxopts::ParseResult const& result) -> std::unique_ptr<CheckpointWriter>;
+
+// sets the convergence based termination criteria of the config (--stagnation, --target-fitness, --min-diversity)
+auto ParseTerminationCriteria(cxxopts::ParseResult const& result, GeneticAlgorithmConfig& config) -> void;
+
+// tunes the batch size of the interpreter (--tune-batch-size) on trees of the creator with lengths in [minLength, maxLength]
+// - the trees are evaluated on the first rows of the training range of the problem (at most TuningRows)
+inline constexpr std::size_t TuningRows{16384};
+auto TuneBatchSize(DefaultBatchSizeTuner& tuner, Problem const& problem, CreatorBase const& creator, CoefficientInitializerBase const& coeffInitializer, std::size_t minLength, std::size_t maxLength, std::size_t maxDepth, RandomGenerator::result_type seed) -> void;
+
 } // namespace Operon
 #endif
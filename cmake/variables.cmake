@@ -12,12 +12,20 @@ if(PROJECT_IS_TOP_LEVEL)
   set(JEMALLOC_DESCRIPTION             "Link against jemalloc, a general purpose malloc(3) implementation that emphasizes fragmentation avoidance and scalable concurrency support [default=OFF].")
   set(USE_SINGLE_PRECISION_DESCRIPTION "Perform model evaluation using floats (single precision) instead of doubles. Great for reducing runtime, might not be appropriate for all purposes [default=OFF].")
   set(USE_CERES_DESCRIPTION            "Use the non-linear least squares optimizer from Ceres solver to tune model coefficients (if OFF, Eigen::LevenbergMarquardt will be used instead).")
+  set(USE_MPI_DESCRIPTION              "Use MPI to exchange migrants between the islands of the island model running on different ranks [default=OFF].")
+  set(USE_ARROW_DESCRIPTION            "Use Apache Arrow to read datasets in the Arrow IPC and Parquet formats [default=OFF].")
+  set(USE_CUDA_DESCRIPTION             "Evaluate populations on a CUDA device (requires the CUDA toolkit) [default=OFF].")
+  set(USE_HARDWARE_COUNTERS_DESCRIPTION "Sample the hardware performance counters around the evaluation kernels (linux perf_event) [default=OFF].")
   set(MATH_BACKEND_DESCRIPTION         "Math library for tree evaluation (defaults to Eigen)")
 
   # option descriptions
   option(USE_JEMALLOC         ${JEMALLOC_DESCRIPTION}             OFF)
   option(USE_SINGLE_PRECISION ${USE_SINGLE_PRECISION_DESCRIPTION}  ON)
   option(USE_CERES            ${USE_CERES_DESCRIPTION}            OFF)
+  option(USE_MPI              ${USE_MPI_DESCRIPTION}              OFF)
+  option(USE_ARROW            ${USE_ARROW_DESCRIPTION}            OFF)
+  option(USE_CUDA             ${USE_CUDA_DESCRIPTION}             OFF)
+  option(USE_HARDWARE_COUNTERS ${USE_HARDWARE_COUNTERS_DESCRIPTION} OFF)
   option(MATH_BACKEND         ${MATH_BACKEND_DESCRIPTION}      "Eigen")
 
   # provide a summary of configured options
@@ -25,6 +33,10 @@ if(PROJECT_IS_TOP_LEVEL)
   add_feature_info(USE_JEMALLOC         USE_JEMALLOC             ${JEMALLOC_DESCRIPTION})
   add_feature_info(USE_SINGLE_PRECISION USE_SINGLE_PRECISION     ${USE_SINGLE_PRECISION_DESCRIPTION})
   add_feature_info(USE_CERES            USE_CERES                ${USE_CERES_DESCRIPTION})
+  add_feature_info(USE_MPI              USE_MPI                  ${USE_MPI_DESCRIPTION})
+  add_feature_info(USE_ARROW            USE_ARROW                ${USE_ARROW_DESCRIPTION})
+  add_feature_info(USE_CUDA             USE_CUDA                 ${USE_CUDA_DESCRIPTION})
+  add_feature_info(USE_HARDWARE_COUNTERS USE_HARDWARE_COUNTERS   ${USE_HARDWARE_COUNTERS_DESCRIPTION})
   add_feature_info(MATH_BACKEND         MATH_BACKEND_DESCRIPTION ${MATH_BACKEND_DESCRIPTION})
   set(CMAKE_EXPORT_COMPILE_COMMANDS ON CACHE INTERNAL "")
   if(CMAKE_EXPORT_COMPILE_COMMANDS)
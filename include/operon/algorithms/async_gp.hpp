@@ -0,0 +1,61 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_ASYNC_GP_HPP
+#define OPERON_ASYNC_GP_HPP
+
+#include <cstddef>                         // for size_t
+#include <functional>                      // for reference_wrapper, function
+#include <operon/operon_export.hpp>        // for OPERON_EXPORT
+#include <thread>                          // for thread
+#include <utility>                         // for move
+
+#include "operon/algorithms/config.hpp"    // for GeneticAlgorithmConfig
+#include "operon/algorithms/ga_base.hpp"
+#include "operon/core/affinity.hpp"         // for AffinityPolicy
+#include "operon/core/individual.hpp"      // for Individual
+#include "operon/core/types.hpp"           // for Span, Vector, RandomGenerator
+#include "operon/operators/evaluator.hpp"  // for EvaluatorBase
+#include "operon/operators/generator.hpp"  // for OffspringGeneratorBase
+
+// forward declaration
+namespace tf { class Executor; }
+
+namespace Operon {
+
+class Problem;
+class ReinserterBase;
+struct CoefficientInitializerBase;
+struct TreeInitializerBase;
+
+// steady-state genetic programming without generational barriers
+// - every worker repeatedly selects two parents, generates and evaluates one child and inserts it into the population,
+//   so a slow individual (eg. a large tree with local search) only stalls its own worker
+// - the population is guarded by a mutex that is only held while inserting the child
+// - the parents are selected from a copy of the population, taken every few insertions (one per worker), the selectors
+//   are prepared with it outside of the population lock
+// - the child is inserted with the reinserter (using a pool of one individual)
+// - a generation is counted every PoolSize insertions: the report callback is invoked (while the population is
+//   locked) and the generator is prepared again with the next copy
+// - the parents are selected by the algorithm, so the child is produced by OffspringGeneratorBase::Generate
+//   (the acceptance rules of the brood and offspring selection generators do not apply)
+class OPERON_EXPORT AsyncGeneticProgrammingAlgorithm : public GeneticAlgorithmBase {
+public:
+    AsyncGeneticProgrammingAlgorithm(Problem const& problem, GeneticAlgorithmConfig const& config, TreeInitializerBase const& treeInit, CoefficientInitializerBase const& coeffInit, OffspringGeneratorBase const& generator, ReinserterBase const& reinserter)
+        : GeneticAlgorithmBase(problem, config, treeInit, coeffInit, generator, reinserter)
+    {
+    }
+
+    // number of children inserted into the population since the start of the run
+    [[nodiscard]] auto Insertions() const -> size_t { return insertions_; }
+
+    auto Run(tf::Executor& /*executor*/, Operon::RandomGenerator&/*rng*/, std::function<void()> /*report*/ = nullptr) -> void;
+    // runs on a new executor whose workers are pinned to the cores under the affinity policy
+    auto Run(Operon::RandomGenerator& /*rng*/, std::function<void()> /*report*/ = nullptr, size_t /*threads*/= 0, AffinityPolicy /*affinity*/ = AffinityPolicy::None) -> void;
+
+private:
+    size_t insertions_{0};
+};
+} // namespace Operon
+
+#endif
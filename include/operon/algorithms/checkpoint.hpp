@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_ALGORITHMS_CHECKPOINT_HPP
+#define OPERON_ALGORITHMS_CHECKPOINT_HPP
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iosfwd>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "operon/core/individual.hpp"
+#include "operon/core/types.hpp"
+#include "operon/operon_export.hpp"
+
+namespace Operon {
+
+// the state of a generational algorithm between two generations, enough to resume the run
+// (see GeneticAlgorithmBase::Restore)
+// - the run has to be resumed with the same configuration, problem and operators
+struct AlgorithmState {
+    using RandomState = Operon::RandomGenerator::state_type;
+
+    std::size_t Generation{0};
+    double Elapsed{0}; // seconds spent so far, counted against the time limit
+    RandomState Random{};          // the generator passed to Run
+    std::vector<RandomState> Rngs; // the generators of the individuals
+    // residual evaluations, jacobian evaluations, call count and saved jacobian evaluations of the evaluator
+    std::array<uint64_t, 4> Counters{};
+    Operon::Vector<Individual> Parents;
+};
+
+// binary checkpoint files: a versioned header followed by the state, with the parents encoded like
+// Serialization::WritePopulation
+constexpr uint32_t CheckpointVersion{1};
+auto OPERON_EXPORT WriteCheckpoint(std::ostream& out, AlgorithmState const& state) -> void;
+auto OPERON_EXPORT ReadCheckpoint(std::istream& in) -> AlgorithmState;
+auto OPERON_EXPORT ReadCheckpoint(std::string const& path) -> AlgorithmState;
+
+// writes checkpoints to a file on a background thread, so that the main loop does not wait for the disk
+// - Submit hands a state over and returns, a state that is still pending is replaced by the newer one
+// - the file is written to a temporary path and renamed, a run that is killed during a write keeps the previous checkpoint
+// - an error in the background thread is rethrown by the next call to Submit or Wait
+class OPERON_EXPORT CheckpointWriter {
+public:
+    CheckpointWriter(std::string path, std::size_t interval);
+    CheckpointWriter(CheckpointWriter const&) = delete;
+    CheckpointWriter(CheckpointWriter&&) = delete;
+    auto operator=(CheckpointWriter const&) -> CheckpointWriter& = delete;
+    auto operator=(CheckpointWriter&&) -> CheckpointWriter& = delete;
+    ~CheckpointWriter(); // writes the pending state, if any
+
+    // generations between two checkpoints
+    [[nodiscard]] auto Interval() const -> std::size_t { return interval_; }
+    [[nodiscard]] auto Path() const -> std::string const& { return path_; }
+
+    auto Submit(AlgorithmState state) -> void;
+
+    // blocks until the submitted states are written
+    auto Wait() -> void;
+
+    // number of checkpoints written so far
+    [[nodiscard]] auto Count() const -> std::size_t;
+
+private:
+    auto Work() -> void;
+    auto Rethrow() -> void;
+
+    std::string path_;
+    std::size_t interval_;
+    std::size_t count_{0};
+    std::optional<AlgorithmState> pending_;
+    std::exception_ptr error_;
+    bool busy_{false};
+    bool stop_{false};
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread thread_;
+};
+
+} // namespace Operon
+
+#endif
@@ -5,6 +5,7 @@
 #define OPERON_ALGORITHM_CONFIG_HPP
 
 #include <cstddef>
+#include <limits>
 
 namespace Operon {
 struct GeneticAlgorithmConfig {
@@ -20,6 +21,17 @@ struct GeneticAlgorithmConfig {
     double LocalSearchProbability{1.0};
     double LamarckianProbability{1.0};
     double Epsilon{0};     // used when comparing fitness values
+    bool BatchedLocalSearch{false}; // optimize the offspring of a generation together after they are generated, and evaluate them once optimized (see GeneticProgrammingAlgorithm::Run)
+    bool PooledGeneration{false}; // the workers produce children for the next free offspring slot until the pool is full (see GeneticProgrammingAlgorithm::Run)
+    bool CostScheduling{true}; // evaluate the most expensive groups of individuals first and hand out the offspring slots one at a time (see detail::ScheduleGroups)
+    bool PipelinedSorting{false}; // NSGA2: generate the offspring of the next generation from the ranks of the current one while the merged population is sorted (see NSGA2::Run)
+    bool Deterministic{false}; // results that do not depend on the number of threads or on the timing of the workers (see GeneticAlgorithmBase::SeedStreams)
+    // convergence based termination criteria, checked between generations (see TerminationCriteria)
+    size_t StagnationGenerations{0}; // stop when the best fitness did not improve by more than Epsilon for this many generations (0 = disabled)
+    double TargetFitness{std::numeric_limits<double>::lowest()}; // stop when the best fitness reaches this value
+    double MinimumDiversity{0}; // stop when the structural diversity of the population falls below this value (0 = disabled)
+    size_t DiversityInterval{10}; // generations between two computations of the diversity
+    bool HugePages{false}; // back the dataset values and the evaluation buffers of the workers with transparent huge pages (see AdviseHugePages)
 };
 } // namespace Operon
 
@@ -4,15 +4,26 @@
 #ifndef GA_BASE_HPP
 #define GA_BASE_HPP
 
+#include <algorithm>
+#include <cstdint>
+#include <fmt/core.h>
 #include <functional>
 #include <operon/operon_export.hpp>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "operon/core/memory.hpp"
 #include "operon/operators/generator.hpp"
+#include "checkpoint.hpp"
 #include "config.hpp"
 
 namespace Operon {
 
 class Problem;
 class ReinserterBase;
+class TaskTrace;
+class ValidationMonitor;
 struct CoefficientInitializerBase;
 struct TreeInitializerBase;
 
@@ -63,6 +74,160 @@ public:
         GetGenerator().Evaluator().Reset();
     }
 
+    // checkpoints are submitted to the writer every writer->Interval() generations by Run (nullptr disables them)
+    auto SetCheckpointWriter(CheckpointWriter* writer) -> void { checkpoint_ = writer; }
+    [[nodiscard]] auto GetCheckpointWriter() const -> CheckpointWriter* { return checkpoint_; }
+
+    // the algorithms count the offspring of each worker and mark the end of every generation in the trace, to
+    // record the per-worker load (see TaskTrace::Mark), nullptr disables it
+    auto SetTaskTrace(TaskTrace* trace) -> void { trace_ = trace; }
+    [[nodiscard]] auto GetTaskTrace() const -> TaskTrace* { return trace_; }
+
+    // the best individuals of every generation are submitted to the monitor, which validates them in the background
+    // and may stop the run early (see ValidationMonitor), nullptr disables it
+    auto SetValidation(ValidationMonitor* validation) -> void { validation_ = validation; }
+    [[nodiscard]] auto GetValidation() const -> ValidationMonitor* { return validation_; }
+
+    // the number of workers that take part in the next generation, given the number of workers of the executor
+    // - asked before each generation, the result is clamped to [1, workers], the other workers of the executor sleep
+    // - eg. LoadAverageLimit, or a value that is changed from another thread (a signal, a control socket)
+    // - the offspring generation, the batched local search and the non-dominated sort of NSGA2 are limited, the
+    //   reinsertion is a single task; the initial population is evaluated by all the workers
+    // - the copies of a LoadAverageLimit given to the concurrent runs of a process share the cores between them
+    using WorkerLimit = std::function<size_t(size_t)>;
+    auto SetWorkerLimit(WorkerLimit limit) -> void { workerLimit_ = std::move(limit); }
+    [[nodiscard]] auto GetWorkerLimit() const -> WorkerLimit const& { return workerLimit_; }
+
+    // the bytes held by the run, by subsystem (see MemoryUsage)
+    // - the buffers of the workers are recorded by Run before each report, they are zero before the first report
+    // - the jacobian is the working memory of the local search of the largest tree of the parents on every worker,
+    //   as estimated by the optimizer (see OptimizerBase::WorkingMemory), zero without a local search
+    [[nodiscard]] auto GetMemoryUsage() const -> Operon::MemoryUsage
+    {
+        Operon::MemoryUsage usage;
+        auto const& dataset = GetProblem().GetDataset();
+        if (!dataset.IsView()) { usage.Dataset = dataset.Rows<std::size_t>() * dataset.Cols<std::size_t>() * sizeof(Operon::Scalar); }
+        usage.Population = PopulationBytes(individuals_);
+        usage.Buffers = bufferBytes_;
+        if (auto const* optimizer = GetGenerator().Optimizer(); optimizer != nullptr) {
+            std::size_t coefficients{0};
+            for (auto const& p : parents_) { coefficients = std::max(coefficients, static_cast<std::size_t>(p.Genotype.CoefficientsCount())); }
+            usage.Jacobian = std::max(workers_, std::size_t{1}) * optimizer->Optimizer().WorkingMemory(coefficients);
+        }
+        return usage;
+    }
+
+    // the next call to Run continues from the saved state instead of initializing a new population
+    auto Restore(AlgorithmState state) -> void
+    {
+        if (state.Parents.size() != parents_.size()) {
+            throw std::invalid_argument(fmt::format("the checkpoint has {} parents but the population size is {}", state.Parents.size(), parents_.size()));
+        }
+        restore_ = std::move(state);
+    }
+
+    // the number of attempts of an offspring slot to produce a child in a deterministic run
+    static constexpr size_t DeterministicAttempts{100};
+
+    // the number of attempts of a worker between two checks of the termination criteria in a pooled generation
+    static constexpr size_t StopCheckInterval{16};
+
+    // the bytes of the individuals with the nodes of their trees and their fitness
+    // - the copies of a tree share its nodes (see Tree), a node buffer is only counted the first time it is seen
+    // - counted holds the buffers that were already counted (eg. by an earlier call for another population)
+    static auto PopulationBytes(Operon::Span<Individual const> individuals, Operon::Set<void const*>& counted) -> std::size_t
+    {
+        auto bytes{individuals.size() * sizeof(Individual)};
+        for (auto const& ind : individuals) {
+            auto const& nodes = ind.Genotype.Nodes();
+            if (counted.insert(&nodes).second) { bytes += nodes.capacity() * sizeof(Node); }
+            bytes += ind.Fitness.capacity() * sizeof(Operon::Scalar);
+        }
+        return bytes;
+    }
+
+    static auto PopulationBytes(Operon::Span<Individual const> individuals) -> std::size_t
+    {
+        Operon::Set<void const*> counted;
+        return PopulationBytes(individuals, counted);
+    }
+
+protected:
+
+    // called by Run before each report with the workers of the executor and the bytes of its buffers
+    auto RecordMemory(std::size_t workers, std::size_t bufferBytes) -> void
+    {
+        workers_ = workers;
+        bufferBytes_ = bufferBytes;
+    }
+
+    // the workers of the next generation (see SetWorkerLimit)
+    [[nodiscard]] auto ActiveWorkers(size_t workers) const -> size_t
+    {
+        return workerLimit_ ? std::clamp(std::invoke(workerLimit_, workers), size_t{1}, workers) : workers;
+    }
+
+    // in a deterministic run (see GeneticAlgorithmConfig::Deterministic) the generator of each offspring slot is
+    // seeded at the start of a generation from (key, generation, slot), with a counter-based function
+    // - the stream of a slot does not depend on the values consumed in the previous generations (eg. by retries)
+    // - the termination criteria are only checked between generations, and a slot makes at most
+    //   DeterministicAttempts attempts, so that a generation does not depend on the timing of the other workers
+    // - the evaluation budget can be exceeded by up to one generation, a time limit stops the run at a generation
+    //   boundary that depends on the speed of the machine
+    // - ahead selects the streams of a later generation (eg. the offspring of the next generation, generated ahead by a
+    //   pipelined NSGA2)
+    auto SeedStreams(uint64_t key, std::vector<Operon::RandomGenerator>& rngs, size_t ahead = 0) const -> void
+    {
+        if (!GetConfig().Deterministic) { return; }
+        for (auto i = 0UL; i < rngs.size(); ++i) {
+            rngs[i] = Operon::RandomGenerator(Random::Philox(key, generation_ + ahead, i)[0]);
+        }
+    }
+
+    // the state of the run after the current generation
+    [[nodiscard]] auto Capture(Operon::RandomGenerator const& random, std::vector<Operon::RandomGenerator> const& rngs, double elapsed) const -> AlgorithmState
+    {
+        auto const& evaluator = GetGenerator().Evaluator();
+        AlgorithmState state;
+        state.Generation = generation_;
+        state.Elapsed = elapsed;
+        state.Random = random.get_state();
+        state.Rngs.reserve(rngs.size());
+        for (auto const& r : rngs) { state.Rngs.push_back(r.get_state()); }
+        state.Counters = { evaluator.ResidualEvaluations.load(), evaluator.JacobianEvaluations.load(), evaluator.CallCount.load(), evaluator.SavedJacobianEvaluations.load() };
+        state.Parents.assign(parents_.begin(), parents_.end());
+        return state;
+    }
+
+    // called by Run after each generation, only the copy of the state is made on the calling thread
+    auto Checkpoint(Operon::RandomGenerator const& random, std::vector<Operon::RandomGenerator> const& rngs, double elapsed) const -> void
+    {
+        if (checkpoint_ != nullptr && generation_ % checkpoint_->Interval() == 0) {
+            checkpoint_->Submit(Capture(random, rngs, elapsed));
+        }
+    }
+
+    // applies the state given to Restore (if any) and returns the time already spent by the restored run
+    auto Resume(Operon::RandomGenerator& random, std::vector<Operon::RandomGenerator>& rngs) -> std::optional<double>
+    {
+        if (!restore_) { return std::nullopt; }
+        auto state = std::move(*restore_);
+        restore_.reset();
+        if (state.Rngs.size() != rngs.size()) {
+            throw std::invalid_argument(fmt::format("the checkpoint has {} random generators but the run needs {}", state.Rngs.size(), rngs.size()));
+        }
+        generation_ = state.Generation;
+        random.set_state(state.Random);
+        for (auto i = 0UL; i < rngs.size(); ++i) { rngs[i].set_state(state.Rngs[i]); }
+        auto const& evaluator = GetGenerator().Evaluator();
+        evaluator.ResidualEvaluations = state.Counters[0];
+        evaluator.JacobianEvaluations = state.Counters[1];
+        evaluator.CallCount = state.Counters[2];
+        evaluator.SavedJacobianEvaluations = state.Counters[3];
+        std::move(state.Parents.begin(), state.Parents.end(), parents_.begin());
+        return state.Elapsed;
+    }
+
 private:
     std::reference_wrapper<const Problem> problem_;
     std::reference_wrapper<const GeneticAlgorithmConfig> config_;
@@ -76,6 +241,13 @@ private:
     Operon::Span<Individual> offspring_;
 
     size_t generation_{0};
+    CheckpointWriter* checkpoint_{nullptr};
+    TaskTrace* trace_{nullptr};
+    ValidationMonitor* validation_{nullptr};
+    std::optional<AlgorithmState> restore_;
+    WorkerLimit workerLimit_;
+    std::size_t workers_{0};
+    std::size_t bufferBytes_{0};
 };
 
 } // namespace Operon
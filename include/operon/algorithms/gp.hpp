@@ -12,6 +12,7 @@
 
 #include "operon/algorithms/config.hpp"    // for GeneticAlgorithmConfig
 #include "operon/algorithms/ga_base.hpp"
+#include "operon/core/affinity.hpp"         // for AffinityPolicy
 #include "operon/core/individual.hpp"      // for Individual
 #include "operon/core/types.hpp"           // for Span, Vector, RandomGenerator
 #include "operon/operators/evaluator.hpp"  // for EvaluatorBase
@@ -34,8 +35,23 @@ public:
     {
     }
 
+    // the executor can be shared with other algorithms that are run at the same time from other threads
     auto Run(tf::Executor& /*executor*/, Operon::RandomGenerator&/*rng*/, std::function<void()> /*report*/ = nullptr) -> void;
-    auto Run(Operon::RandomGenerator& /*rng*/, std::function<void()> /*report*/ = nullptr, size_t /*threads*/= 0) -> void;
+    // runs on a new executor whose workers are pinned to the cores under the affinity policy
+    auto Run(Operon::RandomGenerator& /*rng*/, std::function<void()> /*report*/ = nullptr, size_t /*threads*/= 0, AffinityPolicy /*affinity*/ = AffinityPolicy::None) -> void;
+
+    // the next call to Run continues from the current parents instead of initializing a new population
+    // - the parents are evaluated again, eg. after rows were appended to the training range (see Problem::AppendRows),
+    //   the evaluator then only needs to evaluate them on the new rows (see Evaluator::SetIncrementalStatistics)
+    // - the generation and the counters of the evaluator start again from zero (see Reset)
+    auto Continue() -> void
+    {
+        Reset();
+        continue_ = true;
+    }
+
+private:
+    bool continue_{false};
 };
 } // namespace Operon
 
@@ -0,0 +1,164 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_ISLAND_MODEL_HPP
+#define OPERON_ISLAND_MODEL_HPP
+
+#include <cstddef>                         // for size_t
+#include <cstdint>                         // for uint8_t
+#include <functional>                      // for reference_wrapper, function
+#include <memory>                          // for unique_ptr
+#include <mutex>                           // for mutex
+#include <operon/operon_export.hpp>        // for OPERON_EXPORT
+#include <utility>                         // for move
+#include <vector>                          // for vector
+
+#include "operon/algorithms/ga_base.hpp"
+#include "operon/core/individual.hpp"      // for Individual
+#include "operon/core/types.hpp"           // for Span, Vector, RandomGenerator
+
+// forward declaration
+namespace tf { class Executor; }
+
+#if defined(HAVE_MPI)
+#include <mpi.h>
+#endif
+
+namespace Operon {
+
+// where the migrants of an island are sent
+// - Ring: to the next island
+// - Complete: to every other island
+// - Random: to one other island, chosen at random for each migration
+enum class MigrationTopology : int { Ring, Complete, Random };
+
+struct IslandModelConfig {
+    size_t MigrationInterval{10}; // generations between two migrations of an island
+    size_t MigrationSize{1};      // number of migrants, chosen by the female selector of the island
+    MigrationTopology Topology{MigrationTopology::Ring};
+    bool PinToNodes{false};       // island i runs on the cores of NUMA node i % nodes, so that its population stays in the memory of the node (see CoreTopology)
+};
+
+// compact binary encoding of a group of individuals: the fitness values and the genotype nodes (see Serialization)
+// - the decoded individuals are only meaningful for the same problem, primitive set and dataset variables
+struct OPERON_EXPORT MigrantCodec {
+    static auto Encode(Operon::Span<Individual const> individuals) -> std::vector<uint8_t>;
+    static auto Decode(Operon::Span<uint8_t const> bytes) -> Operon::Vector<Individual>;
+};
+
+// transports the encoded migrants between islands identified by a global index
+// - Send can be called concurrently by different islands, Receive is only called by the destination island
+class OPERON_EXPORT MigrationChannel {
+public:
+    MigrationChannel() = default;
+    MigrationChannel(MigrationChannel const&) = delete;
+    MigrationChannel(MigrationChannel&&) = delete;
+    auto operator=(MigrationChannel const&) -> MigrationChannel& = delete;
+    auto operator=(MigrationChannel&&) -> MigrationChannel& = delete;
+    virtual ~MigrationChannel() = default;
+
+    // total number of islands and the global index of the first island in this process
+    [[nodiscard]] virtual auto IslandCount() const -> size_t = 0;
+    [[nodiscard]] virtual auto FirstIsland() const -> size_t = 0;
+
+    virtual auto Send(size_t destination, std::vector<uint8_t> message) -> void = 0;
+    virtual auto Receive(size_t destination) -> std::vector<std::vector<uint8_t>> = 0;
+};
+
+// mailboxes for the islands of a single process
+class OPERON_EXPORT LocalMigrationChannel : public MigrationChannel {
+public:
+    explicit LocalMigrationChannel(size_t islands);
+
+    [[nodiscard]] auto IslandCount() const -> size_t override { return mailboxes_.size(); }
+    [[nodiscard]] auto FirstIsland() const -> size_t override { return 0; }
+
+    auto Send(size_t destination, std::vector<uint8_t> message) -> void override;
+    auto Receive(size_t destination) -> std::vector<std::vector<uint8_t>> override;
+
+private:
+    struct Mailbox {
+        std::mutex Mutex;
+        std::vector<std::vector<uint8_t>> Messages;
+    };
+    std::vector<Mailbox> mailboxes_;
+};
+
+#if defined(HAVE_MPI)
+// every rank runs the same number of islands, island i lives on rank i / islandsPerRank
+// - the migrants of islands on other ranks are sent with MPI (tagged with the destination island), the others stay in process
+// - requires MPI_THREAD_MULTIPLE, since the islands migrate from their own threads
+class OPERON_EXPORT MpiMigrationChannel : public MigrationChannel {
+public:
+    MpiMigrationChannel(MPI_Comm comm, size_t islandsPerRank);
+    ~MpiMigrationChannel() override;
+
+    MpiMigrationChannel(MpiMigrationChannel const&) = delete;
+    MpiMigrationChannel(MpiMigrationChannel&&) = delete;
+    auto operator=(MpiMigrationChannel const&) -> MpiMigrationChannel& = delete;
+    auto operator=(MpiMigrationChannel&&) -> MpiMigrationChannel& = delete;
+
+    [[nodiscard]] auto IslandCount() const -> size_t override { return islandsPerRank_ * static_cast<size_t>(size_); }
+    [[nodiscard]] auto FirstIsland() const -> size_t override { return islandsPerRank_ * static_cast<size_t>(rank_); }
+
+    auto Send(size_t destination, std::vector<uint8_t> message) -> void override;
+    auto Receive(size_t destination) -> std::vector<std::vector<uint8_t>> override;
+
+private:
+    MPI_Comm comm_;
+    int rank_{0};
+    int size_{1};
+    size_t islandsPerRank_;
+    LocalMigrationChannel local_;
+    std::mutex mutex_; // guards the pending sends
+    std::vector<std::pair<MPI_Request, std::vector<uint8_t>>> pending_;
+};
+#endif
+
+// runs several genetic algorithms (the islands) in parallel and periodically exchanges individuals between them
+// - each island runs on its own executor, the threads are split evenly between the islands (see IslandModelConfig::PinToNodes)
+// - the migration takes place in the report callback of the island, after every MigrationInterval generations:
+//   the emigrants are chosen by the female selector, the immigrants are merged into the population by the reinserter of the island
+// - the migration is asynchronous: an island never waits for its neighbours, immigrants are absorbed at the next migration
+// - the islands must not share operators (selectors, generators, evaluators), since these hold per-population state
+class OPERON_EXPORT IslandModel {
+public:
+    explicit IslandModel(IslandModelConfig config)
+        : config_(config)
+    {
+    }
+
+    template<typename Algorithm>
+    auto AddIsland(Algorithm& algorithm) -> void
+    {
+        islands_.push_back({ algorithm, [&algorithm](tf::Executor& executor, Operon::RandomGenerator& rng, std::function<void()> report) {
+            algorithm.Run(executor, rng, std::move(report));
+        }});
+    }
+
+    [[nodiscard]] auto Islands() const -> size_t { return islands_.size(); }
+    [[nodiscard]] auto Island(size_t i) const -> GeneticAlgorithmBase const& { return islands_[i].Algorithm.get(); }
+    [[nodiscard]] auto GetConfig() const -> IslandModelConfig const& { return config_; }
+
+    // the report callback receives the (local) index of the island that completed a generation
+    // - it is called from the thread of that island
+    auto Run(Operon::RandomGenerator& rng, std::function<void(size_t)> report = nullptr, size_t threads = 0) -> void;
+
+    // migrate over the given channel (eg. across MPI ranks), the local islands get the indices FirstIsland() + i
+    auto Run(MigrationChannel& channel, Operon::RandomGenerator& rng, std::function<void(size_t)> report = nullptr, size_t threads = 0) -> void;
+
+private:
+    struct Entry {
+        std::reference_wrapper<GeneticAlgorithmBase> Algorithm;
+        std::function<void(tf::Executor&, Operon::RandomGenerator&, std::function<void()>)> Run;
+    };
+
+    auto Migrate(MigrationChannel& channel, size_t island, Operon::RandomGenerator& rng) -> void;
+
+    IslandModelConfig config_;
+    std::vector<Entry> islands_;
+};
+
+} // namespace Operon
+
+#endif
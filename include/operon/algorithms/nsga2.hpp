@@ -12,6 +12,7 @@
 
 #include "operon/algorithms/config.hpp"    // for GeneticAlgorithmConfig
 #include "operon/algorithms/ga_base.hpp"
+#include "operon/core/affinity.hpp"         // for AffinityPolicy
 #include "operon/core/individual.hpp"      // for Individual
 #include "operon/core/types.hpp"           // for Span, Vector, RandomGenerator
 #include "operon/operators/evaluator.hpp"  // for EvaluatorBase
@@ -23,6 +24,7 @@ namespace tf { class Executor; }
 namespace Operon {
 
 class NondominatedSorterBase;
+class ParetoIndicators;
 class Problem;
 class ReinserterBase;
 struct CoefficientInitializerBase;
@@ -31,12 +33,26 @@ struct TreeInitializerBase;
 class OPERON_EXPORT NSGA2 : public GeneticAlgorithmBase {
     std::reference_wrapper<const NondominatedSorterBase> sorter_;
     std::vector<std::vector<size_t>> fronts_;
-    Operon::Vector<Individual> best_; // best Pareto front
+    size_t duplicates_{0};            // rank of the front holding the duplicates
+    bool rankedParents_{false};       // the parent ranks can be reused by an incremental sorter
+    tf::Executor* executor_{nullptr}; // the executor of the current run, used for the crowding distance
+    std::vector<size_t> best_;        // positions of the best Pareto front in the population
+    ParetoIndicators* indicators_{nullptr};
+
+    // buffers of the sort, reused across generations
+    std::vector<std::vector<size_t>> spare_; // storage of the fronts of the previous generation
+    std::vector<size_t> indices_;
+    std::vector<size_t> offspring_;
+    Operon::Set<Operon::Hash> semantic_;
 
     auto UpdateDistance(Operon::Span<Individual> pop) -> void;
     auto Sort(Operon::Span<Individual> pop) -> void;
+    auto UpdateBest() -> void;
+    auto RankedParents() -> bool;
 
 public:
+    // the populations are always sorted with the given sorter, the sweeps for two or three objectives are used when
+    // the sorter is BiObjectiveSorter, TriObjectiveSorter or AdaptiveSorter
     NSGA2(Problem const& problem, GeneticAlgorithmConfig const& config, TreeInitializerBase const& treeInit, CoefficientInitializerBase const& coeffInit, OffspringGeneratorBase const& generator, ReinserterBase const& reinserter, NondominatedSorterBase const& sorter)
         : GeneticAlgorithmBase(problem, config, treeInit, coeffInit, generator, reinserter), sorter_(sorter)
     {
@@ -46,10 +62,25 @@ public:
         }
     }
 
-    [[nodiscard]] auto Best() const -> Operon::Span<Individual const> { return { best_.data(), best_.size() }; }
+    // the best Pareto front is only copied out of the population on demand
+    // - the positions are valid until the next generation replaces the offspring
+    [[nodiscard]] auto Best() const -> Operon::Vector<Individual>
+    {
+        Operon::Vector<Individual> best;
+        best.reserve(best_.size());
+        for (auto i : best_) { best.push_back(Individuals()[i]); }
+        return best;
+    }
+    [[nodiscard]] auto BestIndices() const -> Operon::Span<size_t const> { return { best_.data(), best_.size() }; }
+
+    // the indicators are updated with the best front after every generation and the run stops when they have
+    // converged (see ParetoIndicators::SetStagnation), nullptr disables them
+    auto SetIndicators(ParetoIndicators* indicators) -> void { indicators_ = indicators; }
+    [[nodiscard]] auto GetIndicators() const -> ParetoIndicators* { return indicators_; }
 
     auto Run(tf::Executor& /*executor*/, Operon::RandomGenerator&/*rng*/, std::function<void()> /*report*/ = nullptr) -> void;
-    auto Run(Operon::RandomGenerator& /*rng*/, std::function<void()> /*report*/ = nullptr, size_t /*threads*/= 0) -> void;
+    // runs on a new executor whose workers are pinned to the cores under the affinity policy
+    auto Run(Operon::RandomGenerator& /*rng*/, std::function<void()> /*report*/ = nullptr, size_t /*threads*/= 0, AffinityPolicy /*affinity*/ = AffinityPolicy::None) -> void;
 };
 } // namespace Operon
 
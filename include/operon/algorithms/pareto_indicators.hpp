@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_PARETO_INDICATORS_HPP
+#define OPERON_PARETO_INDICATORS_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "operon/core/individual.hpp"
+#include "operon/core/types.hpp"
+#include "operon/operon_export.hpp"
+
+namespace Operon {
+
+class SolutionArchive;
+
+// quality indicators of a Pareto front (minimization)
+// - the hypervolume is the volume dominated by the front and bounded by the reference point (the points that do not
+//   strictly dominate the reference point do not contribute), computed with a sweep for two objectives, the HV3D
+//   sweep of Beume et al. (2009) for three objectives and the WFG algorithm of While et al. (2012) above
+// - the inverted generational distance is the mean euclidean distance from the points of a reference front to their
+//   closest point of the front
+OPERON_EXPORT auto Hypervolume(Operon::Span<Operon::Individual const> front, Operon::Span<Operon::Scalar const> reference) -> double;
+OPERON_EXPORT auto InvertedGenerationalDistance(Operon::Span<Operon::Individual const> front, Operon::Span<Operon::Vector<Operon::Scalar> const> reference) -> double;
+
+// tracks the indicators of the best front of a run (eg. NSGA2::SetIndicators or a SolutionArchive)
+// - the indicators are only computed again when the front has changed since the last update
+// - the run is converged when the hypervolume improved by less than the relative tolerance over the last window
+//   updates (a window of zero never converges)
+class OPERON_EXPORT ParetoIndicators {
+public:
+    using Point = Operon::Vector<Operon::Scalar>;
+
+    explicit ParetoIndicators(Point reference, std::vector<Point> referenceFront = {});
+
+    // returns true if the front has changed
+    auto Update(Operon::Span<Operon::Individual const> front) -> bool;
+    auto Update(Operon::Span<Operon::Individual const> population, Operon::Span<std::size_t const> indices) -> bool;
+    auto Update(SolutionArchive const& archive) -> bool;
+
+    auto SetStagnation(std::size_t window, double tolerance) -> void
+    {
+        window_ = window;
+        tolerance_ = tolerance;
+    }
+
+    [[nodiscard]] auto Converged() const -> bool;
+    [[nodiscard]] auto Hypervolume() const -> double { return hypervolume_; }
+    [[nodiscard]] auto InvertedGenerationalDistance() const -> double { return igd_; } // NaN without a reference front
+    [[nodiscard]] auto History() const -> Operon::Span<double const> { return { history_.data(), history_.size() }; } // hypervolume after each update
+    [[nodiscard]] auto Reference() const -> Point const& { return reference_; }
+
+    auto Reset() -> void;
+
+private:
+    auto Update() -> bool; // compares the front in the buffer with the last one
+
+    Point reference_;
+    std::vector<Point> referenceFront_;
+    std::vector<Point> front_;  // sorted fitness values of the last front
+    std::vector<Point> buffer_; // fitness values of the next front
+    double hypervolume_{0};
+    double igd_;
+    std::vector<double> history_;
+    std::size_t window_{0};
+    double tolerance_{0};
+};
+
+} // namespace Operon
+
+#endif
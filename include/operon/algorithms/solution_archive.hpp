@@ -4,20 +4,63 @@
 #ifndef OPERON_SOLUTION_ARCHIVE_HPP
 #define OPERON_SOLUTION_ARCHIVE_HPP
 
+#include <cstdint>
+#include <shared_mutex>
+#include <vector>
+
 #include "operon/core/individual.hpp"
+#include "operon/core/types.hpp"
 #include "operon/operators/non_dominated_sorter.hpp"
+#include "operon/operon_export.hpp"
 
 namespace Operon {
-class SolutionArchive {
+
+// archive of the non-dominated solutions found so far (minimization)
+// - the solutions are kept in lexicographic order of their fitness, so a new individual can only be dominated by
+//   the solutions before its insertion point and can only dominate the solutions after it
+// - with two objectives the second objective decreases along the archive, which makes the dominance check
+//   a binary search and the dominated solutions a contiguous range
+// - an individual with the same semantic hash as an archived solution is rejected unless it dominates it
+// - Insert is thread-safe: the dominance check runs under a shared lock, so the (common) rejected insertions
+//   from different threads do not block each other; an exclusive lock is only taken to modify the archive
+// - with an epsilon (SetEpsilon), the archive keeps at most one solution per box of the grid of side epsilon and only
+//   the solutions in non-dominated boxes, so its size is bounded by the number of boxes along the front (eg. about
+//   range / epsilon with two objectives) instead of growing with the length of the run
+//   - the occupied boxes are indexed by a hash map: an individual that falls into an occupied box (most of them once
+//     the front is covered) is accepted or rejected in constant expected time
+//   - an individual replaces the solution of its box if it dominates it or, when neither dominates the other, if it
+//     is closer to the lower corner of the box
+//   - the solutions are then kept in lexicographic order of their boxes
+class OPERON_EXPORT SolutionArchive {
 public:
     auto Insert(Operon::Individual const& individual) -> bool;
     auto Insert(Operon::Span<Operon::Individual const> individuals) -> int64_t;
 
+    // the span is invalidated by concurrent insertions, use Snapshot while other threads insert
     [[nodiscard]] auto Solutions() const { return Operon::Span<Operon::Individual const> { archive_ }; }
-    auto Clear() { archive_.clear(); }
+    [[nodiscard]] auto Snapshot() const -> std::vector<Operon::Individual>;
+    [[nodiscard]] auto Size() const -> std::size_t;
+    auto Clear() -> void;
+
+    // zero (the default) keeps every non-dominated solution, the archived solutions are filtered again when it changes
+    auto SetEpsilon(Operon::Scalar eps) -> void;
+    [[nodiscard]] auto GetEpsilon() const -> Operon::Scalar;
+
 private:
-    Operon::Scalar eps_{};
+    struct BoxHash {
+        using is_avalanching = void; // NOLINT
+        auto operator()(Operon::Vector<Operon::Scalar> const& box) const noexcept -> uint64_t;
+    };
+
+    // the methods below expect the caller to hold the lock
+    [[nodiscard]] auto IsDominated(Operon::Individual const& individual) const -> bool;
+    [[nodiscard]] auto IsBoxDominated(Operon::Individual const& individual, Operon::Vector<Operon::Scalar> const& box) const -> bool;
+    auto InsertUnsafe(Operon::Individual const& individual) -> bool;
+
+    mutable std::shared_mutex mutex_;
     std::vector<Operon::Individual> archive_;
+    Operon::Scalar eps_{0};
+    Operon::Map<Operon::Vector<Operon::Scalar>, Operon::Vector<Operon::Scalar>, BoxHash> boxes_; // box -> fitness of its solution
 };
 } // namespace Operon
 #endif
@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_SUCCESSIVE_HALVING_HPP
+#define OPERON_SUCCESSIVE_HALVING_HPP
+
+#include <cstddef>                         // for size_t
+#include <functional>                      // for function
+#include <memory>                          // for shared_ptr
+#include <operon/operon_export.hpp>        // for OPERON_EXPORT
+#include <utility>                         // for move
+#include <vector>                          // for vector
+
+#include "operon/algorithms/config.hpp"    // for GeneticAlgorithmConfig
+#include "operon/algorithms/gp.hpp"        // for GeneticProgrammingAlgorithm
+#include "operon/core/types.hpp"           // for RandomGenerator
+
+// forward declaration
+namespace tf { class Executor; }
+
+namespace Operon {
+
+struct SuccessiveHalvingConfig {
+    size_t Generations{10};   // generations of each configuration in the first rung
+    size_t Reduction{3};      // each rung keeps the best 1/Reduction of the configurations, which then run Reduction times as many generations in total
+    size_t ConcurrentRuns{0}; // configurations run at the same time on the executor (0 = one per worker)
+};
+
+// what became of one configuration of the sweep
+struct SweepResult {
+    GeneticAlgorithmConfig Config;
+    size_t Rungs{0};       // number of rungs the configuration was run in
+    size_t Generations{0}; // generations run in total
+    double Score{0};       // after the last rung it was run in (smaller is better)
+};
+
+// hyperparameter sweep by successive halving: every configuration is run for a few generations, the worst ones are
+// stopped and the others continue from their population for more generations, until a single configuration is left
+// - the factory creates the algorithm of a configuration together with the operators it references (eg. with the
+//   aliasing constructor of shared_ptr), the algorithms share the problem and the executor
+// - the config passed to the factory is owned by the sweep and outlives the algorithm, the sweep sets the generations
+//   of each rung in it and a surviving algorithm continues from its parents (see GeneticProgrammingAlgorithm::Continue)
+// - the evaluation budget and the time limit of a configuration apply to each rung
+// - the score defaults to the best first objective of the parents, eg. a validation fitness can be used instead
+class OPERON_EXPORT SuccessiveHalving {
+public:
+    using Factory = std::function<std::shared_ptr<GeneticProgrammingAlgorithm>(GeneticAlgorithmConfig const&)>;
+    using Score = std::function<double(GeneticProgrammingAlgorithm const&)>;
+
+    SuccessiveHalving(SuccessiveHalvingConfig config, Factory factory, Score score = nullptr)
+        : config_(config)
+        , factory_(std::move(factory))
+        , score_(std::move(score))
+    {
+    }
+
+    // the results are in the order of the configurations, the report callback receives the index of the configuration
+    // that completed a rung and is called from the thread that ran it
+    auto Run(tf::Executor& executor, Operon::RandomGenerator& rng, std::vector<GeneticAlgorithmConfig> const& configs, std::function<void(size_t)> report = nullptr) const -> std::vector<SweepResult>;
+
+    // the configuration that survived the most rungs (the lowest score among those)
+    static auto Best(std::vector<SweepResult> const& results) -> size_t;
+
+    [[nodiscard]] auto GetConfig() const -> SuccessiveHalvingConfig const& { return config_; }
+
+private:
+    SuccessiveHalvingConfig config_;
+    Factory factory_;
+    Score score_;
+};
+
+} // namespace Operon
+
+#endif
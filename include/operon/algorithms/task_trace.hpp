@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_ALGORITHMS_TASK_TRACE_HPP
+#define OPERON_ALGORITHMS_TASK_TRACE_HPP
+
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "operon/core/types.hpp"
+#include "operon/operon_export.hpp"
+
+// forward declaration
+namespace tf { class Executor; }
+
+namespace Operon {
+
+// the load of a worker during one generation (see TaskTrace::Mark)
+struct WorkerLoad {
+    double Busy{0}; // seconds
+    double Idle{0}; // seconds
+    std::size_t Tasks{0};
+    std::size_t Offspring{0};
+};
+
+// records when and on which worker the tasks of an executor run (eg. the named tasks of the main loop of the
+// algorithms), in order to see how the work is balanced between the workers
+// - the trace is recorded from construction until destruction, each worker only writes its own timeline
+// - the timelines are written in the chrome trace event format (chrome://tracing, https://ui.perfetto.dev)
+// - the trace must not be written while the executor is running tasks
+class OPERON_EXPORT TaskTrace {
+public:
+    explicit TaskTrace(tf::Executor& executor);
+    TaskTrace(TaskTrace const&) = delete;
+    TaskTrace(TaskTrace&&) = delete;
+    auto operator=(TaskTrace const&) -> TaskTrace& = delete;
+    auto operator=(TaskTrace&&) -> TaskTrace& = delete;
+    ~TaskTrace();
+
+    // number of recorded tasks
+    [[nodiscard]] auto Size() const -> std::size_t;
+    auto Clear() -> void;
+
+    auto WriteChromeTrace(std::ostream& out) const -> void;
+    auto WriteChromeTrace(std::string const& path) const -> void;
+
+    // per-worker load, to quantify the load imbalance and the time spent at the barriers of a generation
+    // - the algorithms count the offspring produced by each worker and call Mark at the end of every generation
+    //   (see GeneticAlgorithmBase::SetTaskTrace), Mark must be called while the other workers do not run tasks
+    // - a worker is busy while it runs a task that has not spawned tasks on the same worker: the time a task waits
+    //   for the tasks it spawned (eg. a subflow joining its children) is idle time, as is the work it does after its
+    //   first nested task started
+    auto AddOffspring(std::size_t worker) -> void;
+    auto Mark() -> void;
+    [[nodiscard]] auto Loads() const -> std::vector<std::vector<WorkerLoad>> const& { return loads_; } // one vector per generation
+    auto WriteWorkerLoad(std::ostream& out) const -> void; // csv with one line per generation and worker
+
+    // the busy time of the busiest worker over the mean busy time (one for a perfectly balanced generation)
+    [[nodiscard]] static auto Imbalance(Operon::Span<WorkerLoad const> loads) -> double;
+
+    struct Observer;
+
+private:
+    tf::Executor& executor_; // NOLINT
+    std::shared_ptr<Observer> observer_;
+    std::vector<std::vector<WorkerLoad>> loads_;
+};
+
+} // namespace Operon
+
+#endif
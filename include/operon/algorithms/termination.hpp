@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_ALGORITHMS_TERMINATION_HPP
+#define OPERON_ALGORITHMS_TERMINATION_HPP
+
+#include <cstddef>
+#include <string_view>
+
+#include "operon/algorithms/config.hpp"
+#include "operon/core/individual.hpp"
+#include "operon/core/types.hpp"
+#include "operon/operon_export.hpp"
+
+namespace Operon {
+
+enum class TerminationReason : int { None, Stagnation, Target, Diversity };
+
+OPERON_EXPORT auto ToString(TerminationReason reason) -> std::string_view;
+
+// convergence based termination criteria, updated with the parents after every generation
+// (see GeneticAlgorithmConfig::StagnationGenerations, TargetFitness, MinimumDiversity)
+// - the criteria are defined on the first objective (the best value is the smallest one)
+// - the diversity is the mean pairwise distance of the trees (see PopulationDiversityAnalyzer), it is quadratic in
+//   the population size and only computed every DiversityInterval generations
+// - the criteria only depend on the parents, so they do not change the results of a deterministic run
+class OPERON_EXPORT TerminationCriteria {
+public:
+    explicit TerminationCriteria(GeneticAlgorithmConfig const& config);
+
+    auto Update(Operon::Span<Operon::Individual const> parents) -> void;
+
+    [[nodiscard]] auto Terminated() const -> bool { return reason_ != TerminationReason::None; }
+    [[nodiscard]] auto Reason() const -> TerminationReason { return reason_; }
+
+    [[nodiscard]] auto Best() const -> double { return best_; }
+    [[nodiscard]] auto Stagnation() const -> std::size_t { return stagnation_; } // generations without improvement
+    [[nodiscard]] auto Diversity() const -> double { return diversity_; } // last computed diversity
+
+    auto Reset() -> void;
+
+private:
+    std::size_t stagnationGenerations_;
+    double target_;
+    double minimumDiversity_;
+    std::size_t diversityInterval_;
+    double epsilon_;
+
+    std::size_t updates_{0};
+    std::size_t stagnation_{0};
+    double best_{0};
+    double diversity_{1};
+    TerminationReason reason_{TerminationReason::None};
+};
+
+} // namespace Operon
+
+#endif
@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_ALGORITHMS_VALIDATION_HPP
+#define OPERON_ALGORITHMS_VALIDATION_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "operon/core/individual.hpp"
+#include "operon/core/types.hpp"
+#include "operon/operon_export.hpp"
+
+namespace Operon {
+
+struct EvaluatorBase;
+
+// evaluates the best individuals of each generation on the validation range of the problem on a background thread,
+// so that the validation overlaps with the creation of the next generation (see GeneticAlgorithmBase::SetValidation)
+// - Submit copies the k best individuals (by the first objective) and returns, a batch that is still pending is
+//   replaced by the newer one, so the validation skips generations when it is slower than the algorithm
+// - the individuals are evaluated with EvaluatorBase::EvaluateSubset on the validation range, the evaluator should not
+//   be the one of the algorithm so that the validation does not count against the evaluation budget
+// - the archive keeps the (at most k) distinct individuals with the best validation fitness seen so far, best first
+// - with a patience p > 0, early stopping is signalled once the best validation fitness did not improve for p
+//   validated generations (the algorithm notices it at its next check of the termination criteria)
+// - an error in the background thread is rethrown by the next call to Submit or Wait
+class OPERON_EXPORT ValidationMonitor {
+public:
+    struct Entry {
+        Operon::Individual Model;
+        Operon::Scalar Fitness{0}; // on the validation range
+        std::size_t Generation{0}; // the generation the individual was submitted in
+    };
+
+    ValidationMonitor(EvaluatorBase const& evaluator, std::size_t k, std::size_t patience = 0, Operon::RandomGenerator::result_type seed = 0);
+    ValidationMonitor(ValidationMonitor const&) = delete;
+    ValidationMonitor(ValidationMonitor&&) = delete;
+    auto operator=(ValidationMonitor const&) -> ValidationMonitor& = delete;
+    auto operator=(ValidationMonitor&&) -> ValidationMonitor& = delete;
+    ~ValidationMonitor(); // validates the pending batch, if any
+
+    auto Submit(Operon::Span<Operon::Individual const> population, std::size_t generation) -> void;
+
+    // blocks until the submitted batches are validated
+    auto Wait() -> void;
+
+    [[nodiscard]] auto Archive() const -> std::vector<Entry>;
+    [[nodiscard]] auto Best() const -> std::optional<Entry>;
+    [[nodiscard]] auto EarlyStop() const -> bool { return earlyStop_.load(std::memory_order_relaxed); }
+
+    // number of generations validated so far
+    [[nodiscard]] auto Count() const -> std::size_t;
+
+    [[nodiscard]] auto Size() const -> std::size_t { return k_; }
+    [[nodiscard]] auto Patience() const -> std::size_t { return patience_; }
+
+private:
+    struct Batch {
+        std::vector<Operon::Individual> Individuals;
+        std::size_t Generation{0};
+    };
+
+    auto Work() -> void;
+    auto Validate(Batch& batch) -> std::vector<Entry>;
+    auto Rethrow() -> void;
+
+    std::reference_wrapper<EvaluatorBase const> evaluator_;
+    std::size_t k_;
+    std::size_t patience_;
+    Operon::RandomGenerator rng_;
+    std::vector<Entry> archive_;
+    std::size_t count_{0};
+    std::size_t stale_{0}; // validated generations without improvement
+    std::atomic<bool> earlyStop_{false};
+    std::optional<Batch> pending_;
+    std::exception_ptr error_;
+    bool busy_{false};
+    bool stop_{false};
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread thread_;
+};
+
+} // namespace Operon
+
+#endif
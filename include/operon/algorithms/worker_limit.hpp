@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_ALGORITHMS_WORKER_LIMIT_HPP
+#define OPERON_ALGORITHMS_WORKER_LIMIT_HPP
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+#include "operon/operon_export.hpp"
+
+namespace Operon {
+
+// a worker limit (see GeneticAlgorithmBase::SetWorkerLimit) that leaves to the other processes the cores they use
+// - the cores they use are estimated with the 1 minute load average (getloadavg), minus the workers this limit let
+//   the algorithm use at the previous call, since the load also counts them
+// - the copies share the cores: each copy limits one run (eg. the concurrent runs of operon_gp --runs), the workers
+//   of the other runs are not counted as load and are not given to this one, a run that is destroyed releases them
+// - the load average follows a change of the load with a delay of some seconds, so the number of workers does too
+// - without a load average (eg. on windows) all the workers are used
+class OPERON_EXPORT LoadAverageLimit {
+public:
+    explicit LoadAverageLimit(std::size_t cores = 0); // the cores of the machine (0 = std::thread::hardware_concurrency())
+
+    LoadAverageLimit(LoadAverageLimit const& other);
+    LoadAverageLimit(LoadAverageLimit&& other) noexcept;
+    auto operator=(LoadAverageLimit const&) -> LoadAverageLimit& = delete;
+    auto operator=(LoadAverageLimit&&) -> LoadAverageLimit& = delete;
+    ~LoadAverageLimit();
+
+    auto operator()(std::size_t workers) -> std::size_t;
+
+private:
+    struct Shared {
+        std::mutex Mutex;
+        std::size_t Cores;
+        std::size_t Active{0}; // the workers of all the copies
+    };
+
+    std::shared_ptr<Shared> shared_;
+    std::size_t active_{0}; // the workers of this copy
+};
+
+} // namespace Operon
+
+#endif
@@ -5,13 +5,17 @@
 #define DIVERSITY_HPP
 
 #include <algorithm>
+#include <numeric>
 #include <unordered_set>
+#include <utility>
 #include <vstat/vstat.hpp>
 
 #include "operon/analyzers/analyzer_base.hpp"
 #include "operon/core/operator.hpp"
 #include "operon/core/distance.hpp"
+#include "operon/core/minhash.hpp"
 #include "operon/core/tree.hpp"
+#include "operon/random/random.hpp"
 
 namespace Operon {
 namespace {
@@ -43,11 +47,14 @@ public:
         std::transform(indices.begin(), indices.end(), std::back_inserter(hashes),
                 [&](auto i) { return MakeHashes(pop[i], M); });
 
+        // one row of the distance matrix at a time
         vstat::univariate_accumulator<double> acc;
+        std::vector<double> distances(pop.size());
+        Operon::Span<Operon::Vector<Operon::Hash> const> candidates{hashes};
         for (auto i = 0UL; i < pop.size() - 1; ++i) {
-            for (auto j = i+1; j < pop.size(); ++j) {
-                acc(Operon::Distance::Jaccard(hashes[i], hashes[j]));
-            }
+            auto row = Operon::Span<double>{distances}.first(pop.size() - i - 1);
+            Operon::Distance::Jaccard(hashes[i], candidates.subspan(i + 1), row);
+            for (auto d : row) { acc(d); }
         }
 
         diversity_ = vstat::univariate_statistics(acc).mean;
@@ -56,6 +63,73 @@ public:
     private:
         double diversity_{};
     };
+
+// estimates the diversity of large populations from MinHash sketches of the trees (see MinHash)
+// - the mean distance is averaged over `samples` random pairs per tree (over all the pairs if there are fewer)
+// - the nearest neighbour of each tree is searched among the trees that share a band of its sketch
+template <typename T, Operon::HashMode M = Operon::HashMode::Strict>
+class ApproximateDiversityAnalyzer final : PopulationAnalyzerBase<T> {
+public:
+    static constexpr std::size_t DefaultSamples{100};
+
+    explicit ApproximateDiversityAnalyzer(Operon::MinHash minhash = Operon::MinHash{}, std::size_t samples = DefaultSamples, Operon::RandomGenerator::result_type seed = 0)
+        : minhash_(std::move(minhash))
+        , samples_(samples)
+        , random_(seed)
+    {
+    }
+
+    auto operator()(Operon::RandomGenerator& /*unused*/) const -> double
+    {
+        return diversity_;
+    }
+
+    [[nodiscard]] auto NearestNeighbourDistances() const -> Operon::Span<double const> { return nearest_; }
+    [[nodiscard]] auto MeanNearestNeighbourDistance() const -> double { return nearestMean_; }
+
+    void Prepare(Operon::Span<T> pop)
+    {
+        auto const n = pop.size();
+        auto const k = minhash_.Size();
+        sketches_.resize(n * k);
+        for (auto i = 0UL; i < n; ++i) {
+            minhash_.Sketch(MakeHashes(pop[i], M), Operon::Span<Operon::Hash>{sketches_.data() + i * k, k});
+        }
+        Operon::Span<Operon::Hash const> sketches{sketches_};
+        auto sketch = [&](auto i) { return sketches.subspan(i * k, k); };
+
+        vstat::univariate_accumulator<double> acc;
+        if (n < 2) {
+            acc(0.0);
+        } else if ((n - 1) / 2 <= samples_) {
+            for (auto i = 0UL; i < n - 1; ++i) {
+                for (auto j = i + 1; j < n; ++j) {
+                    acc(Operon::MinHash::Distance(sketch(i), sketch(j)));
+                }
+            }
+        } else {
+            for (auto s = 0UL; s < samples_ * n; ++s) {
+                auto const i = Operon::Random::Bounded(random_, n);
+                auto j = Operon::Random::Bounded(random_, n - 1);
+                j += static_cast<decltype(j)>(j >= i);
+                acc(Operon::MinHash::Distance(sketch(i), sketch(j)));
+            }
+        }
+        diversity_ = vstat::univariate_statistics(acc).mean;
+
+        nearest_ = minhash_.NearestNeighbours(sketches);
+        nearestMean_ = nearest_.empty() ? 0.0 : std::reduce(nearest_.begin(), nearest_.end()) / static_cast<double>(n);
+    }
+
+private:
+    Operon::MinHash minhash_;
+    std::size_t samples_;
+    Operon::RandomGenerator random_;
+    Operon::Vector<Operon::Hash> sketches_;
+    std::vector<double> nearest_;
+    double diversity_{};
+    double nearestMean_{};
+};
 } // namespace Operon
 
 #endif
@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_ANALYZERS_POPULATION_STATISTICS_HPP
+#define OPERON_ANALYZERS_POPULATION_STATISTICS_HPP
+
+#include <cstddef>
+
+#include "operon/core/individual.hpp"
+#include "operon/core/types.hpp"
+#include "operon/operon_export.hpp"
+
+namespace tf { class Executor; } // NOLINT
+
+namespace Operon {
+
+// mean, variance (population) and range of a quantity
+struct SummaryStatistics {
+    std::size_t Count{0};
+    double Mean{0};
+    double Variance{0};
+    double Min{0};
+    double Max{0};
+};
+
+// the statistics of a population, as printed or logged at the end of a generation
+struct PopulationStatistics {
+    std::size_t Best{0};          // index of the individual with the lowest fitness (the first one in case of ties)
+    SummaryStatistics Fitness;    // of the objective given to ComputePopulationStatistics
+    SummaryStatistics Length;     // number of nodes
+    SummaryStatistics Depth;
+    SummaryStatistics Complexity; // visitation length (sum of the lengths of all the subtrees)
+};
+
+// both versions return the same statistics (up to the rounding of the partial sums)
+// - the parallel version is a taskflow reduction over blocks of individuals, it can also be called from a worker of the
+//   executor (eg. from the report callback of an algorithm), the other workers then help with the reduction
+OPERON_EXPORT auto ComputePopulationStatistics(Operon::Span<Operon::Individual const> pop, std::size_t idx) -> PopulationStatistics;
+OPERON_EXPORT auto ComputePopulationStatistics(Operon::Span<Operon::Individual const> pop, std::size_t idx, tf::Executor& executor) -> PopulationStatistics;
+
+} // namespace Operon
+
+#endif
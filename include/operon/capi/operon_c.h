@@ -0,0 +1,125 @@
+/* SPDX-License-Identifier: MIT */
+/* SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research */
+
+#ifndef OPERON_CAPI_OPERON_C_H
+#define OPERON_CAPI_OPERON_C_H
+
+/*
+ * C interface for embedding the interpreter in other runtimes (eg. through cgo or rust ffi)
+ * - the datasets are views over column-major buffers owned by the caller, nothing is copied
+ * - the trees are built from postfix arrays (children before their parent, the root last)
+ * - the predictions are written into buffers owned by the caller
+ * - the functions return a status, the message of the last error of the calling thread is given by operon_last_error
+ * - the handles can be shared between threads once created, as long as they are not destroyed concurrently
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "operon/operon_export.hpp"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(USE_SINGLE_PRECISION)
+typedef float operon_scalar;
+#else
+typedef double operon_scalar;
+#endif
+
+typedef enum operon_status {
+    OPERON_OK = 0,
+    OPERON_INVALID_ARGUMENT = 1, /* null pointer, empty array or range outside of the dataset */
+    OPERON_INVALID_TREE = 2,     /* the arrays do not describe a tree in postfix order */
+    OPERON_ERROR = 3             /* any other failure (eg. out of memory) */
+} operon_status;
+
+/* the symbols, with the values of Operon::NodeType */
+typedef enum operon_node_type {
+    OPERON_NODE_ADD = 1U << 0U,
+    OPERON_NODE_MUL = 1U << 1U,
+    OPERON_NODE_SUB = 1U << 2U,
+    OPERON_NODE_DIV = 1U << 3U,
+    OPERON_NODE_FMIN = 1U << 4U,
+    OPERON_NODE_FMAX = 1U << 5U,
+    OPERON_NODE_AQ = 1U << 6U,
+    OPERON_NODE_POW = 1U << 7U,
+    OPERON_NODE_ABS = 1U << 8U,
+    OPERON_NODE_ACOS = 1U << 9U,
+    OPERON_NODE_ASIN = 1U << 10U,
+    OPERON_NODE_ATAN = 1U << 11U,
+    OPERON_NODE_CBRT = 1U << 12U,
+    OPERON_NODE_CEIL = 1U << 13U,
+    OPERON_NODE_COS = 1U << 14U,
+    OPERON_NODE_COSH = 1U << 15U,
+    OPERON_NODE_EXP = 1U << 16U,
+    OPERON_NODE_FLOOR = 1U << 17U,
+    OPERON_NODE_LOG = 1U << 18U,
+    OPERON_NODE_LOGABS = 1U << 19U,
+    OPERON_NODE_LOG1P = 1U << 20U,
+    OPERON_NODE_SIN = 1U << 21U,
+    OPERON_NODE_SINH = 1U << 22U,
+    OPERON_NODE_SQRT = 1U << 23U,
+    OPERON_NODE_SQRTABS = 1U << 24U,
+    OPERON_NODE_TAN = 1U << 25U,
+    OPERON_NODE_TANH = 1U << 26U,
+    OPERON_NODE_SQUARE = 1U << 27U,
+    OPERON_NODE_CONSTANT = 1U << 29U,
+    OPERON_NODE_VARIABLE = 1U << 30U
+} operon_node_type;
+
+typedef struct operon_dataset operon_dataset;
+typedef struct operon_tree operon_tree;
+
+/* the width of operon_scalar the library was built with, callers should check it against sizeof(operon_scalar) */
+OPERON_EXPORT size_t operon_scalar_size(void);
+
+/* the message of the last error of the calling thread (empty if there was none), valid until the next call on this thread */
+OPERON_EXPORT char const* operon_last_error(void);
+
+/*
+ * a view over rows x cols values in column-major order (column j starts at data + j * rows)
+ * - the buffer must outlive the dataset and must not change while a prediction reads it
+ */
+OPERON_EXPORT operon_status operon_dataset_create(operon_scalar const* data, size_t rows, size_t cols, operon_dataset** dataset);
+OPERON_EXPORT void operon_dataset_destroy(operon_dataset* dataset);
+
+/*
+ * a tree of length nodes in postfix order
+ * - types: the symbol of each node (see operon_node_type)
+ * - arities: the number of children of each node, or NULL for the default arities (two for the n-ary symbols), fmin
+ *   and fmax always take two
+ * - values: the value of the constants and the weight of the variables, or NULL for ones
+ * - columns: for the variables, the column of the dataset they read (the other entries are ignored), may be NULL if
+ *   there are no variables
+ * - the arrays are copied, the tree does not refer to them once created
+ */
+OPERON_EXPORT operon_status operon_tree_create(size_t length, uint32_t const* types, uint16_t const* arities,
+    operon_scalar const* values, int64_t const* columns, operon_tree** tree);
+OPERON_EXPORT void operon_tree_destroy(operon_tree* tree);
+
+/* the number of coefficients of the tree (the values of its constants and variables, in postfix order) */
+OPERON_EXPORT size_t operon_tree_coefficient_count(operon_tree const* tree);
+
+/*
+ * writes the predictions of the tree for the rows [begin, end) of the dataset into result[0, end - begin)
+ * - coefficients: replaces the values of the tree (operon_tree_coefficient_count of them), or NULL for the values
+ *   the tree was created with
+ * - the columns read by the tree must exist in the dataset
+ */
+OPERON_EXPORT operon_status operon_evaluate(operon_tree const* tree, operon_dataset const* dataset, size_t begin, size_t end,
+    operon_scalar const* coefficients, operon_scalar* result);
+
+/*
+ * the predictions of count trees for the same rows, the predictions of tree i are written to result + i * (end - begin)
+ * - the trees are evaluated on the calling thread, one after the other
+ */
+OPERON_EXPORT operon_status operon_evaluate_batch(operon_tree const* const* trees, size_t count, operon_dataset const* dataset,
+    size_t begin, size_t end, operon_scalar* result);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif
@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_CORE_AFFINITY_HPP
+#define OPERON_CORE_AFFINITY_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "operon/core/types.hpp"
+#include "operon/operon_export.hpp"
+
+// forward declaration
+namespace tf { class Executor; }
+
+namespace Operon {
+
+// how the workers of an executor are pinned to the cores
+// - None: the workers are placed (and migrated) by the scheduler of the operating system
+// - Compact: consecutive workers on consecutive cores, a NUMA node is filled before the next one is used
+// - Scatter: consecutive workers alternate between the NUMA nodes, the bandwidth of all the nodes is used with few workers
+// with more workers than cores, the cores are assigned again from the first one
+enum class AffinityPolicy : int { None, Compact, Scatter };
+
+// the cores this process may run on (see sched_getaffinity), grouped by NUMA node
+// - a single group when the topology is unknown, empty when the affinity is not supported (linux only)
+OPERON_EXPORT auto CoreTopology() -> std::vector<std::vector<int>>;
+
+// the core of each worker under the policy (empty for AffinityPolicy::None or an empty topology)
+OPERON_EXPORT auto AssignCores(AffinityPolicy policy, std::size_t workers, std::vector<std::vector<int>> const& topology) -> std::vector<int>;
+
+// restricts the calling thread to the cores, returns false when this is not supported
+OPERON_EXPORT auto PinThread(Operon::Span<int const> cores) -> bool;
+
+// an executor whose worker i is pinned to cores[i % cores.size()] when it starts (not pinned if cores is empty)
+OPERON_EXPORT auto MakeExecutor(std::size_t threads, std::vector<int> cores) -> std::unique_ptr<tf::Executor>;
+
+// an executor pinned to the cores of this process under the policy
+OPERON_EXPORT auto MakeExecutor(std::size_t threads, AffinityPolicy policy = AffinityPolicy::None) -> std::unique_ptr<tf::Executor>;
+
+} // namespace Operon
+
+#endif
@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_CORE_COMPACT_TREE_HPP
+#define OPERON_CORE_COMPACT_TREE_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "node.hpp"
+#include "tree.hpp"
+#include "types.hpp"
+#include "operon/operon_export.hpp"
+
+namespace Operon {
+
+// the part of a node that cannot be derived from the rest of the tree
+// - Length, Depth, Level and Parent are recomputed by Tree::UpdateNodes
+// - CalculatedHashValue is recomputed by Tree::Hash
+// - 16 bytes in single precision (24 in double precision), compared to 40 (48) for a Node
+struct CompactNode {
+    Operon::Hash HashValue;
+    Operon::Scalar Value;
+    uint16_t Arity;
+    uint8_t Type; // index of the type in the NodeType enum (lower bits) and the flags (see Enabled and Optimize below)
+    uint8_t Lag;
+
+    static constexpr uint8_t Enabled{1U << 6U};
+    static constexpr uint8_t Optimize{1U << 7U};
+    static constexpr uint8_t TypeMask{Enabled - 1U};
+    static_assert(NodeTypes::Count <= TypeMask + 1U);
+
+    CompactNode() = default;
+
+    explicit CompactNode(Node const& node) noexcept
+        : HashValue(node.HashValue)
+        , Value(node.Value)
+        , Arity(node.Arity)
+        , Type(static_cast<uint8_t>(NodeTypes::GetIndex(node.Type) | (node.IsEnabled ? Enabled : 0U) | (node.Optimize ? Optimize : 0U)))
+        , Lag(node.Lag)
+    {
+    }
+
+    [[nodiscard]] auto GetType() const noexcept -> NodeType { return static_cast<NodeType>(UnderlyingNodeType{1} << (Type & TypeMask)); }
+    [[nodiscard]] auto IsLeaf() const noexcept -> bool { return Arity == 0; }
+
+    [[nodiscard]] auto ToNode() const noexcept -> Node
+    {
+        Node node(GetType(), HashValue);
+        node.Value = Value;
+        node.Arity = Arity;
+        node.Length = Arity;
+        node.IsEnabled = (Type & Enabled) != 0;
+        node.Optimize = (Type & Optimize) != 0;
+        node.Lag = Lag;
+        return node;
+    }
+};
+
+static_assert(sizeof(CompactNode) <= sizeof(Operon::Hash) + 2 * sizeof(Operon::Scalar));
+
+// postfix node array for the long-term storage of trees (eg. archives, populations waiting for reinsertion)
+// - the subtree lengths are derived from the arities, so subtree crossover works directly on the compact layout
+// - ToTree rebuilds the full nodes for the interpreter and the other operators (without the calculated hashes)
+class OPERON_EXPORT CompactTree {
+public:
+    CompactTree() = default;
+    explicit CompactTree(Tree const& tree);
+    explicit CompactTree(Operon::Vector<CompactNode> nodes)
+        : nodes_(std::move(nodes))
+    {
+    }
+
+    [[nodiscard]] auto ToTree() const -> Tree;
+
+    // number of descendants of node i (same as Node::Length)
+    [[nodiscard]] auto SubtreeLength(std::size_t i) const noexcept -> std::size_t;
+
+    // replace the subtree rooted at i in lhs with the subtree rooted at j in rhs (see SubtreeCrossover::Cross)
+    [[nodiscard]] static auto Cross(CompactTree const& lhs, CompactTree const& rhs, std::size_t i, std::size_t j) -> CompactTree;
+
+    [[nodiscard]] auto Nodes() const noexcept -> Operon::Vector<CompactNode> const& { return nodes_; }
+    [[nodiscard]] auto Length() const noexcept -> std::size_t { return nodes_.size(); }
+    [[nodiscard]] auto Empty() const noexcept -> bool { return nodes_.empty(); }
+
+    auto operator[](std::size_t i) const noexcept -> CompactNode const& { return nodes_[i]; }
+
+private:
+    Operon::Vector<CompactNode> nodes_;
+};
+
+} // namespace Operon
+
+#endif
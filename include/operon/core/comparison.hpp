@@ -4,9 +4,14 @@
 #ifndef OPERON_COMPARISON_HPP
 #define OPERON_COMPARISON_HPP
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <iterator>
+#include <ranges>
 #include <type_traits>
+#include <utility>
 
 #include "contracts.hpp"
 #include "types.hpp"
@@ -74,6 +79,50 @@ struct LessEqual {
     }
 };
 
+namespace detail {
+    // both comparison results of M objectives at once: bit 0 is set if some a[i] < b[i] and bit 1 if some a[i] > b[i]
+    // (by more than eps, which is the same as Less for eps >= 0)
+    // - the loop has a fixed trip count and no branches, so the compiler unrolls and vectorizes it
+    template<std::size_t M, std::floating_point T>
+    inline auto DominanceKernel(T const* a, T const* b, T eps) noexcept -> uint8_t
+    {
+        uint8_t r{0};
+        uint8_t v{0};
+        for (auto i = 0UL; i < M; ++i) {
+            r |= static_cast<uint8_t>(b[i] - a[i] > eps);
+            v |= static_cast<uint8_t>(a[i] - b[i] > eps);
+        }
+        return r | static_cast<uint8_t>(v << 1U);
+    }
+
+    // the largest objective count compared with a single kernel
+    constexpr std::size_t DominanceKernelSize{8};
+
+    // fitness vectors with two to eight objectives use a single kernel, longer ones are compared in blocks of eight
+    // with an early exit when neither dominates the other
+    template<std::floating_point T>
+    inline auto Dominance(T const* a, T const* b, std::size_t n, T eps) noexcept -> Operon::Dominance
+    {
+        constexpr auto block{DominanceKernelSize};
+        constexpr uint8_t none{static_cast<uint8_t>(Operon::Dominance::None)};
+        switch (n) {
+        case 2: return static_cast<Operon::Dominance>(DominanceKernel<2>(a, b, eps)); // NOLINT
+        case 3: return static_cast<Operon::Dominance>(DominanceKernel<3>(a, b, eps)); // NOLINT
+        case 4: return static_cast<Operon::Dominance>(DominanceKernel<4>(a, b, eps)); // NOLINT
+        case 5: return static_cast<Operon::Dominance>(DominanceKernel<5>(a, b, eps)); // NOLINT
+        case 6: return static_cast<Operon::Dominance>(DominanceKernel<6>(a, b, eps)); // NOLINT
+        case 7: return static_cast<Operon::Dominance>(DominanceKernel<7>(a, b, eps)); // NOLINT
+        case 8: return static_cast<Operon::Dominance>(DominanceKernel<8>(a, b, eps)); // NOLINT
+        default: break;
+        }
+        uint8_t d{0};
+        auto i{0UL};
+        for (; i + block <= n && d != none; i += block) { d |= DominanceKernel<block>(a + i, b + i, eps); }
+        for (; i < n && d != none; ++i) { d |= DominanceKernel<1>(a + i, b + i, eps); }
+        return static_cast<Operon::Dominance>(d);
+    }
+} // namespace detail
+
 template <bool CheckNan = false>
 struct ParetoDominance {
     template<std::forward_iterator Input1, std::forward_iterator Input2>
@@ -116,6 +165,25 @@ struct ParetoDominance {
     {
         return (*this)(std::begin(r1), std::end(r1), std::begin(r2), std::end(r2), eps);
     }
+
+    // contiguous fitness vectors (eg. Individual::Fitness) use the kernels in detail::Dominance
+    template<std::ranges::contiguous_range R1, std::ranges::contiguous_range R2>
+    inline auto operator()(R1&& r1, R2&& r2) const noexcept -> Dominance
+    {
+        return (*this)(std::forward<R1>(r1), std::forward<R2>(r2), Operon::Scalar{0});
+    }
+
+    template<std::ranges::contiguous_range R1, std::ranges::contiguous_range R2>
+    inline auto operator()(R1&& r1, R2&& r2, Operon::Scalar eps) const noexcept -> Dominance
+    {
+        using T = std::ranges::range_value_t<R1>;
+        if constexpr (!CheckNan && std::floating_point<T> && std::same_as<T, std::ranges::range_value_t<R2>>) {
+            auto const n = std::min(std::ranges::size(r1), std::ranges::size(r2));
+            return detail::Dominance(std::ranges::data(r1), std::ranges::data(r2), n, static_cast<T>(eps));
+        } else {
+            return (*this)(std::begin(r1), std::end(r1), std::begin(r2), std::end(r2), eps);
+        }
+    }
 };
 
 } // namespace Operon
@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_CORESET_HPP
+#define OPERON_CORESET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "operon/operon_export.hpp"
+#include "problem.hpp"
+#include "types.hpp"
+
+namespace Operon {
+
+// the selection of the representative rows of the training range
+// - Stratified: the training rows are sorted by the target and split into strata of (almost) equal size, one random
+//   row of each stratum is kept and weighted by the size of its stratum
+// - KMeans: the lightweight coreset of k-means, the rows are sampled with probability (1/n + d(x)^2 / sum d^2) / 2,
+//   where d is the distance of the (standardized) inputs to their mean, ie. the D^2 sampling of the k-means++ seeding
+//   from the mean, mixed with uniform sampling
+// - Leverage: the rows are sampled with probability (1/n + h(x) / sum h) / 2, where h are the statistical leverages
+//   of the (standardized) inputs and an intercept, the rows that determine a linear fit are kept with a high probability
+// the sampled rows are drawn with replacement and weighted by the inverse of their expected count, a row drawn
+// several times is kept once with the sum of the weights
+enum class CoresetMethod : std::uint8_t { Stratified, KMeans, Leverage };
+
+struct Coreset {
+    std::vector<std::size_t> Rows;       // the rows of the dataset, in increasing order
+    std::vector<Operon::Scalar> Weights; // the (estimated) number of training rows represented by each row
+};
+
+// selects at most size rows of the training range of the problem, the weights sum to the size of the training range
+// (exactly for Stratified, in expectation otherwise)
+// - the whole training range is returned with unit weights if it has at most size rows
+// - throws std::invalid_argument if size is zero
+OPERON_EXPORT auto SelectCoreset(Problem const& problem, std::size_t size, CoresetMethod method, Operon::RandomGenerator& random) -> Coreset;
+
+// a copy of the problem restricted to the rows of the coreset, with the weights as an additional variable
+// - the dataset holds the rows of the coreset (the training range), then the rows of the test and validation ranges
+//   with unit weights, the variables keep their names, hashes and transforms
+// - the target, the inputs and the primitive set are copied, the weight variable is not an input
+// - the weight variable is given to the evaluators and to the optimizer of the reduced problem (see
+//   Evaluator::SetWeights and OptimizerBase::SetWeights), the weighted error then estimates the error on the whole
+//   training range
+OPERON_EXPORT auto ReduceProblem(Problem const& problem, Coreset const& coreset, std::string const& weightName = "coreset_weight") -> Problem;
+
+} // namespace Operon
+
+#endif
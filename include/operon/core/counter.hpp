@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_CORE_COUNTER_HPP
+#define OPERON_CORE_COUNTER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "operon/operon_export.hpp"
+
+namespace Operon {
+
+// a small number identifying the calling thread, threads are numbered in the order in which they first ask for it
+// - spreads the workers of an executor over the shards of the counters below
+OPERON_EXPORT auto ThreadIndex() noexcept -> std::size_t;
+
+// number of shards of a ShardedCounter, the smallest power of two not less than the number of hardware threads
+OPERON_EXPORT auto ShardCount() noexcept -> std::size_t;
+
+// a counter that is incremented by many threads and read rarely
+// - each thread adds to its own cache line (threads with the same index modulo the number of shards share one),
+//   so that the workers do not contend for the same cache line, a read sums the shards
+// - the interface is the subset of std::atomic used by the evaluator counters
+// - a store is not atomic with respect to concurrent increments, it is meant for resetting or restoring the counter
+class ShardedCounter {
+public:
+    ShardedCounter()
+        : mask_(ShardCount() - 1)
+        , shards_(std::make_unique<Shard[]>(mask_ + 1)) // NOLINT
+    {
+    }
+
+    explicit ShardedCounter(uint64_t value)
+        : ShardedCounter()
+    {
+        store(value);
+    }
+
+    ShardedCounter(ShardedCounter const&) = delete;
+    ShardedCounter(ShardedCounter&&) = delete;
+    auto operator=(ShardedCounter const&) -> ShardedCounter& = delete;
+    auto operator=(ShardedCounter&&) -> ShardedCounter& = delete;
+    ~ShardedCounter() = default;
+
+    // NOLINTBEGIN(readability-identifier-naming)
+    auto fetch_add(uint64_t value) noexcept -> void { AddLocal(value); }
+
+    [[nodiscard]] auto load() const noexcept -> uint64_t
+    {
+        uint64_t sum{0};
+        for (auto i = 0UL; i <= mask_; ++i) { sum += shards_[i].Value.load(std::memory_order_relaxed); }
+        return sum;
+    }
+
+    auto store(uint64_t value) noexcept -> void
+    {
+        for (auto i = 0UL; i <= mask_; ++i) { shards_[i].Value.store(0, std::memory_order_relaxed); }
+        shards_[0].Value.store(value, std::memory_order_relaxed);
+    }
+    // NOLINTEND(readability-identifier-naming)
+
+    // adds to the shard of the calling thread and returns the previous value of the shard
+    auto AddLocal(uint64_t value) noexcept -> uint64_t
+    {
+        return shards_[ThreadIndex() & mask_].Value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    auto operator+=(uint64_t value) noexcept -> ShardedCounter& { AddLocal(value); return *this; }
+    auto operator++() noexcept -> ShardedCounter& { AddLocal(1); return *this; }
+    auto operator=(uint64_t value) noexcept -> ShardedCounter& { store(value); return *this; }
+
+    operator uint64_t() const noexcept { return load(); } // NOLINT(google-explicit-constructor)
+
+private:
+    struct alignas(64) Shard { // NOLINT
+        std::atomic<uint64_t> Value{0};
+    };
+
+    std::size_t mask_;
+    std::unique_ptr<Shard[]> shards_; // NOLINT
+};
+
+} // namespace Operon
+
+#endif
@@ -6,7 +6,11 @@
 
 #include <Eigen/Core>
 
+#include <memory>
 #include <optional>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "operon/operon_export.hpp"
 #include "contracts.hpp"
@@ -14,8 +18,12 @@
 #include "types.hpp"
 #include "variable.hpp"
 
+namespace tf { class Executor; } // NOLINT
+
 namespace Operon {
 
+class DatasetCodes;
+
 // a dataset variable described by: name, hash value (for hashing), data column index
 
 class OPERON_EXPORT Dataset {
@@ -25,10 +33,20 @@ public:
     using Matrix = Eigen::Array<Operon::Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor>;
     using Map = Eigen::Map<Matrix const>;
 
+    struct CsvOptions {
+        bool HasHeader{true};
+        std::vector<std::string> Columns; // the columns to load, in file order (all of them when empty)
+        std::size_t Threads{0};           // zero means one thread per hardware thread
+        std::size_t Cardinality{0};       // the variables with at most this many distinct values are encoded (see Encode)
+    };
+
 private:
     Variables variables_;
     Matrix values_;
     Map map_;
+    std::shared_ptr<void const> storage_; // keeps the data of a view alive (eg. a memory-mapped file)
+    bool mapped_{false};                   // the view is a memory-mapped file (see ReadBinary), the paging hints only apply to it
+    std::shared_ptr<DatasetCodes const> codes_; // the dictionary codes of the variables (see Encode)
 
     Dataset();
 
@@ -42,10 +60,14 @@ private:
 public:
     explicit Dataset(const std::string& path, bool hasHeader = false);
 
+    // a copy of a view is a view of the same data
     Dataset(Dataset const& rhs)
         : variables_(rhs.variables_)
         , values_(rhs.values_)
-        , map_(values_.data(), values_.rows(), values_.cols())
+        , map_(rhs.IsView() ? rhs.map_.data() : values_.data(), rhs.map_.rows(), rhs.map_.cols())
+        , storage_(rhs.storage_)
+        , mapped_(rhs.mapped_)
+        , codes_(rhs.codes_)
     {
     }
 
@@ -53,6 +75,9 @@ public:
         : variables_(std::move(rhs.variables_))
         , values_(std::move(rhs.values_))
         , map_(rhs.map_)
+        , storage_(std::move(rhs.storage_))
+        , mapped_(rhs.mapped_)
+        , codes_(std::move(rhs.codes_))
     {
     }
 
@@ -78,6 +103,9 @@ public:
         if (this != &rhs) {
             variables_ = std::move(rhs.variables_);
             values_ = std::move(rhs.values_);
+            storage_ = std::move(rhs.storage_);
+            mapped_ = rhs.mapped_;
+            codes_ = std::move(rhs.codes_);
             new (&map_) Map(rhs.map_.data(), rhs.map_.rows(), rhs.map_.cols()); // we use placement new (no allocation)
         }
         return *this;
@@ -85,11 +113,89 @@ public:
 
     void Swap(Dataset& rhs) noexcept
     {
+        Map const lhsMap{map_};
+        Map const rhsMap{rhs.map_};
+        auto const lhsView{IsView()};
+        auto const rhsView{rhs.IsView()};
         variables_.swap(rhs.variables_);
         values_.swap(rhs.values_);
-        new (&map_) Map(values_.data(), values_.rows(), values_.cols()); // we use placement new (no allocation)
+        storage_.swap(rhs.storage_);
+        std::swap(mapped_, rhs.mapped_);
+        codes_.swap(rhs.codes_);
+        // we use placement new (no allocation)
+        new (&map_) Map(rhsView ? rhsMap.data() : values_.data(), rhsMap.rows(), rhsMap.cols());
+        new (&rhs.map_) Map(lhsView ? lhsMap.data() : rhs.values_.data(), lhsMap.rows(), lhsMap.cols());
     }
 
+    // binary column-major format that can be memory-mapped (see WriteBinary)
+    // - header: magic, version, scalar width, rows, columns, data offset, then the hash and name of each variable
+    // - data: the columns one after the other, starting at an offset aligned to 64 bytes
+    [[nodiscard]] static auto IsBinary(std::string const& path) -> bool;
+
+    // returns a view over the memory-mapped file when all the columns are read and the file uses the width of Operon::Scalar,
+    // otherwise the selected columns (all of them if empty) are converted into a dataset that owns its data
+    [[nodiscard]] static auto ReadBinary(std::string const& path, std::vector<std::string> const& columns = {}) -> Dataset;
+    auto WriteBinary(std::string const& path) const -> void;
+
+    // parallel csv loader: the file is memory-mapped, split into chunks at line boundaries and the chunks are parsed
+    // concurrently into the columns of the matrix, only the selected columns are materialized
+    // - fields are separated by commas and may be enclosed in double quotes, but cannot contain commas or line breaks
+    [[nodiscard]] static auto LoadCsv(std::string const& path, CsvOptions const& options) -> Dataset;
+
+#if defined(HAVE_ARROW)
+    // true if the file is in the arrow ipc (feather v2) or parquet format
+    [[nodiscard]] static auto IsArrow(std::string const& path) -> bool;
+
+    // reads the given columns (all of them if empty) of an arrow ipc or parquet file, in file order
+    // - the file is memory-mapped and only the selected columns are decoded, then copied into the columns of the matrix
+    // - supports floating point and integer columns without missing values
+    [[nodiscard]] static auto ReadArrow(std::string const& path, std::vector<std::string> const& columns = {}) -> Dataset;
+#endif
+
+    // paging hints for datasets that are memory-mapped views (see ReadBinary and IsMapped), ignored for the other
+    // datasets, in particular for the shared in-memory views (see Share) whose released pages would read as zeros
+    // - Prefetch starts reading the given rows of all the columns in the background
+    // - Evict releases the memory of the given rows, which are read again from the file when accessed
+    // together they allow streaming over datasets larger than the memory, one block of rows at a time
+    auto Prefetch(Range rows) const -> void;
+    auto Evict(Range rows) const -> void;
+
+    // moves the values into a reference-counted read-only buffer, making this dataset a view of it
+    // - the copies of the dataset (eg. the problems of the islands, the targets or the cv folds) then share one buffer
+    // - a view is already shared and is left unchanged
+    // - like the other views, the dataset can no longer be shuffled, normalized or standardized
+    auto Share() -> void;
+
+    // applies the transparent huge page hint to the values (see AdviseHugePages)
+    auto AdviseHugePages() const -> bool;
+
+    // keeps a dictionary-encoded copy of the variables with at most maxCardinality distinct values (see DatasetCodes),
+    // which the interpreters decode instead of reading the columns, and returns the number of encoded variables
+    // - the copies of the dataset share the codes, the operations that modify the values (and Select, SelectRows) drop
+    //   them, so the codes are built after the data is shuffled or scaled
+    // - zero drops the codes
+    auto Encode(std::size_t maxCardinality) -> std::size_t;
+
+    // the codes kept by the dataset, null if none
+    [[nodiscard]] auto Codes() const noexcept -> DatasetCodes const* { return codes_.get(); }
+
+    // a dataset that owns a copy of the given variables, in the order of their columns
+    [[nodiscard]] auto Select(Operon::Span<Operon::Hash const> hashes) const -> Dataset;
+
+    // a dataset that owns a copy of the given rows (in the given order) of all the variables
+    [[nodiscard]] auto SelectRows(Operon::Span<std::size_t const> rows) const -> Dataset;
+
+    // appends the rows at the end of the dataset, the columns of rows are in the order of the columns of the dataset
+    // - the existing rows keep their values and their indices, but the values are reallocated (the spans returned by
+    //   GetValues are invalidated)
+    // - the dataset must own its values (see IsView)
+    auto AppendRows(Eigen::Ref<Matrix const> rows) -> void;
+
+    // appends a column with the given values (one per row) and returns the new variable
+    // - the existing variables keep their indices, the values are reallocated (see AppendRows)
+    // - the dataset must own its values and the name must not be used by another variable
+    auto AddVariable(std::string const& name, Operon::Span<Operon::Scalar const> values) -> Variable;
+
     auto operator==(Dataset const& rhs) const noexcept -> bool
     {
         return
@@ -97,11 +203,12 @@ public:
             Cols() == rhs.Cols() &&
             variables_.size() == rhs.variables_.size() &&
             std::equal(variables_.begin(), variables_.end(), rhs.variables_.begin()) &&
-            values_.isApprox(rhs.values_);
+            map_.isApprox(rhs.map_);
     }
 
     // check if we own the data or if we are a view over someone else's data
     [[nodiscard]] auto IsView() const noexcept -> bool { return values_.data() != map_.data(); }
+    [[nodiscard]] auto IsMapped() const noexcept -> bool { return mapped_; }
 
     template<std::integral T = Eigen::Index>
     [[nodiscard]] auto Rows() const -> T { return static_cast<T>(map_.rows()); }
@@ -125,6 +232,10 @@ public:
     [[nodiscard]] auto GetValues(int64_t index) const noexcept -> Operon::Span<const Operon::Scalar>;
     [[nodiscard]] auto GetValues(Variable const& variable) const noexcept -> Operon::Span<const Operon::Scalar> { return GetValues(variable.Hash); }
 
+    // the values of the rows of the range, read lag rows earlier (see Node::Lag)
+    // - throws std::runtime_error when the lag reaches before the first row of the data
+    [[nodiscard]] auto GetValues(Operon::Hash hash, Operon::Range range, std::size_t lag) const -> Operon::Span<const Operon::Scalar>;
+
     [[nodiscard]] auto GetVariable(const std::string& name) const noexcept -> std::optional<Variable>;
     [[nodiscard]] auto GetVariable(Operon::Hash hash) const noexcept -> std::optional<Variable>;
 
@@ -135,14 +246,37 @@ public:
         return variables;
     }
 
+    // a random order of the rows, without permuting the data (eg. for SelectRows or to sample the rows by index)
+    [[nodiscard]] auto RandomPermutation(Operon::RandomGenerator& random) const -> std::vector<Eigen::Index>;
+
+    // permutes the rows randomly, row i moves to RandomPermutation(random)[i]
     void Shuffle(Operon::RandomGenerator& random);
 
     void Normalize(size_t i, Range range);
 
+    // row i moves to row indices[i]
     void PermuteRows(std::vector<Eigen::Index> const& indices);
 
     // standardize column i using mean and stddev calculated over the specified range
-    void Standardize(size_t i, Range range);
+    // - in place, the values are rewritten (the dataset must own them)
+    // - otherwise, the values are left unchanged and the standardization is stored as the transform of the variable,
+    //   which the interpreters fold into the weights of the variable nodes (this also works for views)
+    void Standardize(size_t i, Range range, bool inPlace = true);
+
+    // parallel versions of the above, with the same results
+    // - the rows are permuted one column per task, the columns are normalized and standardized in blocks of rows
+    void Shuffle(Operon::RandomGenerator& random, tf::Executor& executor);
+    void PermuteRows(std::vector<Eigen::Index> const& indices, tf::Executor& executor);
+    void Normalize(Operon::Span<std::size_t const> columns, Range range, tf::Executor& executor);
+    void Standardize(Operon::Span<std::size_t const> columns, Range range, bool inPlace, tf::Executor& executor);
+
+    // the interpreters read the values x of the variable as scale * x + offset, without rewriting the data
+    // - the transform is kept by the copies of the dataset and by Select and SelectRows, but not by WriteBinary
+    void SetTransform(Operon::Hash hash, Operon::Scalar scale, Operon::Scalar offset);
+    void ClearTransforms() noexcept;
+
+    // the scale and offset of the variable, {1, 0} if it has no transform (or does not exist)
+    [[nodiscard]] auto GetTransform(Operon::Hash hash) const noexcept -> std::pair<Operon::Scalar, Operon::Scalar>;
 };
 } // namespace Operon
 
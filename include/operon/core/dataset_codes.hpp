@@ -0,0 +1,203 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_DATASET_CODES_HPP
+#define OPERON_DATASET_CODES_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "operon/operon_export.hpp"
+#include "dataset.hpp"
+#include "types.hpp"
+
+namespace Operon {
+
+// the storage of an encoded variable
+// - Dictionary: 8 or 16 bit codes into a dictionary of the distinct values (lossless)
+// - Half: IEEE 754 binary16, 11 significant bits (about 3 decimal digits) and a range of +-65504 (lossy)
+// - BFloat16: the upper half of a binary32, 8 significant bits and the range of a float (lossy)
+enum class ValueEncoding : std::uint8_t { Dictionary, Half, BFloat16 };
+
+namespace detail {
+    // the conversions round to the nearest even value, the values out of the range of a half become infinite
+    // - a subnormal half is widened by a multiplication, which does not work if denormals are flushed to zero
+    inline auto HalfToFloat(std::uint16_t h) noexcept -> float
+    {
+        constexpr auto magic = 0x1p112F; // 2^(127 - 15)
+        auto const sign = static_cast<std::uint32_t>(h & 0x8000U) << 16U;
+        auto bits = std::bit_cast<std::uint32_t>(std::bit_cast<float>(static_cast<std::uint32_t>(h & 0x7fffU) << 13U) * magic);
+        bits |= (h & 0x7c00U) == 0x7c00U ? 0x7f800000U : 0U; // infinity or nan
+        return std::bit_cast<float>(bits | sign);
+    }
+
+    inline auto FloatToHalf(float f) noexcept -> std::uint16_t
+    {
+        constexpr std::uint32_t infinity{255U << 23U};
+        constexpr std::uint32_t overflow{(127U + 16U) << 23U};
+        constexpr std::uint32_t denormal{((127U - 15U) + (23U - 10U) + 1U) << 23U};
+        auto u = std::bit_cast<std::uint32_t>(f);
+        auto const sign = u & 0x80000000U;
+        u ^= sign;
+        std::uint32_t h{0};
+        if (u >= overflow) {
+            h = u > infinity ? 0x7e00U : 0x7c00U;
+        } else if (u < (113U << 23U)) {
+            // the addition aligns the mantissa of the subnormal half and rounds it
+            h = std::bit_cast<std::uint32_t>(std::bit_cast<float>(u) + std::bit_cast<float>(denormal)) - denormal;
+        } else {
+            auto const odd = (u >> 13U) & 1U;
+            u += (static_cast<std::uint32_t>(15 - 127) << 23U) + 0xfffU + odd; // rebias the exponent and round
+            h = u >> 13U;
+        }
+        return static_cast<std::uint16_t>(h | (sign >> 16U));
+    }
+
+    inline auto BFloat16ToFloat(std::uint16_t h) noexcept -> float
+    {
+        return std::bit_cast<float>(static_cast<std::uint32_t>(h) << 16U);
+    }
+
+    inline auto FloatToBFloat16(float f) noexcept -> std::uint16_t
+    {
+        auto const u = std::bit_cast<std::uint32_t>(f);
+        if ((u & 0x7fffffffU) > 0x7f800000U) { return static_cast<std::uint16_t>((u >> 16U) | 0x40U); } // quiet nan
+        return static_cast<std::uint16_t>((u + 0x7fffU + ((u >> 16U) & 1U)) >> 16U);
+    }
+} // namespace detail
+
+// the encoded values of a variable from a given row
+// - dictionary codes: the value of row i is Dictionary[Codes[i]], the codes are 8 or 16 bit wide (Width is the number
+//   of bytes of a code)
+// - evenly spaced dictionary values (Linear): the value of row i is also Base + Step * Codes[i], which is converted
+//   instead of read from the dictionary
+// - half or bfloat16 values: Codes holds the 16 bit values, there is no dictionary
+struct EncodedValues {
+    void const* Codes{nullptr};
+    Operon::Scalar const* Dictionary{nullptr};
+    std::uint8_t Width{0};
+    ValueEncoding Encoding{ValueEncoding::Dictionary};
+    bool Linear{false};
+    Operon::Scalar Base{0};
+    Operon::Scalar Step{0};
+
+    [[nodiscard]] auto Empty() const -> bool { return Codes == nullptr; }
+
+    // true if the values are looked up in the dictionary, the other values are converted from the codes
+    [[nodiscard]] auto Gathered() const -> bool { return Encoding == ValueEncoding::Dictionary && !Linear; }
+
+    // writes w * x + b for the values x of the rows [row, row + n) into out
+    template<typename T>
+    auto Decode(std::size_t row, std::size_t n, T* out, T w = T{1}, T b = T{0}) const -> void
+    {
+        Visit(row, [&](auto const& x) {
+            for (auto i = 0UL; i < n; ++i) { out[i] = static_cast<T>(x(i)) * w + b; }
+        });
+    }
+
+    // adds w * x to out, for the values x of the rows [row, row + n)
+    template<typename T>
+    auto Accumulate(std::size_t row, std::size_t n, T* out, T w) const -> void
+    {
+        Visit(row, [&](auto const& x) {
+            for (auto i = 0UL; i < n; ++i) { out[i] += static_cast<T>(x(i)) * w; }
+        });
+    }
+
+private:
+    // calls f with the function that widens the value of row + i, for each storage
+    template<typename F>
+    auto Visit(std::size_t row, F&& f) const -> void
+    {
+        auto const* codes16 = static_cast<std::uint16_t const*>(Codes) + row;
+        switch (Encoding) {
+        case ValueEncoding::Half: {
+            f([codes16](auto i) { return detail::HalfToFloat(codes16[i]); });
+            break;
+        }
+        case ValueEncoding::BFloat16: {
+            f([codes16](auto i) { return detail::BFloat16ToFloat(codes16[i]); });
+            break;
+        }
+        default: {
+            auto const* dictionary = Dictionary;
+            // the conversion vectorizes, the lookups are gathers
+            if (Linear && Width == 1) {
+                auto const* codes8 = static_cast<std::uint8_t const*>(Codes) + row;
+                f([codes8, b = Base, s = Step](auto i) { return (static_cast<Operon::Scalar>(codes8[i]) * s) + b; });
+            } else if (Linear) {
+                f([codes16, b = Base, s = Step](auto i) { return (static_cast<Operon::Scalar>(codes16[i]) * s) + b; });
+            } else if (Width == 1) {
+                auto const* codes8 = static_cast<std::uint8_t const*>(Codes) + row;
+                f([codes8, dictionary](auto i) { return dictionary[codes8[i]]; });
+            } else {
+                f([codes16, dictionary](auto i) { return dictionary[codes16[i]]; });
+            }
+        }
+        }
+    }
+};
+
+// dictionary-encoded copy of the variables of a dataset with few distinct values (eg. categorical or integer codes)
+// - a variable with at most 256 distinct values is stored as 8 bit codes, one with at most 65536 as 16 bit codes,
+//   the other variables are not encoded, nor are those whose codes and dictionary would not be smaller than the column
+// - the interpreter reads a quarter (half) of the bytes of a column: the values with a cheap conversion (the evenly
+//   spaced values and the 16 bit floating point values) are converted by each node of the variable, the values
+//   looked up in the dictionary are decoded once per batch, the nodes of the variable then read them like a column of
+//   the dataset (see Tape::Decode)
+// - a dataset can keep the codes of its variables, which the interpreters then use by default (see Dataset::Encode)
+// - the values are compared bitwise, NaN is a value like any other
+// - the codes of evenly spaced values (eg. integer codes) are their ranks, the decoding then converts the codes without
+//   the dictionary (see EncodedValues::Linear)
+// - the variables with more significant digits than they need (eg. sensor readings) can instead be stored as 16 bit
+//   floating point values (see Narrow), which are widened the same way
+class OPERON_EXPORT DatasetCodes {
+public:
+    static constexpr std::size_t MaxCardinality{65536};
+
+    DatasetCodes(Dataset const& dataset, Operon::Span<Operon::Hash const> variables, std::size_t maxCardinality = MaxCardinality);
+
+    // all the variables of the dataset
+    explicit DatasetCodes(Dataset const& dataset, std::size_t maxCardinality = MaxCardinality);
+
+    [[nodiscard]] auto Rows() const -> std::size_t { return rows_; }
+
+    // number of encoded variables
+    [[nodiscard]] auto Size() const -> std::size_t { return columns_.size(); }
+
+    // the values of the variable from the given row, empty if the variable is not encoded
+    [[nodiscard]] auto Values(Operon::Hash hash, std::size_t row = 0) const -> EncodedValues;
+
+    // the number of distinct values of a dictionary-encoded variable (zero if not encoded or not a dictionary)
+    [[nodiscard]] auto Cardinality(Operon::Hash hash) const -> std::size_t;
+
+    // stores the variables as half or bfloat16 values (replacing their dictionary codes, if any), which halves the
+    // bytes read per value with single precision scalars (a quarter with double precision)
+    // - the rounding is not checked, the values only keep 3 (half) or 2 (bfloat16) significant decimal digits
+    // - throws std::invalid_argument if the dataset differs in its rows or lacks a variable, or for a dictionary
+    auto Narrow(Dataset const& dataset, Operon::Span<Operon::Hash const> variables, ValueEncoding encoding) -> void;
+
+    // the storage of an encoded variable, empty if not encoded
+    [[nodiscard]] auto Encoding(Operon::Hash hash) const -> std::optional<ValueEncoding>;
+
+private:
+    struct Column {
+        std::vector<std::uint8_t> Codes8;
+        std::vector<std::uint16_t> Codes16;
+        std::vector<Operon::Scalar> Dictionary;
+        ValueEncoding Encoding{ValueEncoding::Dictionary};
+        bool Linear{false};
+        Operon::Scalar Base{0};
+        Operon::Scalar Step{0};
+    };
+
+    std::size_t rows_;
+    Operon::Map<Operon::Hash, Column> columns_;
+};
+
+} // namespace Operon
+
+#endif
@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_DATASET_TILES_HPP
+#define OPERON_DATASET_TILES_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "operon/operon_export.hpp"
+#include "dataset.hpp"
+#include "types.hpp"
+
+namespace Operon {
+
+// row-blocked copy of some variables of a dataset
+// - the rows are split into tiles of TileRows() rows, a tile stores the values of all the variables for its rows (one
+//   variable after the other) so that the values read by a batch over many variables form a single memory stream
+// - the last tile is padded with zeros
+// - the interpreter reads the variables from the tiles when the tile size equals its batch size and the evaluated
+//   range starts at a tile boundary (see Interpreter::SetTiles), otherwise it reads the columns of the dataset
+class OPERON_EXPORT DatasetTiles {
+public:
+    DatasetTiles(Dataset const& dataset, Operon::Span<Operon::Hash const> variables, std::size_t tileRows);
+
+    // all the variables of the dataset
+    DatasetTiles(Dataset const& dataset, std::size_t tileRows);
+
+    [[nodiscard]] auto TileRows() const -> std::size_t { return tileRows_; }
+    [[nodiscard]] auto Tiles() const -> std::size_t { return tiles_; }
+    [[nodiscard]] auto Rows() const -> std::size_t { return rows_; }
+
+    // distance between the values of a variable in two consecutive tiles
+    [[nodiscard]] auto Stride() const -> std::size_t { return index_.size() * tileRows_; }
+
+    // the values of the variable in the given tile, nullptr if the variable is not tiled
+    [[nodiscard]] auto Values(Operon::Hash hash, std::size_t tile) const -> Operon::Scalar const*;
+
+private:
+    std::size_t tileRows_;
+    std::size_t rows_;
+    std::size_t tiles_;
+    Operon::Map<Operon::Hash, std::size_t> index_; // position of the variables in a tile
+    std::vector<Operon::Scalar> values_;
+};
+
+} // namespace Operon
+
+#endif
@@ -4,12 +4,32 @@
 #ifndef OPERON_DISTANCE_HPP
 #define OPERON_DISTANCE_HPP
 
+#include <cstddef>
+
 #include "types.hpp"
 #include "operon/operon_export.hpp"
 
+namespace tf { class Executor; } // NOLINT
+
+// the distances between sorted vectors of subtree hashes
 namespace Operon::Distance {
     auto OPERON_EXPORT Jaccard(Operon::Vector<Operon::Hash> const& lhs, Operon::Vector<Operon::Hash> const& rhs) noexcept -> double;
     auto OPERON_EXPORT SorensenDice(Operon::Vector<Operon::Hash> const& lhs, Operon::Vector<Operon::Hash> const& rhs) noexcept -> double;
+
+    // one to many: result[i] is the distance between the query and candidates[i]
+    auto OPERON_EXPORT Jaccard(Operon::Vector<Operon::Hash> const& query, Operon::Span<Operon::Vector<Operon::Hash> const> candidates, Operon::Span<double> result) noexcept -> void;
+    auto OPERON_EXPORT SorensenDice(Operon::Vector<Operon::Hash> const& query, Operon::Span<Operon::Vector<Operon::Hash> const> candidates, Operon::Span<double> result) noexcept -> void;
+
+    // many to many: the distances of the pairs i < j in the order (0, 1), (0, 2), ..., (0, n-1), (1, 2), ...
+    // - the result holds n * (n - 1) / 2 values (see PairIndex), the rows are distributed over the executor
+    auto OPERON_EXPORT Jaccard(Operon::Span<Operon::Vector<Operon::Hash> const> hashes, Operon::Span<double> result, tf::Executor& executor) -> void;
+    auto OPERON_EXPORT SorensenDice(Operon::Span<Operon::Vector<Operon::Hash> const> hashes, Operon::Span<double> result, tf::Executor& executor) -> void;
+
+    // the position of the pair (i, j) with i < j < n in the result of the many to many distances
+    constexpr auto PairIndex(std::size_t i, std::size_t j, std::size_t n) noexcept -> std::size_t
+    {
+        return (i * (2 * n - i - 1) / 2) + (j - i - 1);
+    }
 } // namespace Operon::Distance
 
 #endif
@@ -0,0 +1,24 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_CORE_EXECUTOR_HPP
+#define OPERON_CORE_EXECUTOR_HPP
+
+#include "operon/operon_export.hpp"
+
+// forward declaration
+namespace tf { class Executor; class Taskflow; }
+
+namespace Operon {
+
+// runs the taskflow on the executor and returns when all its tasks are done
+// - corun is only allowed from inside a worker of the executor: a worker coruns the taskflow (it executes other tasks
+//   while it waits instead of blocking), any other thread runs it and waits
+// - a worker that coruns can execute any task of the executor, including one of the caller's graph; the tasks must not
+//   share a per-worker (or thread-local) buffer with the code around the call, such buffers are taken from an
+//   ObjectPool instead (see core/pool.hpp)
+OPERON_EXPORT auto RunTaskflow(tf::Executor& executor, tf::Taskflow& taskflow) -> void;
+
+} // namespace Operon
+
+#endif
@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_CORE_FINGERPRINT_HPP
+#define OPERON_CORE_FINGERPRINT_HPP
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include "tree.hpp"
+#include "types.hpp"
+
+namespace Operon {
+
+// a fixed-size bit signature of the set of subtree hashes of a tree
+// - each hash value sets one bit, the intersection of two trees is estimated by the popcount of the bitwise and
+// - the hashes do not have to be sorted and a distance query needs no allocation, but distinct subtrees whose
+//   bits collide count as shared and repeated subtrees count once
+class Fingerprint {
+public:
+    static constexpr std::size_t Bits{512};
+    static constexpr std::size_t Words{Bits / 64};
+    static_assert(std::has_single_bit(Bits) && Bits >= 64);
+
+    Fingerprint() = default;
+
+    explicit Fingerprint(Operon::Span<Operon::Hash const> hashes) noexcept
+    {
+        for (auto h : hashes) { Insert(h); }
+    }
+
+    // the tree must be hashed (see Tree::Hash)
+    explicit Fingerprint(Operon::Tree const& tree) noexcept
+    {
+        for (auto const& n : tree.Nodes()) { Insert(n.CalculatedHashValue); }
+    }
+
+    auto Insert(Operon::Hash h) noexcept -> void
+    {
+        // the top bits of a multiplicative hash, in case the low bits of the hash values are not well mixed
+        auto const b = (h * 0x9e3779b97f4a7c15ULL) >> (64 - std::countr_zero(Bits)); // NOLINT
+        auto const bit = uint64_t{1} << (b % 64); // NOLINT
+        auto& w = words_[b / 64];
+        count_ += static_cast<std::size_t>((w & bit) == 0);
+        w |= bit;
+    }
+
+    // the number of bits that are set
+    [[nodiscard]] auto Count() const noexcept -> std::size_t { return count_; }
+
+    [[nodiscard]] static auto CountIntersect(Fingerprint const& lhs, Fingerprint const& rhs) noexcept -> std::size_t
+    {
+        std::size_t c{0};
+        for (auto i = 0UL; i < Words; ++i) { c += static_cast<std::size_t>(std::popcount(lhs.words_[i] & rhs.words_[i])); }
+        return c;
+    }
+
+    [[nodiscard]] auto Data() const noexcept -> std::array<uint64_t, Words> const& { return words_; }
+
+    auto operator==(Fingerprint const& rhs) const noexcept -> bool = default;
+
+private:
+    std::array<uint64_t, Words> words_{};
+    std::size_t count_{0};
+};
+
+namespace Distance {
+    // same scale as the distances of the sorted hash vectors
+    inline auto Jaccard(Fingerprint const& lhs, Fingerprint const& rhs) noexcept -> double
+    {
+        auto const n = lhs.Count() + rhs.Count();
+        auto const c = Fingerprint::CountIntersect(lhs, rhs);
+        return n == 0 ? 0.0 : static_cast<double>(n - 2 * c) / static_cast<double>(n);
+    }
+
+    inline auto SorensenDice(Fingerprint const& lhs, Fingerprint const& rhs) noexcept -> double
+    {
+        auto const n = lhs.Count() + rhs.Count();
+        auto const c = Fingerprint::CountIntersect(lhs, rhs);
+        return n == 0 ? 0.0 : 1 - 2 * static_cast<double>(c) / static_cast<double>(n);
+    }
+
+    // one to many: result[i] is the distance between the query and candidates[i] (the words of the query stay in registers)
+    inline auto Jaccard(Fingerprint const& query, Operon::Span<Fingerprint const> candidates, Operon::Span<double> result) noexcept -> void
+    {
+        for (auto i = 0UL; i < candidates.size(); ++i) { result[i] = Jaccard(query, candidates[i]); }
+    }
+
+    inline auto SorensenDice(Fingerprint const& query, Operon::Span<Fingerprint const> candidates, Operon::Span<double> result) noexcept -> void
+    {
+        for (auto i = 0UL; i < candidates.size(); ++i) { result[i] = SorensenDice(query, candidates[i]); }
+    }
+} // namespace Distance
+
+} // namespace Operon
+
+#endif
@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_FITNESS_MATRIX_HPP
+#define OPERON_FITNESS_MATRIX_HPP
+
+#include <Eigen/Core>
+#include <vector>
+
+#include "operon/core/comparison.hpp"
+#include "operon/core/individual.hpp"
+#include "operon/core/types.hpp"
+
+namespace Operon {
+
+// structure-of-arrays copy of the fitness of a population
+// - the objective values are stored in one column-major matrix with a row per individual, so that comparisons
+//   and sorts stream over contiguous memory instead of going through the Fitness vector of each individual
+// - the rank and crowding distance (used by NSGA2) are stored alongside
+// - the matrix is a snapshot: it must be assigned again after the fitness of the population changes
+class FitnessMatrix {
+public:
+    using Matrix = Eigen::Array<Operon::Scalar, -1, -1, Eigen::ColMajor>;
+
+    FitnessMatrix() = default;
+    explicit FitnessMatrix(Operon::Span<Individual const> pop) { Assign(pop); }
+
+    // the storage is reused between assignments of populations of the same size
+    auto Assign(Operon::Span<Individual const> pop) -> void
+    {
+        auto const n { std::ssize(pop) };
+        auto const m { pop.empty() ? Eigen::Index{0} : static_cast<Eigen::Index>(pop.front().Size()) };
+        values_.resize(n, m);
+        rank_.resize(pop.size());
+        distance_.resize(pop.size());
+        for (auto i = 0L; i < n; ++i) {
+            auto const& ind = pop[i];
+            EXPECT(std::ssize(ind.Fitness) == m);
+            values_.row(i) = Eigen::Map<Eigen::Array<Operon::Scalar, 1, -1> const>(ind.Fitness.data(), m);
+            rank_[i] = ind.Rank;
+            distance_[i] = ind.Distance;
+        }
+    }
+
+    [[nodiscard]] auto Rows() const -> std::size_t { return static_cast<std::size_t>(values_.rows()); }
+    [[nodiscard]] auto Cols() const -> std::size_t { return static_cast<std::size_t>(values_.cols()); }
+
+    [[nodiscard]] auto operator()(std::size_t i, std::size_t k) const -> Operon::Scalar { return values_(static_cast<Eigen::Index>(i), static_cast<Eigen::Index>(k)); }
+
+    // the values of objective k for all the individuals
+    [[nodiscard]] auto Objective(std::size_t k) const -> Operon::Span<Operon::Scalar const>
+    {
+        return { values_.col(static_cast<Eigen::Index>(k)).data(), Rows() };
+    }
+
+    [[nodiscard]] auto Rank(std::size_t i) const -> std::size_t { return rank_[i]; }
+    [[nodiscard]] auto Distance(std::size_t i) const -> Operon::Scalar { return distance_[i]; }
+    [[nodiscard]] auto Values() const -> Matrix const& { return values_; }
+
+private:
+    Matrix values_;
+    std::vector<std::size_t> rank_;
+    std::vector<Operon::Scalar> distance_;
+};
+
+// the comparison functors on individuals (SingleObjectiveComparison, LexicographicalComparison, CrowdedComparison)
+// expressed on the rows of fitness matrices
+// - FromCallback recognizes these functors inside a ComparisonCallback, other callables (eg. lambdas) are not
+//   recognized and the operators keep comparing the individuals with the callback
+class FitnessComparison {
+public:
+    enum class Order : int { None, SingleObjective, Lexicographic, Crowded };
+
+    FitnessComparison() = default;
+    FitnessComparison(Order order, std::size_t objective)
+        : order_(order)
+        , objective_(objective)
+    {
+    }
+
+    static auto FromCallback(ComparisonCallback const& cb) -> FitnessComparison
+    {
+        if (auto const* c = cb.target<SingleObjectiveComparison>(); c != nullptr) {
+            return { Order::SingleObjective, c->GetObjectiveIndex() };
+        }
+        if (cb.target<LexicographicalComparison>() != nullptr) {
+            return { Order::Lexicographic, 0 };
+        }
+        if (cb.target<CrowdedComparison>() != nullptr) {
+            return { Order::Crowded, 0 };
+        }
+        return {};
+    }
+
+    // returns true if row i of a is better than row j of b
+    auto operator()(FitnessMatrix const& a, std::size_t i, FitnessMatrix const& b, std::size_t j) const -> bool
+    {
+        Operon::Less less;
+        switch (order_) {
+        case Order::SingleObjective: {
+            return less(a(i, objective_), b(j, objective_));
+        }
+        case Order::Lexicographic: {
+            for (auto k = 0UL; k < a.Cols(); ++k) {
+                if (less(a(i, k), b(j, k))) { return true; }
+                if (less(b(j, k), a(i, k))) { return false; }
+            }
+            return false;
+        }
+        case Order::Crowded: {
+            if (a.Rank(i) != b.Rank(j)) { return a.Rank(i) < b.Rank(j); }
+            return less(b.Distance(j), a.Distance(i));
+        }
+        default: {
+            return false;
+        }
+        }
+    }
+
+    auto operator()(FitnessMatrix const& f, std::size_t i, std::size_t j) const -> bool { return (*this)(f, i, f, j); }
+
+    explicit operator bool() const { return order_ != Order::None; }
+
+    [[nodiscard]] auto GetOrder() const -> Order { return order_; }
+    [[nodiscard]] auto GetObjectiveIndex() const -> std::size_t { return objective_; }
+
+private:
+    Order order_{Order::None};
+    std::size_t objective_{0};
+};
+
+} // namespace Operon
+
+#endif
@@ -7,8 +7,10 @@
 #include "comparison.hpp"
 #include "tree.hpp" 
 #include "types.hpp" 
+#include "operon/error_metrics/error_accumulator.hpp"
 #include <cstddef>
 #include <functional>
+#include <optional>
 
 namespace Operon {
 
@@ -19,6 +21,9 @@ struct Individual {
     Operon::Vector<Operon::Scalar> Fitness;
     size_t Rank{}; // domination rank; used by NSGA2
     Operon::Scalar Distance{}; // crowding distance; used by NSGA2
+    Operon::Hash Semantic{}; // hash of the outputs on a sample of rows (zero if not computed, see Evaluator::SetSemanticHashing)
+    std::optional<ErrorAccumulator> Statistics; // moments of the predictions and the target over the training rows (see Evaluator::SetRecordStatistics)
+    Operon::Vector<Operon::Scalar> CaseErrors; // absolute errors on a sample of the training rows (empty if not computed, see Evaluator::SetCaseSample)
 
     inline auto operator[](size_t const i) noexcept -> Operon::Scalar& { return Fitness[i]; }
     inline auto operator[](size_t const i) const noexcept -> Operon::Scalar { return Fitness[i]; }
@@ -76,7 +81,7 @@ struct ParetoComparison {
         EXPECT(std::size(lhs.Fitness) == std::size(rhs.Fitness));
         auto const& fit1 = lhs.Fitness;
         auto const& fit2 = rhs.Fitness;
-        return ParetoDominance{}(fit1.begin(), fit1.end(), fit2.begin(), fit2.end(), eps) == Dominance::Left;
+        return ParetoDominance{}(fit1, fit2, eps) == Dominance::Left;
     }
 };
 
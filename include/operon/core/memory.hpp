@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_CORE_MEMORY_HPP
+#define OPERON_CORE_MEMORY_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "operon/core/pool.hpp"
+#include "operon/core/types.hpp"
+#include "operon/operon_export.hpp"
+
+namespace Operon {
+
+// asks the kernel to back the range with transparent huge pages (madvise(MADV_HUGEPAGE) on linux)
+// - reduces the TLB misses when large buffers are scanned repeatedly (eg. the dataset columns, the evaluation buffers)
+// - only the whole huge pages inside the range are affected, memory that was already touched is collapsed
+//   later by the kernel (khugepaged), so the hint is best applied right after allocation
+// - returns false when the hint is not supported
+OPERON_EXPORT auto AdviseHugePages(void const* data, std::size_t bytes) -> bool;
+
+// grows the buffer to n elements, applying the huge page hint to the new storage before it is touched
+template<typename T>
+auto Grow(Operon::Vector<T>& buf, std::size_t n, bool hugePages) -> void
+{
+    if (buf.size() >= n) { return; }
+    if (hugePages && buf.capacity() < n) {
+        buf.reserve(n);
+        (void)AdviseHugePages(buf.data(), n * sizeof(T));
+    }
+    buf.resize(n);
+}
+
+// the bytes allocated by a set of buffers (their capacity, not their size)
+template<typename T, typename A>
+auto CapacityBytes(std::vector<T, A> const& buf) -> std::size_t
+{
+    return buf.capacity() * sizeof(T);
+}
+
+template<typename T, typename A, typename B>
+auto CapacityBytes(std::vector<std::vector<T, A>, B> const& buffers) -> std::size_t
+{
+    auto bytes{buffers.capacity() * sizeof(std::vector<T, A>)};
+    for (auto const& buf : buffers) { bytes += CapacityBytes(buf); }
+    return bytes;
+}
+
+// the buffers of the pool that are not held by a task
+template<typename T, typename A>
+auto CapacityBytes(ObjectPool<std::vector<T, A>> const& pool) -> std::size_t
+{
+    auto bytes{0UL};
+    pool.ForEach([&](auto const& buf) { bytes += sizeof(buf) + CapacityBytes(buf); });
+    return bytes;
+}
+
+// the working memory of one levenberg-marquardt solve for a tree with the given number of coefficients
+// - full: the jacobian and the residuals of all the rows, in the precision of the interpreter
+// - blocked: the jacobian and the residuals of one block of rows, and the normal equations in double precision (see
+//   NormalEquationsCostFunction)
+inline auto FullJacobianBytes(std::size_t rows, std::size_t coefficients) -> std::size_t
+{
+    return rows * (coefficients + 1) * sizeof(Operon::Scalar);
+}
+
+inline auto BlockedJacobianBytes(std::size_t block, std::size_t coefficients) -> std::size_t
+{
+    return (block * (coefficients + 1) * sizeof(Operon::Scalar)) + ((coefficients + 1) * (coefficients + 1) * sizeof(double));
+}
+
+// the bytes held by the subsystems of a run (see GeneticAlgorithmBase::MemoryUsage)
+struct MemoryUsage {
+    std::size_t Dataset{0};    // the values owned by the dataset (a memory-mapped view is paged by the kernel)
+    std::size_t Population{0}; // the parents and the offspring: the individuals, their fitness and the nodes of their trees
+    std::size_t Buffers{0};    // the evaluation buffers of the workers (one slot and one group buffer each), the pipeline of NSGA2
+    std::size_t Jacobian{0};   // the local search of the largest tree of the population on every worker (estimated)
+
+    [[nodiscard]] auto Total() const -> std::size_t { return Dataset + Population + Buffers + Jacobian; }
+};
+
+// the memory of a run that does not depend on the choices of PlanMemory, and the preferred choices
+struct MemoryRequirements {
+    std::size_t Fixed{0};        // eg. the dataset and the population
+    std::size_t Workers{1};      // the number of concurrent evaluations and local searches
+    std::size_t Rows{0};         // the training rows evaluated for each individual
+    std::size_t Coefficients{0}; // the largest number of coefficients of a tree (eg. the maximum length)
+    std::size_t GroupSize{1};    // the preferred evaluation group size (see Evaluator::SetEvaluationGroupSize)
+    std::size_t BlockSize{4096}; // NOLINT, the preferred block of the normal equations (see NormalEquationsCostFunction)
+};
+
+struct MemoryPlan {
+    std::size_t GroupSize{1};
+    bool BlockedJacobian{false}; // solve the normal equations block by block instead of forming the full jacobian
+    std::size_t BlockSize{0};    // the rows of a block of the normal equations (if blocked)
+    std::size_t Bytes{0};        // the estimated peak memory of the run with these choices
+    bool Fits{false};            // false if even the smallest choices exceed the limit (the plan then holds them)
+};
+
+// chooses the evaluation group size and the jacobian strategy so that the run stays within limit bytes
+// - every worker holds a slot buffer (Rows values), a group buffer (GroupSize * Rows values) and the working memory of
+//   the local search (see FullJacobianBytes and BlockedJacobianBytes)
+// - the full jacobian is kept if possible: the group size is halved first (down to 1), then the blocked normal
+//   equations are used and their block is halved (down to MinJacobianBlockSize rows)
+constexpr std::size_t MinJacobianBlockSize{64}; // NOLINT
+OPERON_EXPORT auto PlanMemory(MemoryRequirements const& requirements, std::size_t limit) -> MemoryPlan;
+
+} // namespace Operon
+
+#endif
@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_MINHASH_HPP
+#define OPERON_MINHASH_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "types.hpp"
+#include "operon/operon_export.hpp"
+
+// MinHash sketches of the sorted vectors of subtree hashes compared by Distance::Jaccard
+// - the k-th occurrence of a hash value is a distinct element, so the fraction of equal sketch values estimates the
+//   multiset similarity s = sum(min) / sum(max) and the distance of Distance::Jaccard is (1 - s) / (1 + s)
+// - the sketch is split into bands, sketches that agree on a whole band are candidate neighbours (locality sensitive hashing)
+namespace Operon {
+
+class OPERON_EXPORT MinHash {
+public:
+    static constexpr std::size_t DefaultSize{128};
+    static constexpr std::size_t DefaultBands{32};
+    static constexpr std::size_t DefaultWindow{4};
+
+    // the size must be a multiple of the number of bands, throws std::invalid_argument otherwise
+    explicit MinHash(std::size_t size = DefaultSize, std::size_t bands = DefaultBands, Operon::Hash seed = 0);
+
+    [[nodiscard]] auto Size() const noexcept -> std::size_t { return seeds_.size(); }
+    [[nodiscard]] auto Bands() const noexcept -> std::size_t { return bands_; }
+
+    // the sketch of a sorted vector of hashes
+    auto Sketch(Operon::Span<Operon::Hash const> hashes, Operon::Span<Operon::Hash> sketch) const noexcept -> void;
+    [[nodiscard]] auto Sketch(Operon::Span<Operon::Hash const> hashes) const -> Operon::Vector<Operon::Hash>;
+
+    // the hash of the values of band b
+    [[nodiscard]] auto Band(Operon::Span<Operon::Hash const> sketch, std::size_t b) const noexcept -> Operon::Hash;
+
+    // the estimated similarity and the estimated distance on the scale of Distance::Jaccard
+    [[nodiscard]] static auto Similarity(Operon::Span<Operon::Hash const> lhs, Operon::Span<Operon::Hash const> rhs) noexcept -> double;
+    [[nodiscard]] static auto Distance(Operon::Span<Operon::Hash const> lhs, Operon::Span<Operon::Hash const> rhs) noexcept -> double;
+
+    // the estimated distance of each sketch to its nearest candidate neighbour, or 1 if it has none
+    // - the sketches are stored one after the other
+    // - the members of a bucket are ordered by index and each one is compared with the next `window` members,
+    //   so a large bucket (e.g. many copies of the same tree) costs linear time
+    [[nodiscard]] auto NearestNeighbours(Operon::Span<Operon::Hash const> sketches, std::size_t window = DefaultWindow) const -> std::vector<double>;
+
+private:
+    std::vector<Operon::Hash> seeds_;
+    std::size_t bands_;
+};
+
+} // namespace Operon
+
+#endif
@@ -100,6 +100,7 @@ struct Node {
     NodeType Type;
     bool IsEnabled;
     bool Optimize;
+    uint8_t Lag; // for variables: the value is read Lag rows before the current row (time series lags)
 
     Node() = default;
 
@@ -128,6 +129,7 @@ struct Node {
         Length = Arity;
         IsEnabled = true;
         Optimize = IsLeaf(); // we only optimize leaf nodes
+        Lag = 0;
         Value = 1.;
     }
 
@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_CORE_NODE_ARENA_HPP
+#define OPERON_CORE_NODE_ARENA_HPP
+
+#include <atomic>
+#include <cstddef>
+
+#include "node.hpp"
+#include "types.hpp"
+#include "operon/operon_export.hpp"
+
+namespace Operon {
+
+// the nodes of a tree, shared by the copies of the tree until one of them is modified (see Tree)
+struct NodeBuffer {
+    std::atomic<std::size_t> References{1};
+    Operon::Vector<Node> Nodes;
+};
+
+// per-thread pool of node buffers
+// - the buffers of the trees destroyed by a thread are kept in the pool of that thread and handed out again when
+//   the thread builds a new tree (tree copies, crossover, mutation, splice)
+// - in the main loop of the algorithms the offspring replace the trees of the previous generation on the same
+//   worker, so after the first generations the nodes are no longer allocated on the heap
+// - the shared blocks holding the nodes of the trees are pooled in the same way
+// - each pool keeps at most MaxBuffers buffers (and blocks), the others are freed as usual
+struct OPERON_EXPORT NodeArena {
+    static constexpr std::size_t MaxBuffers{4096};
+
+    // an empty buffer with room for at least the given number of nodes
+    static auto Acquire(std::size_t capacity) -> Operon::Vector<Node>;
+
+    // a copy of the given nodes in a recycled buffer
+    static auto Copy(Operon::Vector<Node> const& nodes) -> Operon::Vector<Node>;
+
+    // returns the buffer to the pool of the calling thread (the buffer is left empty)
+    static auto Release(Operon::Vector<Node>&& nodes) noexcept -> void;
+
+    // a shared block holding the given nodes, with a single reference
+    static auto Share(Operon::Vector<Node>&& nodes) -> NodeBuffer*;
+
+    // drops a reference to the block, the last reference releases the nodes and the block to the pool of the calling thread
+    static auto Unshare(NodeBuffer* buffer) noexcept -> void;
+
+    // number of buffers in the pool of the calling thread
+    static auto Count() noexcept -> std::size_t;
+
+    // frees the buffers in the pool of the calling thread
+    static auto Clear() noexcept -> void;
+};
+
+} // namespace Operon
+
+#endif
@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_CORE_PERMUTATION_HPP
+#define OPERON_CORE_PERMUTATION_HPP
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "contracts.hpp"
+#include "types.hpp"
+
+namespace Operon {
+
+// moves the element at position indices[i] to position i, in place
+// - the populations are sorted and partitioned by index (see ReinserterBase, NSGA2::Sort) and the individuals
+//   are moved once at the end, instead of being swapped around by the sorting algorithm
+// - the cycles of the permutation are followed, so that each element is moved once (plus once per cycle through
+//   a temporary) without moving the range into a copy and back
+// - the indices must be a permutation of 0..n-1
+template<typename T>
+auto ApplyPermutation(Operon::Span<T> values, Operon::Span<std::size_t const> indices) -> void
+{
+    EXPECT(values.size() == indices.size());
+    std::vector<bool> done(values.size(), false);
+    for (auto i = 0UL; i < values.size(); ++i) {
+        if (done[i] || indices[i] == i) { continue; }
+        T tmp = std::move(values[i]);
+        auto j = i;
+        for (auto k = indices[j]; k != i; k = indices[j]) {
+            values[j] = std::move(values[k]);
+            done[j] = true;
+            j = k;
+        }
+        values[j] = std::move(tmp);
+        done[j] = true;
+    }
+}
+
+} // namespace Operon
+
+#endif
@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_CORE_POOL_HPP
+#define OPERON_CORE_POOL_HPP
+
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace Operon {
+
+// objects handed out to the tasks running at the same time, each task holds its own until it is done
+// - unlike one object per worker (or per thread), a task that a worker runs while another of its tasks waits in a
+//   corun (see RunTaskflow) does not get the object in use
+// - the released objects keep their storage and are handed out again, so there are only as many as tasks held
+//   one at the same time
+template<typename T>
+class ObjectPool {
+public:
+    class Lease {
+    public:
+        Lease(ObjectPool& pool, std::unique_ptr<T> object)
+            : pool_(&pool)
+            , object_(std::move(object))
+        {
+        }
+
+        Lease(Lease const&) = delete;
+        Lease(Lease&&) noexcept = default;
+        auto operator=(Lease const&) -> Lease& = delete;
+        auto operator=(Lease&&) -> Lease& = delete;
+        ~Lease() { if (object_) { pool_->Release(std::move(object_)); } }
+
+        auto operator*() const -> T& { return *object_; }
+        auto operator->() const -> T* { return object_.get(); }
+
+    private:
+        ObjectPool* pool_;
+        std::unique_ptr<T> object_;
+    };
+
+    [[nodiscard]] auto Acquire() -> Lease
+    {
+        std::unique_ptr<T> object;
+        {
+            std::scoped_lock lock(mutex_);
+            if (!free_.empty()) {
+                object = std::move(free_.back());
+                free_.pop_back();
+            }
+        }
+        if (!object) { object = std::make_unique<T>(); }
+        return Lease{*this, std::move(object)};
+    }
+
+    // calls func(object) for each object that is not held by a task
+    template<typename F>
+    auto ForEach(F&& func) const -> void
+    {
+        std::scoped_lock lock(mutex_);
+        for (auto const& object : free_) { func(std::as_const(*object)); }
+    }
+
+private:
+    auto Release(std::unique_ptr<T> object) -> void
+    {
+        std::scoped_lock lock(mutex_);
+        free_.push_back(std::move(object));
+    }
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<T>> free_;
+};
+
+} // namespace Operon
+
+#endif
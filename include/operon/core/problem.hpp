@@ -25,6 +25,13 @@ class Problem {
         return dataset_.GetVariable(t).has_value();
     }
 
+    [[nodiscard]] auto InputColumns() const -> std::vector<std::size_t> {
+        std::vector<std::size_t> columns;
+        columns.reserve(inputs_.size());
+        for (auto h : inputs_) { columns.push_back(static_cast<std::size_t>(GetVariable(h).Index)); }
+        return columns;
+    }
+
     auto ValidateInputs(auto const& inputs) const {
         using T = typename std::remove_cvref_t<decltype(inputs)>::value_type;
         static_assert(std::is_same_v<T, std::string> || std::is_same_v<T, Operon::Hash>, "the inputs must be strings or hashes");
@@ -41,6 +48,7 @@ class Problem {
     Operon::Set<Operon::Hash> inputs_;
 
 public:
+    // the dataset is copied, unless it is a view (see Dataset::Share) in which case the problems share its values
     Problem(Dataset ds, Range trainingRange, Range testRange, Range validationRange = { 0, 0 }) // NOLINT(bugprone-easily-swappable-parameters)
         : dataset_(std::move(ds))
         , training_(std::move(trainingRange))
@@ -77,6 +85,30 @@ public:
         return inputs_.values();
     }
 
+    // keep only the columns of the inputs and the target (eg. for wide datasets where few variables are used)
+    // - the dataset is replaced by an owned copy of these columns, so the variable indices may change
+    auto ProjectDataset() -> void {
+        auto hashes = inputs_.values();
+        hashes.push_back(target_.Hash);
+        auto projected = dataset_.Select(hashes);
+        dataset_.Swap(projected);
+        target_ = GetVariable(target_.Hash);
+    }
+
+    // appends the rows to the dataset (see Dataset::AppendRows) and returns the range of the new rows
+    // - the training range is extended over the new rows if it ended at the last row of the dataset,
+    //   the test and validation ranges are left unchanged
+    // - the evaluators that keep the error statistics of the trees only evaluate them on the new rows (see
+    //   Evaluator::SetIncrementalStatistics), and compute the bounds of their interval check again in Prepare
+    // - the tiles and codes of the dataset built before (see DatasetTiles, DatasetCodes) no longer match its rows, the
+    //   interpreters then read the columns until they are built again (the dataset drops its own codes, see Encode)
+    auto AppendRows(Eigen::Ref<Dataset::Matrix const> rows) -> Range {
+        auto const n = dataset_.Rows<std::size_t>();
+        dataset_.AppendRows(rows);
+        if (training_.End() == n) { training_ = Range(training_.Start(), dataset_.Rows<std::size_t>()); }
+        return { n, dataset_.Rows<std::size_t>() };
+    }
+
     // set all variables except the target as inputs
     auto SetDefaultInputs() -> void {
         inputs_.clear();
@@ -110,10 +142,11 @@ public:
         return dataset_.GetValues(target_.Index).subspan(range.Start(), range.Size());
     }
 
-    void StandardizeData(Range range)
+    // standardize the inputs over the range, in place or by storing the transforms of the inputs (see Dataset::Standardize)
+    void StandardizeData(Range range, bool inPlace = true)
     {
         for (auto const& v : inputs_) {
-            dataset_.Standardize(GetVariable<Operon::Hash>(v).Index, range);
+            dataset_.Standardize(GetVariable<Operon::Hash>(v).Index, range, inPlace);
         }
     }
 
@@ -123,6 +156,17 @@ public:
             dataset_.Normalize(GetVariable<Operon::Hash>(v).Index, range);
         }
     }
+
+    // parallel versions, the columns of the inputs are processed concurrently (see Dataset::Standardize)
+    void StandardizeData(Range range, bool inPlace, tf::Executor& executor)
+    {
+        dataset_.Standardize(InputColumns(), range, inPlace, executor);
+    }
+
+    void NormalizeData(Range range, tf::Executor& executor)
+    {
+        dataset_.Normalize(InputColumns(), range, executor);
+    }
 };
 } // namespace Operon
 
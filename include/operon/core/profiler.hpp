@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_CORE_PROFILER_HPP
+#define OPERON_CORE_PROFILER_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+#include "operon/operon_export.hpp"
+
+namespace Operon {
+
+// the stages of the main loop of the generational algorithms (see OffspringGeneratorBase::Generate)
+enum class Stage : uint8_t {
+    Initialization,
+    Selection,
+    Crossover,
+    Mutation,
+    LocalSearch,
+    Evaluation,
+    Sorting,
+    Reinsertion,
+    Count // number of stages
+};
+
+constexpr auto StageCount{static_cast<std::size_t>(Stage::Count)};
+
+OPERON_EXPORT auto StageName(Stage stage) -> std::string_view;
+
+struct StageStatistics {
+    uint64_t Calls{0};
+    uint64_t Nanoseconds{0};
+
+    [[nodiscard]] auto Seconds() const -> double { return static_cast<double>(Nanoseconds) / 1e9; } // NOLINT
+
+    auto operator+=(StageStatistics const& other) -> StageStatistics&
+    {
+        Calls += other.Calls;
+        Nanoseconds += other.Nanoseconds;
+        return *this;
+    }
+};
+
+using ProfileSummary = std::array<StageStatistics, StageCount>;
+
+// time and number of calls of each stage
+// - each thread records into its own shard of counters, so that the workers do not contend for the same cache line
+// - the times are summed over the threads, so the time of a stage can exceed the wall clock time of the generation
+// - Collect is called by the algorithms at the end of each generation, the summary of the generation is then
+//   available from Last and added to Total
+class OPERON_EXPORT Profiler {
+    using Clock = std::chrono::steady_clock;
+
+public:
+    explicit Profiler(std::size_t shards = 0); // one shard per hardware thread if zero
+
+    auto Record(Stage stage, Clock::duration elapsed) noexcept -> void;
+
+    // sums the shards, resets them and adds the sums to the total
+    auto Collect() -> ProfileSummary const&;
+    auto Reset() -> void;
+
+    [[nodiscard]] auto Last() const -> ProfileSummary const& { return last_; }
+    [[nodiscard]] auto Total() const -> ProfileSummary const& { return total_; }
+
+    // times the enclosing scope, does nothing without a profiler
+    class Scope {
+    public:
+        Scope(Profiler* profiler, Stage stage) noexcept
+            : profiler_(profiler)
+            , stage_(stage)
+        {
+            if (profiler_ != nullptr) { start_ = Clock::now(); }
+        }
+
+        Scope(Scope const&) = delete;
+        Scope(Scope&&) = delete;
+        auto operator=(Scope const&) -> Scope& = delete;
+        auto operator=(Scope&&) -> Scope& = delete;
+
+        ~Scope()
+        {
+            if (profiler_ != nullptr) { profiler_->Record(stage_, Clock::now() - start_); }
+        }
+
+    private:
+        Profiler* profiler_;
+        Stage stage_;
+        Clock::time_point start_;
+    };
+
+private:
+    struct alignas(64) Shard { // NOLINT
+        std::array<std::atomic<uint64_t>, 2 * StageCount> Counters{}; // calls and nanoseconds of each stage
+    };
+
+    auto Local() noexcept -> Shard&;
+
+    std::size_t size_;
+    std::unique_ptr<Shard[]> shards_; // NOLINT
+    ProfileSummary last_{};
+    ProfileSummary total_{};
+};
+
+} // namespace Operon
+
+#endif
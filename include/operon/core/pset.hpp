@@ -4,11 +4,44 @@
 #ifndef OPERON_PSET_HPP
 #define OPERON_PSET_HPP
 
+#include <cstdint>
+#include <vector>
+
 #include "contracts.hpp"
 #include "node.hpp"
 
 namespace Operon {
 
+class PrimitiveSet;
+
+// samples the enabled symbols of a primitive set in constant time with walker's alias method
+// - the probability of a symbol is proportional to its frequency among the symbols whose arity range intersects
+//   the requested one, the arity is then uniform over the intersection
+// - one alias table per arity range, built from the primitive set at construction, later changes of the primitive
+//   set are not seen by the sampler (the primitive set rebuilds its own, see PrimitiveSet::SampleRandomSymbol)
+class OPERON_EXPORT SymbolSampler {
+public:
+    SymbolSampler() = default;
+    explicit SymbolSampler(PrimitiveSet const& pset);
+
+    auto operator()(Operon::RandomGenerator& random, size_t minArity, size_t maxArity) const -> Operon::Node;
+
+private:
+    struct Symbol {
+        Operon::Node Node;
+        size_t MinArity;
+        size_t MaxArity;
+    };
+
+    struct Table {
+        std::vector<Symbol> Symbols;
+        std::vector<double> Probability; // of keeping the sampled column instead of its alias
+        std::vector<uint32_t> Alias;
+    };
+
+    size_t maxArity_{0};
+    std::vector<Table> tables_; // indexed by minArity * (maxArity_ + 1) + maxArity
+};
 class PrimitiveSet {
     using Primitive = std::tuple<
         Node,
@@ -19,6 +52,9 @@ class PrimitiveSet {
     enum { NODE = 0, FREQUENCY = 1, MINARITY = 2, MAXARITY = 3}; // for accessing tuple elements more easily
 
     Operon::Map<Operon::Hash, Primitive> pset_;
+    SymbolSampler sampler_; // rebuilt by every change of the primitives
+
+    auto Update() -> void { sampler_ = SymbolSampler(*this); }
 
     [[nodiscard]] auto OPERON_EXPORT GetPrimitive(Operon::Hash hash) const -> Primitive const&;
 
@@ -43,11 +79,16 @@ public:
     auto AddPrimitive(Operon::Node node, size_t frequency, size_t minArity, size_t maxArity) -> bool
     {
         auto [_, ok] = pset_.insert({ node.HashValue, Primitive { node, frequency, minArity, maxArity } });
+        Update();
         return ok;
     }
-    void RemovePrimitive(Operon::Node node) { pset_.erase(node.HashValue); }
+    void RemovePrimitive(Operon::Node node) { RemovePrimitive(node.HashValue); }
 
-    void RemovePrimitive(Operon::Hash hash) { pset_.erase(hash); }
+    void RemovePrimitive(Operon::Hash hash)
+    {
+        pset_.erase(hash);
+        Update();
+    }
 
     void SetConfig(PrimitiveSetConfig config)
     {
@@ -60,6 +101,7 @@ public:
                 pset_[n.HashValue] = { n, 1, n.Arity, n.Arity };
             }
         }
+        Update();
     }
 
     [[nodiscard]] auto EnabledPrimitives() const -> std::vector<Node> {
@@ -95,6 +137,7 @@ public:
     {
         auto& p = GetPrimitive(hash);
         std::get<FREQUENCY>(p) = frequency;
+        Update();
     }
 
     [[nodiscard]] auto Contains(Operon::Hash hash) const -> bool { return pset_.contains(hash); }
@@ -109,6 +152,7 @@ public:
     {
         auto& p = GetPrimitive(hash);
         std::get<NODE>(p).IsEnabled = enabled;
+        Update();
     }
 
     void Enable(Operon::Hash hash)
@@ -133,6 +177,7 @@ public:
         return { minArity, maxArity };
     }
 
+    // constant time, see SymbolSampler
     OPERON_EXPORT auto SampleRandomSymbol(Operon::RandomGenerator& random, size_t minArity, size_t maxArity) const -> Operon::Node;
 
     void SetMinimumArity(Operon::Hash hash, size_t minArity)
@@ -140,6 +185,7 @@ public:
         EXPECT(minArity <= MaximumArity(hash));
         auto& p = GetPrimitive(hash);
         std::get<MINARITY>(p) = minArity;
+        Update();
     }
 
     [[nodiscard]] auto MinimumArity(Operon::Hash hash) const -> size_t
@@ -153,6 +199,7 @@ public:
         EXPECT(maxArity >= MinimumArity(hash));
         auto& p = GetPrimitive(hash);
         std::get<MAXARITY>(p) = maxArity;
+        Update();
     }
 
     [[nodiscard]] auto MaximumArity(Operon::Hash hash) const -> size_t
@@ -173,6 +220,7 @@ public:
         auto& p = GetPrimitive(hash);
         std::get<MINARITY>(p) = minArity;
         std::get<MAXARITY>(p) = maxArity;
+        Update();
     }
 
     // convenience overloads
@@ -207,5 +255,6 @@ public:
         SetMinMaxArity(node.HashValue, minArity, maxArity);
     }
 };
+
 } // namespace Operon
 #endif
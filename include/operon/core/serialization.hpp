@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_SERIALIZATION_HPP
+#define OPERON_SERIALIZATION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fmt/core.h>
+#include <iosfwd>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "operon/core/individual.hpp"
+#include "operon/core/tree.hpp"
+#include "operon/core/types.hpp"
+#include "operon/operon_export.hpp"
+
+namespace Operon::Serialization {
+
+// compact binary encoding of values and trees, eg. for sending individuals to other processes
+// - the values are stored in the native byte order (all the processes are assumed to share the same architecture)
+// - only the node fields that cannot be recomputed by Tree::UpdateNodes are stored (type, hash, value, arity, flags
+//   and the lag of the lagged variables)
+// - the decoded trees are only meaningful for the same primitive set and dataset variables
+template<typename T>
+requires std::is_trivially_copyable_v<T>
+auto Write(std::vector<uint8_t>& bytes, T const value) -> void
+{
+    auto const offset = bytes.size();
+    bytes.resize(offset + sizeof(T));
+    std::memcpy(bytes.data() + offset, &value, sizeof(T));
+}
+
+// reads a value at the given offset and advances the offset, throws if the input is too short
+template<typename T>
+requires std::is_trivially_copyable_v<T>
+auto Read(Operon::Span<uint8_t const> bytes, std::size_t& offset) -> T
+{
+    if (offset + sizeof(T) > bytes.size()) {
+        throw std::runtime_error(fmt::format("truncated message ({} bytes, expected at least {})", bytes.size(), offset + sizeof(T)));
+    }
+    T value;
+    std::memcpy(&value, bytes.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return value;
+}
+
+auto OPERON_EXPORT Write(std::vector<uint8_t>& bytes, Operon::Tree const& tree) -> void;
+auto OPERON_EXPORT ReadTree(Operon::Span<uint8_t const> bytes, std::size_t& offset) -> Operon::Tree;
+
+// an individual is encoded as its fitness values followed by its genotype
+auto OPERON_EXPORT Write(std::vector<uint8_t>& bytes, Operon::Individual const& individual) -> void;
+auto OPERON_EXPORT ReadIndividual(Operon::Span<uint8_t const> bytes, std::size_t& offset) -> Operon::Individual;
+
+// populations in a stream (eg. checkpoints), written and read one individual at a time
+// - the header holds a magic number, the format version, the size of Operon::Scalar and the number of individuals
+// - each individual is preceded by the size of its encoding
+// - a stream with another magic number, version or scalar type is rejected with std::runtime_error
+constexpr uint32_t PopulationVersion{2}; // 2: variable lags
+auto OPERON_EXPORT WritePopulation(std::ostream& out, Operon::Span<Operon::Individual const> individuals) -> void;
+auto OPERON_EXPORT ReadPopulation(std::istream& in) -> Operon::Vector<Operon::Individual>;
+
+} // namespace Operon::Serialization
+
+#endif
@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_CORE_SHARDED_MAP_HPP
+#define OPERON_CORE_SHARDED_MAP_HPP
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "operon/core/types.hpp"
+
+namespace Operon {
+
+// concurrent map from a hash (eg. of a genotype) to a value
+// - the key space is split into shards, each guarded by its own mutex to keep contention low
+// - a capacity of zero means unbounded, otherwise a shard that reaches its share of the capacity is flushed
+//   (generational eviction, no bookkeeping on lookup)
+// - Reserve sizes the shards for a number of entries, so that an unbounded map filled up to it does not rehash
+template<typename V>
+class ShardedMap {
+    struct Shard {
+        std::mutex Mutex;
+        Operon::Map<Operon::Hash, V> Entries;
+    };
+
+public:
+    static constexpr std::size_t DefaultShardCount { 64 };
+
+    explicit ShardedMap(std::size_t capacity = 0, std::size_t shardCount = DefaultShardCount)
+        : shards_(std::max(shardCount, std::size_t{1}))
+    {
+        SetCapacity(capacity);
+    }
+
+    // looks up the value corresponding to key, returns true if found
+    auto Find(Operon::Hash key, V& value) const -> bool
+    {
+        auto& shard = GetShard(key);
+        std::scoped_lock lock(shard.Mutex);
+        if (auto it = shard.Entries.find(key); it != shard.Entries.end()) {
+            value = it->second;
+            return true;
+        }
+        return false;
+    }
+
+    [[nodiscard]] auto Contains(Operon::Hash key) const -> bool
+    {
+        auto& shard = GetShard(key);
+        std::scoped_lock lock(shard.Mutex);
+        return shard.Entries.contains(key);
+    }
+
+    // inserts the value or replaces the one of key
+    auto Insert(Operon::Hash key, V value) const -> void
+    {
+        auto& shard = GetShard(key);
+        std::scoped_lock lock(shard.Mutex);
+        Evict(shard);
+        shard.Entries.insert_or_assign(key, std::move(value));
+    }
+
+    // inserts the value if key is not in the map, returns true if it was inserted
+    auto TryInsert(Operon::Hash key, V value = {}) const -> bool
+    {
+        auto& shard = GetShard(key);
+        std::scoped_lock lock(shard.Mutex);
+        if (shard.Entries.contains(key)) { return false; }
+        Evict(shard);
+        shard.Entries.emplace(key, std::move(value));
+        return true;
+    }
+
+    // applies func to the value of key under the lock of its shard (a default value is inserted if missing)
+    template<typename F>
+    requires std::invocable<F, V&>
+    auto Update(Operon::Hash key, F&& func) const -> void
+    {
+        auto& shard = GetShard(key);
+        std::scoped_lock lock(shard.Mutex);
+        if (!shard.Entries.contains(key)) { Evict(shard); }
+        std::forward<F>(func)(shard.Entries[key]);
+    }
+
+    auto Clear() const -> void
+    {
+        for (auto& shard : shards_) {
+            std::scoped_lock lock(shard.Mutex);
+            shard.Entries.clear();
+        }
+    }
+
+    auto Reserve(std::size_t size) const -> void
+    {
+        auto const n = (size + shards_.size() - 1) / shards_.size();
+        for (auto& shard : shards_) {
+            std::scoped_lock lock(shard.Mutex);
+            shard.Entries.reserve(n);
+        }
+    }
+
+    // changing the capacity discards all the entries
+    auto SetCapacity(std::size_t capacity) -> void
+    {
+        capacity_ = capacity;
+        shardCapacity_ = capacity == 0 ? 0 : std::max(capacity / shards_.size(), std::size_t{1});
+        Clear();
+    }
+
+    [[nodiscard]] auto Capacity() const -> std::size_t { return capacity_; }
+
+    [[nodiscard]] auto Size() const -> std::size_t
+    {
+        return std::transform_reduce(shards_.begin(), shards_.end(), std::size_t{0}, std::plus{}, [](auto& shard) {
+            std::scoped_lock lock(shard.Mutex);
+            return shard.Entries.size();
+        });
+    }
+
+private:
+    auto GetShard(Operon::Hash key) const -> Shard& { return shards_[key % shards_.size()]; }
+
+    auto Evict(Shard& shard) const -> void
+    {
+        if (shardCapacity_ > 0 && shard.Entries.size() >= shardCapacity_) { shard.Entries.clear(); }
+    }
+
+    mutable std::vector<Shard> shards_;
+    std::size_t capacity_{0};
+    std::size_t shardCapacity_{0};
+};
+
+// concurrent set of hashes (see ShardedMap), eg. the genotypes already produced
+using ShardedSet = ShardedMap<std::monostate>;
+
+} // namespace Operon
+
+#endif
@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_CORE_SUBTREE_STORE_HPP
+#define OPERON_CORE_SUBTREE_STORE_HPP
+
+#include <cstdint>
+#include <shared_mutex>
+#include <vector>
+
+#include "compact_tree.hpp"
+#include "tree.hpp"
+#include "types.hpp"
+#include "operon/operon_export.hpp"
+
+namespace Operon {
+
+// hash-consed storage of trees: every distinct subtree is stored once and referenced by its id
+// - a converged population shares most of its subtrees, so the store needs much less memory than the postfix
+//   node arrays of the individual trees (the memory grows with the number of distinct subtrees)
+// - two trees are equal if and only if they have the same id (the order of the children and the coefficients
+//   matter, as for the postfix representation), and the hash value of an id is the strict hash of the tree
+// - ToTree expands an id to the linear postfix representation used by the interpreter and the operators
+// - the ids remain valid until Clear, the store can be used by several threads (interning takes a lock)
+class OPERON_EXPORT SubtreeStore {
+public:
+    using Id = uint32_t;
+
+    // the root id of the tree, the tree is hashed (strict, see Tree::Hash)
+    auto Intern(Tree const& tree) -> Id;
+
+    [[nodiscard]] auto ToTree(Id id) const -> Tree;
+
+    // the strict hash value and the number of nodes of the tree with the given id
+    [[nodiscard]] auto HashValue(Id id) const -> Operon::Hash;
+    [[nodiscard]] auto Length(Id id) const -> std::size_t;
+
+    // number of distinct subtrees
+    [[nodiscard]] auto Size() const -> std::size_t;
+
+    auto Clear() -> void;
+
+private:
+    struct Entry {
+        CompactNode Node;
+        Operon::Hash HashValue;
+        uint32_t Length;   // number of nodes of the subtree
+        uint32_t Children; // offset of the child ids in children_, in the order of Tree::Indices
+        Id Next;           // next entry with the same hash value (or None)
+    };
+
+    static constexpr Id None{ ~Id{0} };
+
+    auto Find(Node const& node, Operon::Hash hash, Operon::Span<Id const> children) const -> Id;
+    auto Expand(Id id, Operon::Vector<Node>& nodes) const -> void;
+
+    mutable std::shared_mutex mutex_;
+    std::vector<Entry> entries_;
+    std::vector<Id> children_;
+    Operon::Map<Operon::Hash, Id> index_; // the first entry with a given hash value
+};
+
+} // namespace Operon
+
+#endif
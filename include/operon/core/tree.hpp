@@ -9,34 +9,44 @@
 #include <iterator>
 #include <optional>
 #include <random>
+#include <utility>
 #include <vector>
 
 #include "contracts.hpp"
+#include "node_arena.hpp"
 #include "subtree.hpp"
 #include "operon/operon_export.hpp"
 
 namespace Operon {
+// the nodes are copy-on-write: the copies of a tree share its node buffer (a copy only increments a reference count)
+// and a tree takes a private copy of the nodes before it modifies them
+// - the mutable accessors (Nodes, operator[], Children) and the modifiers make the nodes private, so a reference
+//   obtained from them must not be used after the tree was copied (the copy would see the changes)
+// - Hash makes the nodes private as well, since it stores the hash values in the nodes
+// - the reference counts are atomic, so the copies of a tree can be used and modified by different threads
 class OPERON_EXPORT Tree { // NOLINT
 public:
     Tree() = default;
     Tree(std::initializer_list<Node> list)
-        : nodes_(list)
+        : buffer_(NodeArena::Share(Operon::Vector<Node>(list)))
     {
     }
     explicit Tree(Operon::Vector<Node> vec)
-        : nodes_(std::move(vec))
+        : buffer_(NodeArena::Share(std::move(vec)))
     {
     }
-    Tree(Tree const& rhs) // NOLINT
-        : nodes_(rhs.nodes_)
+    Tree(Tree const& rhs) noexcept // NOLINT
+        : buffer_(rhs.buffer_)
     {
+        if (buffer_ != nullptr) { buffer_->References.fetch_add(1, std::memory_order_relaxed); }
     }
     Tree(Tree&& rhs) noexcept
-        : nodes_(std::move(rhs.nodes_))
+        : buffer_(std::exchange(rhs.buffer_, nullptr))
     {
     }
 
-    ~Tree() = default;
+    // the node buffers are recycled by the arena of the thread that drops the last reference
+    ~Tree() { NodeArena::Unshare(buffer_); }
 
     auto operator=(Tree rhs) -> Tree&
     {
@@ -47,10 +57,21 @@ public:
 
     friend void Swap(Tree& lhs, Tree& rhs) noexcept
     {
-        std::swap(lhs.nodes_, rhs.nodes_);
+        std::swap(lhs.buffer_, rhs.buffer_);
+    }
+
+    // true if the nodes are shared with a copy of this tree
+    [[nodiscard]] auto Shared() const noexcept -> bool
+    {
+        return buffer_ != nullptr && buffer_->References.load(std::memory_order_acquire) != 1;
     }
 
     auto UpdateNodes() -> Tree&;
+
+    // incremental update after the subtree [begin, begin + removed) was replaced by [begin, begin + inserted) (either may be empty)
+    // - parent is the index (after the replacement) of the parent of the spliced subtree, whose arity must already be adjusted
+    // - only the spliced nodes and their ancestors are recomputed, the parent indices of the following nodes are shifted
+    auto UpdateNodes(size_t begin, size_t removed, size_t inserted, size_t parent) -> Tree&;
     auto Sort() -> Tree&;
     auto Reduce() -> Tree&;
     auto Simplify() -> Tree&;
@@ -59,33 +80,47 @@ public:
     // aggregating hash values from the leafs towards the root node
     [[nodiscard]] auto Hash(Operon::HashMode mode) const -> Tree const&;
 
+    // rehash only the subtree rooted at i and the ancestors of i (the other hash values must be up to date)
+    [[nodiscard]] auto Hash(Operon::HashMode mode, size_t i) const -> Tree const&;
+
     // splice a subtree rooted at node with index i as a new tree
     [[nodiscard]] auto Splice(size_t i) const -> Tree {
         EXPECT(i < Length());
-        auto const& n = nodes_[i];
-        auto it = nodes_.begin() + static_cast<int64_t>(i);
-        return Tree({it - n.Length, it + 1}).UpdateNodes();
+        auto const& n = Buffer()[i];
+        auto it = Buffer().begin() + static_cast<int64_t>(i);
+        auto nodes = NodeArena::Acquire(n.Length + 1UL);
+        nodes.assign(it - n.Length, it + 1);
+        Tree subtree(std::move(nodes));
+        subtree.UpdateNodes();
+        return subtree;
     }
 
     void SetEnabled(size_t i, bool enabled)
     {
-        for (auto j = i - nodes_[i].Length; j <= i; ++j) {
-            nodes_[j].IsEnabled = enabled;
+        auto& nodes = Own();
+        for (auto j = i - nodes[i].Length; j <= i; ++j) {
+            nodes[j].IsEnabled = enabled;
         }
     }
 
-    auto Nodes() & -> Operon::Vector<Node>& { return nodes_; }
-    auto Nodes() && -> Operon::Vector<Node>&& { return std::move(nodes_); }
-    [[nodiscard]] auto Nodes() const& -> Operon::Vector<Node> const& { return nodes_; }
+    auto Nodes() & -> Operon::Vector<Node>& { return Own(); }
+    auto Nodes() && -> Operon::Vector<Node>&& { return std::move(Own()); }
+    [[nodiscard]] auto Nodes() const& -> Operon::Vector<Node> const& { return Buffer(); }
 
     [[nodiscard]] auto CoefficientsCount() const
     {
-        return std::count_if(nodes_.cbegin(), nodes_.cend(), [](auto const& s) { return s.Optimize; });
+        return std::count_if(Buffer().cbegin(), Buffer().cend(), [](auto const& s) { return s.Optimize; });
     }
 
     void SetCoefficients(Operon::Span<Operon::Scalar const> coefficients);
     [[nodiscard]] auto GetCoefficients() const -> std::vector<Operon::Scalar>;
 
+    // the overloads below write the coefficients into a caller buffer and return the written values
+    // - the span must hold at least CoefficientsCount() values
+    // - the vector is resized to the number of coefficients, its capacity is reused (eg. a scratch buffer of the worker)
+    auto GetCoefficients(Operon::Span<Operon::Scalar> coefficients) const -> Operon::Span<Operon::Scalar>;
+    auto GetCoefficients(std::vector<Operon::Scalar>& coefficients) const -> Operon::Span<Operon::Scalar>;
+
     [[nodiscard]] auto ApplyCoefficients(Operon::Span<Operon::Scalar const> coefficients) const
     {
         auto tree{ *this };
@@ -93,26 +128,26 @@ public:
         return tree;
     }
 
-    auto operator[](size_t i) noexcept -> Node& { return nodes_[i]; }
-    auto operator[](size_t i) const noexcept -> Node const& { return nodes_[i]; }
+    auto operator[](size_t i) -> Node& { return Own()[i]; }
+    auto operator[](size_t i) const noexcept -> Node const& { return Buffer()[i]; }
 
-    [[nodiscard]] auto Length() const noexcept -> size_t { return nodes_.size(); }
+    [[nodiscard]] auto Length() const noexcept -> size_t { return Buffer().size(); }
     [[nodiscard]] auto AdjustedLength() const noexcept -> size_t {
         auto length = [](auto const& n) {
             if (n.IsConstant()) { return 1; }
             return n.Value == Operon::Scalar{1} ? 1 : 3;
         };
-        return std::transform_reduce(nodes_.begin(), nodes_.end(), 0UL, std::plus{}, length);
+        return std::transform_reduce(Buffer().begin(), Buffer().end(), 0UL, std::plus{}, length);
     }
     [[nodiscard]] auto VisitationLength() const noexcept -> size_t;
     [[nodiscard]] auto Depth() const noexcept -> size_t;
-    [[nodiscard]] auto Empty() const noexcept -> bool { return nodes_.empty(); }
+    [[nodiscard]] auto Empty() const noexcept -> bool { return Buffer().empty(); }
 
-    [[nodiscard]] auto HashValue() const -> Operon::Hash { return nodes_.empty() ? 0 : nodes_.back().CalculatedHashValue; }
+    [[nodiscard]] auto HashValue() const -> Operon::Hash { return Empty() ? 0 : Buffer().back().CalculatedHashValue; }
 
-    [[nodiscard]] auto Children(size_t i) { return Subtree<Node>{nodes_, i}.Nodes(); }
-    [[nodiscard]] auto Children(size_t i) const { return Subtree<Node const>{nodes_, i}.Nodes(); }
-    [[nodiscard]] auto Indices(size_t i) const { return Subtree<Node const>{nodes_, i}.Indices(); }
+    [[nodiscard]] auto Children(size_t i) { return Subtree<Node>{Own(), i}.Nodes(); }
+    [[nodiscard]] auto Children(size_t i) const { return Subtree<Node const>{Buffer(), i}.Nodes(); }
+    [[nodiscard]] auto Indices(size_t i) const { return Subtree<Node const>{Buffer(), i}.Indices(); }
 
     // convenience methods
     static auto Indices(auto const& nodes, auto i) {
@@ -140,7 +175,33 @@ public:
     }
 
 private:
-    Operon::Vector<Node> nodes_;
+    [[nodiscard]] auto Buffer() const noexcept -> Operon::Vector<Node> const&
+    {
+        static Operon::Vector<Node> const empty;
+        return buffer_ == nullptr ? empty : buffer_->Nodes;
+    }
+
+    // the nodes of this tree only, copied from the shared buffer if needed
+    auto Own() -> Operon::Vector<Node>&
+    {
+        if (buffer_ == nullptr) {
+            buffer_ = NodeArena::Share({});
+        } else {
+            Detach();
+        }
+        return buffer_->Nodes;
+    }
+
+    // a private copy of shared nodes (const for Hash, which stores the hash values in the nodes)
+    auto Detach() const -> void
+    {
+        if (Shared()) {
+            auto* copy = NodeArena::Share(NodeArena::Copy(buffer_->Nodes));
+            NodeArena::Unshare(std::exchange(buffer_, copy));
+        }
+    }
+
+    mutable NodeBuffer* buffer_{nullptr};
 };
 } // namespace Operon
 #endif // TREE_H
@@ -12,8 +12,12 @@ struct Variable {
     Operon::Hash Hash{0};
     int64_t Index{0};
 
+    // the interpreters read Scale * x + Offset instead of the stored values x (see Dataset::SetTransform)
+    Operon::Scalar Scale{1};
+    Operon::Scalar Offset{0};
+
     constexpr auto operator==(Variable const& rhs) const noexcept -> bool {
-        return std::tie(Name, Hash, Index) == std::tie(rhs.Name, rhs.Hash, rhs.Index);
+        return std::tie(Name, Hash, Index, Scale, Offset) == std::tie(rhs.Name, rhs.Hash, rhs.Index, rhs.Scale, rhs.Offset);
     }
 
     constexpr auto operator!=(Variable const& rhs) const noexcept -> bool {
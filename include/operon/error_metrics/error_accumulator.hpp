@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_METRICS_ERROR_ACCUMULATOR_HPP
+#define OPERON_METRICS_ERROR_ACCUMULATOR_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "operon/core/contracts.hpp"
+#include "operon/core/types.hpp"
+
+namespace Operon {
+
+// streaming sufficient statistics of a sequence of estimated (x) and target (y) values
+// - each block of values is summarized in two passes (means, then centered sums) and merged
+//   using the pairwise update formulas of Chan et al., which is numerically stable
+// - accumulators over disjoint ranges can be merged (eg. after row-parallel evaluation)
+// - the error metrics, with or without linear scaling, can be computed from the statistics
+//   without storing the values (with the exception of the scaled mean absolute error)
+// - the estimated and target values may have different precisions, the statistics are always kept in double precision
+class ErrorAccumulator {
+public:
+    template<typename T, typename U>
+    requires std::is_arithmetic_v<T> && std::is_arithmetic_v<U>
+    auto operator()(Operon::Span<T const> x, Operon::Span<U const> y) -> void
+    {
+        EXPECT(x.size() == y.size());
+        auto const n { x.size() };
+        if (n == 0) { return; }
+
+        ErrorAccumulator block;
+        block.n_ = static_cast<double>(n);
+        for (auto i = 0UL; i < n; ++i) {
+            block.mx_ += x[i];
+            block.my_ += y[i];
+        }
+        block.mx_ /= block.n_;
+        block.my_ /= block.n_;
+
+        for (auto i = 0UL; i < n; ++i) {
+            auto const dx = static_cast<double>(x[i]) - block.mx_;
+            auto const dy = static_cast<double>(y[i]) - block.my_;
+            auto const e = static_cast<double>(x[i]) - static_cast<double>(y[i]);
+            block.sxx_ += dx * dx;
+            block.syy_ += dy * dy;
+            block.sxy_ += dx * dy;
+            block.sse_ += e * e;
+            block.sae_ += std::abs(e);
+        }
+        Merge(block);
+    }
+
+    auto Merge(ErrorAccumulator const& other) -> void
+    {
+        if (other.n_ == 0) { return; }
+        if (n_ == 0) { *this = other; return; }
+
+        auto const n = n_ + other.n_;
+        auto const dx = other.mx_ - mx_;
+        auto const dy = other.my_ - my_;
+        auto const f = n_ * other.n_ / n;
+
+        sxx_ += other.sxx_ + dx * dx * f;
+        syy_ += other.syy_ + dy * dy * f;
+        sxy_ += other.sxy_ + dx * dy * f;
+        mx_ += dx * other.n_ / n;
+        my_ += dy * other.n_ / n;
+        sse_ += other.sse_;
+        sae_ += other.sae_;
+        n_ = n;
+    }
+
+    // linear scaling parameters a, b minimizing the squared error of a * x + b (same as FitLeastSquares)
+    [[nodiscard]] auto LinearScaling() const -> std::pair<double, double>
+    {
+        auto a = sxy_ / sxx_;
+        if (!std::isfinite(a)) { a = 1; }
+        return { a, my_ - a * mx_ };
+    }
+
+    // sum of squared errors of the linearly scaled estimated values
+    // - since b cancels out the mean residual, this only depends on the centered sums
+    [[nodiscard]] auto ScaledSumOfSquaredErrors() const -> double
+    {
+        auto const [a, b] = LinearScaling();
+        return std::max(syy_ - 2 * a * sxy_ + a * a * sxx_, 0.0);
+    }
+
+    // statistics of the estimated values transformed as a * x + b (eg. with scaling parameters fit on other values)
+    // - the absolute errors cannot be derived from the statistics, SumOfAbsoluteErrors is NaN afterwards
+    [[nodiscard]] auto Scaled(double a, double b) const -> ErrorAccumulator
+    {
+        ErrorAccumulator acc{*this};
+        if (n_ == 0) { return acc; }
+        auto const d = (a * mx_) + b - my_; // mean residual
+        acc.mx_ = (a * mx_) + b;
+        acc.sxx_ = a * a * sxx_;
+        acc.sxy_ = a * sxy_;
+        acc.sse_ = std::max(syy_ - (2 * a * sxy_) + (a * a * sxx_), 0.0) + (n_ * d * d);
+        acc.sae_ = std::numeric_limits<double>::quiet_NaN();
+        return acc;
+    }
+
+    [[nodiscard]] auto Count() const -> double { return n_; }
+    [[nodiscard]] auto MeanX() const -> double { return mx_; }
+    [[nodiscard]] auto MeanY() const -> double { return my_; }
+    [[nodiscard]] auto VarianceX() const -> double { return sxx_ / n_; }
+    [[nodiscard]] auto VarianceY() const -> double { return syy_ / n_; }
+    [[nodiscard]] auto Covariance() const -> double { return sxy_ / n_; }
+    [[nodiscard]] auto SumOfSquaredErrors() const -> double { return sse_; }
+    [[nodiscard]] auto SumOfAbsoluteErrors() const -> double { return sae_; }
+
+    // centered sums (n times the variances and covariance)
+    [[nodiscard]] auto SumSquaresX() const -> double { return sxx_; }
+    [[nodiscard]] auto SumSquaresY() const -> double { return syy_; }
+    [[nodiscard]] auto SumProducts() const -> double { return sxy_; }
+
+    // raw state, eg. for sending the statistics to another process
+    using State = std::array<double, 8>; // NOLINT
+    [[nodiscard]] auto GetState() const -> State { return { n_, mx_, my_, sxx_, syy_, sxy_, sse_, sae_ }; }
+    static auto FromState(State const& s) -> ErrorAccumulator
+    {
+        ErrorAccumulator acc;
+        auto const& [n, mx, my, sxx, syy, sxy, sse, sae] = s;
+        acc.n_ = n; acc.mx_ = mx; acc.my_ = my;
+        acc.sxx_ = sxx; acc.syy_ = syy; acc.sxy_ = sxy;
+        acc.sse_ = sse; acc.sae_ = sae;
+        return acc;
+    }
+
+private:
+    double n_{0};
+    double mx_{0};
+    double my_{0};
+    double sxx_{0};
+    double syy_{0};
+    double sxy_{0};
+    double sse_{0};
+    double sae_{0};
+};
+
+} // namespace Operon
+
+#endif
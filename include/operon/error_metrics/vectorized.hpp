@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_METRICS_VECTORIZED_HPP
+#define OPERON_METRICS_VECTORIZED_HPP
+
+#include "operon/core/types.hpp"
+#include "operon/operon_export.hpp"
+
+// explicitly vectorized versions of the error metrics (eve), with the same semantics as the iterator-based versions
+// - the sums are accumulated in several independent SIMD registers, to hide the latency of the additions
+// - the registers are flushed into double precision partial sums every few thousand values, so that single
+//   precision inputs do not lose accuracy over long ranges
+// - the centered sums (variance, covariance) use two passes over the data, like the iterator-based versions
+// - T can be float or double, the results are always in double precision
+namespace Operon::Vectorized {
+
+template<typename T> auto OPERON_EXPORT SumOfSquaredErrors(Operon::Span<T const> x, Operon::Span<T const> y) noexcept -> double;
+template<typename T> auto OPERON_EXPORT SumOfSquaredErrors(Operon::Span<T const> x, Operon::Span<T const> y, Operon::Span<T const> w) noexcept -> double;
+
+template<typename T> auto OPERON_EXPORT MeanSquaredError(Operon::Span<T const> x, Operon::Span<T const> y) noexcept -> double;
+template<typename T> auto OPERON_EXPORT MeanSquaredError(Operon::Span<T const> x, Operon::Span<T const> y, Operon::Span<T const> w) noexcept -> double;
+
+template<typename T> auto OPERON_EXPORT RootMeanSquaredError(Operon::Span<T const> x, Operon::Span<T const> y) noexcept -> double;
+template<typename T> auto OPERON_EXPORT RootMeanSquaredError(Operon::Span<T const> x, Operon::Span<T const> y, Operon::Span<T const> w) noexcept -> double;
+
+template<typename T> auto OPERON_EXPORT NormalizedMeanSquaredError(Operon::Span<T const> x, Operon::Span<T const> y) noexcept -> double;
+template<typename T> auto OPERON_EXPORT NormalizedMeanSquaredError(Operon::Span<T const> x, Operon::Span<T const> y, Operon::Span<T const> w) noexcept -> double;
+
+template<typename T> auto OPERON_EXPORT MeanAbsoluteError(Operon::Span<T const> x, Operon::Span<T const> y) noexcept -> double;
+template<typename T> auto OPERON_EXPORT MeanAbsoluteError(Operon::Span<T const> x, Operon::Span<T const> y, Operon::Span<T const> w) noexcept -> double;
+
+template<typename T> auto OPERON_EXPORT R2Score(Operon::Span<T const> x, Operon::Span<T const> y) noexcept -> double;
+template<typename T> auto OPERON_EXPORT R2Score(Operon::Span<T const> x, Operon::Span<T const> y, Operon::Span<T const> w) noexcept -> double;
+
+template<typename T> auto OPERON_EXPORT CorrelationCoefficient(Operon::Span<T const> x, Operon::Span<T const> y) noexcept -> double;
+template<typename T> auto OPERON_EXPORT CorrelationCoefficient(Operon::Span<T const> x, Operon::Span<T const> y, Operon::Span<T const> w) noexcept -> double;
+
+template<typename T> auto SquaredCorrelation(Operon::Span<T const> x, Operon::Span<T const> y) noexcept -> double {
+    auto const r = CorrelationCoefficient(x, y);
+    return r * r;
+}
+
+template<typename T> auto SquaredCorrelation(Operon::Span<T const> x, Operon::Span<T const> y, Operon::Span<T const> w) noexcept -> double {
+    auto const r = CorrelationCoefficient(x, y, w);
+    return r * r;
+}
+
+} // namespace Operon::Vectorized
+
+#endif
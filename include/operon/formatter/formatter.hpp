@@ -4,13 +4,51 @@
 #ifndef OPERON_FORMAT_HPP
 #define OPERON_FORMAT_HPP
 
+#include <functional>
+#include <string>
 #include <unordered_map>
+#include <vector>
+#include <fmt/format.h>
 
 #include "operon/core/tree.hpp"
 
+namespace tf { class Executor; } // NOLINT
+
 namespace Operon {
 
 class Dataset;
+struct Individual;
+
+namespace detail {
+    // the name of a variable node, a lagged variable is written as name[t-lag]
+    inline auto VariableName(std::string const& name, Node const& node) -> std::string
+    {
+        return node.Lag == 0 ? name : fmt::format("{}[t-{}]", name, node.Lag);
+    }
+
+    // same as above, appended to the buffer
+    inline auto FormatVariable(fmt::memory_buffer& buffer, std::string const& name, Node const& node) -> void
+    {
+        buffer.append(name);
+        if (node.Lag != 0) { fmt::format_to(std::back_inserter(buffer), "[t-{}]", node.Lag); }
+    }
+
+    // a value with the given number of decimals, in parentheses if it is negative
+    inline auto FormatValue(fmt::memory_buffer& buffer, Operon::Scalar value, int decimalPrecision) -> void
+    {
+        if (value < 0) {
+            fmt::format_to(std::back_inserter(buffer), "({:.{}f})", value, decimalPrecision);
+        } else {
+            fmt::format_to(std::back_inserter(buffer), "{:.{}f}", value, decimalPrecision);
+        }
+    }
+
+    OPERON_EXPORT auto VariableNames(Dataset const& dataset) -> Operon::Map<Operon::Hash, std::string>;
+
+    // calls format(i, buffer) for i in [0, n) on the executor, each worker reuses its buffer
+    // - can be called from inside a worker of the executor (see RunTaskflow)
+    OPERON_EXPORT auto FormatAll(std::size_t n, tf::Executor& executor, std::function<void(std::size_t, fmt::memory_buffer&)> const& format) -> std::vector<std::string>;
+} // namespace detail
 
 class OPERON_EXPORT TreeFormatter {
     static auto FormatNode(Tree const& tree, Operon::Map<Operon::Hash, std::string> variableNames, size_t i, std::string& current, std::string indent, bool isLast, bool initialMarker, int decimalPrecision) -> void;
@@ -21,19 +59,59 @@ public:
 };
 
 class OPERON_EXPORT InfixFormatter {
-    static auto FormatNode(Tree const& tree, Operon::Map<Operon::Hash, std::string> const& variableNames, size_t i, std::string& current, int decimalPrecision) -> void;
+    static auto FormatNode(Tree const& tree, Operon::Map<Operon::Hash, std::string> const& variableNames, size_t i, fmt::memory_buffer& current, int decimalPrecision) -> void;
 
 public:
     static auto Format(Tree const& tree, Dataset const& dataset, int decimalPrecision = 2) -> std::string;
     static auto Format(Tree const& tree, Operon::Map<Operon::Hash, std::string> const& variableNames, int decimalPrecision = 2) -> std::string;
+
+    // appends to the buffer, which can be reused across trees to avoid the allocations
+    static auto Format(Tree const& tree, Operon::Map<Operon::Hash, std::string> const& variableNames, fmt::memory_buffer& buffer, int decimalPrecision = 2) -> void;
+
+    // formats the trees (eg. a population or an archive) in parallel, in the order of the input
+    static auto Format(Operon::Span<Tree const> trees, Operon::Map<Operon::Hash, std::string> const& variableNames, tf::Executor& executor, int decimalPrecision = 2) -> std::vector<std::string>;
+    static auto Format(Operon::Span<Individual const> individuals, Operon::Map<Operon::Hash, std::string> const& variableNames, tf::Executor& executor, int decimalPrecision = 2) -> std::vector<std::string>;
 };
 
 class OPERON_EXPORT PostfixFormatter {
-    static auto FormatNode(Tree const& tree, Operon::Map<Operon::Hash, std::string> const& variableNames, size_t i, std::string& current, int decimalPrecision) -> void;
+    static auto FormatNode(Tree const& tree, Operon::Map<Operon::Hash, std::string> const& variableNames, size_t i, fmt::memory_buffer& current, int decimalPrecision) -> void;
 
 public:
     static auto Format(Tree const& tree, Dataset const& dataset, int decimalPrecision = 2) -> std::string;
     static auto Format(Tree const& tree, Operon::Map<Operon::Hash, std::string> const& variableNames, int decimalPrecision = 2) -> std::string;
+
+    // appends to the buffer, which can be reused across trees to avoid the allocations
+    static auto Format(Tree const& tree, Operon::Map<Operon::Hash, std::string> const& variableNames, fmt::memory_buffer& buffer, int decimalPrecision = 2) -> void;
+
+    // formats the trees (eg. a population or an archive) in parallel, in the order of the input
+    static auto Format(Operon::Span<Tree const> trees, Operon::Map<Operon::Hash, std::string> const& variableNames, tf::Executor& executor, int decimalPrecision = 2) -> std::vector<std::string>;
+    static auto Format(Operon::Span<Individual const> individuals, Operon::Map<Operon::Hash, std::string> const& variableNames, tf::Executor& executor, int decimalPrecision = 2) -> std::vector<std::string>;
+};
+
+// generates the source code of a C++ function template that evaluates the tree over a range of rows
+// - template<typename T> auto name(T const* const* x, T* out, std::size_t n) -> void
+// - x[k] points to the values of the k-th input, the inputs are the distinct variables in the order of
+//   their first appearance in the tree and are listed in a comment above the function
+// - a lagged variable reads x[k][i - lag], the rows before the first one must be readable (see Node::Lag)
+// - the expression is fully inlined, with the node weights and the coefficients baked in as literals, which
+//   lets the compiler vectorize the loop over the rows (useful to deploy small models without the interpreter)
+// - dynamic nodes cannot be translated and throw std::runtime_error
+class OPERON_EXPORT CppFormatter {
+    static auto FormatNode(Tree const& tree, Operon::Vector<Operon::Hash> const& inputs, size_t i, std::string& current) -> void;
+    static auto FormatFunction(Tree const& tree, Operon::Map<Operon::Hash, std::string> const& variableNames, std::string const& name, std::string& current) -> void;
+
+public:
+    // the inputs of the generated function (the distinct variables in the order of their first appearance)
+    static auto Inputs(Tree const& tree) -> Operon::Vector<Operon::Hash>;
+
+    static auto Format(Tree const& tree, Dataset const& dataset, std::string const& name = "model") -> std::string;
+    static auto Format(Tree const& tree, Operon::Map<Operon::Hash, std::string> const& variableNames, std::string const& name = "model") -> std::string;
+
+    // a translation unit for ahead-of-time compilation of several models (eg. a production model set)
+    // - tree i is generated as the template name_i, with its own inputs, as above
+    // - each template also gets a C entry point name_i_evaluate instantiated for Operon::Scalar, which can be called
+    //   from other languages once the unit is compiled into a shared library
+    static auto FormatModule(Operon::Span<Tree const> trees, Operon::Map<Operon::Hash, std::string> const& variableNames, std::string const& name = "model") -> std::string;
 };
 
 struct OPERON_EXPORT DotFormatter {
@@ -0,0 +1,21 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_HASH_SEMANTIC_HASH_HPP
+#define OPERON_HASH_SEMANTIC_HASH_HPP
+
+#include "operon/core/types.hpp"
+#include "operon/operon_export.hpp"
+
+namespace Operon {
+
+// a hash of the output values of a model, so that models with the same behaviour have the same hash
+// - each value is rounded to the given number of mantissa bits before hashing, so that outputs that differ only by
+//   rounding errors (eg. x + x and 2x) hash to the same value
+// - negative zero and all the NaN values are hashed as zero and one NaN value, respectively
+// - the result is never zero, which is used to mean that no hash was computed
+OPERON_EXPORT auto SemanticHash(Operon::Span<Operon::Scalar const> values, int bits = 16) -> Operon::Hash; // NOLINT
+
+} // namespace Operon
+
+#endif
@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_APPROXIMATE_DISPATCH_HPP
+#define OPERON_APPROXIMATE_DISPATCH_HPP
+
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+#include "dispatch_table.hpp"
+#include "backend/fast_approx/impl/aq.hpp"
+#include "backend/fast_approx/impl/exp.hpp"
+#include "backend/fast_approx/impl/inv.hpp"
+#include "backend/fast_approx/impl/log.hpp"
+#include "backend/fast_approx/impl/pow.hpp"
+#include "backend/fast_approx/impl/sqrt.hpp"
+#include "backend/fast_approx/impl/tanh.hpp"
+#include "backend/fast_approx/impl/trig.hpp"
+
+namespace Operon {
+
+namespace detail::approximate {
+    namespace fa = Operon::Backend::detail::fast_approx;
+
+    template<std::size_t P>
+    struct Primitives {
+        static constexpr auto Exp(Operon::Scalar x) { return fa::ExpImpl<P>(x); }
+        static constexpr auto Log(Operon::Scalar x) { return fa::LogImpl<P>(x); }
+        static constexpr auto Log1p(Operon::Scalar x) { return fa::Log1pImpl<P>(x); }
+        static constexpr auto Logabs(Operon::Scalar x) { return fa::LogabsImpl<P>(x); }
+        static constexpr auto Sin(Operon::Scalar x) { return fa::SinImpl<P>(x); }
+        static constexpr auto Cos(Operon::Scalar x) { return fa::CosImpl<P>(x); }
+        static constexpr auto Tan(Operon::Scalar x) { return fa::TanImpl<P>(x); }
+        static constexpr auto Tanh(Operon::Scalar x) { return fa::TanhImpl<P>(x); }
+        static constexpr auto Sqrt(Operon::Scalar x) { return fa::SqrtImpl<P>(x); }
+        static constexpr auto Sqrtabs(Operon::Scalar x) { return fa::SqrtabsImpl<P>(x); }
+        static constexpr auto Sinh(Operon::Scalar x) { auto const e = Exp(x); return (e * e - 1.F) * fa::InvImpl<P>(e + e); }
+        static constexpr auto Cosh(Operon::Scalar x) { auto const e = Exp(x); return (e * e + 1.F) * fa::InvImpl<P>(e + e); }
+        static auto Pow(Operon::Scalar x, Operon::Scalar y) { return fa::PowImpl<P>(x, y); }
+        static constexpr auto Aq(Operon::Scalar x, Operon::Scalar y) { return fa::AqImpl<P>(x, y); }
+    };
+
+    // same argument layout as Dispatch::UnaryOp and Dispatch::BinaryOp
+    template<typename T, std::size_t S, auto F>
+    auto Unary(Operon::Vector<Node> const& /*nodes*/, Backend::View<T, S> view, std::size_t i, Operon::Range /*range*/) -> void {
+        auto const* arg = Backend::Ptr(view, i - 1);
+        std::transform(arg, arg + S, Backend::Ptr(view, i), [](auto x) { return static_cast<T>(F(static_cast<Operon::Scalar>(x))); });
+    }
+
+    template<typename T, std::size_t S, auto F>
+    auto Binary(Operon::Vector<Node> const& nodes, Backend::View<T, S> view, std::size_t i, Operon::Range /*range*/) -> void {
+        auto const j = i - 1;
+        auto const k = j - nodes[j].Length - 1;
+        auto const* a = Backend::Ptr(view, j);
+        auto const* b = Backend::Ptr(view, k);
+        std::transform(a, a + S, b, Backend::Ptr(view, i), [](auto x, auto y) {
+            return static_cast<T>(F(static_cast<Operon::Scalar>(x), static_cast<Operon::Scalar>(y)));
+        });
+    }
+
+    template<std::size_t P, typename T, typename... Ts>
+    auto Replace(DispatchTable<Ts...>& dtable, NodeType types) -> void {
+        using F = Primitives<P>;
+        constexpr auto S = DispatchTable<Ts...>::template BatchSize<T>;
+
+        auto replace = [&](NodeType type, Dispatch::Callable<T, S> f) {
+            if ((types & type) == NodeType{}) { return; }
+            auto& map = dtable.GetMap();
+            if (auto it = map.find(Node(type).HashValue); it != map.end()) {
+                std::get<Dispatch::Callable<T, S>>(std::get<0>(it->second)) = std::move(f);
+            }
+        };
+
+        replace(NodeType::Exp,     Unary<T, S, F::Exp>);
+        replace(NodeType::Log,     Unary<T, S, F::Log>);
+        replace(NodeType::Log1p,   Unary<T, S, F::Log1p>);
+        replace(NodeType::Logabs,  Unary<T, S, F::Logabs>);
+        replace(NodeType::Sin,     Unary<T, S, F::Sin>);
+        replace(NodeType::Cos,     Unary<T, S, F::Cos>);
+        replace(NodeType::Tan,     Unary<T, S, F::Tan>);
+        replace(NodeType::Sinh,    Unary<T, S, F::Sinh>);
+        replace(NodeType::Cosh,    Unary<T, S, F::Cosh>);
+        replace(NodeType::Tanh,    Unary<T, S, F::Tanh>);
+        replace(NodeType::Sqrt,    Unary<T, S, F::Sqrt>);
+        replace(NodeType::Sqrtabs, Unary<T, S, F::Sqrtabs>);
+        replace(NodeType::Pow,     Binary<T, S, F::Pow>);
+        replace(NodeType::Aq,      Binary<T, S, F::Aq>);
+    }
+} // namespace detail::approximate
+
+// replaces the transcendental primitives of a dispatch table with the fast approximations of the fast_approx backend
+// - precision is 0, 1 or 2 (same as the Fast_v1, Fast_v2 and Fast_v3 backends)
+// - the arithmetic primitives and the derivatives are kept, the derivatives are computed from the approximate primal values
+// - meant for a separate search table: the final models should be evaluated with an exact table (see operon_gp)
+// - only the primitives in the mask are replaced, eg. NodeType::Exp | NodeType::Tanh keeps the exact log and pow (the
+//   other primitives can also come from another backend, see DispatchTable::CopyPrimitives)
+template<typename... Ts>
+auto ApproximatePrimitives(DispatchTable<Ts...>& dtable, int precision, NodeType types = ~NodeType{}) -> void {
+    auto apply = [&]<std::size_t P>() {
+        // only the floating point types are replaced (not the dual numbers used for autodiff)
+        ([&]() { if constexpr (std::is_floating_point_v<Ts>) { detail::approximate::Replace<P, Ts>(dtable, types); } }(), ...);
+    };
+    switch (precision) {
+    case 0: { apply.template operator()<0>(); break; }
+    case 1: { apply.template operator()<1>(); break; }
+    case 2: { apply.template operator()<2>(); break; }
+    default: { throw std::invalid_argument(fmt::format("unsupported approximation precision {} (expected 0, 1 or 2)\n", precision)); }
+    }
+}
+
+} // namespace Operon
+
+#endif
@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_BATCH_TUNING_HPP
+#define OPERON_BATCH_TUNING_HPP
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "operon/core/dataset.hpp"
+#include "operon/core/range.hpp"
+#include "operon/core/tree.hpp"
+#include "operon/core/types.hpp"
+#include "dispatch_table.hpp"
+#include "interpreter.hpp"
+
+namespace Operon {
+
+// picks the fastest of several compiled batch sizes for each bucket of tree lengths
+// - the best batch size depends on the cache sizes of the machine and on the number of columns of a tree, so the
+//   tuning is done once at startup on a sample of trees (eg. trees of the creator over the range of lengths)
+// - the dispatch tables of the candidates are created with the tuner and hold the default primitives (the tables can
+//   be modified before the tuning, see ForEachTable)
+// - the lengths are bucketed by powers of two, trees longer than the last bucket use the last bucket
+// - until tuned (and for the buckets without trees) the default batch size of T is used if it is a candidate,
+//   otherwise the first candidate
+// - the tuned batch sizes are only read afterwards, so the tuner can be shared by the evaluators of several threads
+//   (see Evaluator::SetBatchSizeTuner)
+template<typename T, std::size_t... S>
+requires (sizeof...(S) > 0)
+class BatchSizeTuner {
+public:
+    static constexpr std::array<std::size_t, sizeof...(S)> Candidates{ S... };
+    static constexpr std::array<std::size_t, 4> Buckets{ 16, 32, 64, 128 }; // NOLINT, upper bounds (exclusive)
+
+    BatchSizeTuner()
+    {
+        auto const* it = std::ranges::find(Candidates, Dispatch::DefaultBatchSize<T>);
+        choice_.fill(it == Candidates.end() ? 0UL : static_cast<std::size_t>(std::distance(Candidates.begin(), it)));
+    }
+
+    // each candidate evaluates the trees of a bucket once before it is timed (the first pass warms up the caches and
+    // the buffers of the interpreter), then repeats times, the time of a candidate is its fastest repetition
+    auto Tune(Operon::Span<Operon::Tree const> trees, Operon::Dataset const& dataset, Operon::Range range, std::size_t repeats = 3) -> void
+    {
+        if (repeats == 0) { throw std::invalid_argument("the batch size tuning needs at least one repetition"); }
+        std::array<std::vector<std::size_t>, Buckets.size() + 1> buckets;
+        for (auto i = 0UL; i < trees.size(); ++i) { buckets[Bucket(trees[i].Length())].push_back(i); }
+        std::vector<std::vector<T>> coefficients;
+        coefficients.reserve(trees.size());
+        for (auto const& tree : trees) { coefficients.push_back(Coefficients(tree)); }
+
+        std::vector<T> result(range.Size());
+        for (auto b = 0UL; b < buckets.size(); ++b) {
+            if (buckets[b].empty()) { continue; }
+            auto pass = [&](std::size_t k) {
+                for (auto i : buckets[b]) {
+                    Evaluate(k, trees[i], dataset, { coefficients[i].data(), coefficients[i].size() }, range, { result.data(), result.size() });
+                }
+            };
+            auto best{std::numeric_limits<double>::max()};
+            for (auto k = 0UL; k < Candidates.size(); ++k) {
+                pass(k);
+                auto elapsed{std::numeric_limits<double>::max()};
+                for (auto r = 0UL; r < repeats; ++r) {
+                    auto const start = std::chrono::steady_clock::now();
+                    pass(k);
+                    elapsed = std::min(elapsed, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+                }
+                if (elapsed < best) {
+                    best = elapsed;
+                    choice_[b] = k;
+                }
+            }
+        }
+    }
+
+    // the batch size used for trees of the given length
+    [[nodiscard]] auto BatchSize(std::size_t length) const -> std::size_t { return Candidates[choice_[Bucket(length)]]; }
+
+    // calls f with the dispatch table of the batch size tuned for the given length
+    template<typename F>
+    auto Visit(std::size_t length, F&& f) const -> void
+    {
+        Visit(choice_[Bucket(length)], std::forward<F>(f), std::index_sequence_for<std::integral_constant<std::size_t, S>...>{});
+    }
+
+    // calls f with each of the dispatch tables (eg. to register approximate primitives, see ApproximatePrimitives)
+    template<typename F>
+    auto ForEachTable(F&& f) -> void
+    {
+        std::apply([&](auto&... table) { (f(table), ...); }, tables_);
+    }
+
+    // evaluates the tree using the interpreter compiled for the batch size tuned for its length
+    auto Evaluate(Operon::Tree const& tree, Operon::Dataset const& dataset, Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> result) const -> void
+    {
+        Evaluate(choice_[Bucket(tree.Length())], tree, dataset, coeff, range, result);
+    }
+
+    [[nodiscard]] auto Evaluate(Operon::Tree const& tree, Operon::Dataset const& dataset, Operon::Range range) const -> std::vector<T>
+    {
+        std::vector<T> result(range.Size());
+        auto const coeff = Coefficients(tree);
+        Evaluate(tree, dataset, { coeff.data(), coeff.size() }, range, { result.data(), result.size() });
+        return result;
+    }
+
+private:
+    static auto Bucket(std::size_t length) -> std::size_t
+    {
+        return static_cast<std::size_t>(std::distance(Buckets.begin(), std::ranges::upper_bound(Buckets, length)));
+    }
+
+    static auto Coefficients(Operon::Tree const& tree) -> std::vector<T>
+    {
+        auto const coeff = tree.GetCoefficients();
+        return { coeff.begin(), coeff.end() };
+    }
+
+    template<typename F, std::size_t... I>
+    auto Visit(std::size_t k, F&& f, std::index_sequence<I...> /*unused*/) const -> void
+    {
+        (void) ((k == I && (f(std::get<I>(tables_)), true)) || ...);
+    }
+
+    auto Evaluate(std::size_t k, Operon::Tree const& tree, Operon::Dataset const& dataset, Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> result) const -> void
+    {
+        Visit(k, [&]<typename Table>(Table const& table) {
+            Interpreter<T, Table>{table, dataset, tree}.Evaluate(coeff, range, result);
+        }, std::index_sequence_for<std::integral_constant<std::size_t, S>...>{});
+    }
+
+    std::tuple<BatchDispatch<T, S>...> tables_;
+    std::array<std::size_t, Buckets.size() + 1> choice_{};
+};
+
+// the candidates are multiples of the default alignment for single and double precision
+using DefaultBatchSizeTuner = BatchSizeTuner<Operon::Scalar, 32, 64, 128, 256, 512>; // NOLINT
+
+} // namespace Operon
+
+#endif
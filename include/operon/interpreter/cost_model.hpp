@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_COST_MODEL_HPP
+#define OPERON_COST_MODEL_HPP
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "operon/core/dataset.hpp"
+#include "operon/core/node.hpp"
+#include "operon/core/range.hpp"
+#include "operon/core/tree.hpp"
+#include "operon/core/types.hpp"
+#include "interpreter.hpp"
+
+namespace Operon {
+
+// the estimated time (in nanoseconds per row) the interpreter takes to evaluate a tree, as the sum of the costs of its
+// nodes, an n-ary node costs one operation per pair of arguments (arity - 1)
+// - the costs are measured on the current machine with the given dispatch table (see Calibrate), so that they account
+//   for the backends and approximations of the primitives
+// - until calibrated each node costs 1, the cost is then the length of the tree with the n-ary nodes expanded
+class EvaluationCostModel {
+public:
+    static constexpr std::size_t DefaultRows{4096};
+    static constexpr std::size_t DefaultRepeats{5};
+    static constexpr std::size_t ChainLength{32}; // NOLINT, the number of operations of a calibration tree
+
+    EvaluationCostModel() { costs_.fill(1); }
+
+    // times the evaluation of chains of each primitive (the leaves are variables) on random values in [0.1, 0.9], the
+    // cost of a primitive is the time of its chain minus the time of its leaves, the time of a chain is its fastest
+    // repetition
+    // - the cost of a leaf includes the fixed cost of an evaluation (a tree has at least one leaf)
+    // - only the given primitives are measured, the others (and Dynamic, which is not known to the table) keep the
+    //   default cost
+    template<typename DTable>
+    static auto Calibrate(DTable const& dtable, NodeType types = ~NodeType{}, std::size_t rows = DefaultRows, std::size_t repeats = DefaultRepeats) -> EvaluationCostModel
+    {
+        if (rows == 0 || repeats == 0) { throw std::invalid_argument("the cost model calibration needs at least one row and one repetition"); }
+        Operon::RandomGenerator random{0};
+        std::uniform_real_distribution<Operon::Scalar> dist(0.1, 0.9); // NOLINT, in the domain of all the primitives
+        Dataset::Matrix values(static_cast<Eigen::Index>(rows), 1);
+        std::generate_n(values.data(), values.size(), [&]() { return dist(random); });
+        Dataset const dataset(std::move(values));
+        auto const x = dataset.GetVariables().front().Hash;
+        Operon::Range const range{0, rows};
+        std::vector<Operon::Scalar> result(rows);
+
+        auto time = [&](Operon::Vector<Node> nodes) {
+            Tree tree{std::move(nodes)};
+            tree.UpdateNodes();
+            auto const coeff = tree.GetCoefficients();
+            Interpreter<Operon::Scalar, DTable> const interpreter{dtable, dataset, tree};
+            interpreter.Evaluate(coeff, range, result); // warm up
+            auto elapsed{std::numeric_limits<double>::max()};
+            for (auto r = 0UL; r < repeats; ++r) {
+                auto const start = std::chrono::steady_clock::now();
+                interpreter.Evaluate(coeff, range, result);
+                elapsed = std::min(elapsed, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+            }
+            return elapsed / static_cast<double>(rows);
+        };
+
+        EvaluationCostModel model;
+        auto const variable = time({ Node(NodeType::Variable, x) });
+        model.SetCost(NodeType::Variable, variable);
+        model.SetCost(NodeType::Constant, time({ Node::Constant(1) }));
+
+        for (auto i = 0UL; i < NodeTypes::Count; ++i) {
+            auto const type = static_cast<NodeType>(1U << i);
+            Node const node(type);
+            if ((types & type) == NodeType{} || node.IsLeaf()) { continue; }
+            // unary: x f f ... f, binary: x x f x f ... x f (a left-deep chain)
+            Operon::Vector<Node> chain{ Node(NodeType::Variable, x) };
+            for (auto k = 0UL; k < ChainLength; ++k) {
+                if (node.Arity == 2) { chain.emplace_back(NodeType::Variable, x); }
+                chain.push_back(node);
+            }
+            auto const leaves = node.Arity == 2 ? static_cast<double>(ChainLength) * variable : 0.0;
+            model.SetCost(type, std::max(0.0, (time(chain) - variable - leaves) / static_cast<double>(ChainLength)));
+        }
+        return model;
+    }
+
+    [[nodiscard]] auto Cost(NodeType type) const -> double { return costs_[NodeTypes::GetIndex(type)]; }
+    auto SetCost(NodeType type, double nanoseconds) -> void { costs_[NodeTypes::GetIndex(type)] = nanoseconds; }
+
+    // the estimated cost of the tree, in nanoseconds per row once calibrated
+    [[nodiscard]] auto operator()(Operon::Tree const& tree) const -> double
+    {
+        auto cost{0.0};
+        for (auto const& node : tree.Nodes()) {
+            auto const operations = node.Type < NodeType::Aq && node.Arity > 2 ? node.Arity - 1 : 1;
+            cost += Cost(node.Type) * static_cast<double>(operations);
+        }
+        return cost;
+    }
+
+private:
+    std::array<double, NodeTypes::Count> costs_{};
+};
+
+} // namespace Operon
+
+#endif
@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_CPU_DISPATCH_HPP
+#define OPERON_CPU_DISPATCH_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "dispatch_table.hpp"
+#include "operon/operon_export.hpp"
+
+namespace Operon {
+
+// instruction set targets for the primitives of the default dispatch table
+// - the library itself is compiled for the baseline target (the flags of the build)
+// - the other targets are optional modules built with OPERON_DISPATCH_TARGETS (eg. -DOPERON_DISPATCH_TARGETS="x86-64-v3;x86-64-v4"),
+//   containing the same MATH_BACKEND primitives compiled for that instruction set
+// - the modules are looked up in the directories listed by the OPERON_DISPATCH_PATH environment variable,
+//   then in the build and install directories
+enum class DispatchTarget : int { Baseline, X86_64_V2, X86_64_V3, X86_64_V4 };
+
+namespace detail {
+    // identifies the layout of the dispatch table, a module built with a different scalar type or backend is rejected
+    constexpr auto DispatchAbi() -> std::uint64_t {
+        return (sizeof(Operon::Scalar) << 32U) | (sizeof(DefaultDispatch::Map) << 16U) | Backend::BatchSize<Operon::Scalar>;
+    }
+} // namespace detail
+
+OPERON_EXPORT auto DispatchTargetName(DispatchTarget target) -> std::string_view;
+
+// parses the names returned by DispatchTargetName
+OPERON_EXPORT auto ParseDispatchTarget(std::string_view name) -> std::optional<DispatchTarget>;
+
+// true if the cpu supports the instruction set of the target (as reported by cpuid)
+OPERON_EXPORT auto CpuSupports(DispatchTarget target) -> bool;
+
+// the targets supported by the cpu for which a module could be loaded, in increasing order
+OPERON_EXPORT auto AvailableDispatchTargets() -> std::vector<DispatchTarget>;
+
+OPERON_EXPORT auto BestDispatchTarget() -> DispatchTarget;
+
+// returns a default dispatch table with the primitives compiled for the given target
+// - throws if the cpu does not support the target or if its module cannot be loaded
+// - the modules stay loaded until the program exits, since the callables live in them
+OPERON_EXPORT auto MakeDispatchTable(DispatchTarget target) -> DefaultDispatch;
+
+// same as above, using the best available target
+OPERON_EXPORT auto MakeDispatchTable() -> DefaultDispatch;
+
+// returns the table of a module at the given path (eg. one of the backend modules built for the backend benchmark)
+// - the module must export the same entry points as the target modules (see dispatch_target.cpp)
+// - throws if the module cannot be loaded or was built for a different scalar type
+// - its primitives can be mixed with those of another table (see DispatchTable::CopyPrimitives)
+OPERON_EXPORT auto LoadDispatchTable(std::string const& path) -> DefaultDispatch;
+
+} // namespace Operon
+
+#endif
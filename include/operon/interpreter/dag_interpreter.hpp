@@ -0,0 +1,176 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_DAG_INTERPRETER_HPP
+#define OPERON_DAG_INTERPRETER_HPP
+
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include "operon/hash/hash.hpp"
+#include "interpreter.hpp"
+
+namespace Operon {
+
+// evaluates a group of trees as a single DAG where identical subtrees are shared (hash-consing)
+// - two nodes are merged if they have the same type, the same value and the same (already merged) children
+// - each unique subexpression is evaluated only once per batch of rows
+// - each tree is evaluated using its own coefficients (node values)
+template<typename T = Operon::Scalar, typename DTable = DefaultDispatch>
+requires DTable::template SupportsType<T>
+class DagInterpreter {
+    using Callable = Dispatch::Callable<T, DTable::template BatchSize<T>>;
+
+    struct Vertex {
+        Operon::Node Node;
+        std::size_t ChildOffset; // offset of the first child in the children_ array
+        std::optional<Callable const> Function;
+    };
+
+public:
+    static constexpr auto BatchSize = DTable::template BatchSize<T>;
+
+    DagInterpreter(DTable const& dtable, Operon::Dataset const& dataset, Operon::Span<std::reference_wrapper<Operon::Tree const> const> trees)
+        : dataset_(dataset)
+    {
+        Operon::Map<Operon::Hash, std::size_t> index;
+        std::vector<std::size_t> ids;
+        std::vector<Operon::Hash> key;
+        Operon::Hasher hasher;
+
+        for (auto const& tree : trees) {
+            auto const& nodes = tree.get().Nodes();
+            ENSURE(!nodes.empty());
+            ids.resize(nodes.size());
+            nodeCount_ += nodes.size();
+
+            for (auto i = 0UL; i < nodes.size(); ++i) {
+                auto const& n = nodes[i];
+                Operon::Hash value{0};
+                std::memcpy(&value, &n.Value, sizeof(n.Value));
+                key.clear();
+                key.push_back(n.HashValue);
+                key.push_back(value);
+                key.push_back(n.Lag);
+                if (!n.IsLeaf()) {
+                    for (auto j : Tree::Indices(nodes, i)) { key.push_back(ids[j]); }
+                }
+
+                auto h = hasher(std::bit_cast<uint8_t const*>(key.data()), sizeof(Operon::Hash) * key.size());
+                if (auto it = index.find(h); it != index.end()) {
+                    ids[i] = it->second;
+                    continue;
+                }
+
+                auto const offset = children_.size();
+                if (!n.IsLeaf()) {
+                    for (auto j : Tree::Indices(nodes, i)) { children_.push_back(ids[j]); }
+                    maxArity_ = std::max(maxArity_, std::size_t{n.Arity});
+                }
+                auto function = dtable.template TryGetFunction<T>(n);
+                if (!n.IsLeaf() && !function) {
+                    throw std::runtime_error(fmt::format("Missing primitive for node {}\n", n.Name()));
+                }
+                ids[i] = vertices_.size();
+                index.insert({ h, ids[i] });
+                vertices_.push_back({ n, offset, std::move(function) });
+            }
+            roots_.push_back(ids.back());
+        }
+    }
+
+    // the result has length (number of trees) * range.Size()
+    auto Evaluate(Operon::Range range, Operon::Span<T> result) const -> void
+    {
+        constexpr int64_t S{ BatchSize };
+        auto const len { static_cast<int64_t>(range.Size()) };
+        auto const nv { vertices_.size() };
+        EXPECT(result.size() >= roots_.size() * range.Size());
+
+        auto primalStorage = detail::AllocateAligned<T, Backend::DefaultAlignment>(S * nv);
+        Backend::View<T, S> primal(primalStorage.get(), S, nv);
+
+        // the callables expect the children of a node to precede it in postfix order
+        // therefore, the arguments of each vertex are gathered into a small scratch view
+        auto const ns { maxArity_ + 1 };
+        auto scratchStorage = detail::AllocateAligned<T, Backend::DefaultAlignment>(S * ns);
+        Backend::View<T, S> scratch(scratchStorage.get(), S, ns);
+        Operon::Vector<Operon::Node> scratchNodes(ns, Operon::Node::Constant(0));
+
+        std::vector<std::span<Operon::Scalar const>> values(nv);
+        std::vector<std::pair<Operon::Scalar, Operon::Scalar>> transforms(nv, { 1, 0 });
+        for (auto i = 0UL; i < nv; ++i) {
+            auto const& n = vertices_[i].Node;
+            if (n.IsVariable()) {
+                values[i] = dataset_.get().GetValues(n.HashValue, range, n.Lag);
+                transforms[i] = dataset_.get().GetTransform(n.HashValue);
+            } else if (n.IsConstant()) {
+                Fill<T, S>(primal, static_cast<int>(i), static_cast<T>(n.Value));
+            }
+        }
+
+        for (auto row = 0L; row < len; row += S) {
+            auto const rem = std::min(S, len - row);
+            Operon::Range rg(range.Start() + row, range.Start() + row + rem);
+
+            for (auto i = 0UL; i < nv; ++i) {
+                auto const& [n, offset, f] = vertices_[i];
+                auto* ptr = primal.data_handle() + i * S;
+                auto const w = static_cast<T>(n.Value);
+
+                if (n.IsVariable()) {
+                    auto const [scale, offset] = transforms[i];
+                    std::ranges::transform(values[i].subspan(row, rem), ptr, [a = w * scale, b = w * offset](auto x) { return x * a + b; });
+                } else if (f) {
+                    auto const a { std::size_t{n.Arity} };
+                    for (auto k = 0UL; k < a; ++k) {
+                        auto const* src = primal.data_handle() + children_[offset + k] * S;
+                        std::copy_n(src, rem, scratch.data_handle() + (a - 1 - k) * S);
+                    }
+                    scratchNodes[a] = n;
+                    scratchNodes[a].Length = static_cast<uint16_t>(a);
+                    std::invoke(*f, scratchNodes, scratch, a, rg);
+                    scratchNodes[a] = Operon::Node::Constant(0);
+
+                    auto const* res = scratch.data_handle() + a * S;
+                    if (w != T{1}) {
+                        std::transform(res, res + rem, ptr, [w](auto x) { return x * w; });
+                    } else {
+                        std::copy_n(res, rem, ptr);
+                    }
+                }
+            }
+
+            for (auto t = 0UL; t < roots_.size(); ++t) {
+                auto const* ptr = primal.data_handle() + roots_[t] * S;
+                std::copy_n(ptr, rem, result.data() + t * range.Size() + row);
+            }
+        }
+    }
+
+    auto Evaluate(Operon::Range range) const -> std::vector<T>
+    {
+        std::vector<T> result(roots_.size() * range.Size());
+        Evaluate(range, { result.data(), result.size() });
+        return result;
+    }
+
+    // number of unique subexpressions
+    [[nodiscard]] auto VertexCount() const -> std::size_t { return vertices_.size(); }
+
+    // total number of nodes in the trees
+    [[nodiscard]] auto NodeCount() const -> std::size_t { return nodeCount_; }
+
+private:
+    std::reference_wrapper<Operon::Dataset const> dataset_;
+    std::vector<Vertex> vertices_;
+    std::vector<std::size_t> children_;
+    std::vector<std::size_t> roots_;
+    std::size_t maxArity_{0};
+    std::size_t nodeCount_{0};
+};
+
+} // namespace Operon
+
+#endif
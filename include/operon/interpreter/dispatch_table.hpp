@@ -6,9 +6,17 @@
 
 #include <Eigen/Dense>
 #include <fmt/core.h>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <limits>
 #include <optional>
 #include <cstddef>
+#include <span>
+#include <stdexcept>
 #include <tuple>
+#include <type_traits>
+#include <vector>
 
 #include "operon/core/node.hpp"
 #include "operon/core/range.hpp"
@@ -30,6 +38,18 @@ using Callable = std::function<void(Operon::Vector<Node> const&, Backend::View<T
 template<typename T, std::size_t S>
 using CallableDiff = std::function<void(Operon::Vector<Node> const&, Backend::View<T const, S>, Backend::View<T, S>, int, int)>;
 
+// the plain functions wrapped by the callables of the built-in primitives (see Tape)
+template<typename T, std::size_t S>
+using FunctionPtr = void(*)(Operon::Vector<Node> const&, Backend::View<T, S>, size_t, Operon::Range);
+
+template<typename T, std::size_t S>
+using DerivativePtr = void(*)(Operon::Vector<Node> const&, Backend::View<T const, S>, Backend::View<T, S>, int, int);
+
+// the kernels of the built-in primitives addressed by column instead of node index (the result column followed by the
+// argument columns), used with the compact primal layout of the tape
+template<typename T, std::size_t S>
+using ColumnPtr = void(*)(Backend::View<T, S>, std::uint32_t, std::span<std::uint32_t const>);
+
 // dispatching mechanism
 // compared to the simple/naive way of evaluating n-ary symbols, this method has the following advantages:
 // 1) improved performance: the naive method accumulates into the result for each argument, leading to unnecessary assignments
@@ -90,14 +110,40 @@ static inline void BinaryOp(Operon::Vector<Node> const& nodes, Backend::View<T,
 {
     auto j = i - 1;
     auto k = j - nodes[j].Length - 1;
-    Func<T, Type, false>{}(m, i, j, k);
+    Func<T, Type, false, S>{}(m, i, j, k);
 }
 
 template<NodeType Type, typename T, std::size_t S>
 requires Node::IsUnary<Type>
 static inline void UnaryOp(Operon::Vector<Node> const& /*unused*/, Backend::View<T, S> m, size_t i, Operon::Range /*unused*/)
 {
-    Func<T, Type, false>{}(m, i, i-1);
+    Func<T, Type, false, S>{}(m, i, i-1);
+}
+
+// same as above but the arguments are given by their columns
+template<NodeType Type, typename T, std::size_t S>
+static inline void ColumnOp(Backend::View<T, S> data, std::uint32_t result, std::span<std::uint32_t const> args)
+{
+    if constexpr (Node::IsNary<Type>) {
+        auto const call = [&](bool continued, auto... args) {
+            if (continued) { Func<T, Type, true , S>{}(data, result, args...); }
+            else           { Func<T, Type, false, S>{}(data, result, args...); }
+        };
+
+        bool continued = false;
+        for (auto k = 0UL; k < args.size(); continued = true) {
+            switch (args.size() - k) {
+            case 1: { call(continued, args[k]); k += 1; break; }
+            case 2: { call(continued, args[k], args[k+1]); k += 2; break; }
+            case 3: { call(continued, args[k], args[k+1], args[k+2]); k += 3; break; }
+            default: { call(continued, args[k], args[k+1], args[k+2], args[k+3]); k += 4; break; }
+            }
+        }
+    } else if constexpr (Node::IsBinary<Type>) {
+        Func<T, Type, false, S>{}(data, result, args[0], args[1]);
+    } else if constexpr (Node::IsUnary<Type>) {
+        Func<T, Type, false, S>{}(data, result, args[0]);
+    }
 }
 
 struct Noop {
@@ -105,23 +151,85 @@ struct Noop {
     void operator()(Args&&... /*unused*/) {}
 };
 
+// the columns of the arguments of a user-defined primitive, in the order of the children (the first argument is the
+// node right before its parent, see Tree::Indices)
+template<typename T, std::size_t S>
+using Arguments = std::span<std::span<T const, S> const>;
+
+template<typename T, std::size_t S, typename V>
+static inline auto CollectArguments(Operon::Vector<Node> const& nodes, V view, std::size_t i, std::vector<std::span<T const, S>>& args) -> void
+{
+    args.clear();
+    for (std::size_t a = 0, j = i - 1; a < nodes[i].Arity; ++a, j -= nodes[j].Length + 1) {
+        args.emplace_back(Backend::Ptr(view, j), S);
+    }
+}
+
+// wraps the batch kernels of a user-defined primitive (see DispatchTable::RegisterPrimitive)
+// - Kernel(result, args) computes the S values of the result from those of the arguments
+// - the argument list is kept in a thread-local buffer, so the call does not allocate
+template<typename T, std::size_t S, typename F>
+struct DynamicOp {
+    F Kernel;
+
+    auto operator()(Operon::Vector<Node> const& nodes, Backend::View<T, S> view, std::size_t i, Operon::Range /*unused*/) const -> void {
+        thread_local std::vector<std::span<T const, S>> args;
+        CollectArguments<T, S>(nodes, view, i, args);
+        Kernel(std::span<T, S>{Backend::Ptr(view, i), S}, Arguments<T, S>{args});
+    }
+};
+
+// - Kernel(result, args, k, partial) computes the partial derivative of the result with respect to argument k, the
+//   result is the value of the primitive before its node weight is applied
+template<typename T, std::size_t S, typename DF>
+struct DynamicDiffOp {
+    DF Kernel;
+
+    auto operator()(Operon::Vector<Node> const& nodes, Backend::View<T const, S> primal, Backend::View<T, S> trace, int i, int j) const -> void {
+        thread_local std::vector<std::span<T const, S>> args;
+        CollectArguments<T, S>(nodes, primal, static_cast<std::size_t>(i), args);
+        auto k{0UL};
+        for (auto c = i - 1; c != j; c -= static_cast<int>(nodes[c].Length) + 1) { ++k; }
+        Kernel(std::span<T const, S>{Backend::Ptr(primal, i), S}, Arguments<T, S>{args}, k, std::span<T, S>{Backend::Ptr(trace, j), S});
+    }
+};
+
 template<NodeType Type, typename T, std::size_t S>
 static inline void DiffOp(Operon::Vector<Node> const& nodes, Backend::View<T const, S> primal, Backend::View<T, S> trace, int i, int j) {
    Diff<T, Type, S>{}(nodes, primal, trace, i, j);
 }
 
 template<NodeType Type, typename T, std::size_t S>
-static constexpr auto MakeFunctionCall() -> Dispatch::Callable<T, S>
+static constexpr auto BuiltinCall() -> FunctionPtr<T, S>
 {
     if constexpr (Node::IsNary<Type>) {
-        return Callable<T, S>{NaryOp<Type, T, S>};
+        return &NaryOp<Type, T, S>;
     } else if constexpr (Node::IsBinary<Type>) {
-        return Callable<T, S>{BinaryOp<Type, T, S>};
+        return &BinaryOp<Type, T, S>;
     } else if constexpr (Node::IsUnary<Type>) {
-        return Callable<T, S>{UnaryOp<Type, T, S>};
+        return &UnaryOp<Type, T, S>;
     }
 }
 
+template<NodeType Type, typename T, std::size_t S>
+static constexpr auto MakeFunctionCall() -> Dispatch::Callable<T, S>
+{
+    return Callable<T, S>{BuiltinCall<Type, T, S>()};
+}
+
+// returns the column kernel of the given node type if f is its built-in primitive, nullptr otherwise (eg. for a
+// callable registered by the user)
+template<typename T, std::size_t S>
+static auto MakeColumnCall(NodeType type, FunctionPtr<T, S> f) -> ColumnPtr<T, S>
+{
+    auto constexpr g = [](auto i) { return static_cast<NodeType>(1U << i); };
+    ColumnPtr<T, S> result{nullptr};
+    [&]<auto ...I>(std::index_sequence<I...>){
+        (void) ((type == g(I) && (result = (f == BuiltinCall<g(I), T, S>() ? &ColumnOp<g(I), T, S> : nullptr), true)) || ...);
+    }(std::make_index_sequence<NodeTypes::Count-3>{});
+    return result;
+}
+
 template<NodeType Type, typename T, std::size_t S>
 static constexpr auto MakeDiffCall() -> Dispatch::CallableDiff<T, S>
 {
@@ -210,6 +318,28 @@ private:
         return Dispatch::MakeDiffCall<Type, T, BatchSize<T>>();
     }
 
+    template<typename T, typename F>
+    static auto MakePrimitive(F const& f) -> Callable<T> {
+        constexpr auto S = BatchSize<T>;
+        if constexpr (std::is_invocable_v<F const&, std::span<T, S>, Dispatch::Arguments<T, S>>) {
+            return Dispatch::DynamicOp<T, S, F>{f};
+        } else {
+            return [](auto&&... /*unused*/) { throw std::runtime_error("the user-defined primitive is not invocable for this type\n"); };
+        }
+    }
+
+    template<typename T, typename DF>
+    static auto MakePrimitiveDiff(DF const& df) -> CallableDiff<T> {
+        constexpr auto S = BatchSize<T>;
+        if constexpr (!std::is_arithmetic_v<T>) {
+            return Dispatch::Noop{}; // same as the built-in primitives (see Dispatch::MakeDiffCall)
+        } else if constexpr (std::is_invocable_v<DF const&, std::span<T const, S>, Dispatch::Arguments<T, S>, std::size_t, std::span<T, S>>) {
+            return Dispatch::DynamicDiffOp<T, S, DF>{df};
+        } else {
+            return [](auto&&... /*unused*/) { throw std::runtime_error("the user-defined primitive has no derivative\n"); };
+        }
+    }
+
     template<NodeType Type>
     static constexpr auto MakeTuple()
     {
@@ -229,11 +359,39 @@ private:
                     return std::make_tuple(CallableDiff<std::tuple_element_t<Idx, Typ>>{}...);
                  }(std::index_sequence_for<Typ>{}));
 
+public:
     using Tuple = std::tuple<TFun, TDif>;
     using Map   = Operon::Map<Operon::Hash, Tuple>;
 
+private:
+    static auto constexpr NoIndex { std::numeric_limits<std::uint32_t>::max() };
+
     Map map_;
 
+    // position in the map of the callables associated with the hash of each built-in node type
+    // - the map stores its values contiguously, so a node whose hash matches the one of its type is resolved
+    //   with an array access instead of a hash lookup
+    // - the key at the position is checked on every access, if the map was modified through GetMap (eg. by
+    //   erasing elements) the lookup falls back to the map
+    std::array<std::uint32_t, NodeTypes::Count> index_{};
+
+    auto UpdateIndex() -> void {
+        for (auto i = 0UL; i < NodeTypes::Count; ++i) {
+            auto it = map_.find(Node(static_cast<NodeType>(1U << i)).HashValue);
+            index_[i] = it == map_.end() ? NoIndex : static_cast<std::uint32_t>(std::distance(map_.begin(), it));
+        }
+    }
+
+    [[nodiscard]] inline auto Find(Node const& node) const noexcept -> Tuple const* {
+        auto const& values = map_.values();
+        auto const i = index_[NodeTypes::GetIndex(node.Type)];
+        if (i < values.size() && values[i].first == node.HashValue) {
+            return &values[i].second;
+        }
+        auto it = map_.find(node.HashValue);
+        return it == map_.end() ? nullptr : &it->second;
+    }
+
 public:
     DispatchTable()
     {
@@ -241,6 +399,7 @@ public:
         [&]<auto ...I>(std::index_sequence<I...>){
             (map_.insert({ Node(f(I)).HashValue, MakeTuple<f(I)>() }), ...);
         }(std::make_index_sequence<NodeTypes::Count-3>{});
+        UpdateIndex();
     }
 
     ~DispatchTable() = default;
@@ -248,24 +407,26 @@ public:
     auto operator=(DispatchTable const& other) -> DispatchTable& {
         if (this != &other) {
             map_ = other.map_;
+            UpdateIndex();
         }
         return *this;
     }
 
     auto operator=(DispatchTable&& other) noexcept -> DispatchTable& {
         map_ = std::move(other.map_);
+        UpdateIndex();
         return *this;
     }
 
     template<typename U>
     static constexpr auto SupportsType = TypeIndex<U> < std::tuple_size_v<Typ>;
 
-    explicit DispatchTable(Map const& map) : map_(map) { }
-    explicit DispatchTable(Map&& map) : map_(std::move(map)) { }
-    explicit DispatchTable(std::unordered_map<Operon::Hash, Tuple> const& map) : map_(map.begin(), map.end()) { }
+    explicit DispatchTable(Map const& map) : map_(map) { UpdateIndex(); }
+    explicit DispatchTable(Map&& map) : map_(std::move(map)) { UpdateIndex(); }
+    explicit DispatchTable(std::unordered_map<Operon::Hash, Tuple> const& map) : map_(map.begin(), map.end()) { UpdateIndex(); }
 
-    DispatchTable(DispatchTable const& other) : map_(other.map_) { }
-    DispatchTable(DispatchTable &&other) noexcept : map_(std::move(other.map_)) { }
+    DispatchTable(DispatchTable const& other) : map_(other.map_), index_(other.index_) { }
+    DispatchTable(DispatchTable &&other) noexcept : map_(std::move(other.map_)), index_(other.index_) { }
 
     auto GetMap() -> Map& { return map_; }
     auto GetMap() const -> Map const& { return map_; }
@@ -309,14 +470,40 @@ public:
         throw std::runtime_error(fmt::format("Hash value {} is not in the map\n", h));
     }
 
+    // registers callables with the signatures of Callable and CallableDiff, they must be invocable for every supported type
+    // (see RegisterPrimitive for batch kernels over columns)
     template<typename F>
     void RegisterCallable(Operon::Hash hash, F&& f) {
-        map_[hash] = MakeTuple<F, Ts...>(std::forward<F&&>(f), Dispatch::Noop{});
+        RegisterCallable(hash, std::forward<F>(f), Dispatch::Noop{});
     }
 
     template<typename F, typename DF>
     void RegisterCallable(Operon::Hash hash, F&& f, DF&& df) {
-        map_[hash] = MakeTuple<F, Ts...>(std::forward<F&&>(f), std::forward<DF&&>(df));
+        map_[hash] = [&]<auto... Idx>(std::index_sequence<Idx...>) {
+            return Tuple{ TFun{ Callable<std::tuple_element_t<Idx, Tup>>{f}... }, TDif{ CallableDiff<std::tuple_element_t<Idx, Tup>>{df}... } };
+        }(std::index_sequence_for<Typ>{});
+        UpdateIndex();
+    }
+
+    // registers the batch kernels of a user-defined primitive, evaluated for the nodes of type Dynamic with the given hash
+    // (eg. Node node(NodeType::Dynamic, hash); node.Arity = 2;)
+    // - f(result, args): result is a std::span<T, S> over the batch of the node and args the spans over the batches of
+    //   its arguments (see Dispatch::Arguments), the extent S is the batch size of the type so the loops over the rows
+    //   have a constant trip count and can be vectorized like the built-in primitives
+    // - df(result, args, k, partial): the partial derivative of the result with respect to argument k (see Dispatch::DynamicDiffOp)
+    // - the kernels are generic over the value type T, a type for which they are not invocable throws when evaluated
+    // - without a derivative the trees with the primitive can be evaluated but throw when differentiated (eg. by JacRev)
+    template<typename F, typename DF>
+    void RegisterPrimitive(Operon::Hash hash, F f, DF df) {
+        map_[hash] = [&]<auto... Idx>(std::index_sequence<Idx...>) {
+            return Tuple{ TFun{ MakePrimitive<std::tuple_element_t<Idx, Tup>>(f)... }, TDif{ MakePrimitiveDiff<std::tuple_element_t<Idx, Tup>>(df)... } };
+        }(std::index_sequence_for<Typ>{});
+        UpdateIndex();
+    }
+
+    template<typename F>
+    void RegisterPrimitive(Operon::Hash hash, F f) {
+        RegisterPrimitive(hash, std::move(f), Dispatch::Noop{});
     }
 
     template<typename T>
@@ -337,10 +524,78 @@ public:
         return {};
     }
 
+    // pointer access to the stored callables (nullptr if the hash is not in the map)
+    // - the pointers remain valid as long as no callables are registered or removed
+    template<typename T>
+    [[nodiscard]] inline auto TryGetFunctionPtr(Operon::Hash const h) const noexcept -> Callable<T> const*
+    {
+        if (auto it = map_.find(h); it != map_.end()) {
+            return &std::get<TypeIndex<T>>(std::get<0>(it->second));
+        }
+        return nullptr;
+    }
+
+    template<typename T>
+    [[nodiscard]] inline auto TryGetDerivativePtr(Operon::Hash const h) const noexcept -> CallableDiff<T> const*
+    {
+        if (auto it = map_.find(h); it != map_.end()) {
+            return &std::get<TypeIndex<T>>(std::get<1>(it->second));
+        }
+        return nullptr;
+    }
+
+    // same as above, built-in node types are resolved without a hash lookup (dynamic nodes go through the map)
+    template<typename T>
+    [[nodiscard]] inline auto TryGetFunction(Node const& node) const noexcept -> std::optional<Callable<T>>
+    {
+        if (auto const* t = Find(node); t != nullptr) { return std::optional{ std::get<TypeIndex<T>>(std::get<0>(*t)) }; }
+        return {};
+    }
+
+    template<typename T>
+    [[nodiscard]] inline auto TryGetFunctionPtr(Node const& node) const noexcept -> Callable<T> const*
+    {
+        auto const* t = Find(node);
+        return t == nullptr ? nullptr : &std::get<TypeIndex<T>>(std::get<0>(*t));
+    }
+
+    template<typename T>
+    [[nodiscard]] inline auto TryGetDerivativePtr(Node const& node) const noexcept -> CallableDiff<T> const*
+    {
+        auto const* t = Find(node);
+        return t == nullptr ? nullptr : &std::get<TypeIndex<T>>(std::get<1>(*t));
+    }
+
+    // replaces the callables (primal and derivative) of the built-in node types in the mask by those of another table,
+    // eg. one loaded from a backend module (see LoadDispatchTable), so that each primitive can come from a different backend
+    // - the types missing from the other table are left unchanged
+    // - the callables may live in a module of the other table, which must stay loaded
+    auto CopyPrimitives(DispatchTable const& other, NodeType types) -> void {
+        for (auto i = 0UL; i < NodeTypes::Count; ++i) {
+            auto const type = static_cast<NodeType>(1U << i);
+            if ((types & type) == NodeType{}) { continue; }
+            auto const h = Node(type).HashValue;
+            if (auto it = other.map_.find(h); it != other.map_.end()) { map_[h] = it->second; }
+        }
+        UpdateIndex();
+    }
+
     [[nodiscard]] auto Contains(Operon::Hash hash) const noexcept -> bool { return map_.contains(hash); }
 }; // struct DispatchTable
 
 using DefaultDispatch = DispatchTable<Operon::Scalar>;
+
+// a dispatch table for a single type, compiled with the given batch size (the number of rows of a primal column)
+template<typename T, std::size_t S>
+using BatchDispatch = DispatchTable<T, Operon::Seq<std::size_t, S>>;
+
+// an immutable dispatch table shared by the convenience methods (eg. the static Interpreter::Evaluate), created on first use
+// - the initialization is thread-safe and the table is never modified, so it can be used concurrently
+template<typename DTable = DefaultDispatch>
+auto SharedDispatchTable() -> DTable const& {
+    static DTable const table;
+    return table;
+}
 } // namespace Operon
 
 #endif
@@ -332,6 +332,42 @@ namespace Operon {
             Backend::Tanh<T, S>(h + result * S, h + i * S);
         }
     };
+
+    // fused kernels for common patterns (selected by the tape compiler)
+    // - the intermediate columns (weighted variables, products) are not materialized
+    // - the variable values are only available for the first n rows of the batch
+    template<typename T, std::size_t S>
+    struct FusedWeightedSum {
+        // res = w * x if init, res += w * x otherwise
+        auto operator()(T* res, T w, Operon::Scalar const* x, std::size_t n, bool init) {
+            if (init) {
+                for (auto i = 0UL; i < n; ++i) { res[i] = x[i] * w; }
+            } else {
+                for (auto i = 0UL; i < n; ++i) { res[i] += x[i] * w; }
+            }
+        }
+    };
+
+    template<typename T, std::size_t S>
+    struct FusedWeightedExp {
+        // res = exp(w * x + b)
+        auto operator()(T* res, T w, T b, Operon::Scalar const* x, std::size_t n) {
+            if (b == T{0}) {
+                for (auto i = 0UL; i < n; ++i) { res[i] = x[i] * w; }
+            } else {
+                for (auto i = 0UL; i < n; ++i) { res[i] = x[i] * w + b; }
+            }
+            Backend::Exp<T, S>(res, res);
+        }
+    };
+
+    template<typename T, std::size_t S>
+    struct FusedMulAdd {
+        // res = a * b * w + c
+        auto operator()(T* res, T const* a, T const* b, T w, T const* c) {
+            for (auto i = 0UL; i < S; ++i) { res[i] = a[i] * b[i] * w + c[i]; }
+        }
+    };
 } // namespace Operon
 
 #endif
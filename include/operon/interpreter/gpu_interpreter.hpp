@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_INTERPRETER_GPU_HPP
+#define OPERON_INTERPRETER_GPU_HPP
+
+#if defined(HAVE_CUDA)
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "operon/core/dataset.hpp"
+#include "operon/core/range.hpp"
+#include "operon/core/tree.hpp"
+#include "operon/core/types.hpp"
+#include "operon/error_metrics/error_accumulator.hpp"
+#include "operon/interpreter/interpreter.hpp"
+#include "operon/operon_export.hpp"
+
+// tree evaluation on a cuda device (built with USE_CUDA)
+// - the dataset is uploaded once (see GpuDataset) and the trees are copied to the device in postfix order,
+//   each thread evaluates one row of a tree with a small stack in local memory
+// - the primitives have the same semantics as the default dispatch table, dynamic nodes are not supported
+// - the trees are limited to a stack depth of 64 and to nodes with at most 8 arguments
+// - errors reported by the cuda runtime are thrown as std::runtime_error
+namespace Operon {
+
+namespace detail {
+    // device memory, released when the buffer is destroyed
+    class OPERON_EXPORT DeviceBuffer {
+    public:
+        DeviceBuffer() = default;
+        explicit DeviceBuffer(std::size_t bytes) { Reserve(bytes); }
+        DeviceBuffer(DeviceBuffer const&) = delete;
+        DeviceBuffer(DeviceBuffer&& other) noexcept;
+        auto operator=(DeviceBuffer const&) -> DeviceBuffer& = delete;
+        auto operator=(DeviceBuffer&& other) noexcept -> DeviceBuffer&;
+        ~DeviceBuffer();
+
+        // grows the buffer to at least the given size, the contents are not preserved
+        auto Reserve(std::size_t bytes) -> void;
+        auto Upload(void const* src, std::size_t bytes) -> void;
+        auto Download(void* dst, std::size_t bytes) const -> void;
+
+        template<typename T>
+        [[nodiscard]] auto Data() const -> T* { return static_cast<T*>(ptr_); }
+        [[nodiscard]] auto Size() const -> std::size_t { return size_; }
+
+    private:
+        void* ptr_{nullptr};
+        std::size_t size_{0};
+    };
+} // namespace detail
+
+// a copy of the values of a dataset in device memory (column-major), with the transforms of the variables applied
+class OPERON_EXPORT GpuDataset {
+public:
+    explicit GpuDataset(Operon::Dataset const& dataset);
+
+    [[nodiscard]] auto GetDataset() const -> Operon::Dataset const& { return dataset_.get(); }
+    [[nodiscard]] auto Rows() const -> std::size_t { return rows_; }
+
+    // the index of the column of a variable, throws if the variable is not in the dataset
+    [[nodiscard]] auto Column(Operon::Hash hash) const -> std::size_t;
+
+    // device pointer to the values of a column
+    [[nodiscard]] auto Values(std::size_t column) const -> Operon::Scalar const* { return values_.Data<Operon::Scalar const>() + column * rows_; }
+
+private:
+    std::reference_wrapper<Operon::Dataset const> dataset_;
+    std::size_t rows_;
+    detail::DeviceBuffer values_;
+};
+
+// evaluates a tree on the device, with the same interface as the interpreter so that it can be used for local search
+// - the jacobian is computed in forward mode, with one thread per row and coefficient, JacRev and JacFwd are the same
+// - the device buffers are reused between calls, an instance should not be shared between threads
+class OPERON_EXPORT GpuInterpreter final : public InterpreterBase<Operon::Scalar> {
+    using T = Operon::Scalar;
+
+public:
+    GpuInterpreter(GpuDataset const& dataset, Operon::Tree const& tree);
+
+    auto Evaluate(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> result) const -> void final;
+    auto Evaluate(Operon::Span<T const> coeff, Operon::Range range) const -> std::vector<T> final;
+
+    auto JacRev(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> jacobian) const -> void final { JacRev(coeff, range, {}, jacobian); }
+    auto JacRev(Operon::Span<T const> coeff, Operon::Range range) const -> Eigen::Array<T, -1, -1> final { return JacFwd(coeff, range); }
+    auto JacRev(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> result, Operon::Span<T> jacobian) const -> void final;
+
+    auto JacFwd(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> jacobian) const -> void final { JacRev(coeff, range, {}, jacobian); }
+    auto JacFwd(Operon::Span<T const> coeff, Operon::Range range) const -> Eigen::Array<T, -1, -1> final;
+
+    [[nodiscard]] auto GetTree() const -> Operon::Tree const& final { return tree_.get(); }
+    [[nodiscard]] auto GetDataset() const -> Operon::Dataset const& final { return dataset_.get().GetDataset(); }
+
+private:
+    auto Upload(Operon::Span<T const> coeff) const -> void;
+
+    std::reference_wrapper<GpuDataset const> dataset_;
+    std::reference_wrapper<Operon::Tree const> tree_;
+    mutable detail::DeviceBuffer code_;
+    mutable detail::DeviceBuffer output_;
+    mutable detail::DeviceBuffer jacobian_;
+};
+
+// evaluates a group of trees in a single launch and returns the error statistics of each tree against the target
+// - only the statistics (see ErrorAccumulator) are copied back to the host, not the predictions
+OPERON_EXPORT auto EvaluateErrorStatistics(GpuDataset const& dataset, Operon::Span<std::reference_wrapper<Operon::Tree const> const> trees,
+    Operon::Range range, Operon::Hash target) -> std::vector<ErrorAccumulator>;
+
+} // namespace Operon
+
+#endif
+
+#endif
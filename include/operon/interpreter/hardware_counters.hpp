@@ -0,0 +1,154 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_INTERPRETER_HARDWARE_COUNTERS_HPP
+#define OPERON_INTERPRETER_HARDWARE_COUNTERS_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "operon/core/node.hpp"
+#include "operon/operon_export.hpp"
+
+// sampling of the hardware performance counters around the evaluation kernels (built with USE_HARDWARE_COUNTERS, linux only)
+// - the interpreter reads the counters around each primitive of the forward pass and around the reverse pass of JacRev,
+//   the evaluator around the error metric, the counts are aggregated per node type over all the threads
+// - the counters are read in user space (rdpmc) when the kernel allows it (see /proc/sys/kernel/perf_event_paranoid and
+//   /sys/bus/event_source/devices/cpu/rdpmc), otherwise with a system call, which inflates the counts of small kernels
+// - without USE_HARDWARE_COUNTERS the instrumentation compiles to nothing
+namespace Operon {
+
+enum class HardwareEvent : uint8_t {
+    Cycles,
+    Instructions,
+    CacheMisses,
+    BranchMisses,
+    Count // number of events
+};
+
+constexpr auto HardwareEventCount{static_cast<std::size_t>(HardwareEvent::Count)};
+using CounterValues = std::array<uint64_t, HardwareEventCount>;
+
+OPERON_EXPORT auto HardwareEventName(HardwareEvent event) -> std::string_view;
+
+// the counts of a kernel, summed over its calls
+struct KernelCounters {
+    uint64_t Calls{0};
+    uint64_t Rows{0};
+    CounterValues Values{};
+
+    [[nodiscard]] auto PerRow(HardwareEvent event) const -> double
+    {
+        return Rows == 0 ? 0.0 : static_cast<double>(Values[static_cast<std::size_t>(event)]) / static_cast<double>(Rows);
+    }
+
+    // instructions per cycle
+    [[nodiscard]] auto Ipc() const -> double
+    {
+        auto const cycles = Values[static_cast<std::size_t>(HardwareEvent::Cycles)];
+        return cycles == 0 ? 0.0 : static_cast<double>(Values[static_cast<std::size_t>(HardwareEvent::Instructions)]) / static_cast<double>(cycles);
+    }
+};
+
+// the kernels are indexed by node type (see NodeTypes::GetIndex), followed by the sections below
+struct KernelProfile {
+    static constexpr std::size_t Jacobian{NodeTypes::Count};        // reverse pass of JacRev
+    static constexpr std::size_t ErrorMetric{NodeTypes::Count + 1}; // error metric of the evaluator
+    static constexpr std::size_t Size{NodeTypes::Count + 2};
+
+    std::array<KernelCounters, Size> Kernels{};
+
+    [[nodiscard]] static auto Name(std::size_t kernel) -> std::string_view;
+};
+
+class OPERON_EXPORT KernelSampler {
+public:
+    // the counters of one thread, created the first time the thread evaluates a kernel while sampling is enabled
+    class OPERON_EXPORT Counters {
+    public:
+        Counters(); // throws std::runtime_error if the counters cannot be opened
+        Counters(Counters const&) = delete;
+        Counters(Counters&&) = delete;
+        auto operator=(Counters const&) -> Counters& = delete;
+        auto operator=(Counters&&) -> Counters& = delete;
+        ~Counters();
+
+        [[nodiscard]] auto Read() const noexcept -> CounterValues;
+        auto Add(std::size_t kernel, std::size_t rows, CounterValues const& begin) noexcept -> void;
+
+    private:
+        friend class KernelSampler;
+
+        auto Close() noexcept -> void;
+
+        struct Slot {
+            std::atomic<uint64_t> Calls{0};
+            std::atomic<uint64_t> Rows{0};
+            std::array<std::atomic<uint64_t>, HardwareEventCount> Values{};
+        };
+
+        std::array<int, HardwareEventCount> fds_{};
+        std::array<void*, HardwareEventCount> pages_{}; // mapped perf_event_mmap_page of each event
+        std::array<Slot, KernelProfile::Size> slots_{};
+    };
+
+    // true if the library was built with USE_HARDWARE_COUNTERS and the counters of the calling thread can be opened
+    static auto Supported() -> bool;
+
+    // the sampling of all the threads is enabled or disabled at once
+    static auto Enable() -> void;
+    static auto Disable() -> void;
+    [[nodiscard]] static auto Enabled() noexcept -> bool;
+
+    // the sum of the counts of all the threads, Reset sets them to zero
+    [[nodiscard]] static auto Collect() -> KernelProfile;
+    static auto Reset() -> void;
+
+    // the counters of the calling thread, or null if sampling is disabled
+#if defined(HAVE_HARDWARE_COUNTERS)
+    static auto Local() noexcept -> Counters*;
+#else
+    static constexpr auto Local() noexcept -> Counters* { return nullptr; }
+#endif
+};
+
+// samples the enclosing scope as the given kernel, does nothing without counters
+#if defined(HAVE_HARDWARE_COUNTERS)
+class KernelSample {
+public:
+    KernelSample(KernelSampler::Counters* counters, std::size_t kernel, std::size_t rows) noexcept
+        : counters_(counters)
+        , kernel_(kernel)
+        , rows_(rows)
+    {
+        if (counters_ != nullptr) { begin_ = counters_->Read(); }
+    }
+
+    KernelSample(KernelSample const&) = delete;
+    KernelSample(KernelSample&&) = delete;
+    auto operator=(KernelSample const&) -> KernelSample& = delete;
+    auto operator=(KernelSample&&) -> KernelSample& = delete;
+
+    ~KernelSample()
+    {
+        if (counters_ != nullptr) { counters_->Add(kernel_, rows_, begin_); }
+    }
+
+private:
+    KernelSampler::Counters* counters_;
+    std::size_t kernel_;
+    std::size_t rows_;
+    CounterValues begin_{};
+};
+#else
+struct KernelSample {
+    constexpr KernelSample(KernelSampler::Counters* /*counters*/, std::size_t /*kernel*/, std::size_t /*rows*/) noexcept { }
+};
+#endif
+
+} // namespace Operon
+
+#endif
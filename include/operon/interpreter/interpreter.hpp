@@ -5,14 +5,30 @@
 #define OPERON_INTERPRETER_HPP
 
 #include <algorithm>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <numeric>
 #include <optional>
 #include <span>
+#include <type_traits>
+#include <vector>
+#include <Eigen/Core>
 
 #include "operon/core/dataset.hpp"
 #include "operon/core/tree.hpp"
 #include "operon/core/types.hpp"
 #include "dispatch_table.hpp"
-// #include "tape.hpp"
+#include "hardware_counters.hpp"
+#include "second_derivatives.hpp"
+#include "subtree_cache.hpp"
+#include "tape.hpp"
+
+namespace tf { class Executor; } // NOLINT
 
 namespace Operon {
 
@@ -37,6 +53,63 @@ namespace detail {
     }
 }  // namespace detail
 
+// true if none of the values is NaN or infinite
+// - x - x is zero for the finite values and NaN otherwise, so the test reduces to a vectorized sum
+template<typename T>
+inline auto AllFinite(Operon::Span<T const> values) -> bool
+{
+    Eigen::Map<Eigen::Array<T, -1, 1> const> const x(values.data(), std::ssize(values));
+    return (x - x).sum() == T{0};
+}
+
+// grow-only scratch storage for the interpreter (primal, trace and tangent buffers, compiled tape)
+// - buffers are only reallocated when a larger tree is encountered
+// - the tape is only recompiled when a different interpreter, range or tree uses the workspace
+// - a workspace must not be shared between threads
+template<typename T, std::size_t S>
+struct InterpreterWorkspace {
+    Operon::Tape<T, S> CompiledTape; // NOLINT
+
+    // returns a zero-initialized S x n primal view
+    auto Primal(std::size_t n) -> Backend::View<T, S> {
+        auto* ptr = Reserve(primal_, primalCapacity_, S * n);
+        std::ranges::fill_n(ptr, S * n, T{0});
+        return Backend::View<T, S>(ptr, S, n);
+    }
+
+    // returns an uninitialized S x n trace view
+    auto Trace(std::size_t n) -> Backend::View<T, S> {
+        return Backend::View<T, S>(Reserve(trace_, traceCapacity_, S * n), S, n);
+    }
+
+    // returns an uninitialized S x n view for the tangents of the forward mode jacobian
+    auto Tangent(std::size_t n) -> Backend::View<T, S> {
+        return Backend::View<T, S>(Reserve(tangent_, tangentCapacity_, S * n), S, n);
+    }
+
+    // the workspace used by default by interpreters running on the calling thread
+    static auto Local() -> InterpreterWorkspace& {
+        thread_local InterpreterWorkspace workspace;
+        return workspace;
+    }
+
+private:
+    static auto Reserve(detail::AlignedUnique<T>& storage, std::size_t& capacity, std::size_t n) -> T* {
+        if (capacity < n) {
+            storage = detail::AllocateAligned<T, Backend::DefaultAlignment>(n);
+            capacity = n;
+        }
+        return storage.get();
+    }
+
+    detail::AlignedUnique<T> primal_;
+    detail::AlignedUnique<T> trace_;
+    detail::AlignedUnique<T> tangent_;
+    std::size_t primalCapacity_{0};
+    std::size_t traceCapacity_{0};
+    std::size_t tangentCapacity_{0};
+};
+
 enum class LikelihoodType : int { Gaussian, Poisson };
 
 template<typename T>
@@ -49,10 +122,75 @@ struct InterpreterBase {
     virtual auto JacRev(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> jacobian) const -> void = 0;
     virtual auto JacRev(Operon::Span<T const> coeff, Operon::Range range) const -> Eigen::Array<T, -1, -1> = 0;
 
+    // evaluate model output and jacobian (reverse mode) in the same pass over the data
+    virtual auto JacRev(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> result, Operon::Span<T> jacobian) const -> void = 0;
+
     // evaluate model jacobian in forward mode
     virtual auto JacFwd(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> jacobian) const -> void = 0;
     virtual auto JacFwd(Operon::Span<T const> coeff, Operon::Range range) const -> Eigen::Array<T, -1, -1> = 0;
 
+    // adjoint(row, values, a) receives the output of the rows starting at row (relative to range.Start()), writes
+    // the adjoint of these rows (the derivative of the loss with respect to the output) to a and returns their loss
+    using AdjointFunction = std::function<T(int64_t, Operon::Span<T const>, Operon::Span<T>)>;
+
+    // vector-jacobian product gradient = J^T a (the gradient of the loss), returns the sum of the loss values
+    // - the default implementation calls adjoint once for the whole range and materializes the output and the jacobian
+    virtual auto Vjp(Operon::Span<T const> coeff, Operon::Range range, AdjointFunction const& adjoint, Operon::Span<T> gradient) const -> T {
+        auto const nr{ static_cast<int64_t>(range.Size()) };
+        auto const nc{ std::ssize(coeff) };
+        std::vector<T> result(range.Size());
+        std::vector<T> a(range.Size());
+        Eigen::Array<T, -1, -1> jacobian(nr, nc);
+        JacRev(coeff, range, { result.data(), result.size() }, { jacobian.data(), static_cast<std::size_t>(jacobian.size()) });
+        auto const loss = adjoint(0, { result.data(), result.size() }, { a.data(), a.size() });
+        Eigen::Map<Eigen::Matrix<T, -1, 1>>(gradient.data(), nc) = jacobian.matrix().transpose() * Eigen::Map<Eigen::Matrix<T, -1, 1> const>(a.data(), nr);
+        return loss;
+    }
+
+    // vector-jacobian product gradient = J^T v for a given vector v of length range.Size()
+    auto Vjp(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T const> v, Operon::Span<T> gradient) const -> void {
+        EXPECT(v.size() == range.Size());
+        (void) Vjp(coeff, range, [&](int64_t row, Operon::Span<T const> values, Operon::Span<T> a) {
+            std::ranges::copy(v.subspan(static_cast<std::size_t>(row), values.size()), a.begin());
+            return T{0};
+        }, gradient);
+    }
+
+    // jacobian-vector product result = J u (the directional derivative of the output along u)
+    // - the default implementation materializes the jacobian
+    virtual auto Jvp(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T const> u, Operon::Span<T> result) const -> void {
+        EXPECT(u.size() == coeff.size() && result.size() == range.Size());
+        auto const jacobian = JacRev(coeff, range);
+        Eigen::Map<Eigen::Matrix<T, -1, 1>>(result.data(), std::ssize(result)) = jacobian.matrix() * Eigen::Map<Eigen::Matrix<T, -1, 1> const>(u.data(), std::ssize(u));
+    }
+
+    // hessian-vector product result = sum_r weights[r] * H_r v, where H_r is the hessian of the output of row r with
+    // respect to the coefficients (all the weights are one if weights is empty)
+    // - with the residuals as weights this is the second order term of the hessian of the least squares loss, which
+    //   the gauss-newton approximation J^T J leaves out
+    // - the default implementation uses central differences of the weighted gradient (see Vjp)
+    virtual auto Hvp(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T const> weights, Operon::Span<T const> v, Operon::Span<T> result) const -> void {
+        EXPECT(v.size() == coeff.size() && result.size() == coeff.size());
+        EXPECT(weights.empty() || weights.size() == range.Size());
+        auto norm = [](auto const& x) { return std::sqrt(std::transform_reduce(x.begin(), x.end(), T{0}, std::plus{}, [](auto a) { return a * a; })); };
+        auto const nv = norm(v);
+        if (nv == T{0}) {
+            std::ranges::fill(result, T{0});
+            return;
+        }
+        std::vector<T> w(weights.begin(), weights.end());
+        if (w.empty()) { w.assign(range.Size(), T{1}); }
+
+        auto const h = std::cbrt(std::numeric_limits<T>::epsilon()) * std::max(T{1}, norm(coeff)) / nv;
+        std::vector<T> c(coeff.size());
+        std::vector<T> g(coeff.size());
+        std::ranges::transform(coeff, v, c.begin(), [h](auto a, auto b) { return a + (h * b); });
+        Vjp(c, range, w, result);
+        std::ranges::transform(coeff, v, c.begin(), [h](auto a, auto b) { return a - (h * b); });
+        Vjp(c, range, w, g);
+        std::ranges::transform(result, g, result.begin(), [h](auto a, auto b) { return (a - b) / (2 * h); });
+    }
+
     // getters
     [[nodiscard]] virtual auto GetTree() const -> Operon::Tree const& = 0;
     [[nodiscard]] virtual auto GetDataset() const -> Operon::Dataset const& = 0;
@@ -65,22 +203,30 @@ requires DTable::template SupportsType<T>
 struct Interpreter : public InterpreterBase<T> {
     using DispatchTable = DTable;
     static constexpr auto BatchSize = DTable::template BatchSize<T>;
+    using Workspace = InterpreterWorkspace<T, BatchSize>;
 
+    // by default the interpreter borrows the workspace of the calling thread
     Interpreter(DTable const& dtable, Operon::Dataset const& dataset, Operon::Tree const& tree)
+        : Interpreter(dtable, dataset, tree, Workspace::Local()) { }
+
+    Interpreter(DTable const& dtable, Operon::Dataset const& dataset, Operon::Tree const& tree, Workspace& workspace)
         : dtable_(dtable)
         , dataset_(dataset)
-        , tree_(tree) { }
+        , tree_(tree)
+        , workspace_(workspace)
+        , id_(detail::NextTapeOwner())
+        , codes_(dataset.Codes()) { }
 
-    auto Primal() const { return primal_; }
+    auto Primal() const { return primal_; } // one column per node, unless the last pass used the compact layout
     auto Trace() const { return trace_; }
 
     inline auto Evaluate(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> result) const -> void final {
-        InitContext(coeff, range);
+        InitContext(coeff, range, /*compact=*/true);
 
         auto const len{ static_cast<int64_t>(range.Size()) };
 
         constexpr int64_t S{ BatchSize };
-        auto* ptr = primal_.data_handle() + (primal_.extent(1) - 1) * S;
+        auto const* ptr = Output();
 
         for (auto row = 0L; row < len; row += S) {
             ForwardPass(range, row, /*trace=*/false);
@@ -92,27 +238,198 @@ struct Interpreter : public InterpreterBase<T> {
         }
     }
 
+    // same as above but stops at the first batch containing a NaN or infinite value (see AllFinite)
+    // - returns false if the output is not finite, in which case the rows of result after that batch are left untouched
+    // - saves the rest of the sweep for broken trees whose error would be discarded anyway
+    inline auto EvaluateFinite(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> result) const -> bool {
+        EXPECT(result.size() == range.Size());
+        auto finite{true};
+        ForEachBatch(coeff, range, [&](int64_t row, Operon::Span<T const> values) {
+            std::ranges::copy(values, result.data() + row);
+            finite = AllFinite(values);
+            return finite;
+        });
+        return finite;
+    }
+
+    // same as above, each batch is also passed to func(row, values) once it has been copied to result
+    // - this allows a reduction of the output (eg. the error statistics) to be computed in the same pass
+    // - if func returns a bool, the evaluation stops as soon as it returns false
+    template<typename F>
+    requires std::invocable<F, int64_t, Operon::Span<T const>>
+    inline auto Evaluate(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> result, F&& func) const -> void {
+        EXPECT(result.size() == range.Size());
+        ForEachBatch(coeff, range, [&](int64_t row, Operon::Span<T const> values) {
+            std::ranges::copy(values, result.data() + row);
+            return std::invoke(func, row, values);
+        });
+    }
+
+    // incremental evaluation: the values of subtrees found in the cache are copied instead of being computed
+    // - the subtrees that were evaluated are in turn stored in the cache (if large enough)
+    // - the cache is keyed on the strict hash, therefore this is only valid when coeff is empty or equal to the tree coefficients
+    inline auto Evaluate(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> result, SubtreeValueCache<T>& cache) const -> void {
+        if (!cache.Enabled()) {
+            Evaluate(coeff, range, result);
+            return;
+        }
+        InitContext(coeff, range);
+        cache.Bind(&dataset_.get(), range);
+
+        auto const& tree = tree_.get().Hash(Operon::HashMode::Strict);
+        auto const& nodes = tree.Nodes();
+        auto const nn { std::ssize(nodes) };
+        auto const len{ static_cast<int64_t>(range.Size()) };
+        constexpr int64_t S{ BatchSize };
+
+        // walk from the root towards the leaves, at most one cached subtree per path is used
+        std::vector<std::span<T const>> seeds(nn);
+        std::vector<uint8_t> skip(nn, 0);
+        std::vector<std::pair<int64_t, std::vector<T>>> record;
+        for (auto i = nn-1; i >= 0; --i) {
+            auto const& n = nodes[i];
+            if (skip[i] || n.IsLeaf() || n.Length + 1UL < cache.MinLength()) { continue; }
+            if (auto values = cache.Find(n.CalculatedHashValue); std::ssize(values) == len) {
+                seeds[i] = values;
+                std::fill_n(skip.begin() + (i - n.Length), n.Length, uint8_t{1});
+            } else {
+                record.emplace_back(i, std::vector<T>(range.Size()));
+            }
+        }
+
+        auto* ptr = primal_.data_handle() + (primal_.extent(1) - 1) * S;
+        for (auto row = 0L; row < len; row += S) {
+            ForwardPass(range, row, /*trace=*/false, seeds, skip);
+            auto const rem = std::min(S, len - row);
+
+            if (std::ssize(result) == len) {
+                std::ranges::copy(std::span(ptr, rem), result.data() + row);
+            }
+            for (auto& [i, values] : record) {
+                std::ranges::copy(std::span(primal_.data_handle() + i * S, rem), values.data() + row);
+            }
+        }
+
+        for (auto& [i, values] : record) {
+            cache.Insert(nodes[i].CalculatedHashValue, std::move(values));
+        }
+    }
+
+    // streams the output one batch at a time to func(row, values), where row is the offset of the batch relative to range.Start()
+    // - the full output is never stored, which is useful when only a reduction of it is needed (eg. an error metric)
+    // - if func returns a bool, the evaluation stops as soon as it returns false
+    template<typename F>
+    inline auto ForEachBatch(Operon::Span<T const> coeff, Operon::Range range, F&& func) const -> void {
+        InitContext(coeff, range, /*compact=*/true);
+
+        auto const len{ static_cast<int64_t>(range.Size()) };
+        constexpr int64_t S{ BatchSize };
+        auto const* ptr = Output();
+
+        for (auto row = 0L; row < len; row += S) {
+            ForwardPass(range, row, /*trace=*/false);
+            auto const rem = static_cast<std::size_t>(std::min(S, len - row));
+            if constexpr (std::is_same_v<std::invoke_result_t<F, int64_t, Operon::Span<T const>>, bool>) {
+                if (!std::invoke(func, row, Operon::Span<T const>{ptr, rem})) { break; }
+            } else {
+                std::invoke(func, row, Operon::Span<T const>{ptr, rem});
+            }
+        }
+    }
+
+    // the two methods below split Evaluate into a setup step and a per-batch forward pass
+    // - this allows many interpreters (each with its own workspace) to advance over the same rows in lockstep
+    // - row is the offset of the batch relative to range.Start() and must be a multiple of BatchSize
+    inline auto Prepare(Operon::Span<T const> coeff, Operon::Range range) const -> void {
+        InitContext(coeff, range, /*compact=*/true);
+    }
+
+    inline auto EvaluateBatch(Operon::Range range, int64_t row, Operon::Span<T> result) const -> void {
+        constexpr int64_t S{ BatchSize };
+        auto const len{ static_cast<int64_t>(range.Size()) };
+        ForwardPass(range, static_cast<int>(row), /*trace=*/false);
+        auto const* ptr = Output();
+        std::ranges::copy(std::span(ptr, std::min(S, len - row)), result.data() + row);
+    }
+
+    // same as above but returns the output of the batch instead of copying it (valid until the next forward pass)
+    inline auto ForwardBatch(Operon::Range range, int64_t row) const -> Operon::Span<T const> {
+        constexpr int64_t S{ BatchSize };
+        auto const len{ static_cast<int64_t>(range.Size()) };
+        ForwardPass(range, static_cast<int>(row), /*trace=*/false);
+        auto const* ptr = Output();
+        return { ptr, static_cast<std::size_t>(std::min(S, len - row)) };
+    }
+
     inline auto Evaluate(Operon::Span<T const> coeff, Operon::Range range) const -> std::vector<T> final {
         std::vector<T> res(range.Size());
         Evaluate(coeff, range, {res.data(), res.size()});
         return res;
     }
 
+    // evaluates several (possibly overlapping or non-contiguous) ranges with a single setup, results[k] receives the
+    // values of ranges[k] and must have its size (eg. the training and test ranges of a report)
+    // - the tape is compiled once over the smallest range covering all of them, the rows outside the ranges are only
+    //   evaluated to complete the batches at their boundaries
+    inline auto Evaluate(Operon::Span<T const> coeff, Operon::Span<Operon::Range const> ranges, Operon::Span<Operon::Span<T> const> results) const -> void {
+        EXPECT(ranges.size() == results.size());
+        if (ranges.empty()) { return; }
+        auto const start = std::ranges::min(ranges, std::less{}, &Operon::Range::Start).Start();
+        auto const end = std::ranges::max(ranges, std::less{}, &Operon::Range::End).End();
+        Operon::Range const hull{start, end};
+        InitContext(coeff, hull, /*compact=*/true);
+
+        constexpr int64_t S{ BatchSize };
+        auto const* ptr = Output();
+
+        // the batches stay aligned to the covering range, so they can be shared with the cached subtrees and the tiles
+        for (auto k = 0UL; k < ranges.size(); ++k) {
+            EXPECT(results[k].size() == ranges[k].Size());
+            auto const first = static_cast<int64_t>(ranges[k].Start() - start);
+            auto const last = first + static_cast<int64_t>(ranges[k].Size());
+            for (auto row = first / S * S; row < last; row += S) {
+                ForwardPass(hull, static_cast<int>(row), /*trace=*/false);
+                auto const lo = std::max(row, first);
+                auto const hi = std::min(row + S, last);
+                std::copy(ptr + (lo - row), ptr + (hi - row), results[k].data() + (lo - first));
+            }
+        }
+    }
+
+    [[nodiscard]] inline auto Evaluate(Operon::Span<T const> coeff, Operon::Span<Operon::Range const> ranges) const -> std::vector<std::vector<T>> {
+        std::vector<std::vector<T>> res;
+        res.reserve(ranges.size());
+        for (auto const& r : ranges) { res.emplace_back(r.Size()); }
+        std::vector<Operon::Span<T>> results(res.begin(), res.end());
+        Evaluate(coeff, ranges, { results.data(), results.size() });
+        return res;
+    }
+
     inline auto JacRev(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> jacobian) const -> void final {
+        JacRev(coeff, range, /*result=*/{}, jacobian);
+    }
+
+    // the primal values computed by the forward pass are copied to result (when its size matches the range)
+    inline auto JacRev(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> result, Operon::Span<T> jacobian) const -> void final {
         InitContext(coeff, range);
         auto const len{ static_cast<int64_t>(range.Size()) };
         auto const& nodes = tree_.get().Nodes();
         auto const nn { std::ssize(nodes) };
 
         constexpr int64_t S{ BatchSize };
-        traceStorage_ = detail::AllocateAligned<T, Backend::DefaultAlignment>(S * nn);
-        trace_ = Backend::View<T, S>(traceStorage_.get(), S, nn);
+        trace_ = workspace_.get().Trace(static_cast<std::size_t>(nn));
         Fill<T, S>(trace_, nn-1, T{1});
 
         Eigen::Map<Eigen::Array<T, -1, -1>> jac(jacobian.data(), len, coeff.size());
 
+        auto const* ptr = primal_.data_handle() + (nn - 1) * S;
+        auto* counters = KernelSampler::Local();
         for (auto row = 0L; row < len; row += S) {
             ForwardPass(range, row, /*trace=*/true);
+            if (std::ssize(result) == len) {
+                std::ranges::copy(std::span(ptr, std::min(S, len - row)), result.data() + row);
+            }
+            KernelSample sample(counters, KernelProfile::Jacobian, static_cast<std::size_t>(std::min(S, len - row)));
             ReverseTrace(range, row, jac);
         }
     }
@@ -124,6 +441,191 @@ struct Interpreter : public InterpreterBase<T> {
         return jacobian;
     }
 
+    // streams the output and the jacobian (reverse mode) one batch at a time to func(row, values, jacobian), where row is
+    // the offset of the batch relative to range.Start() and jacobian is the (column-major) block of the rows of the batch
+    // - neither the full output nor the full jacobian are stored, which is useful for reductions (eg. a fisher matrix)
+    template<typename F>
+    inline auto ForEachJacobianBatch(Operon::Span<T const> coeff, Operon::Range range, F&& func) const -> void {
+        InitContext(coeff, range);
+        auto const len{ static_cast<int64_t>(range.Size()) };
+        auto const nn { std::ssize(tree_.get().Nodes()) };
+        auto const nc { std::ssize(coeff) };
+
+        constexpr int64_t S{ BatchSize };
+        trace_ = workspace_.get().Trace(static_cast<std::size_t>(nn));
+        Fill<T, S>(trace_, nn-1, T{1});
+
+        std::vector<T> block(static_cast<std::size_t>(S * nc));
+        auto const* ptr = primal_.data_handle() + (nn - 1) * S;
+        auto* counters = KernelSampler::Local();
+        for (auto row = 0L; row < len; row += S) {
+            ForwardPass(range, row, /*trace=*/true);
+            auto const rem = std::min(S, len - row);
+            {
+                KernelSample sample(counters, KernelProfile::Jacobian, static_cast<std::size_t>(rem));
+                Eigen::Map<Eigen::Array<T, -1, -1>> jac(block.data(), rem, nc);
+                Backpropagate(rem, nc, [&](auto k, auto const& d) { jac.col(k) = d; });
+            }
+            std::invoke(func, row, Operon::Span<T const>{ptr, static_cast<std::size_t>(rem)}, Operon::Span<T const>{block.data(), static_cast<std::size_t>(rem * nc)});
+        }
+    }
+
+    using InterpreterBase<T>::Vjp;
+
+    // the adjoint of each batch seeds the reverse pass, so neither the output nor the jacobian are stored
+    inline auto Vjp(Operon::Span<T const> coeff, Operon::Range range, typename InterpreterBase<T>::AdjointFunction const& adjoint, Operon::Span<T> gradient) const -> T final {
+        EXPECT(gradient.size() == coeff.size());
+        InitContext(coeff, range);
+        auto const len{ static_cast<int64_t>(range.Size()) };
+        auto const nn { std::ssize(tree_.get().Nodes()) };
+
+        constexpr int64_t S{ BatchSize };
+        trace_ = workspace_.get().Trace(static_cast<std::size_t>(nn));
+        std::ranges::fill(gradient, T{0});
+
+        auto const* ptr = primal_.data_handle() + (nn - 1) * S;
+        auto* seed = trace_.data_handle() + (nn - 1) * S;
+        auto* counters = KernelSampler::Local();
+        T loss{0};
+        for (auto row = 0L; row < len; row += S) {
+            ForwardPass(range, row, /*trace=*/true);
+            auto const rem = std::min(S, len - row);
+            loss += adjoint(row, { ptr, static_cast<std::size_t>(rem) }, { seed, static_cast<std::size_t>(rem) });
+            KernelSample sample(counters, KernelProfile::Jacobian, static_cast<std::size_t>(rem));
+            Backpropagate(rem, std::ssize(gradient), [&](auto k, auto const& d) { gradient[k] += d.sum(); });
+        }
+        return loss;
+    }
+
+    // forward mode with a single tangent, seeded at each coefficient with its component of u
+    inline auto Jvp(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T const> u, Operon::Span<T> result) const -> void final {
+        EXPECT(u.size() == coeff.size() && result.size() == range.Size());
+        InitContext(coeff, range);
+        auto const len{ static_cast<int64_t>(range.Size()) };
+        auto const& nodes = tree_.get().Nodes();
+        auto const nn { std::ssize(nodes) };
+
+        constexpr int64_t S{ BatchSize };
+        trace_ = workspace_.get().Trace(static_cast<std::size_t>(nn));
+        auto tangent = workspace_.get().Tangent(static_cast<std::size_t>(nn));
+
+        Eigen::Map<Eigen::Array<T, S, -1>> primal(primal_.data_handle(), S, nn);
+        Eigen::Map<Eigen::Array<T, S, -1>> trace(trace_.data_handle(), S, nn);
+        Eigen::Map<Eigen::Array<T, S, -1>> dot(tangent.data_handle(), S, nn);
+        auto const& tape = GetTape();
+
+        for (auto row = 0L; row < len; row += S) {
+            ForwardPass(range, row, /*trace=*/true);
+            auto const rem = std::min(S, len - row);
+
+            // the tangent of the inactive nodes is zero
+            for (auto i = 0L, k = 0L; i < nn; ++i) {
+                auto di = dot.col(i).head(rem);
+                di.setConstant(T{0});
+                if (!tape[i].Active) {
+                    k += static_cast<int64_t>(nodes[i].Optimize);
+                    continue;
+                }
+                auto const w = tape[i].Coefficient;
+                if (!nodes[i].IsLeaf()) {
+                    for (auto x : tape.Children(i)) {
+                        auto const j{ static_cast<int64_t>(x) };
+                        if (tape[j].Active) { di += dot.col(j).head(rem) * trace.col(j).head(rem) * w; }
+                    }
+                }
+                if (nodes[i].Optimize) { di += primal.col(i).head(rem) / w * u[k++]; }
+            }
+            Eigen::Map<Eigen::Array<T, -1, 1>>(result.data() + row, rem) = dot.col(nn - 1).head(rem);
+        }
+    }
+
+    // forward over reverse mode: the forward pass also propagates the tangents along v, the reverse pass propagates the
+    // adjoints together with their tangents, which need the second derivatives of the primitives (see PartialTangent)
+    // - the adjoint of the root is the weight of the row
+    // - only the active nodes are visited, the tangents and the adjoints of the other nodes are zero
+    inline auto Hvp(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T const> weights, Operon::Span<T const> v, Operon::Span<T> result) const -> void final {
+        EXPECT(v.size() == coeff.size() && result.size() == coeff.size());
+        EXPECT(weights.empty() || weights.size() == range.Size());
+        InitContext(coeff, range);
+        auto const len{ static_cast<int64_t>(range.Size()) };
+        auto const& nodes = tree_.get().Nodes();
+        auto const nn { std::ssize(nodes) };
+
+        constexpr int64_t S{ BatchSize };
+        trace_ = workspace_.get().Trace(static_cast<std::size_t>(nn));
+        // the tangents of the primals, followed by the tangents of the adjoints
+        auto tangent = workspace_.get().Tangent(2 * static_cast<std::size_t>(nn));
+
+        Eigen::Map<Eigen::Array<T, S, -1>> primal(primal_.data_handle(), S, nn);
+        Eigen::Map<Eigen::Array<T, S, -1>> trace(trace_.data_handle(), S, nn);
+        Eigen::Map<Eigen::Array<T, S, -1>> dot(tangent.data_handle(), S, 2 * nn);
+        auto const& tape = GetTape();
+
+        // the index of the coefficient of each node
+        std::vector<int64_t> index(nn);
+        for (auto i = 0L, k = 0L; i < nn; ++i) {
+            index[i] = k;
+            k += static_cast<int64_t>(nodes[i].Optimize);
+        }
+
+        using Column = SecondDerivativeColumn<T, S>;
+        std::ranges::fill(result, T{0});
+        for (auto row = 0L; row < len; row += S) {
+            ForwardPass(range, row, /*trace=*/true);
+            auto const rem = std::min(S, len - row);
+            auto y = [&](auto c) { return primal.col(c).head(rem); };
+            auto dy = [&](auto c) { return dot.col(c).head(rem); };
+            auto active = [&](auto c) { return tape[c].Active; };
+
+            // the tangents of the primals (see Jvp)
+            for (auto i = 0L; i < nn; ++i) {
+                auto di = dot.col(i).head(rem);
+                di.setConstant(T{0});
+                dot.col(nn + i).head(rem).setConstant(T{0});
+                if (!tape[i].Active) { continue; }
+                auto const w = tape[i].Coefficient;
+                for (auto x : tape.Children(i)) {
+                    if (tape[x].Active) { di += dy(x) * trace.col(x).head(rem) * w; }
+                }
+                if (nodes[i].Optimize) { di += y(i) / w * v[index[i]]; }
+            }
+
+            if (weights.empty()) {
+                trace.col(nn - 1).head(rem).setConstant(T{1});
+            } else {
+                trace.col(nn - 1).head(rem) = Eigen::Map<Eigen::Array<T, -1, 1> const>(weights.data() + row, rem);
+            }
+
+            // the adjoints (in place of the partials, see Backpropagate) and their tangents
+            for (auto i = nn-1; i >= 0L; --i) {
+                if (!tape[i].Active) { continue; }
+                auto const w = tape[i].Coefficient;
+                auto const dw = nodes[i].Optimize ? v[index[i]] : T{0};
+                auto const children = tape.Children(i);
+                auto a = trace.col(i).head(rem);
+                auto da = dot.col(nn + i).head(rem);
+                Column const g = y(i) / w;
+
+                if (nodes[i].Optimize) {
+                    // the tangent of the value without the coefficient
+                    Column dg = Column::Zero(rem);
+                    for (auto x : children) {
+                        if (tape[x].Active) { dg += trace.col(x).head(rem) * dy(x); }
+                    }
+                    result[index[i]] += (da * g + a * dg).sum();
+                }
+
+                for (auto x : children) {
+                    if (!tape[x].Active) { continue; }
+                    auto t = trace.col(x).head(rem);
+                    Column const dt = PartialTangent<T, S>(nodes, children, y, dy, active, g, i, x);
+                    dot.col(nn + x).head(rem) = (da * w + a * dw) * t + a * w * dt;
+                    t *= a * w;
+                }
+            }
+        }
+    }
+
     auto JacFwd(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> jacobian) const -> void final {
         InitContext(coeff, range);
         auto const len{ static_cast<int>(range.Size()) };
@@ -131,15 +633,17 @@ struct Interpreter : public InterpreterBase<T> {
         auto const nn   { std::ssize(nodes) };
 
         constexpr int64_t S{ BatchSize };
-        traceStorage_ = detail::AllocateAligned<T, Backend::DefaultAlignment>(S * nn);
-        trace_ = Backend::View<T, S>(traceStorage_.get(), S, nn);
+        trace_ = workspace_.get().Trace(static_cast<std::size_t>(nn));
         Fill<T, S>(trace_, nn-1, T{1});
 
+        // one block of coeff.size() tangents per node
+        auto tangent = workspace_.get().Tangent(static_cast<std::size_t>(nn) * coeff.size());
+
         Eigen::Map<Eigen::Array<T, -1, -1>> jac(jacobian.data(), len, coeff.size());
 
         for (int row = 0; row < len; row += S) {
             ForwardPass(range, row, /*trace=*/true);
-            ForwardTrace(range, row, jac);
+            ForwardTrace(range, row, tangent, jac);
         }
     }
 
@@ -152,42 +656,62 @@ struct Interpreter : public InterpreterBase<T> {
 
     [[nodiscard]] auto GetTree() const -> Operon::Tree const& final { return tree_.get(); }
     [[nodiscard]] auto GetDataset() const -> Operon::Dataset const& final { return dataset_.get(); }
+    [[nodiscard]] auto GetWorkspace() const -> Workspace& { return workspace_.get(); }
+
+    // reads the variables from a tiled copy of the dataset (see DatasetTiles), which must outlive the interpreter
+    // - the tiles are only used when their size equals BatchSize and the range starts at a tile boundary
+    auto SetTiles(Operon::DatasetTiles const* tiles) -> void {
+        tiles_ = tiles;
+        id_ = detail::NextTapeOwner(); // the compiled tape reads from the previous source
+    }
+
+    // decodes the encoded variables from a dictionary-encoded (or narrowed) copy of the dataset (see DatasetCodes), which
+    // must outlive the interpreter (the tiles take precedence)
+    // - by default the interpreter uses the codes kept by the dataset (see Dataset::Encode), null reads the columns
+    auto SetCodes(Operon::DatasetCodes const* codes) -> void {
+        codes_ = codes;
+        id_ = detail::NextTapeOwner();
+    }
 
     auto GetDispatchTable() const { return dtable_.get(); }
 
+    // these use the shared dispatch table (see SharedDispatchTable)
     static inline auto Evaluate(Operon::Tree const& tree, Operon::Dataset const& dataset, Operon::Range const range) {
         auto coeff = tree.GetCoefficients();
-        DTable dt;
-        return Interpreter{dt, dataset, tree}.Evaluate(coeff, range);
+        return Interpreter{SharedDispatchTable<DTable>(), dataset, tree}.Evaluate(coeff, range);
     }
 
     static inline auto Evaluate(Operon::Tree const& tree, Operon::Dataset const& dataset, Operon::Range const range, Operon::Span<T const> coeff) {
-        DTable dt;
-        return Interpreter{dt, dataset, tree}.Evaluate(coeff, range);
+        return Interpreter{SharedDispatchTable<DTable>(), dataset, tree}.Evaluate(coeff, range);
     }
 
 private:
     // private members
-    using Data = std::tuple<T,
-          std::span<Operon::Scalar const>,
-          std::optional<Dispatch::Callable<T, BatchSize> const>,
-          std::optional<Dispatch::CallableDiff<T, BatchSize> const> >;
-
     std::reference_wrapper<DTable const> dtable_;
     std::reference_wrapper<Operon::Dataset const> dataset_;
     std::reference_wrapper<Operon::Tree const> tree_;
 
-    // mutable internal state (used by all the forward/reverse passes)
-    mutable std::vector<Data> context_;
+    // scratch storage (tape, primal and trace buffers) used by all the forward/reverse passes
+    std::reference_wrapper<Workspace> workspace_;
+    std::uint64_t id_; // identifies the tapes compiled by this interpreter
+    Operon::DatasetTiles const* tiles_{nullptr};
+    Operon::DatasetCodes const* codes_{nullptr};
 
     mutable Backend::View<T, BatchSize> primal_;
     mutable Backend::View<T, BatchSize> trace_;
+    mutable bool compact_{false}; // primal_ uses the compact column layout of the tape (see Tape::Columns)
+
+    auto GetTape() const -> Operon::Tape<T, BatchSize>& { return workspace_.get().CompiledTape; }
 
-    mutable detail::AlignedUnique<T> primalStorage_;
-    mutable detail::AlignedUnique<T> traceStorage_;
+    // the primal column of node i
+    [[nodiscard]] auto Column(int64_t i) const -> int64_t { return compact_ ? GetTape()[i].Column : i; }
+
+    // the primal values of the root
+    [[nodiscard]] auto Output() const -> T* { return primal_.data_handle() + Column(std::ssize(tree_.get().Nodes()) - 1) * BatchSize; }
 
     // private methods
-    inline auto ForwardPass(Operon::Range range, int row, bool trace = false) const -> void {
+    // seeds (optional) contains precomputed values for some nodes, skip (optional) marks nodes whose evaluation is not necessary
+    inline auto ForwardPass(Operon::Range range, int row, bool trace = false, Operon::Span<std::span<T const> const> seeds = {}, Operon::Span<uint8_t const> skip = {}) const -> void {
         auto const start { static_cast<int64_t>(range.Start()) };
         auto const len   { static_cast<int64_t>(range.Size()) };
         auto const& nodes = tree_.get().Nodes();
@@ -197,20 +721,69 @@ private:
         auto rem = std::min(S, len - row);
         Operon::Range rg(start + row, start + row + rem);
 
+        auto& tape = GetTape();
+
+        // the fused kernels do not materialize the absorbed nodes, which are needed by the trace and by the seeded evaluation
+        auto const fused = !trace && seeds.empty() && skip.empty();
+        EXPECT(fused || !compact_);
+        auto* counters = KernelSampler::Local();
+
+        // the variables gathered from a dictionary are decoded once for the batch, their nodes then read them like columns
+        if (tape.Decoding()) { tape.Decode(row, rem); }
+
+        // the cached subtrees (see Tape::CacheInvariants) are copied if the batch is stored, otherwise they are stored
+        auto const cache = seeds.empty() && skip.empty() && tape.Caching();
+        auto const stored = cache && tape.Stored(row);
+
         // forward pass - compute primal and trace
         for (auto i = 0L; i < nn; ++i) {
-            auto const& [ p, v, f, df ] = context_[i];
-            auto* ptr = primal_.data_handle() + i * S;
-
-            if (nodes[i].IsVariable()) {
-                std::ranges::transform(v.subspan(row, rem), ptr, [p](auto x) { return x * p; });
-            } else if (f) {
-                std::invoke(*f, nodes, primal_, i, rg);
-
-                // first compute the partials
-                if (trace && df) {
-                    for (auto j : Tree::Indices(nodes, i)) {
-                        std::invoke(*df, nodes, primal_, trace_, i, j);
+            if (!skip.empty() && skip[i]) { continue; }
+
+            auto const& ins = tape[i];
+            if (stored && ins.Covered) { continue; }
+            if (fused && ins.Absorbed) { continue; }
+            // the folded nodes were computed by InitContext, unless their partials are needed
+            if (ins.Folded && !(trace && ins.Active)) { continue; }
+            KernelSample sample(counters, NodeTypes::GetIndex(nodes[i].Type), static_cast<std::size_t>(rem));
+
+            auto const p = ins.Coefficient;
+            auto* ptr = primal_.data_handle() + Column(i) * S;
+
+            if (!seeds.empty() && !seeds[i].empty()) {
+                std::ranges::copy(seeds[i].subspan(row, rem), ptr);
+            } else if (stored && ins.Slot >= 0) {
+                std::ranges::copy(tape.CachedValues(i).subspan(row, rem), ptr);
+            } else if (ins.Op == Operon::OpCode::Constant) {
+                // the columns of the constants are shared in the compact layout
+                if (compact_) { std::fill_n(ptr, rem, p); }
+            } else if (ins.Op == Operon::OpCode::Variable) {
+                // the transform of the variable is folded into its weight
+                auto const w = p * ins.Scale;
+                auto const b = p * ins.Offset;
+                if (!ins.Encoded.Empty()) {
+                    ins.Encoded.Decode(static_cast<std::size_t>(row), static_cast<std::size_t>(rem), ptr, w, b);
+                } else if (auto const* values = tape.Values(i, row); b == T{0}) {
+                    std::transform(values, values + rem, ptr, [w](auto x) { return x * w; });
+                } else {
+                    std::transform(values, values + rem, ptr, [w, b](auto x) { return x * w + b; });
+                }
+            } else if (fused && ins.Fused != Operon::FusedOp::None) {
+                FusedPass(i, row, rem);
+                if (p != T{1}) {
+                    std::ranges::transform(std::span(ptr, rem), ptr, [p](auto x) { return x * p; });
+                }
+            } else if (ins.Op == Operon::OpCode::Function) {
+                Call(i, rg);
+
+                // first compute the partials (only towards the children with coefficients in their subtree)
+                if (trace && ins.Active && ins.Derivative != nullptr) {
+                    for (auto j : tape.Children(i)) {
+                        if (!tape[j].Active) { continue; }
+                        if (ins.CallDiff != nullptr) {
+                            ins.CallDiff(nodes, primal_, trace_, i, j);
+                        } else {
+                            std::invoke(*ins.Derivative, nodes, primal_, trace_, i, j);
+                        }
                     }
                 }
 
@@ -219,110 +792,405 @@ private:
                     std::ranges::transform(std::span(ptr, rem), ptr, [p](auto x) { return x * p; });
                 }
             }
+
+            if (cache && !stored && ins.Slot >= 0) {
+                std::ranges::copy(std::span(ptr, rem), tape.CachedValues(i).data() + row);
+            }
+        }
+        if (cache && !stored) { tape.Store(row); }
+    }
+
+    // computes the primal of a function node (without its weight)
+    // - the built-in primitives read their arguments from the child arrays of the tape, which hold the columns of the
+    //   children in both layouts (the node indices in the full layout), instead of walking the subtree lengths
+    inline auto Call(int64_t i, Operon::Range rg) const -> void {
+        auto const& tape = GetTape();
+        auto const& ins = tape[i];
+        if (compact_) {
+            ins.CallColumns(primal_, ins.Column, tape.Arguments(i));
+        } else if (ins.CallColumns != nullptr) {
+            ins.CallColumns(primal_, static_cast<std::uint32_t>(i), tape.Children(i));
+        } else if (ins.Call != nullptr) {
+            ins.Call(tree_.get().Nodes(), primal_, i, rg);
+        } else {
+            std::invoke(*ins.Function, tree_.get().Nodes(), primal_, i, rg);
+        }
+    }
+
+    // evaluates a node using its fused kernel
+    inline auto FusedPass(int64_t i, int64_t row, int64_t rem) const -> void {
+        constexpr int64_t S{ BatchSize };
+        auto const& tape = GetTape();
+        auto const& ins = tape[i];
+        auto const children = tape.Children(i);
+        auto* h = primal_.data_handle();
+        auto* ptr = h + Column(i) * S;
+        auto const n = static_cast<std::size_t>(rem);
+
+        switch (ins.Fused) {
+        case Operon::FusedOp::WeightedSum: {
+            T b{0};
+            for (auto k = 0UL; k < children.size(); ++k) {
+                auto const& c = tape[children[k]];
+                if (!c.Encoded.Empty()) {
+                    auto const w = c.Coefficient * c.Scale;
+                    if (k == 0) { c.Encoded.Decode(static_cast<std::size_t>(row), n, ptr, w); } else { c.Encoded.Accumulate(static_cast<std::size_t>(row), n, ptr, w); }
+                } else {
+                    FusedWeightedSum<T, S>{}(ptr, c.Coefficient * c.Scale, tape.Values(children[k], row), n, k == 0);
+                }
+                b += c.Coefficient * c.Offset;
+            }
+            if (b != T{0}) { std::for_each_n(ptr, n, [b](auto& x) { x += b; }); }
+            break;
+        }
+        case Operon::FusedOp::WeightedExp: {
+            auto const& c = tape[children.front()];
+            FusedWeightedExp<T, S>{}(ptr, c.Coefficient * c.Scale, c.Coefficient * c.Offset, tape.Values(children.front(), row), n);
+            break;
+        }
+        case Operon::FusedOp::MulAdd: {
+            auto const m = children[0];
+            auto const ab = tape.Children(m);
+            FusedMulAdd<T, S>{}(ptr, h + Column(ab[0]) * S, h + Column(ab[1]) * S, tape[m].Coefficient, h + Column(children[1]) * S);
+            break;
+        }
+        default:
+            break;
         }
     }
 
-    inline auto ForwardTrace(Operon::Range range, int row, Eigen::Ref<Eigen::Array<T, -1, -1>> jac) const -> void {
+    // propagates the tangents of all the coefficients in a single walk over the tree
+    // - the tangents of node i are the columns [i * k, (i+1) * k) of the tangent view, where k is the number of coefficients
+    // - only the active nodes are visited, the tangents of the other nodes are zero
+    inline auto ForwardTrace(Operon::Range range, int row, Backend::View<T, BatchSize> tangent, Eigen::Ref<Eigen::Array<T, -1, -1>> jac) const -> void {
         auto const len   { static_cast<int64_t>(range.Size()) };
         auto const& nodes{ tree_.get().Nodes() };
         auto const nn { std::ssize(nodes) };
         constexpr int64_t S{ BatchSize };
         auto const rem   { std::min(S, len - row) };
-
-        Eigen::Array<T, S, -1> dot(S, nn);
-        std::vector<int64_t> cidx(jac.cols());
+        auto const nc    { static_cast<int64_t>(jac.cols()) };
 
         Eigen::Map<Eigen::Array<T, S, -1>> primal(primal_.data_handle(), S, nn);
         Eigen::Map<Eigen::Array<T, S, -1>> trace(trace_.data_handle(), S, nn);
-
-        for (auto i = 0L, j = 0L; i < nn; ++i) {
-            if (nodes[i].Optimize) { cidx[j++] = i; }
-        }
-
-        auto k{0};
-        for (auto c : cidx) {
-            dot.topRows(rem).setConstant(T{0});
-            dot.col(c).head(rem).setConstant(T{1});
-
-            for (auto i = 0; i < nn; ++i) {
-                if (nodes[i].IsLeaf()) { continue; }
-                for (auto x : Tree::Indices(nodes, i)) {
-                    auto j{ static_cast<int64_t>(x) };
-                    if (nodes[j].IsLeaf() && j != c) { continue; }
-                    dot.col(i).head(rem) += dot.col(j).head(rem) * trace.col(j).head(rem) * std::get<0>(context_[i]);
+        Eigen::Map<Eigen::Array<T, S, -1>> dot(tangent.data_handle(), S, nn * nc);
+
+        auto const& tape = GetTape();
+
+        for (auto i = 0L, k = 0L; i < nn; ++i) {
+            if (!tape[i].Active) { continue; }
+            auto di = dot.middleCols(i * nc, nc).topRows(rem);
+            di.setConstant(T{0});
+
+            if (!nodes[i].IsLeaf()) {
+                auto const w = tape[i].Coefficient;
+                for (auto x : tape.Children(i)) {
+                    auto const j{ static_cast<int64_t>(x) };
+                    if (!tape[j].Active) { continue; }
+                    Eigen::Array<T, -1, 1, Eigen::ColMajor, S, 1> const t = trace.col(j).head(rem) * w;
+                    di += dot.middleCols(j * nc, nc).topRows(rem).colwise() * t;
                 }
             }
 
-            jac.col(k++).segment(row, rem) = dot.col(nn-1).head(rem) * primal.col(c).head(rem) / std::get<0>(context_[c]);
+            // the seed (the subtree of a coefficient does not depend on it)
+            if (nodes[i].Optimize) { di.col(k++).setConstant(T{1}); }
+        }
+
+        for (auto i = 0L, k = 0L; i < nn; ++i) {
+            if (!nodes[i].Optimize) { continue; }
+            jac.col(k).segment(row, rem) = dot.col((nn-1) * nc + k).head(rem) * primal.col(i).head(rem) / tape[i].Coefficient;
+            ++k;
         }
     }
 
     auto ReverseTrace(Operon::Range range, int row, Eigen::Ref<Eigen::Array<T, -1, -1>> jac) const -> void {
-        auto const len   { static_cast<int64_t>(range.Size()) };
+        auto const len { static_cast<int64_t>(range.Size()) };
+        auto const rem { std::min(int64_t{BatchSize}, len - row) };
+        Backpropagate(rem, jac.cols(), [&](auto k, auto const& d) { jac.col(k).segment(row, rem) = d; });
+    }
+
+    // propagates the root trace column (the seed) towards the leaves and calls sink(k, d) with the derivative d of
+    // the seeded output with respect to coefficient k (for the first rem rows of the batch)
+    template<typename F>
+    auto Backpropagate(int64_t rem, int64_t nc, F&& sink) const -> void {
         auto const& nodes{ tree_.get().Nodes() };
         auto const nn    { std::ssize(nodes) };
         constexpr int64_t S{ BatchSize };
-        auto const rem   { std::min(S, len - row) };
 
-        auto k{jac.cols()};
+        auto k{nc};
         Eigen::Map<Eigen::Array<T, S, -1>> primal(primal_.data_handle(), S, nn);
         Eigen::Map<Eigen::Array<T, S, -1>> trace(trace_.data_handle(), S, nn);
+        auto const& tape = GetTape();
 
+        // only the active nodes (on a path from a coefficient to the root) are visited
+        // - the trace columns of the other nodes are never written by the forward pass nor read here
         for (auto i = nn-1; i >= 0L; --i) {
-            auto w = std::get<0>(context_[i]);
+            if (!tape[i].Active) { continue; }
+            auto w = tape[i].Coefficient;
 
             if (nodes[i].Optimize) {
-                jac.col(--k).segment(row, rem) = trace.col(i).head(rem) * primal.col(i).head(rem) / w;
+                sink(--k, trace.col(i).head(rem) * primal.col(i).head(rem) / w);
             }
 
             if (nodes[i].IsLeaf()) { continue; }
 
-            for (auto j : Tree::Indices(nodes, i)) {
+            for (auto j : tape.Children(i)) {
                 auto const x { static_cast<int64_t>(j) };
+                if (!tape[x].Active) { continue; }
                 trace.col(x).head(rem) *= trace.col(i).head(rem) * w;
             }
         }
     }
 
-    // init tree info into context_ and initializes primal_ columns
-    auto InitContext(Operon::Span<T const> coeff, Operon::Range range) const {
+    // compiles the tree into the workspace tape (unless already compiled by this interpreter) and initializes primal_ columns
+    // - repeated calls for the same tree and range (eg. during local search) only refresh the coefficients and reuse the
+    //   values of the subtrees without coefficients
+    // - compact selects the compact column layout of the tape when the tree supports it, which is only valid for the
+    //   fused forward pass (no trace, no seeds): a stack of columns instead of one column per node keeps the working
+    //   set of a batch in the L1 cache for large trees
+    auto InitContext(Operon::Span<T const> coeff, Operon::Range range, bool compact = false) const {
         auto const& nodes{ tree_.get().Nodes() };
-        auto const nr { static_cast<int64_t>(range.Size()) };
         auto const nn { std::ssize(nodes) };
 
         constexpr int64_t S{ BatchSize };
-        primalStorage_ = detail::AllocateAligned<T, Backend::DefaultAlignment>(S * nn);
-        std::ranges::fill_n(primalStorage_.get(), S * nn, T{0});
-        primal_ = Backend::View<T, BatchSize>(primalStorage_.get(), S, nn);
+        auto& tape = GetTape();
+        auto const reused = tape.IsCompiled(id_, range, nodes);
+        if (!reused) {
+            tape.Compile(dtable_.get(), dataset_.get(), nodes, range, id_, tiles_, codes_);
+        }
+        tape.SetCoefficients(nodes, coeff);
+        // the subtrees without coefficients are cached from the second call on, so a single evaluation does not pay for the copies
+        if (reused) { tape.CacheInvariants(nodes); }
 
-        context_.clear();
-        context_.reserve(nn);
+        compact_ = compact && tape.Columns() > 0;
+        primal_ = workspace_.get().Primal(compact_ ? tape.Columns() : static_cast<std::size_t>(nn));
 
-        auto const& dt = dtable_.get();
-        // aggregate necessary info about the tree into a context object
-        for (int64_t i = 0, j = 0; i < nn; ++i) {
-            auto const& n = nodes[i];
-            auto const* ptr      = n.IsVariable() ? dataset_.get().GetValues(n.HashValue).subspan(range.Start(), range.Size()).data() : nullptr;
-            auto variableValues  = std::tuple_element_t<1, Data>(ptr, nr);
-            auto nodeCoefficient = (!coeff.empty() && n.Optimize) ? T{coeff[j++]} : T{n.Value};
-            auto nodeFunction    = dt.template TryGetFunction<T>(n.HashValue);
-            auto nodeDerivative  = dt.template TryGetDerivative<T>(n.HashValue);
-
-            if (!n.IsLeaf() && !nodeFunction) {
-                throw std::runtime_error(fmt::format("Missing primitive for node {}\n", n.Name()));
+        // the folded nodes hold the same value in every row, so they are computed once over a single batch
+        auto const rg = Operon::Range{range.Start(), range.Start() + std::min(static_cast<std::size_t>(S), range.Size())};
+        for (auto i = 0L; i < nn; ++i) {
+            auto const& ins = tape[i];
+            if (ins.Op == Operon::OpCode::Constant) {
+                Fill<T, S>(primal_, static_cast<int>(Column(i)), ins.Coefficient);
+            } else if (ins.Folded) {
+                Call(i, rg);
+                if (ins.Coefficient != T{1}) {
+                    auto* ptr = primal_.data_handle() + Column(i) * S;
+                    std::transform(ptr, ptr + S, ptr, [p = ins.Coefficient](auto x) { return x * p; });
+                }
             }
+        }
+    }
+};
 
-            context_.push_back({ nodeCoefficient, variableValues, nodeFunction, nodeDerivative });
+// evaluates a group of trees by tiling the rows into BatchSize blocks
+// - for each block, all the trees are evaluated before moving on to the next block, so that the
+//   variable columns stay in cache
+// - the result has length trees.size() * range.Size() (the output of each tree is stored contiguously)
+// - each tree is evaluated using its own coefficients
+template<typename T = Operon::Scalar, typename DTable = DefaultDispatch>
+auto EvaluateTiled(DTable const& dtable, Operon::Dataset const& dataset, Operon::Span<std::reference_wrapper<Operon::Tree const> const> trees, Operon::Range range, Operon::Span<T> result) -> void
+{
+    using TInterpreter = Interpreter<T, DTable>;
+    using Workspace = typename TInterpreter::Workspace;
+    constexpr int64_t S{ TInterpreter::BatchSize };
+
+    auto const n { trees.size() };
+    auto const len { static_cast<int64_t>(range.Size()) };
+    EXPECT(result.size() >= n * range.Size());
+
+    // each interpreter needs its own workspace since their states are interleaved
+    thread_local std::vector<Workspace> workspaces;
+    if (workspaces.size() < n) { workspaces.resize(n); }
+
+    std::vector<TInterpreter> interpreters;
+    interpreters.reserve(n);
+    for (auto i = 0UL; i < n; ++i) {
+        interpreters.emplace_back(dtable, dataset, trees[i].get(), workspaces[i]);
+        interpreters.back().Prepare({}, range);
+    }
+
+    for (auto row = 0L; row < len; row += S) {
+        for (auto i = 0UL; i < n; ++i) {
+            interpreters[i].EvaluateBatch(range, row, result.subspan(i * range.Size(), range.Size()));
+        }
+    }
+}
+
+// evaluates a group of trees, packing the small trees of identical shape into the rows of a batch
+// - the trees have the same shape if they have the same nodes up to their values (ie. the same relaxed hash)
+// - when the range is shorter than a batch most rows of each kernel call are wasted, so several trees of the same
+//   shape are evaluated together: each tree uses its own group of rows of the batch (a lane) with its own
+//   coefficients and the kernel of each node is called once for all the lanes
+// - the trees with maxLength nodes or more, the trees with dynamic nodes and the ranges longer than half a batch
+//   are evaluated one tree at a time
+// - the result has length trees.size() * range.Size(), as for EvaluateTiled, and is the same as the result of
+//   evaluating each tree on its own up to rounding (the packed trees do not use the fused kernels)
+template<typename T = Operon::Scalar, typename DTable = DefaultDispatch>
+auto EvaluateByShape(DTable const& dtable, Operon::Dataset const& dataset, Operon::Span<std::reference_wrapper<Operon::Tree const> const> trees, Operon::Range range, Operon::Span<T> result, std::size_t maxLength = 8) -> void // NOLINT
+{
+    using TInterpreter = Interpreter<T, DTable>;
+    constexpr auto S{ static_cast<std::size_t>(TInterpreter::BatchSize) };
+    auto const sz { range.Size() };
+    EXPECT(result.size() >= trees.size() * sz);
+
+    auto const lanes = sz == 0 ? 1UL : S / sz;
+    auto packable = [&](Operon::Tree const& tree) {
+        return lanes > 1 && tree.Length() < maxLength && std::ranges::none_of(tree.Nodes(), [](auto const& n) { return n.Type == NodeType::Dynamic; });
+    };
+    auto same = [](Operon::Node const& x, Operon::Node const& y) { return x.HashValue == y.HashValue && x.Arity == y.Arity && x.Lag == y.Lag; };
+    // a cheap multiplicative mix is enough, the trees of a group are compared node by node
+    auto shape = [](Operon::Tree const& tree) {
+        Operon::Hash h{tree.Length()};
+        for (auto const& n : tree.Nodes()) {
+            h = (std::rotl(h, 5) ^ n.HashValue ^ (static_cast<Operon::Hash>(n.Arity) << 48U) ^ (static_cast<Operon::Hash>(n.Lag) << 40U)) * 0x9E3779B97F4A7C15UL; // NOLINT
+        }
+        return h;
+    };
+
+    // the packable trees sorted by shape, so that the trees of a shape are adjacent
+    std::vector<std::pair<Operon::Hash, std::size_t>> small;
+    for (auto i = 0UL; i < trees.size(); ++i) {
+        auto const& tree = trees[i].get();
+        if (packable(tree)) {
+            small.emplace_back(shape(tree), i);
+        } else {
+            TInterpreter{dtable, dataset, tree}.Evaluate({}, range, result.subspan(i * sz, sz));
+        }
+    }
+    std::ranges::sort(small);
+
+    std::vector<typename DTable::template Callable<T> const*> functions;
+    std::vector<std::size_t> group;
+    auto const rg = Operon::Range{ range.Start(), range.Start() + sz };
+
+    for (auto k = 0UL; k < small.size();) {
+        auto const& first = trees[small[k].second].get();
+        auto const& nodes = first.Nodes();
+        auto const nn = nodes.size();
+
+        // the trees of the group (a hash collision ends the group, the next tree starts another one)
+        group.clear();
+        for (auto const h = small[k].first; k < small.size() && small[k].first == h; ++k) {
+            auto const& tree = trees[small[k].second].get();
+            if (tree.Length() != nn || !std::ranges::equal(tree.Nodes(), nodes, same)) { break; }
+            group.push_back(small[k].second);
+        }
+
+        functions.assign(nn, nullptr);
+        for (auto i = 0UL; i < nn; ++i) {
+            if (nodes[i].IsLeaf()) { continue; }
+            functions[i] = dtable.template TryGetFunctionPtr<T>(nodes[i]);
+            if (functions[i] == nullptr) { throw std::runtime_error(fmt::format("Missing primitive for node {}\n", nodes[i].Name())); }
+        }
 
-            if (n.IsConstant()) {
-                Fill<T, S>(primal_, i, T{nodeCoefficient});
+        auto primal = TInterpreter::Workspace::Local().Primal(nn);
+        for (auto g = 0UL; g < group.size(); g += lanes) {
+            auto const n = std::min(lanes, group.size() - g);
+            for (auto i = 0UL; i < nn; ++i) {
+                auto* col = primal.data_handle() + i * S;
+                if (nodes[i].IsConstant()) {
+                    for (auto l = 0UL; l < n; ++l) { std::fill_n(col + l * sz, sz, static_cast<T>(trees[group[g + l]].get()[i].Value)); }
+                    continue;
+                }
+                if (nodes[i].IsVariable()) {
+                    auto const values = dataset.GetValues(nodes[i].HashValue, rg, nodes[i].Lag);
+                    auto const [scale, offset] = dataset.GetTransform(nodes[i].HashValue);
+                    for (auto l = 0UL; l < n; ++l) {
+                        auto const p = static_cast<T>(trees[group[g + l]].get()[i].Value);
+                        std::ranges::transform(values, col + l * sz, [w = p * scale, b = p * offset](auto x) { return x * w + b; });
+                    }
+                    continue;
+                }
+                std::invoke(*functions[i], nodes, primal, i, rg);
+                for (auto l = 0UL; l < n; ++l) {
+                    auto const p = static_cast<T>(trees[group[g + l]].get()[i].Value);
+                    if (p != T{1}) { std::transform(col + l * sz, col + (l + 1) * sz, col + l * sz, [p](auto x) { return x * p; }); }
+                }
             }
+            auto const* out = primal.data_handle() + (nn - 1) * S;
+            for (auto l = 0UL; l < n; ++l) { std::copy_n(out + l * sz, sz, result.data() + group[g + l] * sz); }
         }
     }
-};
+}
+
+// streams a group of trees over the rows in blocks of blockRows rows (rounded up to a multiple of BatchSize)
+// - all the trees are evaluated on a block before moving on to the next one, func(i, row, values) receives the
+//   output of tree i for the batch starting at row (relative to range.Start())
+// - the dataset is asked to prefetch the next block and to evict the finished one (see Dataset::Prefetch), so that
+//   a memory-mapped dataset larger than the memory is read from disk once per call
+template<typename T = Operon::Scalar, typename DTable = DefaultDispatch, typename F>
+auto StreamTiled(DTable const& dtable, Operon::Dataset const& dataset, Operon::Span<std::reference_wrapper<Operon::Tree const> const> trees, Operon::Range range, std::size_t blockRows, F&& func) -> void
+{
+    using TInterpreter = Interpreter<T, DTable>;
+    using Workspace = typename TInterpreter::Workspace;
+    constexpr int64_t S{ TInterpreter::BatchSize };
+
+    auto const n { trees.size() };
+    auto const len { static_cast<int64_t>(range.Size()) };
+    auto const block { std::max((static_cast<int64_t>(blockRows) + S - 1) / S * S, S) };
+
+    thread_local std::vector<Workspace> workspaces;
+    if (workspaces.size() < n) { workspaces.resize(n); }
+
+    std::vector<TInterpreter> interpreters;
+    interpreters.reserve(n);
+    for (auto i = 0UL; i < n; ++i) {
+        interpreters.emplace_back(dtable, dataset, trees[i].get(), workspaces[i]);
+        interpreters.back().Prepare({}, range);
+    }
+
+    auto rows = [&](int64_t a, int64_t b) { return Operon::Range{ range.Start() + static_cast<std::size_t>(a), range.Start() + static_cast<std::size_t>(b) }; };
+    dataset.Prefetch(rows(0, std::min(block, len)));
+    for (auto start = 0L; start < len; start += block) {
+        auto const stop { std::min(start + block, len) };
+        if (stop < len) { dataset.Prefetch(rows(stop, std::min(stop + block, len))); }
+        for (auto i = 0UL; i < n; ++i) {
+            for (auto row = start; row < stop; row += S) {
+                std::invoke(func, i, row, interpreters[i].ForwardBatch(range, row));
+            }
+        }
+        dataset.Evict(rows(start, stop));
+    }
+}
 
-// convenience method to interpret many trees in parallel (mostly useful from the python wrapper)
+// convenience method to interpret many trees in parallel (mostly useful from the python wrapper), using the shared dispatch table
 auto OPERON_EXPORT EvaluateTrees(std::vector<Operon::Tree> const& trees, Operon::Dataset const& dataset, Operon::Range range, size_t nthread = 0) -> std::vector<std::vector<Operon::Scalar>>;
 auto OPERON_EXPORT EvaluateTrees(std::vector<Operon::Tree> const& trees, Operon::Dataset const& dataset, Operon::Range range, std::span<Operon::Scalar> result, size_t nthread = 0) -> void;
+
+// same as above but using an existing executor and dispatch table (avoids spawning a thread pool on each call)
+auto OPERON_EXPORT EvaluateTrees(tf::Executor& executor, DefaultDispatch const& dtable, std::vector<Operon::Tree> const& trees, Operon::Dataset const& dataset, Operon::Range range) -> std::vector<std::vector<Operon::Scalar>>;
+auto OPERON_EXPORT EvaluateTrees(tf::Executor& executor, DefaultDispatch const& dtable, std::vector<Operon::Tree> const& trees, Operon::Dataset const& dataset, Operon::Range range, std::span<Operon::Scalar> result) -> void;
+
+// row-parallel evaluation of a single tree (useful for very large ranges and small populations)
+// - the range is split into chunks of rowChunk rows which are processed by the workers of the executor
+// - it can be called from inside a worker of the same executor (eg. from the GP loop), in which case the
+//   calling worker participates in the evaluation instead of blocking (work stealing)
+static constexpr std::size_t DefaultRowChunk{ 1UL << 16U };
+
+auto OPERON_EXPORT ForEachRowChunk(tf::Executor& executor, Operon::Range range, std::size_t rowChunk, std::function<void(Operon::Range)> const& func) -> void;
+auto OPERON_EXPORT EvaluateRows(tf::Executor& executor, DefaultDispatch const& dtable, Operon::Tree const& tree, Operon::Dataset const& dataset, Operon::Span<Operon::Scalar const> coeff, Operon::Range range, Operon::Span<Operon::Scalar> result, std::size_t rowChunk = DefaultRowChunk) -> void;
+auto OPERON_EXPORT JacRevRows(tf::Executor& executor, DefaultDispatch const& dtable, Operon::Tree const& tree, Operon::Dataset const& dataset, Operon::Span<Operon::Scalar const> coeff, Operon::Range range, Operon::Span<Operon::Scalar> jacobian, std::size_t rowChunk = DefaultRowChunk) -> void;
+
+// keeps a thread pool and a dispatch table alive between scoring calls
+// - the interpreter workspaces are thread-local, so the buffers of each worker are reused as well
+class OPERON_EXPORT ScoringSession {
+public:
+    explicit ScoringSession(std::size_t nthread = 0);
+    ScoringSession(ScoringSession const&) = delete;
+    ScoringSession(ScoringSession&&) noexcept;
+    auto operator=(ScoringSession const&) -> ScoringSession& = delete;
+    auto operator=(ScoringSession&&) noexcept -> ScoringSession&;
+    ~ScoringSession();
+
+    auto Evaluate(std::vector<Operon::Tree> const& trees, Operon::Dataset const& dataset, Operon::Range range) const -> std::vector<std::vector<Operon::Scalar>>;
+    auto Evaluate(std::vector<Operon::Tree> const& trees, Operon::Dataset const& dataset, Operon::Range range, std::span<Operon::Scalar> result) const -> void;
+
+    [[nodiscard]] auto GetExecutor() const -> tf::Executor& { return *executor_; }
+    [[nodiscard]] auto GetDispatchTable() const -> DefaultDispatch const& { return dtable_; }
+    [[nodiscard]] auto GetDispatchTable() -> DefaultDispatch& { return dtable_; }
+
+private:
+    std::unique_ptr<tf::Executor> executor_;
+    DefaultDispatch dtable_;
+};
 } // namespace Operon
 #endif
@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_INTERPRETER_INTERVAL_HPP
+#define OPERON_INTERPRETER_INTERVAL_HPP
+
+#include <cmath>
+
+#include "operon/core/dataset.hpp"
+#include "operon/core/range.hpp"
+#include "operon/core/tree.hpp"
+#include "operon/core/types.hpp"
+#include "operon/operon_export.hpp"
+
+namespace Operon {
+
+// a closed interval of values, the bounds are not finite if the values can be infinite or undefined
+struct Interval {
+    Operon::Scalar Lower;
+    Operon::Scalar Upper;
+
+    [[nodiscard]] auto Finite() const -> bool { return std::isfinite(Lower) && std::isfinite(Upper); }
+    [[nodiscard]] auto Contains(Operon::Scalar value) const -> bool { return Lower <= value && value <= Upper; }
+};
+
+using VariableBounds = Operon::Map<Operon::Hash, Interval>;
+
+// the smallest and largest values of each variable over the range (the missing values are ignored)
+// - the bounds also cover the maxLag rows before the range, which are read by the lagged variables (see Node::Lag)
+OPERON_EXPORT auto ComputeVariableBounds(Operon::Dataset const& dataset, Operon::Range range, std::size_t maxLag = 0) -> VariableBounds;
+
+// evaluates the tree over intervals: the result contains the outputs of the tree for all the inputs within the bounds
+// - takes a single pass over the nodes, the coefficients of the tree are used as they are
+// - the evaluation stops at the first node whose interval is not finite (eg. a division by an interval containing
+//   zero or the logarithm of an interval containing negative values), the returned interval is then not finite
+// - the intervals are conservative: a tree can be flagged although none of the rows produce a non-finite value
+//   (the inputs are bounded independently and the subtrees are assumed to be independent)
+// - the bounds are not rounded outwards, a tree whose interval touches the boundary of a domain (eg. sqrt over [0, 1])
+//   is accepted although the rounding errors of the interpreter can still make it non-finite
+// - throws for the dynamic nodes and for the variables without bounds
+OPERON_EXPORT auto EvaluateInterval(Operon::Tree const& tree, VariableBounds const& bounds) -> Interval;
+
+} // namespace Operon
+
+#endif
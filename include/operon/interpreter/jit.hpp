@@ -0,0 +1,60 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_INTERPRETER_JIT_HPP
+#define OPERON_INTERPRETER_JIT_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "operon/core/dataset.hpp"
+#include "operon/core/range.hpp"
+#include "operon/core/tree.hpp"
+#include "operon/core/types.hpp"
+#include "operon/operon_export.hpp"
+
+namespace Operon {
+
+struct JitOptions {
+    // the compiler and the flags used to build the model, empty values are replaced by the defaults:
+    // - the OPERON_JIT_CXX and OPERON_JIT_FLAGS environment variables, if set
+    // - otherwise the compiler of the library build and -O3 -march=native -fno-math-errno
+    std::string Compiler;
+    std::string Flags;
+};
+
+// a tree compiled to native code, for scoring large datasets with a fixed model
+// - the C++ code of the tree (see CppFormatter) is compiled with the system compiler into a shared module that is
+//   loaded into the process, the module is unloaded when the model is destroyed
+// - the coefficients are baked into the code: a model must be compiled again after its coefficients change
+// - compilation takes a fraction of a second, which pays off when the same model is evaluated over many rows
+// - the transformed variables of a dataset (see Dataset::SetTransform) are copied and transformed by each evaluation
+// - throws std::runtime_error if the tree contains dynamic nodes, if the compilation fails or if the platform does
+//   not support loading modules at runtime
+class OPERON_EXPORT JitModel {
+public:
+    using Function = void (*)(Operon::Scalar const* const* x, Operon::Scalar* out, std::size_t n);
+
+    explicit JitModel(Operon::Tree const& tree, JitOptions const& options = {});
+
+    // same semantics as Interpreter::Evaluate: the model output for the rows in range
+    auto Evaluate(Operon::Dataset const& dataset, Operon::Range range, Operon::Span<Operon::Scalar> result) const -> void;
+    [[nodiscard]] auto Evaluate(Operon::Dataset const& dataset, Operon::Range range) const -> std::vector<Operon::Scalar>;
+
+    // the variables read by the model, in the order in which the compiled function expects their columns
+    [[nodiscard]] auto Inputs() const -> Operon::Vector<Operon::Hash> const& { return inputs_; }
+    [[nodiscard]] auto GetFunction() const -> Function { return function_; }
+
+private:
+    struct ModuleDeleter { auto operator()(void* handle) const -> void; };
+
+    Operon::Vector<Operon::Hash> inputs_;
+    std::size_t lag_{0}; // the largest variable lag, the range must start at or after this row
+    std::unique_ptr<void, ModuleDeleter> module_;
+    Function function_{nullptr};
+};
+
+} // namespace Operon
+
+#endif
@@ -0,0 +1,171 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_INTERPRETER_SECOND_DERIVATIVES_HPP
+#define OPERON_INTERPRETER_SECOND_DERIVATIVES_HPP
+
+#include <concepts>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <Eigen/Core>
+#include <fmt/core.h>
+
+#include "operon/core/node.hpp"
+#include "operon/core/types.hpp"
+
+namespace Operon {
+
+// the second derivatives of the primitives, used by the hessian-vector products of the interpreter (see Interpreter::Hvp)
+// - PartialTangent returns the directional derivative of the partial of node i towards its child j, along the tangents
+//   of the children: sum_l d2g / (dy_j dy_l) * dy_l, where g is the value of node i without its coefficient and y are
+//   the values of the children
+// - y(c) and dy(c) return the values and the tangents of node c for the rows of the batch, active(c) is false if the
+//   tangent of c is zero (the tangents of the inactive children are not read)
+// - the first argument of node i is its child i-1 (see the first derivatives of the backends)
+// - the piecewise linear primitives (add, sub, min, max, abs, ceil, floor) have no second derivative
+// - the primitives registered by the user have no second derivative and throw
+template<typename T, std::size_t S>
+using SecondDerivativeColumn = Eigen::Array<T, -1, 1, Eigen::ColMajor, static_cast<int>(S), 1>;
+
+template<typename T, std::size_t S, typename Y, typename D, typename A>
+auto PartialTangent(Operon::Vector<Operon::Node> const& nodes, std::span<std::uint32_t const> children, Y&& y, D&& dy, A&& active, SecondDerivativeColumn<T, S> const& g, std::integral auto i, std::integral auto j) -> SecondDerivativeColumn<T, S> // NOLINT(readability-function-cognitive-complexity)
+{
+    using Column = SecondDerivativeColumn<T, S>;
+    auto const& n = nodes[i];
+    auto const rem = g.size();
+    auto const first = static_cast<std::uint32_t>(i - 1);
+    auto const x = static_cast<std::uint32_t>(j);
+    Column r = Column::Zero(rem);
+
+    switch (n.Type) {
+    case NodeType::Add:
+    case NodeType::Sub:
+    case NodeType::Fmin:
+    case NodeType::Fmax:
+    case NodeType::Abs:
+    case NodeType::Ceil:
+    case NodeType::Floor: {
+        break;
+    }
+    case NodeType::Mul: {
+        // the product of the other arguments, differentiated along each of them
+        for (auto l : children) {
+            if (l == x || !active(l)) { continue; }
+            Column p = dy(l);
+            for (auto m : children) {
+                if (m != x && m != l) { p *= y(m); }
+            }
+            r += p;
+        }
+        break;
+    }
+    case NodeType::Div: {
+        if (n.Arity == 1) {
+            r = T{2} * dy(x) / y(x).cube();
+            break;
+        }
+        // g = a / (y_2 * ... * y_n), q = sum_l dy_l / y_l over the denominators
+        Column q = Column::Zero(rem);
+        for (auto l : children) {
+            if (l != first && active(l)) { q += dy(l) / y(l); }
+        }
+        if (x == first) {
+            r = -g / y(first) * q;
+        } else {
+            Column dg = -g * q;
+            if (active(first)) { dg += dy(first) * g / y(first); }
+            r = (g * dy(x) / y(x) - dg) / y(x);
+        }
+        break;
+    }
+    case NodeType::Aq: {
+        auto const b = children[1];
+        Column const s = T{1} + y(b).square();
+        Column const q = s.rsqrt();
+        Column const ab = -q * y(b) / s;
+        if (x == first) {
+            if (active(b)) { r = ab * dy(b); }
+        } else {
+            if (active(first)) { r = ab * dy(first); }
+            r += y(first) * q * (T{2} * y(b).square() - T{1}) / s.square() * dy(b);
+        }
+        break;
+    }
+    case NodeType::Pow: {
+        auto const b = children[1];
+        Column const la = y(first).log();
+        Column const ga = g / y(first);
+        Column const ab = ga * (T{1} + y(b) * la);
+        if (x == first) {
+            r = y(b) * (y(b) - T{1}) * ga / y(first) * dy(first);
+            if (active(b)) { r += ab * dy(b); }
+        } else {
+            r = g * la.square() * dy(b);
+            if (active(first)) { r += ab * dy(first); }
+        }
+        break;
+    }
+    case NodeType::Acos: {
+        r = -y(x) * (T{1} - y(x).square()).pow(T{-1.5}) * dy(x); // NOLINT
+        break;
+    }
+    case NodeType::Asin: {
+        r = y(x) * (T{1} - y(x).square()).pow(T{-1.5}) * dy(x); // NOLINT
+        break;
+    }
+    case NodeType::Atan: {
+        r = T{-2} * y(x) / (T{1} + y(x).square()).square() * dy(x);
+        break;
+    }
+    case NodeType::Cbrt: {
+        r = T{-2} / (T{9} * y(x) * g.square()) * dy(x); // NOLINT
+        break;
+    }
+    case NodeType::Cos:
+    case NodeType::Sin: {
+        r = -g * dy(x);
+        break;
+    }
+    case NodeType::Cosh:
+    case NodeType::Sinh:
+    case NodeType::Exp: {
+        r = g * dy(x);
+        break;
+    }
+    case NodeType::Log:
+    case NodeType::Logabs: {
+        r = -dy(x) / y(x).square();
+        break;
+    }
+    case NodeType::Log1p: {
+        r = -dy(x) / (T{1} + y(x)).square();
+        break;
+    }
+    case NodeType::Sqrt:
+    case NodeType::Sqrtabs: {
+        r = -dy(x) / (T{4} * g.cube());
+        break;
+    }
+    case NodeType::Tan: {
+        r = T{2} * g * (T{1} + g.square()) * dy(x);
+        break;
+    }
+    case NodeType::Tanh: {
+        r = T{-2} * g * (T{1} - g.square()) * dy(x);
+        break;
+    }
+    case NodeType::Square: {
+        r = T{2} * dy(x);
+        break;
+    }
+    default: {
+        throw std::runtime_error(fmt::format("missing second derivative for node {}\n", n.Name()));
+    }
+    }
+    return r;
+}
+
+} // namespace Operon
+
+#endif
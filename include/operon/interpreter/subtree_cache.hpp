@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_SUBTREE_CACHE_HPP
+#define OPERON_SUBTREE_CACHE_HPP
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "operon/core/range.hpp"
+#include "operon/core/types.hpp"
+
+namespace Operon {
+
+// stores the output values of subtrees (identified by their strict hash value) over a fixed data range
+// - used by the interpreter to skip the evaluation of subtrees that were already evaluated as part of another tree
+//   (eg. the subtrees of a parent that are unchanged in a crossover or mutation child)
+// - only subtrees of at least MinLength() nodes are stored, the total number of cached values is bounded by Capacity()
+// - when the capacity is exceeded, the cache is flushed
+// - not thread-safe, meant to be used as a per-thread cache
+template<typename T = Operon::Scalar>
+class SubtreeValueCache {
+public:
+    static constexpr std::size_t DefaultMinLength{5};
+
+    explicit SubtreeValueCache(std::size_t capacity = 0, std::size_t minLength = DefaultMinLength)
+        : capacity_(capacity), minLength_(minLength)
+    {
+    }
+
+    // the cached values are only valid for a given dataset and range
+    // - calling this method with a different dataset or range flushes the cache
+    auto Bind(void const* dataset, Operon::Range range) -> void {
+        if (dataset != dataset_ || range.Bounds() != range_.Bounds()) {
+            Clear();
+            dataset_ = dataset;
+            range_ = range;
+        }
+    }
+
+    [[nodiscard]] auto Find(Operon::Hash hash) const -> std::span<T const> {
+        if (auto it = map_.find(hash); it != map_.end()) {
+            return { it->second.data(), it->second.size() };
+        }
+        return {};
+    }
+
+    auto Insert(Operon::Hash hash, std::vector<T>&& values) -> void {
+        if (values.size() > capacity_) { return; }
+        if (size_ + values.size() > capacity_) { Clear(); }
+        size_ += values.size();
+        map_.insert_or_assign(hash, std::move(values));
+    }
+
+    auto Clear() -> void {
+        map_.clear();
+        size_ = 0;
+    }
+
+    auto SetCapacity(std::size_t capacity) -> void { capacity_ = capacity; Clear(); }
+    auto SetMinLength(std::size_t minLength) -> void { minLength_ = minLength; }
+
+    [[nodiscard]] auto Capacity() const -> std::size_t { return capacity_; }
+    [[nodiscard]] auto MinLength() const -> std::size_t { return minLength_; }
+    [[nodiscard]] auto Size() const -> std::size_t { return size_; }
+    [[nodiscard]] auto Enabled() const -> bool { return capacity_ > 0; }
+
+private:
+    Operon::Map<Operon::Hash, std::vector<T>> map_;
+    void const* dataset_{nullptr};
+    Operon::Range range_;
+    std::size_t capacity_;
+    std::size_t minLength_;
+    std::size_t size_{0};
+};
+
+} // namespace Operon
+
+#endif
@@ -0,0 +1,423 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_TAPE_HPP
+#define OPERON_TAPE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "operon/core/dataset.hpp"
+#include "operon/core/dataset_codes.hpp"
+#include "operon/core/dataset_tiles.hpp"
+#include "operon/core/range.hpp"
+#include "operon/core/tree.hpp"
+#include "operon/core/types.hpp"
+#include "dispatch_table.hpp"
+
+namespace Operon {
+
+enum class OpCode : std::uint8_t { Constant, Variable, Function };
+
+// fused patterns recognized by the tape compiler
+// - WeightedSum: an n-ary addition of variables, w1 * x1 + w2 * x2 + ...
+// - WeightedExp: the exponential of a variable, exp(w * x)
+// - MulAdd: a binary addition where one argument is a binary multiplication, a * b + c
+enum class FusedOp : std::uint8_t { None, WeightedSum, WeightedExp, MulAdd };
+
+template<typename T, std::size_t S>
+struct Instruction {
+    Operon::OpCode Op;
+    Operon::Hash Hash;                                // node hash value (used to validate the tape)
+    T Coefficient;
+    std::span<Operon::Scalar const> Values;           // variable values over the compiled range
+    Operon::Scalar const* Tile;                       // variable values in the tile of the first row (see DatasetTiles)
+    Operon::EncodedValues Encoded;                    // variable values from the first row of the range, converted by the node (see DatasetCodes)
+    std::int32_t Decoded;                             // column of the variable in the decoded batch (see Tape::Decode), negative if not gathered
+    Operon::Scalar Scale;                             // variable transform, the values are read as Scale * x + Offset
+    Operon::Scalar Offset;                            // (see Dataset::SetTransform)
+    Dispatch::Callable<T, S> const* Function;         // owned by the dispatch table
+    Dispatch::CallableDiff<T, S> const* Derivative;   // owned by the dispatch table
+    Dispatch::FunctionPtr<T, S> Call;                 // the function wrapped by Function, if it is a plain function
+    Dispatch::DerivativePtr<T, S> CallDiff;           // the function wrapped by Derivative, if it is a plain function
+    Dispatch::ColumnPtr<T, S> CallColumns;            // the column kernel of a built-in primitive (see Tape::Columns)
+    std::uint32_t ChildOffset;                        // offset of the first child index in the children array
+    std::uint32_t Column;                             // column of the node in the compact primal layout
+    std::int32_t Slot;                                // block of the node in the invariant cache, negative if not cached
+    std::uint16_t Arity;
+    std::uint8_t Lag;                                 // row offset of a variable (see Node::Lag)
+    Operon::FusedOp Fused;                            // fused kernel used when no trace is needed
+    bool Absorbed;                                    // the node is computed as part of a fused parent
+    bool Active;                                      // the node is a coefficient or has a coefficient in its subtree
+    bool Folded;                                      // the subtree has no variables, its value is the same for every row
+    bool Covered;                                     // the node is in the subtree of a cached node (see Tape::CacheInvariants)
+};
+
+namespace detail {
+    // unique identifiers for the owners of a tape
+    inline auto NextTapeOwner() -> std::uint64_t {
+        static std::atomic<std::uint64_t> counter{1};
+        return counter.fetch_add(1, std::memory_order_relaxed);
+    }
+} // namespace detail
+
+// flat representation of a tree compiled against a dispatch table, a dataset and a range
+// - dispatch table lookups and variable lookups are done once, when the tape is compiled (including the transforms of
+//   the variables, so the tape must be compiled again if they change)
+// - child indices are precomputed so that the passes do not need to walk the postfix layout
+// - a compiled tape can be reused by subsequent calls for the same tree (eg. during local search),
+//   in which case only the coefficients are refreshed
+// - the functions of constants (the subtrees without variables) are folded: the interpreter computes them once per
+//   call instead of once per batch
+// - the values of the subtrees without coefficients can be cached across the calls (see CacheInvariants)
+// - the callables are referenced by pointer, therefore the dispatch table must not be modified while the tape is in use
+template<typename T, std::size_t S>
+class Tape {
+public:
+    // the variables are read from the tiles (if not null) when they match the batches (see DatasetTiles), otherwise
+    // they are decoded from the codes (if not null) when they are encoded (see DatasetCodes)
+    // - the nodes of the same variable (and lag) share one decoded column, unless they convert its codes themselves
+    template<typename DTable>
+    auto Compile(DTable const& dtable, Operon::Dataset const& dataset, Operon::Vector<Operon::Node> const& nodes, Operon::Range range, std::uint64_t owner, Operon::DatasetTiles const* tiles = nullptr, Operon::DatasetCodes const* codes = nullptr) -> void
+    {
+        code_.clear();
+        children_.clear();
+        encoded_.clear();
+        code_.reserve(nodes.size());
+
+        auto const tiled = tiles != nullptr && tiles->TileRows() == S && range.Start() % S == 0 && tiles->Rows() == dataset.Rows<std::size_t>();
+        stride_ = tiled ? tiles->Stride() : 0;
+
+        for (auto i = 0UL; i < nodes.size(); ++i) {
+            auto const& n = nodes[i];
+            Instruction<T, S> ins{
+                .Op          = Operon::OpCode::Constant,
+                .Hash        = n.HashValue,
+                .Coefficient = T{n.Value},
+                .Values      = {},
+                .Tile        = nullptr,
+                .Encoded     = {},
+                .Decoded     = -1,
+                .Scale       = 1,
+                .Offset      = 0,
+                .Function    = nullptr,
+                .Derivative  = nullptr,
+                .Call        = nullptr,
+                .CallDiff    = nullptr,
+                .CallColumns = nullptr,
+                .ChildOffset = static_cast<std::uint32_t>(children_.size()),
+                .Column      = 0,
+                .Slot        = -1,
+                .Arity       = n.Arity,
+                .Lag         = n.Lag,
+                .Fused       = Operon::FusedOp::None,
+                .Absorbed    = false,
+                .Active      = false,
+                .Folded      = false,
+                .Covered     = false
+            };
+
+            if (n.IsVariable()) {
+                // a lagged variable reads the rows before those of the range, without a shifted copy of the column
+                ins.Op = Operon::OpCode::Variable;
+                ins.Values = dataset.GetValues(n.HashValue, range, n.Lag);
+                if (tiled && n.Lag == 0) { ins.Tile = tiles->Values(n.HashValue, range.Start() / S); }
+                if (ins.Tile == nullptr && codes != nullptr && codes->Rows() == dataset.Rows<std::size_t>()) {
+                    if (auto const values = codes->Values(n.HashValue, range.Start() - n.Lag); !values.Gathered()) {
+                        ins.Encoded = values;
+                    } else if (!values.Empty()) {
+                        auto it = std::ranges::find(encoded_, values.Codes, &Operon::EncodedValues::Codes);
+                        ins.Decoded = static_cast<std::int32_t>(it - encoded_.begin());
+                        if (it == encoded_.end()) { encoded_.push_back(values); }
+                    }
+                }
+                std::tie(ins.Scale, ins.Offset) = dataset.GetTransform(n.HashValue);
+            } else if (!n.IsLeaf()) {
+                ins.Op     = Operon::OpCode::Function;
+                ins.Function   = dtable.template TryGetFunctionPtr<T>(n);
+                ins.Derivative = dtable.template TryGetDerivativePtr<T>(n);
+
+                if (ins.Function == nullptr) {
+                    throw std::runtime_error(fmt::format("Missing primitive for node {}\n", n.Name()));
+                }
+
+                // the built-in primitives are plain functions, which are called directly instead of through std::function
+                if (auto const* f = ins.Function->template target<Dispatch::FunctionPtr<T, S>>(); f != nullptr) {
+                    ins.Call = *f;
+                    ins.CallColumns = Dispatch::MakeColumnCall<T, S>(n.Type, *f);
+                }
+                if (ins.Derivative != nullptr) {
+                    if (auto const* df = ins.Derivative->template target<Dispatch::DerivativePtr<T, S>>(); df != nullptr) {
+                        ins.CallDiff = *df;
+                    }
+                }
+
+                ins.Folded = true;
+                for (auto j : Tree::Indices(nodes, i)) {
+                    children_.push_back(static_cast<std::uint32_t>(j));
+                    ins.Folded = ins.Folded && (code_[j].Op == Operon::OpCode::Constant || code_[j].Folded);
+                }
+            }
+            code_.push_back(ins);
+        }
+        Fuse(nodes);
+        Allocate();
+        decoded_.resize(encoded_.size() * S);
+
+        owner_ = owner;
+        range_ = range;
+        ResetCache();
+    }
+
+    // true if the tape was compiled by the given owner for the given range and nodes
+    [[nodiscard]] auto IsCompiled(std::uint64_t owner, Operon::Range range, Operon::Vector<Operon::Node> const& nodes) const -> bool
+    {
+        if (owner != owner_ || range.Bounds() != range_.Bounds() || nodes.size() != code_.size()) {
+            return false;
+        }
+        return std::ranges::equal(nodes, code_, [](auto const& n, auto const& ins) { return n.HashValue == ins.Hash && n.Lag == ins.Lag; });
+    }
+
+    // refresh the coefficients (from coeff if not empty, otherwise from the node values)
+    // - the active flags are refreshed as well, since the hash of a node does not cover its Optimize flag
+    // - the invariant cache is dropped if an inactive node changed
+    auto SetCoefficients(Operon::Vector<Operon::Node> const& nodes, Operon::Span<T const> coeff) -> void
+    {
+        auto changed{false};
+        for (auto i = 0UL, j = 0UL; i < nodes.size(); ++i) {
+            auto const& n = nodes[i];
+            auto& ins = code_[i];
+            auto const coefficient = (!coeff.empty() && n.Optimize) ? T{coeff[j++]} : T{n.Value};
+            auto const active = n.Optimize || std::ranges::any_of(Children(i), [&](auto c) { return code_[c].Active; });
+            changed = changed || active != ins.Active || (!active && coefficient != ins.Coefficient);
+            ins.Coefficient = coefficient;
+            ins.Active = active;
+        }
+        if (changed) { ResetCache(); }
+    }
+
+    // caches the values of the coefficient-free subtrees over the compiled range, so that the following calls (eg. the
+    // iterations of a local search, which only change the coefficients) copy them instead of computing them
+    // - the largest such subtrees are cached first (walking from the root) until the capacity is reached, the folded
+    //   and the absorbed nodes are not cached
+    // - each batch is stored by the first pass over it (see Store), the passes may visit the batches in any order
+    // - no-op if the subtrees are already cached
+    auto CacheInvariants(Operon::Vector<Operon::Node> const& nodes) -> void
+    {
+        if (planned_) { return; }
+        planned_ = true;
+        auto const len = range_.Size();
+        if (len == 0) { return; }
+
+        for (auto& ins : code_) {
+            ins.Slot = -1;
+            ins.Covered = false;
+        }
+        for (auto i = code_.size(); i-- > 0;) {
+            auto& ins = code_[i];
+            if (ins.Op != Operon::OpCode::Function || ins.Active || ins.Folded || ins.Absorbed || ins.Covered) { continue; }
+            if ((slots_ + 1) * len > capacity_) { break; }
+            ins.Slot = static_cast<std::int32_t>(slots_++);
+            for (auto j = i - nodes[i].Length; j < i; ++j) { code_[j].Covered = true; }
+        }
+        cache_.resize(slots_ * len);
+        stored_.assign((len + S - 1) / S, 0);
+    }
+
+    // true if some subtrees are cached
+    [[nodiscard]] auto Caching() const -> bool { return slots_ > 0; }
+
+    // true if the cached values of the batch starting at row (relative to the compiled range) are stored
+    [[nodiscard]] auto Stored(std::int64_t row) const -> bool { return stored_[static_cast<std::size_t>(row) / S] != 0; }
+
+    // marks the cached values of the batch starting at row as stored
+    auto Store(std::int64_t row) -> void { stored_[static_cast<std::size_t>(row) / S] = 1; }
+
+    // the cached values of node i (with its coefficient) over the compiled range
+    [[nodiscard]] auto CachedValues(std::size_t i) -> std::span<T> {
+        auto const len = range_.Size();
+        return { cache_.data() + (static_cast<std::size_t>(code_[i].Slot) * len), len };
+    }
+
+    // the maximum number of cached values (zero disables the cache)
+    auto SetCacheCapacity(std::size_t capacity) -> void {
+        capacity_ = capacity;
+        ResetCache();
+    }
+
+    [[nodiscard]] auto CacheCapacity() const -> std::size_t { return capacity_; }
+
+    [[nodiscard]] auto operator[](std::size_t i) const -> Instruction<T, S> const& { return code_[i]; }
+
+    [[nodiscard]] auto Children(std::size_t i) const -> std::span<std::uint32_t const> {
+        auto const& ins = code_[i];
+        return { children_.data() + ins.ChildOffset, ins.Op == Operon::OpCode::Function ? ins.Arity : 0UL };
+    }
+
+    // the values of variable i for the batch starting at row (relative to the compiled range), from its tiles if possible
+    // - the values of a gathered variable are those of the last decoded batch (see Decode)
+    [[nodiscard]] auto Values(std::size_t i, std::int64_t row) const -> Operon::Scalar const* {
+        auto const& ins = code_[i];
+        if (ins.Decoded >= 0) { return decoded_.data() + (static_cast<std::size_t>(ins.Decoded) * S); }
+        return ins.Tile == nullptr ? ins.Values.data() + row : ins.Tile + ((row / static_cast<std::int64_t>(S)) * static_cast<std::int64_t>(stride_));
+    }
+
+    // true if some variables are gathered from a dictionary
+    [[nodiscard]] auto Decoding() const -> bool { return !encoded_.empty(); }
+
+    // decodes the rem values of the gathered variables from row (relative to the compiled range), once per batch
+    // instead of once per node of the variable
+    auto Decode(std::int64_t row, std::int64_t rem) -> void {
+        for (auto k = 0UL; k < encoded_.size(); ++k) {
+            encoded_[k].Decode(static_cast<std::size_t>(row), static_cast<std::size_t>(rem), decoded_.data() + (k * S));
+        }
+    }
+
+    // the columns of the children of node i in the compact primal layout
+    [[nodiscard]] auto Arguments(std::size_t i) const -> std::span<std::uint32_t const> {
+        auto const& ins = code_[i];
+        return { arguments_.data() + ins.ChildOffset, ins.Op == Operon::OpCode::Function ? ins.Arity : 0UL };
+    }
+
+    // number of columns of the compact primal layout, zero if the tree cannot use it (see Allocate)
+    [[nodiscard]] auto Columns() const -> std::size_t { return columns_; }
+
+    [[nodiscard]] auto Size() const -> std::size_t { return code_.size(); }
+
+private:
+    // select fused kernels for the patterns described by FusedOp
+    // - this assumes the default semantics of the Add, Mul and Exp primitives
+    // - the absorbed children are only skipped by passes that do not need their values (no trace, no seeds)
+    auto Fuse(Operon::Vector<Operon::Node> const& nodes) -> void
+    {
+        // the weighted sums convert the encoded variables, the other fused kernels read the columns of the variables
+        auto isVariable = [&](auto j) { return code_[j].Op == Operon::OpCode::Variable; };
+        auto isColumn = [&](auto j) { return isVariable(j) && code_[j].Encoded.Empty(); };
+
+        for (auto i = 0UL; i < nodes.size(); ++i) {
+            auto const& n = nodes[i];
+            auto& ins = code_[i];
+            if (ins.Op != Operon::OpCode::Function) { continue; }
+            auto children = Children(i);
+
+            if (n.Type == NodeType::Add && n.Arity > 1 && std::ranges::all_of(children, isVariable)) {
+                ins.Fused = Operon::FusedOp::WeightedSum;
+            } else if (n.Type == NodeType::Exp && isColumn(children.front())) {
+                ins.Fused = Operon::FusedOp::WeightedExp;
+            } else if (n.Type == NodeType::Add && n.Arity == 2) {
+                // put the multiplication first
+                auto isProduct = [&](auto j) { return nodes[j].Type == NodeType::Mul && nodes[j].Arity == 2; };
+                if (!isProduct(children[0]) && isProduct(children[1])) {
+                    std::swap(children_[ins.ChildOffset], children_[ins.ChildOffset + 1]);
+                }
+                if (isProduct(children[0])) {
+                    ins.Fused = Operon::FusedOp::MulAdd;
+                    code_[children[0]].Absorbed = true;
+                }
+                continue;
+            }
+
+            if (ins.Fused != Operon::FusedOp::None) {
+                for (auto j : children) { code_[j].Absorbed = true; }
+            }
+        }
+    }
+
+    // assigns the columns of the compact primal layout, used by the passes that need neither the trace nor the values
+    // of the absorbed nodes (in postfix order only a stack of intermediate values is live at once)
+    // - the column of a node is reused once its parent (the fused parent for the children of an absorbed node) has
+    //   been computed, the parent never shares a column with its arguments
+    // - the folded nodes are computed once per call, those read by the other nodes keep their columns (the constants
+    //   are filled again by each batch instead, a column of a constant costs more than filling it)
+    // - the absorbed nodes are not computed and have no column
+    // - the layout is not used if a computed node has no column kernel (eg. a primitive registered by the user)
+    auto Allocate() -> void
+    {
+        arguments_.assign(children_.size(), 0);
+        columns_ = 0;
+
+        if (code_.empty()) { return; }
+
+        // the folded nodes whose values are read after each batch (the absorbed nodes are read through their children)
+        std::vector<std::uint8_t> pinned(code_.size(), 0);
+        pinned.back() = static_cast<std::uint8_t>(code_.back().Folded);
+        for (auto i = 0UL; i < code_.size(); ++i) {
+            if (code_[i].Op != Operon::OpCode::Function || code_[i].Folded) { continue; }
+            for (auto j : Children(i)) {
+                if (code_[j].Absorbed) {
+                    for (auto x : Children(j)) { pinned[x] = static_cast<std::uint8_t>(code_[x].Folded); }
+                } else {
+                    pinned[j] = static_cast<std::uint8_t>(code_[j].Folded);
+                }
+            }
+        }
+
+        std::vector<std::uint32_t> free;
+        auto release = [&](auto j) {
+            if (pinned[j] == 0 && !(code_[j].Absorbed && !code_[j].Folded)) { free.push_back(code_[j].Column); }
+        };
+
+        auto supported{true};
+        for (auto i = 0UL; i < code_.size(); ++i) {
+            auto& ins = code_[i];
+            if (ins.Absorbed && !ins.Folded) { continue; }
+
+            if (pinned[i] != 0 || free.empty()) {
+                ins.Column = static_cast<std::uint32_t>(columns_++);
+            } else {
+                ins.Column = free.back();
+                free.pop_back();
+            }
+            if (ins.Op != Operon::OpCode::Function) { continue; }
+
+            auto const called = ins.Folded || ins.Fused == Operon::FusedOp::None;
+            supported = supported && (!called || ins.CallColumns != nullptr);
+            for (auto k = 0UL; k < ins.Arity; ++k) {
+                arguments_[ins.ChildOffset + k] = code_[children_[ins.ChildOffset + k]].Column;
+            }
+            if (ins.Absorbed) { continue; } // the arguments are read by the fused parent
+            for (auto j : Children(i)) {
+                release(j);
+                if (code_[j].Absorbed) {
+                    for (auto x : Children(j)) { release(x); }
+                }
+            }
+        }
+        if (!supported) { columns_ = 0; }
+    }
+
+    auto ResetCache() -> void
+    {
+        planned_ = false;
+        slots_ = 0;
+    }
+
+    static constexpr std::size_t DefaultCacheCapacity{1UL << 20U};
+
+    std::vector<Instruction<T, S>> code_;
+    std::vector<std::uint32_t> children_;
+    std::vector<std::uint32_t> arguments_; // the columns of children_
+    std::size_t columns_{0};
+    std::size_t stride_{0}; // distance between the tiles of a variable
+    std::vector<Operon::EncodedValues> encoded_; // the distinct gathered variables (see Decode)
+    std::vector<Operon::Scalar> decoded_;        // one batch of S values per gathered variable
+    std::uint64_t owner_{0};
+    Operon::Range range_;
+
+    // the invariant cache (see CacheInvariants)
+    std::vector<T> cache_;                 // one block of range_.Size() values per cached node
+    std::vector<std::uint8_t> stored_;     // the batches whose values are stored
+    std::size_t slots_{0};
+    std::size_t capacity_{DefaultCacheCapacity};
+    bool planned_{false};
+};
+
+} // namespace Operon
+
+#endif
@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_ASYNC_EVALUATOR_HPP
+#define OPERON_ASYNC_EVALUATOR_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "operon/operators/evaluator.hpp"
+#include "operon/operon_export.hpp"
+
+namespace Operon {
+
+// fitness evaluation by an external system (eg. a simulator or a remote service) that evaluates batches of individuals
+// - the batch function submits the individuals and returns at once, the future holds one fitness per individual (in
+//   order), or the exception of the evaluation
+// - Evaluate (the initial population, the batched local search) splits the group into batches and submits all of them
+//   before waiting for the first result, so the whole group is in flight at once
+// - the single evaluations of the workers (the offspring) are coalesced: a batch is submitted when it holds BatchSize
+//   individuals or when its first individual has waited for MaxDelay, every worker of the batch waits for its result
+// - the workers are blocked while the batches are evaluated externally, an executor with more workers than cores
+//   keeps more offspring in flight
+// - the batch function is called from the worker threads, possibly by several at once, and must be thread-safe, the
+//   individuals of a batch stay alive until its future is ready
+// - each fitness counts as one residual evaluation, so that the evaluation budget applies
+class OPERON_EXPORT AsyncEvaluator : public EvaluatorBase {
+public:
+    using BatchResult = std::vector<typename EvaluatorBase::ReturnType>;
+    using BatchFunction = std::function<std::future<BatchResult>(Operon::Span<Operon::Individual const>)>;
+
+    static constexpr std::size_t DefaultBatchSize{64};
+    static constexpr std::chrono::microseconds DefaultMaxDelay{1000};
+
+    AsyncEvaluator(Problem& problem, BatchFunction func, std::size_t batchSize = DefaultBatchSize, std::chrono::microseconds maxDelay = DefaultMaxDelay);
+
+    auto operator()(Operon::RandomGenerator& rng, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> typename EvaluatorBase::ReturnType override;
+
+    auto Evaluate(Operon::RandomGenerator& rng, Operon::Span<Individual> individuals, Operon::Vector<Operon::Scalar>& buf) const -> void override;
+
+    [[nodiscard]] auto BatchSize() const -> std::size_t { return batchSize_; }
+    [[nodiscard]] auto MaxDelay() const -> std::chrono::microseconds { return maxDelay_; }
+
+    // the number of batches submitted so far
+    [[nodiscard]] auto Batches() const -> std::size_t { return batches_.load(); }
+
+private:
+    struct Pending;
+
+    // submits the pending batch, lock is held on entry and released on return
+    auto Submit(std::unique_lock<std::mutex>& lock) const -> void;
+
+    BatchFunction func_;
+    std::size_t batchSize_;
+    std::chrono::microseconds maxDelay_;
+
+    mutable std::mutex mutex_;
+    mutable std::condition_variable submitted_;
+    mutable std::shared_ptr<Pending> pending_; // the batch that collects the single evaluations
+    mutable ShardedCounter batches_{0};
+};
+
+} // namespace Operon
+
+#endif
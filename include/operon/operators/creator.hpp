@@ -4,6 +4,8 @@
 #ifndef OPERON_CREATOR_HPP
 #define OPERON_CREATOR_HPP
 
+#include <cstdint>
+#include <random>
 #include <utility>
 
 #include "operon/core/operator.hpp"
@@ -28,9 +30,29 @@ struct OPERON_EXPORT CreatorBase : public OperatorBase<Tree, size_t, size_t, siz
     [[nodiscard]] auto GetVariables() const -> Operon::Span<Operon::Hash const> { return variables_; }
     auto SetVariables(Operon::Span<Operon::Hash const> variables) { variables_ = std::vector<Operon::Hash>(variables.begin(), variables.end()); }
 
+    // the variables are lagged by a uniformly drawn number of rows between zero and maxLag (see Node::Lag)
+    // - the first row of the ranges evaluated by the created trees must be at least maxLag
+    // - zero (the default) creates no lagged variables and does not draw from the random generator
+    [[nodiscard]] auto GetMaxLag() const -> uint8_t { return maxLag_; }
+    auto SetMaxLag(uint8_t maxLag) { maxLag_ = maxLag; }
+
+    static auto SampleLag(Operon::RandomGenerator& random, uint8_t maxLag) -> uint8_t
+    {
+        return maxLag == 0 ? uint8_t{0} : static_cast<uint8_t>(std::uniform_int_distribution<int>(0, maxLag)(random));
+    }
+
+    // creates a group of trees, trees[i] with the target length lengths[i] and the random generator rngs[i]
+    // - the default implementation calls operator() for each tree
+    // - the balanced, grow and probabilistic creators reuse their buffers between the trees and write into the node
+    //   buffers of the trees
+    // - the grow and probabilistic creators fill in the Length, Depth, Level and Parent of the nodes as they build them,
+    //   without recursion (the trees do not need Tree::UpdateNodes)
+    virtual auto Create(Operon::Span<Operon::RandomGenerator> rngs, Operon::Span<size_t const> lengths, size_t minDepth, size_t maxDepth, Operon::Span<Tree> trees) const -> void;
+
 private:
     std::reference_wrapper<PrimitiveSet const> pset_;
     std::vector<Operon::Hash> variables_;
+    uint8_t maxLag_{0};
 };
 
 // this tree creator expands bread-wise using a "horizon" of open expansion slots
@@ -45,6 +67,7 @@ public:
     }
 
     auto operator()(Operon::RandomGenerator& random, size_t targetLen, size_t minDepth, size_t maxDepth) const -> Tree override;
+    auto Create(Operon::Span<Operon::RandomGenerator> rngs, Operon::Span<size_t const> lengths, size_t minDepth, size_t maxDepth, Operon::Span<Tree> trees) const -> void override;
 
     void SetBias(double bias) { irregularityBias_ = bias; }
     [[nodiscard]] auto GetBias() const -> double { return irregularityBias_; }
@@ -60,6 +83,7 @@ class OPERON_EXPORT GrowTreeCreator final : public CreatorBase {
         { }
 
     auto operator()(Operon::RandomGenerator& random, size_t targetLen, size_t minDepth, size_t maxDepth) const -> Tree override;
+    auto Create(Operon::Span<Operon::RandomGenerator> rngs, Operon::Span<size_t const> lengths, size_t minDepth, size_t maxDepth, Operon::Span<Tree> trees) const -> void override;
 };
 
 class OPERON_EXPORT ProbabilisticTreeCreator final : public CreatorBase {
@@ -71,6 +95,7 @@ public:
     }
 
     auto operator()(Operon::RandomGenerator& random, size_t targetLen, size_t minDepth, size_t maxDepth) const -> Tree override;
+    auto Create(Operon::Span<Operon::RandomGenerator> rngs, Operon::Span<size_t const> lengths, size_t minDepth, size_t maxDepth, Operon::Span<Tree> trees) const -> void override;
 
     void SetBias(double bias) { irregularityBias_ = bias; }
     [[nodiscard]] auto GetBias() const -> double { return irregularityBias_; }
@@ -12,6 +12,7 @@
 #include <utility>
 
 #include "operon/operon_export.hpp"
+#include "operon/core/compact_tree.hpp"
 #include "operon/core/operator.hpp"
 #include "operon/core/tree.hpp"
 #include "operon/core/node.hpp"
@@ -20,6 +21,43 @@
 namespace Operon {
 // crossover takes two parent trees and returns a child
 struct CrossoverBase : public OperatorBase<Tree, const Tree&, const Tree&> {
+    // writes the child into an existing tree, reusing the capacity of its node vector
+    // - the child must not be one of the parents
+    // - the default implementation assigns the result of operator()
+    virtual auto Recombine(Operon::RandomGenerator& random, Tree const& lhs, Tree const& rhs, Tree& child) const -> void
+    {
+        child = (*this)(random, lhs, rhs);
+    }
+};
+
+// the swap locations of a tree ordered by subtree length, for sampling compatible swap locations without scanning the tree
+// - build it once for a tree that takes part in many crossovers (eg. a parent producing a brood)
+// - a query takes logarithmic time, plus a few rejected samples when the depth limit is tight
+// - the level limits used by SubtreeCrossover always admit every node, so levels are not indexed
+class OPERON_EXPORT SwapLocationIndex {
+public:
+    using Limits = std::pair<size_t, size_t>;
+
+    explicit SwapLocationIndex(Tree const& tree);
+
+    // a uniformly sampled node whose subtree length (Length + 1) and depth are within the limits
+    // - internal nodes are preferred with probability internalProb (as in SubtreeCrossover)
+    [[nodiscard]] auto Sample(Operon::RandomGenerator& random, double internalProb, Limits length, Limits depth) const -> size_t;
+
+    [[nodiscard]] auto Length() const -> size_t { return length_; }
+    [[nodiscard]] auto Depth() const -> size_t { return depth_; }
+
+private:
+    struct Entry {
+        uint16_t Length; // subtree length
+        uint16_t Depth;
+        uint32_t Index;
+    };
+
+    std::vector<uint32_t> leaves_;
+    std::vector<Entry> functions_; // sorted by subtree length
+    size_t length_;
+    size_t depth_;
 };
 
 class OPERON_EXPORT SubtreeCrossover : public CrossoverBase {
@@ -31,23 +69,44 @@ public:
     {
     }
     auto operator()(Operon::RandomGenerator& random, const Tree& lhs, const Tree& rhs) const -> Tree override;
+    auto Recombine(Operon::RandomGenerator& random, Tree const& lhs, Tree const& rhs, Tree& child) const -> void override;
     auto FindCompatibleSwapLocations(Operon::RandomGenerator& random, const Tree& lhs, const Tree& rhs) const -> std::pair<size_t, size_t>;
+    // same distribution of swap locations, sampled from precomputed indices of the parents
+    auto FindCompatibleSwapLocations(Operon::RandomGenerator& random, const Tree& lhs, const Tree& rhs, SwapLocationIndex const& lhsIndex, SwapLocationIndex const& rhsIndex) const -> std::pair<size_t, size_t>;
 
-    static inline auto Cross(const Tree& lhs, const Tree& rhs, /* index of subtree 1 */ size_t i, /* index of subtree 2 */ size_t j) -> Tree
+    static inline auto Cross(const Tree& lhs, const Tree& rhs, /* index of subtree 1 */ size_t i, /* index of subtree 2 */ size_t j, Tree& child) -> void
     {
+        EXPECT(&child != &lhs && &child != &rhs);
         auto const& left = lhs.Nodes();
         auto const& right = rhs.Nodes();
-        Operon::Vector<Node> nodes;
+        // a child that shares its nodes with another tree gets a new buffer instead of a copy of the old nodes
+        if (child.Shared()) { child = Tree(NodeArena::Acquire(right[j].Length - left[i].Length + left.size())); }
+        auto& nodes = child.Nodes();
         using signed_t = std::make_signed<size_t>::type; // NOLINT
+        nodes.clear();
         nodes.reserve(right[j].Length - left[i].Length + left.size());
         std::copy_n(left.begin(), i - left[i].Length, back_inserter(nodes));
         std::copy_n(right.begin() + static_cast<signed_t>(j) - right[j].Length, right[j].Length + 1, back_inserter(nodes));
         std::copy_n(left.begin() + static_cast<signed_t>(i) + 1, left.size() - (i + 1), back_inserter(nodes));
+        // only the swapped subtree and its ancestors need updating
+        auto const removed = left[i].Length + 1UL;
+        auto const inserted = right[j].Length + 1UL;
+        auto const parent = static_cast<size_t>(static_cast<signed_t>(left[i].Parent) + static_cast<signed_t>(inserted) - static_cast<signed_t>(removed));
+        child.UpdateNodes(i - left[i].Length, removed, inserted, parent);
+    }
 
-        auto child = Tree(nodes).UpdateNodes();
+    static inline auto Cross(const Tree& lhs, const Tree& rhs, /* index of subtree 1 */ size_t i, /* index of subtree 2 */ size_t j) -> Tree
+    {
+        Tree child(NodeArena::Acquire(rhs[j].Length - lhs[i].Length + lhs.Length()));
+        Cross(lhs, rhs, i, j, child);
         return child;
     }
 
+    static inline auto Cross(CompactTree const& lhs, CompactTree const& rhs, size_t i, size_t j) -> CompactTree
+    {
+        return CompactTree::Cross(lhs, rhs, i, j);
+    }
+
     [[nodiscard]] auto InternalProbability() const -> double { return internalProbability_; }
     [[nodiscard]] auto MaxDepth() const -> size_t { return maxDepth_; }
     [[nodiscard]] auto MaxLength() const -> size_t { return maxLength_; }
@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_DISTRIBUTED_EVALUATOR_HPP
+#define OPERON_DISTRIBUTED_EVALUATOR_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "operon/core/dataset.hpp"
+#include "operon/core/range.hpp"
+#include "operon/error_metrics/error_accumulator.hpp"
+#include "operon/interpreter/dispatch_table.hpp"
+#include "operon/operators/evaluator.hpp"
+#include "operon/operon_export.hpp"
+
+#if defined(HAVE_MPI)
+#include <mpi.h>
+#endif
+
+namespace Operon {
+
+// fitness evaluation over datasets whose rows are split between several nodes (processes or machines)
+// - a request is a batch of trees (see Serialization), the response contains one ErrorAccumulator state per tree
+// - each node evaluates the trees on its shard of the rows and the master merges the statistics into the fitness,
+//   so the error metric must be computable from the statistics (see ErrorMetric::SupportsStatistics)
+// - the shards must use the same variable names, since the variable hashes of the trees are derived from the names
+
+// evaluates the requests on one shard of the rows
+class OPERON_EXPORT EvaluationWorker {
+public:
+    EvaluationWorker(DefaultDispatch const& dtable, Dataset const& shard, std::string const& target, Range range);
+    EvaluationWorker(DefaultDispatch const& dtable, Dataset const& shard, std::string const& target)
+        : EvaluationWorker(dtable, shard, target, Range{0, shard.Rows<std::size_t>()})
+    {
+    }
+
+    [[nodiscard]] auto Process(Operon::Span<uint8_t const> request) const -> std::vector<uint8_t>;
+
+    [[nodiscard]] auto Rows() const -> std::size_t { return range_.Size(); }
+
+private:
+    std::reference_wrapper<DefaultDispatch const> dtable_;
+    std::reference_wrapper<Dataset const> shard_;
+    Operon::Span<Operon::Scalar const> target_;
+    Range range_;
+};
+
+// sends a request to a worker and waits for the response (must be thread-safe)
+class OPERON_EXPORT EvaluationNode {
+public:
+    EvaluationNode() = default;
+    EvaluationNode(EvaluationNode const&) = delete;
+    EvaluationNode(EvaluationNode&&) = delete;
+    auto operator=(EvaluationNode const&) -> EvaluationNode& = delete;
+    auto operator=(EvaluationNode&&) -> EvaluationNode& = delete;
+    virtual ~EvaluationNode() = default;
+
+    [[nodiscard]] virtual auto Evaluate(std::vector<uint8_t> const& request) const -> std::vector<uint8_t> = 0;
+};
+
+// a worker in the same process
+class OPERON_EXPORT LocalEvaluationNode : public EvaluationNode {
+public:
+    explicit LocalEvaluationNode(EvaluationWorker const& worker)
+        : worker_(worker)
+    {
+    }
+
+    [[nodiscard]] auto Evaluate(std::vector<uint8_t> const& request) const -> std::vector<uint8_t> override { return worker_.get().Process(request); }
+
+private:
+    std::reference_wrapper<EvaluationWorker const> worker_;
+};
+
+#if defined(HAVE_MPI)
+// a worker on another rank, running ServeEvaluations
+// - each request is sent with a unique tag and the response comes back with the same tag,
+//   so several threads can evaluate concurrently (requires MPI_THREAD_MULTIPLE)
+class OPERON_EXPORT MpiEvaluationNode : public EvaluationNode {
+public:
+    MpiEvaluationNode(MPI_Comm comm, int rank);
+
+    [[nodiscard]] auto Evaluate(std::vector<uint8_t> const& request) const -> std::vector<uint8_t> override;
+
+    // stops the ServeEvaluations loop of the worker
+    auto Shutdown() const -> void;
+
+private:
+    MPI_Comm comm_;
+    int rank_;
+    int maxTag_;
+    mutable std::atomic_int tag_{0};
+};
+
+// answers the requests of the master until the master calls Shutdown
+auto OPERON_EXPORT ServeEvaluations(MPI_Comm comm, EvaluationWorker const& worker, int master = 0) -> void;
+#endif
+
+class OPERON_EXPORT DistributedEvaluator : public EvaluatorBase {
+public:
+    DistributedEvaluator(Problem& problem, std::vector<std::reference_wrapper<EvaluationNode const>> nodes, ErrorMetric error = MSE{}, bool linearScaling = true);
+
+    auto operator()(Operon::RandomGenerator& rng, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> typename EvaluatorBase::ReturnType override;
+
+    // the whole group is sent as a single request to each node
+    auto Evaluate(Operon::RandomGenerator& rng, Operon::Span<Individual> individuals, Operon::Vector<Operon::Scalar>& buf) const -> void override;
+
+    // the merged statistics of each tree over all the shards
+    [[nodiscard]] auto Statistics(Operon::Span<Individual const> individuals) const -> std::vector<ErrorAccumulator>;
+
+    [[nodiscard]] auto Nodes() const -> std::size_t { return nodes_.size(); }
+
+private:
+    std::vector<std::reference_wrapper<EvaluationNode const>> nodes_;
+    ErrorMetric error_;
+    bool scaling_;
+};
+
+} // namespace Operon
+
+#endif
@@ -4,16 +4,30 @@
 #ifndef OPERON_EVALUATOR_HPP
 #define OPERON_EVALUATOR_HPP
 
+#include <algorithm>
 #include <atomic>
+#include <cmath>
 #include <functional>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
 #include <utility>
 
 #include "operon/collections/projection.hpp"
+#include "operon/core/counter.hpp"
+#include "operon/core/fingerprint.hpp"
 #include "operon/core/individual.hpp"
 #include "operon/core/operator.hpp"
+#include "operon/core/pool.hpp"
 #include "operon/core/problem.hpp"
+#include "operon/core/sharded_map.hpp"
 #include "operon/core/types.hpp"
+#include "operon/error_metrics/error_accumulator.hpp"
+#include "operon/interpreter/batch_tuning.hpp"
+#include "operon/interpreter/cost_model.hpp"
 #include "operon/interpreter/interpreter.hpp"
+#include "operon/interpreter/interval.hpp"
 #include "operon/operon_export.hpp"
 #include "operon/optimizer/likelihood/likelihood_base.hpp"
 #include "operon/optimizer/optimizer.hpp"
@@ -33,6 +47,20 @@ struct OPERON_EXPORT ErrorMetric {
     auto operator()(Iterator beg1, Iterator end1, Iterator beg2) const -> double;
     auto operator()(Iterator beg1, Iterator end1, Iterator beg2, Iterator beg3) const -> double;
 
+    // computes the error from streaming statistics (see ErrorAccumulator), optionally for the linearly scaled estimates
+    // - the scaled MAE cannot be computed from the statistics (check SupportsStatistics first)
+    auto operator()(ErrorAccumulator const& stats, bool scaled = false) const -> double;
+    [[nodiscard]] auto SupportsStatistics(bool scaled) const -> bool { return !(scaled && type_ == ErrorType::MAE); }
+
+    // lower bound of the error over n values, given the statistics of a subset of them
+    // - only defined for the metrics that grow with the accumulated error (SSE, MSE, RMSE, unscaled MAE)
+    // - in the scaled case, the least squares error over a subset cannot exceed the least squares error over all the values
+    auto LowerBound(ErrorAccumulator const& partial, double n, bool scaled) const -> double;
+    [[nodiscard]] auto SupportsBound(bool scaled) const -> bool {
+        return type_ == ErrorType::SSE || type_ == ErrorType::MSE || type_ == ErrorType::RMSE || (type_ == ErrorType::MAE && !scaled);
+    }
+    [[nodiscard]] auto Type() const -> ErrorType { return type_; }
+
     private:
     ErrorType type_;
 };
@@ -68,13 +96,63 @@ struct OPERON_EXPORT C2 : public ErrorMetric {
 auto OPERON_EXPORT FitLeastSquares(Operon::Span<float const> estimated, Operon::Span<float const> target) noexcept -> std::pair<double, double>;
 auto OPERON_EXPORT FitLeastSquares(Operon::Span<double const> estimated, Operon::Span<double const> target) noexcept -> std::pair<double, double>;
 
+// moments of the target values, which do not change during a run (see Evaluator::Prepare)
+// - Values is the span the statistics were computed on, the statistics only apply to the same span
+struct OPERON_EXPORT TargetStatistics {
+    Operon::Span<Operon::Scalar const> Values;
+    double Mean{0};
+    double Variance{0};
+    double SumSquares{0}; // sum of squared deviations from the mean
+
+    TargetStatistics() = default;
+    explicit TargetStatistics(Operon::Span<Operon::Scalar const> values);
+
+    [[nodiscard]] auto Matches(Operon::Span<Operon::Scalar const> values) const -> bool {
+        return !Values.empty() && Values.data() == values.data() && Values.size() == values.size();
+    }
+};
+
+// least squares fit of the scaling parameters with the target moments precomputed
+// - only the moments involving the estimated values are accumulated, in a single pass
+auto OPERON_EXPORT FitLeastSquares(Operon::Span<float const> estimated, Operon::Span<float const> target, TargetStatistics const& stats) noexcept -> std::pair<double, double>;
+auto OPERON_EXPORT FitLeastSquares(Operon::Span<double const> estimated, Operon::Span<double const> target, TargetStatistics const& stats) noexcept -> std::pair<double, double>;
+
+// the counters of an evaluator (see EvaluatorBase::Stats)
+struct EvaluatorStats {
+    std::size_t Residual{0};       // residual evaluations
+    std::size_t Jacobian{0};       // jacobian evaluations
+    std::size_t Calls{0};          // calls of the evaluator
+    std::size_t CostTime{0};       // time spent in the cost function (microseconds)
+    std::size_t CacheHits{0};      // fitness cache hits (see Evaluator::SetCache)
+    std::size_t CacheMisses{0};    // fitness cache misses
+    std::size_t SavedJacobians{0}; // local search iterations not spent (see CoefficientOptimizer::SetAdaptiveIterations)
+
+    auto operator+=(EvaluatorStats const& rhs) -> EvaluatorStats& {
+        Residual += rhs.Residual;
+        Jacobian += rhs.Jacobian;
+        Calls += rhs.Calls;
+        CostTime += rhs.CostTime;
+        CacheHits += rhs.CacheHits;
+        CacheMisses += rhs.CacheMisses;
+        SavedJacobians += rhs.SavedJacobians;
+        return *this;
+    }
+};
+
+// the counters are sharded over the threads (see ShardedCounter), they are cheap to increment and summed when read
 struct EvaluatorBase : public OperatorBase<Operon::Vector<Operon::Scalar>, Individual&, Operon::Span<Operon::Scalar>> {
-    mutable std::atomic_ulong ResidualEvaluations { 0 }; // NOLINT
-    mutable std::atomic_ulong JacobianEvaluations { 0 }; // NOLINT
-    mutable std::atomic_ulong CallCount { 0 }; // NOLINT
-    mutable std::atomic_ulong CostFunctionTime { 0 }; // NOLINT
+    mutable ShardedCounter ResidualEvaluations { 0 }; // NOLINT
+    mutable ShardedCounter JacobianEvaluations { 0 }; // NOLINT
+    mutable ShardedCounter CallCount { 0 }; // NOLINT
+    mutable ShardedCounter CostFunctionTime { 0 }; // NOLINT
+    mutable ShardedCounter CacheHits { 0 }; // NOLINT
+    mutable ShardedCounter CacheMisses { 0 }; // NOLINT
+    mutable ShardedCounter SavedJacobianEvaluations { 0 }; // NOLINT (local search iterations not spent, see CoefficientOptimizer::SetAdaptiveIterations)
 
     static constexpr size_t DefaultEvaluationBudget = 100'000;
+    static constexpr size_t DefaultEvaluationTileSize = 16; // default number of individuals evaluated together by Evaluate
+    static constexpr size_t BudgetCheckInterval = 16; // see BudgetExhaustedApprox
+    static constexpr size_t BudgetCheckSlack = 16;
 
     static auto constexpr ErrMax { std::numeric_limits<Operon::Scalar>::max() };
 
@@ -91,20 +169,97 @@ struct EvaluatorBase : public OperatorBase<Operon::Vector<Operon::Scalar>, Indiv
 
     virtual auto ObjectiveCount() const -> std::size_t { return 1UL; }
 
+    // true if the tree is known to evaluate to non-finite values, without evaluating it (eg. see Evaluator::SetIntervalCheck)
+    // - the offspring generators skip the local search of rejected trees
+    // - the default implementation rejects nothing
+    virtual auto Rejects(Operon::Tree const& /*tree*/) const -> bool { return false; }
+
+    // evaluates a group of individuals and assigns their fitness
+    // - the default implementation simply calls operator() for each individual
+    // - derived evaluators can override it to evaluate the whole group in one pass over the data
+    // - buf should be able to hold individuals.size() * training range size values (resized if needed)
+    virtual auto Evaluate(Operon::RandomGenerator& rng, Operon::Span<Individual> individuals, Operon::Vector<Operon::Scalar>& buf) const -> void
+    {
+        auto const n { std::min(buf.size(), GetProblem().TrainingRange().Size()) };
+        for (auto& ind : individuals) {
+            ind.Fitness = (*this)(rng, ind, { buf.data(), n });
+        }
+    }
+
+    // evaluates an individual whose fitness only matters if it does not exceed bound (eg. in offspring selection)
+    // - evaluators may stop as soon as the error provably exceeds the bound, in which case the returned fitness
+    //   is a lower bound of the actual fitness (and larger than bound)
+    // - an empty bound means no bound, the default implementation ignores the bound
+    virtual auto EvaluateBounded(Operon::RandomGenerator& rng, Individual& ind, Operon::Span<Operon::Scalar> buf, Operon::Span<Operon::Scalar const> /*bound*/) const -> ReturnType
+    {
+        return (*this)(rng, ind, buf);
+    }
+
+    // evaluates an individual on a subrange of the training range (eg. for racing or mini-batch evaluation)
+    // - the default implementation ignores the range and evaluates on the whole training range
+    virtual auto EvaluateSubset(Operon::RandomGenerator& rng, Individual& ind, Operon::Span<Operon::Scalar> buf, Operon::Range /*range*/) const -> ReturnType
+    {
+        return (*this)(rng, ind, buf);
+    }
+
+    // sharing of the predictions between the evaluators of a MultiEvaluator, so that a tree is interpreted only once
+    // - an evaluator that uses predictions can both compute them (Predict) and derive its fitness from them
+    //   (EvaluatePredictions), the predictions are the unscaled outputs of the tree over the training range
+    // - the default implementation does not use predictions
+    virtual auto UsesPredictions() const -> bool { return false; }
+    virtual auto Predict(Individual const& /*ind*/, Operon::Span<Operon::Scalar> /*buf*/) const -> void { }
+    virtual auto EvaluatePredictions(Operon::RandomGenerator& rng, Individual& ind, Operon::Span<Operon::Scalar const> /*predictions*/) const -> ReturnType
+    {
+        return (*this)(rng, ind, {});
+    }
+
     auto TotalEvaluations() const -> size_t { return ResidualEvaluations + JacobianEvaluations; }
 
-    void SetBudget(size_t value) { budget_ = value; }
+    void SetBudget(size_t value)
+    {
+        budget_ = value;
+        exhausted_ = false;
+        lastTotal_ = 0;
+    }
     auto Budget() const -> size_t { return budget_; }
 
+    // number of individuals passed at once to Evaluate by the algorithms (initial population)
+    void SetEvaluationGroupSize(size_t value) { groupSize_ = std::max(value, size_t{1}); }
+    auto EvaluationGroupSize() const -> size_t { return groupSize_; }
+
     // virtual because more complex evaluators (e.g. MultiEvaluator) might need to calculate it differently
     virtual auto BudgetExhausted() const -> bool { return TotalEvaluations() >= Budget(); }
 
-    virtual auto Stats() const -> std::tuple<std::size_t, std::size_t, std::size_t, std::size_t> {
-        return std::tuple{
-            ResidualEvaluations.load(),
-            JacobianEvaluations.load(),
-            CallCount.load(),
-            CostFunctionTime.load()
+    // cheap approximation of BudgetExhausted for the tight loops of the algorithms (see OffspringGeneratorBase::Terminate)
+    // - each thread sums the counters only once every BudgetCheckInterval calls, except in the last sixteenth of the
+    //   budget where every call is exact, an exhausted budget is remembered until the next Reset or SetBudget
+    // - the budget can be exceeded by the evaluations of the other threads between two of their checks
+    auto BudgetExhaustedApprox() const -> bool
+    {
+        if (exhausted_.load(std::memory_order_relaxed)) { return true; }
+        auto const budget = Budget();
+        auto const last = lastTotal_.load(std::memory_order_relaxed);
+        auto const close = last >= budget - (budget / BudgetCheckSlack);
+        if (!close && budgetChecks_.AddLocal(1) % BudgetCheckInterval != 0) { return false; }
+
+        auto const stats = Stats();
+        lastTotal_.store(stats.Residual + stats.Jacobian, std::memory_order_relaxed);
+        if (BudgetExhausted()) {
+            exhausted_.store(true, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    virtual auto Stats() const -> EvaluatorStats {
+        return EvaluatorStats{
+            .Residual = ResidualEvaluations.load(),
+            .Jacobian = JacobianEvaluations.load(),
+            .Calls = CallCount.load(),
+            .CostTime = CostFunctionTime.load(),
+            .CacheHits = CacheHits.load(),
+            .CacheMisses = CacheMisses.load(),
+            .SavedJacobians = SavedJacobianEvaluations.load()
         };
     }
 
@@ -120,12 +275,21 @@ struct EvaluatorBase : public OperatorBase<Operon::Vector<Operon::Scalar>, Indiv
         JacobianEvaluations = 0;
         CallCount = 0;
         CostFunctionTime = 0;
+        CacheHits = 0;
+        CacheMisses = 0;
+        SavedJacobianEvaluations = 0;
+        exhausted_ = false;
+        lastTotal_ = 0;
     }
 
 private:
+    mutable ShardedCounter budgetChecks_{0};
+    mutable std::atomic<bool> exhausted_{false};
+    mutable std::atomic<std::size_t> lastTotal_{0}; // evaluations at the last exact check
     mutable Operon::Span<Operon::Individual const> population_;
     std::reference_wrapper<Problem> problem_;
     size_t budget_ = DefaultEvaluationBudget;
+    size_t groupSize_ = DefaultEvaluationTileSize;
 };
 
 class OPERON_EXPORT UserDefinedEvaluator : public EvaluatorBase {
@@ -155,6 +319,83 @@ private:
     std::function<typename EvaluatorBase::ReturnType(Operon::RandomGenerator*, Operon::Individual&)> fptr_; // workaround for pybind11
 };
 
+// concurrent, bounded map from a genotype fingerprint to its fitness (and the other outputs of its evaluation)
+// - a ShardedMap whose full shards are flushed (generational eviction, no bookkeeping on lookup)
+// - a capacity of zero disables the cache
+class OPERON_EXPORT FitnessCache {
+public:
+    struct Entry {
+        EvaluatorBase::ReturnType Fitness;
+        bool Recorded{false}; // the statistics were recorded (see Evaluator::SetRecordStatistics)
+        std::optional<ErrorAccumulator> Statistics;
+        Operon::Vector<Operon::Scalar> CaseErrors;
+    };
+
+    static constexpr std::size_t DefaultShardCount { ShardedMap<Entry>::DefaultShardCount };
+
+    explicit FitnessCache(std::size_t capacity = 0, std::size_t shardCount = DefaultShardCount)
+        : entries_(capacity, shardCount)
+    {
+    }
+
+    // looks up the fitness corresponding to key, returns true if found
+    auto Find(Operon::Hash key, EvaluatorBase::ReturnType& fitness) const -> bool {
+        Entry entry;
+        if (!Find(key, entry)) { return false; }
+        fitness = std::move(entry.Fitness);
+        return true;
+    }
+    auto Find(Operon::Hash key, Entry& entry) const -> bool { return Enabled() && entries_.Find(key, entry); }
+
+    auto Insert(Operon::Hash key, EvaluatorBase::ReturnType const& fitness) const -> void { Insert(key, Entry{ .Fitness = fitness }); }
+    auto Insert(Operon::Hash key, Entry entry) const -> void {
+        if (Enabled()) { entries_.Insert(key, std::move(entry)); }
+    }
+
+    auto Clear() const -> void { entries_.Clear(); }
+
+    // changing the capacity discards all cached values
+    auto SetCapacity(std::size_t capacity) -> void { entries_.SetCapacity(capacity); }
+
+    [[nodiscard]] auto Capacity() const -> std::size_t { return entries_.Capacity(); }
+    [[nodiscard]] auto Enabled() const -> bool { return Capacity() > 0; }
+    [[nodiscard]] auto Size() const -> std::size_t { return entries_.Size(); }
+
+private:
+    ShardedMap<Entry> entries_;
+};
+
+// concurrent, bounded map from a tree to its error statistics over the training rows [start, End)
+// - sharded and flushed like the FitnessCache, a capacity of zero disables it
+class OPERON_EXPORT ErrorStatisticsCache {
+public:
+    struct Entry {
+        std::size_t End{0}; // the end of the rows covered by the statistics
+        ErrorAccumulator Statistics;
+        Operon::Vector<Operon::Scalar> Cases; // the unscaled predictions on the case rows before End (see Evaluator::SetCaseSample)
+    };
+
+    explicit ErrorStatisticsCache(std::size_t capacity = 0, std::size_t shardCount = FitnessCache::DefaultShardCount)
+        : entries_(capacity, shardCount)
+    {
+    }
+
+    auto Find(Operon::Hash key, Entry& entry) const -> bool { return Enabled() && entries_.Find(key, entry); }
+    auto Insert(Operon::Hash key, Entry entry) const -> void {
+        if (Enabled()) { entries_.Insert(key, std::move(entry)); }
+    }
+    auto Clear() const -> void { entries_.Clear(); }
+
+    auto SetCapacity(std::size_t capacity) -> void { entries_.SetCapacity(capacity); }
+
+    [[nodiscard]] auto Capacity() const -> std::size_t { return entries_.Capacity(); }
+    [[nodiscard]] auto Enabled() const -> bool { return Capacity() > 0; }
+    [[nodiscard]] auto Size() const -> std::size_t { return entries_.Size(); }
+
+private:
+    ShardedMap<Entry> entries_;
+};
+
 template <typename DTable>
 class OPERON_EXPORT Evaluator : public EvaluatorBase {
     using TInterpreter = Operon::Interpreter<Operon::Scalar, DTable>;
@@ -170,15 +411,243 @@ public:
 
     auto GetDispatchTable() const { return dtable_.get(); }
 
+    // cache fitness values keyed on the strict tree hash and the coefficients of the tree (disabled by default)
+    // - the entries also hold the recorded statistics and the case errors (see SetRecordStatistics, SetCaseSample),
+    //   but not the predictions: operator() does not look up the cache when it writes them to a non-empty buffer
+    //   (without streaming)
+    auto SetCacheCapacity(std::size_t capacity) { cache_.SetCapacity(capacity); }
+    auto CacheCapacity() const { return cache_.Capacity(); }
+    auto ClearCache() const { cache_.Clear(); }
+
+    // set Individual::Semantic to the hash of the outputs of the tree on a sample of the training rows (see SemanticHash)
+    // - the rows are spread evenly over the training range, zero disables it
+    // - individuals with the same outputs on the sample are considered equivalent: only one of them is kept by
+    //   NSGA2::Sort and the SolutionArchive (they are still evaluated and cached separately)
+    // - trees that only differ outside of the sample are equivalent as well, so the sample should not be too small
+    auto SetSemanticHashing(std::size_t rows) {
+        auto const& problem = GetProblem();
+        auto const range = problem.TrainingRange();
+        rows = std::min(rows, range.Size());
+        if (rows == 0) { semantic_.reset(); return; }
+        std::vector<std::size_t> indices(rows);
+        for (auto i = 0UL; i < rows; ++i) { indices[i] = range.Start() + i * range.Size() / rows; }
+        semantic_ = problem.GetDataset().SelectRows(indices);
+    }
+    auto SemanticRows() const { return semantic_ ? semantic_->Rows<std::size_t>() : std::size_t{0}; }
+
+    // reuse the values of subtrees evaluated previously on the same thread (see SubtreeValueCache)
+    // - capacity is the maximum number of values stored per thread (zero disables the cache)
+    auto SetSubtreeCacheCapacity(std::size_t capacity) { subtreeCacheCapacity_ = capacity; }
+    auto SubtreeCacheCapacity() const { return subtreeCacheCapacity_; }
+
+    // evaluate groups of individuals as a DAG where common subexpressions are computed only once (see DagInterpreter)
+    // - this pays off when the group is large and the population has converged (e.g. combined with SetEvaluationGroupSize)
+    auto SetSubexpressionSharing(bool value) { sharing_ = value; }
+    auto SubexpressionSharing() const { return sharing_; }
+
+    // split the training range of each individual across the workers of an executor (see EvaluateRows)
+    // - only used when the training range is larger than the chunk size
+    // - the executor can be the one running the algorithm, in which case the two levels of parallelism share the same workers
+    // - the error is reduced in parallel from per-chunk statistics (see ErrorAccumulator)
+    auto SetRowParallelism(tf::Executor* executor, std::size_t rowChunk = DefaultRowChunk) { executor_ = executor; rowChunk_ = rowChunk; }
+    auto RowChunk() const { return rowChunk_; }
+
+    // accumulate the error batch by batch while the tree is evaluated, without storing the predictions
+    // - this is always done when operator() is called with an empty buffer
+    // - when enabled, the buffer passed to operator() is left untouched
+    // - not available for the scaled MAE or together with the subtree cache (the buffered path is used instead)
+    auto SetStreaming(bool value) { streaming_ = value; }
+    auto Streaming() const { return streaming_; }
+
+    // evaluate the trees in single precision on the streaming paths, the error statistics are still accumulated in double precision
+    // - roughly doubles the SIMD throughput of the interpreter when Operon::Scalar is double, at the cost of some accuracy
+    // - the buffered path (and therefore the subtree cache and the predictions written to the buffer) keeps Operon::Scalar
+    // - the default float primitives are used, callables registered in the dispatch table are ignored
+    auto SetSinglePrecision(bool value) { singlePrecision_ = value; }
+    auto SinglePrecision() const { return singlePrecision_; }
+
+    // evaluate the trees on the buffered paths with the batch size tuned for their length (see BatchSizeTuner)
+    // - the tuner is not owned and must be tuned before it is set, the streaming and row-parallel paths keep the
+    //   dispatch table of the evaluator
+    // - the tables of the tuner are used instead of the dispatch table, the callables registered in the latter are ignored
+    auto SetBatchSizeTuner(DefaultBatchSizeTuner const* tuner) { tuner_ = tuner; }
+    auto GetBatchSizeTuner() const { return tuner_; }
+
+    // with linear scaling, accumulate the error statistics while the predictions are written to the buffer
+    // - the error is derived from the moments (see ErrorAccumulator), so the buffer is not rescaled in place
+    //   and is left with the unscaled predictions
+    // - not used for the scaled MAE or together with the subtree cache
+    auto SetFusedScaling(bool value) { fusedScaling_ = value; }
+    auto FusedScaling() const { return fusedScaling_; }
+
+    // weight the error of each row by the values of a dataset variable (eg. importance sampling weights)
+    // - the weights are read directly from the dataset, the variable should not be one of the inputs
+    // - with linear scaling, the scaling parameters are fit by weighted least squares
+    // - the weighted error is not computed from the error statistics, so the streaming, fused, out-of-core,
+    //   row-parallel and bounded evaluations fall back to the buffered path
+    auto SetWeights(std::optional<Operon::Hash> variable) {
+        if (variable && !GetProblem().GetDataset().GetVariable(*variable)) {
+            throw std::invalid_argument("the weight variable does not exist in the dataset");
+        }
+        weights_ = variable;
+    }
+    auto Weights() const -> std::optional<Operon::Hash> { return weights_; }
+
+    // out-of-core evaluation of groups: Evaluate streams the rows in blocks of the given size (see StreamTiled)
+    // - the error statistics of the group are accumulated block by block and the predictions are never stored
+    // - with a memory-mapped dataset, the group reads the file once and the finished blocks are evicted,
+    //   so the dataset does not have to fit in memory (combine with a large SetEvaluationGroupSize)
+    // - zero disables it, it is not used when the error metric cannot be computed from statistics
+    auto SetBlockRows(std::size_t rows) { blockRows_ = rows; }
+    auto BlockRows() const { return blockRows_; }
+
+    // keep the error statistics of the evaluated trees, so that when rows are appended to the training range (see
+    // Problem::AppendRows) a tree evaluated before is only evaluated on the new rows
+    // - capacity is the maximum number of trees whose statistics are kept, zero disables it
+    // - the statistics are keyed on the strict tree hash (so the coefficients matter, a tree changed by the local
+    //   search is evaluated again over all the rows), the target and the start of the training range
+    // - the rows covered by the statistics must keep their values: ClearStatistics after shuffling, scaling or
+    //   replacing the data (the preprocessing of the new rows has to use the transforms of the old ones)
+    // - the error is then streamed (see SetStreaming), one individual at a time; not used for the weighted error,
+    //   the scaled MAE, the row-parallel evaluation and together with the subtree cache
+    // - the predictions are only skipped when they are not asked for: operator() with a non-empty buffer and without
+    //   streaming evaluates the tree over all the rows to write them (the algorithms pass a buffer, so enable both)
+    auto SetIncrementalStatistics(std::size_t capacity) { statistics_.SetCapacity(capacity); }
+    auto IncrementalStatistics() const { return statistics_.Capacity(); }
+    auto ClearStatistics() const { statistics_.Clear(); }
+
+    // store the error statistics of the predictions over the training range in Individual::Statistics
+    // - any error metric, with or without linear scaling, can then be computed from them without evaluating the tree
+    //   again (see ErrorMetric), eg. to rank the individuals by another metric
+    // - the statistics are not weighted (see SetWeights) and are reset for the individuals that are rejected or
+    //   whose evaluation stopped before the end of the range (see SetNonFiniteAbort)
+    // - with the buffered evaluation the statistics take one more pass over the predictions
+    auto SetRecordStatistics(bool value) { record_ = value; }
+    auto RecordStatistics() const { return record_; }
+
+    // capture the absolute errors of the predictions on a sample of the training rows in Individual::CaseErrors, for
+    // the lexicase selection (see LexicaseSelector)
+    // - rows are indices into the training range (the same rows for every individual), an empty sample disables it
+    // - the errors are taken after the linear scaling: the streaming, incremental, tiled and bounded evaluations keep
+    //   the predictions on the sample rows and scale them with the statistics of the whole range
+    // - the individuals that are rejected, whose predictions are not finite or whose bounded evaluation stopped early
+    //   get no errors
+    auto SetCaseSample(std::vector<std::size_t> rows) -> void;
+    auto CaseSample() const -> Operon::Span<std::size_t const> { return caseRows_; }
+
+    // reject the trees whose interval over the training data is not finite (see EvaluateInterval) before evaluating them
+    // - the bounds of the variables are computed over the training range when the check is enabled, and again by
+    //   Prepare when the training range changed (eg. after Problem::AppendRows)
+    // - rejected trees get the worst fitness and do not count as residual evaluations
+    // - the check is conservative and can reject trees that are finite on every row, trees with dynamic nodes are never rejected
+    // - the bounds cover the maxLag rows before the training range, for the trees with lagged variables
+    auto SetIntervalCheck(bool value, std::size_t maxLag = 0) {
+        if (!value) { bounds_.reset(); return; }
+        auto const& problem = GetProblem();
+        boundsRange_ = problem.TrainingRange();
+        boundsLag_ = maxLag;
+        bounds_ = ComputeVariableBounds(problem.GetDataset(), boundsRange_, maxLag);
+    }
+    auto IntervalCheck() const { return bounds_.has_value(); }
+
+    // stop the evaluation at the first batch of rows with a NaN or infinite output (see Interpreter::EvaluateFinite)
+    // - the fitness of such trees is the worst fitness, as it would be after the whole sweep
+    // - the buffer passed to operator() then only holds the predictions up to that batch
+    // - not used by the batch evaluation (Evaluate) and together with the subtree cache
+    auto SetNonFiniteAbort(bool value) { abort_ = value; }
+    auto NonFiniteAbort() const { return abort_; }
+
+    auto Rejects(Operon::Tree const& tree) const -> bool override {
+        if (!bounds_ || std::ranges::any_of(tree.Nodes(), [](auto const& n) { return n.Type == NodeType::Dynamic; })) { return false; }
+        return !EvaluateInterval(tree, *bounds_).Finite();
+    }
+
+    // caches the statistics of the target over the training range, used by the linear scaling
+    // - the bounds of the interval check are computed again if the training range changed (see SetIntervalCheck)
+    auto Prepare(Operon::Span<Individual const> pop) const -> void override;
+
+    [[nodiscard]] auto GetTargetStatistics() const -> TargetStatistics const& { return target_; }
+
     auto
     operator()(Operon::RandomGenerator& /*random*/, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> typename EvaluatorBase::ReturnType override;
 
+    // evaluates the trees in lockstep over row tiles (see EvaluateTiled)
+    auto Evaluate(Operon::RandomGenerator& rng, Operon::Span<Individual> individuals, Operon::Vector<Operon::Scalar>& buf) const -> void override;
+
+    // streams the error and stops once its lower bound exceeds bound (see ErrorMetric::LowerBound)
+    // - falls back to operator() when the metric does not support bounds or row-parallelism or the subtree cache are enabled
+    // - early terminated results are not stored in the fitness cache
+    auto EvaluateBounded(Operon::RandomGenerator& rng, Individual& ind, Operon::Span<Operon::Scalar> buf, Operon::Span<Operon::Scalar const> bound) const -> typename EvaluatorBase::ReturnType override;
+
+    // evaluates the error on the given subrange of the dataset (the buffer is not used)
+    auto EvaluateSubset(Operon::RandomGenerator& rng, Individual& ind, Operon::Span<Operon::Scalar> buf, Operon::Range range) const -> typename EvaluatorBase::ReturnType override;
+
+    // the error is computed from the given predictions (the fitness is stored in the cache but not looked up)
+    auto UsesPredictions() const -> bool override { return true; }
+    auto Predict(Individual const& ind, Operon::Span<Operon::Scalar> buf) const -> void override;
+    auto EvaluatePredictions(Operon::RandomGenerator& rng, Individual& ind, Operon::Span<Operon::Scalar const> predictions) const -> typename EvaluatorBase::ReturnType override;
+
 private:
+    auto ComputeFitness(Operon::Span<Operon::Scalar> estimated, Operon::Span<Operon::Scalar const> target, Operon::Span<Operon::Scalar const> weights = {}) const -> Operon::Scalar;
+    auto ComputeFitnessRows(Operon::Tree const& tree, Operon::Span<Operon::Scalar> estimated, ErrorAccumulator& stats) const -> Operon::Scalar;
+    auto ComputeFitness(ErrorAccumulator const& stats) const -> Operon::Scalar {
+        auto const fit = static_cast<Operon::Scalar>(error_(stats, scaling_));
+        return std::isfinite(fit) ? fit : EvaluatorBase::ErrMax;
+    }
+    auto CacheKey(Individual const& ind) const -> Operon::Hash;
+    // copies the outputs of a cached evaluation of ind into it, returns false if there is none
+    auto FindCached(Operon::Hash key, Individual& ind, typename EvaluatorBase::ReturnType& fitness) const -> bool;
+    auto InsertCached(Operon::Hash key, Individual const& ind, typename EvaluatorBase::ReturnType const& fitness) const -> void;
+    auto ComputeSemanticHash(Individual& ind) const -> void;
+    auto RowParallel() const -> bool { return executor_ != nullptr && !weights_ && GetProblem().TrainingRange().Size() > rowChunk_; }
+    auto SupportsStatistics() const -> bool { return !weights_ && error_.SupportsStatistics(scaling_); }
+    auto Fused() const -> bool { return fusedScaling_ && scaling_ && SupportsStatistics() && subtreeCacheCapacity_ == 0; }
+    auto Incremental() const -> bool { return statistics_.Enabled() && SupportsStatistics() && subtreeCacheCapacity_ == 0 && !RowParallel(); }
+    // the predictions written to a non-empty buffer need the tree to be evaluated over all the rows
+    auto Incremental(Operon::Span<Operon::Scalar const> buf) const -> bool { return Incremental() && (streaming_ || buf.empty()); }
+    auto IncrementalFitness(Individual& ind, Operon::Range range, Operon::Span<Operon::Scalar const> target) const -> Operon::Scalar;
+    // scaled tells whether the linear scaling was already applied to the estimated values
+    auto CaptureCaseErrors(Individual& ind, Operon::Span<Operon::Scalar const> estimated, Operon::Span<Operon::Scalar const> target, bool scaled) const -> void;
+    // from the unscaled predictions on the case rows (in the order of the sample) and the statistics of the whole range
+    auto CaptureCaseErrors(Individual& ind, Operon::Span<Operon::Scalar const> sampled, Operon::Span<Operon::Scalar const> target, ErrorAccumulator const& stats) const -> void;
+    auto Record(Individual& ind, ErrorAccumulator const& stats) const -> void {
+        if (record_ && stats.Count() == static_cast<double>(GetProblem().TrainingRange().Size())) { ind.Statistics = stats; }
+    }
+    auto WeightValues(Operon::Range range) const -> Operon::Span<Operon::Scalar const> {
+        return weights_ ? GetProblem().GetDataset().GetValues(*weights_).subspan(range.Start(), range.Size()) : Operon::Span<Operon::Scalar const>{};
+    }
+
     std::reference_wrapper<DTable const> dtable_;
     ErrorMetric error_;
     bool scaling_{false};
+    bool sharing_{false};
+    bool streaming_{false};
+    bool singlePrecision_{false};
+    bool fusedScaling_{false};
+    bool abort_{false};
+    bool record_{false};
+    std::size_t subtreeCacheCapacity_{0};
+    std::vector<std::size_t> caseRows_;
+    std::vector<std::size_t> caseOrder_;  // the positions of the sample sorted by row
+    std::vector<std::size_t> caseSorted_; // the rows of the sample in increasing order
+    Operon::Hash caseHash_{0};
+    tf::Executor* executor_{nullptr};
+    std::size_t rowChunk_{DefaultRowChunk};
+    std::size_t blockRows_{0};
+    DefaultBatchSizeTuner const* tuner_{nullptr};
+    FitnessCache cache_;
+    ErrorStatisticsCache statistics_;
+    std::optional<Operon::Dataset> semantic_;
+    mutable TargetStatistics target_;
+    std::optional<Operon::Hash> weights_;
+    mutable std::optional<VariableBounds> bounds_;
+    mutable Operon::Range boundsRange_;
+    std::size_t boundsLag_{0};
 };
 
+// concatenates the fitness values of several evaluators
+// - when at least two of them use predictions (see EvaluatorBase::UsesPredictions), the tree is interpreted once by
+//   the first of them and the others derive their fitness from the same predictions
 class MultiEvaluator : public EvaluatorBase {
 public:
     explicit MultiEvaluator(Problem& problem)
@@ -203,43 +672,64 @@ public:
         return std::transform_reduce(evaluators_.begin(), evaluators_.end(), 0UL, std::plus {}, [](auto const& eval) { return eval.get().ObjectiveCount(); });
     }
 
+    auto Rejects(Operon::Tree const& tree) const -> bool override
+    {
+        return std::ranges::any_of(evaluators_, [&](auto const& eval) { return eval.get().Rejects(tree); });
+    }
+
+    // a tree rejected by any of the evaluators (eg. over the cost limit of a CostEvaluator) has the worst fitness in all
+    // the objectives, so that it is dominated by the accepted trees
     auto
     operator()(Operon::RandomGenerator& rng, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> typename EvaluatorBase::ReturnType override
     {
+        if (Rejects(ind.Genotype)) { return EvaluatorBase::ReturnType(ObjectiveCount(), EvaluatorBase::ErrMax); }
+
         EvaluatorBase::ReturnType fit;
         fit.reserve(ind.Size());
 
+        auto const shared = std::ranges::count_if(evaluators_, [](auto const& ev) { return ev.get().UsesPredictions(); }) > 1;
+        if (!shared) {
+            for (auto const& ev : evaluators_) {
+                auto f = ev(rng, ind, buf);
+                std::copy(f.begin(), f.end(), std::back_inserter(fit));
+            }
+            return fit;
+        }
+
+        // the predictions are kept apart from buf, which the other evaluators may overwrite
+        // - pooled rather than thread-local: an evaluator that coruns (eg. row-parallel) lets the thread start another
+        //   evaluation while these predictions are still read
+        static ObjectPool<Operon::Vector<Operon::Scalar>> pool;
+        auto lease = pool.Acquire();
+        auto& predictions = *lease;
+        predictions.resize(GetProblem().TrainingRange().Size());
+        bool predicted{false};
         for (auto const& ev : evaluators_) {
-            auto f = ev(rng, ind, buf);
+            auto const& e = ev.get();
+            if (!e.UsesPredictions()) {
+                auto f = e(rng, ind, buf);
+                std::copy(f.begin(), f.end(), std::back_inserter(fit));
+                continue;
+            }
+            if (!predicted) {
+                e.Predict(ind, { predictions.data(), predictions.size() });
+                predicted = true;
+            }
+            auto f = e.EvaluatePredictions(rng, ind, { predictions.data(), predictions.size() });
             std::copy(f.begin(), f.end(), std::back_inserter(fit));
         }
-
         return fit;
     }
 
-    auto Stats() const -> std::tuple<std::size_t, std::size_t, std::size_t, std::size_t> final {
-        auto resEval{0UL};
-        auto jacEval{0UL};
-        auto callCnt{0UL};
-        auto cfTime{0UL};
-
-        for (auto const& eval : evaluators_) {
-            auto [re, je, cc, ct] = eval.get().Stats();
-            resEval += re;
-            jacEval += je;
-            callCnt += cc;
-            cfTime  += ct;
-        }
-
-        return std::tuple{resEval + ResidualEvaluations.load(),
-            jacEval + JacobianEvaluations.load(),
-            callCnt + CallCount.load(),
-            cfTime + CostFunctionTime.load()};
+    auto Stats() const -> EvaluatorStats final {
+        auto stats = EvaluatorBase::Stats();
+        for (auto const& eval : evaluators_) { stats += eval.get().Stats(); }
+        return stats;
     }
 
     auto BudgetExhausted() const -> bool final {
-        auto [re, je, cc, ct] = Stats();
-        return re + je >= Budget();
+        auto const stats = Stats();
+        return stats.Residual + stats.Jacobian >= Budget();
     }
 
     auto Evaluators() const { return evaluators_; }
@@ -248,6 +738,112 @@ private:
     std::vector<std::reference_wrapper<EvaluatorBase const>> evaluators_;
 };
 
+// scores the output of each tree against several target variables, so that a tree is only evaluated once for all of them
+// - the fitness has one value per target (in the given order), an AggregateEvaluator turns it into a single objective
+// - with linear scaling, the scaling parameters are fit for each target separately (see Scaling)
+// - the error of each target is derived from its error statistics (see ErrorAccumulator), accumulated while the
+//   output is written to the buffer (or streamed if the buffer is empty), the scaled MAE uses a scaled copy instead
+template <typename DTable>
+class OPERON_EXPORT MultiTargetEvaluator : public EvaluatorBase {
+    using TInterpreter = Operon::Interpreter<Operon::Scalar, DTable>;
+
+public:
+    MultiTargetEvaluator(Problem& problem, DTable const& dtable, std::vector<Operon::Hash> targets, ErrorMetric error = MSE{}, bool linearScaling = true)
+        : EvaluatorBase(problem)
+        , dtable_(dtable)
+        , targets_(std::move(targets))
+        , error_(error)
+        , scaling_(linearScaling)
+    {
+        if (targets_.empty()) {
+            throw std::invalid_argument("at least one target variable is required");
+        }
+        for (auto t : targets_) {
+            if (!problem.GetDataset().GetVariable(t)) {
+                throw std::invalid_argument("the target variable does not exist in the dataset");
+            }
+        }
+    }
+
+    auto GetDispatchTable() const { return dtable_.get(); }
+    auto Targets() const -> Operon::Span<Operon::Hash const> { return { targets_.data(), targets_.size() }; }
+    auto ObjectiveCount() const -> std::size_t override { return targets_.size(); }
+
+    auto
+    operator()(Operon::RandomGenerator& /*random*/, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> typename EvaluatorBase::ReturnType override;
+
+    // the linear scaling parameters (a, b) of the output of the tree for each target over the training range
+    auto Scaling(Individual const& ind) const -> std::vector<std::pair<double, double>>;
+
+private:
+    auto Accumulate(Operon::Tree const& tree, Operon::Span<Operon::Scalar> buf) const -> std::vector<ErrorAccumulator>;
+
+    std::reference_wrapper<DTable const> dtable_;
+    std::vector<Operon::Hash> targets_;
+    ErrorMetric error_;
+    bool scaling_{true};
+};
+
+// k-fold cross-validation of the output of a tree, the fitness is the mean and the variance of the fold errors
+// - the folds are ranges over the dataset of the problem (see KFold), the training range is not used
+// - the tree is evaluated once over the rows spanned by the folds and the error statistics of each fold are
+//   accumulated from the same batches (see ErrorAccumulator), the predictions are never stored
+// - with linear scaling, the scaling parameters of each fold are fit on the other folds, so the fold error is the
+//   error on unseen rows (this is why the scaled MAE, which cannot be derived from the statistics, is not supported)
+// - the variance is the sample variance of the fold errors
+template <typename DTable>
+class OPERON_EXPORT CrossValidationEvaluator : public EvaluatorBase {
+    using TInterpreter = Operon::Interpreter<Operon::Scalar, DTable>;
+
+public:
+    CrossValidationEvaluator(Problem& problem, DTable const& dtable, std::vector<Operon::Range> folds, ErrorMetric error = MSE{}, bool linearScaling = true)
+        : EvaluatorBase(problem)
+        , dtable_(dtable)
+        , folds_(std::move(folds))
+        , error_(error)
+        , scaling_(linearScaling)
+    {
+        if (folds_.size() < 2) {
+            throw std::invalid_argument("cross-validation needs at least two folds");
+        }
+        auto const rows = problem.GetDataset().template Rows<std::size_t>();
+        if (std::ranges::any_of(folds_, [&](auto const& f) { return f.Size() == 0 || f.End() > rows; })) {
+            throw std::invalid_argument("the folds must be non-empty ranges within the dataset");
+        }
+        if (!error_.SupportsStatistics(scaling_)) {
+            throw std::invalid_argument("the scaled mean absolute error is not supported by cross-validation");
+        }
+    }
+
+    // splits the range into k contiguous folds of (almost) equal size
+    static auto KFold(Operon::Range range, std::size_t k) -> std::vector<Operon::Range>
+    {
+        EXPECT(k > 0 && k <= range.Size());
+        std::vector<Operon::Range> folds;
+        folds.reserve(k);
+        for (auto i = 0UL; i < k; ++i) {
+            folds.emplace_back(range.Start() + (i * range.Size() / k), range.Start() + ((i + 1) * range.Size() / k));
+        }
+        return folds;
+    }
+
+    auto GetDispatchTable() const { return dtable_.get(); }
+    auto Folds() const -> Operon::Span<Operon::Range const> { return { folds_.data(), folds_.size() }; }
+    auto ObjectiveCount() const -> std::size_t override { return 2; }
+
+    auto
+    operator()(Operon::RandomGenerator& /*random*/, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> typename EvaluatorBase::ReturnType override;
+
+    // the error of the tree on each fold
+    auto FoldErrors(Operon::Tree const& tree) const -> std::vector<double>;
+
+private:
+    std::reference_wrapper<DTable const> dtable_;
+    std::vector<Operon::Range> folds_;
+    ErrorMetric error_;
+    bool scaling_{true};
+};
+
 class OPERON_EXPORT AggregateEvaluator final : public EvaluatorBase {
 public:
     enum class AggregateType : int { Min,
@@ -274,6 +870,51 @@ private:
     AggregateType aggtype_ { AggregateType::Mean };
 };
 
+// racing evaluator: individuals are first evaluated on a random sample of the training rows (see EvaluateSubset)
+// and only evaluated on the whole training range if their sample fitness looks competitive
+// - an individual is competitive if its sample fitness does not exceed the given quantile of the population fitness
+//   (the population is the one passed to Prepare, before the first call to Prepare every individual is competitive)
+// - the sample is a random contiguous block of rows, like GaussianLikelihood::SelectRandomRange
+// - non-competitive individuals keep their sample fitness
+// - the budget counts evaluated rows, so a sample evaluation costs a fraction of a full evaluation
+// - only meaningful for single-objective evaluators, otherwise it evaluates everything on the whole range
+class OPERON_EXPORT ProgressiveEvaluator final : public EvaluatorBase {
+public:
+    static constexpr double DefaultSampleRatio { 0.1 };
+    static constexpr double DefaultQuantile { 0.5 };
+
+    explicit ProgressiveEvaluator(EvaluatorBase& evaluator, double sampleRatio = DefaultSampleRatio, double quantile = DefaultQuantile)
+        : EvaluatorBase(evaluator.GetProblem())
+        , evaluator_(evaluator)
+        , sampleRatio_(sampleRatio)
+        , quantile_(quantile)
+    {
+    }
+
+    auto SetSampleRatio(double value) { sampleRatio_ = value; }
+    auto SampleRatio() const { return sampleRatio_; }
+    auto SetQuantile(double value) { quantile_ = value; }
+    auto Quantile() const { return quantile_; }
+
+    // number of individuals that were evaluated on the whole training range after the sample evaluation
+    mutable ShardedCounter Promotions { 0 }; // NOLINT
+
+    auto ObjectiveCount() const -> std::size_t override { return evaluator_.get().ObjectiveCount(); }
+    auto Prepare(Operon::Span<Individual const> pop) const -> void override;
+
+    auto
+    operator()(Operon::RandomGenerator& rng, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> typename EvaluatorBase::ReturnType override;
+
+private:
+    auto CountRows(std::size_t rows) const -> void;
+
+    std::reference_wrapper<EvaluatorBase const> evaluator_;
+    double sampleRatio_;
+    double quantile_;
+    mutable Operon::Scalar threshold_ { std::numeric_limits<Operon::Scalar>::max() };
+    mutable std::atomic<std::size_t> rows_ { 0 }; // not sharded, CountRows needs the previous value
+};
+
 // a couple of useful user-defined evaluators (mostly to avoid calling lambdas from python)
 // TODO: think about a better design
 class OPERON_EXPORT LengthEvaluator : public UserDefinedEvaluator {
@@ -296,6 +937,43 @@ public:
     }
 };
 
+// the estimated evaluation cost of the tree (see EvaluationCostModel) divided by maxCost, eg. as the second objective
+// of NSGA2 in place of the length
+// - with a cost limit, the trees that cost more are rejected (see Rejects), their cost is the worst fitness and a
+//   MultiEvaluator gives them the worst fitness in all the objectives
+class OPERON_EXPORT CostEvaluator : public EvaluatorBase {
+public:
+    explicit CostEvaluator(Operon::Problem& problem, EvaluationCostModel model = {}, double maxCost = 1)
+        : EvaluatorBase(problem)
+        , model_(model)
+        , maxCost_(maxCost)
+    {
+    }
+
+    auto
+    operator()(Operon::RandomGenerator& /*random*/, Individual& ind, Operon::Span<Operon::Scalar> /*buf*/) const -> typename EvaluatorBase::ReturnType override
+    {
+        ++this->CallCount;
+        auto const cost = model_(ind.Genotype);
+        if (cost > limit_) { return { EvaluatorBase::ErrMax }; }
+        return { static_cast<Operon::Scalar>(cost / maxCost_) };
+    }
+
+    auto Rejects(Operon::Tree const& tree) const -> bool override { return model_(tree) > limit_; }
+
+    // the largest cost of an accepted tree, in the units of the model (nanoseconds per row once calibrated)
+    auto SetCostLimit(double limit) -> void { limit_ = limit; }
+    [[nodiscard]] auto CostLimit() const -> double { return limit_; }
+
+    [[nodiscard]] auto CostModel() const -> EvaluationCostModel const& { return model_; }
+
+private:
+    EvaluationCostModel model_;
+    double maxCost_;
+    double limit_{std::numeric_limits<double>::infinity()};
+};
+
+// the negated mean distance to a sample of the population, the trees are compared by their fingerprints (see Fingerprint)
 class OPERON_EXPORT DiversityEvaluator : public EvaluatorBase {
 public:
     explicit DiversityEvaluator(Operon::Problem& problem, Operon::HashMode hashmode = Operon::HashMode::Strict, std::size_t sampleSize = 100)
@@ -308,10 +986,20 @@ public:
     auto
     operator()(Operon::RandomGenerator& /*random*/, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> typename EvaluatorBase::ReturnType override;
 
+    // the trees are hashed and fingerprinted in parallel when an executor is set, Prepare can be called from inside
+    // a worker of the same executor (eg. from the GP loop)
+    // - the fingerprints of the trees that were already in the previous population are reused
     auto Prepare(Operon::Span<Operon::Individual const> pop) const -> void override;
 
+    auto SetExecutor(tf::Executor* executor) const -> void { executor_ = executor; }
+    [[nodiscard]] auto Executor() const -> tf::Executor* { return executor_; }
+
 private:
-    mutable Operon::Map<Operon::Hash, std::vector<Operon::Hash>> divmap_;
+    mutable Operon::Map<Operon::Hash, Fingerprint> divmap_;
+    mutable Operon::Map<Operon::Hash, Fingerprint> previous_; // the fingerprints of the previous call to Prepare
+    mutable std::vector<Operon::Hash> hashes_;
+    mutable std::vector<std::pair<std::size_t, std::size_t>> missing_; // (individual, index in divmap_)
+    mutable tf::Executor* executor_{nullptr};
     Operon::HashMode hashmode_ { Operon::HashMode::Strict };
     std::size_t sampleSize_ {};
 };
@@ -329,6 +1017,15 @@ public:
     auto Sigma() const { return std::span<Operon::Scalar const>{sigma_}; }
     auto SetSigma(std::vector<Operon::Scalar> sigma) const { sigma_ = std::move(sigma); }
 
+    // the description length needs the jacobian, which is computed along with the predictions
+    auto UsesPredictions() const -> bool override { return false; }
+
+    // the fitness is not a plain error metric, so fall back to per-individual evaluation
+    auto Evaluate(Operon::RandomGenerator& rng, Operon::Span<Individual> individuals, Operon::Vector<Operon::Scalar>& buf) const -> void override {
+        EvaluatorBase::Evaluate(rng, individuals, buf); // NOLINT(bugprone-parent-virtual-call)
+    }
+
+    // the predictions are written to the buffer when it holds the training range
     auto operator()(Operon::RandomGenerator& /*random*/, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> typename EvaluatorBase::ReturnType override {
         ++Base::CallCount;
 
@@ -341,19 +1038,25 @@ public:
         // this call will optimize the tree coefficients and compute the SSE
         auto& tree = ind.Genotype;
         Operon::Interpreter<Operon::Scalar, DefaultDispatch> interpreter{dtable, dataset, ind.Genotype};
-        auto parameters = tree.GetCoefficients();
+        thread_local std::vector<Operon::Scalar> coefficients; // reused between the evaluations of the thread
+        auto const parameters = tree.GetCoefficients(coefficients);
 
         auto const p { static_cast<double>(parameters.size()) };
 
-        std::vector<Operon::Scalar> buffer;
-        if (buf.size() < range.Size()) {
-            buffer.resize(range.Size());
-            buf = Operon::Span<Operon::Scalar>(buffer);
-        }
-
+        // the fisher matrix and the likelihood are accumulated batch by batch in a single forward and reverse pass,
+        // without storing the jacobian
         ++Base::ResidualEvaluations;
-        interpreter.Evaluate(parameters, range, buf);
-
+        ++Base::JacobianEvaluations;
+        auto const targetValues = problem.TargetValues(range);
+        typename Lik::Matrix fisherMatrix = Lik::Matrix::Zero(std::ssize(parameters), std::ssize(parameters));
+        auto cLikelihood { 0.0 };
+        interpreter.ForEachJacobianBatch(parameters, range, [&](int64_t row, Operon::Span<Operon::Scalar const> values, Operon::Span<Operon::Scalar const> jacobian) {
+            auto const r = static_cast<std::size_t>(row);
+            if (buf.size() >= range.Size()) { std::ranges::copy(values, buf.begin() + row); }
+            auto const sigma = sigma_.size() == range.Size() ? Operon::Span<Operon::Scalar const>{sigma_}.subspan(r, values.size()) : Operon::Span<Operon::Scalar const>{sigma_};
+            if (!jacobian.empty()) { fisherMatrix += Lik::ComputeFisherMatrix(values, jacobian, sigma); }
+            cLikelihood += Lik::ComputeLikelihood(values, targetValues.subspan(r, values.size()), sigma);
+        });
 
         // codelength of the complexity
         // count number of unique functions
@@ -365,10 +1068,6 @@ public:
         auto cComplexity { 0.0 };
 
         // codelength of the parameters
-        ++Base::JacobianEvaluations;
-        Eigen::Matrix<Operon::Scalar, -1, -1> j = interpreter.JacRev(parameters, range); // jacobian
-        auto estimatedValues = buf;
-        auto fisherMatrix = Lik::ComputeFisherMatrix(estimatedValues, {j.data(), static_cast<std::size_t>(j.size())}, sigma_);
         auto fisherDiag   = fisherMatrix.diagonal().array();
         ENSURE(fisherDiag.size() == p);
 
@@ -411,8 +1110,6 @@ public:
 
         cParameters -= p/2 * std::log(3);
 
-        auto targetValues = problem.TargetValues(problem.TrainingRange());
-        auto cLikelihood  = Lik::ComputeLikelihood(estimatedValues, targetValues, sigma_);
         auto mdl = cComplexity + cParameters + cLikelihood;
         if (!std::isfinite(mdl)) { mdl = EvaluatorBase::ErrMax; }
         return typename EvaluatorBase::ReturnType { static_cast<Operon::Scalar>(mdl) };
@@ -432,8 +1129,15 @@ public:
     {
     }
 
+    // the fitness is not a plain error metric, so fall back to per-individual evaluation
+    auto Evaluate(Operon::RandomGenerator& rng, Operon::Span<Individual> individuals, Operon::Vector<Operon::Scalar>& buf) const -> void override {
+        EvaluatorBase::Evaluate(rng, individuals, buf); // NOLINT(bugprone-parent-virtual-call)
+    }
+
     auto
     operator()(Operon::RandomGenerator& /*random*/, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> typename EvaluatorBase::ReturnType override;
+
+    auto EvaluatePredictions(Operon::RandomGenerator& rng, Individual& ind, Operon::Span<Operon::Scalar const> predictions) const -> typename EvaluatorBase::ReturnType override;
 };
 
 template <typename DTable>
@@ -446,8 +1150,15 @@ public:
     {
     }
 
+    // the fitness is not a plain error metric, so fall back to per-individual evaluation
+    auto Evaluate(Operon::RandomGenerator& rng, Operon::Span<Individual> individuals, Operon::Vector<Operon::Scalar>& buf) const -> void override {
+        EvaluatorBase::Evaluate(rng, individuals, buf); // NOLINT(bugprone-parent-virtual-call)
+    }
+
     auto
     operator()(Operon::RandomGenerator& /*random*/, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> typename EvaluatorBase::ReturnType override;
+
+    auto EvaluatePredictions(Operon::RandomGenerator& rng, Individual& ind, Operon::Span<Operon::Scalar const> predictions) const -> typename EvaluatorBase::ReturnType override;
 };
 
 template<typename DTable, Concepts::Likelihood Likelihood = GaussianLikelihood<Operon::Scalar>>
@@ -461,6 +1172,11 @@ class OPERON_EXPORT LikelihoodEvaluator final : public Evaluator<DTable> {
     {
     }
 
+    // the fitness is not a plain error metric, so fall back to per-individual evaluation
+    auto Evaluate(Operon::RandomGenerator& rng, Operon::Span<Individual> individuals, Operon::Vector<Operon::Scalar>& buf) const -> void override {
+        EvaluatorBase::Evaluate(rng, individuals, buf); // NOLINT(bugprone-parent-virtual-call)
+    }
+
     auto
     operator()(Operon::RandomGenerator&  /*rng*/, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> typename EvaluatorBase::ReturnType override {
         ++Base::CallCount;
@@ -473,7 +1189,8 @@ class OPERON_EXPORT LikelihoodEvaluator final : public Evaluator<DTable> {
         // this call will optimize the tree coefficients and compute the SSE
         auto& tree = ind.Genotype;
         Operon::Interpreter<Operon::Scalar, DefaultDispatch> interpreter{dtable, dataset, ind.Genotype};
-        auto parameters = tree.GetCoefficients();
+        thread_local std::vector<Operon::Scalar> coefficients; // reused between the evaluations of the thread
+        auto const parameters = tree.GetCoefficients(coefficients);
 
         std::vector<Operon::Scalar> buffer;
         if (buf.size() < range.Size()) {
@@ -490,6 +1207,13 @@ class OPERON_EXPORT LikelihoodEvaluator final : public Evaluator<DTable> {
         return typename EvaluatorBase::ReturnType { static_cast<Operon::Scalar>(lik) };
     }
 
+    auto EvaluatePredictions(Operon::RandomGenerator& /*rng*/, Individual& /*ind*/, Operon::Span<Operon::Scalar const> predictions) const -> typename EvaluatorBase::ReturnType override {
+        ++Base::CallCount;
+        auto const targetValues = Base::GetProblem().TargetValues(Base::GetProblem().TrainingRange());
+        auto lik = Likelihood::ComputeLikelihood(predictions, targetValues, sigma_);
+        return typename EvaluatorBase::ReturnType { static_cast<Operon::Scalar>(lik) };
+    }
+
     auto Sigma() const { return std::span<Operon::Scalar const>{sigma_}; }
     auto SetSigma(std::vector<Operon::Scalar> sigma) const { sigma_ = std::move(sigma); }
 
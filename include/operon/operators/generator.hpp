@@ -4,7 +4,12 @@
 #ifndef OPERON_GENERATOR_HPP
 #define OPERON_GENERATOR_HPP
 
+#include "operon/core/comparison.hpp"
+#include "operon/core/counter.hpp"
 #include "operon/core/operator.hpp"
+#include "operon/core/pool.hpp"
+#include "operon/core/profiler.hpp"
+#include "operon/core/sharded_map.hpp"
 #include "operon/operators/crossover.hpp"
 #include "operon/operators/evaluator.hpp"
 #include "operon/operators/mutation.hpp"
@@ -40,49 +45,113 @@ public:
     [[nodiscard]] auto Evaluator() const -> EvaluatorBase& { return evaluator_.get(); }
     [[nodiscard]] auto Optimizer() const -> CoefficientOptimizer const* { return coeffOptimizer_; }
 
+    // the stages of Generate are timed when a profiler is set, the algorithms also record their own stages into it
+    auto SetProfiler(Profiler* profiler) -> void { profiler_ = profiler; }
+    [[nodiscard]] auto GetProfiler() const -> Profiler* { return profiler_; }
+
+    // a cheap evaluator (eg. on a small sample of the training rows) that screens the children before the coefficient
+    // optimizer and the evaluator run
+    // - only generators that compare the child against a bound screen it (see ScreeningBound), a child whose predicted
+    //   fitness is dominated by the bound plus tolerance times its magnitude is discarded with the predicted fitness
+    // - the surrogate has its own counters, its evaluations do not count towards the budget of the evaluator
+    auto SetSurrogate(EvaluatorBase const* surrogate, double tolerance = DefaultSurrogateTolerance) -> void { surrogate_ = surrogate; surrogateTolerance_ = tolerance; }
+    [[nodiscard]] auto Surrogate() const -> EvaluatorBase const* { return surrogate_; }
+    [[nodiscard]] auto SurrogateTolerance() const -> double { return surrogateTolerance_; }
+
+    // the number of children predicted by the surrogate and the number of those that were discarded
+    [[nodiscard]] auto ScreenedChildren() const -> uint64_t { return screened_.load(); }
+    [[nodiscard]] auto DiscardedChildren() const -> uint64_t { return discarded_.load(); }
+
+    static constexpr double DefaultSurrogateTolerance{0.1};
+
+    // simplify the children (see Tree::Simplify) before they are screened, optimized and evaluated
+    auto SetSimplify(bool simplify) -> void { simplify_ = simplify; }
+    [[nodiscard]] auto Simplify() const -> bool { return simplify_; }
+
+    // reject the children whose genotype (strict hash) is one of the parents or was already produced during the same
+    // generation, before they are screened, optimized and evaluated
+    // - a duplicate is generated again from the same parents up to retries times, after that it is kept with the
+    //   fitness of the genotype it duplicates, so that the duplicates never spend evaluation budget
+    // - the genotypes are collected in a concurrent map that does not evict (see ShardedMap), cleared and filled by
+    //   Prepare with the parents and by Generate with every evaluated child, it is sized for the parents and children
+    //   per generation (zero means as many as the parents)
+    auto SetDuplicateRejection(bool value, std::size_t retries = DefaultDuplicateRetries, std::size_t children = 0) -> void
+    {
+        rejectDuplicates_ = value;
+        duplicateRetries_ = retries;
+        duplicateChildren_ = children;
+    }
+    [[nodiscard]] auto DuplicateRejection() const -> bool { return rejectDuplicates_; }
+    [[nodiscard]] auto DuplicateRetries() const -> std::size_t { return duplicateRetries_; }
+
+    // the number of duplicate children that were rejected (including the ones that were generated again)
+    [[nodiscard]] auto RejectedDuplicates() const -> uint64_t { return duplicates_.load(); }
+
+    static constexpr std::size_t DefaultDuplicateRetries{3};
+
     virtual auto Prepare(Operon::Span<Individual const> pop) const -> void
     {
         this->FemaleSelector().Prepare(pop);
         this->MaleSelector().Prepare(pop);
         this->Evaluator().Prepare(pop);
+        genotypes_.Clear();
+        if (rejectDuplicates_) {
+            genotypes_.Reserve(pop.size() + (duplicateChildren_ == 0 ? pop.size() : duplicateChildren_));
+            for (auto const& ind : pop) { genotypes_.Insert(ind.Genotype.Hash(Operon::HashMode::Strict).HashValue(), ind.Fitness); }
+        }
     }
 
-    [[nodiscard]] virtual auto Terminate() const -> bool { return evaluator_.get().BudgetExhausted(); }
+    // called by the workers for every child, the budget check is approximate (see EvaluatorBase::BudgetExhaustedApprox)
+    [[nodiscard]] virtual auto Terminate() const -> bool { return evaluator_.get().BudgetExhaustedApprox(); }
 
-    auto Generate(Operon::RandomGenerator& random, double pCrossover, double pMutation, double pLocal, Operon::Span<Operon::Scalar> buf, RecombinationResult& res) const -> void {
-        auto pop = FemaleSelector().Population();
-        if (!res.Parent1) {
-            res.Parent1 = pop[ FemaleSelector()(random) ];
-        }
-
-        using BernoulliTrial = std::bernoulli_distribution;
-        if (BernoulliTrial{pCrossover}(random)) {
-            if (!res.Parent2) {
-                res.Parent2 = pop[ MaleSelector()(random) ];
-            }
-            res.Child = Individual{};
-            res.Child->Genotype = Crossover()(random, res.Parent1->Genotype, res.Parent2->Genotype);
-        }
+    // the outcome of GenerateUnevaluated
+    enum class Variation : uint8_t {
+        None,       // neither crossover nor mutation took place, the individual is left untouched
+        Evaluated,  // the child has a fitness: it duplicates a known genotype or it was discarded by the surrogate
+        Unevaluated // the child must still be evaluated (its fitness is the one the individual had before)
+    };
 
-        if (BernoulliTrial{pMutation}(random)) {
-            if (res.Child) {
-                res.Child->Genotype = Mutator()(random, std::move(res.Child->Genotype));
-            } else {
-                res.Child = Individual{};
-                res.Child->Genotype = Mutator()(random, res.Parent1->Genotype);
-            }
-        }
+    // writes the child into the given individual (eg. the offspring slot it will replace), reusing its node buffer
+    // - returns false if neither crossover nor mutation took place, in which case the individual is left untouched
+    // - the child must not be one of the parents in res
+    auto Generate(Operon::RandomGenerator& random, double pCrossover, double pMutation, double pLocal, Operon::Span<Operon::Scalar> buf, RecombinationResult& res, Individual& child) const -> bool {
+        auto const variation = Vary(random, pCrossover, pMutation, res, child);
+        if (variation != Variation::Unevaluated) { return variation == Variation::Evaluated; }
 
-        if (BernoulliTrial{pLocal}(random)) {
-            auto summary = (*coeffOptimizer_)(random, res.Child->Genotype);
+        if (std::bernoulli_distribution{pLocal}(random) && !Evaluator().Rejects(child.Genotype)) {
+            Profiler::Scope scope(profiler_, Stage::LocalSearch);
+            auto summary = (*coeffOptimizer_)(random, child.Genotype);
             Evaluator().ResidualEvaluations += summary.FunctionEvaluations;
             Evaluator().JacobianEvaluations += summary.JacobianEvaluations;
+            Evaluator().SavedJacobianEvaluations += summary.SavedJacobianEvaluations;
         }
 
-        res.Child->Fitness = Evaluator()(random, res.Child.value(), buf);
-        for (auto& v : res.Child->Fitness) {
+        Profiler::Scope scope(profiler_, Stage::Evaluation);
+        child.Fitness = Evaluator().EvaluateBounded(random, child, buf, FitnessBound(res));
+        for (auto& v : child.Fitness) {
             if (!std::isfinite(v)) { v = std::numeric_limits<Operon::Scalar>::max(); }
         }
+        if (rejectDuplicates_) { genotypes_.Insert(child.Genotype.Hash(Operon::HashMode::Strict).HashValue(), child.Fitness); }
+        return true;
+    }
+
+    // true if the generator keeps every child it produces whatever its fitness, so that the evaluation of the
+    // children can be left to the caller (see GenerateUnevaluated)
+    [[nodiscard]] virtual auto AcceptsEveryChild() const -> bool { return false; }
+
+    // writes the child into the given individual like Generate, without the local search and the evaluation
+    // - for the callers that optimize and evaluate the children together afterwards (eg. the batched local search of
+    //   GeneticProgrammingAlgorithm), with a generator that accepts every child
+    // - the unevaluated children are not added to the genotypes of the duplicate rejection
+    auto GenerateUnevaluated(Operon::RandomGenerator& random, double pCrossover, double pMutation, RecombinationResult& res, Individual& child) const -> Variation {
+        return Vary(random, pCrossover, pMutation, res, child);
+    }
+
+    auto Generate(Operon::RandomGenerator& random, double pCrossover, double pMutation, double pLocal, Operon::Span<Operon::Scalar> buf, RecombinationResult& res) const -> void {
+        Individual child;
+        if (Generate(random, pCrossover, pMutation, pLocal, buf, res, child)) {
+            res.Child = std::move(child);
+        }
     }
 
     auto Generate(Operon::RandomGenerator& random, double pCrossover, double pMutation, double pLocal, Operon::Span<Operon::Scalar> buf) const -> RecombinationResult {
@@ -91,13 +160,111 @@ public:
         return res;
     }
 
+    // generates an offspring into the given slot, returns false if no offspring was produced (the slot is then unchanged)
+    // - the default implementation assigns the result of operator(), generators that accept every child write into the slot directly
+    virtual auto GenerateInto(Operon::RandomGenerator& random, double pCrossover, double pMutation, double pLocal, Operon::Span<Operon::Scalar> buf, Individual& slot) const -> bool {
+        auto result = (*this)(random, pCrossover, pMutation, pLocal, buf);
+        if (result) { slot = std::move(result.value()); }
+        return result.has_value();
+    }
+
+protected:
+    // upper bound on the child fitness beyond which the child is discarded (empty means no bound)
+    // - the evaluator may stop evaluating the child once its fitness provably exceeds this bound
+    [[nodiscard]] virtual auto FitnessBound(RecombinationResult const& /*res*/) const -> Operon::Vector<Operon::Scalar> { return {}; }
+
+    // the fitness the child must not be dominated by to be kept (empty means that the children are not screened)
+    [[nodiscard]] virtual auto ScreeningBound(RecombinationResult const& /*res*/) const -> Operon::Vector<Operon::Scalar> { return {}; }
+
 private:
+    // the selection, the variation, the duplicate rejection and the screening of a child (see Generate)
+    auto Vary(Operon::RandomGenerator& random, double pCrossover, double pMutation, RecombinationResult& res, Individual& child) const -> Variation {
+        auto pop = FemaleSelector().Population();
+        if (!res.Parent1) {
+            Profiler::Scope scope(profiler_, Stage::Selection);
+            res.Parent1 = pop[ FemaleSelector()(random) ];
+        }
+
+        using BernoulliTrial = std::bernoulli_distribution;
+        for (auto attempt = 0UL;; ++attempt) {
+            auto produced{false};
+            if (BernoulliTrial{pCrossover}(random)) {
+                if (!res.Parent2) {
+                    Profiler::Scope scope(profiler_, Stage::Selection);
+                    res.Parent2 = pop[ MaleSelector()(random) ];
+                }
+                Profiler::Scope scope(profiler_, Stage::Crossover);
+                Crossover().Recombine(random, res.Parent1->Genotype, res.Parent2->Genotype, child.Genotype);
+                produced = true;
+            }
+
+            if (BernoulliTrial{pMutation}(random)) {
+                Profiler::Scope scope(profiler_, Stage::Mutation);
+                if (!produced) {
+                    auto const& nodes = res.Parent1->Genotype.Nodes();
+                    child.Genotype.Nodes().assign(nodes.begin(), nodes.end());
+                    produced = true;
+                }
+                Mutator().Mutate(random, child.Genotype);
+            }
+
+            if (!produced) { return Variation::None; }
+            child.Rank = 0;
+            child.Distance = 0;
+            child.Semantic = 0;
+            if (simplify_) { child.Genotype.Simplify(); }
+
+            if (!rejectDuplicates_ || !genotypes_.Find(child.Genotype.Hash(Operon::HashMode::Strict).HashValue(), child.Fitness)) { break; }
+            ++duplicates_;
+            if (attempt == duplicateRetries_) { return Variation::Evaluated; }
+        }
+
+        if (Discard(random, res, child)) { return Variation::Evaluated; }
+        return Variation::Unevaluated;
+    }
+
+    // predicts the fitness of the child with the surrogate, true if the child should be discarded
+    auto Discard(Operon::RandomGenerator& random, RecombinationResult const& res, Individual& child) const -> bool
+    {
+        if (surrogate_ == nullptr) { return false; }
+        auto bound = ScreeningBound(res);
+        if (bound.empty()) { return false; }
+
+        Operon::Vector<Operon::Scalar> predicted;
+        {
+            Profiler::Scope scope(profiler_, Stage::Evaluation);
+            predicted = (*surrogate_)(random, child, {});
+        }
+        ++screened_;
+        for (auto& v : predicted) {
+            if (!std::isfinite(v)) { v = std::numeric_limits<Operon::Scalar>::max(); }
+        }
+        for (auto& b : bound) {
+            b += static_cast<Operon::Scalar>(surrogateTolerance_) * std::abs(b);
+        }
+        if (Operon::ParetoDominance{}(predicted, bound) != Dominance::Right) { return false; }
+        ++discarded_;
+        child.Fitness = std::move(predicted);
+        return true;
+    }
+
     std::reference_wrapper<EvaluatorBase> evaluator_;
     std::reference_wrapper<CrossoverBase> crossover_;
     std::reference_wrapper<MutatorBase>   mutator_;
     std::reference_wrapper<SelectorBase>  femaleSelector_;
     std::reference_wrapper<SelectorBase>  maleSelector_;
     CoefficientOptimizer const*           coeffOptimizer_;
+    Profiler*                             profiler_{nullptr};
+    EvaluatorBase const*                  surrogate_{nullptr};
+    double                                surrogateTolerance_{DefaultSurrogateTolerance};
+    bool                                  simplify_{false};
+    bool                                  rejectDuplicates_{false};
+    std::size_t                           duplicateRetries_{DefaultDuplicateRetries};
+    std::size_t                           duplicateChildren_{0};
+    mutable ShardedMap<EvaluatorBase::ReturnType> genotypes_;
+    mutable ShardedCounter                screened_;
+    mutable ShardedCounter                discarded_;
+    mutable ShardedCounter                duplicates_;
 };
 
 class OPERON_EXPORT BasicOffspringGenerator final : public OffspringGeneratorBase {
@@ -107,7 +274,10 @@ public:
     {
     }
 
+    [[nodiscard]] auto AcceptsEveryChild() const -> bool override { return true; }
+
     auto operator()(Operon::RandomGenerator& random, double pCrossover, double pMutation, double pLocal, Operon::Span<Operon::Scalar> buf) const -> std::optional<Individual> final;
+    auto GenerateInto(Operon::RandomGenerator& random, double pCrossover, double pMutation, double pLocal, Operon::Span<Operon::Scalar> buf, Individual& slot) const -> bool final;
 };
 
 class OPERON_EXPORT BroodOffspringGenerator : public OffspringGeneratorBase {
@@ -123,10 +293,18 @@ public:
     void BroodSize(size_t value) { broodSize_ = value; }
     [[nodiscard]] auto BroodSize() const -> size_t { return broodSize_; }
 
+    // the members of the brood are generated and evaluated in parallel by the workers of the executor
+    // - the generator can be called from inside a worker of the same executor (eg. from the GP loop)
+    void SetExecutor(tf::Executor* executor) { executor_ = executor; }
+    [[nodiscard]] auto Executor() const -> tf::Executor* { return executor_; }
+
     static constexpr size_t DefaultBroodSize { 10 };
 
 private:
     size_t broodSize_;
+    tf::Executor* executor_{nullptr};
+    // the broods of the calls in progress, a call that another one coruns into while it waits for its members has its own
+    mutable Operon::ObjectPool<std::vector<Individual>> broods_;
 };
 
 class OPERON_EXPORT PolygenicOffspringGenerator : public OffspringGeneratorBase {
@@ -142,10 +320,18 @@ public:
     void PolygenicSize(size_t value) { broodSize_ = value; }
     [[nodiscard]] auto PolygenicSize() const -> size_t { return broodSize_; }
 
+    // the members of the brood are generated and evaluated in parallel by the workers of the executor
+    // - the generator can be called from inside a worker of the same executor (eg. from the GP loop)
+    void SetExecutor(tf::Executor* executor) { executor_ = executor; }
+    [[nodiscard]] auto Executor() const -> tf::Executor* { return executor_; }
+
     static constexpr size_t DefaultBroodSize = 10;
 
 private:
     size_t broodSize_;
+    tf::Executor* executor_{nullptr};
+    // the broods of the calls in progress, a call that another one coruns into while it waits for its members has its own
+    mutable Operon::ObjectPool<std::vector<Individual>> broods_;
 };
 
 class OPERON_EXPORT OffspringSelectionGenerator : public OffspringGeneratorBase {
@@ -163,19 +349,25 @@ public:
     void ComparisonFactor(double value) { comparisonFactor_ = value; }
     auto ComparisonFactor() const -> double { return comparisonFactor_; }
 
+    // stop evaluating a child as soon as its fitness provably exceeds the fitness it must beat to be accepted
+    void EarlyTermination(bool value) { earlyTermination_ = value; }
+    auto EarlyTermination() const -> bool { return earlyTermination_; }
+
     void Prepare(const Operon::Span<const Individual> pop) const override
     {
         OffspringGeneratorBase::Prepare(pop);
-        lastEvaluations_ = this->Evaluator().TotalEvaluations();
+        lastEvaluations_ = this->Evaluator().TotalEvaluations() + DiscardedChildren() + RejectedDuplicates();
     }
 
+    // the children discarded by the surrogate and the rejected duplicates count as evaluated, otherwise a generation
+    // in which every child is discarded would never end
     auto SelectionPressure() const -> double
     {
         auto n = this->FemaleSelector().Population().size();
         if (n == 0U) {
             return 0;
         }
-        auto e = this->Evaluator().TotalEvaluations() - lastEvaluations_;
+        auto e = this->Evaluator().TotalEvaluations() + DiscardedChildren() + RejectedDuplicates() - lastEvaluations_;
         return static_cast<double>(e) / static_cast<double>(n);
     }
 
@@ -187,10 +379,18 @@ public:
     static constexpr size_t DefaultMaxSelectionPressure { 100 };
     static constexpr double DefaultComparisonFactor { 1.0 };
 
+protected:
+    [[nodiscard]] auto FitnessBound(RecombinationResult const& res) const -> Operon::Vector<Operon::Scalar> override;
+    [[nodiscard]] auto ScreeningBound(RecombinationResult const& res) const -> Operon::Vector<Operon::Scalar> override { return ComparisonFitness(res); }
+
 private:
+    // the fitness the child is compared against
+    [[nodiscard]] auto ComparisonFitness(RecombinationResult const& res) const -> Operon::Vector<Operon::Scalar>;
+
     mutable size_t lastEvaluations_{0};
     size_t maxSelectionPressure_{DefaultMaxSelectionPressure};
     double comparisonFactor_{0};
+    bool earlyTermination_{false};
 };
 
 } // namespace Operon
@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_GPU_EVALUATOR_HPP
+#define OPERON_GPU_EVALUATOR_HPP
+
+#if defined(HAVE_CUDA)
+
+#include <functional>
+#include <vector>
+
+#include "operon/error_metrics/error_accumulator.hpp"
+#include "operon/interpreter/gpu_interpreter.hpp"
+#include "operon/operators/evaluator.hpp"
+#include "operon/operon_export.hpp"
+
+namespace Operon {
+
+// fitness evaluation on a cuda device (see GpuDataset)
+// - a group of individuals is evaluated in a single launch, only the error statistics of each tree are copied back,
+//   so the error metric must be computable from the statistics (see ErrorMetric::SupportsStatistics)
+// - the dataset of the device must hold the same values as the dataset of the problem
+// - local search can run on the device as well, with GpuLevenbergMarquardtOptimizer
+class OPERON_EXPORT GpuEvaluator : public EvaluatorBase {
+public:
+    GpuEvaluator(Problem& problem, GpuDataset const& dataset, ErrorMetric error = MSE{}, bool linearScaling = true);
+
+    auto operator()(Operon::RandomGenerator& rng, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> typename EvaluatorBase::ReturnType override;
+
+    auto Evaluate(Operon::RandomGenerator& rng, Operon::Span<Individual> individuals, Operon::Vector<Operon::Scalar>& buf) const -> void override;
+
+    // the statistics of each tree over the training range
+    [[nodiscard]] auto Statistics(Operon::Span<Individual const> individuals) const -> std::vector<ErrorAccumulator>;
+
+private:
+    std::reference_wrapper<GpuDataset const> dataset_;
+    ErrorMetric error_;
+    bool scaling_;
+};
+
+} // namespace Operon
+
+#endif
+
+#endif
@@ -4,8 +4,17 @@
 #ifndef OPERON_INITIALIZER_HPP
 #define OPERON_INITIALIZER_HPP
 
+#include <functional>
+#include <span>
+#include <vector>
+
+#include "operon/core/constants.hpp"
+#include "operon/core/contracts.hpp"
+#include "operon/core/counter.hpp"
+#include "operon/core/sharded_map.hpp"
 #include "operon/core/tree.hpp"
 #include "operon/operators/creator.hpp"
+#include "operon/random/random.hpp"
 
 namespace Operon {
 
@@ -13,6 +22,21 @@ struct CoefficientInitializerBase : public OperatorBase<void, Tree&> {
 };
 
 struct TreeInitializerBase : public OperatorBase<Tree> {
+    static constexpr size_t DefaultGroupSize = 64; // number of trees initialized together by the algorithms
+
+    // initializes a group of trees, trees[i] with the random generator rngs[i]
+    // - the default implementation calls operator() for each tree
+    virtual auto Initialize(Operon::Span<Operon::RandomGenerator> rngs, Operon::Span<Tree> trees) const -> void
+    {
+        EXPECT(rngs.size() >= trees.size());
+        for (auto i = 0UL; i < trees.size(); ++i) {
+            trees[i] = (*this)(rngs[i]);
+        }
+    }
+
+    // discards the state kept between the trees (eg. the genotypes of UniqueTreeInitializer), called by the
+    // algorithms before they initialize a population
+    virtual auto Reset() const -> void { }
 };
 
 template <typename Dist>
@@ -29,12 +53,22 @@ struct OPERON_EXPORT CoefficientInitializer : public CoefficientInitializerBase
     {
     }
 
+    // the values of the selected nodes are drawn together (see Random::Draw) into a buffer reused by the thread
     auto operator()(Operon::RandomGenerator& random, Operon::Tree& tree) const -> void override
     {
-        for (auto& node : tree.Nodes()) {
-            if (callback_(node)) {
-                node.Value = Dist(params_)(random);
-            }
+        thread_local std::vector<size_t> indices;
+        thread_local std::vector<typename Dist::result_type> values;
+
+        auto& nodes = tree.Nodes();
+        indices.clear();
+        for (auto i = 0UL; i < nodes.size(); ++i) {
+            if (callback_(nodes[i])) { indices.push_back(i); }
+        }
+        values.resize(indices.size());
+        Dist dist(params_);
+        Operon::Random::Draw(random, dist, std::span{values});
+        for (auto i = 0UL; i < indices.size(); ++i) {
+            nodes[indices[i]].Value = static_cast<Operon::Scalar>(values[i]);
         }
     }
 
@@ -62,6 +96,17 @@ struct OPERON_EXPORT TreeInitializer : public TreeInitializerBase {
         return creator_(random, targetLen, minDepth_, maxDepth_); // initialize tree
     }
 
+    // the lengths are drawn first, then the creator builds the group in one call
+    auto Initialize(Operon::Span<Operon::RandomGenerator> rngs, Operon::Span<Tree> trees) const -> void override
+    {
+        EXPECT(rngs.size() >= trees.size());
+        std::vector<size_t> lengths(trees.size());
+        for (auto i = 0UL; i < trees.size(); ++i) {
+            lengths[i] = std::max(size_t { 1 }, static_cast<size_t>(std::round(Dist(params_)(rngs[i]))));
+        }
+        creator_.get().Create(rngs, lengths, minDepth_, maxDepth_, trees);
+    }
+
     template <typename... Args>
     auto ParameterizeDistribution(Args... args) const -> void
     {
@@ -86,6 +131,72 @@ private:
     size_t maxDepth_ { DefaultMaxDepth };
 };
 
+// initializes trees with another initializer but rejects the duplicates, so that the individuals of the initial
+// population have distinct genotypes and no evaluation is wasted on copies (eg. small balanced trees)
+// - the genotypes are compared by hash, by default relaxed since the coefficients are usually initialized afterwards
+// - a duplicate is created again up to retries times (with the same random generator), after which it is kept
+// - the hashes are stored in a concurrent set (see ShardedSet), so that the groups of the population can be initialized in parallel,
+//   with more than one thread the trees that get retried depend on the order of the insertions
+// - Reset clears the set, the algorithms call it before they initialize a population
+class UniqueTreeInitializer : public TreeInitializerBase {
+public:
+    static constexpr std::size_t DefaultRetries { 10 };
+
+    explicit UniqueTreeInitializer(TreeInitializerBase const& initializer, std::size_t retries = DefaultRetries, Operon::HashMode mode = Operon::HashMode::Relaxed)
+        : initializer_(initializer)
+        , retries_(retries)
+        , mode_(mode)
+    {
+    }
+
+    auto operator()(Operon::RandomGenerator& random) const -> Operon::Tree override
+    {
+        auto tree = initializer_.get()(random);
+        Deduplicate(random, tree);
+        return tree;
+    }
+
+    auto Initialize(Operon::Span<Operon::RandomGenerator> rngs, Operon::Span<Tree> trees) const -> void override
+    {
+        initializer_.get().Initialize(rngs, trees);
+        for (auto i = 0UL; i < trees.size(); ++i) {
+            Deduplicate(rngs[i], trees[i]);
+        }
+    }
+
+    auto Reset() const -> void override
+    {
+        hashes_.Clear();
+        rejected_.store(0);
+    }
+
+    // the number of duplicates that were created again, and the number of trees in the set
+    [[nodiscard]] auto Rejected() const -> std::size_t { return rejected_.load(); }
+    [[nodiscard]] auto Size() const -> std::size_t { return hashes_.Size(); }
+
+    [[nodiscard]] auto Retries() const -> std::size_t { return retries_; }
+
+private:
+    auto Insert(Operon::Tree const& tree) const -> bool
+    {
+        return hashes_.TryInsert(tree.Hash(mode_).HashValue());
+    }
+
+    auto Deduplicate(Operon::RandomGenerator& random, Operon::Tree& tree) const -> void
+    {
+        for (auto attempt = 0UL; !Insert(tree) && attempt < retries_; ++attempt) {
+            rejected_.fetch_add(1);
+            tree = initializer_.get()(random);
+        }
+    }
+
+    std::reference_wrapper<TreeInitializerBase const> initializer_;
+    std::size_t retries_;
+    Operon::HashMode mode_;
+    ShardedSet hashes_;
+    mutable ShardedCounter rejected_;
+};
+
 // wraps a creator and generates trees from a given size distribution
 using UniformCoefficientInitializer = CoefficientInitializer<std::uniform_real_distribution<Operon::Scalar>>;
 using NormalCoefficientInitializer = CoefficientInitializer<std::normal_distribution<Operon::Scalar>>;
@@ -12,23 +12,62 @@ namespace Operon {
 
 // forward declarations
 class Tree;
+struct Individual;
 class OptimizerBase;
+class SolverStateCache;
 struct OptimizerSummary;
 
 class OPERON_EXPORT CoefficientOptimizer : public OperatorBase<OptimizerSummary, Operon::Tree&> {
 public:
+    static constexpr double DefaultAdaptiveTolerance{1e-3};
+
     explicit CoefficientOptimizer(OptimizerBase const& optimizer, double lmProb = 1.0)
         : optimizer_(optimizer)
         , lamarckianProbability_(lmProb)
     { }
 
+    [[nodiscard]] auto Optimizer() const -> OptimizerBase const& { return optimizer_.get(); }
+
     // convenience
     auto operator()(Operon::RandomGenerator& rng, Operon::Tree& tree) const -> OptimizerSummary override;
 
+    // adaptive iteration budget (disabled when step is zero)
+    // - the optimizer runs in rounds of step iterations, up to optimizer.Iterations() in total
+    // - the search stops after a round whose relative cost reduction is below tolerance (or which converged before its end)
+    // - the next round gets twice as many iterations if the reduction was larger than ten times the tolerance
+    // - the iterations not spent are reported as SavedJacobianEvaluations
+    auto SetAdaptiveIterations(std::size_t step, double tolerance) -> void { adaptiveStep_ = step; adaptiveTolerance_ = tolerance; }
+    [[nodiscard]] auto AdaptiveStep() const -> std::size_t { return adaptiveStep_; }
+    [[nodiscard]] auto AdaptiveTolerance() const -> double { return adaptiveTolerance_; }
+
+    // warm start from the best coefficients known for the structure of the tree (disabled by default)
+    // - needs the state cache of the optimizer (see OptimizerBase::SetStateCache), which keeps for each structure the
+    //   coefficients with the lowest cost found so far (see SolverStateCache::Key), across generations
+    // - a tree with a known structure is optimized from the cached coefficients instead of its own, which the cached
+    //   ones replace even if the optimizer does not improve them
+    // - once an optimization from the cached coefficients reduces the cost by less than the adaptive tolerance, the
+    //   structure is converged: its trees receive the cached coefficients without running the optimizer (the
+    //   iterations not spent are reported as SavedJacobianEvaluations)
+    // - the costs are only comparable for a fixed training range, the state cache must be cleared when it changes
+    auto SetStructureWarmStart(bool enabled) -> void { structureWarmStart_ = enabled; }
+    [[nodiscard]] auto StructureWarmStart() const -> bool { return structureWarmStart_; }
+
+    // optimizes a group of individuals on the calling thread, largest trees first (so that the interpreter buffers are only grown once)
+    // - the trees of the same structure are optimized one after the other, so that they warm start from each other
+    // - the returned summary only holds the total function and jacobian evaluations
+    auto operator()(Operon::RandomGenerator& rng, Operon::Span<Operon::Individual> individuals) const -> OptimizerSummary;
+
 private:
+    auto Optimize(Operon::RandomGenerator& rng, Operon::Tree const& tree) const -> OptimizerSummary;
+    auto OptimizeAdaptive(Operon::RandomGenerator& rng, Operon::Tree const& tree) const -> OptimizerSummary;
+    auto OptimizeWarm(Operon::RandomGenerator& rng, Operon::Tree const& tree, SolverStateCache const& cache) const -> OptimizerSummary;
+    [[nodiscard]] auto Cache() const -> SolverStateCache const*;
 
     std::reference_wrapper<Operon::OptimizerBase const> optimizer_;
     double lamarckianProbability_{1.0};
+    std::size_t adaptiveStep_{0};
+    double adaptiveTolerance_{DefaultAdaptiveTolerance};
+    bool structureWarmStart_{false};
 };
 
 } // namespace Operon
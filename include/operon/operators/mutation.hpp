@@ -4,9 +4,11 @@
 #ifndef OPERON_MUTATION_HPP
 #define OPERON_MUTATION_HPP
 
+#include <algorithm>
 #include <cstddef>
 #include <utility>
 #include <functional>
+#include <span>
 #include <vector>
 
 #include "operon/operon_export.hpp"
@@ -25,6 +27,12 @@ struct CreatorBase;
 
 // the mutator can work in place or return a copy (child)
 struct MutatorBase : public OperatorBase<Tree, Tree> {
+    // mutates the tree in place, keeping its node vector when the mutation allows it
+    // - the default implementation moves the tree through operator()
+    virtual auto Mutate(Operon::RandomGenerator& random, Tree& tree) const -> void
+    {
+        tree = (*this)(random, std::move(tree));
+    }
 };
 
 template<typename Dist>
@@ -52,12 +60,18 @@ struct OPERON_EXPORT OnePointMutation : public MutatorBase {
 
 template<typename Dist>
 struct OPERON_EXPORT MultiPointMutation : public MutatorBase {
+    // the perturbations of all the leaves are drawn together (see Random::Draw) into a buffer reused by the thread
     auto operator()(Operon::RandomGenerator& random, Tree tree) const -> Tree override
     {
-        for (auto& node : tree.Nodes()) {
-            if (node.IsLeaf()) {
-                node.Value += Dist(params_)(random);
-            }
+        thread_local std::vector<typename Dist::result_type> values;
+
+        auto& nodes = tree.Nodes();
+        values.resize(static_cast<size_t>(std::count_if(nodes.begin(), nodes.end(), [](auto const& n) { return n.IsLeaf(); })));
+        Dist dist(params_);
+        Operon::Random::Draw(random, dist, std::span{values});
+        auto i = 0UL;
+        for (auto& node : nodes) {
+            if (node.IsLeaf()) { node.Value += static_cast<Operon::Scalar>(values[i++]); }
         }
         return tree;
     }
@@ -134,6 +148,8 @@ private:
     PrimitiveSet pset_;
 };
 
+// the subtree mutations (insert, replace, remove) splice the nodes of a tree that is not shared in place and only
+// update the metadata of the spliced nodes and their ancestors, a shared tree is copied once (without the old subtree)
 struct OPERON_EXPORT InsertSubtreeMutation final : public MutatorBase {
     InsertSubtreeMutation(CreatorBase& creator, CoefficientInitializerBase& coeffInit, size_t maxDepth, size_t maxLength)
         : creator_(creator)
@@ -10,12 +10,19 @@
 
 // aggregate performancae statistics such as sort duration
 #include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+// forward declaration
+namespace tf { class Executor; }
 
 namespace Operon {
 
 enum EfficientSortStrategy : int { Binary, Sequential };
 
-class NondominatedSorterBase {
+class OPERON_EXPORT NondominatedSorterBase {
 public:
     using Result = std::vector<std::vector<size_t>>;
 
@@ -39,6 +46,23 @@ public:
     {
         return Sort(pop, eps);
     }
+
+    // the sorters that support it (DominanceDegreeSorter, RankIntersectSorter) split their work between the workers of the executor
+    // - the result is the same as with the serial sort
+    // - Sort can be called from inside a worker of the same executor (eg. from the NSGA2 loop)
+    // - workers limits the chunks to that many workers of the executor (zero means all of them), eg. the active
+    //   workers of a run (see GeneticAlgorithmBase::SetWorkerLimit)
+    auto SetExecutor(tf::Executor* executor, std::size_t workers = 0) const -> void { executor_ = executor; workers_ = workers; }
+    [[nodiscard]] auto Executor() const -> tf::Executor* { return executor_; }
+    [[nodiscard]] auto Workers() const -> std::size_t { return workers_; }
+
+protected:
+    // calls func(begin, end) for one contiguous chunk of [0, n) per (allowed) worker, or func(0, n) without an executor
+    auto ForEachChunk(std::size_t n, std::function<void(std::size_t, std::size_t)> const& func) const -> void;
+
+private:
+    mutable tf::Executor* executor_{nullptr};
+    mutable std::size_t workers_{0};
 };
 
 struct OPERON_EXPORT DeductiveSorter : public NondominatedSorterBase {
@@ -77,5 +101,59 @@ struct OPERON_EXPORT BestOrderSorter : public NondominatedSorterBase {
     auto Sort(Operon::Span<Operon::Individual const> pop, Operon::Scalar eps) const -> NondominatedSorterBase::Result override;
 };
 
+// efficient non-dominated sort with insertion into existing fronts
+// - Sort inserts the individuals one by one (like EfficientSequentialSorter for a lexicographically sorted population)
+// - Insert updates the fronts of the other individuals of pop with the given indices: the solutions dominated by
+//   an inserted individual move one front down, which can cascade to the following fronts
+// - used by NSGA2 to add the offspring to the fronts of the parents instead of sorting the whole population again
+struct OPERON_EXPORT IncrementalSorter : public NondominatedSorterBase {
+    auto Sort(Operon::Span<Operon::Individual const> pop, Operon::Scalar eps) const -> NondominatedSorterBase::Result override;
+    auto Insert(Operon::Span<Operon::Individual const> pop, NondominatedSorterBase::Result& fronts, Operon::Span<size_t const> indices, Operon::Scalar eps) const -> void;
+};
+
+// sweep over the lexicographically sorted population for exactly two objectives, in O(n log n)
+// - with eps > 0 (Bi and Tri) the sweep does not apply and the population is sorted with DominanceDegreeSorter
+struct OPERON_EXPORT BiObjectiveSorter : public NondominatedSorterBase {
+    auto Sort(Operon::Span<Operon::Individual const> pop, Operon::Scalar eps) const -> NondominatedSorterBase::Result override;
+};
+
+// sweep for exactly three objectives, each front keeps its staircase in the last two objectives in a balanced tree
+// - O(n log n log k) for k fronts
+struct OPERON_EXPORT TriObjectiveSorter : public NondominatedSorterBase {
+    auto Sort(Operon::Span<Operon::Individual const> pop, Operon::Scalar eps) const -> NondominatedSorterBase::Result override;
+};
+
+// chooses one of the sorters at runtime from the size of the population, the number of objectives and the tie ratio
+// - the tie ratio is the mean share of repeated values per objective (eg. the length objective of GP only takes a few
+//   distinct values), estimated on a sample of the population
+// - two and three objectives are always sorted with BiObjectiveSorter and TriObjectiveSorter
+// - otherwise, the first population of each shape (size rounded up to a power of two, objectives, tie ratio in tenths)
+//   is sorted with every candidate and the fastest one is kept for that shape, the populations larger than the
+//   calibration limit use RS
+// - the candidates are RS, RO, MNDS, ENS-BS and ENS-SS (the others are much slower on GP populations) and they use the
+//   executor of the adaptive sorter
+// - Sort can be called concurrently, the calibrated choices are guarded by a mutex (a shape that is calibrated by two
+//   calls at once keeps the choice of the last one)
+struct OPERON_EXPORT AdaptiveSorter : public NondominatedSorterBase {
+    static constexpr std::size_t DefaultCalibrationLimit{20'000};
+
+    explicit AdaptiveSorter(std::size_t calibrationLimit = DefaultCalibrationLimit);
+
+    auto Sort(Operon::Span<Operon::Individual const> pop, Operon::Scalar eps) const -> NondominatedSorterBase::Result override;
+
+    // the sorter that is used for the given population (the fixed rule if its shape was not calibrated yet)
+    [[nodiscard]] auto Choice(Operon::Span<Operon::Individual const> pop) const -> NondominatedSorterBase const&;
+    [[nodiscard]] static auto TieRatio(Operon::Span<Operon::Individual const> pop) -> double;
+
+private:
+    [[nodiscard]] static auto Shape(Operon::Span<Operon::Individual const> pop) -> std::uint64_t;
+    [[nodiscard]] auto Rule(Operon::Span<Operon::Individual const> pop) const -> std::size_t;
+
+    std::vector<std::unique_ptr<NondominatedSorterBase>> sorters_;
+    std::size_t limit_;
+    mutable Operon::Map<std::uint64_t, std::size_t> choice_; // index of the fastest sorter for each shape
+    mutable std::mutex mutex_;                                // guards choice_
+};
+
 } // namespace Operon
 #endif
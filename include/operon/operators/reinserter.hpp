@@ -5,26 +5,90 @@
 #define OPERON_REINSERTER_HPP
 
 #include <algorithm>
+#include <numeric>
+#include <utility>
+#include <vector>
+#include "operon/core/fitness_matrix.hpp"
 #include "operon/core/operator.hpp"
 #include "operon/core/individual.hpp"
+#include "operon/core/permutation.hpp"
 
 namespace Operon {
+namespace detail {
+    // the comparison on indices with ties broken by index, so that the unstable algorithms (nth_element) are
+    // deterministic and prefer the lower indices
+    template<typename Less>
+    auto Strict(Less&& less)
+    {
+        return [less = std::forward<Less>(less)](size_t i, size_t j) {
+            if (less(i, j)) { return true; }
+            return !less(j, i) && i < j;
+        };
+    }
+} // namespace detail
+
 class ReinserterBase : public OperatorBase<void, Operon::Span<Individual>, Operon::Span<Individual>> {
 public:
     explicit ReinserterBase(ComparisonCallback cb)
         : comp_(std::move(cb))
+        , order_(FitnessComparison::FromCallback(comp_))
+    {
+    }
+
+    // if the comparison is one of the known functors, the individuals are sorted by index on a fitness matrix
+    // and then moved into place, instead of being compared through the callback (see FitnessComparison)
+    inline void Sort(Operon::Span<Individual> inds) const
     {
+        if (!order_) {
+            std::stable_sort(inds.begin(), inds.end(), comp_);
+            return;
+        }
+        FitnessMatrix const fitness(inds);
+        Permute(inds, SortedIndices(fitness));
     }
 
-    inline void Sort(Operon::Span<Individual> inds) const { std::stable_sort(inds.begin(), inds.end(), comp_); }
+    // moves the best k individuals to the front, in no particular order (linear on average instead of a sort)
+    inline void Partition(Operon::Span<Individual> inds, size_t k) const
+    {
+        if (k == 0 || k >= inds.size()) { return; }
+        std::vector<size_t> indices(inds.size());
+        std::iota(indices.begin(), indices.end(), size_t{0});
+        auto const nth = indices.begin() + static_cast<std::ptrdiff_t>(k);
+        if (Order()) {
+            FitnessMatrix const fitness(inds);
+            std::nth_element(indices.begin(), nth, indices.end(), detail::Strict([&](auto i, auto j) { return order_(fitness, i, j); }));
+        } else {
+            std::nth_element(indices.begin(), nth, indices.end(), detail::Strict([&](auto i, auto j) { return comp_(inds[i], inds[j]); }));
+        }
+        Permute(inds, indices);
+    }
 
     [[nodiscard]] inline auto Compare(Individual const& lhs, Individual const& rhs) const -> bool
     {
         return comp_(lhs, rhs);
     }
 
+protected:
+    [[nodiscard]] auto Order() const -> FitnessComparison const& { return order_; }
+
+    // the positions of the individuals in sorted order
+    [[nodiscard]] auto SortedIndices(FitnessMatrix const& fitness) const -> std::vector<size_t>
+    {
+        std::vector<size_t> indices(fitness.Rows());
+        std::iota(indices.begin(), indices.end(), size_t{0});
+        std::stable_sort(indices.begin(), indices.end(), [&](auto i, auto j) { return order_(fitness, i, j); });
+        return indices;
+    }
+
+    // moves the individual at position indices[i] to position i
+    static auto Permute(Operon::Span<Individual> inds, std::vector<size_t> const& indices) -> void
+    {
+        ApplyPermutation(inds, Operon::Span<size_t const>(indices));
+    }
+
 private:
     ComparisonCallback comp_;
+    FitnessComparison order_;
 };
 
 class OPERON_EXPORT KeepBestReinserter : public ReinserterBase {
@@ -36,6 +100,27 @@ public:
     // keep the best |pop| individuals from pop+pool
     void operator()(Operon::RandomGenerator& /*random*/, Operon::Span<Individual> pop, Operon::Span<Individual> pool) const override
     {
+        if (Order()) {
+            // the merge below compares the individuals before the swaps, so it can use the fitness matrices taken before sorting
+            FitnessMatrix const fpop(pop);
+            FitnessMatrix const fpool(pool);
+            auto const ipop = SortedIndices(fpop);
+            auto const ipool = SortedIndices(fpool);
+            Permute(pop, ipop);
+            Permute(pool, ipool);
+
+            size_t i = 0;
+            size_t j = 0;
+            while (i < pool.size() && j < pop.size()) {
+                if (Order()(fpool, ipool[i], fpop, ipop[j])) {
+                    std::swap(pool[i], pop[j]);
+                    ++i;
+                }
+                ++j;
+            }
+            return;
+        }
+
         // sort the population and the recombination pool
         Sort(pop);
         Sort(pool);
@@ -53,6 +138,55 @@ public:
     }
 };
 
+// keeps the best |pop| individuals from pop+pool without sorting them
+// - the best individuals are found with nth_element over the indices of pop+pool, when pop and pool are tied
+//   the individual of pop is kept
+// - unlike the merge of KeepBestReinserter, an individual of pop displaced by one of pool is still compared
+//   with the others, so the kept individuals are exactly the best |pop| ones
+// - only the rejected individuals of pop are swapped with the kept individuals of pool, the other individuals do
+//   not move and the population is not left in sorted order
+class OPERON_EXPORT SelectBestReinserter : public ReinserterBase {
+public:
+    explicit SelectBestReinserter(ComparisonCallback const& cb)
+        : ReinserterBase(cb)
+    {
+    }
+
+    void operator()(Operon::RandomGenerator& /*random*/, Operon::Span<Individual> pop, Operon::Span<Individual> pool) const override
+    {
+        if (pop.empty() || pool.empty()) { return; }
+        auto const n = pop.size();
+
+        // the indices below n are the individuals of pop, the others the individuals of pool
+        std::vector<size_t> indices(n + pool.size());
+        std::iota(indices.begin(), indices.end(), size_t{0});
+        auto const mid = indices.begin() + static_cast<std::ptrdiff_t>(n);
+
+        if (Order()) {
+            FitnessMatrix const fpop(pop);
+            FitnessMatrix const fpool(pool);
+            std::nth_element(indices.begin(), mid, indices.end(), detail::Strict([&](auto i, auto j) {
+                return Order()(i < n ? fpop : fpool, i < n ? i : i - n, j < n ? fpop : fpool, j < n ? j : j - n);
+            }));
+        } else {
+            auto const get = [&](auto i) -> Individual const& { return i < n ? pop[i] : pool[i - n]; };
+            std::nth_element(indices.begin(), mid, indices.end(), detail::Strict([&](auto i, auto j) { return Compare(get(i), get(j)); }));
+        }
+
+        // pair the kept individuals of pool with the rejected individuals of pop
+        auto kept = indices.begin();
+        auto rejected = mid;
+        while (true) {
+            kept = std::find_if(kept, mid, [n](auto i) { return i >= n; });
+            if (kept == mid) { break; }
+            rejected = std::find_if(rejected, indices.end(), [n](auto i) { return i < n; });
+            std::swap(pop[*rejected], pool[*kept - n]);
+            ++kept;
+            ++rejected;
+        }
+    }
+};
+
 class OPERON_EXPORT ReplaceWorstReinserter : public ReinserterBase {
 public:
     explicit ReplaceWorstReinserter(ComparisonCallback const& cb)
@@ -62,13 +196,14 @@ public:
     // replace the worst individuals in pop with the best individuals from pool
     void operator()(Operon::RandomGenerator& /*random*/, Operon::Span<Individual> pop, Operon::Span<Individual> pool) const override
     {
-        // typically the pool and the population are the same size
+        // typically the pool and the population are the same size, otherwise only the individuals that are
+        // replaced (or the ones that replace them) need to be separated from the others
+        auto offset = static_cast<std::ptrdiff_t>(std::min(pop.size(), pool.size()));
         if (pop.size() > pool.size()) {
-            Sort(pop);
+            Partition(pop, pop.size() - pool.size());
         } else if (pop.size() < pool.size()) {
-            Sort(pool);
+            Partition(pool, pop.size());
         }
-        auto offset = static_cast<std::ptrdiff_t>(std::min(pop.size(), pool.size()));
         std::swap_ranges(pool.begin(), pool.begin() + offset, pop.end() - offset);
     }
 };
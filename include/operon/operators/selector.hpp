@@ -4,8 +4,17 @@
 #ifndef OPERON_SELECTOR_HPP
 #define OPERON_SELECTOR_HPP
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <vector>
+
+#include "operon/core/contracts.hpp"
+#include "operon/core/fitness_matrix.hpp"
 #include "operon/core/individual.hpp"
 #include "operon/core/operator.hpp"
+#include "operon/random/random.hpp"
 
 namespace Operon {
 // the selector a vector of individuals and returns the index of a selected individual per each call of operator()
@@ -21,17 +30,22 @@ public:
 
     explicit SelectorBase(ComparisonCallback&& cb)
         : comp_(std::move(cb))
+        , order_(FitnessComparison::FromCallback(comp_))
     {
     }
 
     explicit SelectorBase(ComparisonCallback cb)
         : comp_(std::move(cb))
+        , order_(FitnessComparison::FromCallback(comp_))
     {
     }
 
+    // if the comparison is one of the known functors, the fitness of the population is copied into a fitness matrix,
+    // so that comparing two individuals by index reads contiguous values (see FitnessComparison)
     virtual void Prepare(Operon::Span<Individual const> pop) const
     {
         this->population_ = Operon::Span<const Individual>(pop);
+        if (order_) { fitness_.Assign(pop); }
     };
 
     auto Population() const -> Operon::Span<Individual const> { return population_; }
@@ -41,9 +55,22 @@ public:
         return comp_(lhs, rhs);
     }
 
+    // compares the individuals at positions i and j in the population
+    [[nodiscard]] inline auto Compare(size_t i, size_t j) const -> bool
+    {
+        return order_ ? order_(fitness_, i, j) : comp_(population_[i], population_[j]);
+    }
+
+protected:
+    // the fitness matrix is only assigned if the comparison is recognized (see Prepare)
+    [[nodiscard]] auto Fitness() const -> FitnessMatrix const& { return fitness_; }
+    [[nodiscard]] auto Order() const -> FitnessComparison const& { return order_; }
+
 private:
     mutable Operon::Span<const Individual> population_;
+    mutable FitnessMatrix fitness_;
     ComparisonCallback comp_;
+    FitnessComparison order_;
 };
 
 
@@ -68,6 +95,46 @@ private:
     size_t tournamentSize_;
 };
 
+// tournament selection with all the tournaments of a generation played at once in Prepare
+// - Prepare plays BatchSize tournaments (twice the population size by default, about one per selection) and
+//   operator() hands out their winners in order through an atomic cursor, the next batch is played when it runs out
+// - the tournaments are independent and each winner is handed out once, so an individual is selected with the same
+//   probability as with TournamentSelector and the selection pressure is preserved, a call costs an atomic increment
+// - for a single objective the tournaments are played in blocks over the contiguous fitness values, with
+//   branchless comparisons that the compiler vectorizes
+// - the contestants are drawn in bulk with a generator owned by the selector (see SetSeed), advanced by every batch,
+//   the caller's random generator is not used
+class OPERON_EXPORT BatchTournamentSelector : public SelectorBase {
+public:
+    explicit BatchTournamentSelector(ComparisonCallback&& cb) : SelectorBase(cb) { }
+    explicit BatchTournamentSelector(ComparisonCallback const& cb) : SelectorBase(cb) { }
+
+    auto operator()(Operon::RandomGenerator& random) const -> size_t override;
+
+    void Prepare(Operon::Span<Individual const> pop) const override;
+
+    void SetTournamentSize(size_t size) { tournamentSize_ = size; }
+    auto GetTournamentSize() const -> size_t { return tournamentSize_; }
+
+    void SetBatchSize(size_t size) { batchSize_ = size; } // zero means twice the population size
+    auto GetBatchSize() const -> size_t { return batchSize_; }
+
+    void SetSeed(uint64_t seed) { random_ = Random::RomuTrioX<>(seed); }
+
+    static constexpr size_t DefaultTournamentSize = 5;
+
+private:
+    // plays the tournaments of a batch into the winners (which may be read concurrently, see operator())
+    void Play() const;
+
+    size_t tournamentSize_{DefaultTournamentSize};
+    size_t batchSize_{0};
+    mutable Random::RomuTrioX<> random_{0}; // the contestants are drawn in blocks
+    mutable std::vector<size_t> winners_;
+    mutable std::atomic<size_t> cursor_{0}; // the next winner handed out
+    mutable std::mutex mutex_; // serializes the batches played by operator()
+};
+
 class OPERON_EXPORT RankTournamentSelector : public SelectorBase {
 public:
     explicit RankTournamentSelector(ComparisonCallback&& cb) : SelectorBase(cb){ } 
@@ -102,11 +169,43 @@ public:
 private:
     void Prepare() const; 
 
-    // discrete CDF of the population fitness values
-    mutable std::vector<std::pair<Operon::Scalar, size_t>> fitness_;
+    // discrete CDF of the weights (vmax - f) of the individuals, in population order
+    // - the CDF does not need to be sorted, a selection is a binary search over it
+    mutable std::vector<Operon::Scalar> cdf_;
     size_t idx_ = 0;
 };
 
+// epsilon-lexicase selection on a random subset of the cases (rows) drawn again by every Prepare
+// - the errors of the cases are the ones captured by the evaluator (see Individual::CaseErrors and
+//   Evaluator::SetCaseSample), the individuals without errors lose every case
+// - Prepare draws CaseCount cases among the captured ones (all of them if zero) and copies their errors into a
+//   column-major matrix with one column per case, so that the filtering of a case reads contiguous values
+// - a selection goes through the cases in a random order and keeps the candidates within epsilon of the best error
+//   on the case, the epsilon of a case is the median absolute deviation of its errors over the population
+//   (La Cava et al., "Epsilon-lexicase selection for regression", GECCO 2016); the last candidates are drawn uniformly
+// - the candidates are filtered with a branchless compaction, operator() can be called from several threads
+class OPERON_EXPORT LexicaseSelector : public SelectorBase {
+public:
+    auto operator()(Operon::RandomGenerator& random) const -> size_t override;
+
+    void Prepare(Operon::Span<Individual const> pop) const override;
+
+    void SetCaseCount(size_t count) { caseCount_ = count; } // zero means all the captured cases
+    auto GetCaseCount() const -> size_t { return caseCount_; }
+
+    void SetSeed(uint64_t seed) { random_ = Random::RomuTrioX<>(seed); }
+
+    // n distinct rows out of [0, rows) in increasing order, eg. the case sample of the evaluator
+    static auto SampleCases(Operon::RandomGenerator& random, size_t rows, size_t n) -> std::vector<size_t>;
+
+private:
+    size_t caseCount_{0};
+    mutable Random::RomuTrioX<> random_{0}; // draws the cases of a generation
+    mutable std::vector<Operon::Scalar> errors_; // population size x cases, column-major
+    mutable std::vector<Operon::Scalar> epsilon_; // per case
+    mutable size_t cases_{0};
+};
+
 class OPERON_EXPORT RandomSelector : public SelectorBase {
 public:
     auto operator()(Operon::RandomGenerator& random) const -> size_t override
@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_OPERATORS_THROUGHPUT_HPP
+#define OPERON_OPERATORS_THROUGHPUT_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <string>
+
+#include "operon/operators/evaluator.hpp"
+#include "operon/operon_export.hpp"
+
+// evaluation throughput derived from the evaluator counters, for sizing jobs and watching running ones
+// - a snapshot is taken by the caller, typically once per generation from the report callback of an algorithm
+// - the rates are computed over the interval since the previous snapshot
+// - the rows are estimated as the number of evaluations times the size of the training range, so evaluations on
+//   a subset of the training range (eg. mini-batches) are overestimated
+namespace Operon {
+
+struct ThroughputSnapshot {
+    std::size_t Generation{0};
+    double Elapsed{0};  // seconds since the monitor was created or reset
+    double Interval{0}; // seconds since the previous snapshot
+
+    // the counters of the evaluator (see EvaluatorBase::Stats)
+    uint64_t ResidualEvaluations{0};
+    uint64_t JacobianEvaluations{0};
+    uint64_t CallCount{0};
+    uint64_t CacheHits{0};
+    uint64_t CacheMisses{0};
+    uint64_t Budget{0};
+    std::size_t Rows{0}; // rows per evaluation
+
+    // rates since the previous snapshot
+    double EvaluationsPerSecond{0};
+    double RowsPerSecond{0};
+    double JacobianRowsPerSecond{0};
+    double CacheHitRate{0}; // fraction of the cache lookups that hit, zero without lookups
+
+    [[nodiscard]] auto Evaluations() const -> uint64_t { return ResidualEvaluations + JacobianEvaluations; }
+
+    // fraction of the evaluation budget spent
+    [[nodiscard]] auto BudgetUsed() const -> double
+    {
+        return Budget == 0 ? 0.0 : static_cast<double>(Evaluations()) / static_cast<double>(Budget);
+    }
+};
+
+class OPERON_EXPORT ThroughputMonitor {
+    using Clock = std::chrono::steady_clock;
+
+public:
+    // the rates of the first snapshot are relative to the counters at construction (eg. after resuming a run)
+    explicit ThroughputMonitor(EvaluatorBase const& evaluator);
+
+    auto Sample(std::size_t generation) -> ThroughputSnapshot const&;
+    auto Reset() -> void;
+
+    [[nodiscard]] auto Last() const -> ThroughputSnapshot const& { return last_; }
+
+private:
+    auto Read() const -> ThroughputSnapshot;
+
+    std::reference_wrapper<EvaluatorBase const> evaluator_;
+    Clock::time_point start_;
+    Clock::time_point time_; // of the last snapshot
+    ThroughputSnapshot last_;
+};
+
+// writes the snapshot in the OpenMetrics text format (also accepted by prometheus)
+OPERON_EXPORT auto WriteOpenMetrics(std::ostream& os, ThroughputSnapshot const& snapshot) -> void;
+
+// replaces the file atomically, so that a scraper (eg. the textfile collector of the node exporter) never reads a partial file
+OPERON_EXPORT auto WriteOpenMetrics(std::string const& path, ThroughputSnapshot const& snapshot) -> void;
+
+} // namespace Operon
+
+#endif
@@ -0,0 +1,195 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_OPTIMIZER_BATCH_SAMPLER_HPP
+#define OPERON_OPTIMIZER_BATCH_SAMPLER_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "operon/core/contracts.hpp"
+#include "operon/core/range.hpp"
+#include "operon/core/types.hpp"
+
+namespace Operon {
+
+// - contiguous: a single random block of batch size rows (the default)
+// - shuffled: the training range is split into blocks of rows which are visited in a random order, reshuffled every
+//   epoch (every row is seen once per epoch)
+// - stratified: the training range is split into as many strata as there are blocks in a batch and one block is drawn
+//   from each stratum (every part of a time series is represented in every batch)
+enum class BatchSampling : int { Contiguous, Shuffled, Stratified };
+
+// how the minibatches of the gradient based optimizers are drawn (see BatchSampler)
+// - the batch size grows by a constant factor after every batch (geometric schedule, one keeps it constant) and by the
+//   adaptive factor whenever the norm test fails (zero disables the test)
+struct BatchSchedule {
+    static constexpr std::size_t DefaultBlockSize{64};
+
+    BatchSampling Sampling{BatchSampling::Contiguous};
+    std::size_t BlockSize{DefaultBlockSize};
+    double Growth{1};
+    double NormTest{0};
+    double AdaptiveGrowth{2};
+};
+
+// selects the rows of the minibatches of GaussianLikelihood, PoissonLikelihood and MinibatchGradient
+// - a batch is a list of disjoint ranges of rows sorted by their start (the interpreter evaluates one range at a time)
+// - the norm test of Byrd et al. (2012) grows the batch when the variance of the gradient estimate is large compared
+//   to its squared norm: the variance is estimated from the stream of observed minibatch gradients (with exponential
+//   forgetting), since the per-row gradients are never materialized
+class BatchSampler {
+public:
+    static constexpr auto Forgetting{0.9};
+    static constexpr std::size_t MinObservations{4};
+
+    BatchSampler(Operon::RandomGenerator& rng, Operon::Range range, std::size_t batchSize, BatchSchedule schedule = {})
+        : rng_(rng)
+        , range_(range)
+        , schedule_(schedule)
+        , batchSize_(static_cast<double>(batchSize == 0 ? range.Size() : std::min(batchSize, range.Size())))
+    {
+        EXPECT(schedule_.BlockSize > 0);
+        EXPECT(schedule_.Growth >= 1 && schedule_.AdaptiveGrowth >= 1);
+    }
+
+    // starts over with the given schedule and the current batch size
+    auto SetSchedule(BatchSchedule const& schedule) -> void
+    {
+        EXPECT(schedule.BlockSize > 0);
+        EXPECT(schedule.Growth >= 1 && schedule.AdaptiveGrowth >= 1);
+        schedule_ = schedule;
+        blocks_.clear();
+        cursor_ = 0;
+        offset_ = 0;
+        Reset(0);
+    }
+
+    // the ranges of the next batch
+    auto Next() -> Operon::Span<Operon::Range const>
+    {
+        auto const n = range_.Size();
+        auto const bs = BatchSize();
+        ranges_.clear();
+
+        if (bs >= n) {
+            ranges_.push_back(range_);
+        } else if (schedule_.Sampling == BatchSampling::Contiguous) {
+            auto s = std::uniform_int_distribution<std::size_t>{0UL, n - bs}(rng_.get());
+            ranges_.emplace_back(range_.Start() + s, range_.Start() + s + bs);
+        } else if (schedule_.Sampling == BatchSampling::Stratified) {
+            auto const k = std::max(std::size_t{1}, (bs + schedule_.BlockSize - 1) / schedule_.BlockSize);
+            for (auto i = 0UL; i < k; ++i) {
+                auto const lo = n * i / k;
+                auto const hi = n * (i + 1) / k;
+                auto const len = std::min(bs / k + static_cast<std::size_t>(i < bs % k), hi - lo);
+                auto s = std::uniform_int_distribution<std::size_t>{lo, hi - len}(rng_.get());
+                ranges_.emplace_back(range_.Start() + s, range_.Start() + s + len);
+            }
+        } else {
+            auto const b = schedule_.BlockSize;
+            if (blocks_.empty()) {
+                blocks_.resize((n + b - 1) / b);
+                std::iota(blocks_.begin(), blocks_.end(), 0UL);
+            }
+            // a block that does not fit into the batch is continued by the next one
+            for (auto rows = 0UL; rows < bs;) {
+                if (cursor_ == 0 && offset_ == 0) { std::ranges::shuffle(blocks_, rng_.get()); }
+                auto const s = blocks_[cursor_] * b + offset_;
+                auto const e = std::min(s - offset_ + b, n);
+                auto const len = std::min(e - s, bs - rows);
+                ranges_.emplace_back(range_.Start() + s, range_.Start() + s + len);
+                rows += len;
+                offset_ += len;
+                if (s + len == e) {
+                    offset_ = 0;
+                    cursor_ = (cursor_ + 1) % blocks_.size();
+                }
+            }
+            // adjacent blocks are merged into a single range, as well as a block drawn again after a reshuffle
+            std::ranges::sort(ranges_, std::less{}, &Operon::Range::Start);
+            auto out = 0UL;
+            for (auto i = 1UL; i < ranges_.size(); ++i) {
+                if (ranges_[out].End() >= ranges_[i].Start()) {
+                    ranges_[out] = Operon::Range{ranges_[out].Start(), std::max(ranges_[out].End(), ranges_[i].End())};
+                } else {
+                    ranges_[++out] = ranges_[i];
+                }
+            }
+            ranges_.resize(out + 1);
+        }
+
+        ++batches_;
+        for (auto const& r : ranges_) { rows_ += r.Size(); }
+        batchSize_ = std::min(batchSize_ * schedule_.Growth, static_cast<double>(n));
+        return ranges_;
+    }
+
+    // updates the statistics of the norm test with the gradient of the last batch
+    template<typename T>
+    auto Observe(Operon::Span<T const> gradient) -> void
+    {
+        if (schedule_.NormTest <= 0 || gradient.empty() || BatchSize() >= range_.Size()) { return; }
+        if (mean_.size() != gradient.size()) { Reset(gradient.size()); }
+
+        constexpr auto a{Forgetting};
+        if (observations_++ == 0) {
+            std::ranges::transform(gradient, mean_.begin(), [](auto g) { return static_cast<double>(g); });
+            return;
+        }
+        for (auto i = 0UL; i < gradient.size(); ++i) {
+            auto const g = static_cast<double>(gradient[i]);
+            auto const d = g - mean_[i];
+            mean_[i] += (1 - a) * d;
+            var_[i] = a * (var_[i] + (1 - a) * d * d);
+        }
+
+        if (observations_ < MinObservations) { return; }
+        auto const variance = std::reduce(var_.begin(), var_.end());
+        auto const norm = std::transform_reduce(mean_.begin(), mean_.end(), 0.0, std::plus{}, [](auto m) { return m * m; });
+        if (!(variance <= schedule_.NormTest * schedule_.NormTest * norm)) {
+            batchSize_ = std::min(batchSize_ * schedule_.AdaptiveGrowth, static_cast<double>(range_.Size()));
+            Reset(gradient.size());
+        }
+    }
+
+    [[nodiscard]] auto BatchSize() const -> std::size_t { return std::max(std::size_t{1}, static_cast<std::size_t>(std::lround(batchSize_))); }
+    [[nodiscard]] auto Batches() const -> std::size_t { return batches_; }
+    [[nodiscard]] auto RowsSampled() const -> std::size_t { return rows_; }
+    [[nodiscard]] auto Schedule() const -> BatchSchedule const& { return schedule_; }
+
+private:
+    auto Reset(std::size_t n) -> void
+    {
+        mean_.assign(n, 0.0);
+        var_.assign(n, 0.0);
+        observations_ = 0;
+    }
+
+    std::reference_wrapper<Operon::RandomGenerator> rng_;
+    Operon::Range range_;
+    BatchSchedule schedule_;
+    double batchSize_;
+    std::vector<Operon::Range> ranges_;
+
+    // shuffled blocks
+    std::vector<std::size_t> blocks_;
+    std::size_t cursor_{0};
+    std::size_t offset_{0}; // rows of the current block already sampled
+
+    // norm test
+    std::vector<double> mean_;
+    std::vector<double> var_;
+    std::size_t observations_{0};
+
+    std::size_t batches_{0};
+    std::size_t rows_{0};
+};
+
+} // namespace Operon
+
+#endif
@@ -13,16 +13,30 @@
 
 
 #include "operon/core/contracts.hpp"
+#include "operon/core/pool.hpp"
 
 namespace Operon {
+
+// the buffers of a cost function whose scalar type is not double, reused across evaluations (and across cost functions)
+template <typename Scalar>
+struct CostFunctionBuffers {
+    Eigen::Matrix<Scalar, -1, 1> Parameters;
+    Eigen::Matrix<Scalar, -1, 1> Residuals;
+    Eigen::Matrix<Scalar, -1, -1> Jacobian; // column-major, like the jacobian computed by the interpreter
+};
+
+// bridges a cost functor (see LMCostFunction) to ceres
+// - ceres expects a row-major jacobian: when the functor computes it in this format in double precision the ceres
+//   buffers are passed through, otherwise the values are cast (and transposed) from the given buffers
+// - the buffers only grow, so evaluating a cost function of the same size does not allocate
 template <typename CostFunctor>
 struct DynamicCostFunction final : public ceres::DynamicCostFunction {
     using Scalar = typename CostFunctor::Scalar;
 
-    explicit DynamicCostFunction(CostFunctor const& cf)
+    explicit DynamicCostFunction(CostFunctor const& cf, CostFunctionBuffers<Scalar>* buffers = nullptr)
         : cf_(cf)
+        , buffers_(buffers == nullptr ? &own_ : buffers)
     {
-        static_assert(CostFunctor::Storage == Eigen::RowMajor, "Operon::DynamicCostFunction requires row-major storage.");
         this->mutable_parameter_block_sizes()->push_back(cf_.NumParameters());
         set_num_residuals(cf_.NumResiduals());
 
@@ -30,45 +44,52 @@ struct DynamicCostFunction final : public ceres::DynamicCostFunction {
         ENSURE(cf_.NumResiduals() > 0);
     }
 
+    DynamicCostFunction(DynamicCostFunction const&) = delete;
+    DynamicCostFunction(DynamicCostFunction&&) = delete;
+    auto operator=(DynamicCostFunction const&) -> DynamicCostFunction& = delete;
+    auto operator=(DynamicCostFunction&&) -> DynamicCostFunction& = delete;
+    ~DynamicCostFunction() override = default;
+
     // required by ceres
     auto Evaluate(double const* const* parameters, double* residuals, double** jacobians) const -> bool override
     {
         EXPECT(parameters != nullptr && parameters[0] != nullptr);
+        auto* jacobian = jacobians == nullptr ? nullptr : jacobians[0];
 
-        if constexpr (std::is_same_v<Scalar, double>) {
-            if (jacobians != nullptr) { EXPECT(jacobians[0] != nullptr); }
-            return cf_(parameters[0], residuals, jacobians == nullptr ? nullptr : jacobians[0]);
+        if constexpr (std::is_same_v<Scalar, double> && CostFunctor::Storage == Eigen::RowMajor) {
+            return cf_(parameters[0], residuals, jacobian);
         } else {
-            // we need to make a copy
             int const nr = this->num_residuals();
             int const np = this->parameter_block_sizes().front();
 
-            ENSURE(nr > 0);
-            ENSURE(np > 0);
+            auto& [param, resid, jacob] = *buffers_;
+            param.resize(np);
+            param = Eigen::Map<Eigen::Matrix<double, -1, 1> const>(parameters[0], np).template cast<Scalar>();
 
-            Eigen::Map<const Eigen::Matrix<double, -1, 1>> pMap(parameters[0], np);
-            Eigen::Map<Eigen::Matrix<double, -1, 1>> rMap(residuals, nr);
+            // the residuals are always requested by ceres together with the jacobian
+            Scalar* r = nullptr;
+            if (residuals != nullptr) {
+                if constexpr (std::is_same_v<Scalar, double>) { r = residuals; } else { resid.resize(nr); r = resid.data(); }
+            }
+            Scalar* j = nullptr;
+            if (jacobian != nullptr) {
+                jacob.resize(nr, np);
+                j = jacob.data();
+            }
 
-            Eigen::Matrix<Scalar, -1, 1> param = pMap.cast<Scalar>();
-            Eigen::Matrix<Scalar, -1, 1> resid(nr);
+            if (!cf_(param.data(), r, j)) {
+                return false;
+            }
 
-            if (jacobians == nullptr) {
-                auto success = cf_(param.data(), resid.data(), nullptr);
-                if (!success) {
-                    return false;
-                }
-            } else {
-                Eigen::Matrix<Scalar, -1, -1, CostFunctor::Storage> jacob(nr, np);
-                auto success = cf_(param.data(), resid.data(), jacob.data());
-                if (!success) {
-                    return false;
+            if constexpr (!std::is_same_v<Scalar, double>) {
+                if (residuals != nullptr) {
+                    Eigen::Map<Eigen::Matrix<double, -1, 1>>(residuals, nr) = resid.template cast<double>();
                 }
-
-                Eigen::Map<Eigen::Matrix<double, -1, -1, CostFunctor::Storage>> jMap(jacobians[0], nr, np);
-                jMap = jacob.template cast<double>();
             }
-            rMap = resid.template cast<double>();
-
+            if (jacobian != nullptr) {
+                Eigen::Map<Eigen::Matrix<Scalar, -1, -1, CostFunctor::Storage> const> src(j, nr, np);
+                Eigen::Map<Eigen::Matrix<double, -1, -1, Eigen::RowMajor>>(jacobian, nr, np) = src.template cast<double>();
+            }
             return true;
         }
     }
@@ -88,6 +109,65 @@ struct DynamicCostFunction final : public ceres::DynamicCostFunction {
 
 private:
     CostFunctor cf_;
+    CostFunctionBuffers<Scalar> own_;
+    CostFunctionBuffers<Scalar>* buffers_;
+};
+
+// the ceres objects of one levenberg-marquardt optimization, held until the lease is released and then reused by the
+// next one (see ObjectPool, a thread that coruns can start another optimization while one is in progress)
+// - the problem does not take ownership of the cost functions (they live on the stack of the optimizer) and
+//   removes a parameter block (together with its residual block) in constant time
+// - the parameter and cost function buffers only grow
+template <typename Scalar>
+struct CeresSolverContext {
+    CeresSolverContext()
+        : Problem(ProblemOptions())
+    {
+        Options.linear_solver_type = ceres::DENSE_QR;
+        Options.logging_type = ceres::LoggingType::SILENT;
+        Options.minimizer_progress_to_stdout = false;
+        Options.num_threads = 1;
+        Options.trust_region_strategy_type = ceres::LEVENBERG_MARQUARDT;
+        Options.use_inner_iterations = false;
+    }
+
+    static auto ProblemOptions() -> ceres::Problem::Options {
+        ceres::Problem::Options options;
+        options.cost_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+        options.enable_fast_removal = true;
+        return options;
+    }
+
+    static auto Acquire() -> typename ObjectPool<CeresSolverContext>::Lease {
+        static ObjectPool<CeresSolverContext> pool;
+        return pool.Acquire();
+    }
+
+    // adds the residual block of the parameters to the problem and removes it (with the parameter block) when
+    // destroyed, also when the solver throws, so that the context goes back to the pool without it
+    class ResidualBlock {
+    public:
+        ResidualBlock(ceres::Problem& problem, ceres::CostFunction* cost, double* parameters)
+            : problem_(problem), parameters_(parameters)
+        {
+            problem_.AddResidualBlock(cost, nullptr, parameters_);
+        }
+
+        ResidualBlock(ResidualBlock const&) = delete;
+        ResidualBlock(ResidualBlock&&) = delete;
+        auto operator=(ResidualBlock const&) -> ResidualBlock& = delete;
+        auto operator=(ResidualBlock&&) -> ResidualBlock& = delete;
+        ~ResidualBlock() { problem_.RemoveParameterBlock(parameters_); }
+
+    private:
+        ceres::Problem& problem_;
+        double* parameters_;
+    };
+
+    ceres::Problem Problem;
+    ceres::Solver::Options Options;
+    Eigen::VectorXd Parameters;
+    CostFunctionBuffers<Scalar> Buffers;
 };
 } // namespace Operon
 #endif
@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_OPTIMIZER_GPU_HPP
+#define OPERON_OPTIMIZER_GPU_HPP
+
+#if defined(HAVE_CUDA)
+
+#include "operon/interpreter/gpu_interpreter.hpp"
+#include "optimizer.hpp"
+
+namespace Operon {
+
+// levenberg-marquardt (tiny solver) with the residuals and the jacobian computed on the device
+// - the solver itself runs on the host, only the predictions and the jacobian are copied back at each iteration
+struct GpuLevenbergMarquardtOptimizer final : public OptimizerBase {
+    GpuLevenbergMarquardtOptimizer(GpuDataset const& dataset, Problem const& problem)
+        : OptimizerBase{problem}, dataset_{dataset}
+    {
+    }
+
+    using OptimizerBase::Optimize;
+
+    [[nodiscard]] auto Optimize(Operon::RandomGenerator& /*unused*/, Operon::Tree const& tree, std::size_t iterations) const -> OptimizerSummary final
+    {
+        auto const& problem = this->GetProblem();
+        auto range  = problem.TrainingRange();
+        auto target = problem.TargetValues(range);
+
+        Operon::GpuInterpreter interpreter{dataset_.get(), tree};
+        Operon::LMCostFunction cf{interpreter, target, range};
+        ceres::TinySolver<decltype(cf)> solver;
+        solver.options.max_num_iterations = static_cast<int>(iterations);
+
+        auto x0 = tree.GetCoefficients();
+        OptimizerSummary summary;
+        summary.InitialParameters = x0;
+        auto m0 = Eigen::Map<Eigen::Matrix<Operon::Scalar, Eigen::Dynamic, 1>>(x0.data(), x0.size());
+        if (!x0.empty()) {
+            typename decltype(solver)::Parameters p = m0.cast<typename decltype(cf)::Scalar>();
+            solver.Solve(cf, &p);
+            m0 = p.template cast<Operon::Scalar>();
+        }
+        summary.FinalParameters = x0;
+        summary.InitialCost = solver.summary.initial_cost;
+        summary.FinalCost = solver.summary.final_cost;
+        summary.Iterations = solver.summary.iterations;
+        summary.FunctionEvaluations = solver.summary.iterations;
+        summary.Success = detail::CheckSuccess(summary.InitialCost, summary.FinalCost);
+        return summary;
+    }
+
+    [[nodiscard]] auto ComputeLikelihood(Operon::Span<Operon::Scalar const> x, Operon::Span<Operon::Scalar const> y, Operon::Span<Operon::Scalar const> w) const -> Operon::Scalar final
+    {
+        return GaussianLikelihood<Operon::Scalar>::ComputeLikelihood(x, y, w);
+    }
+
+    [[nodiscard]] auto ComputeFisherMatrix(Operon::Span<Operon::Scalar const> pred, Operon::Span<Operon::Scalar const> jac, Operon::Span<Operon::Scalar const> sigma) const -> Eigen::Matrix<Operon::Scalar, -1, -1> final {
+        return GaussianLikelihood<Operon::Scalar>::ComputeFisherMatrix(pred, jac, sigma);
+    }
+
+private:
+    std::reference_wrapper<GpuDataset const> dataset_;
+};
+
+} // namespace Operon
+
+#endif
+
+#endif
@@ -11,7 +11,9 @@
 #include "operon/core/concepts.hpp"
 #include "operon/core/types.hpp"
 #include "operon/interpreter/interpreter.hpp"
+#include "kernels.hpp"
 #include "likelihood_base.hpp"
+#include "operon/optimizer/batch_sampler.hpp"
 
 namespace Operon {
 
@@ -35,13 +37,11 @@ template<typename T = Operon::Scalar>
 struct GaussianLikelihood : public LikelihoodBase<T> {
     GaussianLikelihood(Operon::RandomGenerator& rng, InterpreterBase<T> const& interpreter, Operon::Span<Operon::Scalar const> target, Operon::Range const range, std::size_t const batchSize = 0)
         : LikelihoodBase<T>(interpreter)
-        , rng_(rng)
         , target_{target.data(), std::ssize(target)}
         , range_{range}
-        , bs_{batchSize == 0 ? range.Size() : batchSize}
         , np_{static_cast<std::size_t>(interpreter.GetTree().CoefficientsCount())}
         , nr_{range_.Size()}
-        , jac_{bs_, np_}
+        , sampler_{rng, range, batchSize}
     { }
 
     using Scalar   = typename LikelihoodBase<T>::Scalar;
@@ -52,26 +52,47 @@ struct GaussianLikelihood : public LikelihoodBase<T> {
     using Matrix   = typename LikelihoodBase<T>::Matrix;
 
     // this loss can be used by the SGD or LBFGS optimizers
+    // - the gradient is the product of the residuals with the jacobian, computed batch by batch (see InterpreterBase::Vjp)
+    // - the rows are drawn by the batch sampler, one range at a time
     auto operator()(Cref x, Ref grad) const noexcept -> Operon::Scalar final {
         ++feval_;
         auto const& interpreter = this->GetInterpreter();
         Operon::Span<Operon::Scalar const> c{x.data(), static_cast<std::size_t>(x.size())};
-        auto range = SelectRandomRange();
-        auto primal = interpreter.Evaluate(c, range);
-        auto target = target_.segment(range.Start(), range.Size());
-        Eigen::Map<Eigen::Array<Scalar, -1, 1> const> primalMap{primal.data(), std::ssize(primal)};
-        auto e = primalMap - target;
+        auto const ranges = sampler_.Next();
+        Operon::Scalar loss{0};
 
         if (grad.size() != 0) {
             assert(grad.size() == x.size());
             ++jeval_;
-            interpreter.JacRev(c, range, {jac_.data(), np_ * bs_});
-            grad = (e.matrix().asDiagonal() * jac_.matrix()).colwise().sum();
+            if (ranges.size() > 1) { grad.setZero(); partial_.resize(std::ssize(grad)); }
+            for (auto const& range : ranges) {
+                auto target = target_.segment(range.Start() - range_.Start(), range.Size());
+                Operon::Span<Scalar> g{ranges.size() > 1 ? partial_.data() : grad.data(), np_};
+                loss += interpreter.Vjp(c, range, [&](int64_t row, Operon::Span<Scalar const> values, Operon::Span<Scalar> residual) {
+                    Eigen::Map<Eigen::Array<Scalar, -1, 1> const> primal{values.data(), std::ssize(values)};
+                    Eigen::Map<Eigen::Array<Scalar, -1, 1>> e{residual.data(), std::ssize(residual)};
+                    e = primal - target.segment(row, std::ssize(values));
+                    return static_cast<Scalar>(e.square().sum()) * Scalar{0.5};
+                }, g);
+                if (ranges.size() > 1) { grad += partial_; }
+            }
+            sampler_.Observe(Operon::Span<Scalar const>{grad.data(), np_});
+            return loss;
         }
 
-        return static_cast<Operon::Scalar>(e.square().sum()) * Operon::Scalar{0.5};
+        for (auto const& range : ranges) {
+            auto target = target_.segment(range.Start() - range_.Start(), range.Size());
+            if (primal_.size() < std::ssize(target)) { primal_.resize(std::ssize(target)); }
+            interpreter.Evaluate(c, range, {primal_.data(), range.Size()});
+            auto e = primal_.head(std::ssize(target)) - target;
+            loss += static_cast<Operon::Scalar>(e.square().sum()) * Operon::Scalar{0.5};
+        }
+        return loss;
     }
 
+    auto SetBatchSchedule(BatchSchedule const& schedule) -> void { sampler_.SetSchedule(schedule); }
+    [[nodiscard]] auto Sampler() const -> BatchSampler const& { return sampler_; }
+
     static auto ComputeLikelihood(Span<Scalar const> x, Span<Scalar const> y, Span<Scalar const> s) noexcept -> Scalar {
         EXPECT(!s.empty());
         static_assert(std::is_arithmetic_v<Scalar>);
@@ -85,15 +106,11 @@ struct GaussianLikelihood : public LikelihoodBase<T> {
         }
 
         if (s.size() == x.size()) {
-            auto const t = std::sqrt(Operon::Math::Tau);
-            auto sum{0.0};
-            for (auto i = 0; i < n; ++i) {
-                auto const si{ s[i] };
-                auto const ei{ x[i] - y[i] };
-                auto const pi{ ei / si };
-                sum += std::log(si * t) + z * pi * pi;
-            }
-            return sum;
+            // sum log(s_i * sqrt(tau)) + 0.5 * ((x_i - y_i) / s_i)^2, with the log computed by the math backend
+            using Map = Eigen::Map<Eigen::Array<Scalar, -1, 1> const>;
+            auto const e = ((Map(x.data(), n) - Map(y.data(), n)) / Map(s.data(), n)).template cast<double>();
+            auto const sum = static_cast<double>(n) * std::log(std::sqrt(Operon::Math::Tau)) + detail::LikelihoodKernels<Scalar>::SumLog(s) + z * e.square().sum();
+            return static_cast<Scalar>(sum);
         }
 
         return std::numeric_limits<Operon::Scalar>::quiet_NaN();
@@ -123,19 +140,13 @@ struct GaussianLikelihood : public LikelihoodBase<T> {
     auto JacobianEvaluations() const -> std::size_t { return jeval_; }
 
 private:
-    auto SelectRandomRange() const -> Operon::Range {
-        if (bs_ >= range_.Size()) { return range_; }
-        auto s = std::uniform_int_distribution<std::size_t>{0UL, range_.Size()-bs_}(rng_.get());
-        return Operon::Range{range_.Start() + s, range_.Start() + s + bs_};
-    }
-
-    std::reference_wrapper<Operon::RandomGenerator> rng_;
     Eigen::Map<Eigen::Array<Operon::Scalar, -1, 1> const> target_;
     Operon::Range const range_; // range of the training data NOLINT
-    std::size_t bs_; // batch size
     std::size_t np_; // number of parameters to optimize
     std::size_t nr_; // number of data points (rows)
-    mutable Eigen::Array<Scalar, -1, -1> jac_;
+    mutable BatchSampler sampler_;
+    mutable Eigen::Array<Scalar, -1, 1> primal_;
+    mutable Vector partial_; // gradient of one range of the batch
     mutable std::size_t feval_{};
     mutable std::size_t jeval_{};
 };
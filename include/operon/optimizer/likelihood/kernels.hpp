@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_LIKELIHOOD_KERNELS_HPP
+#define OPERON_LIKELIHOOD_KERNELS_HPP
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+#include "operon/core/types.hpp"
+#include "operon/interpreter/functions.hpp"
+
+namespace Operon::detail {
+
+// sums of transcendental functions over the rows, computed with the batch kernels of the active math backend
+// (the same exp and log as the interpreter, eg. eve or fast_approx)
+// - the rows are processed in batches of S values, the last batch is padded with ones (in the domain of log)
+// - the partial sums are accumulated in double precision
+template<typename T, std::size_t S = Backend::BatchSize<T>>
+struct LikelihoodKernels {
+    using Array = Eigen::Array<T, -1, 1>;
+    using Map   = Eigen::Map<Array const>;
+
+    // calls kernel(out, in) on each batch of input(i, len, in) and returns the sum of reduce(i, len, in, out)
+    template<typename Input, typename Kernel, typename Reduce>
+    static auto Batched(std::size_t n, Input&& input, Kernel&& kernel, Reduce&& reduce) -> double
+    {
+        alignas(Backend::DefaultAlignment) std::array<T, S> in{};
+        alignas(Backend::DefaultAlignment) std::array<T, S> out{};
+        auto sum{0.0};
+        for (auto i = 0UL; i < n; i += S) {
+            auto const len = std::min(S, n - i);
+            input(i, len, in.data());
+            std::fill(in.begin() + static_cast<std::ptrdiff_t>(len), in.end(), T{1});
+            kernel(out.data(), in.data());
+            sum += reduce(i, len, in.data(), out.data());
+        }
+        return sum;
+    }
+
+    static auto Exp(T* out, T const* in) -> void { Backend::Exp<T, S>(out, in); }
+    static auto Log(T* out, T const* in) -> void { Backend::Log<T, S>(out, in); }
+
+    static auto Sum(T const* p, std::size_t len) -> double { return Map(p, static_cast<Eigen::Index>(len)).template cast<double>().sum(); }
+
+    // sum log(s)
+    static auto SumLog(Operon::Span<T const> s) -> double
+    {
+        return Batched(s.size(),
+            [&](auto i, auto len, T* in) { std::copy_n(s.data() + i, len, in); },
+            Log,
+            [](auto /*i*/, auto len, T const* /*in*/, T const* out) { return Sum(out, len); });
+    }
+
+    // sum f(w * x) - y * w * x if log input, w * x - y * log(w * x) otherwise (w is one if empty or broadcast if it has one element)
+    template<bool LogInput>
+    static auto PoissonSum(Operon::Span<T const> x, Operon::Span<T const> y, Operon::Span<T const> w) -> double
+    {
+        auto input = [&](auto i, auto len, T* in) {
+            Eigen::Map<Array> z(in, static_cast<Eigen::Index>(len));
+            z = Map(x.data() + i, z.size());
+            if (w.size() == 1) { z *= w[0]; }
+            else if (!w.empty()) { z *= Map(w.data() + i, z.size()); }
+        };
+        auto reduce = [&](auto i, auto len, T const* in, T const* out) {
+            auto const n = static_cast<Eigen::Index>(len);
+            Map z(in, n);
+            Map f(out, n);
+            Map t(y.data() + i, n);
+            if constexpr (LogInput) {
+                return static_cast<double>((f - t * z).template cast<double>().sum());
+            } else {
+                return static_cast<double>((z - t * f).template cast<double>().sum());
+            }
+        };
+        if constexpr (LogInput) {
+            return Batched(x.size(), input, Exp, reduce);
+        } else {
+            return Batched(x.size(), input, Log, reduce);
+        }
+    }
+
+    // sum lgamma(y + 1), which only depends on the target (there is no batch kernel for it)
+    static auto SumLogFactorial(Operon::Span<T const> y) -> double
+    {
+        auto sum{0.0};
+        for (auto v : y) { sum += std::lgamma(static_cast<double>(v) + 1); }
+        return sum;
+    }
+};
+
+} // namespace Operon::detail
+
+#endif
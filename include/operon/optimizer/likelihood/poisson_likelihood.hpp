@@ -7,12 +7,13 @@
 #include "operon/core/concepts.hpp"
 #include "operon/core/types.hpp"
 #include "operon/interpreter/interpreter.hpp"
+#include "kernels.hpp"
 #include "likelihood_base.hpp"
+#include "operon/optimizer/batch_sampler.hpp"
 
 #include <functional>
+#include <stdexcept>
 #include <type_traits>
-#include <vstat/univariate.hpp>
-#include <vstat/vstat.hpp>
 namespace Operon {
 
 namespace detail {
@@ -46,13 +47,11 @@ struct PoissonLikelihood : public LikelihoodBase<T> {
 
     PoissonLikelihood(Operon::RandomGenerator& rng, InterpreterBase<T> const& interpreter, Operon::Span<Operon::Scalar const> target, Operon::Range const range, std::size_t const batchSize = 0)
         : LikelihoodBase<T>(interpreter)
-        , rng_{rng}
         , target_(target)
         , range_(range)
-        , batchSize_(batchSize == 0 ? range.Size() : batchSize)
         , numParameters_{static_cast<std::size_t>(interpreter.GetTree().CoefficientsCount())}
         , numResiduals_{range_.Size()}
-        , jac_{batchSize_, numParameters_}
+        , sampler_{rng, range, batchSize}
     { }
 
     using Scalar   = typename LikelihoodBase<T>::Scalar;
@@ -64,54 +63,60 @@ struct PoissonLikelihood : public LikelihoodBase<T> {
     using Matrix   = typename LikelihoodBase<T>::Matrix;
 
     // this loss can be used by the SGD or LBFGS optimizers
+    // - the gradient is computed batch by batch without storing the jacobian (see InterpreterBase::Vjp)
+    // - the rows are drawn by the batch sampler, one range at a time
     auto operator()(Cref x, Ref g) const noexcept -> Operon::Scalar final {
         ++feval_;
         auto const& interpreter = this->GetInterpreter();
         Operon::Span<Operon::Scalar const> c{x.data(), static_cast<std::size_t>(x.size())};
-        auto r = SelectRandomRange();
-        auto p = interpreter.Evaluate(c, r);
-        auto t = target_.subspan(r.Start(), r.Size());
-        auto pmap = Eigen::Map<Eigen::Array<Operon::Scalar, -1, 1> const>(p.data(), std::ssize(p));
-        auto tmap = Eigen::Map<Eigen::Array<Operon::Scalar, -1, 1> const>(t.data(), std::ssize(t));
+        auto const ranges = sampler_.Next();
+        Operon::Scalar total{0};
+        if (g.size() != 0 && ranges.size() > 1) {
+            g.setZero();
+            partial_.resize(std::ssize(g));
+        }
+
+        for (auto const& r : ranges) {
+            auto t = target_.subspan(r.Start() - range_.Start(), r.Size());
+
+            // the loss of the given rows, the adjoint is the derivative of the loss with respect to the output
+            auto loss = [&](int64_t row, Operon::Span<Scalar const> values, Operon::Span<Scalar> adjoint) {
+                auto pmap = Eigen::Map<Eigen::Array<Operon::Scalar, -1, 1> const>(values.data(), std::ssize(values));
+                auto tmap = Eigen::Map<Eigen::Array<Operon::Scalar, -1, 1> const>(t.data() + row, std::ssize(values));
+                auto amap = Eigen::Map<Eigen::Array<Operon::Scalar, -1, 1>>(adjoint.data(), std::ssize(adjoint));
+                if constexpr (LogInput) {
+                    if (!adjoint.empty()) { amap = pmap.exp() - tmap; }
+                    return static_cast<Operon::Scalar>((pmap.exp() - tmap * pmap).sum());
+                } else {
+                    if (!adjoint.empty()) { amap = 1 - tmap * pmap.inverse(); }
+                    return static_cast<Operon::Scalar>((pmap - tmap * pmap.log()).sum());
+                }
+            };
 
-        // compute jacobian
-        if constexpr (LogInput) {
-            if (g.size() != 0) {
-                interpreter.JacRev(c, r, { jac_.data(), numParameters_ * batchSize_ });
-                g = ((pmap.exp() - tmap).matrix().asDiagonal() * jac_.matrix()).colwise().sum();
-            }
-            return (pmap.exp() - tmap * pmap).sum();
-        } else {
-            auto tmap = Eigen::Map<Eigen::Array<Operon::Scalar, -1, 1> const>(t.data(), std::ssize(t));
             if (g.size() != 0) {
-                interpreter.JacRev(c, r, { jac_.data(), numParameters_ * batchSize_ });
-                g = ((1 - tmap * pmap.inverse()).matrix().asDiagonal() * jac_.matrix()).colwise().sum();
+                total += interpreter.Vjp(c, r, loss, {ranges.size() > 1 ? partial_.data() : g.data(), numParameters_});
+                if (ranges.size() > 1) { g += partial_; }
+            } else {
+                if (primal_.size() < std::ssize(t)) { primal_.resize(std::ssize(t)); }
+                interpreter.Evaluate(c, r, {primal_.data(), r.Size()});
+                total += loss(0, {primal_.data(), r.Size()}, {});
             }
-            return (pmap - tmap * pmap.log()).sum();
         }
+
+        if (g.size() != 0) { sampler_.Observe(Operon::Span<Scalar const>{g.data(), numParameters_}); }
+        return total;
     }
 
-    static auto ComputeLikelihood(Span<Scalar const> x, Span<Scalar const> y, Span<Scalar const> w) -> Scalar {
-        using F = std::conditional_t<LogInput, detail::PoissonLog, detail::Poisson>;
-        vstat::univariate_accumulator<Operon::Scalar> acc;
+    auto SetBatchSchedule(BatchSchedule const& schedule) -> void { sampler_.SetSchedule(schedule); }
+    [[nodiscard]] auto Sampler() const -> BatchSampler const& { return sampler_; }
 
-        if (w.empty()) {
-            for (auto i = 0UL; i < x.size(); ++i) {
-                acc(F{}(x[i], y[i]));
-            }
-        } else if (w.size() == 1) {
-            for (auto i = 0UL; i < x.size(); ++i) {
-                acc(F{}(x[i], y[i], w[0]));
-            }
-        } else if (w.size() == x.size()) {
-            for (auto i = 0UL; i < x.size(); ++i) {
-                acc(F{}(x[i], y[i], w[i]));
-            }
-        } else {
+    static auto ComputeLikelihood(Span<Scalar const> x, Span<Scalar const> y, Span<Scalar const> w) -> Scalar {
+        // the exp (or log) of the whole batch is computed by the math backend, lgamma(y + 1) remains scalar
+        using K = detail::LikelihoodKernels<Scalar>;
+        if (!(w.empty() || w.size() == 1 || w.size() == x.size())) {
             throw std::runtime_error("incompatible weights");
         }
-
-        return vstat::univariate_statistics(acc).sum;
+        return static_cast<Scalar>(K::template PoissonSum<LogInput>(x, y, w) + K::SumLogFactorial(y));
     }
 
     static auto ComputeFisherMatrix(Span<Scalar const> pred, Span<Scalar const> jac, Span<Scalar const> /*not used*/) -> Matrix
@@ -134,19 +139,13 @@ struct PoissonLikelihood : public LikelihoodBase<T> {
     auto JacobianEvaluations() const -> std::size_t { return jeval_; }
 
 private:
-    auto SelectRandomRange() const -> Operon::Range {
-        if (batchSize_ >= range_.Size()) { return range_; }
-        auto s = std::uniform_int_distribution<std::size_t>{0UL, range_.Size()-batchSize_}(rng_.get());
-        return Operon::Range{range_.Start() + s, range_.Start() + s + batchSize_};
-    }
-
-    std::reference_wrapper<Operon::RandomGenerator> rng_;
     Operon::Span<Operon::Scalar const> target_;
     Operon::Range const range_; // NOLINT
-    std::size_t batchSize_; // batch size
     std::size_t numParameters_; // number of parameters to optimize
     std::size_t numResiduals_; // number of data points (rows)
-    mutable Eigen::Array<Scalar, -1, -1> jac_;
+    mutable BatchSampler sampler_;
+    mutable Eigen::Array<Scalar, -1, 1> primal_;
+    mutable Vector partial_; // gradient of one range of the batch
     mutable std::size_t feval_{};
     mutable std::size_t jeval_{};
 };
@@ -13,6 +13,8 @@ namespace Operon {
 // for this, a number of template parameters are necessary:
 // - the AutodiffCalculator will compute and return the Jacobian matrix
 // - the StorageOrder specifies the format of the jacobian (row-major for the big Ceres solver, column-major for the tiny solver)
+// with weights (one per row of the range) the residuals and the rows of the jacobian are scaled by sqrt(w), so that the
+// solvers minimize 0.5 * sum w_i * r_i^2
 
 template<typename T = Operon::Scalar, int StorageOrder = Eigen::ColMajor>
 struct LMCostFunction {
@@ -24,13 +26,18 @@ struct LMCostFunction {
         NUM_PARAMETERS = Eigen::Dynamic, // NOLINT
     };
 
-    explicit LMCostFunction(InterpreterBase<T> const& interpreter, Operon::Span<Operon::Scalar const> target, Operon::Range const range)
+    explicit LMCostFunction(InterpreterBase<T> const& interpreter, Operon::Span<Operon::Scalar const> target, Operon::Range const range, Operon::Span<Operon::Scalar const> weights = {})
         : interpreter_(interpreter)
         , target_{target}
         , range_{range}
         , numResiduals_{range.Size()}
         , numParameters_{static_cast<std::size_t>(interpreter.GetTree().CoefficientsCount())}
-    { }
+    {
+        EXPECT(weights.empty() || weights.size() == numResiduals_);
+        if (!weights.empty()) {
+            scale_ = Eigen::Map<Eigen::Array<Operon::Scalar, -1, 1> const>(weights.data(), std::ssize(weights)).sqrt();
+        }
+    }
 
     inline auto Evaluate(Scalar const* parameters, Scalar* residuals, Scalar* jacobian) const -> bool // NOLINT
     {
@@ -38,17 +45,30 @@ struct LMCostFunction {
         EXPECT(parameters != nullptr);
         Operon::Span<Operon::Scalar const> params{ parameters, numParameters_ };
 
+        // when both are requested, the residuals come from the forward pass of the jacobian
+        Operon::Span<Operon::Scalar> res;
+        if (residuals != nullptr) {
+            res = { residuals, static_cast<size_t>(numResiduals_) };
+        }
+
         if (jacobian != nullptr) {
             Operon::Span<Operon::Scalar> jac{jacobian, static_cast<size_t>(numResiduals_ * numParameters_)};
-            interpreter_.get().JacRev(params, range_, jac);
+            interpreter_.get().JacRev(params, range_, res, jac);
+        } else if (residuals != nullptr) {
+            interpreter_.get().Evaluate(params, range_, res);
         }
 
         if (residuals != nullptr) {
-            Operon::Span<Operon::Scalar> res{ residuals, static_cast<size_t>(numResiduals_) };
-            interpreter_.get().Evaluate(params, range_, res);
             Eigen::Map<Eigen::Array<Operon::Scalar, -1, 1>> x(residuals, numResiduals_);
             Eigen::Map<Eigen::Array<Operon::Scalar, -1, 1> const> y(target_.data(), numResiduals_);
             x -= y;
+            if (scale_.size() > 0) { x *= scale_; }
+        }
+
+        if (jacobian != nullptr && scale_.size() > 0) {
+            // the interpreter writes the jacobian in column-major format
+            Eigen::Map<Eigen::Matrix<Operon::Scalar, -1, -1>> jac(jacobian, numResiduals_, numParameters_);
+            jac = scale_.matrix().asDiagonal() * jac;
         }
         return true;
     }
@@ -91,6 +111,7 @@ private:
     Operon::Range const range_; // NOLINT
     std::size_t numResiduals_;
     std::size_t numParameters_;
+    Eigen::Array<Operon::Scalar, -1, 1> scale_; // the square roots of the weights (empty without weights)
 };
 } // namespace Operon
 
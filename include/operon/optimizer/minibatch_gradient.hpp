@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_OPTIMIZER_MINIBATCH_GRADIENT_HPP
+#define OPERON_OPTIMIZER_MINIBATCH_GRADIENT_HPP
+
+#include <Eigen/Core>
+#include <map>
+#include <mutex>
+#include <random>
+#include <vector>
+
+#include "operon/core/contracts.hpp"
+#include "operon/core/types.hpp"
+#include "operon/interpreter/interpreter.hpp"
+#include "operon/optimizer/batch_sampler.hpp"
+
+namespace Operon {
+
+// gaussian loss 0.5 * ||f(x) - y||^2 over a random minibatch, with the gradient computed in parallel
+// - same sampling as GaussianLikelihood (see BatchSampler)
+// - the minibatch is split into chunks of rows processed by the executor, each chunk with its own interpreter
+// - the partial gradients are accumulated in double precision and added in row order,
+//   so the result does not depend on the scheduling
+// - can be used as the functor of the SGD solver in place of the likelihood
+template<typename DTable, typename T = Operon::Scalar>
+struct MinibatchGradient {
+    using Scalar = T;
+    using Vector = Eigen::Array<T, -1, 1>;
+    using Ref    = Eigen::Ref<Vector>;
+    using Cref   = Eigen::Ref<Vector const> const&;
+
+    MinibatchGradient(Operon::RandomGenerator& rng, DTable const& dtable, Operon::Dataset const& dataset, Operon::Tree const& tree, Operon::Span<Operon::Scalar const> target, Operon::Range range, std::size_t batchSize = 0)
+        : dtable_(dtable)
+        , dataset_(dataset)
+        , tree_(tree)
+        , target_(target)
+        , range_(range)
+        , np_{static_cast<std::size_t>(tree.CoefficientsCount())}
+        , sampler_{rng, range, batchSize}
+    {
+        EXPECT(target.size() == range.Size());
+    }
+
+    auto SetExecutor(tf::Executor* executor) -> void { executor_ = executor; }
+    auto SetRowChunk(std::size_t rowChunk) -> void { rowChunk_ = rowChunk; }
+    auto SetBatchSchedule(BatchSchedule const& schedule) -> void { sampler_.SetSchedule(schedule); }
+    [[nodiscard]] auto Sampler() const -> BatchSampler const& { return sampler_; }
+
+    auto operator()(Cref x, Ref grad) const -> Operon::Scalar {
+        ++feval_;
+        Operon::Span<T const> c{x.data(), static_cast<std::size_t>(x.size())};
+        auto const ranges = sampler_.Next();
+        auto const withGradient = grad.size() != 0;
+        if (withGradient) {
+            EXPECT(grad.size() == x.size());
+            ++jeval_;
+        }
+
+        struct Partial { Eigen::Array<double, -1, 1> Gradient; double Cost{0}; };
+        auto compute = [&](Operon::Range rg) {
+            Interpreter<T, DTable> const interpreter{dtable_.get(), dataset_.get(), tree_.get()};
+            auto const n = rg.Size();
+            auto const nr = static_cast<Eigen::Index>(n);
+            auto const* y = target_.data() + (rg.Start() - range_.Start());
+
+            Partial partial{ Eigen::Array<double, -1, 1>::Zero(static_cast<Eigen::Index>(np_)), 0.0 };
+            std::vector<T> pred(n);
+            if (withGradient) {
+                std::vector<T> jac(n * np_);
+                interpreter.JacRev(c, rg, {pred.data(), n}, {jac.data(), jac.size()});
+                Eigen::Map<Eigen::Matrix<T, -1, -1> const> j(jac.data(), nr, static_cast<Eigen::Index>(np_));
+                Eigen::Map<Eigen::Matrix<T, -1, 1> const> p(pred.data(), nr);
+                Eigen::Map<Eigen::Matrix<Operon::Scalar, -1, 1> const> t(y, nr);
+                Eigen::Matrix<double, -1, 1> const e = p.template cast<double>() - t.template cast<double>();
+                partial.Gradient = (j.template cast<double>().transpose() * e).array();
+                partial.Cost = e.squaredNorm();
+            } else {
+                interpreter.Evaluate(c, rg, {pred.data(), n});
+                for (auto i = 0UL; i < n; ++i) {
+                    auto const r = static_cast<double>(pred[i]) - static_cast<double>(y[i]);
+                    partial.Cost += r * r;
+                }
+            }
+            return partial;
+        };
+
+        // the partial results are keyed by the start of their rows (the ranges of a batch do not overlap)
+        std::map<std::size_t, Partial> partials;
+        std::mutex mutex;
+        for (auto const& range : ranges) {
+            if (executor_ == nullptr || range.Size() <= rowChunk_) {
+                partials.emplace(range.Start(), compute(range));
+                continue;
+            }
+            ForEachRowChunk(*executor_, range, rowChunk_, [&](Operon::Range rg) {
+                auto partial = compute(rg);
+                std::scoped_lock lock(mutex);
+                partials.emplace(rg.Start(), std::move(partial));
+            });
+        }
+
+        Partial total{ Eigen::Array<double, -1, 1>::Zero(static_cast<Eigen::Index>(np_)), 0.0 };
+        for (auto const& [start, partial] : partials) {
+            if (withGradient) { total.Gradient += partial.Gradient; }
+            total.Cost += partial.Cost;
+        }
+
+        if (withGradient) {
+            grad = total.Gradient.template cast<T>();
+            sampler_.Observe(Operon::Span<T const>{grad.data(), np_});
+        }
+        return static_cast<Operon::Scalar>(0.5 * total.Cost); // NOLINT
+    }
+
+    [[nodiscard]] auto NumParameters() const -> std::size_t { return np_; }
+    [[nodiscard]] auto NumObservations() const -> std::size_t { return range_.Size(); }
+    [[nodiscard]] auto FunctionEvaluations() const -> std::size_t { return feval_; }
+    [[nodiscard]] auto JacobianEvaluations() const -> std::size_t { return jeval_; }
+
+private:
+    std::reference_wrapper<DTable const> dtable_;
+    std::reference_wrapper<Operon::Dataset const> dataset_;
+    std::reference_wrapper<Operon::Tree const> tree_;
+    Operon::Span<Operon::Scalar const> target_;
+    Operon::Range range_;
+    std::size_t np_; // number of parameters to optimize
+    mutable BatchSampler sampler_;
+    std::size_t rowChunk_{ DefaultRowChunk };
+    tf::Executor* executor_{nullptr};
+    mutable std::size_t feval_{};
+    mutable std::size_t jeval_{};
+};
+
+} // namespace Operon
+
+#endif
@@ -0,0 +1,166 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_OPTIMIZER_NORMAL_EQUATIONS_HPP
+#define OPERON_OPTIMIZER_NORMAL_EQUATIONS_HPP
+
+#include <Eigen/Core>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "operon/core/contracts.hpp"
+#include "operon/interpreter/interpreter.hpp"
+
+namespace Operon {
+
+// least squares cost function that never materializes the full jacobian
+// - the normal equations J^T J and J^T r are accumulated one block of rows at a time,
+//   so the memory is O(p^2 + block * p) instead of O(n * p)
+// - the accumulation is done in double precision, which matters for tall datasets
+// - if an executor is given, the rows are split into chunks that are processed in parallel
+//   (the partial sums are added in row order, so the result does not depend on the scheduling)
+// - with weights (one per row of the range) it accumulates J^T W J, J^T W r and 0.5 * sum w_i * r_i^2
+template<typename DTable, typename T = Operon::Scalar>
+struct NormalEquationsCostFunction {
+    using Matrix = Eigen::Matrix<double, -1, -1>;
+    using Vector = Eigen::Matrix<double, -1, 1>;
+
+    static constexpr std::size_t DefaultBlockSize{ 4096 };
+
+    NormalEquationsCostFunction(DTable const& dtable, Operon::Dataset const& dataset, Operon::Tree const& tree, Operon::Span<Operon::Scalar const> target, Operon::Range range, std::size_t blockSize = DefaultBlockSize)
+        : dtable_(dtable)
+        , dataset_(dataset)
+        , tree_(tree)
+        , target_(target)
+        , range_(range)
+        , blockSize_(blockSize)
+        , numParameters_(static_cast<std::size_t>(tree.CoefficientsCount()))
+    {
+        EXPECT(target.size() == range.Size());
+        EXPECT(blockSize > 0);
+    }
+
+    auto SetExecutor(tf::Executor* executor) -> void { executor_ = executor; }
+    auto SetRowChunk(std::size_t rowChunk) -> void { rowChunk_ = rowChunk; }
+    auto SetWeights(Operon::Span<Operon::Scalar const> weights) -> void
+    {
+        EXPECT(weights.empty() || weights.size() == range_.Size());
+        weights_ = weights;
+    }
+
+    // accumulates J^T J and J^T r (where r = f(x) - y) and returns the cost 0.5 * ||r||^2
+    auto Accumulate(Operon::Span<T const> coeff, Matrix& jtj, Vector& jtr) const -> double
+    {
+        EXPECT(coeff.size() == numParameters_);
+        auto const p = static_cast<Eigen::Index>(numParameters_);
+        jtj.setZero(p, p);
+        jtr.setZero(p);
+        auto cost{0.0};
+
+        ForEachChunk([&](Operon::Range rg, Matrix& a, Vector& b, double& c) {
+            AccumulateRows(coeff, rg, a, b, c);
+        }, jtj, jtr, cost);
+        return 0.5 * cost; // NOLINT
+    }
+
+    // returns the cost 0.5 * ||r||^2 without computing the jacobian
+    auto Cost(Operon::Span<T const> coeff) const -> double
+    {
+        Matrix jtj;
+        Vector jtr;
+        auto cost{0.0};
+
+        ForEachChunk([&](Operon::Range rg, Matrix& /*unused*/, Vector& /*unused*/, double& c) {
+            Interpreter<T, DTable> const interpreter{dtable_.get(), dataset_.get(), tree_.get()};
+            auto const offset = rg.Start() - range_.Start();
+            interpreter.ForEachBatch(coeff, rg, [&](int64_t row, Operon::Span<T const> values) {
+                auto const* y = target_.data() + offset + row;
+                auto const* w = weights_.empty() ? nullptr : weights_.data() + offset + row;
+                for (auto i = 0UL; i < values.size(); ++i) {
+                    auto const r = static_cast<double>(values[i]) - static_cast<double>(y[i]);
+                    c += w == nullptr ? r * r : static_cast<double>(w[i]) * r * r;
+                }
+            });
+        }, jtj, jtr, cost);
+        return 0.5 * cost; // NOLINT
+    }
+
+    [[nodiscard]] auto NumResiduals() const -> std::size_t { return range_.Size(); }
+    [[nodiscard]] auto NumParameters() const -> std::size_t { return numParameters_; }
+
+private:
+    auto AccumulateRows(Operon::Span<T const> coeff, Operon::Range rows, Matrix& jtj, Vector& jtr, double& cost) const -> void
+    {
+        Interpreter<T, DTable> const interpreter{dtable_.get(), dataset_.get(), tree_.get()};
+        auto const p = numParameters_;
+        auto const block = std::min(blockSize_, rows.Size());
+
+        std::vector<T> pred(block);
+        std::vector<T> jac(block * p);
+
+        for (auto start = rows.Start(); start < rows.End(); start += block) {
+            Operon::Range const rg{start, std::min(start + block, rows.End())};
+            auto const n = rg.Size();
+            interpreter.JacRev(coeff, rg, {pred.data(), n}, {jac.data(), n * p});
+
+            auto const nr = static_cast<Eigen::Index>(n);
+            Matrix j = Eigen::Map<Eigen::Matrix<T, -1, -1> const>(jac.data(), nr, static_cast<Eigen::Index>(p)).template cast<double>();
+            Vector r = Eigen::Map<Eigen::Matrix<T, -1, 1> const>(pred.data(), nr).template cast<double>()
+                - Eigen::Map<Eigen::Matrix<Operon::Scalar, -1, 1> const>(target_.data() + (start - range_.Start()), nr).template cast<double>();
+            if (!weights_.empty()) {
+                // the rows are scaled by sqrt(w)
+                Vector const s = Eigen::Map<Eigen::Matrix<Operon::Scalar, -1, 1> const>(weights_.data() + (start - range_.Start()), nr).template cast<double>().cwiseSqrt();
+                j = s.asDiagonal() * j;
+                r = r.cwiseProduct(s);
+            }
+
+            jtj.template selfadjointView<Eigen::Lower>().rankUpdate(j.transpose());
+            jtr.noalias() += j.transpose() * r;
+            cost += r.squaredNorm();
+        }
+        jtj.template triangularView<Eigen::StrictlyUpper>() = jtj.transpose();
+    }
+
+    // calls func(rows, jtj, jtr, cost) for each chunk of rows and adds up the partial results
+    template<typename F>
+    auto ForEachChunk(F&& func, Matrix& jtj, Vector& jtr, double& cost) const -> void
+    {
+        if (executor_ == nullptr || range_.Size() <= rowChunk_) {
+            func(range_, jtj, jtr, cost);
+            return;
+        }
+
+        struct Partial { Matrix JtJ; Vector JtR; double Cost{0}; };
+        std::map<std::size_t, Partial> partials;
+        std::mutex mutex;
+
+        ForEachRowChunk(*executor_, range_, rowChunk_, [&](Operon::Range rg) {
+            Partial partial{ Matrix::Zero(jtj.rows(), jtj.cols()), Vector::Zero(jtr.size()), 0.0 };
+            func(rg, partial.JtJ, partial.JtR, partial.Cost);
+            std::scoped_lock lock(mutex);
+            partials.emplace(rg.Start(), std::move(partial));
+        });
+
+        for (auto const& [start, partial] : partials) {
+            if (jtj.size() > 0) { jtj += partial.JtJ; }
+            if (jtr.size() > 0) { jtr += partial.JtR; }
+            cost += partial.Cost;
+        }
+    }
+
+    std::reference_wrapper<DTable const> dtable_;
+    std::reference_wrapper<Operon::Dataset const> dataset_;
+    std::reference_wrapper<Operon::Tree const> tree_;
+    Operon::Span<Operon::Scalar const> target_;
+    Operon::Span<Operon::Scalar const> weights_;
+    Operon::Range range_;
+    std::size_t blockSize_;
+    std::size_t numParameters_;
+    std::size_t rowChunk_{ DefaultRowChunk };
+    tf::Executor* executor_{nullptr};
+};
+
+} // namespace Operon
+
+#endif
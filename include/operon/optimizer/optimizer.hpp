@@ -7,7 +7,10 @@
 #include "operon/error_metrics/mean_squared_error.hpp"
 #include "operon/error_metrics/sum_of_squared_errors.hpp"
 #include "operon/interpreter/dispatch_table.hpp"
+#include <algorithm>
 #include <functional>
+#include <optional>
+#include <stdexcept>
 #if defined(HAVE_CERES)
 #include <ceres/tiny_solver.h>
 #else
@@ -21,13 +24,25 @@
 #include "likelihood/gaussian_likelihood.hpp"
 #include "likelihood/poisson_likelihood.hpp"
 #include "lm_cost_function.hpp"
+#include "batch_sampler.hpp"
+#include "minibatch_gradient.hpp"
+#include "normal_equations.hpp"
 #include "operon/core/comparison.hpp"
+#include "operon/core/memory.hpp"
+#include "operon/core/pool.hpp"
 #include "operon/core/problem.hpp"
+#include "solver_state_cache.hpp"
+#include "solvers/normal_equations.hpp"
 #include "solvers/sgd.hpp"
+#include "variable_projection.hpp"
 
 namespace Operon {
 
-enum class OptimizerType : int { Tiny, Eigen, Ceres };
+// - Tiny, Eigen and Ceres materialize the full jacobian
+// - NormalEquations accumulates J^T J and J^T r over blocks of rows (memory independent of the number of rows, see NormalEquationsCostFunction)
+// - VariableProjection solves for the linear coefficients in closed form and runs the tiny solver on the nonlinear ones
+//   (see VariableProjectionCostFunction)
+enum class OptimizerType : int { Tiny, Eigen, Ceres, NormalEquations, VariableProjection };
 
 struct OptimizerSummary {
     std::vector<Operon::Scalar> InitialParameters;
@@ -38,6 +53,22 @@ struct OptimizerSummary {
     int FunctionEvaluations{};
     int JacobianEvaluations{};
     bool Success{};
+    int SavedJacobianEvaluations{}; // iterations not spent because of an adaptive budget (see CoefficientOptimizer)
+};
+
+// termination tolerances of the tiny levenberg-marquardt solver, a negative value keeps the default of the solver
+// - the solver stops when max |J'r| < Gradient, when the step is smaller than Parameter * (|x| + Parameter) or when a
+//   step changes the cost (half the sum of squared residuals) by less than Cost
+// - a selection that compares the mean squared error up to some epsilon does not depend on a cost change below
+//   epsilon * n / 2 (with n training rows), so the solver can stop there (see FromFitnessEpsilon)
+struct SolverTolerances {
+    double Gradient{-1};
+    double Parameter{-1};
+    double Cost{-1};
+
+    [[nodiscard]] static auto FromFitnessEpsilon(double epsilon, std::size_t rows) -> SolverTolerances {
+        return { .Cost = epsilon * static_cast<double>(rows) / 2 };
+    }
 };
 
 class OptimizerBase {
@@ -45,6 +76,10 @@ std::reference_wrapper<Problem const> problem_;
 // batch size for loss functions (default = 0 -> use entire data range)
 mutable std::size_t batchSize_{0};
 mutable std::size_t iterations_{100}; // NOLINT
+mutable SolverStateCache const* stateCache_{nullptr}; // warm start state of the solver (if supported)
+mutable SolverTolerances tolerances_;
+mutable BatchSchedule batchSchedule_; // how the minibatches are drawn (gradient based optimizers)
+mutable std::optional<Operon::Hash> weights_; // the variable holding the weights of the rows (see SetWeights)
 
 public:
     explicit OptimizerBase(Problem const& problem)
@@ -64,9 +99,51 @@ public:
     [[nodiscard]] auto Iterations() const -> std::size_t { return iterations_; }
 
     auto SetBatchSize(std::size_t batchSize) const { batchSize_ = batchSize; }
+    auto SetBatchSchedule(BatchSchedule const& schedule) const { batchSchedule_ = schedule; }
+    [[nodiscard]] auto GetBatchSchedule() const -> BatchSchedule const& { return batchSchedule_; }
     auto SetIterations(std::size_t iterations) const { iterations_ = iterations; }
 
-    [[nodiscard]] virtual auto Optimize(Operon::RandomGenerator& rng, Tree const& tree) const -> OptimizerSummary = 0;
+    // the state cache keeps the best coefficients of each tree structure for all the optimizers (see
+    // CoefficientOptimizer::SetStructureWarmStart), the trust region radius is only carried over by the optimizers
+    // whose solver reports its final radius (see WarmStartsTrustRegion)
+    // - the normal equations optimizer reads and updates the cached radius
+    // - the tiny (ceres), eigen and variable projection optimizers always start from the default radius of their solver
+    auto SetStateCache(SolverStateCache const* cache) const { stateCache_ = cache; }
+    [[nodiscard]] auto StateCache() const -> SolverStateCache const* { return stateCache_; }
+    [[nodiscard]] virtual auto WarmStartsTrustRegion() const -> bool { return false; }
+
+    auto SetTolerances(SolverTolerances const& tolerances) const { tolerances_ = tolerances; }
+    [[nodiscard]] auto Tolerances() const -> SolverTolerances const& { return tolerances_; }
+
+    // weight the squared residual of each row by the values of a dataset variable (eg. the weights of a coreset, see
+    // ReduceProblem), the same weighting as Evaluator::SetWeights
+    // - the least squares optimizers (levenberg-marquardt, all types) minimize 0.5 * sum w_i * r_i^2, the likelihood
+    //   based ones (LBFGS, SGD) ignore the weights
+    auto SetWeights(std::optional<Operon::Hash> variable) const {
+        if (variable && !GetProblem().GetDataset().GetVariable(*variable)) {
+            throw std::invalid_argument("the weight variable does not exist in the dataset");
+        }
+        weights_ = variable;
+    }
+    [[nodiscard]] auto Weights() const -> std::optional<Operon::Hash> { return weights_; }
+
+    // the weights of the rows of the range (empty without weights)
+    [[nodiscard]] auto WeightValues(Operon::Range range) const -> Operon::Span<Operon::Scalar const> {
+        return weights_ ? GetProblem().GetDataset().GetValues(*weights_).subspan(range.Start(), range.Size()) : Operon::Span<Operon::Scalar const>{};
+    }
+
+    [[nodiscard]] auto Optimize(Operon::RandomGenerator& rng, Tree const& tree) const -> OptimizerSummary { return Optimize(rng, tree, Iterations()); }
+
+    // the estimated bytes of the jacobian and the residuals of one call to Optimize for a tree with the given number of
+    // coefficients, by default over the training range (or a batch of it, see SetBatchSize)
+    [[nodiscard]] virtual auto WorkingMemory(std::size_t coefficients) const -> std::size_t
+    {
+        auto const rows = batchSize_ > 0 ? batchSize_ : GetProblem().TrainingRange().Size();
+        return FullJacobianBytes(rows, coefficients);
+    }
+
+    // same as above with an explicit iteration limit (eg. for adaptive policies, without mutating the shared optimizer)
+    [[nodiscard]] virtual auto Optimize(Operon::RandomGenerator& rng, Tree const& tree, std::size_t iterations) const -> OptimizerSummary = 0;
     [[nodiscard]] virtual auto ComputeLikelihood(Operon::Span<Operon::Scalar const> x, Operon::Span<Operon::Scalar const> y, Operon::Span<Operon::Scalar const> w) const -> Operon::Scalar = 0;
     [[nodiscard]] virtual auto ComputeFisherMatrix(Operon::Span<Operon::Scalar const> pred, Operon::Span<Operon::Scalar const> jac, Operon::Span<Operon::Scalar const> sigma) const -> Eigen::Matrix<Operon::Scalar, -1, -1> = 0;
 };
@@ -76,6 +153,72 @@ namespace detail {
         constexpr auto CHECK_NAN{true};
         return Operon::Less<CHECK_NAN>{}(finalCost, initialCost);
     }
+
+    // warm start of the trust region from the solver state cached for the same tree structure
+    // - the lower bound keeps a parent that ended on a run of rejected steps from freezing its children
+    struct WarmStart {
+        static constexpr auto MinTrustRegionRadius{1.0};
+
+        WarmStart(SolverStateCache const* cache, Operon::Tree const& tree)
+            : cache_{cache != nullptr && cache->Enabled() ? cache : nullptr}
+            , key_{cache_ != nullptr ? SolverStateCache::Key(tree) : Operon::Hash{0}}
+        {
+        }
+
+        [[nodiscard]] auto TrustRegionRadius(double defaultRadius) const -> double {
+            if (cache_ == nullptr) { return defaultRadius; }
+            auto const state = cache_->Find(key_);
+            return state && state->TrustRegionRadius > 0 ? std::clamp(state->TrustRegionRadius, MinTrustRegionRadius, defaultRadius) : defaultRadius;
+        }
+
+        auto Update(double finalRadius) const -> void {
+            if (cache_ != nullptr && finalRadius > 0 && std::isfinite(finalRadius)) {
+                cache_->Update(key_, [&](auto& state) { state.TrustRegionRadius = finalRadius; });
+            }
+        }
+
+    private:
+        SolverStateCache const* cache_;
+        Operon::Hash key_;
+    };
+
+    // a tiny solver held by the caller until the lease is released, with default options and an empty summary
+    // - its matrices keep their storage between solves (eigen only reallocates them when their size changes, ie. when
+    //   the number of coefficients differs from the previous tree)
+    // - the solvers are pooled rather than thread-local, so a task that the thread runs while it waits in a corun
+    //   does not get the solver in use
+    template <typename CostFunction>
+    inline auto LocalTinySolver() -> typename ObjectPool<ceres::TinySolver<CostFunction>>::Lease {
+        static ObjectPool<ceres::TinySolver<CostFunction>> pool;
+        auto solver = pool.Acquire();
+        solver->options = typename ceres::TinySolver<CostFunction>::Options{};
+        solver->summary = typename ceres::TinySolver<CostFunction>::Summary{};
+        return solver;
+    }
+
+    // the losses that draw their minibatches with a BatchSampler
+    template <typename Loss>
+    inline auto ApplyBatchSchedule(BatchSchedule const& schedule, Loss& loss) -> void {
+        if constexpr (requires { loss.SetBatchSchedule(schedule); }) { loss.SetBatchSchedule(schedule); }
+    }
+
+    // the number of rows of an average batch (the batch size might follow a schedule)
+    template <typename Loss>
+    inline auto MeanBatchSize(Loss const& loss, std::size_t batchSize) -> double {
+        if constexpr (requires { loss.Sampler(); }) {
+            auto const& sampler = loss.Sampler();
+            if (sampler.Batches() > 0) { return static_cast<double>(sampler.RowsSampled()) / static_cast<double>(sampler.Batches()); }
+        }
+        return static_cast<double>(batchSize);
+    }
+
+    template <typename Options>
+    inline auto ApplyTolerances(SolverTolerances const& tolerances, Options& options) -> void {
+        using T = decltype(options.gradient_tolerance);
+        if (tolerances.Gradient >= 0) { options.gradient_tolerance = static_cast<T>(tolerances.Gradient); }
+        if (tolerances.Parameter >= 0) { options.parameter_tolerance = static_cast<T>(tolerances.Parameter); }
+        if (tolerances.Cost >= 0) { options.function_tolerance = static_cast<T>(tolerances.Cost); }
+    }
 } // namespace detail
 
 template <typename DTable, OptimizerType = OptimizerType::Tiny>
@@ -85,30 +228,34 @@ struct LevenbergMarquardtOptimizer : public OptimizerBase {
     {
     }
 
-    [[nodiscard]] auto Optimize(Operon::RandomGenerator& /*unused*/, Operon::Tree const& tree) const -> OptimizerSummary final
+    using OptimizerBase::Optimize;
+
+    [[nodiscard]] auto Optimize(Operon::RandomGenerator& /*unused*/, Operon::Tree const& tree, std::size_t iterations) const -> OptimizerSummary final
     {
         auto const& dtable = this->GetDispatchTable();
         auto const& problem = this->GetProblem();
         auto const& dataset = problem.GetDataset();
         auto range  = problem.TrainingRange();
         auto target = problem.TargetValues(range);
-        auto iterations = this->Iterations();
 
         Operon::Interpreter<Operon::Scalar, DTable> interpreter{dtable, dataset, tree};
-        Operon::LMCostFunction cf{interpreter, target, range};
-        ceres::TinySolver<decltype(cf)> solver;
+        Operon::LMCostFunction cf{interpreter, target, range, this->WeightValues(range)};
+        auto lease = detail::LocalTinySolver<decltype(cf)>();
+        auto& solver = *lease;
         solver.options.max_num_iterations = static_cast<int>(iterations);
+        detail::ApplyTolerances(this->Tolerances(), solver.options);
 
-        auto x0 = tree.GetCoefficients();
+        // the coefficients are optimized in place in the final parameters of the summary
         OptimizerSummary summary;
+        auto& x0 = summary.FinalParameters;
+        tree.GetCoefficients(x0);
         summary.InitialParameters = x0;
         auto m0 = Eigen::Map<Eigen::Matrix<Operon::Scalar, Eigen::Dynamic, 1>>(x0.data(), x0.size());
         if (!x0.empty()) {
-            typename decltype(solver)::Parameters p = m0.cast<typename decltype(cf)::Scalar>();
+            typename std::remove_reference_t<decltype(solver)>::Parameters p = m0.cast<typename decltype(cf)::Scalar>();
             solver.Solve(cf, &p);
             m0 = p.template cast<Operon::Scalar>();
         }
-        summary.FinalParameters = x0;
         summary.InitialCost = solver.summary.initial_cost;
         summary.FinalCost = solver.summary.final_cost;
         summary.Iterations = solver.summary.iterations;
@@ -132,6 +279,86 @@ struct LevenbergMarquardtOptimizer : public OptimizerBase {
     std::reference_wrapper<DTable const> dtable_;
 };
 
+template <typename DTable>
+struct LevenbergMarquardtOptimizer<DTable, OptimizerType::VariableProjection> final : public OptimizerBase {
+    explicit LevenbergMarquardtOptimizer(DTable const& dtable, Problem const& problem)
+        : OptimizerBase{problem}, dtable_{dtable}
+    {
+    }
+
+    using OptimizerBase::Optimize;
+
+    [[nodiscard]] auto Optimize(Operon::RandomGenerator& rng, Operon::Tree const& tree, std::size_t iterations) const -> OptimizerSummary final
+    {
+        auto const& dtable = this->GetDispatchTable();
+        auto const& problem = this->GetProblem();
+        auto const& dataset = problem.GetDataset();
+        auto range  = problem.TrainingRange();
+        auto target = problem.TargetValues(range);
+
+        // without linear coefficients this is the same as the tiny solver
+        auto const linear = VariableProjectionCostFunction<>::LinearCoefficients(tree);
+        if (std::ranges::none_of(linear, std::identity{})) {
+            LevenbergMarquardtOptimizer<DTable, OptimizerType::Tiny> tiny{dtable, problem};
+            tiny.SetStateCache(this->StateCache());
+            tiny.SetTolerances(this->Tolerances());
+            tiny.SetWeights(this->Weights());
+            return tiny.Optimize(rng, tree, iterations);
+        }
+
+        Operon::Interpreter<Operon::Scalar, DTable> interpreter{dtable, dataset, tree};
+        auto const weights = this->WeightValues(range);
+        Operon::VariableProjectionCostFunction cf{interpreter, target, range, weights};
+
+        OptimizerSummary summary;
+        summary.InitialParameters = tree.GetCoefficients();
+
+        // the initial cost is computed with the initial linear coefficients
+        Eigen::Matrix<Operon::Scalar, -1, 1> residual(cf.NumResiduals());
+        interpreter.Evaluate(summary.InitialParameters, range, { residual.data(), static_cast<std::size_t>(residual.size()) });
+        residual -= Eigen::Map<Eigen::Matrix<Operon::Scalar, -1, 1> const>(target.data(), std::ssize(target));
+        if (!weights.empty()) { residual.array() *= Eigen::Map<Eigen::Array<Operon::Scalar, -1, 1> const>(weights.data(), std::ssize(weights)).sqrt(); }
+        summary.InitialCost = residual.squaredNorm() / 2;
+
+        auto theta = cf.NonlinearCoefficients();
+        if (theta.size() > 0) {
+            auto lease = detail::LocalTinySolver<decltype(cf)>();
+            auto& solver = *lease;
+            solver.options.max_num_iterations = static_cast<int>(iterations);
+            detail::ApplyTolerances(this->Tolerances(), solver.options);
+
+            typename std::remove_reference_t<decltype(solver)>::Parameters p = theta;
+            solver.Solve(cf, &p);
+            theta = p;
+            summary.Iterations = solver.summary.iterations;
+        }
+
+        // the last evaluation of the solver might have been a rejected step, so the linear coefficients are solved
+        // again for the final nonlinear ones (also when all the coefficients are linear)
+        cf(theta.data(), residual.data(), nullptr);
+        summary.FinalCost = residual.squaredNorm() / 2;
+        summary.FunctionEvaluations = static_cast<int>(cf.FunctionEvaluations()) + 1; // and the initial cost
+        summary.JacobianEvaluations = static_cast<int>(cf.JacobianEvaluations());
+        summary.FinalParameters = cf.Coefficients();
+        summary.Success = detail::CheckSuccess(summary.InitialCost, summary.FinalCost);
+        return summary;
+    }
+
+    auto GetDispatchTable() const -> DTable const& { return dtable_.get(); }
+
+    [[nodiscard]] auto ComputeLikelihood(Operon::Span<Operon::Scalar const> x, Operon::Span<Operon::Scalar const> y, Operon::Span<Operon::Scalar const> w) const -> Operon::Scalar final
+    {
+        return GaussianLikelihood<Operon::Scalar>::ComputeLikelihood(x, y, w);
+    }
+
+    [[nodiscard]] auto ComputeFisherMatrix(Operon::Span<Operon::Scalar const> pred, Operon::Span<Operon::Scalar const> jac, Operon::Span<Operon::Scalar const> sigma) const -> Eigen::Matrix<Operon::Scalar, -1, -1> final {
+        return GaussianLikelihood<Operon::Scalar>::ComputeFisherMatrix(pred, jac, sigma);
+    }
+
+    private:
+    std::reference_wrapper<DTable const> dtable_;
+};
+
 template <typename DTable>
 struct LevenbergMarquardtOptimizer<DTable, OptimizerType::Eigen> final : public OptimizerBase {
     explicit LevenbergMarquardtOptimizer(DTable const& dtable, Problem const& problem)
@@ -139,22 +366,24 @@ struct LevenbergMarquardtOptimizer<DTable, OptimizerType::Eigen> final : public
     {
     }
 
-    [[nodiscard]] auto Optimize(Operon::RandomGenerator& /*unused*/, Operon::Tree const& tree) const -> OptimizerSummary final
+    using OptimizerBase::Optimize;
+
+    [[nodiscard]] auto Optimize(Operon::RandomGenerator& /*unused*/, Operon::Tree const& tree, std::size_t iterations) const -> OptimizerSummary final
     {
         auto const& dtable = this->GetDispatchTable();
         auto const& problem = this->GetProblem();
         auto const& dataset = problem.GetDataset();
         auto range  = problem.TrainingRange();
         auto target = problem.TargetValues(range);
-        auto iterations = this->Iterations();
 
         Operon::Interpreter<Operon::Scalar, DTable> interpreter{dtable, dataset, tree};
-        Operon::LMCostFunction<Operon::Scalar> cf{interpreter, target, range};
+        Operon::LMCostFunction<Operon::Scalar> cf{interpreter, target, range, this->WeightValues(range)};
         Eigen::LevenbergMarquardt<decltype(cf)> lm(cf);
         lm.setMaxfev(static_cast<int>(iterations));
 
-        auto x0 = tree.GetCoefficients();
         OptimizerSummary summary;
+        auto& x0 = summary.FinalParameters;
+        tree.GetCoefficients(x0);
         summary.InitialParameters = x0;
         if (!x0.empty()) {
             Eigen::Map<Eigen::Matrix<Operon::Scalar, -1, 1>> m0(x0.data(), std::ssize(x0));
@@ -170,7 +399,6 @@ struct LevenbergMarquardtOptimizer<DTable, OptimizerType::Eigen> final : public
             }
             m0 = m;
         }
-        summary.FinalParameters = x0;
         summary.FinalCost = lm.fnorm() * lm.fnorm();
         summary.Iterations = static_cast<int>(lm.iterations());
         summary.FunctionEvaluations = static_cast<int>(lm.nfev());
@@ -194,6 +422,81 @@ struct LevenbergMarquardtOptimizer<DTable, OptimizerType::Eigen> final : public
     std::reference_wrapper<DTable const> dtable_;
 };
 
+template <typename DTable>
+struct LevenbergMarquardtOptimizer<DTable, OptimizerType::NormalEquations> final : public OptimizerBase {
+    explicit LevenbergMarquardtOptimizer(DTable const& dtable, Problem const& problem)
+        : OptimizerBase{problem}, dtable_{dtable}
+    {
+    }
+
+    using OptimizerBase::Optimize;
+
+    [[nodiscard]] auto Optimize(Operon::RandomGenerator& /*unused*/, Operon::Tree const& tree, std::size_t iterations) const -> OptimizerSummary final
+    {
+        auto const& problem = this->GetProblem();
+        auto range  = problem.TrainingRange();
+        auto target = problem.TargetValues(range);
+
+        Operon::NormalEquationsCostFunction<DTable> cf{this->GetDispatchTable(), problem.GetDataset(), tree, target, range, blockSize_};
+        cf.SetExecutor(executor_);
+        cf.SetWeights(this->WeightValues(range));
+        NormalEquationsSolver<decltype(cf)> solver;
+        auto& options = solver.GetOptions();
+        options.MaxIterations = static_cast<int>(iterations);
+        detail::WarmStart const warmStart{this->StateCache(), tree};
+        options.InitialTrustRegionRadius = warmStart.TrustRegionRadius(options.InitialTrustRegionRadius);
+
+        OptimizerSummary summary;
+        auto& x0 = summary.FinalParameters;
+        tree.GetCoefficients(x0);
+        summary.InitialParameters = x0;
+        if (!x0.empty()) {
+            Eigen::Map<Eigen::Matrix<Operon::Scalar, -1, 1>> m0(x0.data(), std::ssize(x0));
+            Eigen::Matrix<Operon::Scalar, -1, 1> m = m0;
+            solver.Solve(cf, m);
+            m0 = m;
+            warmStart.Update(solver.GetSummary().FinalTrustRegionRadius);
+        }
+        auto const& s = solver.GetSummary();
+        summary.InitialCost = static_cast<Operon::Scalar>(s.InitialCost);
+        summary.FinalCost = static_cast<Operon::Scalar>(s.FinalCost);
+        summary.Iterations = s.Iterations;
+        summary.FunctionEvaluations = s.FunctionEvaluations;
+        summary.JacobianEvaluations = s.JacobianEvaluations;
+        summary.Success = detail::CheckSuccess(summary.InitialCost, summary.FinalCost);
+        return summary;
+    }
+
+    auto GetDispatchTable() const -> DTable const& { return dtable_.get(); }
+
+    [[nodiscard]] auto WarmStartsTrustRegion() const -> bool final { return true; }
+
+    // the row blocks are processed in parallel by the executor (if set)
+    auto SetExecutor(tf::Executor* executor) const { executor_ = executor; }
+    auto SetBlockSize(std::size_t blockSize) const { blockSize_ = blockSize; }
+    [[nodiscard]] auto BlockSize() const -> std::size_t { return blockSize_; }
+
+    // one block of the jacobian and the normal equations (see NormalEquationsCostFunction)
+    [[nodiscard]] auto WorkingMemory(std::size_t coefficients) const -> std::size_t final
+    {
+        return BlockedJacobianBytes(std::min(blockSize_, this->GetProblem().TrainingRange().Size()), coefficients);
+    }
+
+    [[nodiscard]] auto ComputeLikelihood(Operon::Span<Operon::Scalar const> x, Operon::Span<Operon::Scalar const> y, Operon::Span<Operon::Scalar const> w) const -> Operon::Scalar final
+    {
+        return GaussianLikelihood<Operon::Scalar>::ComputeLikelihood(x, y, w);
+    }
+
+    [[nodiscard]] auto ComputeFisherMatrix(Operon::Span<Operon::Scalar const> pred, Operon::Span<Operon::Scalar const> jac, Operon::Span<Operon::Scalar const> sigma) const -> Eigen::Matrix<Operon::Scalar, -1, -1> final {
+        return GaussianLikelihood<Operon::Scalar>::ComputeFisherMatrix(pred, jac, sigma);
+    }
+
+    private:
+    std::reference_wrapper<DTable const> dtable_;
+    mutable tf::Executor* executor_{nullptr};
+    mutable std::size_t blockSize_{NormalEquationsCostFunction<DTable>::DefaultBlockSize};
+};
+
 #if defined(HAVE_CERES)
 template <typename DTable>
 struct LevenbergMarquardtOptimizer<DTable, OptimizerType::Ceres> final : public OptimizerBase {
@@ -202,42 +505,43 @@ struct LevenbergMarquardtOptimizer<DTable, OptimizerType::Ceres> final : public
     {
     }
 
-    [[nodiscard]] auto Optimize(Operon::RandomGenerator& /*unused*/, Operon::Tree const& tree) const -> OptimizerSummary final
+    using OptimizerBase::Optimize;
+
+    [[nodiscard]] auto Optimize(Operon::RandomGenerator& /*unused*/, Operon::Tree const& tree, std::size_t iterations) const -> OptimizerSummary final
     {
         auto const& dtable = this->GetDispatchTable();
         auto const& problem = this->GetProblem();
         auto const& dataset = problem.GetDataset();
         auto range  = problem.TrainingRange();
         auto target = problem.TargetValues(range);
-        auto iterations = this->Iterations();;
 
         auto initialParameters = tree.GetCoefficients();
-        auto finalParameters   = initialParameters;
+        auto finalParameters   = initialParameters; // optimized in place, both are moved into the summary
 
         Operon::Interpreter<Operon::Scalar, DTable> interpreter{dtable, dataset, tree};
-        Operon::LMCostFunction<Operon::Scalar, Eigen::RowMajor> cf{interpreter, target, range};
-        auto* dynamicCostFunction = new Operon::DynamicCostFunction{cf};
         ceres::Solver::Summary s;
         if (!initialParameters.empty()) {
+            // the jacobian is computed in column-major format, the cost function transposes it for ceres
+            Operon::LMCostFunction<Operon::Scalar, Eigen::ColMajor> cf{interpreter, target, range, this->WeightValues(range)};
+            auto lease = CeresSolverContext<Operon::Scalar>::Acquire();
+            auto& context = *lease;
+            Operon::DynamicCostFunction costFunction{cf, &context.Buffers};
+
             auto sz = std::ssize(finalParameters);
             Eigen::Map<Eigen::Matrix<Operon::Scalar, -1, 1>> m0(finalParameters.data(), sz);
-            Eigen::VectorXd params = m0.template cast<double>();
-            ceres::Problem problem;
-            problem.AddResidualBlock(dynamicCostFunction, nullptr, params.data());
-            ceres::Solver::Options options;
-            options.linear_solver_type = ceres::DENSE_QR;
-            options.logging_type = ceres::LoggingType::SILENT;
-            options.max_num_iterations = static_cast<int>(iterations);
-            options.minimizer_progress_to_stdout = false;
-            options.num_threads = 1;
-            options.trust_region_strategy_type = ceres::LEVENBERG_MARQUARDT;
-            options.use_inner_iterations = false;
-            Solve(options, &problem, &s);
+            auto& params = context.Parameters;
+            params = m0.template cast<double>();
+            context.Options.max_num_iterations = static_cast<int>(iterations);
+            {
+                // the next optimization with this context might resize the parameters
+                CeresSolverContext<Operon::Scalar>::ResidualBlock const block{context.Problem, &costFunction, params.data()};
+                Solve(context.Options, &context.Problem, &s);
+            }
             m0 = params.cast<Operon::Scalar>();
         }
         return Operon::OptimizerSummary {
-            .InitialParameters = initialParameters,
-            .FinalParameters = finalParameters,
+            .InitialParameters = std::move(initialParameters),
+            .FinalParameters = std::move(finalParameters),
             .InitialCost = static_cast<Operon::Scalar>(s.initial_cost),
             .FinalCost   = static_cast<Operon::Scalar>(s.final_cost),
             .Iterations  = static_cast<int>(s.iterations.size()),
@@ -270,19 +574,21 @@ struct LBFGSOptimizer final : public OptimizerBase {
     {
     }
 
-    [[nodiscard]] auto Optimize(Operon::RandomGenerator& rng, Operon::Tree const& tree) const -> OptimizerSummary final
+    using OptimizerBase::Optimize;
+
+    [[nodiscard]] auto Optimize(Operon::RandomGenerator& rng, Operon::Tree const& tree, std::size_t iterations) const -> OptimizerSummary final
     {
         auto const& dtable = this->GetDispatchTable();
         auto const& problem = this->GetProblem();
         auto const& dataset = problem.GetDataset();
         auto range  = problem.TrainingRange();
         auto target = problem.TargetValues(range);
-        auto iterations = this->Iterations();
         auto batchSize = this->BatchSize();
         if (batchSize == 0) { batchSize = range.Size(); }
 
         Operon::Interpreter<Operon::Scalar, DTable> interpreter{dtable, dataset, tree};
         LossFunction loss{rng, interpreter, target, range, batchSize};
+        detail::ApplyBatchSchedule(this->GetBatchSchedule(), loss);
 
         auto cost = [&](auto const& coeff) {
             auto pred = interpreter.Evaluate(coeff, range);
@@ -305,14 +611,14 @@ struct LBFGSOptimizer final : public OptimizerBase {
             std::copy(xf.begin(), xf.end(), coeff.begin());
         }
 
-        summary.FinalParameters = coeff;
         auto const f1 = cost(coeff);
+        summary.FinalParameters = std::move(coeff);
         summary.FinalCost = f1;
         summary.Success = detail::CheckSuccess(f0, f1);
         auto const funEvals = loss.FunctionEvaluations();
         auto const jacEvals = loss.JacobianEvaluations();
         auto const rangeSize = range.Size();
-        summary.FunctionEvaluations = static_cast<std::size_t>(static_cast<double>(funEvals + jacEvals) * batchSize / rangeSize);
+        summary.FunctionEvaluations = static_cast<std::size_t>(static_cast<double>(funEvals + jacEvals) * detail::MeanBatchSize(loss, batchSize) / rangeSize);
         summary.JacobianEvaluations = summary.FunctionEvaluations;
         return summary;
     }
@@ -348,19 +654,19 @@ struct SGDOptimizer final : public OptimizerBase {
 
     auto GetDispatchTable() const -> DTable const& { return dtable_.get(); }
 
-    [[nodiscard]] auto Optimize(Operon::RandomGenerator& rng, Operon::Tree const& tree) const -> OptimizerSummary final
+    using OptimizerBase::Optimize;
+
+    [[nodiscard]] auto Optimize(Operon::RandomGenerator& rng, Operon::Tree const& tree, std::size_t iterations) const -> OptimizerSummary final
     {
         auto const& dtable = this->GetDispatchTable();
         auto const& problem = this->GetProblem();
         auto const& dataset = problem.GetDataset();
         auto range  = problem.TrainingRange();
         auto target = problem.TargetValues(range);
-        auto iterations = this->Iterations();
         auto batchSize = this->BatchSize();
         if (batchSize == 0) { batchSize = range.Size(); }
 
         Operon::Interpreter<Operon::Scalar, DTable> interpreter{dtable, dataset, tree};
-        LossFunction loss{rng, interpreter, target, range, batchSize};
 
         auto cost = [&](auto const& coeff) {
             auto pred = interpreter.Evaluate(coeff, range);
@@ -373,21 +679,37 @@ struct SGDOptimizer final : public OptimizerBase {
         summary.InitialParameters = coeff;
         summary.InitialCost = f0;
         auto rule = update_->Clone(coeff.size());
-        SGDSolver<LossFunction> solver(loss, *rule);
 
-        Eigen::Map<Eigen::Array<Operon::Scalar, -1, 1> const> x0(coeff.data(), std::ssize(coeff));
-        auto x = solver.Optimize(x0, iterations);
-        std::copy(x.begin(), x.end(), coeff.begin());
+        // the update rule only sees the reduced gradient, so it does not matter how the gradient was computed
+        auto solve = [&](auto const& loss) {
+            SGDSolver<std::remove_cvref_t<decltype(loss)>> solver(loss, *rule);
+            Eigen::Map<Eigen::Array<Operon::Scalar, -1, 1> const> x0(coeff.data(), std::ssize(coeff));
+            auto x = solver.Optimize(x0, iterations);
+            std::copy(x.begin(), x.end(), coeff.begin());
+            summary.Iterations = solver.Epochs();
+            return std::tuple{loss.FunctionEvaluations(), loss.JacobianEvaluations(), detail::MeanBatchSize(loss, batchSize)};
+        };
+
+        // the minibatch is split into row chunks only if it will not fit into a single chunk
+        auto const [funEvals, jacEvals, meanBatchSize] = [&]() {
+            if (executor_ != nullptr && std::min(batchSize, range.Size()) > rowChunk_) {
+                MinibatchGradient<DTable> loss{rng, dtable, dataset, tree, target, range, batchSize};
+                loss.SetExecutor(executor_);
+                loss.SetRowChunk(rowChunk_);
+                loss.SetBatchSchedule(this->GetBatchSchedule());
+                return solve(loss);
+            }
+            LossFunction loss{rng, interpreter, target, range, batchSize};
+            detail::ApplyBatchSchedule(this->GetBatchSchedule(), loss);
+            return solve(loss);
+        }();
         auto const f1 = cost(coeff);
 
-        summary.FinalParameters = coeff;
+        summary.FinalParameters = std::move(coeff);
         summary.FinalCost = f1;
         summary.Success = detail::CheckSuccess(f0, f1);
-        summary.Iterations = solver.Epochs();
-        auto const funEvals = loss.FunctionEvaluations();
-        auto const jacEvals = loss.JacobianEvaluations();
         auto const rangeSize = range.Size();
-        summary.FunctionEvaluations = static_cast<std::size_t>(static_cast<double>(funEvals + jacEvals) * batchSize / rangeSize);
+        summary.FunctionEvaluations = static_cast<std::size_t>(static_cast<double>(funEvals + jacEvals) * meanBatchSize / rangeSize);
         summary.JacobianEvaluations = summary.FunctionEvaluations;
         return summary;
     }
@@ -405,11 +727,16 @@ struct SGDOptimizer final : public OptimizerBase {
         update_ = std::move(update);
     }
 
+    // the gradient of large minibatches is computed in parallel by the executor (if set, see MinibatchGradient)
+    auto SetExecutor(tf::Executor* executor, std::size_t rowChunk = DefaultRowChunk) const { executor_ = executor; rowChunk_ = rowChunk; }
+
     auto UpdateRule() const { return update_.get(); }
 
     private:
     std::reference_wrapper<DTable const> dtable_;
     std::unique_ptr<UpdateRule::LearningRateUpdateRule const> update_{nullptr};
+    mutable tf::Executor* executor_{nullptr};
+    mutable std::size_t rowChunk_{DefaultRowChunk};
 };
 } // namespace Operon
 #endif
@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_OPTIMIZER_SOLVER_STATE_CACHE_HPP
+#define OPERON_OPTIMIZER_SOLVER_STATE_CACHE_HPP
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "operon/core/sharded_map.hpp"
+#include "operon/core/tree.hpp"
+#include "operon/core/types.hpp"
+#include "operon/hash/hash.hpp"
+
+namespace Operon {
+
+// concurrent, bounded map from a tree structure to the final state of the levenberg-marquardt solver
+// - the key ignores the coefficient values, so the children of an optimized parent that keep its structure
+//   (eg. after a coefficient mutation, or a crossover that reproduces a known shape) warm start from the parent state
+// - the state is the trust region radius, which would otherwise restart from the solver default, and optionally the
+//   best coefficients found for the structure (see CoefficientOptimizer::SetStructureWarmStart)
+// - a ShardedMap with the eviction policy of the fitness cache (a full shard is flushed)
+// - a capacity of zero disables the cache
+class SolverStateCache {
+public:
+    struct State {
+        double TrustRegionRadius{0}; // zero if unknown
+        std::vector<Operon::Scalar> Coefficients; // the coefficients with the lowest cost (empty if unknown)
+        double Cost{std::numeric_limits<double>::infinity()};
+        bool Converged{false}; // the last optimization from the coefficients did not improve them significantly
+    };
+
+    static constexpr std::size_t DefaultShardCount { ShardedMap<State>::DefaultShardCount };
+
+    explicit SolverStateCache(std::size_t capacity = 0, std::size_t shardCount = DefaultShardCount)
+        : states_(capacity, shardCount)
+    {
+    }
+
+    // structural hash of the tree (node labels, variable hashes and lags, but not the coefficient values)
+    // - computed from the node hash values, the cached hashes of the tree are left untouched
+    [[nodiscard]] static auto Key(Operon::Tree const& tree) -> Operon::Hash {
+        std::vector<Operon::Hash> hashes;
+        hashes.reserve(tree.Length());
+        std::ranges::transform(tree.Nodes(), std::back_inserter(hashes), [](auto const& n) { return n.HashValue ^ (static_cast<Operon::Hash>(n.Lag) << 56U); });
+        return Operon::Hasher{}(std::bit_cast<uint8_t const*>(hashes.data()), hashes.size() * sizeof(Operon::Hash));
+    }
+
+    [[nodiscard]] auto Find(Operon::Hash key) const -> std::optional<State> {
+        if (State state; Enabled() && states_.Find(key, state)) { return state; }
+        return std::nullopt;
+    }
+
+    auto Insert(Operon::Hash key, State const& state) const -> void {
+        if (Enabled()) { states_.Insert(key, state); }
+    }
+
+    // applies func to the state of the key under the lock of its shard (a default state is inserted if missing)
+    template<typename F>
+    requires std::invocable<F, State&>
+    auto Update(Operon::Hash key, F&& func) const -> void {
+        if (Enabled()) { states_.Update(key, std::forward<F>(func)); }
+    }
+
+    auto Clear() const -> void { states_.Clear(); }
+
+    // changing the capacity discards all cached states
+    auto SetCapacity(std::size_t capacity) -> void { states_.SetCapacity(capacity); }
+
+    [[nodiscard]] auto Capacity() const -> std::size_t { return states_.Capacity(); }
+    [[nodiscard]] auto Enabled() const -> bool { return Capacity() > 0; }
+    [[nodiscard]] auto Size() const -> std::size_t { return states_.Size(); }
+
+private:
+    ShardedMap<State> states_;
+};
+
+} // namespace Operon
+
+#endif
@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+#ifndef OPERON_SOLVER_NORMAL_EQUATIONS_HPP
+#define OPERON_SOLVER_NORMAL_EQUATIONS_HPP
+
+#include <Eigen/Cholesky>
+#include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Operon {
+
+// levenberg-marquardt solver working directly on the normal equations
+// - same update strategy as ceres::TinySolver, but the function provides J^T J and J^T r instead of the jacobian
+// - the function must implement:
+//     auto Accumulate(Span<T const> x, Matrix& jtj, Vector& jtr) const -> double; // returns 0.5 * ||r||^2
+//     auto Cost(Span<T const> x) const -> double;                                   // returns 0.5 * ||r||^2
+//     auto NumParameters() const -> std::size_t;
+template<typename Function>
+class NormalEquationsSolver {
+public:
+    using Matrix = Eigen::Matrix<double, -1, -1>;
+    using Vector = Eigen::Matrix<double, -1, 1>;
+
+    struct Options {
+        int MaxIterations{50}; // NOLINT
+        double GradientTolerance{1e-10}; // NOLINT
+        double ParameterTolerance{1e-8}; // NOLINT
+        double FunctionTolerance{1e-6}; // NOLINT
+        double CostThreshold{std::numeric_limits<double>::epsilon()};
+        double InitialTrustRegionRadius{1e4}; // NOLINT
+    };
+
+    struct Summary {
+        double InitialCost{-1};
+        double FinalCost{-1};
+        double GradientMaxNorm{-1};
+        int Iterations{0};
+        int FunctionEvaluations{0};
+        int JacobianEvaluations{0};
+        double FinalTrustRegionRadius{-1}; // not set if the solver stopped before the first iteration
+    };
+
+    // x is updated in place
+    template<typename T>
+    auto Solve(Function const& function, Eigen::Matrix<T, -1, 1>& x) -> Summary const&
+    {
+        summary_ = Summary{};
+        auto const p = static_cast<Eigen::Index>(function.NumParameters());
+        if (p == 0) { return summary_; }
+
+        Eigen::Matrix<T, -1, 1> xnew(p);
+        auto update = [&]() {
+            cost_ = function.Accumulate({x.data(), static_cast<std::size_t>(p)}, jtj_, g_);
+            ++summary_.JacobianEvaluations;
+
+            // jacobi scaling (the norms of the jacobian columns are the square roots of the diagonal of J^T J)
+            if (summary_.Iterations == 0) {
+                scaling_ = (1.0 + jtj_.diagonal().array().sqrt()).inverse();
+            }
+            jtj_ = scaling_.asDiagonal() * jtj_ * scaling_.asDiagonal();
+            g_ = -(scaling_.asDiagonal() * g_);
+            summary_.GradientMaxNorm = g_.array().abs().maxCoeff();
+        };
+
+        update();
+        summary_.InitialCost = summary_.FinalCost = cost_;
+        if (summary_.GradientMaxNorm < options_.GradientTolerance || cost_ < options_.CostThreshold) {
+            return summary_;
+        }
+
+        auto u = 1.0 / options_.InitialTrustRegionRadius;
+        auto v = 2.0;
+
+        constexpr auto minDiagonal{1e-6};
+        constexpr auto maxDiagonal{1e32};
+
+        for (summary_.Iterations = 1; summary_.Iterations < options_.MaxIterations; ++summary_.Iterations) {
+            Matrix regularized = jtj_;
+            regularized.diagonal().array() += u * jtj_.diagonal().array().max(minDiagonal).min(maxDiagonal);
+
+            Vector const step = solver_.compute(regularized).solve(g_);
+            Vector const dx = scaling_.asDiagonal() * step;
+
+            auto const tolerance = options_.ParameterTolerance * (x.template cast<double>().norm() + options_.ParameterTolerance);
+            if (dx.norm() < tolerance) { break; }
+
+            xnew = (x.template cast<double>() + dx).template cast<T>();
+            auto const newCost = function.Cost({xnew.data(), static_cast<std::size_t>(p)});
+            ++summary_.FunctionEvaluations;
+
+            auto const costChange = 2 * cost_ - 2 * newCost;
+            auto const modelCostChange = step.dot(2 * g_ - jtj_ * step);
+            auto const rho = costChange / modelCostChange;
+
+            if (rho > 0) {
+                // accept the step
+                x = xnew;
+                if (std::abs(costChange) < options_.FunctionTolerance) {
+                    cost_ = newCost;
+                    break;
+                }
+                update();
+                if (summary_.GradientMaxNorm < options_.GradientTolerance || cost_ < options_.CostThreshold) { break; }
+
+                auto const tmp = 2 * rho - 1;
+                u *= std::max(1.0 / 3.0, 1.0 - tmp * tmp * tmp);
+                v = 2;
+            } else {
+                // reject the step and shrink the trust region
+                if (std::abs(costChange) < options_.FunctionTolerance) { break; }
+                u *= v;
+                v *= 2;
+            }
+        }
+
+        summary_.FinalCost = cost_;
+        summary_.FinalTrustRegionRadius = 1.0 / u;
+        return summary_;
+    }
+
+    [[nodiscard]] auto GetOptions() -> Options& { return options_; }
+    [[nodiscard]] auto GetSummary() const -> Summary const& { return summary_; }
+
+private:
+    Options options_;
+    Summary summary_;
+    double cost_{0};
+    Matrix jtj_;
+    Vector g_;
+    Vector scaling_;
+    Eigen::LDLT<Matrix> solver_;
+};
+
+} // namespace Operon
+
+#endif
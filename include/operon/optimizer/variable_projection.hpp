@@ -0,0 +1,185 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_OPTIMIZER_VARIABLE_PROJECTION_HPP
+#define OPERON_OPTIMIZER_VARIABLE_PROJECTION_HPP
+
+#include <Eigen/Core>
+#include <Eigen/QR>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "operon/core/contracts.hpp"
+#include "operon/core/tree.hpp"
+#include "operon/interpreter/interpreter.hpp"
+
+namespace Operon {
+
+// separable least squares (variable projection, see Golub & Pereyra 1973 and Kaufman 1975)
+// - a coefficient is linear if the path from its node to the root only goes through add and sub nodes whose weight is
+//   not a coefficient: the model is then f(x) = sum_j c_j * phi_j(x, theta) + phi_0(x, theta)
+// - the solver only sees the nonlinear coefficients theta: for each theta the linear coefficients are the least
+//   squares solution of the basis phi (given by the corresponding columns of the jacobian) computed via QR
+// - the jacobian of the residual is the projection of the nonlinear columns onto the orthogonal complement of the
+//   basis (the approximation of Kaufman), so it has one column per nonlinear coefficient
+// - same interface as LMCostFunction (jacobian in column-major format) so it can be used with the tiny solver
+// - every evaluation computes the jacobian of the tree (the basis), a second one when the solver asks for the
+//   jacobian of the residual (see FunctionEvaluations and JacobianEvaluations)
+// - with weights (one per row of the range) the outputs, the jacobian of the tree and the target are scaled by sqrt(w),
+//   so that the linear coefficients are the weighted least squares solution and the cost is 0.5 * sum w_i * r_i^2
+template<typename T = Operon::Scalar>
+struct VariableProjectionCostFunction {
+    static auto constexpr Storage{ Eigen::ColMajor };
+    using Scalar = Operon::Scalar;
+
+    enum {
+        NUM_RESIDUALS = Eigen::Dynamic,  // NOLINT
+        NUM_PARAMETERS = Eigen::Dynamic, // NOLINT
+    };
+
+    using Matrix = Eigen::Matrix<Scalar, -1, -1>;
+    using Vector = Eigen::Matrix<Scalar, -1, 1>;
+
+    explicit VariableProjectionCostFunction(InterpreterBase<T> const& interpreter, Operon::Span<Operon::Scalar const> target, Operon::Range const range, Operon::Span<Operon::Scalar const> weights = {})
+        : interpreter_(interpreter)
+        , target_{target}
+        , range_{range}
+        , coefficients_(interpreter.GetTree().GetCoefficients())
+        , linear_(LinearCoefficients(interpreter.GetTree()))
+        , y_(Eigen::Map<Vector const>(target.data(), std::ssize(target)))
+    {
+        EXPECT(target.size() == range.Size());
+        EXPECT(weights.empty() || weights.size() == target.size());
+        if (!weights.empty()) {
+            scale_ = Eigen::Map<Vector const>(weights.data(), std::ssize(weights)).cwiseSqrt();
+            y_ = y_.cwiseProduct(scale_);
+        }
+        for (auto i = 0UL; i < linear_.size(); ++i) {
+            (linear_[i] ? lin_ : nonlin_).push_back(static_cast<Eigen::Index>(i));
+        }
+    }
+
+    // the mask of the linear coefficients of the tree (in the order of Tree::GetCoefficients)
+    [[nodiscard]] static auto LinearCoefficients(Operon::Tree const& tree) -> std::vector<bool>
+    {
+        auto const& nodes = tree.Nodes();
+        // whether the output of the node is added (up to a constant factor) to the output of the tree
+        std::vector<bool> additive(nodes.size());
+        for (auto i = std::ssize(nodes) - 1; i >= 0; --i) {
+            auto const& n = nodes[i];
+            if (i == std::ssize(nodes) - 1) {
+                additive[i] = true;
+            } else {
+                auto const& p = nodes[n.Parent];
+                additive[i] = additive[n.Parent] && p.Is<NodeType::Add, NodeType::Sub>() && !p.Optimize;
+            }
+        }
+
+        std::vector<bool> linear;
+        for (auto i = 0UL; i < nodes.size(); ++i) {
+            if (nodes[i].Optimize) { linear.push_back(additive[i]); }
+        }
+        return linear;
+    }
+
+    // computes the linear coefficients for the given nonlinear ones, the residuals are f(x) - y
+    inline auto Evaluate(Scalar const* parameters, Scalar* residuals, Scalar* jacobian) const -> bool // NOLINT
+    {
+        auto const n = static_cast<Eigen::Index>(target_.size());
+        auto const p = std::ssize(lin_);
+        auto const q = std::ssize(nonlin_);
+        EXPECT(parameters != nullptr || q == 0);
+        if (residuals != nullptr) { ++feval_; }
+
+        for (auto k = 0L; k < q; ++k) { coefficients_[nonlin_[k]] = parameters[k]; }
+
+        // the basis is the jacobian of the linear coefficients, which does not depend on their values
+        Compute();
+        phi_.resize(n, p);
+        for (auto k = 0L; k < p; ++k) { phi_.col(k) = jac_.col(lin_[k]); }
+
+        auto const& y = y_;
+        Vector c(p);
+        for (auto k = 0L; k < p; ++k) { c[k] = coefficients_[lin_[k]]; }
+        Vector const offset = p > 0 ? Vector(f_ - phi_ * c) : f_; // phi_0
+
+        if (p > 0) {
+            qr_.compute(phi_);
+            c = qr_.solve(y - offset);
+        }
+        for (auto k = 0L; k < p; ++k) { coefficients_[lin_[k]] = c[k]; }
+
+        if (residuals != nullptr) {
+            Eigen::Map<Vector>(residuals, n) = offset + phi_ * c - y;
+        }
+
+        if (jacobian != nullptr) {
+            // the nonlinear columns depend on the linear coefficients
+            Compute();
+            Eigen::Map<Matrix> jac(jacobian, n, q);
+            for (auto k = 0L; k < q; ++k) { jac.col(k) = jac_.col(nonlin_[k]); }
+            if (p > 0) { jac -= phi_ * qr_.solve(jac); }
+        }
+        return true;
+    }
+
+    auto operator()(Scalar const* parameters, Scalar* residuals, Scalar* jacobian) const -> bool
+    {
+        return Evaluate(parameters, residuals, jacobian);
+    }
+
+    [[nodiscard]] auto NumResiduals() const -> int { return static_cast<int>(target_.size()); }
+    [[nodiscard]] auto NumParameters() const -> int { return static_cast<int>(nonlin_.size()); }
+    [[nodiscard]] auto NumLinearParameters() const -> int { return static_cast<int>(lin_.size()); }
+
+    // the nonlinear coefficients (the parameters of the solver)
+    [[nodiscard]] auto NonlinearCoefficients() const -> Vector
+    {
+        Vector theta(std::ssize(nonlin_));
+        for (auto k = 0L; k < theta.size(); ++k) { theta[k] = coefficients_[nonlin_[k]]; }
+        return theta;
+    }
+
+    // all the coefficients, with the linear ones from the last evaluation
+    [[nodiscard]] auto Coefficients() const -> std::vector<Operon::Scalar> const& { return coefficients_; }
+
+    // the residuals and the jacobians of the tree computed so far
+    [[nodiscard]] auto FunctionEvaluations() const -> std::size_t { return feval_; }
+    [[nodiscard]] auto JacobianEvaluations() const -> std::size_t { return jeval_; }
+
+private:
+    auto Compute() const -> void {
+        auto const n = static_cast<Eigen::Index>(target_.size());
+        f_.resize(n);
+        jac_.resize(n, std::ssize(coefficients_));
+        ++jeval_;
+        interpreter_.get().JacRev(coefficients_, range_, { f_.data(), static_cast<std::size_t>(n) }, { jac_.data(), static_cast<std::size_t>(jac_.size()) });
+        if (scale_.size() > 0) {
+            f_ = f_.cwiseProduct(scale_);
+            jac_ = scale_.asDiagonal() * jac_;
+        }
+    }
+
+    std::reference_wrapper<InterpreterBase<T> const> interpreter_;
+    Operon::Span<Operon::Scalar const> target_;
+    Operon::Range range_;
+    mutable std::vector<Operon::Scalar> coefficients_;
+    std::vector<bool> linear_;
+    std::vector<Eigen::Index> lin_;
+    std::vector<Eigen::Index> nonlin_;
+    Vector y_;     // the target (scaled by the square roots of the weights)
+    Vector scale_; // the square roots of the weights (empty without weights)
+
+    // buffers
+    mutable Vector f_;
+    mutable Matrix jac_;
+    mutable Matrix phi_;
+    mutable Eigen::ColPivHouseholderQR<Matrix> qr_;
+    mutable std::size_t feval_{0};
+    mutable std::size_t jeval_{0};
+};
+
+} // namespace Operon
+
+#endif
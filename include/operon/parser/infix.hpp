@@ -16,6 +16,8 @@ namespace detail {
     using Token = pratt::token<Operon::Vector<Node>>;
     using TokenMap = Operon::Map<std::string, detail::Token, Operon::Hasher, std::equal_to<>>;
     using VariableMap = Operon::Map<std::string, Operon::Hash>;
+    // variable hashes keyed by name, with transparent lookup (no key is allocated for a lookup)
+    using VariableLookup = Operon::Map<std::string, Operon::Hash, Operon::Hasher, std::equal_to<>>;
 } // namespace detail
 
 struct OPERON_EXPORT InfixParser {
@@ -24,6 +26,20 @@ struct OPERON_EXPORT InfixParser {
 
 static auto Parse(std::string const& infix, detail::VariableMap const& vars, detail::TokenMap const& tokens, bool reduce = false) -> Tree;
 static auto Parse(std::string const& infix, detail::VariableMap const& vars, bool reduce = false) -> Tree;
+
+// the default operators and functions (built once)
+static auto DefaultTokens() -> detail::TokenMap const&;
+
+// parser for many expressions over the same variables (eg. when loading stored models)
+// - the token table and the variable lookup are built once and shared by all calls
+// - an instance can be used by several threads at the same time
+explicit InfixParser(detail::VariableMap const& vars, detail::TokenMap tokens = DefaultTokens());
+
+[[nodiscard]] auto operator()(std::string const& infix, bool reduce = false) const -> Tree;
+
+private:
+    detail::TokenMap tokens_;
+    detail::VariableLookup vars_;
 };
 } // namespace Operon
 
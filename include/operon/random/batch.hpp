@@ -0,0 +1,212 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_RANDOM_BATCH_HPP
+#define OPERON_RANDOM_BATCH_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <random>
+#include <span>
+#include <type_traits>
+
+#include "operon/core/contracts.hpp"
+#include "romu.hpp"
+
+namespace Operon::Random {
+
+// true if the generator produces uniform 64-bit values (required by Bounded)
+template<typename R>
+inline constexpr bool IsFull64 = (R::min)() == 0 && (R::max)() == std::numeric_limits<uint64_t>::max();
+
+// a uniform integer in [0, n) with Lemire's nearly divisionless method (https://arxiv.org/abs/1805.10941)
+// - the value is the upper half of the 128-bit product of a random value with n, the division is only
+//   computed on the rare occasions when the lower half falls in the biased region
+// - without 128-bit integers it falls back to std::uniform_int_distribution
+template<typename R>
+inline auto Bounded(R& random, uint64_t n) -> uint64_t
+{
+    static_assert(IsFull64<R>, "the generator must produce uniform 64-bit values");
+    EXPECT(n > 0);
+#if defined(__SIZEOF_INT128__)
+    using U128 = unsigned __int128;
+    auto m = static_cast<U128>(random()) * n;
+    auto l = static_cast<uint64_t>(m);
+    if (l < n) {
+        auto const t = (0 - n) % n; // 2^64 mod n
+        while (l < t) {
+            m = static_cast<U128>(random()) * n;
+            l = static_cast<uint64_t>(m);
+        }
+    }
+    return static_cast<uint64_t>(m >> 64U); // NOLINT
+#else
+    return std::uniform_int_distribution<uint64_t>(0, n - 1)(random);
+#endif
+}
+
+// a uniform value in [0, 1) from the upper bits of a 64-bit value (53 bits for double, 24 bits for float)
+template<typename T>
+inline auto Canonical(uint64_t v) noexcept -> T
+{
+    static_assert(std::is_floating_point_v<T>);
+    constexpr auto bits = std::numeric_limits<T>::digits;
+    constexpr auto scale = T{1} / static_cast<T>(UINT64_C(1) << static_cast<unsigned>(bits));
+    return static_cast<T>(v >> (64U - bits)) * scale; // NOLINT
+}
+
+namespace detail {
+    // fills the output with raw 64-bit values, the batch generators fill it in bulk
+    template<typename R>
+    inline auto FillRaw(R& random, std::span<uint64_t> out) noexcept -> void
+    {
+        if constexpr (requires { random.Fill(out); }) {
+            random.Fill(out);
+        } else {
+            for (auto& v : out) { v = random(); }
+        }
+    }
+
+    constexpr std::size_t FillChunk { 64 }; // number of raw values converted together
+} // namespace detail
+
+// fills the output with uniform values in [a, b)
+// - the raw values are drawn in chunks and converted with Canonical, the conversion loop has no branches and is
+//   vectorized by the compiler (unlike std::uniform_real_distribution, which calls std::generate_canonical per value)
+template<typename R, typename T>
+inline auto FillUniform(R& random, std::span<T> out, T a, T b) noexcept -> void
+{
+    static_assert(IsFull64<R>, "the generator must produce uniform 64-bit values");
+    std::array<uint64_t, detail::FillChunk> raw; // NOLINT
+    for (auto i = 0UL; i < out.size(); i += raw.size()) {
+        auto const n = std::min(raw.size(), out.size() - i);
+        detail::FillRaw(random, std::span{raw.data(), n});
+        for (auto j = 0UL; j < n; ++j) {
+            out[i + j] = a + (b - a) * Canonical<T>(raw[j]);
+        }
+    }
+}
+
+// fills the output with normal values with the given mean and standard deviation
+// - the values are produced in pairs with the Box-Muller transform from bulk uniform values, there is no rejection
+//   loop (std::normal_distribution uses the polar method, which rejects about a fifth of the pairs)
+template<typename R, typename T>
+inline auto FillNormal(R& random, std::span<T> out, T mean, T stddev) noexcept -> void
+{
+    static_assert(IsFull64<R>, "the generator must produce uniform 64-bit values");
+    std::array<uint64_t, detail::FillChunk> raw; // NOLINT
+    for (auto i = 0UL; i < out.size(); i += raw.size()) {
+        auto const n = std::min(raw.size(), out.size() - i);
+        auto const m = n + (n % 2); // an odd tail still takes a whole pair
+        detail::FillRaw(random, std::span{raw.data(), m});
+        for (auto j = 0UL; j < m; j += 2) {
+            auto const r = std::sqrt(T{-2} * std::log(T{1} - Canonical<T>(raw[j]))); // 1 - u is in (0, 1]
+            auto const t = T{2} * std::numbers::pi_v<T> * Canonical<T>(raw[j + 1]);
+            out[i + j] = mean + stddev * r * std::cos(t);
+            if (j + 1 < n) { out[i + j + 1] = mean + stddev * r * std::sin(t); }
+        }
+    }
+}
+
+// N independent RomuTrio generators (lanes) advanced together
+// - the states are stored by component, so that a step updates all the lanes with the same instructions and the
+//   loop is vectorized by the compiler (the lanes do not depend on each other)
+// - the values are produced N at a time and handed out one at a time by operator(), or in bulk by Fill
+// - the lanes are seeded from a splitmix64 sequence, the stream is not the same as the one of RomuTrio
+template<std::size_t N = 8>
+class RomuTrioX final {
+public:
+    using result_type = uint64_t;
+
+    static constexpr auto(min)() -> result_type { return 0; }
+    static constexpr auto(max)() -> result_type { return std::numeric_limits<result_type>::max(); }
+
+    explicit RomuTrioX(uint64_t seed) noexcept
+    {
+        for (auto i = 0UL; i < N; ++i) {
+            x_[i] = detail::splitMix64(seed);
+            y_[i] = detail::splitMix64(seed);
+            z_[i] = detail::splitMix64(seed);
+        }
+        constexpr auto warmup { 10 };
+        for (auto i = 0; i < warmup; ++i) { Step(buffer_.data()); }
+    }
+
+    // disallow copying (to prevent misuse), like the other generators
+    RomuTrioX(RomuTrioX const&) = delete;
+    auto operator=(RomuTrioX const&) -> RomuTrioX& = delete;
+
+    RomuTrioX(RomuTrioX&&) noexcept = default;
+    auto operator=(RomuTrioX&&) noexcept -> RomuTrioX& = default;
+
+    ~RomuTrioX() noexcept = default;
+
+    auto operator()() noexcept -> result_type
+    {
+        if (pos_ == N) {
+            Step(buffer_.data());
+            pos_ = 0;
+        }
+        return buffer_[pos_++];
+    }
+
+    // fills the output with random values, whole steps are written directly to the output
+    auto Fill(std::span<result_type> out) noexcept -> void
+    {
+        auto i = 0UL;
+        for (; i < out.size() && pos_ < N; ++i) { out[i] = buffer_[pos_++]; }
+        for (; i + N <= out.size(); i += N) { Step(out.data() + i); }
+        for (; i < out.size(); ++i) { out[i] = (*this)(); }
+    }
+
+    // fills the output with uniform integers in [0, n)
+    // - the random values are generated in bulk and then scaled in place, the few values that fall in the
+    //   biased region (see Bounded) are drawn again
+    auto Fill(std::span<result_type> out, uint64_t n) noexcept -> void
+    {
+        EXPECT(n > 0);
+#if defined(__SIZEOF_INT128__)
+        Fill(out);
+        using U128 = unsigned __int128;
+        auto const t = (0 - n) % n;
+        for (auto& v : out) {
+            auto const m = static_cast<U128>(v) * n;
+            v = static_cast<uint64_t>(m) < t ? Bounded(*this, n) : static_cast<uint64_t>(m >> 64U); // NOLINT
+        }
+#else
+        for (auto& v : out) { v = Bounded(*this, n); }
+#endif
+    }
+
+private:
+    auto Step(result_type* out) noexcept -> void
+    {
+        constexpr auto mul { UINT64_C(15241094284759029579) };
+        constexpr auto ry { 12U };
+        constexpr auto rz { 44U };
+        for (auto i = 0UL; i < N; ++i) {
+            auto const xp = x_[i];
+            auto const yp = y_[i];
+            auto const zp = z_[i];
+            x_[i] = mul * zp;
+            y_[i] = detail::rotl(yp - xp, ry);
+            z_[i] = detail::rotl(zp - yp, rz);
+            out[i] = xp;
+        }
+    }
+
+    alignas(64) std::array<uint64_t, N> x_{}; // NOLINT
+    alignas(64) std::array<uint64_t, N> y_{}; // NOLINT
+    alignas(64) std::array<uint64_t, N> z_{}; // NOLINT
+    alignas(64) std::array<uint64_t, N> buffer_{}; // NOLINT
+    std::size_t pos_{N};
+};
+
+} // namespace Operon::Random
+
+#endif
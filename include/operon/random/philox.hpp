@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_RANDOM_PHILOX_HPP
+#define OPERON_RANDOM_PHILOX_HPP
+
+#include <array>
+#include <cstdint>
+
+namespace Operon::Random {
+
+namespace detail {
+    // the high and low halves of the 128-bit product
+    constexpr auto MulHiLo(uint64_t a, uint64_t b) noexcept -> std::array<uint64_t, 2>
+    {
+#if defined(__SIZEOF_INT128__)
+        auto const p = static_cast<unsigned __int128>(a) * b;
+        return { static_cast<uint64_t>(p >> 64U), static_cast<uint64_t>(p) }; // NOLINT
+#else
+        constexpr auto mask { UINT64_C(0xFFFFFFFF) };
+        auto const a0 = a & mask;
+        auto const a1 = a >> 32U;
+        auto const b0 = b & mask;
+        auto const b1 = b >> 32U;
+        auto const p00 = a0 * b0;
+        auto const p01 = a0 * b1;
+        auto const p10 = a1 * b0;
+        auto const p11 = a1 * b1;
+        auto const mid = (p00 >> 32U) + (p01 & mask) + (p10 & mask);
+        return { p11 + (p01 >> 32U) + (p10 >> 32U) + (mid >> 32U), a * b };
+#endif
+    }
+} // namespace detail
+
+// the Philox2x64-10 counter-based generator (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC 2011)
+// - the output is a pure function of the key and the counter, so that independent streams can be derived from
+//   their coordinates (eg. the generation and the slot of an offspring) in any order and on any thread
+constexpr auto Philox(uint64_t key, uint64_t c0, uint64_t c1) noexcept -> std::array<uint64_t, 2>
+{
+    constexpr auto multiplier { UINT64_C(0xD2B74407B1CE6E93) };
+    constexpr auto weyl { UINT64_C(0x9E3779B97F4A7C15) };
+    constexpr auto rounds { 10 };
+    for (auto r = 0; r < rounds; ++r) {
+        auto const [hi, lo] = detail::MulHiLo(multiplier, c0);
+        c0 = hi ^ key ^ c1;
+        c1 = lo;
+        key += weyl;
+    }
+    return { c0, c1 };
+}
+
+} // namespace Operon::Random
+
+#endif
@@ -5,12 +5,17 @@
 #define OPERON_RANDOM_HPP
 
 #include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <random>
+#include <span>
 #include <type_traits>
 
 #include "operon/core/contracts.hpp"
 
+#include "batch.hpp"
 #include "jsf.hpp"
+#include "philox.hpp"
 #include "romu.hpp"
 #include "sfc64.hpp"
 //#include "wyrand.hpp"
@@ -20,6 +25,13 @@ template<typename R, typename T>
 auto Uniform(R& random, T a, T b) -> T
 {
     static_assert(std::is_arithmetic_v<T>, "T must be an arithmetic type.");
+    // integers from a 64-bit generator are drawn without a division in most cases (see Bounded)
+    if constexpr (std::is_integral_v<T> && IsFull64<R> && sizeof(T) <= sizeof(uint64_t)) {
+        EXPECT(a <= b);
+        auto const range = static_cast<uint64_t>(b) - static_cast<uint64_t>(a);
+        if (range == std::numeric_limits<uint64_t>::max()) { return static_cast<T>(random()); }
+        return static_cast<T>(static_cast<uint64_t>(a) + Bounded(random, range + 1));
+    }
     using Dist = std::conditional_t<std::is_integral_v<T>, std::uniform_int_distribution<T>, std::uniform_real_distribution<T>>;
     return Dist(a,b)(random);
 }
@@ -55,6 +67,23 @@ auto Sample(R& random, InputIterator start, InputIterator end,
     return it;
 }
 
+// draws out.size() values from the distribution
+// - the uniform real and normal distributions are drawn in bulk (see FillUniform and FillNormal), the values are not
+//   the ones the distribution would draw from the same generator
+// - the other distributions are drawn one value at a time
+template <typename R, typename Dist>
+auto Draw(R& random, Dist& dist, std::span<typename Dist::result_type> out) -> void
+{
+    using T = typename Dist::result_type;
+    if constexpr (IsFull64<R> && std::is_same_v<Dist, std::uniform_real_distribution<T>>) {
+        FillUniform(random, out, dist.a(), dist.b());
+    } else if constexpr (IsFull64<R> && std::is_same_v<Dist, std::normal_distribution<T>>) {
+        FillNormal(random, out, dist.mean(), dist.stddev());
+    } else {
+        for (auto& v : out) { v = dist(random); }
+    }
+}
+
 // sample n elements and write them to the output iterator
 template <typename R, typename InputIterator, typename OutputIterator>
 auto Sample(R& random, InputIterator start, InputIterator end, OutputIterator out, size_t n) -> OutputIterator
@@ -4,6 +4,7 @@
 #ifndef OPERON_RANDOM_ROMU_HPP // NOLINT
 #define OPERON_RANDOM_ROMU_HPP // NOLINT
  // NOLINT
+#include <array> // NOLINT
 #include <cstddef> // NOLINT
 #include <cstdint> // NOLINT
 #include <limits> // NOLINT
@@ -61,6 +62,10 @@ namespace Random { // NOLINT
             return xp; // NOLINT
         } // NOLINT
  // NOLINT
+        // the internal state, eg. for saving and resuming a run // NOLINT
+        using state_type = std::array<uint64_t, 3>; // NOLINT
+        [[nodiscard]] inline state_type get_state() const noexcept { return { state.x, state.y, state.z }; } // NOLINT
+        inline void set_state(state_type const& s) noexcept { state = { s[0], s[1], s[2] }; } // NOLINT
  // NOLINT
     private: // NOLINT
         struct state { // NOLINT
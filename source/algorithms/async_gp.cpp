@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <algorithm>                         // for max, min
+#include <atomic>                            // for atomic_bool
+#include <chrono>                            // for steady_clock
+#include <mutex>                             // for mutex, scoped_lock
+#include <shared_mutex>                      // for shared_mutex, shared_lock
+#include <taskflow/taskflow.hpp>             // for taskflow
+#include <taskflow/algorithm/for_each.hpp>   // for taskflow.for_each_index
+#include <utility>                           // for move
+#include <vector>                            // for vector
+
+#include "operon/algorithms/async_gp.hpp"
+#include "operon/core/contracts.hpp"         // for ENSURE
+#include "operon/core/memory.hpp"            // for Grow
+#include "operon/core/pool.hpp"              // for ObjectPool
+#include "operon/core/operator.hpp"          // for OperatorBase
+#include "operon/core/problem.hpp"           // for Problem
+#include "operon/core/range.hpp"             // for Range
+#include "operon/core/tree.hpp"              // for Tree
+#include "operon/operators/initializer.hpp"  // for CoefficientInitializerBase
+#include "operon/operators/reinserter.hpp"   // for ReinserterBase
+
+namespace Operon {
+auto AsyncGeneticProgrammingAlgorithm::Run(tf::Executor& executor, Operon::RandomGenerator& random, std::function<void()> report) -> void
+{
+    const auto& config = GetConfig();
+    const auto& treeInit = GetTreeInitializer();
+    const auto& coeffInit = GetCoefficientInitializer();
+    const auto& generator = GetGenerator();
+    const auto& reinserter = GetReinserter();
+    const auto& problem = GetProblem();
+
+    auto t0 = std::chrono::steady_clock::now();
+    auto elapsed = [t0]() {
+        auto t1 = std::chrono::steady_clock::now();
+        constexpr double ms{1e3};
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count()) / ms;
+    };
+
+    ENSURE(executor.num_workers() > 0);
+    auto const workers { executor.num_workers() };
+
+    // random seeds for the initialization and for each worker
+    auto parents = Parents();
+    std::vector<Operon::RandomGenerator> rngs;
+    for (size_t i = 0; i < std::max(parents.size(), workers); ++i) {
+        rngs.emplace_back(random());
+    }
+
+    auto const& evaluator = generator.Evaluator();
+    auto const trainSize = problem.TrainingRange().Size();
+    if (config.HugePages) { (void)problem.GetDataset().AdviseHugePages(); }
+    // held by the tasks rather than by the workers, a worker running a corun (see RunTaskflow) can start another task
+    Operon::ObjectPool<Operon::Vector<Operon::Scalar>> slots;
+    Operon::ObjectPool<Operon::Vector<Operon::Scalar>> tiles;
+    auto const tileSize { evaluator.EvaluationGroupSize() };
+
+    insertions_ = 0;
+    auto const generationSize { std::max(config.PoolSize, size_t{1}) };
+    std::mutex mutex; // guards the population and the generation counter
+    std::atomic_bool finished{ Generation() >= config.Generations }; // lock-free view of the generation limit
+
+    // the parents are selected from a copy of the population, which the selectors are prepared with (they keep a
+    // snapshot of its fitness), so that the population can change while they are used
+    // - the copy is replaced every refreshInterval insertions (each worker inserts about one child in between), and
+    //   the selectors are prepared again outside of the population lock
+    // - version is the number of insertions the copy was taken after, an older copy is not installed
+    std::shared_mutex selection; // guards the copy and the selectors
+    std::vector<Individual> snapshot;
+    size_t version{0};
+    auto const refreshInterval { std::max(workers, size_t{1}) };
+
+    auto stop = [&]() {
+        return finished || generator.Terminate() || elapsed() > static_cast<double>(config.TimeLimit);
+    };
+
+    tf::Taskflow taskflow;
+    auto resetInit = taskflow.emplace([&]() { treeInit.Reset(); }).name("reset initializer");
+    auto init = taskflow.for_each_index(size_t{0}, parents.size(), TreeInitializerBase::DefaultGroupSize, [&](size_t i) {
+        auto const n = std::min(TreeInitializerBase::DefaultGroupSize, parents.size() - i);
+        std::vector<Tree> trees(n);
+        treeInit.Initialize({ rngs.data() + i, n }, trees);
+        for (auto j = i; j < i + n; ++j) {
+            parents[j].Genotype = std::move(trees[j - i]);
+            coeffInit(rngs[j], parents[j].Genotype);
+        }
+    }).name("initialize population");
+    auto prepareEval = taskflow.emplace([&]() { evaluator.Prepare(parents); }).name("prepare evaluator");
+    auto eval = taskflow.for_each_index(size_t{0}, parents.size(), tileSize, [&](size_t i) {
+        auto const n = std::min(tileSize, parents.size() - i);
+        auto tile = tiles.Acquire();
+        evaluator.Evaluate(rngs[i], parents.subspan(i, n), *tile);
+    }).name("evaluate population");
+    auto prepareGenerator = taskflow.emplace([&]() {
+        snapshot.assign(parents.begin(), parents.end());
+        generator.Prepare(snapshot);
+        if (report) { std::invoke(report); }
+    }).name("prepare generator");
+
+    // one long-running task per worker, no synchronization besides the population lock
+    auto evolve = [&](size_t w) {
+        auto& rng = rngs[w];
+        auto lease = slots.Acquire();
+        auto& slot = *lease;
+        Operon::Grow(slot, trainSize, config.HugePages);
+
+        Individual child; // reused between the iterations of the worker
+        std::vector<Individual> copy; // the next copy of the population, reuses the one it replaces
+        while (!stop()) {
+            RecombinationResult res;
+            {
+                std::shared_lock lock(selection);
+                res.Parent1 = snapshot[generator.FemaleSelector()(rng)];
+                res.Parent2 = snapshot[generator.MaleSelector()(rng)];
+            }
+
+            if (!generator.Generate(rng, config.CrossoverProbability, config.MutationProbability, config.LocalSearchProbability, slot, res, child)) { continue; }
+
+            auto newGeneration{false};
+            auto refresh{false};
+            size_t n{0};
+            {
+                std::scoped_lock lock(mutex);
+                if (finished) { break; }
+                reinserter(rng, parents, { &child, 1 });
+                n = ++insertions_;
+                newGeneration = n % generationSize == 0;
+                refresh = newGeneration || n % refreshInterval == 0;
+                if (newGeneration) {
+                    finished = ++Generation() >= config.Generations;
+                    if (report) { std::invoke(report); }
+                }
+                if (refresh) { copy.assign(parents.begin(), parents.end()); }
+            }
+            if (!refresh) { continue; }
+
+            std::unique_lock lock(selection);
+            if (n > version) {
+                snapshot.swap(copy);
+                version = n;
+            }
+            if (newGeneration) {
+                generator.Prepare(snapshot);
+            } else if (version == n) {
+                generator.FemaleSelector().Prepare(snapshot);
+                generator.MaleSelector().Prepare(snapshot);
+            }
+        }
+    };
+
+    resetInit.precede(init);
+    init.precede(prepareEval);
+    prepareEval.precede(eval);
+    eval.precede(prepareGenerator);
+    for (size_t w = 0; w < workers; ++w) {
+        prepareGenerator.precede(taskflow.emplace([&evolve, w]() { evolve(w); }).name("evolve"));
+    }
+    taskflow.name("async GP");
+
+    executor.run(taskflow);
+    executor.wait_for_all();
+}
+
+auto AsyncGeneticProgrammingAlgorithm::Run(Operon::RandomGenerator& random, std::function<void()> report, size_t threads, AffinityPolicy affinity) -> void {
+    auto executor = MakeExecutor(threads, affinity);
+    Run(*executor, random, std::move(report));
+}
+} // namespace Operon
@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include "operon/algorithms/checkpoint.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fmt/core.h>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#include "operon/core/serialization.hpp"
+
+namespace Operon {
+
+namespace {
+    constexpr uint32_t CheckpointMagic{0x4B43504FU}; // "OPCK"
+
+    template<typename T>
+    auto WriteValue(std::ostream& out, T const& value) -> void
+    {
+        out.write(reinterpret_cast<char const*>(&value), sizeof(T)); // NOLINT
+    }
+
+    template<typename T>
+    auto ReadValue(std::istream& in) -> T
+    {
+        T value;
+        if (!in.read(reinterpret_cast<char*>(&value), sizeof(T))) { // NOLINT
+            throw std::runtime_error("truncated checkpoint");
+        }
+        return value;
+    }
+} // namespace
+
+auto WriteCheckpoint(std::ostream& out, AlgorithmState const& state) -> void
+{
+    WriteValue<uint32_t>(out, CheckpointMagic);
+    WriteValue<uint32_t>(out, CheckpointVersion);
+    WriteValue<uint64_t>(out, state.Generation);
+    WriteValue<double>(out, state.Elapsed);
+    WriteValue(out, state.Random);
+    WriteValue<uint64_t>(out, state.Rngs.size());
+    for (auto const& r : state.Rngs) { WriteValue(out, r); }
+    WriteValue(out, state.Counters);
+    Serialization::WritePopulation(out, state.Parents);
+    if (!out) {
+        throw std::runtime_error("failed to write the checkpoint");
+    }
+}
+
+auto ReadCheckpoint(std::istream& in) -> AlgorithmState
+{
+    if (ReadValue<uint32_t>(in) != CheckpointMagic) {
+        throw std::runtime_error("not a checkpoint");
+    }
+    if (auto const version = ReadValue<uint32_t>(in); version != CheckpointVersion) {
+        throw std::runtime_error(fmt::format("unsupported checkpoint version {} (expected {})", version, CheckpointVersion));
+    }
+    AlgorithmState state;
+    state.Generation = ReadValue<uint64_t>(in);
+    state.Elapsed = ReadValue<double>(in);
+    state.Random = ReadValue<AlgorithmState::RandomState>(in);
+    auto const n = ReadValue<uint64_t>(in);
+    for (auto i = 0UL; i < n; ++i) {
+        state.Rngs.push_back(ReadValue<AlgorithmState::RandomState>(in));
+    }
+    state.Counters = ReadValue<decltype(state.Counters)>(in);
+    state.Parents = Serialization::ReadPopulation(in);
+    return state;
+}
+
+auto ReadCheckpoint(std::string const& path) -> AlgorithmState
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error(fmt::format("cannot open {}", path));
+    }
+    return ReadCheckpoint(in);
+}
+
+CheckpointWriter::CheckpointWriter(std::string path, std::size_t interval)
+    : path_(std::move(path))
+    , interval_(std::max(interval, std::size_t{1}))
+    , thread_([this]() { Work(); })
+{
+}
+
+CheckpointWriter::~CheckpointWriter()
+{
+    {
+        std::scoped_lock lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+}
+
+auto CheckpointWriter::Rethrow() -> void
+{
+    if (error_) {
+        std::rethrow_exception(std::exchange(error_, nullptr));
+    }
+}
+
+auto CheckpointWriter::Submit(AlgorithmState state) -> void
+{
+    {
+        std::scoped_lock lock(mutex_);
+        Rethrow();
+        pending_ = std::move(state);
+    }
+    cv_.notify_all();
+}
+
+auto CheckpointWriter::Wait() -> void
+{
+    std::unique_lock lock(mutex_);
+    cv_.wait(lock, [&]() { return !pending_ && !busy_; });
+    Rethrow();
+}
+
+auto CheckpointWriter::Count() const -> std::size_t
+{
+    std::scoped_lock lock(mutex_);
+    return count_;
+}
+
+auto CheckpointWriter::Work() -> void
+{
+    std::unique_lock lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [&]() { return stop_ || pending_; });
+        if (!pending_) { return; } // stopped with nothing left to write
+
+        auto state = std::move(*pending_);
+        pending_.reset();
+        busy_ = true;
+        lock.unlock();
+
+        std::exception_ptr error;
+        try {
+            auto const tmp = path_ + ".tmp";
+            {
+                std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+                if (!out) { throw std::runtime_error(fmt::format("cannot open {} for writing", tmp)); }
+                WriteCheckpoint(out, state);
+            }
+            std::filesystem::rename(tmp, path_);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        busy_ = false;
+        if (error) { error_ = error; } else { ++count_; }
+        cv_.notify_all();
+    }
+}
+
+} // namespace Operon
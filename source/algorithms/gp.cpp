@@ -4,20 +4,33 @@
 #include <algorithm>                         // for max, min_element
 #include <atomic>                            // for atomic_bool
 #include <chrono>                            // for steady_clock
+#include <cmath>                             // for isfinite
+#include <functional>                        // for plus
+#include <limits>                            // for numeric_limits
 #include <memory>                            // for allocator, allocator_tra...
+#include <numeric>                           // for transform_reduce
 #include <optional>                          // for optional
+#include <random>                            // for bernoulli_distribution
 #include <taskflow/taskflow.hpp>             // for taskflow, subflow
 #include <taskflow/algorithm/for_each.hpp>   // for taskflow.for_each_index
+#include <utility>                           // for move
 #include <vector>                            // for vector, vector::size_type
 
 #include "operon/algorithms/gp.hpp"
 #include "operon/core/contracts.hpp"         // for ENSURE
+#include "operon/core/memory.hpp"            // for Grow, CapacityBytes
+#include "operon/core/pool.hpp"              // for ObjectPool
 #include "operon/core/operator.hpp"          // for OperatorBase
 #include "operon/core/problem.hpp"           // for Problem
+#include "operon/algorithms/task_trace.hpp"  // for TaskTrace
+#include "operon/algorithms/termination.hpp" // for TerminationCriteria
+#include "operon/algorithms/validation.hpp"  // for ValidationMonitor
+#include "operon/core/profiler.hpp"          // for Profiler
 #include "operon/core/range.hpp"             // for Range
 #include "operon/core/tree.hpp"              // for Tree
 #include "operon/operators/initializer.hpp"  // for CoefficientInitializerBase
 #include "operon/operators/reinserter.hpp"   // for ReinserterBase
+#include "scheduling.hpp"                    // for ScheduleGroups
 
 namespace Operon {
 auto GeneticProgrammingAlgorithm::Run(tf::Executor& executor, Operon::RandomGenerator& random, std::function<void()> report) -> void
@@ -29,13 +42,6 @@ auto GeneticProgrammingAlgorithm::Run(tf::Executor& executor, Operon::RandomGene
     const auto& reinserter = GetReinserter();
     const auto& problem = GetProblem();
 
-    auto t0 = std::chrono::steady_clock::now();
-    auto elapsed = [t0]() {
-        auto t1 = std::chrono::steady_clock::now();
-        constexpr double ms{1e3};
-        return static_cast<double>(std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count()) / ms;
-    };
-
     // random seeds for each thread
     size_t s = std::max(config.PopulationSize, config.PoolSize);
     std::vector<Operon::RandomGenerator> rngs;
@@ -43,71 +49,265 @@ auto GeneticProgrammingAlgorithm::Run(tf::Executor& executor, Operon::RandomGene
         rngs.emplace_back(random());
     }
 
+    // the key of the streams of a deterministic run, drawn before a restored state replaces the one of random
+    auto const streamKey = config.Deterministic ? random() : 0;
+
+    // a restored run continues with the evaluated parents of the checkpoint (see GeneticAlgorithmBase::Restore)
+    auto const resumed = Resume(random, rngs);
+
+    // a continued run keeps the parents, but evaluates them again (see Continue)
+    auto const keep = resumed.has_value() || std::exchange(continue_, false);
+
+    auto t0 = std::chrono::steady_clock::now();
+    auto elapsed = [t0, offset = resumed.value_or(0.0)]() {
+        auto t1 = std::chrono::steady_clock::now();
+        constexpr double ms{1e3};
+        return offset + static_cast<double>(std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count()) / ms;
+    };
+
     auto idx = 0;
     auto const& evaluator = generator.Evaluator();
+    auto* profiler = generator.GetProfiler();
+    auto* trace = GetTaskTrace();
+    auto* validation = GetValidation();
 
     // we want to allocate all the memory that will be necessary for evaluation (e.g. for storing model responses)
     // in one go and use it throughout the generations in order to minimize the memory pressure
     auto trainSize = problem.TrainingRange().Size();
+    if (config.HugePages) { (void)problem.GetDataset().AdviseHugePages(); }
 
     ENSURE(executor.num_workers() > 0);
-    std::vector<Operon::Vector<Operon::Scalar>> slots(executor.num_workers());
+    // the buffers are held by the tasks rather than by the workers: a worker that coruns a nested evaluation (see
+    // RunTaskflow) can start another generation or evaluation task, which must not write the buffer in use
+    Operon::ObjectPool<Operon::Vector<Operon::Scalar>> slots;
+    // separate buffers for evaluating groups of individuals (initial population)
+    Operon::ObjectPool<Operon::Vector<Operon::Scalar>> tiles;
+    auto const tileSize { evaluator.EvaluationGroupSize() };
+    // the groups of the population evaluated by one task, in the order given by detail::ScheduleGroups
+    std::vector<size_t> evalSchedule;
 
     tf::Taskflow taskflow;
 
+    // the convergence criteria are updated with the parents between generations
+    TerminationCriteria criteria{config};
+
     auto stop = [&]() {
-        return generator.Terminate() || Generation() == config.Generations || elapsed() > static_cast<double>(config.TimeLimit);
+        return generator.Terminate() || Generation() == config.Generations || elapsed() > static_cast<double>(config.TimeLimit)
+            || (validation != nullptr && validation->EarlyStop()) || criteria.Terminated();
     };
 
     auto parents = Parents();
     auto offspring = Offspring();
+    auto const evalGroups = (parents.size() + tileSize - 1) / tileSize;
+
+    // optional local search step: the offspring that drew the local search are neither optimized nor evaluated by the
+    // generator, they are optimized together afterwards and evaluated once, after their optimization
+    // - only with a generator that accepts every child (see OffspringGeneratorBase::AcceptsEveryChild), the other
+    //   generators choose among their children by fitness and optimize them while generating
+    auto const* optimizer = generator.Optimizer();
+    auto const batchedLocalSearch = config.BatchedLocalSearch && optimizer != nullptr && generator.AcceptsEveryChild();
+    auto const pLocal = batchedLocalSearch ? 0.0 : config.LocalSearchProbability;
+    std::vector<uint8_t> pending(offspring.size(), 0);
+    auto const localSearchGroups = offspring.size() > 1 ? (offspring.size() - 2) / tileSize + 1 : 0;
+    std::vector<size_t> localSearchSchedule;
+
+    // pooled generation: instead of each offspring slot retrying until it is filled, every worker produces children
+    // and puts each accepted one into the next free slot, so that the workers that are done help the slow ones
+    // - the children of a worker come from its own stream, seeded from random at the start of each generation
+    // - the order in which the slots are filled depends on the timing of the workers, so a deterministic run
+    //   does not use it
+    auto const pooled = config.PooledGeneration && !config.Deterministic;
+    auto const workers = executor.num_workers();
+    std::atomic<size_t> filled{1};
+    std::vector<Operon::RandomGenerator> workerRngs;
+    for (auto w = 0UL; pooled && w < workers; ++w) { workerRngs.emplace_back(0); }
+    std::vector<Individual> workerChildren(pooled ? workers : 0);
+
+    // one child, deferred is set if it is left to the batched local search
+    auto produce = [&](Operon::RandomGenerator& rng, Operon::Span<Operon::Scalar> buf, Individual& child, uint8_t& deferred) {
+        using Variation = OffspringGeneratorBase::Variation;
+        deferred = 0;
+        if (batchedLocalSearch && std::bernoulli_distribution(config.LocalSearchProbability)(rng)) {
+            RecombinationResult res;
+            auto const variation = generator.GenerateUnevaluated(rng, config.CrossoverProbability, config.MutationProbability, res, child);
+            deferred = static_cast<uint8_t>(variation == Variation::Unevaluated);
+            return variation != Variation::None;
+        }
+        return generator.GenerateInto(rng, config.CrossoverProbability, config.MutationProbability, pLocal, buf, child);
+    };
+
+    // one offspring slot: the child overwrites the offspring of the previous generation in place
+    auto generateSlot = [&](size_t i) {
+        auto slot = slots.Acquire();
+        Operon::Grow(*slot, trainSize, config.HugePages);
+        auto buf = Operon::Span<Operon::Scalar>(*slot);
+        pending[i] = 0;
+        // a deterministic run does not check the (timing dependent) termination criteria while generating
+        for (auto attempt = 0UL; config.Deterministic ? attempt < DeterministicAttempts : !stop(); ++attempt) {
+            if (produce(rngs[i], buf, offspring[i], pending[i])) {
+                if (trace != nullptr) { trace->AddOffspring(executor.this_worker_id()); }
+                return;
+            }
+        }
+    };
+
+    // the buffers of the workers before each report (see GetMemoryUsage)
+    auto recordMemory = [&]() { RecordMemory(workers, CapacityBytes(slots) + CapacityBytes(tiles)); };
 
     // while loop control flow
     auto [init, cond, body, back, done] = taskflow.emplace(
         [&](tf::Subflow& subflow) {
-            auto init = subflow.for_each_index(size_t{0}, parents.size(), size_t{1}, [&](size_t i) {
-                parents[i].Genotype = treeInit(rngs[i]);
-                coeffInit(rngs[i], parents[i].Genotype);
+            // the trees are created in groups (see TreeInitializerBase::Initialize), after the state of the initializer
+            // from a previous run is discarded
+            auto resetInit = subflow.emplace([&]() { if (!keep) { treeInit.Reset(); } }).name("reset initializer");
+            auto init = subflow.for_each_index(size_t{0}, parents.size(), TreeInitializerBase::DefaultGroupSize, [&](size_t i) {
+                if (keep) { return; }
+                Profiler::Scope scope(profiler, Stage::Initialization);
+                auto const n = std::min(TreeInitializerBase::DefaultGroupSize, parents.size() - i);
+                std::vector<Tree> trees(n);
+                treeInit.Initialize({ rngs.data() + i, n }, trees);
+                for (auto j = i; j < i + n; ++j) {
+                    parents[j].Genotype = std::move(trees[j - i]);
+                    coeffInit(rngs[j], parents[j].Genotype);
+                }
             }).name("initialize population");
             auto prepareEval = subflow.emplace([&]() { evaluator.Prepare(parents); }).name("prepare evaluator");
-            auto eval = subflow.for_each_index(size_t{0}, parents.size(), size_t{1}, [&](size_t i) {
-                auto id = executor.this_worker_id();
-                // make sure the worker has a large enough buffer
-                if (slots[id].size() < trainSize) {
-                    slots[id].resize(trainSize);
-                }
-                parents[i].Fitness = evaluator(rngs[i], parents[i], slots[id]);
-            }).name("evaluate population");
-            auto reportProgress = subflow.emplace([&](){ if (report) { std::invoke(report); } }).name("report progress");
-            init.precede(prepareEval);
+            auto scheduleEval = subflow.emplace([&]() {
+                auto cost = [&](size_t i, size_t n) {
+                    return std::transform_reduce(parents.begin() + i, parents.begin() + i + n, 0.0, std::plus{}, [](auto const& p) { return detail::EstimatedCost(p.Genotype, 0); });
+                };
+                detail::ScheduleGroups(0, parents.size(), tileSize, cost, config.CostScheduling && !resumed, evalSchedule);
+            }).name("schedule evaluation");
+            auto eval = detail::ForEachIndex(subflow, size_t{0}, evalGroups, [&](size_t k) {
+                if (resumed) { return; }
+                auto const i = evalSchedule[k];
+                // evaluate a group of individuals at once (the buffer will be grown by the evaluator if necessary)
+                auto const n = std::min(tileSize, parents.size() - i);
+                auto tile = tiles.Acquire();
+                Profiler::Scope scope(profiler, Stage::Evaluation);
+                evaluator.Evaluate(rngs[i], parents.subspan(i, n), *tile);
+            }, config.CostScheduling).name("evaluate population");
+            auto reportProgress = subflow.emplace([&](){
+                if (validation != nullptr) { validation->Submit(parents, Generation()); }
+                criteria.Update(parents);
+                if (trace != nullptr) { trace->Mark(); }
+                if (profiler != nullptr) { profiler->Collect(); }
+                recordMemory();
+                if (report) { std::invoke(report); }
+            }).name("report progress");
+            resetInit.precede(init);
+            init.precede(prepareEval, scheduleEval);
             prepareEval.precede(eval);
+            scheduleEval.precede(eval);
             eval.precede(reportProgress);
         }, // init
         stop, // loop condition
         [&](tf::Subflow& subflow) {
+            // with a worker limit (see SetWorkerLimit) the active workers take the next offspring slot (or group of
+            // the local search) in turn, instead of the slots being spread over all the workers, each slot still uses
+            // its own generator; the reinsertion is a single task
+            auto const active = ActiveWorkers(workers);
+            auto const limit = active < workers ? active : size_t{0};
             auto keepElite = subflow.emplace([&]() {
                 offspring[0] = *std::min_element(parents.begin(), parents.end(), [&](const auto& lhs, const auto& rhs) { return lhs[idx] < rhs[idx]; });
             }).name("keep elite");
-            auto prepareGenerator = subflow.emplace([&]() { generator.Prepare(parents); }).name("prepare generator");
-            auto generateOffspring = subflow.for_each_index(size_t{1}, offspring.size(), size_t{1}, [&](size_t i) {
-                auto buf = Operon::Span<Operon::Scalar>(slots[executor.this_worker_id()]);
-                while (!stop()) {
-                    if (auto result = generator(rngs[i], config.CrossoverProbability, config.MutationProbability, config.LocalSearchProbability, buf); result.has_value()) {
-                        offspring[i] = std::move(result.value());
-                        return;
+            auto prepareGenerator = subflow.emplace([&]() {
+                SeedStreams(streamKey, rngs);
+                if (pooled) {
+                    filled = 1;
+                    std::ranges::fill(pending, 0);
+                    for (auto& rng : workerRngs) { rng = Operon::RandomGenerator(random()); }
+                }
+                generator.Prepare(parents);
+            }).name("prepare generator");
+            // the cost of a slot is only known once its child is generated, so the slots are handed out one at a time
+            auto generateOffspring = detail::ForEachIndex(subflow, size_t{1}, pooled ? size_t{1} : offspring.size(), generateSlot, config.CostScheduling, limit).name("generate offspring");
+            auto generatePooled = subflow.for_each_index(size_t{0}, pooled ? active : size_t{0}, size_t{1}, [&](size_t w) {
+                auto slot = slots.Acquire();
+                Operon::Grow(*slot, trainSize, config.HugePages);
+                auto buf = Operon::Span<Operon::Scalar>(*slot);
+                auto& rng = workerRngs[w];
+                auto& child = workerChildren[w];
+                uint8_t deferred{0};
+                for (auto attempt = 0UL; filled.load(std::memory_order_relaxed) < offspring.size(); ++attempt) {
+                    // checking the time and the budget on every attempt is not free
+                    if (attempt % StopCheckInterval == 0 && stop()) { return; }
+                    if (!produce(rng, buf, child, deferred)) { continue; }
+                    auto const i = filled.fetch_add(1, std::memory_order_relaxed);
+                    if (i >= offspring.size()) { return; }
+                    if (trace != nullptr) { trace->AddOffspring(executor.this_worker_id()); }
+                    // the child that was in the slot is overwritten by the next attempt, reusing its buffers
+                    std::swap(offspring[i], child);
+                    pending[i] = deferred;
+                }
+            }).name("generate offspring (pooled)");
+            auto scheduleLocalSearch = subflow.emplace([&]() {
+                if (!batchedLocalSearch) { return; }
+                auto cost = [&](size_t i, size_t n) {
+                    auto c{0.0};
+                    for (auto j = i; j < i + n; ++j) {
+                        if (pending[j] != 0) { c += detail::EstimatedCost(offspring[j].Genotype, config.Iterations); }
                     }
+                    return c;
+                };
+                detail::ScheduleGroups(1, offspring.size(), tileSize, cost, config.CostScheduling, localSearchSchedule);
+            }).name("schedule local search");
+            // each group of offspring is optimized and then evaluated by one worker
+            auto localSearch = detail::ForEachIndex(subflow, size_t{0}, batchedLocalSearch ? localSearchGroups : size_t{0}, [&](size_t g) {
+                auto const i = localSearchSchedule[g];
+                auto const n = std::min(tileSize, offspring.size() - i);
+                std::vector<size_t> index;
+                Operon::Vector<Individual> group;
+                for (auto j = i; j < i + n; ++j) {
+                    if (pending[j] == 0) { continue; }
+                    index.push_back(j);
+                    group.push_back(std::move(offspring[j]));
                 }
-            }).name("generate offspring");
-            auto reinsert = subflow.emplace([&]() { reinserter(random, Parents(), offspring); }).name("reinsert");
-            auto incrementGeneration = subflow.emplace([&]() { ++Generation(); }).name("increment generation");
-            auto reportProgress = subflow.emplace([&](){ if (report) { std::invoke(report); } }).name("report progress");
+                if (group.empty()) { return; }
+
+                Profiler::Scope scope(profiler, Stage::LocalSearch);
+                auto const summary = (*optimizer)(rngs[i], group);
+                evaluator.ResidualEvaluations += summary.FunctionEvaluations;
+                evaluator.JacobianEvaluations += summary.JacobianEvaluations;
+                evaluator.SavedJacobianEvaluations += summary.SavedJacobianEvaluations;
+                auto tile = tiles.Acquire();
+                evaluator.Evaluate(rngs[i], group, *tile);
+
+                for (auto k = 0UL; k < group.size(); ++k) {
+                    for (auto& v : group[k].Fitness) {
+                        if (!std::isfinite(v)) { v = std::numeric_limits<Operon::Scalar>::max(); }
+                    }
+                    offspring[index[k]] = std::move(group[k]);
+                }
+            }, config.CostScheduling, limit).name("local search");
+            auto reinsert = subflow.emplace([&]() {
+                Profiler::Scope scope(profiler, Stage::Reinsertion);
+                reinserter(random, Parents(), offspring);
+            }).name("reinsert");
+            auto incrementGeneration = subflow.emplace([&]() {
+                ++Generation();
+                criteria.Update(Parents());
+                // the parents are validated in the background while the next generation is created
+                if (validation != nullptr) { validation->Submit(Parents(), Generation()); }
+                if (trace != nullptr) { trace->Mark(); }
+                if (profiler != nullptr) { profiler->Collect(); }
+            }).name("increment generation");
+            auto checkpoint = subflow.emplace([&]() { Checkpoint(random, rngs, elapsed()); }).name("checkpoint");
+            auto reportProgress = subflow.emplace([&](){
+                recordMemory();
+                if (report) { std::invoke(report); }
+            }).name("report progress");
 
             // set-up subflow graph
             keepElite.precede(prepareGenerator);
             prepareGenerator.precede(generateOffspring);
-            generateOffspring.precede(reinsert);
+            generateOffspring.precede(generatePooled);
+            generatePooled.precede(scheduleLocalSearch);
+            scheduleLocalSearch.precede(localSearch);
+            localSearch.precede(reinsert);
             reinsert.precede(incrementGeneration);
-            incrementGeneration.precede(reportProgress);
+            incrementGeneration.precede(checkpoint);
+            checkpoint.precede(reportProgress);
         }, // loop body (evolutionary main loop)
         [&]() { return 0; }, // jump back to the next iteration
         [&]() { /* all done */ }  // work done, report last gen and stop
@@ -125,15 +325,13 @@ auto GeneticProgrammingAlgorithm::Run(tf::Executor& executor, Operon::RandomGene
     body.precede(back);
     back.precede(cond);
 
-    executor.run(taskflow);
-    executor.wait_for_all();
+    // only wait for this taskflow, the executor may be running other algorithms at the same time
+    executor.run(taskflow).wait();
+    if (validation != nullptr) { validation->Wait(); }
 }
 
-auto GeneticProgrammingAlgorithm::Run(Operon::RandomGenerator& random, std::function<void()> report, size_t threads) -> void {
-    if (threads == 0) {
-        threads = std::thread::hardware_concurrency();
-    }
-    tf::Executor executor(threads);
-    Run(executor, random, std::move(report));
+auto GeneticProgrammingAlgorithm::Run(Operon::RandomGenerator& random, std::function<void()> report, size_t threads, AffinityPolicy affinity) -> void {
+    auto executor = MakeExecutor(threads, affinity);
+    Run(*executor, random, std::move(report));
 }
 } // namespace Operon
@@ -0,0 +1,230 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <algorithm>                         // for max
+#include <exception>                         // for exception_ptr
+#include <random>                            // for uniform_int_distribution
+#include <stdexcept>                         // for runtime_error
+#include <taskflow/taskflow.hpp>             // for executor
+#include <thread>                            // for thread
+#include <utility>                           // for exchange
+
+#include "operon/algorithms/island_model.hpp"
+#include "operon/core/affinity.hpp"         // for MakeExecutor
+#include "operon/core/contracts.hpp"         // for EXPECT
+#include "operon/core/serialization.hpp"     // for Write, Read
+#include "operon/core/tree.hpp"              // for Tree
+#include "operon/operators/reinserter.hpp"   // for ReinserterBase
+
+namespace Operon {
+
+auto MigrantCodec::Encode(Operon::Span<Individual const> individuals) -> std::vector<uint8_t>
+{
+    std::vector<uint8_t> bytes;
+    Serialization::Write<uint64_t>(bytes, individuals.size());
+    for (auto const& ind : individuals) {
+        Serialization::Write(bytes, ind);
+    }
+    return bytes;
+}
+
+auto MigrantCodec::Decode(Operon::Span<uint8_t const> bytes) -> Operon::Vector<Individual>
+{
+    size_t offset{0};
+    auto const count = Serialization::Read<uint64_t>(bytes, offset);
+    Operon::Vector<Individual> individuals;
+    individuals.reserve(count);
+    for (auto i = 0UL; i < count; ++i) {
+        individuals.push_back(Serialization::ReadIndividual(bytes, offset));
+    }
+    return individuals;
+}
+
+LocalMigrationChannel::LocalMigrationChannel(size_t islands)
+    : mailboxes_(islands)
+{
+}
+
+auto LocalMigrationChannel::Send(size_t destination, std::vector<uint8_t> message) -> void
+{
+    auto& mailbox = mailboxes_[destination];
+    std::scoped_lock lock(mailbox.Mutex);
+    mailbox.Messages.push_back(std::move(message));
+}
+
+auto LocalMigrationChannel::Receive(size_t destination) -> std::vector<std::vector<uint8_t>>
+{
+    auto& mailbox = mailboxes_[destination];
+    std::scoped_lock lock(mailbox.Mutex);
+    return std::exchange(mailbox.Messages, {});
+}
+
+#if defined(HAVE_MPI)
+MpiMigrationChannel::MpiMigrationChannel(MPI_Comm comm, size_t islandsPerRank)
+    : comm_(comm)
+    , islandsPerRank_(islandsPerRank)
+    , local_(islandsPerRank)
+{
+    int provided{0};
+    MPI_Query_thread(&provided);
+    if (provided < MPI_THREAD_MULTIPLE) {
+        throw std::runtime_error("the island model requires MPI to be initialized with MPI_THREAD_MULTIPLE");
+    }
+    MPI_Comm_rank(comm_, &rank_);
+    MPI_Comm_size(comm_, &size_);
+}
+
+MpiMigrationChannel::~MpiMigrationChannel()
+{
+    // the migrants that were never received are dropped
+    std::scoped_lock lock(mutex_);
+    for (auto& [request, buffer] : pending_) {
+        MPI_Cancel(&request);
+        MPI_Wait(&request, MPI_STATUS_IGNORE);
+    }
+}
+
+auto MpiMigrationChannel::Send(size_t destination, std::vector<uint8_t> message) -> void
+{
+    auto const rank = static_cast<int>(destination / islandsPerRank_);
+    if (rank == rank_) {
+        local_.Send(destination - FirstIsland(), std::move(message));
+        return;
+    }
+
+    // non-blocking send, so that two islands sending to each other never wait on one another
+    std::scoped_lock lock(mutex_);
+    std::erase_if(pending_, [](auto& p) {
+        int done{0};
+        MPI_Test(&p.first, &done, MPI_STATUS_IGNORE);
+        return done != 0;
+    });
+    auto& [request, buffer] = pending_.emplace_back(MPI_REQUEST_NULL, std::move(message));
+    MPI_Isend(buffer.data(), static_cast<int>(buffer.size()), MPI_BYTE, rank, static_cast<int>(destination), comm_, &request);
+}
+
+auto MpiMigrationChannel::Receive(size_t destination) -> std::vector<std::vector<uint8_t>>
+{
+    auto messages = local_.Receive(destination - FirstIsland());
+    // each island only receives its own tag, so the probe and the receive do not race with other islands
+    auto const tag = static_cast<int>(destination);
+    for (;;) {
+        int flag{0};
+        MPI_Status status;
+        MPI_Iprobe(MPI_ANY_SOURCE, tag, comm_, &flag, &status);
+        if (flag == 0) { break; }
+        int count{0};
+        MPI_Get_count(&status, MPI_BYTE, &count);
+        std::vector<uint8_t> buffer(static_cast<size_t>(count));
+        MPI_Recv(buffer.data(), count, MPI_BYTE, status.MPI_SOURCE, tag, comm_, MPI_STATUS_IGNORE);
+        messages.push_back(std::move(buffer));
+    }
+    return messages;
+}
+#endif
+
+auto IslandModel::Migrate(MigrationChannel& channel, size_t island, Operon::RandomGenerator& rng) -> void
+{
+    auto& algorithm = islands_[island].Algorithm.get();
+    auto parents = algorithm.Parents();
+    auto const n = channel.IslandCount();
+    auto const self = channel.FirstIsland() + island;
+
+    // absorb the migrants received since the last migration
+    for (auto const& message : channel.Receive(self)) {
+        auto immigrants = MigrantCodec::Decode(message);
+        if (immigrants.empty() || immigrants.front().Size() != parents.front().Size()) { continue; }
+        algorithm.GetReinserter()(rng, parents, immigrants);
+    }
+
+    if (n < 2 || config_.MigrationSize == 0) { return; }
+
+    Operon::Vector<Individual> emigrants;
+    emigrants.reserve(config_.MigrationSize);
+    auto const& selector = algorithm.GetGenerator().FemaleSelector();
+    for (auto i = 0UL; i < config_.MigrationSize; ++i) {
+        emigrants.push_back(parents[selector(rng)]);
+    }
+    auto message = MigrantCodec::Encode(emigrants);
+
+    switch (config_.Topology) {
+    case MigrationTopology::Ring: {
+        channel.Send((self + 1) % n, std::move(message));
+        break;
+    }
+    case MigrationTopology::Complete: {
+        for (auto i = 0UL; i < n; ++i) {
+            if (i != self) { channel.Send(i, message); }
+        }
+        break;
+    }
+    case MigrationTopology::Random: {
+        auto const i = std::uniform_int_distribution<size_t>{0, n - 2}(rng);
+        channel.Send(i < self ? i : i + 1, std::move(message));
+        break;
+    }
+    }
+}
+
+auto IslandModel::Run(Operon::RandomGenerator& rng, std::function<void(size_t)> report, size_t threads) -> void
+{
+    LocalMigrationChannel channel(islands_.size());
+    Run(channel, rng, std::move(report), threads);
+}
+
+auto IslandModel::Run(MigrationChannel& channel, Operon::RandomGenerator& rng, std::function<void(size_t)> report, size_t threads) -> void
+{
+    auto const n = islands_.size();
+    EXPECT(n > 0);
+    EXPECT(channel.FirstIsland() + n <= channel.IslandCount());
+
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    auto const threadsPerIsland = std::max(threads / n, size_t{1});
+
+    // each island gets its own executor and random generators (one for the algorithm, one for migration)
+    std::vector<std::unique_ptr<tf::Executor>> executors;
+    std::vector<Operon::RandomGenerator> rngs;
+    std::vector<Operon::RandomGenerator> migrationRngs;
+    // the islands that share a node use its cores in turn
+    auto const topology = config_.PinToNodes ? CoreTopology() : std::vector<std::vector<int>>{};
+    for (auto i = 0UL; i < n; ++i) {
+        std::vector<int> cores;
+        if (!topology.empty()) {
+            auto const& node = topology[i % topology.size()];
+            auto const offset = i / topology.size() * threadsPerIsland;
+            for (auto w = 0UL; w < threadsPerIsland; ++w) { cores.push_back(node[(offset + w) % node.size()]); }
+        }
+        executors.push_back(MakeExecutor(threadsPerIsland, std::move(cores)));
+        rngs.emplace_back(rng());
+        migrationRngs.emplace_back(rng());
+    }
+
+    std::vector<std::exception_ptr> errors(n);
+    std::vector<std::thread> workers;
+    workers.reserve(n);
+    for (auto i = 0UL; i < n; ++i) {
+        workers.emplace_back([&, i]() {
+            try {
+                auto const& algorithm = islands_[i].Algorithm.get();
+                islands_[i].Run(*executors[i], rngs[i], [&, i]() {
+                    auto const generation = algorithm.Generation();
+                    if (generation > 0 && config_.MigrationInterval > 0 && generation % config_.MigrationInterval == 0) {
+                        Migrate(channel, i, migrationRngs[i]);
+                    }
+                    if (report) { std::invoke(report, i); }
+                });
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+    for (auto& w : workers) { w.join(); }
+
+    for (auto const& e : errors) {
+        if (e) { std::rethrow_exception(e); }
+    }
+}
+
+} // namespace Operon
@@ -5,94 +5,207 @@
 #include <atomic>                                    // for atomic_bool
 #include <chrono>                                    // for steady_clock
 #include <cmath>                                     // for isfinite
+#include <functional>                                // for plus
 #include <iterator>                                  // for move_iterator, back_inse...
 #include <limits>                                    // for numeric_limits
 #include <memory>                                    // for allocator, allocator_tra...
+#include <numeric>                                   // for iota, transform_reduce
 #include <optional>                                  // for optional
 #include <ranges>                                    // for ranges
 #include <taskflow/taskflow.hpp>                     // for taskflow, subflow
 #include <taskflow/algorithm/for_each.hpp>   // for taskflow.for_each_index
+#include <utility>                                   // for move
 #include <vector>                                    // for vector, vector::size_type
 #include <fmt/ranges.h>
+#include <Eigen/Core>
 
 #include "operon/algorithms/nsga2.hpp"
+#include "operon/algorithms/pareto_indicators.hpp"
 #include "operon/core/contracts.hpp"                 // for ENSURE
+#include "operon/core/executor.hpp"                  // for RunTaskflow
+#include "operon/core/memory.hpp"                    // for Grow, CapacityBytes
+#include "operon/core/pool.hpp"                      // for ObjectPool
+#include "operon/core/permutation.hpp"               // for ApplyPermutation
 #include "operon/core/operator.hpp"                  // for OperatorBase
 #include "operon/core/problem.hpp"                   // for Problem
+#include "operon/algorithms/task_trace.hpp"          // for TaskTrace
+#include "operon/algorithms/termination.hpp"         // for TerminationCriteria
+#include "operon/core/profiler.hpp"                  // for Profiler
 #include "operon/core/range.hpp"                     // for Range
 #include "operon/core/tree.hpp"                      // for Tree
 #include "operon/operators/initializer.hpp"          // for CoefficientInitializerBase
-#include "operon/operators/non_dominated_sorter.hpp" // for RankSorter
+#include "operon/operators/non_dominated_sorter.hpp" // for NondominatedSorterBase
 #include "operon/operators/reinserter.hpp"           // for ReinserterBase
+#include "scheduling.hpp"                            // for ScheduleGroups
 
 namespace Operon {
 
 auto NSGA2::UpdateDistance(Operon::Span<Individual> pop) -> void
 {
-    // assign distance. each front is sorted for each objective
-    size_t m = pop.front().Fitness.size();
-    auto inf = std::numeric_limits<Operon::Scalar>::max();
-    for (size_t i = 0; i < fronts_.size(); ++i) {
-        auto& front = fronts_[i];
-        for (size_t obj = 0; obj < m; ++obj) {
-            SingleObjectiveComparison comp(obj);
-            std::stable_sort(front.begin(), front.end(), [&](auto a, auto b) { return comp(pop[a], pop[b]); });
-            auto min = pop.front()[obj];
-            auto max = pop.back()[obj];
-            for (size_t j = 0; j < front.size(); ++j) {
-                auto idx = front[j];
-
-                pop[idx].Rank = i;
-                if (obj == 0) {
-                    pop[idx].Distance = 0;
-                }
+    // the fitness values of each front are copied into a column-major matrix, so that the per-objective
+    // sorts only touch contiguous values instead of going through the individuals
+    // - the boundary solutions of each objective get an infinite distance
+    // - the distances of the fronts are independent and computed in parallel
+    auto const m = static_cast<Eigen::Index>(pop.front().Fitness.size());
+    constexpr auto inf { std::numeric_limits<Operon::Scalar>::infinity() };
 
-                auto mPrev = j > 0 ? pop[j - 1][obj] : inf;
-                auto mNext = j < front.size() - 1 ? pop[j + 1][obj] : inf;
-                auto distance = (mNext - mPrev) / (max - min);
-                if (!std::isfinite(distance)) {
-                    distance = 0;
-                }
-                pop[idx].Distance += distance;
+    auto crowding = [&](size_t i) {
+        auto const& front = fronts_[i];
+        auto const n = static_cast<Eigen::Index>(front.size());
+        if (n == 0) { return; }
+        Eigen::Array<Operon::Scalar, -1, -1> fit(n, m);
+        for (auto j = 0; j < n; ++j) {
+            auto& ind = pop[front[j]];
+            ind.Rank = i;
+            fit.row(j) = Eigen::Map<Eigen::Array<Operon::Scalar, 1, -1> const>(ind.Fitness.data(), m);
+        }
+
+        Eigen::Array<Operon::Scalar, -1, 1> distance = Eigen::Array<Operon::Scalar, -1, 1>::Zero(n);
+        std::vector<Eigen::Index> idx(n);
+        for (auto k = 0; k < m; ++k) {
+            auto const values = fit.col(k);
+            std::iota(idx.begin(), idx.end(), Eigen::Index{0});
+            std::stable_sort(idx.begin(), idx.end(), [&](auto a, auto b) { return values(a) < values(b); });
+            distance(idx.front()) = distance(idx.back()) = inf;
+
+            auto const range = values(idx.back()) - values(idx.front());
+            if (!std::isfinite(range) || range <= 0) { continue; }
+            for (auto j = 1; j < n - 1; ++j) {
+                distance(idx[j]) += (values(idx[j + 1]) - values(idx[j - 1])) / range;
             }
         }
+        for (auto j = 0; j < n; ++j) {
+            pop[front[j]].Distance = distance(j);
+        }
+    };
+
+    if (executor_ == nullptr || fronts_.size() < 2) {
+        for (auto i = 0UL; i < fronts_.size(); ++i) { crowding(i); }
+        return;
     }
+    tf::Taskflow taskflow;
+    taskflow.for_each_index(size_t{0}, fronts_.size(), size_t{1}, crowding);
+    RunTaskflow(*executor_, taskflow);
+}
+
+auto NSGA2::RankedParents() -> bool
+{
+    // the ranks of the parents relative to each other are still valid if the parents consist of the first fronts
+    // of the (previous) population, eg. after KeepBestReinserter with the crowded comparison
+    auto const individuals = Individuals();
+    auto const parents = Parents();
+    if (fronts_.empty() || parents.empty()) { return false; }
+    auto const rank = std::ranges::max(parents, std::less{}, &Individual::Rank).Rank;
+    auto better = [rank](auto const& ind) { return ind.Rank < rank; };
+    return std::ranges::count_if(individuals, better) == std::ranges::count_if(parents, better);
 }
 
 auto NSGA2::Sort(Operon::Span<Individual> pop) -> void
 {
     auto eps = static_cast<Operon::Scalar>(GetConfig().Epsilon);
     auto eq = [eps](auto const& lhs, auto const& rhs) { return Operon::Equal{}(lhs.Fitness, rhs.Fitness, eps); };
+
+    // with an incremental sorter, the offspring are inserted into the fronts of the parents (see RankedParents)
+    constexpr auto unknown { std::numeric_limits<size_t>::max() };
+    auto const* incremental = dynamic_cast<IncrementalSorter const*>(&sorter_.get());
+    auto const parents = Parents().size();
+    auto reuse = incremental != nullptr && rankedParents_ && pop.data() == Individuals().data() && pop.size() > parents;
+    for (auto i = 0UL; i < pop.size(); ++i) {
+        // the duplicates from the previous generation and the offspring need to be inserted
+        if (!reuse || i >= parents || pop[i].Rank >= duplicates_) { pop[i].Rank = unknown; }
+    }
+    // the ranks of a population sorted on its own are always valid
+    rankedParents_ = pop.size() == parents;
+
     // sort the population lexicographically
-    std::stable_sort(pop.begin(), pop.end(), [](auto const& a, auto const& b){ return std::ranges::lexicographical_compare(a.Fitness, b.Fitness); });
-    // mark the duplicates for stable_partition
-    for(auto i = pop.begin(); i < pop.end(); ) {
-        i->Rank = 0;
+    // - the sort and the partition below permute the indices, the individuals are moved once at the end
+    auto& indices = indices_;
+    indices.resize(pop.size());
+    std::iota(indices.begin(), indices.end(), size_t{0});
+    std::ranges::stable_sort(indices, [&](auto a, auto b){ return std::ranges::lexicographical_compare(pop[a].Fitness, pop[b].Fitness); });
+    // mark the duplicates for stable_partition (keeping an individual with a known rank if possible)
+    for (auto i = indices.begin(); i < indices.end(); ) {
         auto j = i + 1;
-        for (; j < pop.end() && eq(*i, *j); ++j) {
-            j->Rank = 1;
-        }
-        i = j;
+        for (; j < indices.end() && eq(pop[*i], pop[*j]); ++j) { }
+        auto k = std::find_if(i, j, [&](auto x) { return pop[x].Rank != unknown; });
+        if (k == j) { k = i; }
+        for (; i < j; ++i) { pop[*i].Distance = i == k ? 0 : 1; }
+    }
+    // mark the individuals with the same outputs as a lexicographically smaller one (see Evaluator::SetSemanticHashing)
+    // - removing an individual with a known rank can change the ranks of the others, the fronts are then sorted again
+    auto& semantic = semantic_;
+    semantic.clear();
+    for (auto i : indices) {
+        auto& ind = pop[i];
+        if (ind.Distance != 0 || ind.Semantic == 0 || semantic.insert(ind.Semantic).second) { continue; }
+        ind.Distance = 1;
+        reuse = reuse && ind.Rank == unknown;
     }
-    auto r = std::stable_partition(pop.begin(), pop.end(), [](auto const& ind) { return !ind.Rank; });
-    Operon::Span<Operon::Individual const> uniq(pop.begin(), r);
+    auto r = std::stable_partition(indices.begin(), indices.end(), [&](auto x) { return pop[x].Distance == 0; });
+    ApplyPermutation(pop, Operon::Span<size_t const>(indices));
+    Operon::Span<Operon::Individual const> uniq(pop.begin(), pop.begin() + std::distance(indices.begin(), r));
+    // the fronts of the previous generation are kept as storage for the new ones (at most as many as there are fronts)
+    auto recycle = [&](auto& fronts) {
+        for (auto& f : fronts) {
+            if (spare_.size() >= fronts.size()) { break; }
+            f.clear();
+            spare_.push_back(std::move(f));
+        }
+        fronts.clear();
+    };
+    auto front = [&]() {
+        if (spare_.empty()) { return std::vector<size_t>{}; }
+        auto f = std::move(spare_.back());
+        spare_.pop_back();
+        return f;
+    };
     // do the sorting
-    fronts_ = sorter_(uniq, eps);
+    if (reuse) {
+        recycle(fronts_);
+        auto& offspring = offspring_;
+        offspring.clear();
+        for (auto i = 0UL; i < uniq.size(); ++i) {
+            auto const rank = uniq[i].Rank;
+            if (rank == unknown) { offspring.push_back(i); continue; }
+            while (fronts_.size() <= rank) { fronts_.push_back(front()); }
+            fronts_[rank].push_back(i);
+        }
+        // the empty fronts are moved to the back (keeping their storage)
+        auto empty = std::stable_partition(fronts_.begin(), fronts_.end(), [](auto const& f) { return !f.empty(); });
+        std::move(empty, fronts_.end(), std::back_inserter(spare_));
+        fronts_.erase(empty, fronts_.end());
+        incremental->Insert(uniq, fronts_, offspring, eps);
+    } else {
+        auto fronts = sorter_.get()(uniq, eps);
+        std::swap(fronts, fronts_);
+        recycle(fronts);
+    }
     // sort the fronts for consistency between sorting algos
     for (auto& f : fronts_) {
         std::stable_sort(f.begin(), f.end());
     }
     // banish the duplicates into the last front
-    if (r < pop.end()) {
-        std::vector<size_t> last(pop.size() - uniq.size());
+    duplicates_ = fronts_.size();
+    if (uniq.size() < pop.size()) {
+        auto& last = fronts_.emplace_back(front());
+        last.resize(pop.size() - uniq.size());
         std::iota(last.begin(), last.end(), uniq.size());
-        fronts_.push_back(last);
     }
     // calculate crowding distance
     UpdateDistance(pop);
-    // update best front
+    // update best front (pop is a prefix of the population)
+    best_.assign(fronts_.front().begin(), fronts_.front().end());
+}
+
+auto NSGA2::UpdateBest() -> void
+{
+    // the reinserter permutes the population (see ReinserterBase::Sort), the best front is found again by its rank
     best_.clear();
-    std::transform(fronts_.front().begin(), fronts_.front().end(), std::back_inserter(best_), [&](auto i) { return pop[i]; });
+    auto const& individuals = Individuals();
+    for (auto i = 0UL; i < individuals.size(); ++i) {
+        if (individuals[i].Rank == 0) { best_.push_back(i); }
+    }
+    if (indicators_ != nullptr) { indicators_->Update(individuals, best_); }
 }
 
 auto NSGA2::Run(tf::Executor& executor, Operon::RandomGenerator& random, std::function<void()> report) -> void
@@ -104,13 +217,6 @@ auto NSGA2::Run(tf::Executor& executor, Operon::RandomGenerator& random, std::fu
     const auto& reinserter = GetReinserter();
     const auto& problem = GetProblem();
 
-    auto t0 = std::chrono::steady_clock::now();
-    auto elapsed = [t0]() {
-        auto t1 = std::chrono::steady_clock::now();
-        constexpr double ms{1e3};
-        return static_cast<double>(std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count()) / ms;
-    };
-
     // random seeds for each thread
     size_t s = std::max(config.PopulationSize, config.PoolSize);
     std::vector<Operon::RandomGenerator> rngs;
@@ -118,73 +224,212 @@ auto NSGA2::Run(tf::Executor& executor, Operon::RandomGenerator& random, std::fu
         rngs.emplace_back(random());
     }
 
+    // the key of the streams of a deterministic run, drawn before a restored state replaces the one of random
+    auto const streamKey = config.Deterministic ? random() : 0;
+
+    // a restored run continues with the evaluated parents of the checkpoint (see GeneticAlgorithmBase::Restore)
+    auto const resumed = Resume(random, rngs);
+
+    auto t0 = std::chrono::steady_clock::now();
+    auto elapsed = [t0, offset = resumed.value_or(0.0)]() {
+        auto t1 = std::chrono::steady_clock::now();
+        constexpr double ms{1e3};
+        return offset + static_cast<double>(std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count()) / ms;
+    };
+
     auto const& evaluator = generator.Evaluator();
+    auto* profiler = generator.GetProfiler();
+    auto* trace = GetTaskTrace();
 
     // we want to allocate all the memory that will be necessary for evaluation (e.g. for storing model responses)
     // in one go and use it throughout the generations in order to minimize the memory pressure
     auto trainSize = problem.TrainingRange().Size();
+    if (config.HugePages) { (void)problem.GetDataset().AdviseHugePages(); }
 
     ENSURE(executor.num_workers() > 0);
-    std::vector<Operon::Vector<Operon::Scalar>> slots(executor.num_workers());
+    // the buffers are held by the tasks rather than by the workers: a worker that coruns a nested evaluation (see
+    // RunTaskflow) can start another generation or evaluation task, which must not write the buffer in use
+    Operon::ObjectPool<Operon::Vector<Operon::Scalar>> slots;
+    // separate buffers for evaluating groups of individuals (initial population)
+    Operon::ObjectPool<Operon::Vector<Operon::Scalar>> tiles;
+    auto const tileSize { evaluator.EvaluationGroupSize() };
+    // the groups of the population evaluated by one task, in the order given by detail::ScheduleGroups
+    std::vector<size_t> evalSchedule;
+
+    // the sorter can use the workers of the executor (see NondominatedSorterBase::SetExecutor)
+    auto const& sorter = sorter_.get();
+    auto* sorterExecutor = sorter.Executor();
+    sorter.SetExecutor(&executor);
+    executor_ = &executor;
 
     tf::Taskflow taskflow;
 
+    // the convergence criteria are updated with the parents between generations
+    TerminationCriteria criteria{config};
+
     auto stop = [&]() {
-        return generator.Terminate() || Generation() == config.Generations || elapsed() > static_cast<double>(config.TimeLimit);
+        return generator.Terminate() || Generation() == config.Generations || elapsed() > static_cast<double>(config.TimeLimit)
+            || (indicators_ != nullptr && indicators_->Converged()) || criteria.Terminated();
     };
 
     auto& individuals = Individuals();
     auto parents      = Parents();
     auto offspring    = Offspring();
+    auto const evalGroups = (parents.size() + tileSize - 1) / tileSize;
+
+    // the pipelined mode takes the sort off the critical path: while the merged population of a generation is sorted,
+    // the offspring of the next one are generated from a copy of its parents (with their ranks and distances), so
+    // the selection lags one generation behind the reinsertion
+    // - no offspring are generated ahead of the generation limit, those generated ahead of another stop are discarded
+    auto const pipelined = config.PipelinedSorting;
+    Operon::Vector<Individual> stale; // the parents of the pending offspring
+    Operon::Vector<Individual> pending;
+    if (pipelined) {
+        stale.resize(parents.size());
+        pending.assign(offspring.begin(), offspring.end()); // with the fitness vectors sized by the constructor
+    }
+    bool ahead{false}; // the offspring of the next generation are generated in this one
+    bool ready{false}; // the pending offspring are generated
+
+    // a deterministic run does not check the (timing dependent) termination criteria while generating
+    // - the offspring generated ahead only check the budget and the time limit, the other criteria are updated by the
+    //   reinsertion running at the same time
+    auto exhausted = [&]() { return generator.Terminate() || elapsed() > static_cast<double>(config.TimeLimit); };
+    auto generate = [&](size_t i, Individual& child, auto const& halt) {
+        auto slot = slots.Acquire();
+        Operon::Grow(*slot, trainSize, config.HugePages);
+        auto buf = Operon::Span<Operon::Scalar>(*slot);
+        for (auto attempt = 0UL; config.Deterministic ? attempt < DeterministicAttempts : !halt(); ++attempt) {
+            if (generator.GenerateInto(rngs[i], config.CrossoverProbability, config.MutationProbability, config.LocalSearchProbability, buf, child)) {
+                ENSURE(child.Genotype.Length() > 0);
+                if (trace != nullptr) { trace->AddOffspring(executor.this_worker_id()); }
+                return;
+            }
+        }
+    };
+
+    // the buffers of the workers and the populations of the pipeline before each report (see GetMemoryUsage)
+    // - the trees that the pipeline shares with the population are counted with the population
+    auto recordMemory = [&]() {
+        Operon::Set<void const*> counted;
+        (void)PopulationBytes(Individuals(), counted);
+        RecordMemory(executor.num_workers(), CapacityBytes(slots) + CapacityBytes(tiles) + PopulationBytes(stale, counted) + PopulationBytes(pending, counted));
+    };
 
     // while loop control flow
     auto [init, cond, body, back, done] = taskflow.emplace(
         [&](tf::Subflow& subflow) {
-            auto init = subflow.for_each_index(size_t{0}, parents.size(), size_t{1}, [&](size_t i) {
-                parents[i].Genotype = treeInit(rngs[i]);
-                coeffInit(rngs[i], parents[i].Genotype);
+            // the trees are created in groups (see TreeInitializerBase::Initialize), after the state of the initializer
+            // from a previous run is discarded
+            auto resetInit = subflow.emplace([&]() { if (!resumed) { treeInit.Reset(); } }).name("reset initializer");
+            auto init = subflow.for_each_index(size_t{0}, parents.size(), TreeInitializerBase::DefaultGroupSize, [&](size_t i) {
+                if (resumed) { return; }
+                Profiler::Scope scope(profiler, Stage::Initialization);
+                auto const n = std::min(TreeInitializerBase::DefaultGroupSize, parents.size() - i);
+                std::vector<Tree> trees(n);
+                treeInit.Initialize({ rngs.data() + i, n }, trees);
+                for (auto j = i; j < i + n; ++j) {
+                    parents[j].Genotype = std::move(trees[j - i]);
+                    coeffInit(rngs[j], parents[j].Genotype);
+                }
             }).name("initialize population");
             auto prepareEval = subflow.emplace([&]() { evaluator.Prepare(parents); }).name("prepare evaluator");
-            auto eval = subflow.for_each_index(size_t{0}, parents.size(), size_t{1}, [&](size_t i) {
-                auto id = executor.this_worker_id();
-                // make sure the worker has a large enough buffer
-                if (slots[id].size() < trainSize) {
-                    slots[id].resize(trainSize);
-                }
-                parents[i].Fitness = evaluator(rngs[i], parents[i], slots[id]);
-            }).name("evaluate population");
-            auto nonDominatedSort = subflow.emplace([&]() { Sort(parents); }).name("non-dominated sort");
-            auto reportProgress = subflow.emplace([&]() { if (report) { std::invoke(report); } }).name("report progress");
-            init.precede(prepareEval);
+            auto scheduleEval = subflow.emplace([&]() {
+                auto cost = [&](size_t i, size_t n) {
+                    return std::transform_reduce(parents.begin() + i, parents.begin() + i + n, 0.0, std::plus{}, [](auto const& p) { return detail::EstimatedCost(p.Genotype, 0); });
+                };
+                detail::ScheduleGroups(0, parents.size(), tileSize, cost, config.CostScheduling && !resumed, evalSchedule);
+            }).name("schedule evaluation");
+            auto eval = detail::ForEachIndex(subflow, size_t{0}, evalGroups, [&](size_t k) {
+                if (resumed) { return; }
+                auto const i = evalSchedule[k];
+                // evaluate a group of individuals at once (the buffer will be grown by the evaluator if necessary)
+                auto const n = std::min(tileSize, parents.size() - i);
+                auto tile = tiles.Acquire();
+                Profiler::Scope scope(profiler, Stage::Evaluation);
+                evaluator.Evaluate(rngs[i], parents.subspan(i, n), *tile);
+            }, config.CostScheduling).name("evaluate population");
+            auto nonDominatedSort = subflow.emplace([&]() {
+                Profiler::Scope scope(profiler, Stage::Sorting);
+                Sort(parents);
+                if (indicators_ != nullptr) { indicators_->Update(Individuals(), best_); }
+                criteria.Update(parents);
+            }).name("non-dominated sort");
+            auto reportProgress = subflow.emplace([&]() {
+                if (trace != nullptr) { trace->Mark(); }
+                if (profiler != nullptr) { profiler->Collect(); }
+                recordMemory();
+                if (report) { std::invoke(report); }
+            }).name("report progress");
+            resetInit.precede(init);
+            init.precede(prepareEval, scheduleEval);
             prepareEval.precede(eval);
+            scheduleEval.precede(eval);
             eval.precede(nonDominatedSort);
             nonDominatedSort.precede(reportProgress);
         }, // init
         stop, // loop condition
         [&](tf::Subflow& subflow) {
-            auto prepareGenerator = subflow.emplace([&]() { generator.Prepare(parents); }).name("prepare generator");
-            auto generateOffspring = subflow.for_each_index(size_t{0}, offspring.size(), size_t{1}, [&](size_t i) {
-                auto buf = Operon::Span<Operon::Scalar>(slots[executor.this_worker_id()]);
-                while (!stop()) {
-                    auto result = generator(rngs[i], config.CrossoverProbability, config.MutationProbability, config.LocalSearchProbability, buf);
-                    if (result) {
-                        offspring[i] = std::move(*result);
-                        ENSURE(offspring[i].Genotype.Length() > 0);
-                        return;
-                    }
-                }
-            }).name("generate offspring");
-            auto nonDominatedSort = subflow.emplace([&]() { Sort(individuals); }).name("non-dominated sort");
-            auto reinsert = subflow.emplace([&]() { reinserter.Sort(individuals); }).name("reinsert");
-            auto incrementGeneration = subflow.emplace([&]() { ++Generation(); }).name("increment generation");
-            auto reportProgress = subflow.emplace([&]() { if (report) { std::invoke(report); } }).name("report progress");
+            // with a worker limit (see SetWorkerLimit) the active workers take the next offspring slot in turn and the
+            // sorter splits its work between them, the reinsertion is a single task
+            auto const active = ActiveWorkers(executor.num_workers());
+            auto const limit = active < executor.num_workers() ? active : size_t{0};
+            sorter.SetExecutor(&executor, limit);
+            auto prepareGenerator = subflow.emplace([&]() {
+                if (ready) { return; } // prepared with the stale parents
+                SeedStreams(streamKey, rngs);
+                generator.Prepare(parents);
+            }).name("prepare generator");
+            // the cost of a slot is only known once its child is generated, so the slots are handed out one at a time
+            auto generateOffspring = detail::ForEachIndex(subflow, size_t{0}, offspring.size(), [&](size_t i) {
+                if (ready) { std::swap(offspring[i], pending[i]); return; }
+                generate(i, offspring[i], stop);
+            }, config.CostScheduling && !ready, limit).name("generate offspring");
+            auto nonDominatedSort = subflow.emplace([&]() {
+                Profiler::Scope scope(profiler, Stage::Sorting);
+                Sort(individuals);
+            }).name("non-dominated sort");
+            auto reinsert = subflow.emplace([&]() {
+                Profiler::Scope scope(profiler, Stage::Reinsertion);
+                reinserter.Sort(individuals);
+                rankedParents_ = RankedParents();
+                UpdateBest();
+            }).name("reinsert");
+            // the copy of the parents is taken before the sort permutes the population
+            auto copyParents = subflow.for_each_index(size_t{0}, stale.size(), size_t{1}, [&](size_t i) { stale[i] = parents[i]; }).name("copy parents");
+            auto prepareNext = subflow.emplace([&]() {
+                ahead = pipelined && Generation() + 1 < config.Generations;
+                if (!ahead) { return; }
+                SeedStreams(streamKey, rngs, 1);
+                generator.Prepare(stale);
+            }).name("prepare next generator");
+            auto generateNext = detail::ForEachIndex(subflow, size_t{0}, pending.size(), [&](size_t i) {
+                if (ahead) { generate(i, pending[i], exhausted); }
+            }, config.CostScheduling, limit).name("generate next offspring");
+            auto join = subflow.emplace([&]() { ready = ahead; }).name("join");
+            auto incrementGeneration = subflow.emplace([&]() {
+                ++Generation();
+                criteria.Update(Parents());
+                if (trace != nullptr) { trace->Mark(); }
+                if (profiler != nullptr) { profiler->Collect(); }
+            }).name("increment generation");
+            auto checkpoint = subflow.emplace([&]() { Checkpoint(random, rngs, elapsed()); }).name("checkpoint");
+            auto reportProgress = subflow.emplace([&]() {
+                recordMemory();
+                if (report) { std::invoke(report); }
+            }).name("report progress");
 
             // set-up subflow graph
             prepareGenerator.precede(generateOffspring);
-            generateOffspring.precede(nonDominatedSort);
+            generateOffspring.precede(copyParents);
+            copyParents.precede(nonDominatedSort, prepareNext);
             nonDominatedSort.precede(reinsert);
-            reinsert.precede(incrementGeneration);
-            incrementGeneration.precede(reportProgress);
+            prepareNext.precede(generateNext);
+            reinsert.precede(join);
+            generateNext.precede(join);
+            join.precede(incrementGeneration);
+            incrementGeneration.precede(checkpoint);
+            checkpoint.precede(reportProgress);
         }, // loop body (evolutionary main loop)
         [&]() { return 0; }, // jump back to the next iteration
         [&]() { /* done nothing to do */ } // work done, report last gen and stop
@@ -204,14 +449,13 @@ auto NSGA2::Run(tf::Executor& executor, Operon::RandomGenerator& random, std::fu
 
     executor.run(taskflow);
     executor.wait_for_all();
+    sorter.SetExecutor(sorterExecutor);
+    executor_ = nullptr;
 }
 
-auto NSGA2::Run(Operon::RandomGenerator& random, std::function<void()> report, size_t threads) -> void
+auto NSGA2::Run(Operon::RandomGenerator& random, std::function<void()> report, size_t threads, AffinityPolicy affinity) -> void
 {
-    if (threads == 0U) {
-        threads = std::thread::hardware_concurrency();
-    }
-    tf::Executor executor(threads);
-    Run(executor, random, std::move(report));
+    auto executor = MakeExecutor(threads, affinity);
+    Run(*executor, random, std::move(report));
 }
 } // namespace Operon
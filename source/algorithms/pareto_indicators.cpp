@@ -0,0 +1,270 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "operon/algorithms/pareto_indicators.hpp"
+#include "operon/algorithms/solution_archive.hpp"
+#include "operon/core/contracts.hpp"
+
+namespace Operon {
+
+namespace {
+    // the points are stored row-major with m values per point
+    struct Front {
+        std::size_t M;
+        std::vector<double> Values;
+
+        [[nodiscard]] auto Size() const -> std::size_t { return Values.size() / M; }
+        [[nodiscard]] auto operator[](std::size_t i) const -> std::span<double const> { return { Values.data() + (i * M), M }; }
+        auto Push(auto const& p) -> void { Values.insert(Values.end(), p.begin(), p.end()); }
+    };
+
+    // the points of the front sorted by the given comparison
+    auto Sorted(Front const& f, auto&& less) -> std::vector<std::size_t>
+    {
+        std::vector<std::size_t> idx(f.Size());
+        std::iota(idx.begin(), idx.end(), 0UL);
+        std::ranges::sort(idx, [&](auto a, auto b) { return less(f[a], f[b]); });
+        return idx;
+    }
+
+    auto Hv2(Front const& f, std::span<double const> ref) -> double
+    {
+        auto idx = Sorted(f, [](auto a, auto b) { return std::ranges::lexicographical_compare(a, b); });
+        auto hv{0.0};
+        auto top{ref[1]};
+        for (auto i : idx) {
+            auto const p = f[i];
+            if (p[1] < top) {
+                hv += (ref[0] - p[0]) * (top - p[1]);
+                top = p[1];
+            }
+        }
+        return hv;
+    }
+
+    // sweep along the third objective, the staircase of the points seen so far is a map from the first to the second
+    // objective (increasing first, decreasing second) and its area is updated with the area newly dominated by a point
+    auto Hv3(Front const& f, std::span<double const> ref) -> double
+    {
+        auto idx = Sorted(f, [](auto a, auto b) { return a[2] < b[2]; });
+        std::map<double, double> stair;
+        auto area{0.0};
+        auto hv{0.0};
+        auto z{0.0};
+        for (auto k = 0UL; k < idx.size(); ++k) {
+            auto const p = f[idx[k]];
+            if (k > 0) { hv += area * (p[2] - z); }
+            z = p[2];
+
+            auto it = stair.lower_bound(p[0]);
+            auto const top = it == stair.begin() ? ref[1] : std::prev(it)->second;
+            if (top <= p[1] || (it != stair.end() && it->first == p[0] && it->second <= p[1])) { continue; }
+            // the points with a larger first objective and a larger second objective are dominated by p
+            auto x{p[0]};
+            auto y{top};
+            while (it != stair.end() && it->second >= p[1]) {
+                area += (it->first - x) * (y - p[1]);
+                x = it->first;
+                y = it->second;
+                it = stair.erase(it);
+            }
+            area += ((it == stair.end() ? ref[0] : it->first) - x) * (y - p[1]);
+            stair.emplace_hint(it, p[0], p[1]);
+        }
+        return idx.empty() ? 0.0 : hv + (area * (ref[2] - z));
+    }
+
+    // removes the points weakly dominated by another point (keeping one of equal points)
+    auto Nondominated(Front const& f) -> Front
+    {
+        auto const n = f.Size();
+        auto idx = Sorted(f, [](auto a, auto b) { return std::ranges::lexicographical_compare(a, b); });
+        Front nd{ f.M, {} };
+        std::vector<std::size_t> kept;
+        // a point can only be dominated by a lexicographically smaller one
+        for (auto i = 0UL; i < n; ++i) {
+            auto const p = f[idx[i]];
+            auto dominated = std::ranges::any_of(kept, [&](auto j) {
+                return std::ranges::equal(f[j], p, std::less_equal{});
+            });
+            if (!dominated) {
+                kept.push_back(idx[i]);
+                nd.Push(p);
+            }
+        }
+        return nd;
+    }
+
+    // WFG: the hypervolume is the sum of the exclusive contributions of the points, the contribution of a point is
+    // its own volume minus the hypervolume of the following points limited to the region it dominates
+    auto Wfg(Front const& f, std::span<double const> ref) -> double // NOLINT(misc-no-recursion)
+    {
+        auto const n = f.Size();
+        auto const m = f.M;
+        if (n == 0) { return 0; }
+        if (m == 2) { return Hv2(f, ref); }
+        if (m == 3) { return Hv3(f, ref); }
+
+        auto volume = [&](auto p) {
+            auto v{1.0};
+            for (auto i = 0UL; i < m; ++i) { v *= ref[i] - p[i]; }
+            return v;
+        };
+        if (n == 1) { return volume(f[0]); }
+
+        // sorting by the last objective makes the limited sets smaller
+        auto idx = Sorted(f, [](auto a, auto b) { return a.back() > b.back(); });
+        auto hv{0.0};
+        Front limit{ m, {} };
+        std::vector<double> q(m);
+        for (auto k = 0UL; k < n; ++k) {
+            auto const p = f[idx[k]];
+            limit.Values.clear();
+            for (auto j = k + 1; j < n; ++j) {
+                std::ranges::transform(p, f[idx[j]], q.begin(), [](auto a, auto b) { return std::max(a, b); });
+                limit.Push(q);
+            }
+            hv += volume(p) - Wfg(Nondominated(limit), ref);
+        }
+        return hv;
+    }
+
+    // the points that strictly dominate the reference point (the others have no volume)
+    auto Clip(auto const& points, std::span<double const> ref) -> Front
+    {
+        Front f{ ref.size(), {} };
+        for (auto const& p : points) {
+            EXPECT(p.size() == ref.size());
+            auto inside{true};
+            for (auto i = 0UL; i < ref.size(); ++i) { inside = inside && p[i] < ref[i]; }
+            if (inside) { f.Push(p); }
+        }
+        return f;
+    }
+
+    auto ComputeHypervolume(auto const& points, Operon::Span<Operon::Scalar const> reference) -> double
+    {
+        if (reference.size() < 2) {
+            throw std::invalid_argument(fmt::format("the hypervolume needs at least two objectives, the reference point has {}", reference.size()));
+        }
+        std::vector<double> ref(reference.begin(), reference.end());
+        auto f = Clip(points, ref);
+        return Wfg(f.M > 3 ? Nondominated(f) : f, ref);
+    }
+
+    auto ComputeIgd(auto const& points, Operon::Span<Operon::Vector<Operon::Scalar> const> reference) -> double
+    {
+        if (reference.empty()) { return std::numeric_limits<double>::quiet_NaN(); }
+        auto sum{0.0};
+        for (auto const& r : reference) {
+            auto d{std::numeric_limits<double>::infinity()};
+            for (auto const& p : points) {
+                EXPECT(p.size() == r.size());
+                auto s{0.0};
+                for (auto i = 0UL; i < r.size(); ++i) {
+                    auto const e = static_cast<double>(p[i]) - static_cast<double>(r[i]);
+                    s += e * e;
+                }
+                d = std::min(d, s);
+            }
+            sum += std::sqrt(d);
+        }
+        return sum / static_cast<double>(reference.size());
+    }
+
+    auto Fitness(Operon::Span<Operon::Individual const> front)
+    {
+        std::vector<Operon::Vector<Operon::Scalar>> points;
+        points.reserve(front.size());
+        for (auto const& ind : front) { points.push_back(ind.Fitness); }
+        return points;
+    }
+} // namespace
+
+auto Hypervolume(Operon::Span<Operon::Individual const> front, Operon::Span<Operon::Scalar const> reference) -> double
+{
+    return ComputeHypervolume(Fitness(front), reference);
+}
+
+auto InvertedGenerationalDistance(Operon::Span<Operon::Individual const> front, Operon::Span<Operon::Vector<Operon::Scalar> const> reference) -> double
+{
+    return ComputeIgd(Fitness(front), reference);
+}
+
+ParetoIndicators::ParetoIndicators(Point reference, std::vector<Point> referenceFront)
+    : reference_(std::move(reference))
+    , referenceFront_(std::move(referenceFront))
+    , igd_(std::numeric_limits<double>::quiet_NaN())
+{
+    if (reference_.size() < 2) {
+        throw std::invalid_argument(fmt::format("the hypervolume needs at least two objectives, the reference point has {}", reference_.size()));
+    }
+    for (auto const& p : referenceFront_) {
+        if (p.size() != reference_.size()) {
+            throw std::invalid_argument(fmt::format("the reference front has a point with {} objectives instead of {}", p.size(), reference_.size()));
+        }
+    }
+}
+
+auto ParetoIndicators::Update(Operon::Span<Operon::Individual const> front) -> bool
+{
+    buffer_.clear();
+    for (auto const& ind : front) { buffer_.push_back(ind.Fitness); }
+    return Update();
+}
+
+auto ParetoIndicators::Update(Operon::Span<Operon::Individual const> population, Operon::Span<std::size_t const> indices) -> bool
+{
+    buffer_.clear();
+    for (auto i : indices) { buffer_.push_back(population[i].Fitness); }
+    return Update();
+}
+
+auto ParetoIndicators::Update(SolutionArchive const& archive) -> bool
+{
+    // other threads may insert into the archive
+    return Update(archive.Snapshot());
+}
+
+auto ParetoIndicators::Update() -> bool
+{
+    std::ranges::sort(buffer_, [](auto const& a, auto const& b) { return std::ranges::lexicographical_compare(a, b); });
+    auto const changed = history_.empty() || buffer_ != front_;
+    if (changed) {
+        std::swap(front_, buffer_);
+        hypervolume_ = ComputeHypervolume(front_, reference_);
+        igd_ = ComputeIgd(front_, referenceFront_);
+    }
+    history_.push_back(hypervolume_);
+    return changed;
+}
+
+auto ParetoIndicators::Converged() const -> bool
+{
+    if (window_ == 0 || history_.size() <= window_) { return false; }
+    auto const previous = history_[history_.size() - 1 - window_];
+    return hypervolume_ - previous <= tolerance_ * std::abs(previous);
+}
+
+auto ParetoIndicators::Reset() -> void
+{
+    front_.clear();
+    history_.clear();
+    hypervolume_ = 0;
+    igd_ = std::numeric_limits<double>::quiet_NaN();
+}
+
+} // namespace Operon
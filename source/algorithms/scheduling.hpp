@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_ALGORITHMS_SCHEDULING_HPP
+#define OPERON_ALGORITHMS_SCHEDULING_HPP
+
+// the scheduling of the parallel loops of GeneticProgrammingAlgorithm and NSGA2 (see GeneticAlgorithmConfig::CostScheduling)
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <numeric>
+#include <taskflow/taskflow.hpp>
+#include <taskflow/algorithm/for_each.hpp>
+#include <vector>
+
+#include "operon/core/tree.hpp"
+
+namespace Operon::detail {
+
+// the estimated cost of evaluating a tree and optimizing its coefficients for the given number of iterations
+// - an evaluation is linear in the length of the tree, an iteration of the local search also computes one column of
+//   the jacobian per coefficient
+inline auto EstimatedCost(Tree const& tree, std::size_t iterations) -> double
+{
+    auto const length = static_cast<double>(tree.Length());
+    auto const coefficients = static_cast<double>(tree.CoefficientsCount());
+    return length * (1 + (static_cast<double>(iterations) * (1 + coefficients)));
+}
+
+// the first index of each group of (at most) `size` indices in [first, last), the groups with the largest cost first
+// - longest processing time first: the expensive groups start early instead of being picked up last and keeping the
+//   other workers at the barrier, the loop over the schedule must hand out one group at a time (see ForEachIndex)
+// - cost(i, n) is the estimated cost of the group [i, i + n), the groups stay in their order if sorted is false
+template<typename Cost>
+auto ScheduleGroups(std::size_t first, std::size_t last, std::size_t size, Cost&& cost, bool sorted, std::vector<std::size_t>& schedule) -> void
+{
+    schedule.clear();
+    for (auto i = first; i < last; i += size) { schedule.push_back(i); }
+    if (!sorted) { return; }
+
+    thread_local std::vector<double> costs;
+    costs.resize(schedule.size());
+    for (auto k = 0UL; k < schedule.size(); ++k) {
+        auto const i = schedule[k];
+        costs[k] = cost(i, std::min(size, last - i));
+    }
+    thread_local std::vector<std::size_t> order;
+    order.resize(schedule.size());
+    std::iota(order.begin(), order.end(), 0UL);
+    std::stable_sort(order.begin(), order.end(), [&](auto a, auto b) { return costs[a] > costs[b]; });
+    for (auto& k : order) { k = schedule[k]; }
+    std::swap(order, schedule);
+}
+
+// a loop over [first, last), the indices are handed to the workers one at a time if dynamic, otherwise in chunks
+// by the default (guided) partitioner
+template<typename F>
+auto ForEachIndex(tf::Subflow& subflow, std::size_t first, std::size_t last, F&& f, bool dynamic) -> tf::Task
+{
+    if (dynamic) { return subflow.for_each_index(first, last, std::size_t{1}, std::forward<F>(f), tf::DynamicPartitioner{1}); }
+    return subflow.for_each_index(first, last, std::size_t{1}, std::forward<F>(f));
+}
+
+// the same loop with a worker limit (see GeneticAlgorithmBase::SetWorkerLimit): if workers is not zero, that many
+// tasks take the next index in turn (in the order of the indices, like the dynamic loop) and the other workers of the
+// executor stay idle
+template<typename F>
+auto ForEachIndex(tf::Subflow& subflow, std::size_t first, std::size_t last, F&& f, bool dynamic, std::size_t workers) -> tf::Task
+{
+    if (workers == 0) { return ForEachIndex(subflow, first, last, std::forward<F>(f), dynamic); }
+    return subflow.emplace([first, last, workers, f = std::forward<F>(f)](tf::Subflow& limited) {
+        auto next = std::make_shared<std::atomic<std::size_t>>(first);
+        for (auto w = 0UL; w < std::min(workers, last - std::min(first, last)); ++w) {
+            limited.emplace([next, last, f]() {
+                for (auto i = (*next)++; i < last; i = (*next)++) { f(i); }
+            });
+        }
+    });
+}
+
+} // namespace Operon::detail
+
+#endif
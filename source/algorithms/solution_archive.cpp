@@ -3,45 +3,260 @@
 
 #include <cstdint>
 #include <algorithm>
+#include <cmath>
 #include <iterator>
+#include <mutex>
+#include <shared_mutex>
 #include <span>
 #include <vector>
 
 #include "operon/algorithms/solution_archive.hpp"
 #include "operon/core/comparison.hpp"
+#include "operon/core/contracts.hpp"
 #include "operon/core/individual.hpp"
 #include "operon/core/types.hpp"
+#include "operon/hash/hash.hpp"
 
 namespace Operon {
 
-auto SolutionArchive::Insert(Operon::Individual const& individual) -> bool
+namespace {
+    auto LexicographicLess(Operon::Individual const& a, Operon::Individual const& b) -> bool
+    {
+        return std::ranges::lexicographical_compare(a.Fitness, b.Fitness);
+    }
+
+    // the index of the box of a value along one objective (adding zero turns -0 into 0, so that equal boxes hash alike)
+    auto Quantize(Operon::Scalar f, Operon::Scalar eps) -> Operon::Scalar
+    {
+        return std::floor(f / eps) + Operon::Scalar{0};
+    }
+
+    auto BoxOf(Operon::Span<Operon::Scalar const> fitness, Operon::Scalar eps, Operon::Vector<Operon::Scalar>& box) -> void
+    {
+        box.resize(fitness.size());
+        std::ranges::transform(fitness, box.begin(), [eps](auto f) { return Quantize(f, eps); });
+    }
+
+    // the box of the fitness is lexicographically smaller than the given box
+    auto BoxLess(Operon::Span<Operon::Scalar const> fitness, Operon::Span<Operon::Scalar const> box, Operon::Scalar eps) -> bool
+    {
+        for (auto i = 0UL; i < fitness.size(); ++i) {
+            auto const q = Quantize(fitness[i], eps);
+            if (q != box[i]) { return q < box[i]; }
+        }
+        return false;
+    }
+
+    // every coordinate of the box of the fitness is smaller (lhs) or larger (rhs) than the one of the given box
+    auto BoxDominates(Operon::Span<Operon::Scalar const> fitness, Operon::Span<Operon::Scalar const> box, Operon::Scalar eps) -> bool
+    {
+        for (auto i = 0UL; i < fitness.size(); ++i) {
+            if (Quantize(fitness[i], eps) > box[i]) { return false; }
+        }
+        return true;
+    }
+
+    auto BoxDominated(Operon::Span<Operon::Scalar const> fitness, Operon::Span<Operon::Scalar const> box, Operon::Scalar eps) -> bool
+    {
+        for (auto i = 0UL; i < fitness.size(); ++i) {
+            if (Quantize(fitness[i], eps) < box[i]) { return false; }
+        }
+        return true;
+    }
+
+    // y takes the place of x in their common box
+    auto Replaces(Operon::Span<Operon::Scalar const> y, Operon::Span<Operon::Scalar const> x, Operon::Span<Operon::Scalar const> box, Operon::Scalar eps) -> bool
+    {
+        auto const res = Operon::ParetoDominance{}(y, x);
+        if (res != Dominance::None) { return res == Dominance::Left; }
+
+        auto distance = [&](auto const& f) {
+            Operon::Scalar d{0};
+            for (auto i = 0UL; i < f.size(); ++i) {
+                auto const v = f[i] - (box[i] * eps);
+                d += v * v;
+            }
+            return d;
+        };
+        return distance(y) < distance(x);
+    }
+
+    auto ScratchBox() -> Operon::Vector<Operon::Scalar>&
+    {
+        thread_local Operon::Vector<Operon::Scalar> box;
+        return box;
+    }
+} // namespace
+
+auto SolutionArchive::BoxHash::operator()(Operon::Vector<Operon::Scalar> const& box) const noexcept -> uint64_t
+{
+    return Operon::Hasher{}(reinterpret_cast<uint8_t const*>(box.data()), box.size() * sizeof(Operon::Scalar)); // NOLINT
+}
+
+auto SolutionArchive::IsBoxDominated(Operon::Individual const& individual, Operon::Vector<Operon::Scalar> const& box) const -> bool
+{
+    auto const& y = individual;
+
+    // the solution of the same box is only replaced by a better one
+    if (auto it = boxes_.find(box); it != boxes_.end()) {
+        return !Replaces(y.Fitness, it->second, box, eps_);
+    }
+
+    // only the boxes that are lexicographically smaller can dominate the box of y
+    auto const last = std::lower_bound(archive_.begin(), archive_.end(), box, [&](auto const& x, auto const& b) { return BoxLess(x.Fitness, b, eps_); });
+    if (last == archive_.begin()) { return false; }
+
+    if (y.Size() == 2) {
+        // the boxes along the archive have a decreasing second coordinate
+        return Quantize(std::prev(last)->Fitness[1], eps_) <= box[1];
+    }
+    return std::any_of(archive_.begin(), last, [&](auto const& x) { return BoxDominates(x.Fitness, box, eps_); });
+}
+
+auto SolutionArchive::IsDominated(Operon::Individual const& individual) const -> bool
 {
     auto const& y = individual;
     Operon::ParetoDominance dom{};
+    // a solution with the same outputs (see Evaluator::SetSemanticHashing) is only replaced by one that dominates it
+    if (y.Semantic != 0 && std::ranges::any_of(archive_, [&](auto const& x) { return x.Semantic == y.Semantic && dom(x.Fitness, y.Fitness) != Dominance::Right; })) {
+        return true;
+    }
+
+    if (eps_ > 0) {
+        auto& box = ScratchBox();
+        BoxOf(y.Fitness, eps_, box);
+        return IsBoxDominated(y, box);
+    }
+
+    // only the solutions that are lexicographically smaller or equal can dominate y
+    auto const last = std::upper_bound(archive_.begin(), archive_.end(), y, LexicographicLess);
+    if (last == archive_.begin()) { return false; }
 
-    // check if the current individual is dominated by any solution in the archive_
-    // or if it is equal to any solution in the archive_
-    if (std::any_of(archive_.begin(), archive_.end(), [&](auto const& x) {
-        auto res = dom(x.Fitness, y.Fitness, eps_);
+    if (y.Size() == 2) {
+        // the solutions before last have the smallest second objective at the end
+        return std::prev(last)->Fitness[1] <= y.Fitness[1];
+    }
+
+    return std::any_of(archive_.begin(), last, [&](auto const& x) {
+        auto res = dom(x.Fitness, y.Fitness);
         return res == Dominance::Left || res == Dominance::Equal;
-    })) { return false ; } // individual is dominated by or equal to an existing solution
+    });
+}
+
+auto SolutionArchive::InsertUnsafe(Operon::Individual const& individual) -> bool
+{
+    auto const& y = individual;
+    if (IsDominated(y)) { return false; } // individual is dominated by or equal to an existing solution
+
+    if (eps_ > 0) {
+        auto& box = ScratchBox();
+        BoxOf(y.Fitness, eps_, box);
+        auto first = std::lower_bound(archive_.begin(), archive_.end(), box, [&](auto const& x, auto const& b) { return BoxLess(x.Fitness, b, eps_); });
+        if (auto it = boxes_.find(box); it != boxes_.end()) {
+            // y is better than the solution of its box, which is at the insertion point
+            *first = y;
+            it->second = y.Fitness;
+            return true;
+        }
 
-    // remove solutions that are dominated by the current individual
-    std::erase_if(archive_, [&](auto const& x) { return dom(x.Fitness, y.Fitness, eps_) == Dominance::Right; });
-    archive_.push_back(y);
+        // remove the solutions in the boxes dominated by the box of y (all of them are after its insertion point)
+        decltype(first) last;
+        if (y.Size() == 2) {
+            last = std::find_if(first, archive_.end(), [&](auto const& x) { return Quantize(x.Fitness[1], eps_) < box[1]; });
+        } else {
+            last = std::stable_partition(first, archive_.end(), [&](auto const& x) { return BoxDominated(x.Fitness, box, eps_); });
+        }
+        Operon::Vector<Operon::Scalar> removed;
+        for (auto it = first; it != last; ++it) {
+            BoxOf(it->Fitness, eps_, removed);
+            boxes_.erase(removed);
+        }
+        if (y.Size() != 2) {
+            // the remaining solutions were moved after the dominated ones, in the same order
+            first = archive_.erase(first, last);
+            last = first;
+        }
+        archive_.insert(archive_.erase(first, last), y);
+        boxes_.emplace(box, y.Fitness);
+        return true;
+    }
+
+    // remove the solutions that are dominated by the current individual (all of them are after its insertion point)
+    auto first = std::upper_bound(archive_.begin(), archive_.end(), y, LexicographicLess);
+    decltype(first) last;
+    if (y.Size() == 2) {
+        last = std::find_if(first, archive_.end(), [&](auto const& x) { return x.Fitness[1] < y.Fitness[1]; });
+    } else {
+        Operon::ParetoDominance dom{};
+        last = std::remove_if(first, archive_.end(), [&](auto const& x) { return dom(x.Fitness, y.Fitness) == Dominance::Right; });
+        archive_.erase(last, archive_.end());
+        last = first;
+    }
+    archive_.insert(archive_.erase(first, last), y);
     return true;
 }
 
+auto SolutionArchive::Insert(Operon::Individual const& individual) -> bool
+{
+    {
+        std::shared_lock lock(mutex_);
+        if (IsDominated(individual)) { return false; }
+    }
+    // the archive may have changed in the meantime, so the check is repeated
+    std::unique_lock lock(mutex_);
+    return InsertUnsafe(individual);
+}
+
 auto SolutionArchive::Insert(Operon::Span<Operon::Individual const> individuals) -> int64_t {
-    auto const s { std::ssize(archive_) };
-    for (auto const& x : individuals) { Insert(x); }
-    if (!archive_.empty()) {
-        auto const m{ archive_.front().Size() };
-        for (auto k = 0UL; k < m; ++k) {
-            auto cmp = [k](auto const& a, auto const& b) { return a[k] < b[k]; };
-            std::stable_sort(archive_.begin(), archive_.end(), cmp);
+    // filter the individuals under the shared lock, then insert the remaining ones in one go
+    std::vector<Operon::Individual const*> candidates;
+    {
+        std::shared_lock lock(mutex_);
+        for (auto const& x : individuals) {
+            if (!IsDominated(x)) { candidates.push_back(&x); }
         }
     }
+    if (candidates.empty()) { return 0; }
+
+    std::unique_lock lock(mutex_);
+    auto const s { std::ssize(archive_) };
+    for (auto const* x : candidates) { InsertUnsafe(*x); }
     return std::ssize(archive_) - s;
 }
+
+auto SolutionArchive::Snapshot() const -> std::vector<Operon::Individual>
+{
+    std::shared_lock lock(mutex_);
+    return archive_;
+}
+
+auto SolutionArchive::Size() const -> std::size_t
+{
+    std::shared_lock lock(mutex_);
+    return archive_.size();
+}
+
+auto SolutionArchive::Clear() -> void
+{
+    std::unique_lock lock(mutex_);
+    archive_.clear();
+    boxes_.clear();
+}
+
+auto SolutionArchive::SetEpsilon(Operon::Scalar eps) -> void
+{
+    EXPECT(eps >= 0);
+    std::unique_lock lock(mutex_);
+    eps_ = eps;
+    auto solutions = std::move(archive_);
+    archive_.clear();
+    boxes_.clear();
+    for (auto const& x : solutions) { InsertUnsafe(x); }
+}
+
+auto SolutionArchive::GetEpsilon() const -> Operon::Scalar
+{
+    std::shared_lock lock(mutex_);
+    return eps_;
+}
 } // namespace Operon
@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <algorithm>                         // for min_element, sort
+#include <atomic>                            // for atomic
+#include <exception>                         // for exception_ptr
+#include <limits>                            // for numeric_limits
+#include <numeric>                           // for iota
+#include <taskflow/taskflow.hpp>             // for executor
+#include <thread>                            // for thread
+
+#include "operon/algorithms/successive_halving.hpp"
+#include "operon/core/contracts.hpp"         // for EXPECT
+
+namespace Operon {
+
+auto SuccessiveHalving::Run(tf::Executor& executor, Operon::RandomGenerator& rng, std::vector<GeneticAlgorithmConfig> const& configs, std::function<void(size_t)> report) const -> std::vector<SweepResult>
+{
+    EXPECT(config_.Reduction > 1);
+    EXPECT(config_.Generations > 0);
+    auto const n = configs.size();
+
+    // the algorithms keep a reference to their config, which is therefore never reallocated
+    std::vector<GeneticAlgorithmConfig> trialConfigs(configs);
+    std::vector<std::shared_ptr<GeneticProgrammingAlgorithm>> algorithms(n);
+    std::vector<Operon::RandomGenerator> rngs;
+    std::vector<SweepResult> results(n);
+    for (auto i = 0UL; i < n; ++i) {
+        rngs.emplace_back(rng());
+        results[i].Config = configs[i];
+    }
+
+    auto score = [&](GeneticProgrammingAlgorithm const& algorithm) -> double {
+        if (score_) { return std::invoke(score_, algorithm); }
+        auto const parents = algorithm.Parents();
+        if (parents.empty()) { return std::numeric_limits<double>::max(); }
+        return std::ranges::min_element(parents, std::less{}, [](auto const& ind) { return ind[0]; })->operator[](0);
+    };
+
+    // the configurations of a rung are taken in turn by a number of threads, their tasks share the workers of the executor
+    auto runRung = [&](std::vector<size_t> const& alive, size_t generations) {
+        auto const concurrent = std::min(alive.size(), config_.ConcurrentRuns > 0 ? config_.ConcurrentRuns : std::max(executor.num_workers(), size_t{1}));
+        std::atomic<size_t> next{0};
+        std::vector<std::exception_ptr> errors(concurrent);
+        std::vector<std::thread> workers;
+        workers.reserve(concurrent);
+        for (auto w = 0UL; w < concurrent; ++w) {
+            workers.emplace_back([&, w]() {
+                try {
+                    for (auto k = next++; k < alive.size(); k = next++) {
+                        auto const i = alive[k];
+                        trialConfigs[i].Generations = generations;
+                        auto& algorithm = algorithms[i];
+                        if (algorithm) {
+                            algorithm->Continue();
+                        } else {
+                            algorithm = std::invoke(factory_, trialConfigs[i]);
+                            EXPECT(algorithm != nullptr);
+                        }
+                        algorithm->Run(executor, rngs[i]);
+                        auto& r = results[i];
+                        ++r.Rungs;
+                        r.Generations += algorithm->Generation();
+                        r.Score = score(*algorithm);
+                        if (report) { std::invoke(report, i); }
+                    }
+                } catch (...) {
+                    errors[w] = std::current_exception();
+                    next = alive.size(); // the other threads do not start new configurations
+                }
+            });
+        }
+        for (auto& w : workers) { w.join(); }
+        for (auto const& e : errors) {
+            if (e) { std::rethrow_exception(e); }
+        }
+    };
+
+    std::vector<size_t> alive(n);
+    std::iota(alive.begin(), alive.end(), 0UL);
+
+    // the survivors of rung k have run Generations * Reduction^k generations in total
+    for (auto total = config_.Generations, previous = 0UL; !alive.empty(); previous = std::exchange(total, total * config_.Reduction)) {
+        runRung(alive, total - previous);
+        if (alive.size() == 1) { break; }
+
+        std::ranges::stable_sort(alive, std::less{}, [&](auto i) { return results[i].Score; });
+        auto const keep = std::max(alive.size() / config_.Reduction, size_t{1});
+        // the memory of the stopped configurations is released
+        for (auto k = keep; k < alive.size(); ++k) { algorithms[alive[k]].reset(); }
+        alive.resize(keep);
+    }
+    return results;
+}
+
+auto SuccessiveHalving::Best(std::vector<SweepResult> const& results) -> size_t
+{
+    EXPECT(!results.empty());
+    auto const it = std::ranges::min_element(results, [](auto const& lhs, auto const& rhs) {
+        return lhs.Rungs != rhs.Rungs ? lhs.Rungs > rhs.Rungs : lhs.Score < rhs.Score;
+    });
+    return static_cast<size_t>(std::distance(results.begin(), it));
+}
+
+} // namespace Operon
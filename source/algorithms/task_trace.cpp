@@ -0,0 +1,208 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include "operon/algorithms/task_trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fmt/format.h>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <ostream>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <taskflow/taskflow.hpp>
+#include <vector>
+
+namespace Operon {
+
+struct TaskTrace::Observer final : public tf::ObserverInterface {
+    using Clock = std::chrono::steady_clock;
+
+    struct Event {
+        std::string Name;
+        Clock::time_point Begin;
+        Clock::time_point End;
+    };
+
+    // the timeline of a worker, the open tasks are kept on a stack because a worker can run the tasks of a
+    // subflow while the parent task is still running
+    struct Timeline {
+        std::vector<Event> Events;
+        std::vector<std::size_t> Open;
+        std::size_t Offspring{0};
+        std::size_t Marked{0}; // the events before were accounted for by the last mark
+    };
+
+    Clock::time_point Origin{Clock::now()};
+    Clock::time_point Marked{Origin};
+    std::vector<Timeline> Timelines;
+
+    auto set_up(std::size_t workers) -> void final { Timelines.resize(workers); } // NOLINT
+
+    auto on_entry(tf::WorkerView w, tf::TaskView task) -> void final // NOLINT
+    {
+        auto& timeline = Timelines[w.id()];
+        timeline.Open.push_back(timeline.Events.size());
+        timeline.Events.push_back({ task.name().empty() ? std::string{"task"} : task.name(), Clock::now(), {} });
+    }
+
+    auto on_exit(tf::WorkerView w, tf::TaskView /*task*/) -> void final // NOLINT
+    {
+        auto& timeline = Timelines[w.id()];
+        if (timeline.Open.empty()) { return; } // the task started before the trace was attached
+        timeline.Events[timeline.Open.back()].End = Clock::now();
+        timeline.Open.pop_back();
+    }
+};
+
+namespace {
+    auto Escape(std::string_view str) -> std::string
+    {
+        std::string result;
+        result.reserve(str.size());
+        for (auto c : str) {
+            if (c == '"' || c == '\\') {
+                result.push_back('\\');
+                result.push_back(c);
+            } else if (static_cast<unsigned char>(c) < 0x20) { // NOLINT
+                fmt::format_to(std::back_inserter(result), "\\u{:04x}", static_cast<int>(c));
+            } else {
+                result.push_back(c);
+            }
+        }
+        return result;
+    }
+} // namespace
+
+TaskTrace::TaskTrace(tf::Executor& executor)
+    : executor_(executor)
+    , observer_(executor.make_observer<Observer>())
+{
+}
+
+TaskTrace::~TaskTrace()
+{
+    executor_.remove_observer(observer_);
+}
+
+auto TaskTrace::Size() const -> std::size_t
+{
+    std::size_t n{0};
+    for (auto const& t : observer_->Timelines) { n += t.Events.size() - t.Open.size(); }
+    return n;
+}
+
+auto TaskTrace::Clear() -> void
+{
+    for (auto& t : observer_->Timelines) {
+        t.Events.clear();
+        t.Open.clear();
+    }
+    observer_->Origin = Observer::Clock::now();
+    observer_->Marked = observer_->Origin;
+    loads_.clear();
+}
+
+auto TaskTrace::AddOffspring(std::size_t worker) -> void
+{
+    ++observer_->Timelines[worker].Offspring;
+}
+
+auto TaskTrace::Mark() -> void
+{
+    using Seconds = std::chrono::duration<double>;
+    auto const now = Observer::Clock::now();
+    auto const from = observer_->Marked;
+
+    auto& loads = loads_.emplace_back(observer_->Timelines.size());
+    for (auto w = 0UL; w < observer_->Timelines.size(); ++w) {
+        auto& timeline = observer_->Timelines[w];
+        auto const& events = timeline.Events;
+        auto& load = loads[w];
+
+        // the events of a worker are in the order of their start and a nested event starts before its parent ends,
+        // so the busy intervals are also sorted by their start
+        auto end = [&](auto const& e) { return e.End < e.Begin ? now : std::min(e.End, now); };
+        auto covered{from};
+        Observer::Clock::duration busy{0};
+        for (auto k = timeline.Marked; k < events.size(); ++k) {
+            auto const& e = events[k];
+            auto last = end(e);
+            if (k + 1 < events.size() && events[k + 1].Begin < last) {
+                last = events[k + 1].Begin; // the task has spawned tasks on this worker
+            } else {
+                ++load.Tasks;
+            }
+            auto const first = std::max(e.Begin, covered);
+            if (last > first) {
+                busy += last - first;
+                covered = last;
+            }
+        }
+        timeline.Marked = events.size();
+
+        load.Busy = Seconds(busy).count();
+        load.Idle = std::max(0.0, Seconds(now - from).count() - load.Busy);
+        load.Offspring = std::exchange(timeline.Offspring, 0);
+    }
+    observer_->Marked = now;
+}
+
+auto TaskTrace::Imbalance(Operon::Span<WorkerLoad const> loads) -> double
+{
+    if (loads.empty()) { return 1; }
+    auto const total = std::transform_reduce(loads.begin(), loads.end(), 0.0, std::plus{}, [](auto const& l) { return l.Busy; });
+    auto const busiest = std::ranges::max(loads, std::less{}, &WorkerLoad::Busy).Busy;
+    return total > 0 ? busiest * static_cast<double>(loads.size()) / total : 1;
+}
+
+auto TaskTrace::WriteWorkerLoad(std::ostream& out) const -> void
+{
+    fmt::memory_buffer buf;
+    auto it = std::back_inserter(buf);
+    fmt::format_to(it, "generation,worker,busy,idle,tasks,offspring\n");
+    for (auto g = 0UL; g < loads_.size(); ++g) {
+        for (auto w = 0UL; w < loads_[g].size(); ++w) {
+            auto const& l = loads_[g][w];
+            fmt::format_to(it, "{},{},{:.6f},{:.6f},{},{}\n", g, w, l.Busy, l.Idle, l.Tasks, l.Offspring);
+        }
+    }
+    out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+}
+
+auto TaskTrace::WriteChromeTrace(std::ostream& out) const -> void
+{
+    using Microseconds = std::chrono::duration<double, std::micro>;
+    auto const origin = observer_->Origin;
+
+    fmt::memory_buffer buf;
+    auto it = std::back_inserter(buf);
+    fmt::format_to(it, "{{\"traceEvents\":[");
+    auto first{true};
+    for (auto w = 0UL; w < observer_->Timelines.size(); ++w) {
+        fmt::format_to(it, "{}{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":{},\"args\":{{\"name\":\"worker {}\"}}}}", first ? "" : ",", w, w);
+        first = false;
+        for (auto const& e : observer_->Timelines[w].Events) {
+            if (e.End < e.Begin) { continue; } // still running
+            fmt::format_to(it, ",{{\"name\":\"{}\",\"cat\":\"task\",\"ph\":\"X\",\"pid\":0,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+                Escape(e.Name), w, Microseconds(e.Begin - origin).count(), Microseconds(e.End - e.Begin).count());
+        }
+    }
+    fmt::format_to(it, "],\"displayTimeUnit\":\"ms\"}}\n");
+    out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+}
+
+auto TaskTrace::WriteChromeTrace(std::string const& path) const -> void
+{
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error(fmt::format("cannot open {} for writing", path));
+    }
+    WriteChromeTrace(out);
+}
+
+} // namespace Operon
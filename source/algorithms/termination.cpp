@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <algorithm>
+#include <vector>
+
+#include "operon/algorithms/termination.hpp"
+#include "operon/analyzers/diversity.hpp"
+#include "operon/core/contracts.hpp"
+#include "operon/core/tree.hpp"
+
+namespace Operon {
+
+auto ToString(TerminationReason reason) -> std::string_view
+{
+    switch (reason) {
+    case TerminationReason::None: return "none";
+    case TerminationReason::Stagnation: return "stagnation";
+    case TerminationReason::Target: return "target";
+    case TerminationReason::Diversity: return "diversity";
+    }
+    return "unknown";
+}
+
+TerminationCriteria::TerminationCriteria(GeneticAlgorithmConfig const& config)
+    : stagnationGenerations_(config.StagnationGenerations)
+    , target_(config.TargetFitness)
+    , minimumDiversity_(config.MinimumDiversity)
+    , diversityInterval_(std::max(config.DiversityInterval, std::size_t{1}))
+    , epsilon_(config.Epsilon)
+{
+}
+
+auto TerminationCriteria::Update(Operon::Span<Operon::Individual const> parents) -> void
+{
+    EXPECT(!parents.empty());
+    auto const best = static_cast<double>(std::ranges::min(parents, std::less{}, [](auto const& ind) { return ind[0]; })[0]);
+
+    if (updates_ == 0 || best < best_ - epsilon_) {
+        best_ = best;
+        stagnation_ = 0;
+    } else {
+        ++stagnation_;
+    }
+
+    if (minimumDiversity_ > 0 && updates_ % diversityInterval_ == 0 && parents.size() > 1) {
+        std::vector<Operon::Tree> trees;
+        trees.reserve(parents.size());
+        for (auto const& ind : parents) { trees.push_back(ind.Genotype); }
+        PopulationDiversityAnalyzer<Operon::Tree> analyzer;
+        analyzer.Prepare(trees);
+        Operon::RandomGenerator rng{0}; // not used by the analyzer
+        diversity_ = analyzer(rng);
+    }
+    ++updates_;
+
+    if (best_ <= target_) {
+        reason_ = TerminationReason::Target;
+    } else if (stagnationGenerations_ > 0 && stagnation_ >= stagnationGenerations_) {
+        reason_ = TerminationReason::Stagnation;
+    } else if (minimumDiversity_ > 0 && diversity_ < minimumDiversity_) {
+        reason_ = TerminationReason::Diversity;
+    }
+}
+
+auto TerminationCriteria::Reset() -> void
+{
+    updates_ = 0;
+    stagnation_ = 0;
+    best_ = 0;
+    diversity_ = 1;
+    reason_ = TerminationReason::None;
+}
+
+} // namespace Operon
@@ -0,0 +1,154 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+#include "operon/algorithms/validation.hpp"
+#include "operon/core/problem.hpp"
+#include "operon/operators/evaluator.hpp"
+
+namespace Operon {
+
+ValidationMonitor::ValidationMonitor(EvaluatorBase const& evaluator, std::size_t k, std::size_t patience, Operon::RandomGenerator::result_type seed)
+    : evaluator_(evaluator)
+    , k_(k)
+    , patience_(patience)
+    , rng_(seed)
+{
+    if (k_ == 0) {
+        throw std::invalid_argument("the number of validated individuals must be positive");
+    }
+    if (evaluator.GetProblem().ValidationRange().Size() == 0) {
+        throw std::invalid_argument("the validation range of the problem is empty");
+    }
+    thread_ = std::thread([this]() { Work(); });
+}
+
+ValidationMonitor::~ValidationMonitor()
+{
+    {
+        std::scoped_lock lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+}
+
+auto ValidationMonitor::Rethrow() -> void
+{
+    if (error_) {
+        std::rethrow_exception(std::exchange(error_, nullptr));
+    }
+}
+
+auto ValidationMonitor::Submit(Operon::Span<Operon::Individual const> population, std::size_t generation) -> void
+{
+    // the k best individuals are copied since the algorithm overwrites the population
+    std::vector<std::size_t> idx(population.size());
+    std::iota(idx.begin(), idx.end(), 0UL);
+    auto const k = std::min(k_, idx.size());
+    std::ranges::partial_sort(idx, idx.begin() + static_cast<std::ptrdiff_t>(k), std::less{}, [&](auto i) { return population[i][0]; });
+
+    Batch batch;
+    batch.Generation = generation;
+    batch.Individuals.reserve(k);
+    for (auto i = 0UL; i < k; ++i) { batch.Individuals.push_back(population[idx[i]]); }
+    {
+        std::scoped_lock lock(mutex_);
+        Rethrow();
+        pending_ = std::move(batch);
+    }
+    cv_.notify_all();
+}
+
+auto ValidationMonitor::Wait() -> void
+{
+    std::unique_lock lock(mutex_);
+    cv_.wait(lock, [&]() { return !pending_ && !busy_; });
+    Rethrow();
+}
+
+auto ValidationMonitor::Archive() const -> std::vector<Entry>
+{
+    std::scoped_lock lock(mutex_);
+    return archive_;
+}
+
+auto ValidationMonitor::Best() const -> std::optional<Entry>
+{
+    std::scoped_lock lock(mutex_);
+    if (archive_.empty()) { return std::nullopt; }
+    return archive_.front();
+}
+
+auto ValidationMonitor::Count() const -> std::size_t
+{
+    std::scoped_lock lock(mutex_);
+    return count_;
+}
+
+auto ValidationMonitor::Validate(Batch& batch) -> std::vector<Entry>
+{
+    // only called from the background thread, the archive is read without the lock
+    auto const& evaluator = evaluator_.get();
+    auto const range = evaluator.GetProblem().ValidationRange();
+    Operon::Vector<Operon::Scalar> buf(range.Size());
+
+    std::vector<Entry> entries;
+    for (auto& ind : batch.Individuals) {
+        // the elites are submitted again in every generation, they do not need to be validated again
+        auto const hash = ind.Genotype.Hash(Operon::HashMode::Strict).HashValue();
+        auto known = [&](auto const& e) { return e.Model.Genotype.HashValue() == hash; };
+        if (std::ranges::any_of(archive_, known) || std::ranges::any_of(entries, known)) { continue; }
+
+        auto const f = evaluator.EvaluateSubset(rng_, ind, { buf.data(), buf.size() }, range).front();
+        entries.push_back({ std::move(ind), std::isfinite(f) ? f : EvaluatorBase::ErrMax, batch.Generation });
+    }
+    return entries;
+}
+
+auto ValidationMonitor::Work() -> void
+{
+    std::unique_lock lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [&]() { return stop_ || pending_; });
+        if (!pending_) { return; } // stopped with nothing left to validate
+
+        auto batch = std::move(*pending_);
+        pending_.reset();
+        busy_ = true;
+        lock.unlock();
+
+        std::exception_ptr error;
+        std::vector<Entry> entries;
+        try {
+            entries = Validate(batch);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        busy_ = false;
+        if (error) {
+            error_ = error;
+        } else {
+            auto const previous = archive_.empty() ? EvaluatorBase::ErrMax : archive_.front().Fitness;
+            std::ranges::move(entries, std::back_inserter(archive_));
+            std::ranges::stable_sort(archive_, std::less{}, &Entry::Fitness);
+            if (archive_.size() > k_) { archive_.erase(archive_.begin() + static_cast<std::ptrdiff_t>(k_), archive_.end()); }
+
+            ++count_;
+            stale_ = !archive_.empty() && archive_.front().Fitness < previous ? 0 : stale_ + 1;
+            if (patience_ > 0 && stale_ >= patience_) { earlyStop_.store(true, std::memory_order_relaxed); }
+        }
+        cv_.notify_all();
+    }
+}
+
+} // namespace Operon
@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+#include <utility>
+
+#include "operon/algorithms/worker_limit.hpp"
+
+namespace Operon {
+
+LoadAverageLimit::LoadAverageLimit(std::size_t cores)
+    : shared_(std::make_shared<Shared>())
+{
+    shared_->Cores = cores == 0 ? std::max(std::thread::hardware_concurrency(), 1U) : cores;
+}
+
+LoadAverageLimit::LoadAverageLimit(LoadAverageLimit const& other)
+    : shared_(other.shared_)
+{
+}
+
+LoadAverageLimit::LoadAverageLimit(LoadAverageLimit&& other) noexcept
+    : shared_(std::move(other.shared_))
+    , active_(std::exchange(other.active_, 0))
+{
+}
+
+LoadAverageLimit::~LoadAverageLimit()
+{
+    if (!shared_) { return; }
+    std::scoped_lock lock(shared_->Mutex);
+    shared_->Active -= active_;
+}
+
+auto LoadAverageLimit::operator()(std::size_t workers) -> std::size_t
+{
+#if defined(__unix__) || defined(__APPLE__)
+    double load{0};
+    if (::getloadavg(&load, 1) != 1) { return workers; }
+    std::scoped_lock lock(shared_->Mutex);
+    auto const runs = static_cast<double>(shared_->Active); // the workers of all the runs, counted by the load
+    auto const granted = static_cast<double>(shared_->Active - active_); // the workers of the other runs
+    auto const others = std::max(load - runs, 0.0);
+    auto const idle = std::max(static_cast<double>(shared_->Cores) - others - granted, 1.0);
+    shared_->Active -= active_;
+    active_ = std::clamp(static_cast<std::size_t>(std::lround(idle)), std::size_t{1}, workers);
+    shared_->Active += active_;
+    return active_;
+#else
+    return workers;
+#endif
+}
+
+} // namespace Operon
@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include "operon/analyzers/population_statistics.hpp"
+#include "operon/core/executor.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <taskflow/taskflow.hpp>
+#include <taskflow/algorithm/for_each.hpp>
+#include <vector>
+
+namespace Operon {
+
+namespace {
+    // the individuals are reduced in blocks of this size, the blocks are then merged in order
+    // - the result does not depend on the number of workers, and the serial version gives the same one
+    constexpr std::size_t BlockSize{1024};
+
+    // running mean and sum of squared deviations (Welford), merged with the pairwise update of Chan et al.
+    struct Moments {
+        std::size_t Count{0};
+        double Mean{0};
+        double M2{0};
+        double Min{std::numeric_limits<double>::max()};
+        double Max{std::numeric_limits<double>::lowest()};
+
+        auto operator()(double x) -> void
+        {
+            ++Count;
+            auto const delta = x - Mean;
+            Mean += delta / static_cast<double>(Count);
+            M2 += delta * (x - Mean);
+            Min = std::min(Min, x);
+            Max = std::max(Max, x);
+        }
+
+        auto Merge(Moments const& other) -> void
+        {
+            if (other.Count == 0) { return; }
+            if (Count == 0) { *this = other; return; }
+            auto const n = static_cast<double>(Count + other.Count);
+            auto const delta = other.Mean - Mean;
+            Mean += delta * static_cast<double>(other.Count) / n;
+            M2 += other.M2 + delta * delta * static_cast<double>(Count) * static_cast<double>(other.Count) / n;
+            Count += other.Count;
+            Min = std::min(Min, other.Min);
+            Max = std::max(Max, other.Max);
+        }
+
+        [[nodiscard]] auto Summary() const -> SummaryStatistics
+        {
+            if (Count == 0) { return {}; }
+            return { Count, Mean, M2 / static_cast<double>(Count), Min, Max };
+        }
+    };
+
+    struct Accumulator {
+        std::size_t Best{0};
+        Operon::Scalar BestFitness{std::numeric_limits<Operon::Scalar>::max()};
+        std::array<Moments, 4> Values; // fitness, length, depth, complexity
+
+        auto Merge(Accumulator const& other) -> void
+        {
+            // the blocks are merged in order, a tie keeps the first individual
+            if (other.Values[0].Count > 0 && (Values[0].Count == 0 || other.BestFitness < BestFitness)) {
+                Best = other.Best;
+                BestFitness = other.BestFitness;
+            }
+            for (auto k = 0UL; k < Values.size(); ++k) { Values[k].Merge(other.Values[k]); }
+        }
+    };
+
+    auto Reduce(Operon::Span<Operon::Individual const> pop, std::size_t idx, std::size_t begin, std::size_t end) -> Accumulator
+    {
+        Accumulator acc;
+        for (auto i = begin; i < end; ++i) {
+            auto const& ind = pop[i];
+            auto const f = ind[idx];
+            if (acc.Values[0].Count == 0 || f < acc.BestFitness) {
+                acc.Best = i;
+                acc.BestFitness = f;
+            }
+            acc.Values[0](f);
+            acc.Values[1](static_cast<double>(ind.Genotype.Length()));
+            acc.Values[2](static_cast<double>(ind.Genotype.Depth()));
+            acc.Values[3](static_cast<double>(ind.Genotype.VisitationLength()));
+        }
+        return acc;
+    }
+
+    auto Finish(std::vector<Accumulator> const& blocks) -> PopulationStatistics
+    {
+        Accumulator acc;
+        for (auto const& block : blocks) { acc.Merge(block); }
+        return { acc.Best, acc.Values[0].Summary(), acc.Values[1].Summary(), acc.Values[2].Summary(), acc.Values[3].Summary() };
+    }
+
+    auto BlockCount(std::size_t n) { return (n + BlockSize - 1) / BlockSize; }
+} // namespace
+
+auto ComputePopulationStatistics(Operon::Span<Operon::Individual const> pop, std::size_t idx) -> PopulationStatistics
+{
+    std::vector<Accumulator> blocks(BlockCount(pop.size()));
+    for (auto b = 0UL; b < blocks.size(); ++b) {
+        blocks[b] = Reduce(pop, idx, b * BlockSize, std::min((b + 1) * BlockSize, pop.size()));
+    }
+    return Finish(blocks);
+}
+
+auto ComputePopulationStatistics(Operon::Span<Operon::Individual const> pop, std::size_t idx, tf::Executor& executor) -> PopulationStatistics
+{
+    std::vector<Accumulator> blocks(BlockCount(pop.size()));
+    if (blocks.size() < 2) { return ComputePopulationStatistics(pop, idx); }
+
+    tf::Taskflow taskflow;
+    taskflow.for_each_index(std::size_t{0}, blocks.size(), std::size_t{1}, [&](auto b) {
+        blocks[b] = Reduce(pop, idx, b * BlockSize, std::min((b + 1) * BlockSize, pop.size()));
+    });
+    RunTaskflow(executor, taskflow);
+    return Finish(blocks);
+}
+
+} // namespace Operon
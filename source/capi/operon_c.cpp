@@ -0,0 +1,214 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include "operon/capi/operon_c.h"
+
+#include <algorithm>
+#include <bit>
+#include <exception>
+#include <fmt/core.h>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "operon/core/dataset.hpp"
+#include "operon/core/node.hpp"
+#include "operon/core/tree.hpp"
+#include "operon/hash/hash.hpp"
+#include "operon/interpreter/dispatch_table.hpp"
+#include "operon/interpreter/interpreter.hpp"
+
+static_assert(sizeof(operon_scalar) == sizeof(Operon::Scalar));
+static_assert(static_cast<uint32_t>(OPERON_NODE_ADD) == static_cast<uint32_t>(Operon::NodeType::Add));
+static_assert(static_cast<uint32_t>(OPERON_NODE_AQ) == static_cast<uint32_t>(Operon::NodeType::Aq));
+static_assert(static_cast<uint32_t>(OPERON_NODE_SQUARE) == static_cast<uint32_t>(Operon::NodeType::Square));
+static_assert(static_cast<uint32_t>(OPERON_NODE_CONSTANT) == static_cast<uint32_t>(Operon::NodeType::Constant));
+static_assert(static_cast<uint32_t>(OPERON_NODE_VARIABLE) == static_cast<uint32_t>(Operon::NodeType::Variable));
+
+struct operon_dataset {
+    Operon::Dataset Dataset;
+};
+
+struct operon_tree {
+    Operon::Tree Tree;
+    int64_t Columns; // one past the largest column read by the tree
+};
+
+namespace {
+    thread_local std::string lastError; // NOLINT
+
+    auto Fail(operon_status status, std::string message) -> operon_status
+    {
+        lastError = std::move(message);
+        return status;
+    }
+
+    // no exception may cross the c interface
+    template<typename F>
+    auto Guard(F&& f) noexcept -> operon_status
+    {
+        try {
+            lastError.clear();
+            return std::forward<F>(f)();
+        } catch (std::bad_alloc const&) {
+            return Fail(OPERON_ERROR, "out of memory");
+        } catch (std::exception const& ex) {
+            return Fail(OPERON_ERROR, ex.what());
+        } catch (...) {
+            return Fail(OPERON_ERROR, "unknown error");
+        }
+    }
+
+    // the datasets created by operon_dataset_create name their columns X1, X2, ... (the default names of a view)
+    auto ColumnHash(int64_t column) -> Operon::Hash
+    {
+        return Operon::Hasher{}(fmt::format("X{}", column + 1));
+    }
+
+    // the number of children a symbol accepts: {min, max}
+    auto ArityBounds(Operon::NodeType type) -> std::pair<uint16_t, uint16_t>
+    {
+        using Operon::NodeType;
+        // fmin and fmax sit with the n-ary symbols but their derivatives only handle two arguments
+        if (type < NodeType::Fmin) { return { 1, std::numeric_limits<uint16_t>::max() }; }
+        if (type < NodeType::Abs) { return { 2, 2 }; }
+        if (type < NodeType::Dynamic) { return { 1, 1 }; }
+        return { 0, 0 };
+    }
+
+    auto Evaluate(operon_tree const* tree, operon_dataset const* dataset, size_t begin, size_t end, operon_scalar const* coefficients, operon_scalar* result) -> operon_status
+    {
+        if (tree == nullptr || dataset == nullptr || result == nullptr) {
+            return Fail(OPERON_INVALID_ARGUMENT, "the tree, the dataset and the result must not be null");
+        }
+        auto const& ds = dataset->Dataset;
+        if (begin > end || end > ds.Rows<size_t>()) {
+            return Fail(OPERON_INVALID_ARGUMENT, fmt::format("the rows [{}, {}) are not in the dataset ({} rows)", begin, end, ds.Rows()));
+        }
+        if (tree->Columns > ds.Cols()) {
+            return Fail(OPERON_INVALID_ARGUMENT, fmt::format("the tree reads column {} but the dataset has {} columns", tree->Columns - 1, ds.Cols()));
+        }
+        if (begin == end) { return OPERON_OK; }
+
+        auto const& t = tree->Tree;
+        std::vector<Operon::Scalar> coeff;
+        Operon::Span<Operon::Scalar const> c;
+        if (coefficients != nullptr) {
+            c = { coefficients, t.CoefficientsCount() };
+        } else {
+            coeff = t.GetCoefficients();
+            c = coeff;
+        }
+        Operon::Range const range{ begin, end };
+        Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch> interpreter{ Operon::SharedDispatchTable(), ds, t };
+        interpreter.Evaluate(c, range, { result, range.Size() });
+        return OPERON_OK;
+    }
+} // namespace
+
+extern "C" {
+
+auto operon_scalar_size() -> size_t { return sizeof(Operon::Scalar); }
+
+auto operon_last_error() -> char const* { return lastError.c_str(); }
+
+auto operon_dataset_create(operon_scalar const* data, size_t rows, size_t cols, operon_dataset** dataset) -> operon_status
+{
+    return Guard([&]() {
+        if (data == nullptr || dataset == nullptr || rows == 0 || cols == 0) {
+            return Fail(OPERON_INVALID_ARGUMENT, "the data and the dataset must not be null and the dimensions must be positive");
+        }
+        *dataset = new operon_dataset{ Operon::Dataset(data, static_cast<Eigen::Index>(rows), static_cast<Eigen::Index>(cols)) };
+        return OPERON_OK;
+    });
+}
+
+auto operon_dataset_destroy(operon_dataset* dataset) -> void { delete dataset; }
+
+auto operon_tree_create(size_t length, uint32_t const* types, uint16_t const* arities, operon_scalar const* values, int64_t const* columns, operon_tree** tree) -> operon_status
+{
+    return Guard([&]() {
+        if (types == nullptr || tree == nullptr || length == 0) {
+            return Fail(OPERON_INVALID_ARGUMENT, "the types and the tree must not be null and the length must be positive");
+        }
+        if (length > std::numeric_limits<uint16_t>::max()) {
+            return Fail(OPERON_INVALID_TREE, fmt::format("the tree has {} nodes, at most {} are supported", length, std::numeric_limits<uint16_t>::max()));
+        }
+
+        Operon::Vector<Operon::Node> nodes;
+        nodes.reserve(length);
+        int64_t maxColumns{0};
+        size_t stack{0}; // the number of subtrees waiting for their parent
+        for (auto i = 0UL; i < length; ++i) {
+            auto const type = static_cast<Operon::NodeType>(types[i]);
+            if (std::popcount(types[i]) != 1 || type > Operon::NodeType::Variable || type == Operon::NodeType::Dynamic) {
+                return Fail(OPERON_INVALID_TREE, fmt::format("node {} has an unknown type {}", i, types[i]));
+            }
+
+            Operon::Node node{type};
+            if (node.IsVariable()) {
+                if (columns == nullptr || columns[i] < 0) {
+                    return Fail(OPERON_INVALID_TREE, fmt::format("variable node {} has no column", i));
+                }
+                node.HashValue = node.CalculatedHashValue = ColumnHash(columns[i]);
+                maxColumns = std::max(maxColumns, columns[i] + 1);
+            }
+            if (arities != nullptr) {
+                auto const [lo, hi] = ArityBounds(type);
+                if (arities[i] < lo || arities[i] > hi) {
+                    return Fail(OPERON_INVALID_TREE, fmt::format("node {} ({}) cannot have {} children", i, node.Name(), arities[i]));
+                }
+                node.Arity = arities[i];
+            }
+            if (values != nullptr) { node.Value = values[i]; }
+
+            if (stack < node.Arity) {
+                return Fail(OPERON_INVALID_TREE, fmt::format("node {} ({}) has {} children but only {} subtrees precede it", i, node.Name(), node.Arity, stack));
+            }
+            stack = stack - node.Arity + 1;
+            nodes.push_back(node);
+        }
+        if (stack != 1) {
+            return Fail(OPERON_INVALID_TREE, fmt::format("the nodes form {} trees instead of one", stack));
+        }
+
+        Operon::Tree t{ std::move(nodes) };
+        t.UpdateNodes();
+        *tree = new operon_tree{ std::move(t), maxColumns };
+        return OPERON_OK;
+    });
+}
+
+auto operon_tree_destroy(operon_tree* tree) -> void { delete tree; }
+
+auto operon_tree_coefficient_count(operon_tree const* tree) -> size_t
+{
+    return tree == nullptr ? 0 : tree->Tree.CoefficientsCount();
+}
+
+auto operon_evaluate(operon_tree const* tree, operon_dataset const* dataset, size_t begin, size_t end, operon_scalar const* coefficients, operon_scalar* result) -> operon_status
+{
+    return Guard([&]() { return Evaluate(tree, dataset, begin, end, coefficients, result); });
+}
+
+auto operon_evaluate_batch(operon_tree const* const* trees, size_t count, operon_dataset const* dataset, size_t begin, size_t end, operon_scalar* result) -> operon_status
+{
+    return Guard([&]() {
+        if (trees == nullptr && count > 0) {
+            return Fail(OPERON_INVALID_ARGUMENT, "the trees must not be null");
+        }
+        if (begin > end) {
+            return Fail(OPERON_INVALID_ARGUMENT, fmt::format("the rows [{}, {}) are not a range", begin, end));
+        }
+        for (auto i = 0UL; i < count; ++i) {
+            auto const status = Evaluate(trees[i], dataset, begin, end, /*coefficients=*/nullptr, result == nullptr ? nullptr : result + (i * (end - begin)));
+            if (status != OPERON_OK) { return status; }
+        }
+        return OPERON_OK;
+    });
+}
+
+} // extern "C"
@@ -0,0 +1,156 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <string>
+#include <taskflow/taskflow.hpp>
+#include <thread>
+#include <utility>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "operon/core/affinity.hpp"
+
+namespace Operon {
+
+namespace {
+    // parses a linux cpu list, eg. 0-3,8,10-11
+    auto ParseCpuList(std::string const& str) -> std::vector<int>
+    {
+        std::vector<int> cpus;
+        std::size_t pos{0};
+        while (pos < str.size()) {
+            auto const end = std::min(str.find(',', pos), str.size());
+            auto const token = str.substr(pos, end - pos);
+            pos = end + 1;
+            if (token.empty() || token == "\n") { continue; }
+            auto const dash = token.find('-');
+            auto const first = std::stoi(token.substr(0, dash));
+            auto const last = dash == std::string::npos ? first : std::stoi(token.substr(dash + 1));
+            for (auto c = first; c <= last; ++c) { cpus.push_back(c); }
+        }
+        return cpus;
+    }
+
+    // pins each worker when it starts, before it runs any task
+    class PinnedWorkers final : public tf::WorkerInterface {
+    public:
+        explicit PinnedWorkers(std::vector<int> cores)
+            : cores_(std::move(cores))
+        {
+        }
+
+        auto scheduler_prologue(tf::Worker& worker) -> void override // NOLINT(readability-identifier-naming)
+        {
+            (void)PinThread({ &cores_[worker.id() % cores_.size()], 1 });
+        }
+
+        auto scheduler_epilogue(tf::Worker& /*worker*/, std::exception_ptr /*error*/) -> void override {} // NOLINT(readability-identifier-naming)
+
+    private:
+        std::vector<int> cores_;
+    };
+} // namespace
+
+auto CoreTopology() -> std::vector<std::vector<int>>
+{
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (::sched_getaffinity(0, sizeof(set), &set) != 0) { return {}; }
+    auto allowed = [&](int c) { return c >= 0 && c < CPU_SETSIZE && CPU_ISSET(c, &set); }; // NOLINT
+
+    std::vector<std::vector<int>> nodes;
+    std::error_code ec;
+    std::filesystem::path const root{"/sys/devices/system/node"};
+    // the nodes are listed in the order of their index
+    std::vector<std::pair<int, std::filesystem::path>> entries;
+    for (auto const& entry : std::filesystem::directory_iterator(root, ec)) {
+        auto const name = entry.path().filename().string();
+        if (name.rfind("node", 0) != 0 || name.size() == 4 || !std::all_of(name.begin() + 4, name.end(), [](unsigned char c) { return std::isdigit(c) != 0; })) { continue; }
+        entries.emplace_back(std::stoi(name.substr(4)), entry.path() / "cpulist");
+    }
+    std::ranges::sort(entries, std::less{}, &std::pair<int, std::filesystem::path>::first);
+    for (auto const& [index, path] : entries) {
+        std::ifstream in(path);
+        std::string list;
+        std::getline(in, list);
+        std::vector<int> cores;
+        std::ranges::copy_if(ParseCpuList(list), std::back_inserter(cores), allowed);
+        if (!cores.empty()) { nodes.push_back(std::move(cores)); }
+    }
+
+    if (nodes.empty()) {
+        std::vector<int> cores;
+        for (auto c = 0; c < CPU_SETSIZE; ++c) {
+            if (allowed(c)) { cores.push_back(c); }
+        }
+        nodes.push_back(std::move(cores));
+    }
+    return nodes;
+#else
+    return {};
+#endif
+}
+
+auto AssignCores(AffinityPolicy policy, std::size_t workers, std::vector<std::vector<int>> const& topology) -> std::vector<int>
+{
+    std::vector<int> order;
+    if (policy == AffinityPolicy::Compact) {
+        for (auto const& node : topology) { order.insert(order.end(), node.begin(), node.end()); }
+    } else if (policy == AffinityPolicy::Scatter) {
+        // the j-th core of every node, then the (j+1)-th
+        auto const total = std::transform_reduce(topology.begin(), topology.end(), 0UL, std::plus{}, [](auto const& node) { return node.size(); });
+        for (auto j = 0UL; order.size() < total; ++j) {
+            for (auto const& node : topology) {
+                if (j < node.size()) { order.push_back(node[j]); }
+            }
+        }
+    }
+    if (order.empty()) { return {}; }
+
+    std::vector<int> cores(workers);
+    for (auto i = 0UL; i < workers; ++i) { cores[i] = order[i % order.size()]; }
+    return cores;
+}
+
+auto PinThread(Operon::Span<int const> cores) -> bool
+{
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto c : cores) {
+        if (c >= 0 && c < CPU_SETSIZE) { CPU_SET(c, &set); } // NOLINT
+    }
+    return !cores.empty() && ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cores;
+    return false;
+#endif
+}
+
+auto MakeExecutor(std::size_t threads, std::vector<int> cores) -> std::unique_ptr<tf::Executor>
+{
+    if (threads == 0) { threads = std::thread::hardware_concurrency(); }
+    if (cores.empty()) { return std::make_unique<tf::Executor>(threads); }
+    return std::make_unique<tf::Executor>(threads, std::make_shared<PinnedWorkers>(std::move(cores)));
+}
+
+auto MakeExecutor(std::size_t threads, AffinityPolicy policy) -> std::unique_ptr<tf::Executor>
+{
+    if (threads == 0) { threads = std::thread::hardware_concurrency(); }
+    if (policy == AffinityPolicy::None) { return MakeExecutor(threads, std::vector<int>{}); }
+    return MakeExecutor(threads, AssignCores(policy, threads, CoreTopology()));
+}
+
+} // namespace Operon
@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <algorithm>
+#include <iterator>
+
+#include "operon/core/compact_tree.hpp"
+#include "operon/core/contracts.hpp"
+
+namespace Operon {
+
+CompactTree::CompactTree(Tree const& tree)
+{
+    nodes_.reserve(tree.Length());
+    std::ranges::transform(tree.Nodes(), std::back_inserter(nodes_), [](auto const& n) { return CompactNode{n}; });
+}
+
+auto CompactTree::ToTree() const -> Tree
+{
+    Operon::Vector<Node> nodes;
+    nodes.reserve(nodes_.size());
+    std::ranges::transform(nodes_, std::back_inserter(nodes), [](auto const& n) { return n.ToNode(); });
+    auto tree = Tree(std::move(nodes));
+    if (!tree.Empty()) { tree.UpdateNodes(); }
+    return tree;
+}
+
+auto CompactTree::SubtreeLength(std::size_t i) const noexcept -> std::size_t
+{
+    EXPECT(i < nodes_.size());
+    // walk left until all the operands of node i have been consumed
+    auto k = i;
+    auto pending = static_cast<std::size_t>(nodes_[i].Arity);
+    while (pending > 0) {
+        --k;
+        pending += nodes_[k].Arity;
+        --pending;
+    }
+    return i - k;
+}
+
+auto CompactTree::Cross(CompactTree const& lhs, CompactTree const& rhs, std::size_t i, std::size_t j) -> CompactTree
+{
+    auto const& left = lhs.nodes_;
+    auto const& right = rhs.nodes_;
+    auto const li = lhs.SubtreeLength(i);
+    auto const rj = rhs.SubtreeLength(j);
+    using signed_t = std::make_signed_t<std::size_t>; // NOLINT
+
+    Operon::Vector<CompactNode> nodes;
+    nodes.reserve(left.size() - li + rj);
+    std::copy_n(left.begin(), i - li, std::back_inserter(nodes));
+    std::copy_n(right.begin() + static_cast<signed_t>(j - rj), rj + 1, std::back_inserter(nodes));
+    std::copy_n(left.begin() + static_cast<signed_t>(i) + 1, left.size() - (i + 1), std::back_inserter(nodes));
+    return CompactTree{std::move(nodes)};
+}
+
+} // namespace Operon
@@ -0,0 +1,197 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+#include <Eigen/Dense>
+#include <fmt/core.h>
+#include <vstat/vstat.hpp>
+
+#include "operon/core/coreset.hpp"
+#include "operon/random/random.hpp"
+
+namespace Operon {
+
+namespace {
+    // the inputs of the training rows in blocks of rows, centered and scaled to unit variance (the constant inputs are
+    // zero), f(offset, block) is called with the (rows x inputs) block of the rows that start at offset
+    // - only one block is stored at a time, the dataset may be much larger than the memory of a copy in double precision
+    template<typename F>
+    auto ForEachStandardizedBlock(Problem const& problem, F&& f) -> void
+    {
+        constexpr auto blockRows{4096L};
+        auto const range = problem.TrainingRange();
+        auto const& inputs = problem.GetInputs();
+        std::vector<Operon::Span<Operon::Scalar const>> columns;
+        std::vector<double> means;
+        std::vector<double> scales;
+        for (auto h : inputs) {
+            auto values = problem.GetDataset().GetValues(h).subspan(range.Start(), range.Size());
+            auto const stats = vstat::univariate::accumulate<Operon::Scalar>(values.begin(), values.end());
+            auto const s = std::sqrt(stats.variance);
+            columns.push_back(values);
+            means.push_back(stats.mean);
+            scales.push_back(s > 0 ? 1 / s : 0);
+        }
+
+        auto const n = static_cast<Eigen::Index>(range.Size());
+        Eigen::MatrixXd block(std::min(n, blockRows), std::ssize(inputs));
+        for (auto offset = 0L; offset < n; offset += blockRows) {
+            auto const m = std::min(blockRows, n - offset);
+            for (auto j = 0L; j < block.cols(); ++j) {
+                auto values = Eigen::Map<Eigen::Matrix<Operon::Scalar, -1, 1> const>(columns[j].data() + offset, m);
+                block.col(j).head(m) = (values.cast<double>().array() - means[j]) * scales[j];
+            }
+            f(offset, block.topRows(m));
+        }
+    }
+
+    // draws size rows with replacement with the given (unnormalized) scores, mixed half and half with the uniform
+    // distribution, a row drawn c times has the weight c / (size * q)
+    auto ImportanceSample(Problem const& problem, Eigen::Ref<Eigen::ArrayXd const> scores, std::size_t size, Operon::RandomGenerator& random) -> Coreset
+    {
+        auto const n = static_cast<double>(scores.size());
+        auto const total = scores.sum();
+        auto probability = [&](auto i) {
+            return total > 0 ? (0.5 / n) + (0.5 * scores(i) / total) : 1 / n;
+        };
+
+        // sorted uniform variates, the rows are visited once in order
+        std::vector<double> u(size);
+        std::uniform_real_distribution<double> dist(0, 1);
+        std::ranges::generate(u, [&]() { return dist(random); });
+        std::ranges::sort(u);
+
+        Coreset coreset;
+        auto const start = problem.TrainingRange().Start();
+        auto cumulative{0.0};
+        auto k{0UL};
+        for (auto i = 0L; i < scores.size() && k < size; ++i) {
+            auto const q = probability(i);
+            cumulative += q;
+            auto c{0UL};
+            // the last row takes the variates beyond the rounded total
+            while (k < size && (u[k] < cumulative || i + 1 == scores.size())) { ++c; ++k; }
+            if (c == 0) { continue; }
+            coreset.Rows.push_back(start + static_cast<std::size_t>(i));
+            coreset.Weights.push_back(static_cast<Operon::Scalar>(static_cast<double>(c) / (static_cast<double>(size) * q)));
+        }
+        return coreset;
+    }
+
+    auto Stratified(Problem const& problem, std::size_t size, Operon::RandomGenerator& random) -> Coreset
+    {
+        auto const range = problem.TrainingRange();
+        auto const target = problem.TargetValues(range);
+        std::vector<std::size_t> order(range.Size());
+        std::iota(order.begin(), order.end(), 0UL);
+        std::ranges::stable_sort(order, [&](auto a, auto b) { return target[a] < target[b]; });
+
+        Coreset coreset;
+        auto const n = range.Size();
+        for (auto i = 0UL; i < size; ++i) {
+            auto const first = i * n / size;
+            auto const last = (i + 1) * n / size;
+            coreset.Rows.push_back(range.Start() + order[Operon::Random::Uniform(random, first, last - 1)]);
+        }
+
+        // the strata are sorted by the target, the rows are sorted to read the dataset in order
+        std::vector<std::size_t> index(size);
+        std::iota(index.begin(), index.end(), 0UL);
+        std::ranges::sort(index, [&](auto a, auto b) { return coreset.Rows[a] < coreset.Rows[b]; });
+        std::vector<std::size_t> rows(size);
+        coreset.Weights.resize(size);
+        for (auto i = 0UL; i < size; ++i) {
+            auto const s = index[i];
+            rows[i] = coreset.Rows[s];
+            coreset.Weights[i] = static_cast<Operon::Scalar>(((s + 1) * n / size) - (s * n / size));
+        }
+        coreset.Rows = std::move(rows);
+        return coreset;
+    }
+
+    auto KMeans(Problem const& problem, std::size_t size, Operon::RandomGenerator& random) -> Coreset
+    {
+        // the inputs are centered, the squared distance to the mean is the squared norm of the row
+        Eigen::ArrayXd d2(static_cast<Eigen::Index>(problem.TrainingRange().Size()));
+        ForEachStandardizedBlock(problem, [&](auto offset, auto const& block) {
+            d2.segment(offset, block.rows()) = block.rowwise().squaredNorm().array();
+        });
+        return ImportanceSample(problem, d2, size, random);
+    }
+
+    auto Leverage(Problem const& problem, std::size_t size, Operon::RandomGenerator& random) -> Coreset
+    {
+        // h(x) = x^T (X^T X)^+ x with the intercept column, the pseudo-inverse accounts for the constant (zero) columns
+        // - the inputs are centered, the intercept is orthogonal to them and its leverage is 1/n
+        auto const n = static_cast<Eigen::Index>(problem.TrainingRange().Size());
+        auto const d = std::ssize(problem.GetInputs());
+        Eigen::MatrixXd gram = Eigen::MatrixXd::Zero(d, d);
+        ForEachStandardizedBlock(problem, [&](auto /*offset*/, auto const& block) {
+            gram.selfadjointView<Eigen::Lower>().rankUpdate(block.transpose());
+        });
+        Eigen::MatrixXd const inverse = Eigen::MatrixXd(gram.selfadjointView<Eigen::Lower>()).completeOrthogonalDecomposition().pseudoInverse();
+
+        Eigen::ArrayXd h(n);
+        ForEachStandardizedBlock(problem, [&](auto offset, auto const& block) {
+            h.segment(offset, block.rows()) = ((block * inverse).array() * block.array()).rowwise().sum() + (1.0 / static_cast<double>(n));
+        });
+        return ImportanceSample(problem, h.cwiseMax(0), size, random);
+    }
+} // namespace
+
+auto SelectCoreset(Problem const& problem, std::size_t size, CoresetMethod method, Operon::RandomGenerator& random) -> Coreset
+{
+    if (size == 0) { throw std::invalid_argument("the coreset must have at least one row"); }
+    auto const range = problem.TrainingRange();
+    if (range.Size() <= size) {
+        Coreset coreset;
+        coreset.Rows.resize(range.Size());
+        std::iota(coreset.Rows.begin(), coreset.Rows.end(), range.Start());
+        coreset.Weights.assign(range.Size(), Operon::Scalar{1});
+        return coreset;
+    }
+
+    switch (method) {
+    case CoresetMethod::Stratified:
+        return Stratified(problem, size, random);
+    case CoresetMethod::KMeans:
+        return KMeans(problem, size, random);
+    case CoresetMethod::Leverage:
+        return Leverage(problem, size, random);
+    }
+    throw std::invalid_argument("unknown coreset method");
+}
+
+auto ReduceProblem(Problem const& problem, Coreset const& coreset, std::string const& weightName) -> Problem
+{
+    if (coreset.Rows.size() != coreset.Weights.size()) {
+        throw std::invalid_argument(fmt::format("the coreset has {} rows but {} weights", coreset.Rows.size(), coreset.Weights.size()));
+    }
+
+    auto rows = coreset.Rows;
+    std::vector<Operon::Scalar> weights = coreset.Weights;
+    auto append = [&](Range range) {
+        auto const start = rows.size();
+        for (auto i = range.Start(); i < range.End(); ++i) { rows.push_back(i); }
+        weights.resize(rows.size(), Operon::Scalar{1});
+        return Range{start, rows.size()};
+    };
+    auto const training = Range{0, coreset.Rows.size()};
+    auto const test = append(problem.TestRange());
+    auto const validation = append(problem.ValidationRange());
+
+    auto ds = problem.GetDataset().SelectRows(rows);
+    (void) ds.AddVariable(weightName, weights);
+
+    Problem reduced{std::move(ds), training, test, validation};
+    reduced.SetTarget(problem.TargetVariable().Hash);
+    reduced.SetInputs(problem.GetInputs());
+    reduced.GetPrimitiveSet() = problem.GetPrimitiveSet();
+    return reduced;
+}
+
+} // namespace Operon
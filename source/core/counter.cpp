@@ -0,0 +1,25 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include "operon/core/counter.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <thread>
+
+namespace Operon {
+
+auto ThreadIndex() noexcept -> std::size_t
+{
+    static std::atomic<std::size_t> next{0};
+    thread_local std::size_t const index{next.fetch_add(1, std::memory_order_relaxed)};
+    return index;
+}
+
+auto ShardCount() noexcept -> std::size_t
+{
+    static std::size_t const count{std::bit_ceil(std::max(std::size_t{std::thread::hardware_concurrency()}, std::size_t{1}))};
+    return count;
+}
+
+} // namespace Operon
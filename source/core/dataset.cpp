@@ -3,11 +3,41 @@
 
 #include <vstat/vstat.hpp>
 #include <parser.hpp>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <exception>
 #include <fast_float/fast_float.h>
 #include <fmt/format.h>
+#include <fstream>
+#include <numeric>
+#include <string_view>
+#include <taskflow/taskflow.hpp>
+#include <taskflow/algorithm/for_each.hpp>
+#include <thread>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define OPERON_HAVE_MMAP
+#endif
+
+#if defined(HAVE_ARROW)
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/reader.h>
+#include <parquet/arrow/reader.h>
+#endif
 
 #include "operon/core/constants.hpp"
 #include "operon/core/dataset.hpp"
+#include "operon/core/dataset_codes.hpp"
+#include "operon/core/executor.hpp"
+#include "operon/core/memory.hpp"
 #include "operon/core/types.hpp"
 #include "operon/hash/hash.hpp"
 
@@ -43,8 +73,592 @@ namespace {
         }
         return m;
     }
+
+    // read-only contents of a file, memory-mapped when possible
+    struct MappedFile {
+        std::shared_ptr<void const> Storage;
+        uint8_t const* Data{nullptr};
+        std::size_t Size{0};
+        bool Mapped{false}; // false when the file was read into memory
+    };
+
+    auto MapFile(std::string const& path) -> MappedFile
+    {
+#if defined(OPERON_HAVE_MMAP)
+        auto fd = ::open(path.c_str(), O_RDONLY); // NOLINT
+        if (fd < 0) { throw std::runtime_error(fmt::format("cannot open {}: {}", path, std::strerror(errno))); } // NOLINT
+        struct stat st{};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error(fmt::format("cannot stat {}: {}", path, std::strerror(errno))); // NOLINT
+        }
+        auto const size = static_cast<std::size_t>(st.st_size);
+        void* addr = size == 0 ? nullptr : ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // the mapping stays valid after closing the file
+        if (addr == MAP_FAILED) { // NOLINT
+            throw std::runtime_error(fmt::format("cannot map {}: {}", path, std::strerror(errno))); // NOLINT
+        }
+        std::shared_ptr<void const> storage(addr, [size](void const* p) { if (p != nullptr) { ::munmap(const_cast<void*>(p), size); } }); // NOLINT
+        return { storage, static_cast<uint8_t const*>(addr), size, /*mapped=*/true };
+#else
+        // no memory mapping on this platform, read the whole file
+        std::ifstream f(path, std::ios::binary | std::ios::ate);
+        if (!f) { throw std::runtime_error(fmt::format("cannot open {}", path)); }
+        auto const size = static_cast<std::size_t>(f.tellg());
+        auto buffer = std::shared_ptr<uint8_t[]>(new uint8_t[size]); // NOLINT
+        f.seekg(0);
+        f.read(reinterpret_cast<char*>(buffer.get()), static_cast<std::streamsize>(size)); // NOLINT
+        return { buffer, buffer.get(), size, /*mapped=*/false };
+#endif
+    }
+
+#if defined(OPERON_HAVE_MMAP)
+    // applies the advice to the pages holding the given rows of each column
+    // - the pages are rounded outwards (eg. for prefetching) or inwards (eg. for evicting, so that the rows
+    //   of neighbouring blocks sharing a page are not released)
+    auto AdviseRows(Dataset::Map const& map, Range rows, int advice, bool outwards) -> void
+    {
+        static auto const page = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+        for (auto c = 0L; c < map.cols(); ++c) {
+            auto const* col = map.col(c).data();
+            auto a = reinterpret_cast<std::uintptr_t>(col + rows.Start()); // NOLINT
+            auto b = reinterpret_cast<std::uintptr_t>(col + rows.End()); // NOLINT
+            a = outwards ? a / page * page : (a + page - 1) / page * page;
+            b = outwards ? (b + page - 1) / page * page : b / page * page;
+            if (a < b) { ::madvise(reinterpret_cast<void*>(a), b - a, advice); } // NOLINT (a hint, failures are ignored)
+        }
+    }
+#endif
+
+    namespace Binary {
+        constexpr std::array<char, 8> Magic { 'O', 'P', 'E', 'R', 'O', 'N', 'D', 'S' };
+        constexpr uint32_t Version { 1 };
+        constexpr uint64_t Alignment { 64 };
+
+        struct Header {
+            std::array<char, 8> Magic;
+            uint32_t Version;
+            uint32_t ScalarSize;
+            uint64_t Rows;
+            uint64_t Cols;
+            uint64_t DataOffset;
+        };
+        static_assert(sizeof(Header) == 40);
+
+        auto ReadHeader(MappedFile const& file, std::string const& path) -> Header
+        {
+            Header h{};
+            if (file.Size < sizeof(Header)) { throw std::runtime_error(fmt::format("{} is not a binary dataset", path)); }
+            std::memcpy(&h, file.Data, sizeof(Header));
+            if (h.Magic != Magic) { throw std::runtime_error(fmt::format("{} is not a binary dataset", path)); }
+            if (h.Version != Version) { throw std::runtime_error(fmt::format("{} has an unsupported version {}", path, h.Version)); }
+            if (h.ScalarSize != sizeof(float) && h.ScalarSize != sizeof(double)) {
+                throw std::runtime_error(fmt::format("{} has an unsupported scalar width {}", path, h.ScalarSize));
+            }
+            if (h.DataOffset % Alignment != 0 || file.Size < h.DataOffset || (file.Size - h.DataOffset) / h.ScalarSize / std::max(h.Cols, uint64_t{1}) < h.Rows) {
+                throw std::runtime_error(fmt::format("{} is truncated", path));
+            }
+            return h;
+        }
+    } // namespace Binary
+
+    namespace Csv {
+        constexpr std::size_t MinChunkSize { 1UL << 20UL }; // bytes
+
+        // the field without the surrounding whitespace and quotes
+        auto Trim(std::string_view field) -> std::string_view
+        {
+            auto const a = field.find_first_not_of(" \t\r\n");
+            if (a == std::string_view::npos) { return {}; }
+            field = field.substr(a, field.find_last_not_of(" \t\r\n") - a + 1);
+            if (field.size() > 1 && field.front() == '"' && field.back() == '"') {
+                field = field.substr(1, field.size() - 2);
+            }
+            return field;
+        }
+
+        // the beginning of the next line after p
+        auto NextLine(char const* p, char const* end) -> char const*
+        {
+            auto const* nl = static_cast<char const*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+            return nl == nullptr ? end : nl + 1;
+        }
+
+        // calls f(line) for each non-blank line in [begin, end)
+        template<typename F>
+        auto ForEachLine(char const* begin, char const* end, F&& f) -> void
+        {
+            for (auto const* p = begin; p < end;) {
+                auto const* next = NextLine(p, end);
+                std::string_view line(p, static_cast<std::size_t>(next - p));
+                if (!Trim(line).empty()) { f(line); }
+                p = next;
+            }
+        }
+
+        // calls f(index, field) for each comma-separated field of the line
+        template<typename F>
+        auto ForEachField(std::string_view line, F&& f) -> std::size_t
+        {
+            if (!line.empty() && line.back() == '\n') { line.remove_suffix(1); }
+            std::size_t i{0};
+            for (;;) {
+                auto const comma = line.find(',');
+                f(i++, Trim(line.substr(0, comma)));
+                if (comma == std::string_view::npos) { break; }
+                line.remove_prefix(comma + 1);
+            }
+            return i;
+        }
+
+        // runs f(i) for i in [0, n) on n threads, the first exception is rethrown
+        template<typename F>
+        auto Parallel(std::size_t n, F&& f) -> void
+        {
+            if (n == 1) { f(0UL); return; }
+            std::vector<std::exception_ptr> errors(n);
+            std::vector<std::thread> threads;
+            threads.reserve(n);
+            for (auto i = 0UL; i < n; ++i) {
+                threads.emplace_back([&, i]() {
+                    try { f(i); } catch (...) { errors[i] = std::current_exception(); }
+                });
+            }
+            for (auto& t : threads) { t.join(); }
+            for (auto const& e : errors) {
+                if (e) { std::rethrow_exception(e); }
+            }
+        }
+    } // namespace Csv
+
+    // the columns are normalized and standardized in blocks of this many rows (see ForEachBlock)
+    constexpr Eigen::Index BlockRows{1L << 16};
+
+    // runs f(k) for k in [0, n), one task per column
+    template<typename F>
+    auto ForEachColumn(tf::Executor& executor, std::size_t n, F&& f) -> void
+    {
+        tf::Taskflow taskflow;
+        taskflow.for_each_index(std::size_t{0}, n, std::size_t{1}, std::forward<F>(f));
+        RunTaskflow(executor, taskflow);
+    }
+
+    // runs f(k, segment) for the blocks of rows of the columns, one task per block
+    template<typename F>
+    auto ForEachBlock(tf::Executor& executor, Dataset::Matrix& values, Operon::Span<std::size_t const> columns, F&& f) -> void
+    {
+        auto const rows = values.rows();
+        auto const blocks = std::max(Eigen::Index{1}, (rows + BlockRows - 1) / BlockRows);
+        tf::Taskflow taskflow;
+        taskflow.for_each_index(Eigen::Index{0}, std::ssize(columns) * blocks, Eigen::Index{1}, [&](Eigen::Index t) {
+            auto const k = t / blocks;
+            auto const start = (t % blocks) * BlockRows;
+            f(static_cast<std::size_t>(k), values.col(static_cast<Eigen::Index>(columns[k])).segment(start, std::min(BlockRows, rows - start)));
+        });
+        RunTaskflow(executor, taskflow);
+    }
+
+    auto MinMax(auto const& column, Range range) -> std::pair<Operon::Scalar, Operon::Scalar>
+    {
+        auto seg = column.segment(static_cast<Eigen::Index>(range.Start()), static_cast<Eigen::Index>(range.Size()));
+        return { seg.minCoeff(), seg.maxCoeff() };
+    }
+
+    auto MeanStddev(auto const& column, Range range) -> std::pair<double, double>
+    {
+        auto seg = column.segment(static_cast<Eigen::Index>(range.Start()), static_cast<Eigen::Index>(range.Size()));
+        auto stats = vstat::univariate::accumulate<Dataset::Matrix::Scalar>(seg.begin(), seg.end());
+        return { stats.mean, std::sqrt(stats.variance) };
+    }
+
+    // the hash of the variable stored in column j
+    auto VariableAt(Dataset::Variables const& variables, Eigen::Index j) -> Operon::Hash
+    {
+        auto it = std::ranges::find_if(variables, [&](auto const& p) { return p.second.Index == j; });
+        EXPECT(it != variables.end());
+        return it->first;
+    }
 } // namespace
 
+auto Dataset::IsBinary(std::string const& path) -> bool
+{
+    std::ifstream f(path, std::ios::binary);
+    std::array<char, Binary::Magic.size()> magic{};
+    f.read(magic.data(), magic.size());
+    return f.gcount() == std::ssize(magic) && magic == Binary::Magic;
+}
+
+auto Dataset::ReadBinary(std::string const& path, std::vector<std::string> const& columns) -> Dataset
+{
+    auto file = MapFile(path);
+    auto const header = Binary::ReadHeader(file, path);
+    auto const rows = static_cast<Eigen::Index>(header.Rows);
+    auto const cols = static_cast<Eigen::Index>(header.Cols);
+
+    // the variables are stored in column order
+    Hasher hasher;
+    std::vector<std::string> names;
+    std::size_t offset{sizeof(Binary::Header)};
+    for (auto i = 0L; i < cols; ++i) {
+        uint64_t hash{0};
+        uint64_t length{0};
+        if (offset + 2 * sizeof(uint64_t) > header.DataOffset) { throw std::runtime_error(fmt::format("{} has a corrupted header", path)); }
+        std::memcpy(&hash, file.Data + offset, sizeof(hash)); // NOLINT
+        std::memcpy(&length, file.Data + offset + sizeof(hash), sizeof(length)); // NOLINT
+        offset += 2 * sizeof(uint64_t);
+        if (offset + length > header.DataOffset) { throw std::runtime_error(fmt::format("{} has a corrupted header", path)); }
+        std::string name(reinterpret_cast<char const*>(file.Data + offset), length); // NOLINT
+        offset += length;
+        if (hasher(name) != hash) {
+            throw std::runtime_error(fmt::format("{}: the hash of variable {} does not match (the file was written with a different hash function)", path, name));
+        }
+        names.push_back(std::move(name));
+    }
+
+    auto const* data = file.Data + header.DataOffset; // NOLINT
+    if (columns.empty() && header.ScalarSize == sizeof(Operon::Scalar)) {
+        Dataset ds(reinterpret_cast<Operon::Scalar const*>(data), rows, cols); // NOLINT
+        ds.variables_ = VariablesFromNames(names);
+        ds.storage_ = std::move(file.Storage);
+        ds.mapped_ = file.Mapped;
+        return ds;
+    }
+
+    // projection or different precision: copy the selected columns into a dataset that owns its data
+    for (auto const& c : columns) {
+        if (std::ranges::find(names, c) == names.end()) { throw std::runtime_error(fmt::format("variable {} does not exist in {}", c, path)); }
+    }
+    std::vector<Eigen::Index> indices;
+    std::vector<std::string> selected;
+    for (auto i = 0L; i < cols; ++i) {
+        if (columns.empty() || std::ranges::find(columns, names[i]) != columns.end()) {
+            indices.push_back(i);
+            selected.push_back(names[i]);
+        }
+    }
+    Matrix values(rows, std::ssize(indices));
+    auto copy = [&]<typename T>(T /*unused*/) {
+        Eigen::Map<Eigen::Array<T, -1, -1> const> const m(reinterpret_cast<T const*>(data), rows, cols); // NOLINT
+        for (auto i = 0L; i < values.cols(); ++i) {
+            values.col(i) = m.col(indices[i]).template cast<Operon::Scalar>();
+        }
+    };
+    if (header.ScalarSize == sizeof(float)) { copy(float{}); } else { copy(double{}); }
+    Dataset ds(std::move(values));
+    ds.variables_ = VariablesFromNames(selected);
+    return ds;
+}
+
+auto Dataset::Prefetch(Range rows) const -> void
+{
+#if defined(OPERON_HAVE_MMAP)
+    if (mapped_ && rows.Size() > 0) { AdviseRows(map_, rows, MADV_WILLNEED, /*outwards=*/true); }
+#else
+    (void)rows;
+#endif
+}
+
+auto Dataset::Evict(Range rows) const -> void
+{
+#if defined(OPERON_HAVE_MMAP)
+    // the released pages of a file mapping are read again from the file, those of the heap would be zero-filled
+    if (mapped_ && rows.Size() > 0) { AdviseRows(map_, rows, MADV_DONTNEED, /*outwards=*/false); }
+#else
+    (void)rows;
+#endif
+}
+
+auto Dataset::AdviseHugePages() const -> bool
+{
+    return Operon::AdviseHugePages(map_.data(), static_cast<std::size_t>(map_.size()) * sizeof(Operon::Scalar));
+}
+
+auto Dataset::Select(Operon::Span<Operon::Hash const> hashes) const -> Dataset
+{
+    for (auto h : hashes) {
+        if (!GetVariable(h)) { throw std::runtime_error(fmt::format("the dataset does not contain a variable with hash {}", h)); }
+    }
+    std::vector<Variable> selected;
+    for (auto const& v : GetVariables()) {
+        if (std::ranges::find(hashes, v.Hash) != hashes.end()) { selected.push_back(v); }
+    }
+    Matrix values(map_.rows(), std::ssize(selected));
+    std::vector<std::string> names;
+    for (auto i = 0L; i < values.cols(); ++i) {
+        values.col(i) = map_.col(selected[i].Index);
+        names.push_back(selected[i].Name);
+    }
+    Dataset ds(std::move(values));
+    ds.variables_ = VariablesFromNames(names);
+    for (auto const& v : selected) { ds.SetTransform(v.Hash, v.Scale, v.Offset); }
+    return ds;
+}
+
+auto Dataset::Share() -> void
+{
+    if (IsView()) { return; }
+    auto values = std::make_shared<Matrix const>(std::move(values_));
+    values_ = Matrix{};
+    new (&map_) Map(values->data(), values->rows(), values->cols()); // we use placement new (no allocation)
+    storage_ = std::move(values);
+}
+
+auto Dataset::SelectRows(Operon::Span<std::size_t const> rows) const -> Dataset
+{
+    for (auto r : rows) {
+        if (r >= Rows<std::size_t>()) { throw std::runtime_error(fmt::format("row {} is out of range (the dataset has {} rows)", r, Rows())); }
+    }
+    Matrix values(std::ssize(rows), map_.cols());
+    for (auto i = 0L; i < values.rows(); ++i) {
+        values.row(i) = map_.row(static_cast<Eigen::Index>(rows[i]));
+    }
+    Dataset ds(std::move(values));
+    ds.variables_ = variables_;
+    return ds;
+}
+
+auto Dataset::AppendRows(Eigen::Ref<Matrix const> rows) -> void
+{
+    if (IsView()) { throw std::runtime_error("Cannot append rows. Dataset does not own the data.\n"); }
+    if (rows.cols() != values_.cols()) {
+        throw std::runtime_error(fmt::format("the rows have {} columns but the dataset has {}", rows.cols(), values_.cols()));
+    }
+    auto const n = values_.rows();
+    values_.conservativeResize(n + rows.rows(), Eigen::NoChange);
+    values_.bottomRows(rows.rows()) = rows;
+    new (&map_) Map(values_.data(), values_.rows(), values_.cols()); // we use placement new (no allocation)
+    codes_.reset();
+}
+
+auto Dataset::AddVariable(std::string const& name, Operon::Span<Operon::Scalar const> values) -> Variable
+{
+    if (IsView()) { throw std::runtime_error("Cannot add a variable. Dataset does not own the data.\n"); }
+    if (std::ssize(values) != values_.rows()) {
+        throw std::runtime_error(fmt::format("the variable has {} values but the dataset has {} rows", values.size(), values_.rows()));
+    }
+    auto const h = Hasher{}(name);
+    if (GetVariable(h)) { throw std::runtime_error(fmt::format("variable {} already exists", name)); }
+
+    auto const n = values_.cols();
+    values_.conservativeResize(Eigen::NoChange, n + 1);
+    values_.col(n) = Eigen::Map<Eigen::Matrix<Operon::Scalar, -1, 1> const>(values.data(), values_.rows());
+    new (&map_) Map(values_.data(), values_.rows(), values_.cols()); // we use placement new (no allocation)
+
+    Variable variable{name, h, n};
+    variables_.insert({h, variable});
+    return variable;
+}
+
+auto Dataset::Encode(std::size_t maxCardinality) -> std::size_t
+{
+    codes_.reset();
+    if (maxCardinality == 0) { return 0; }
+    auto codes = std::make_shared<DatasetCodes const>(*this, maxCardinality);
+    auto const n = codes->Size();
+    if (n > 0) { codes_ = std::move(codes); }
+    return n;
+}
+
+auto Dataset::WriteBinary(std::string const& path) const -> void
+{
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    if (!f) { throw std::runtime_error(fmt::format("cannot open {} for writing", path)); }
+
+    auto write = [&](auto const& value) { f.write(reinterpret_cast<char const*>(&value), sizeof(value)); }; // NOLINT
+
+    // the variables in column order
+    std::vector<Variable> variables(static_cast<std::size_t>(Cols()));
+    for (auto const& [hash, v] : variables_) { variables[static_cast<std::size_t>(v.Index)] = v; }
+
+    std::size_t offset{sizeof(Binary::Header)};
+    for (auto const& v : variables) { offset += 2 * sizeof(uint64_t) + v.Name.size(); }
+    auto const dataOffset = (offset + Binary::Alignment - 1) / Binary::Alignment * Binary::Alignment;
+
+    write(Binary::Header { Binary::Magic, Binary::Version, sizeof(Operon::Scalar), Rows<uint64_t>(), Cols<uint64_t>(), dataOffset });
+    for (auto const& v : variables) {
+        write(uint64_t{v.Hash});
+        write(uint64_t{v.Name.size()});
+        f.write(v.Name.data(), static_cast<std::streamsize>(v.Name.size()));
+    }
+    std::vector<char> const padding(dataOffset - offset, 0);
+    f.write(padding.data(), std::ssize(padding));
+    for (auto i = 0L; i < Cols(); ++i) {
+        f.write(reinterpret_cast<char const*>(map_.col(i).data()), static_cast<std::streamsize>(sizeof(Operon::Scalar) * Rows<std::size_t>())); // NOLINT
+    }
+    if (!f) { throw std::runtime_error(fmt::format("failed to write {}", path)); }
+}
+
+auto Dataset::LoadCsv(std::string const& path, CsvOptions const& options) -> Dataset
+{
+    auto const file = MapFile(path);
+    auto const* begin = reinterpret_cast<char const*>(file.Data); // NOLINT
+    auto const* end = begin + file.Size; // NOLINT
+
+    // the column names come from the header or default to X1, X2, ...
+    auto const* body = begin;
+    std::vector<std::string> names;
+    while (body < end && Csv::Trim({ body, static_cast<std::size_t>(Csv::NextLine(body, end) - body) }).empty()) {
+        body = Csv::NextLine(body, end);
+    }
+    std::string_view const first{ body, static_cast<std::size_t>(Csv::NextLine(body, end) - body) };
+    if (first.empty()) {
+        throw std::runtime_error(fmt::format("{} is empty", path));
+    }
+    auto const ncol = Csv::ForEachField(first, [&](auto i, auto field) {
+        names.push_back(options.HasHeader ? std::string(field) : fmt::format("X{}", i + 1));
+    });
+    if (options.HasHeader) { body = Csv::NextLine(body, end); }
+
+    // the output column of each file column (-1 if the column is not loaded)
+    std::vector<Eigen::Index> columns(ncol, options.Columns.empty() ? 0 : -1);
+    for (auto const& c : options.Columns) {
+        auto it = std::find(names.begin(), names.end(), c);
+        if (it == names.end()) {
+            throw std::runtime_error(fmt::format("variable {} does not exist in {}", c, path));
+        }
+        columns[std::distance(names.begin(), it)] = 0;
+    }
+    std::vector<std::string> selected;
+    for (auto i = 0UL; i < ncol; ++i) {
+        if (columns[i] < 0) { continue; }
+        columns[i] = std::ssize(selected);
+        selected.push_back(names[i]);
+    }
+
+    // split the body in chunks that start at the beginning of a line
+    auto const size = static_cast<std::size_t>(end - body);
+    auto threads = options.Threads == 0 ? std::thread::hardware_concurrency() : options.Threads;
+    auto const chunks = std::clamp(size / Csv::MinChunkSize, std::size_t{1}, std::max(std::size_t{threads}, std::size_t{1}));
+    std::vector<char const*> bounds(chunks + 1, end);
+    bounds[0] = body;
+    for (auto i = 1UL; i < chunks; ++i) {
+        auto const* p = body + i * size / chunks; // NOLINT
+        bounds[i] = p[-1] == '\n' ? p : Csv::NextLine(p, end); // NOLINT
+    }
+
+    // first pass: count the rows of each chunk to know where its rows go
+    std::vector<Eigen::Index> offsets(chunks + 1, 0);
+    Csv::Parallel(chunks, [&](auto i) {
+        Eigen::Index n{0};
+        Csv::ForEachLine(bounds[i], bounds[i + 1], [&](auto /*line*/) { ++n; });
+        offsets[i + 1] = n;
+    });
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    // second pass: parse the selected fields directly into the column-major matrix
+    Matrix values(offsets.back(), std::ssize(selected));
+    Operon::AdviseHugePages(values.data(), static_cast<std::size_t>(values.size()) * sizeof(Operon::Scalar)); // before the pages are touched
+    Csv::Parallel(chunks, [&](auto i) {
+        auto row = offsets[i];
+        Csv::ForEachLine(bounds[i], bounds[i + 1], [&](auto line) {
+            auto const n = Csv::ForEachField(line, [&](auto j, auto field) {
+                if (j >= ncol || columns[j] < 0) { return; }
+                Operon::Scalar v{0};
+                auto status = fast_float::from_chars(field.data(), field.data() + field.size(), v);
+                if (status.ec != std::errc() || status.ptr != field.data() + field.size()) {
+                    throw std::runtime_error(fmt::format("failed to parse field {} at row {}", j, row));
+                }
+                values(row, columns[j]) = v;
+            });
+            if (n != ncol) {
+                throw std::runtime_error(fmt::format("row {} has {} fields instead of {}", row, n, ncol));
+            }
+            ++row;
+        });
+    });
+
+    Dataset ds(std::move(values));
+    ds.variables_ = VariablesFromNames(selected);
+    if (options.Cardinality > 0) { ds.Encode(options.Cardinality); }
+    return ds;
+}
+
+#if defined(HAVE_ARROW)
+auto Dataset::IsArrow(std::string const& path) -> bool
+{
+    std::ifstream f(path, std::ios::binary);
+    std::array<char, 6> magic{};
+    f.read(magic.data(), magic.size());
+    std::string_view const m(magic.data(), static_cast<std::size_t>(f.gcount()));
+    return m.starts_with("PAR1") || m.starts_with("ARROW1");
+}
+
+auto Dataset::ReadArrow(std::string const& path, std::vector<std::string> const& columns) -> Dataset
+{
+    auto check = [&](arrow::Status const& status) {
+        if (!status.ok()) { throw std::runtime_error(fmt::format("{}: {}", path, status.ToString())); }
+    };
+    auto value = [&](auto&& result) {
+        check(result.status());
+        return std::move(result).ValueUnsafe();
+    };
+
+    // the indices of the selected fields, in file order
+    auto select = [&](arrow::Schema const& schema) {
+        std::vector<int> indices;
+        for (auto i = 0; i < schema.num_fields(); ++i) {
+            if (columns.empty() || std::ranges::find(columns, schema.field(i)->name()) != columns.end()) { indices.push_back(i); }
+        }
+        for (auto const& c : columns) {
+            if (schema.GetFieldIndex(c) < 0) { throw std::runtime_error(fmt::format("variable {} does not exist in {}", c, path)); }
+        }
+        return indices;
+    };
+
+    auto file = value(arrow::io::MemoryMappedFile::Open(path, arrow::io::FileMode::READ));
+    auto const magic = value(file->ReadAt(0, 4));
+
+    std::shared_ptr<arrow::Table> table;
+    if (magic->ToString() == "PAR1") {
+        std::unique_ptr<parquet::arrow::FileReader> reader;
+        check(parquet::arrow::OpenFile(file, arrow::default_memory_pool(), &reader));
+        std::shared_ptr<arrow::Schema> schema;
+        check(reader->GetSchema(&schema));
+        check(reader->ReadTable(select(*schema), &table));
+    } else {
+        auto options = arrow::ipc::IpcReadOptions::Defaults();
+        options.included_fields = select(*value(arrow::ipc::RecordBatchFileReader::Open(file))->schema());
+        auto reader = value(arrow::ipc::RecordBatchFileReader::Open(file, options));
+        std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+        for (auto i = 0; i < reader->num_record_batches(); ++i) {
+            batches.push_back(value(reader->ReadRecordBatch(i)));
+        }
+        table = value(arrow::Table::FromRecordBatches(reader->schema(), batches));
+    }
+
+    Matrix values(table->num_rows(), table->num_columns());
+    std::vector<std::string> names;
+    for (auto i = 0; i < table->num_columns(); ++i) {
+        auto const& name = table->field(i)->name();
+        names.push_back(name);
+        Eigen::Index row{0};
+        for (auto const& chunk : table->column(i)->chunks()) {
+            if (chunk->null_count() > 0) {
+                throw std::runtime_error(fmt::format("{}: column {} contains missing values", path, name));
+            }
+            auto copy = [&]<typename T>(T const* data) {
+                values.col(i).segment(row, chunk->length()) = Eigen::Map<Eigen::Array<T, -1, 1> const>(data, chunk->length()).template cast<Operon::Scalar>();
+            };
+            switch (chunk->type_id()) {
+            case arrow::Type::FLOAT: { copy(std::static_pointer_cast<arrow::FloatArray>(chunk)->raw_values()); break; }
+            case arrow::Type::DOUBLE: { copy(std::static_pointer_cast<arrow::DoubleArray>(chunk)->raw_values()); break; }
+            case arrow::Type::INT32: { copy(std::static_pointer_cast<arrow::Int32Array>(chunk)->raw_values()); break; }
+            case arrow::Type::INT64: { copy(std::static_pointer_cast<arrow::Int64Array>(chunk)->raw_values()); break; }
+            default: {
+                throw std::runtime_error(fmt::format("{}: column {} has the unsupported type {}", path, name, chunk->type()->ToString()));
+            }
+            }
+            row += chunk->length();
+        }
+    }
+
+    Dataset ds(std::move(values));
+    ds.variables_ = VariablesFromNames(names);
+    for (auto const& v : selected) { ds.SetTransform(v.Hash, v.Scale, v.Offset); }
+    return ds;
+}
+#endif
+
 auto Dataset::ReadCsv(std::string const& path, bool hasHeader) -> Dataset::Matrix
 {
     std::ifstream f(path);
@@ -143,6 +757,7 @@ void Dataset::SetVariableNames(std::vector<std::string> const& names)
         throw std::runtime_error(msg);
     }
     variables_ = VariablesFromNames(names);
+    codes_.reset(); // the codes are keyed by the hashes of the names
 }
 
 auto Dataset::VariableNames() const -> std::vector<std::string>
@@ -184,6 +799,14 @@ auto Dataset::GetValues(Operon::Hash hash) const noexcept -> Operon::Span<const
     return {map_.col(it->second.Index).data(), static_cast<size_t>(map_.rows())};
 }
 
+auto Dataset::GetValues(Operon::Hash hash, Operon::Range range, std::size_t lag) const -> Operon::Span<const Operon::Scalar>
+{
+    if (lag > range.Start()) {
+        throw std::runtime_error(fmt::format("the variable lag {} exceeds the first row {} of the range\n", lag, range.Start()));
+    }
+    return GetValues(hash).subspan(range.Start() - lag, range.Size());
+}
+
 // this method needs to take an int argument to differentiate it from GetValues(Operon::Hash)
 auto Dataset::GetValues(int64_t index) const noexcept -> Operon::Span<const Operon::Scalar>
 {
@@ -202,28 +825,28 @@ auto Dataset::GetVariable(Operon::Hash hash) const noexcept -> std::optional<Var
     return it->second;
 }
 
+auto Dataset::RandomPermutation(Operon::RandomGenerator& random) const -> std::vector<Eigen::Index>
+{
+    std::vector<Eigen::Index> indices(Rows<std::size_t>());
+    std::iota(indices.begin(), indices.end(), Eigen::Index{0});
+    std::shuffle(indices.begin(), indices.end(), random);
+    return indices;
+}
+
 void Dataset::Shuffle(Operon::RandomGenerator& random)
 {
     if (IsView()) { throw std::runtime_error("Cannot shuffle. Dataset does not own the data.\n"); }
-    Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic> perm(values_.rows());
-    perm.setIdentity();
-    // generate a random permutation
-    Operon::Span<decltype(perm)::IndicesType::Scalar> idx(perm.indices().data(), perm.indices().size());
-    std::shuffle(idx.begin(), idx.end(), random);
-    values_.matrix().applyOnTheLeft(perm); // permute rows
+    PermuteRows(RandomPermutation(random));
 }
 
 void Dataset::Normalize(size_t i, Range range)
 {
     if (IsView()) { throw std::runtime_error("Cannot normalize. Dataset does not own the data.\n"); }
     EXPECT(range.Start() + range.Size() <= static_cast<size_t>(values_.rows()));
-    auto j     = static_cast<Eigen::Index>(i);
-    auto start = static_cast<Eigen::Index>(range.Start());
-    auto size  = static_cast<Eigen::Index>(range.Size());
-    auto seg   = values_.col(j).segment(start, size);
-    auto min   = seg.minCoeff();
-    auto max   = seg.maxCoeff();
+    auto j = static_cast<Eigen::Index>(i);
+    auto const [min, max] = MinMax(values_.col(j), range);
     values_.col(j) = (values_.col(j).array() - min) / (max - min);
+    codes_.reset();
 }
 
 void Dataset::PermuteRows(std::vector<Eigen::Index> const& indices)
@@ -233,19 +856,94 @@ void Dataset::PermuteRows(std::vector<Eigen::Index> const& indices)
     Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic> perm(values_.rows());
     std::copy(indices.begin(), indices.end(), perm.indices().begin());
     values_.matrix().applyOnTheLeft(perm); // permute rows
+    codes_.reset();
 }
 
 // standardize column i using mean and stddev calculated over the specified range
-void Dataset::Standardize(size_t i, Range range)
+void Dataset::Standardize(size_t i, Range range, bool inPlace)
 {
-    if (IsView()) { throw std::runtime_error("Cannot standardize. Dataset does not own the data.\n"); }
-    EXPECT(range.Start() + range.Size() <= static_cast<size_t>(values_.rows()));
+    if (inPlace && IsView()) { throw std::runtime_error("Cannot standardize. Dataset does not own the data.\n"); }
+    EXPECT(range.Start() + range.Size() <= static_cast<size_t>(map_.rows()));
     auto j = static_cast<Eigen::Index>(i);
-    auto start = static_cast<Eigen::Index>(range.Start());
-    auto n = static_cast<Eigen::Index>(range.Size());
-    auto seg = values_.col(j).segment(start, n);
-    auto stats = vstat::univariate::accumulate<Matrix::Scalar>(seg.begin(), seg.end());
-    auto stddev = std::sqrt(stats.variance);
-    values_.col(j) = (values_.col(j).array() - stats.mean) / stddev;
+    auto const [mean, stddev] = MeanStddev(map_.col(j), range);
+    if (inPlace) {
+        values_.col(j) = (values_.col(j).array() - mean) / stddev;
+        codes_.reset();
+        return;
+    }
+    SetTransform(VariableAt(variables_, j), static_cast<Operon::Scalar>(1 / stddev), static_cast<Operon::Scalar>(-mean / stddev));
+}
+
+void Dataset::Shuffle(Operon::RandomGenerator& random, tf::Executor& executor)
+{
+    if (IsView()) { throw std::runtime_error("Cannot shuffle. Dataset does not own the data.\n"); }
+    PermuteRows(RandomPermutation(random), executor);
+}
+
+void Dataset::PermuteRows(std::vector<Eigen::Index> const& indices, tf::Executor& executor)
+{
+    if (IsView()) { throw std::runtime_error("Cannot shuffle. Dataset does not own the data.\n"); }
+    ENSURE(values_.rows() == std::ssize(indices));
+    // each column is scattered from a copy, the copy is reused by the columns of the same worker and released at the end
+    std::vector<std::vector<Matrix::Scalar>> copies(executor.num_workers());
+    tf::Taskflow taskflow;
+    taskflow.for_each_index(Eigen::Index{0}, values_.cols(), Eigen::Index{1}, [&](Eigen::Index j) {
+        auto& column = copies[executor.this_worker_id()];
+        auto c = values_.col(j);
+        column.assign(c.begin(), c.end());
+        for (auto i = 0UL; i < indices.size(); ++i) { c(indices[i]) = column[i]; }
+    });
+    RunTaskflow(executor, taskflow);
+    codes_.reset();
+}
+
+void Dataset::Normalize(Operon::Span<std::size_t const> columns, Range range, tf::Executor& executor)
+{
+    if (IsView()) { throw std::runtime_error("Cannot normalize. Dataset does not own the data.\n"); }
+    EXPECT(range.Start() + range.Size() <= static_cast<size_t>(values_.rows()));
+    std::vector<std::pair<Matrix::Scalar, Matrix::Scalar>> bounds(columns.size());
+    ForEachColumn(executor, columns.size(), [&](auto k) { bounds[k] = MinMax(values_.col(static_cast<Eigen::Index>(columns[k])), range); });
+    ForEachBlock(executor, values_, columns, [&](auto k, auto seg) { auto const [min, max] = bounds[k]; seg = (seg - min) / (max - min); });
+    codes_.reset();
+}
+
+void Dataset::Standardize(Operon::Span<std::size_t const> columns, Range range, bool inPlace, tf::Executor& executor)
+{
+    if (inPlace && IsView()) { throw std::runtime_error("Cannot standardize. Dataset does not own the data.\n"); }
+    EXPECT(range.Start() + range.Size() <= static_cast<size_t>(map_.rows()));
+    std::vector<std::pair<double, double>> stats(columns.size());
+    ForEachColumn(executor, columns.size(), [&](auto k) { stats[k] = MeanStddev(map_.col(static_cast<Eigen::Index>(columns[k])), range); });
+    if (inPlace) {
+        ForEachBlock(executor, values_, columns, [&](auto k, auto seg) { auto const [mean, stddev] = stats[k]; seg = (seg - mean) / stddev; });
+        codes_.reset();
+        return;
+    }
+    for (auto k = 0UL; k < columns.size(); ++k) {
+        auto const [mean, stddev] = stats[k];
+        SetTransform(VariableAt(variables_, static_cast<Eigen::Index>(columns[k])), static_cast<Operon::Scalar>(1 / stddev), static_cast<Operon::Scalar>(-mean / stddev));
+    }
+}
+
+void Dataset::SetTransform(Operon::Hash hash, Operon::Scalar scale, Operon::Scalar offset)
+{
+    auto it = variables_.find(hash);
+    if (it == variables_.end()) { throw std::runtime_error(fmt::format("the dataset does not contain a variable with hash {}", hash)); }
+    it->second.Scale = scale;
+    it->second.Offset = offset;
+}
+
+void Dataset::ClearTransforms() noexcept
+{
+    for (auto& [hash, v] : variables_) {
+        v.Scale = 1;
+        v.Offset = 0;
+    }
+}
+
+auto Dataset::GetTransform(Operon::Hash hash) const noexcept -> std::pair<Operon::Scalar, Operon::Scalar>
+{
+    auto it = variables_.find(hash);
+    if (it == variables_.end()) { return { 1, 0 }; }
+    return { it->second.Scale, it->second.Offset };
 }
 } // namespace Operon
@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <fmt/core.h>
+
+#include "operon/core/dataset_codes.hpp"
+
+namespace Operon {
+
+namespace {
+    using Bits = std::conditional_t<sizeof(Operon::Scalar) == sizeof(std::uint32_t), std::uint32_t, std::uint64_t>;
+
+    // the ranks of the values if they are base + step * rank for the ranks 0, ..., n - 1 (eg. integer codes)
+    // - the products are exact, so that the values do not depend on the contraction of the operations
+    auto Ranks(std::vector<Operon::Scalar> const& dictionary, Operon::Scalar& base, Operon::Scalar& step) -> std::vector<std::uint16_t>
+    {
+        auto const n = dictionary.size();
+        if (n < 2 || !std::ranges::all_of(dictionary, [](auto v) { return std::isfinite(v); })) { return {}; }
+        auto const [lo, hi] = std::ranges::minmax(dictionary);
+        base = lo;
+        step = (hi - lo) / static_cast<Operon::Scalar>(n - 1);
+
+        std::vector<std::uint16_t> ranks(n);
+        std::vector<std::uint8_t> used(n, 0);
+        for (auto i = 0UL; i < n; ++i) {
+            auto const k = std::round((dictionary[i] - lo) / step);
+            if (!(k >= 0 && k < static_cast<Operon::Scalar>(n)) || used[static_cast<std::size_t>(k)] != 0) { return {}; }
+            auto const p = k * step;
+            if (std::fma(k, step, -p) != 0 || p + lo != dictionary[i]) { return {}; }
+            ranks[i] = static_cast<std::uint16_t>(k);
+            used[static_cast<std::size_t>(k)] = 1;
+        }
+        return ranks;
+    }
+} // namespace
+
+DatasetCodes::DatasetCodes(Dataset const& dataset, Operon::Span<Operon::Hash const> variables, std::size_t maxCardinality)
+    : rows_(dataset.Rows<std::size_t>())
+{
+    if (maxCardinality > MaxCardinality) {
+        throw std::invalid_argument(fmt::format("the codes cannot represent more than {} distinct values", MaxCardinality));
+    }
+
+    Operon::Map<Bits, std::uint16_t> index;
+    std::vector<std::uint16_t> codes(rows_);
+    for (auto h : variables) {
+        if (!dataset.GetVariable(h)) { throw std::invalid_argument(fmt::format("the dataset has no variable with hash {}", h)); }
+
+        // build the dictionary in the order of first appearance, give up once it is too large
+        Column c;
+        index.clear();
+        auto encoded{true};
+        auto const x = dataset.GetValues(h);
+        for (auto i = 0UL; i < rows_ && encoded; ++i) {
+            auto [it, inserted] = index.try_emplace(std::bit_cast<Bits>(x[i]), static_cast<std::uint16_t>(c.Dictionary.size()));
+            if (inserted) {
+                encoded = c.Dictionary.size() < maxCardinality;
+                c.Dictionary.push_back(x[i]);
+            }
+            codes[i] = it->second;
+        }
+        auto const narrow = c.Dictionary.size() <= std::numeric_limits<std::uint8_t>::max() + 1UL;
+        auto const bytes = (rows_ * (narrow ? sizeof(std::uint8_t) : sizeof(std::uint16_t))) + (c.Dictionary.size() * sizeof(Operon::Scalar));
+        if (!encoded || bytes >= rows_ * sizeof(Operon::Scalar)) { continue; }
+
+        // the codes of evenly spaced values are their ranks, the dictionary is sorted
+        if (auto const ranks = Ranks(c.Dictionary, c.Base, c.Step); !ranks.empty()) {
+            auto dictionary = c.Dictionary;
+            for (auto j = 0UL; j < ranks.size(); ++j) { c.Dictionary[ranks[j]] = dictionary[j]; }
+            for (auto& x : codes) { x = ranks[x]; }
+            c.Linear = true;
+        }
+
+        if (narrow) {
+            c.Codes8.assign(codes.begin(), codes.end());
+        } else {
+            c.Codes16 = codes;
+        }
+        columns_.insert({ h, std::move(c) });
+    }
+}
+
+DatasetCodes::DatasetCodes(Dataset const& dataset, std::size_t maxCardinality)
+    : DatasetCodes(dataset, dataset.VariableHashes(), maxCardinality)
+{
+}
+
+auto DatasetCodes::Values(Operon::Hash hash, std::size_t row) const -> EncodedValues
+{
+    auto it = columns_.find(hash);
+    if (it == columns_.end() || row > rows_) { return {}; }
+    auto const& c = it->second;
+    if (c.Encoding != ValueEncoding::Dictionary) {
+        return { c.Codes16.data() + row, nullptr, 2, c.Encoding };
+    }
+    return {
+        .Codes      = c.Codes16.empty() ? static_cast<void const*>(c.Codes8.data() + row) : static_cast<void const*>(c.Codes16.data() + row),
+        .Dictionary = c.Dictionary.data(),
+        .Width      = static_cast<std::uint8_t>(c.Codes16.empty() ? 1 : 2),
+        .Encoding   = ValueEncoding::Dictionary,
+        .Linear     = c.Linear,
+        .Base       = c.Base,
+        .Step       = c.Step
+    };
+}
+
+auto DatasetCodes::Narrow(Dataset const& dataset, Operon::Span<Operon::Hash const> variables, ValueEncoding encoding) -> void
+{
+    if (encoding == ValueEncoding::Dictionary) {
+        throw std::invalid_argument("the dictionary codes are chosen by the constructor");
+    }
+    if (dataset.Rows<std::size_t>() != rows_) {
+        throw std::invalid_argument(fmt::format("the dataset has {} rows instead of {}", dataset.Rows(), rows_));
+    }
+
+    for (auto h : variables) {
+        if (!dataset.GetVariable(h)) { throw std::invalid_argument(fmt::format("the dataset has no variable with hash {}", h)); }
+        Column c;
+        c.Encoding = encoding;
+        c.Codes16.resize(rows_);
+        auto const x = dataset.GetValues(h);
+        if (encoding == ValueEncoding::Half) {
+            std::ranges::transform(x, c.Codes16.begin(), [](auto v) { return detail::FloatToHalf(static_cast<float>(v)); });
+        } else {
+            std::ranges::transform(x, c.Codes16.begin(), [](auto v) { return detail::FloatToBFloat16(static_cast<float>(v)); });
+        }
+        columns_[h] = std::move(c);
+    }
+}
+
+auto DatasetCodes::Encoding(Operon::Hash hash) const -> std::optional<ValueEncoding>
+{
+    auto it = columns_.find(hash);
+    if (it == columns_.end()) { return std::nullopt; }
+    return it->second.Encoding;
+}
+
+auto DatasetCodes::Cardinality(Operon::Hash hash) const -> std::size_t
+{
+    auto it = columns_.find(hash);
+    return it == columns_.end() ? 0 : it->second.Dictionary.size();
+}
+
+} // namespace Operon
@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <fmt/core.h>
+
+#include "operon/core/dataset_tiles.hpp"
+
+namespace Operon {
+
+DatasetTiles::DatasetTiles(Dataset const& dataset, Operon::Span<Operon::Hash const> variables, std::size_t tileRows)
+    : tileRows_(tileRows)
+    , rows_(dataset.Rows<std::size_t>())
+    , tiles_(tileRows == 0 ? 0 : (rows_ + tileRows - 1) / tileRows)
+{
+    if (tileRows == 0) { throw std::invalid_argument("the tiles must have at least one row"); }
+    for (auto h : variables) {
+        if (!dataset.GetVariable(h)) { throw std::invalid_argument(fmt::format("the dataset has no variable with hash {}", h)); }
+        index_.insert({ h, index_.size() });
+    }
+
+    auto const stride = Stride();
+    values_.resize(tiles_ * stride, Operon::Scalar{0});
+    for (auto const& [h, k] : index_) {
+        auto const x = dataset.GetValues(h);
+        for (auto t = 0UL; t < tiles_; ++t) {
+            auto const start = t * tileRows_;
+            auto const n = std::min(tileRows_, rows_ - start);
+            std::copy_n(x.begin() + static_cast<std::ptrdiff_t>(start), n, values_.begin() + static_cast<std::ptrdiff_t>((t * stride) + (k * tileRows_)));
+        }
+    }
+}
+
+DatasetTiles::DatasetTiles(Dataset const& dataset, std::size_t tileRows)
+    : DatasetTiles(dataset, dataset.VariableHashes(), tileRows)
+{
+}
+
+auto DatasetTiles::Values(Operon::Hash hash, std::size_t tile) const -> Operon::Scalar const*
+{
+    auto it = index_.find(hash);
+    if (it == index_.end() || tile >= tiles_) { return nullptr; }
+    return values_.data() + (tile * Stride()) + (it->second * tileRows_);
+}
+
+} // namespace Operon
@@ -2,9 +2,13 @@
 // SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
 
 #include "operon/core/distance.hpp"
+#include "operon/core/contracts.hpp"
+#include "operon/core/executor.hpp"
 
 #include <eve/wide.hpp>
 #include <eve/module/algo.hpp>
+#include <taskflow/taskflow.hpp>
+#include <taskflow/algorithm/for_each.hpp>
 
 namespace Operon::Distance {
     namespace detail {
@@ -62,6 +66,42 @@ namespace Operon::Distance {
             using T = typename Container::value_type;
             return CountIntersect(Operon::Span<T const>(lhs.data(), lhs.size()), Operon::Span<T const>(rhs.data(), rhs.size()));
         }
+
+        struct JaccardMeasure {
+            auto operator()(size_t n, size_t c) const noexcept -> double { return static_cast<double>(n - 2 * c) / static_cast<double>(n); }
+        };
+
+        struct SorensenDiceMeasure {
+            auto operator()(size_t n, size_t c) const noexcept -> double { return 1 - 2 * static_cast<double>(c) / static_cast<double>(n); }
+        };
+
+        template<typename Measure>
+        auto OneToMany(Operon::Vector<Operon::Hash> const& query, Operon::Span<Operon::Vector<Operon::Hash> const> candidates, Operon::Span<double> result) noexcept -> void
+        {
+            Operon::Span<Operon::Hash const> q{query};
+            for (auto i = 0UL; i < candidates.size(); ++i) {
+                auto const& c = candidates[i];
+                // the ranges of disjoint hash vectors often do not overlap at all, no need to walk them
+                auto const k = q.empty() || c.empty() || c.front() > q.back() || q.front() > c.back()
+                    ? 0UL
+                    : CountIntersect(q, Operon::Span<Operon::Hash const>{c});
+                result[i] = Measure{}(q.size() + c.size(), k);
+            }
+        }
+
+        template<typename Measure>
+        auto ManyToMany(Operon::Span<Operon::Vector<Operon::Hash> const> hashes, Operon::Span<double> result, tf::Executor& executor) -> void
+        {
+            auto const n = hashes.size();
+            if (n < 2) { return; }
+            EXPECT(result.size() == n * (n - 1) / 2);
+
+            tf::Taskflow taskflow;
+            taskflow.for_each_index(size_t{0}, n - 1, size_t{1}, [&](auto i) {
+                OneToMany<Measure>(hashes[i], hashes.subspan(i + 1), result.subspan(PairIndex(i, i + 1, n), n - i - 1));
+            });
+            RunTaskflow(executor, taskflow);
+        }
     } // namespace detail
 
     auto Jaccard(Operon::Vector<Operon::Hash> const& lhs, Operon::Vector<Operon::Hash> const& rhs) noexcept -> double
@@ -78,4 +118,24 @@ namespace Operon::Distance {
         return 1 - 2 * static_cast<double>(c) / static_cast<double>(n);
     }
 
+    auto Jaccard(Operon::Vector<Operon::Hash> const& query, Operon::Span<Operon::Vector<Operon::Hash> const> candidates, Operon::Span<double> result) noexcept -> void
+    {
+        detail::OneToMany<detail::JaccardMeasure>(query, candidates, result);
+    }
+
+    auto SorensenDice(Operon::Vector<Operon::Hash> const& query, Operon::Span<Operon::Vector<Operon::Hash> const> candidates, Operon::Span<double> result) noexcept -> void
+    {
+        detail::OneToMany<detail::SorensenDiceMeasure>(query, candidates, result);
+    }
+
+    auto Jaccard(Operon::Span<Operon::Vector<Operon::Hash> const> hashes, Operon::Span<double> result, tf::Executor& executor) -> void
+    {
+        detail::ManyToMany<detail::JaccardMeasure>(hashes, result, executor);
+    }
+
+    auto SorensenDice(Operon::Span<Operon::Vector<Operon::Hash> const> hashes, Operon::Span<double> result, tf::Executor& executor) -> void
+    {
+        detail::ManyToMany<detail::SorensenDiceMeasure>(hashes, result, executor);
+    }
+
 } // namespace Operon::Distance
@@ -0,0 +1,19 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <taskflow/taskflow.hpp>
+
+#include "operon/core/executor.hpp"
+
+namespace Operon {
+
+auto RunTaskflow(tf::Executor& executor, tf::Taskflow& taskflow) -> void
+{
+    if (executor.this_worker_id() < 0) {
+        executor.run(taskflow).wait();
+    } else {
+        executor.corun(taskflow);
+    }
+}
+
+} // namespace Operon
@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "operon/core/memory.hpp"
+
+namespace Operon {
+
+auto AdviseHugePages(void const* data, std::size_t bytes) -> bool
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    // madvise needs a page aligned address, round the range inwards
+    static auto const page = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+    auto const a = (reinterpret_cast<std::uintptr_t>(data) + page - 1) / page * page; // NOLINT
+    auto const b = (reinterpret_cast<std::uintptr_t>(data) + bytes) / page * page; // NOLINT
+    return a < b && ::madvise(reinterpret_cast<void*>(a), b - a, MADV_HUGEPAGE) == 0; // NOLINT
+#else
+    (void)data;
+    (void)bytes;
+    return false;
+#endif
+}
+
+auto PlanMemory(MemoryRequirements const& requirements, std::size_t limit) -> MemoryPlan
+{
+    auto const& r = requirements;
+    auto const column = r.Rows * sizeof(Operon::Scalar);
+    auto bytes = [&](MemoryPlan const& plan) {
+        auto const jacobian = plan.BlockedJacobian ? BlockedJacobianBytes(plan.BlockSize, r.Coefficients) : FullJacobianBytes(r.Rows, r.Coefficients);
+        return r.Fixed + (r.Workers * (column + (plan.GroupSize * column) + jacobian));
+    };
+
+    MemoryPlan plan{ .GroupSize = std::max(r.GroupSize, std::size_t{1}) };
+    auto fits = [&]() {
+        plan.Bytes = bytes(plan);
+        plan.Fits = plan.Bytes <= limit;
+        return plan.Fits;
+    };
+
+    while (!fits() && plan.GroupSize > 1) { plan.GroupSize /= 2; }
+    if (plan.Fits) { return plan; }
+
+    plan.BlockedJacobian = true;
+    plan.BlockSize = std::max(std::min(r.BlockSize, r.Rows), std::size_t{1});
+    while (!fits() && plan.BlockSize > MinJacobianBlockSize) { plan.BlockSize = std::max(plan.BlockSize / 2, MinJacobianBlockSize); }
+    return plan;
+}
+
+} // namespace Operon
@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include "operon/core/minhash.hpp"
+
+#include <algorithm>
+#include <fmt/format.h>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "operon/core/contracts.hpp"
+
+namespace Operon {
+
+namespace {
+    // the splitmix64 finalizer
+    constexpr auto Mix(uint64_t z) noexcept -> uint64_t
+    {
+        z = (z ^ (z >> 30U)) * 0xbf58476d1ce4e5b9ULL; // NOLINT
+        z = (z ^ (z >> 27U)) * 0x94d049bb133111ebULL; // NOLINT
+        return z ^ (z >> 31U);                        // NOLINT
+    }
+
+    constexpr uint64_t Golden{0x9e3779b97f4a7c15ULL};
+} // namespace
+
+MinHash::MinHash(std::size_t size, std::size_t bands, Operon::Hash seed)
+    : seeds_(size)
+    , bands_(bands)
+{
+    if (size == 0 || bands == 0 || size % bands != 0) {
+        throw std::invalid_argument(fmt::format("MinHash: the size ({}) must be a positive multiple of the number of bands ({})", size, bands));
+    }
+    for (auto& s : seeds_) {
+        seed += Golden;
+        s = Mix(seed);
+    }
+}
+
+auto MinHash::Sketch(Operon::Span<Operon::Hash const> hashes, Operon::Span<Operon::Hash> sketch) const noexcept -> void
+{
+    EXPECT(sketch.size() == Size());
+    std::ranges::fill(sketch, std::numeric_limits<Operon::Hash>::max());
+
+    uint64_t occurrence{0};
+    for (auto i = 0UL; i < hashes.size(); ++i) {
+        occurrence = (i > 0 && hashes[i] == hashes[i-1]) ? occurrence + 1 : 0;
+        auto const x = occurrence == 0 ? hashes[i] : Mix(hashes[i] + occurrence * Golden);
+        for (auto j = 0UL; j < sketch.size(); ++j) {
+            sketch[j] = std::min(sketch[j], Mix(x ^ seeds_[j]));
+        }
+    }
+}
+
+auto MinHash::Sketch(Operon::Span<Operon::Hash const> hashes) const -> Operon::Vector<Operon::Hash>
+{
+    Operon::Vector<Operon::Hash> sketch(Size());
+    Sketch(hashes, sketch);
+    return sketch;
+}
+
+auto MinHash::Band(Operon::Span<Operon::Hash const> sketch, std::size_t b) const noexcept -> Operon::Hash
+{
+    EXPECT(b < bands_);
+    auto const rows = Size() / bands_;
+    auto h = Mix(b + 1);
+    for (auto v : sketch.subspan(b * rows, rows)) {
+        h = Mix(h ^ v);
+    }
+    return h;
+}
+
+auto MinHash::Similarity(Operon::Span<Operon::Hash const> lhs, Operon::Span<Operon::Hash const> rhs) noexcept -> double
+{
+    EXPECT(lhs.size() == rhs.size());
+    std::size_t equal{0};
+    for (auto i = 0UL; i < lhs.size(); ++i) {
+        equal += static_cast<std::size_t>(lhs[i] == rhs[i]);
+    }
+    return static_cast<double>(equal) / static_cast<double>(lhs.size());
+}
+
+auto MinHash::Distance(Operon::Span<Operon::Hash const> lhs, Operon::Span<Operon::Hash const> rhs) noexcept -> double
+{
+    auto const s = Similarity(lhs, rhs);
+    return (1 - s) / (1 + s);
+}
+
+auto MinHash::NearestNeighbours(Operon::Span<Operon::Hash const> sketches, std::size_t window) const -> std::vector<double>
+{
+    auto const k = Size();
+    EXPECT(sketches.size() % k == 0);
+    auto const n = sketches.size() / k;
+    auto sketch = [&](auto i) { return sketches.subspan(i * k, k); };
+
+    std::vector<double> nearest(n, 1.0);
+    std::vector<std::pair<Operon::Hash, std::size_t>> buckets(n);
+    for (auto b = 0UL; b < bands_; ++b) {
+        for (auto i = 0UL; i < n; ++i) {
+            buckets[i] = { Band(sketch(i), b), i };
+        }
+        std::ranges::sort(buckets);
+
+        for (auto i = 0UL; i < n; ++i) {
+            auto const [h, p] = buckets[i];
+            for (auto j = i + 1; j < std::min(n, i + 1 + window) && buckets[j].first == h; ++j) {
+                auto const q = buckets[j].second;
+                auto const d = Distance(sketch(p), sketch(q));
+                nearest[p] = std::min(nearest[p], d);
+                nearest[q] = std::min(nearest[q], d);
+            }
+        }
+    }
+    return nearest;
+}
+
+} // namespace Operon
@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "operon/core/node_arena.hpp"
+
+namespace Operon {
+
+namespace {
+    struct Pool {
+        std::vector<Operon::Vector<Node>> Buffers;
+        std::vector<std::unique_ptr<NodeBuffer>> Blocks;
+
+        Pool();
+        ~Pool();
+        Pool(Pool const&) = delete;
+        Pool(Pool&&) = delete;
+        auto operator=(Pool const&) -> Pool& = delete;
+        auto operator=(Pool&&) -> Pool& = delete;
+    };
+
+    // trees can still be destroyed after the pool of their thread (eg. by the destructors of other thread-local
+    // or static objects), the flag is trivially destructible and remains valid in that case
+    thread_local bool destroyed{false}; // NOLINT
+
+    Pool::Pool() = default;
+    Pool::~Pool() { destroyed = true; }
+
+    auto GetPool() -> Pool*
+    {
+        if (destroyed) { return nullptr; }
+        thread_local Pool pool;
+        return &pool;
+    }
+} // namespace
+
+auto NodeArena::Acquire(std::size_t capacity) -> Operon::Vector<Node>
+{
+    Operon::Vector<Node> nodes;
+    if (auto* pool = GetPool(); pool != nullptr && !pool->Buffers.empty()) {
+        nodes = std::move(pool->Buffers.back());
+        pool->Buffers.pop_back();
+    }
+    nodes.reserve(capacity);
+    return nodes;
+}
+
+auto NodeArena::Copy(Operon::Vector<Node> const& nodes) -> Operon::Vector<Node>
+{
+    auto copy = Acquire(nodes.size());
+    copy.assign(nodes.begin(), nodes.end());
+    return copy;
+}
+
+auto NodeArena::Release(Operon::Vector<Node>&& nodes) noexcept -> void
+{
+    auto buffer = std::move(nodes);
+    buffer.clear();
+    auto* pool = buffer.capacity() == 0 ? nullptr : GetPool();
+    if (pool == nullptr || pool->Buffers.size() >= MaxBuffers) {
+        return;
+    }
+    // the pool keeps its capacity, so pushing back does not allocate once it is warm
+    try {
+        pool->Buffers.push_back(std::move(buffer));
+    } catch (...) { // NOLINT
+        // out of memory, let the buffer be freed
+    }
+}
+
+auto NodeArena::Share(Operon::Vector<Node>&& nodes) -> NodeBuffer*
+{
+    std::unique_ptr<NodeBuffer> block;
+    if (auto* pool = GetPool(); pool != nullptr && !pool->Blocks.empty()) {
+        block = std::move(pool->Blocks.back());
+        pool->Blocks.pop_back();
+        block->References.store(1, std::memory_order_relaxed);
+    } else {
+        block = std::make_unique<NodeBuffer>();
+    }
+    block->Nodes = std::move(nodes);
+    return block.release();
+}
+
+auto NodeArena::Unshare(NodeBuffer* buffer) noexcept -> void
+{
+    // the acquire ordering makes the reads of the other owners happen before the nodes are recycled
+    if (buffer == nullptr || buffer->References.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+    std::unique_ptr<NodeBuffer> block{buffer};
+    Release(std::move(block->Nodes));
+    auto* pool = GetPool();
+    if (pool == nullptr || pool->Blocks.size() >= MaxBuffers) {
+        return;
+    }
+    try {
+        pool->Blocks.push_back(std::move(block));
+    } catch (...) { // NOLINT
+        // out of memory, let the block be freed
+    }
+}
+
+auto NodeArena::Count() noexcept -> std::size_t
+{
+    auto const* pool = GetPool();
+    return pool == nullptr ? 0 : pool->Buffers.size();
+}
+
+auto NodeArena::Clear() noexcept -> void
+{
+    if (auto* pool = GetPool(); pool != nullptr) {
+        pool->Buffers.clear();
+        pool->Buffers.shrink_to_fit();
+        pool->Blocks.clear();
+        pool->Blocks.shrink_to_fit();
+    }
+}
+
+} // namespace Operon
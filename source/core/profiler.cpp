@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include "operon/core/profiler.hpp"
+#include "operon/core/counter.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace Operon {
+
+auto StageName(Stage stage) -> std::string_view
+{
+    constexpr std::array<std::string_view, StageCount> names {
+        "initialization", "selection", "crossover", "mutation", "local search", "evaluation", "sorting", "reinsertion"
+    };
+    return names.at(static_cast<std::size_t>(stage));
+}
+
+Profiler::Profiler(std::size_t shards)
+    : size_(shards > 0 ? shards : std::max(std::thread::hardware_concurrency(), 1U))
+    , shards_(std::make_unique<Shard[]>(size_)) // NOLINT
+{
+}
+
+auto Profiler::Local() noexcept -> Shard&
+{
+    return shards_[ThreadIndex() % size_];
+}
+
+auto Profiler::Record(Stage stage, Clock::duration elapsed) noexcept -> void
+{
+    auto& counters = Local().Counters;
+    auto const i = 2 * static_cast<std::size_t>(stage);
+    counters[i].fetch_add(1, std::memory_order_relaxed);
+    counters[i + 1].fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()), std::memory_order_relaxed);
+}
+
+auto Profiler::Collect() -> ProfileSummary const&
+{
+    last_ = {};
+    for (auto s = 0UL; s < size_; ++s) {
+        auto& counters = shards_[s].Counters;
+        for (auto i = 0UL; i < StageCount; ++i) {
+            last_[i] += { counters[2 * i].exchange(0, std::memory_order_relaxed), counters[2 * i + 1].exchange(0, std::memory_order_relaxed) };
+        }
+    }
+    for (auto i = 0UL; i < StageCount; ++i) { total_[i] += last_[i]; }
+    return last_;
+}
+
+auto Profiler::Reset() -> void
+{
+    Collect();
+    last_ = {};
+    total_ = {};
+}
+
+} // namespace Operon
@@ -5,6 +5,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <fmt/core.h>
+#include <numeric>
 #include <random>
 #include <stdexcept>
 #include <tuple>
@@ -29,43 +30,86 @@ namespace Operon {
     {
         EXPECT(minArity <= maxArity);
         EXPECT(!pset_.empty());
+        auto result = sampler_(random, minArity, maxArity);
+        ENSURE(IsEnabled(result.HashValue));
+        ENSURE(Frequency(result.HashValue) > 0);
+        return result;
+    }
 
-        std::vector<Primitive> candidates;
-        candidates.reserve(pset_.size());
-
-        auto sum{0UL};
-        for (auto const& [k, v] : pset_) {
-            auto const& [node, freq, min_arity, max_arity] = v;
+    SymbolSampler::SymbolSampler(PrimitiveSet const& pset)
+    {
+        std::vector<Symbol> symbols;
+        std::vector<size_t> frequencies;
+        for (auto const& [k, v] : pset.Primitives()) {
+            auto const& [node, freq, minArity, maxArity] = v;
             if (!(node.IsEnabled && freq > 0)) { continue; }
-            if (minArity > max_arity || maxArity < min_arity) { continue; }
-            sum += freq;
-            candidates.push_back(v);
+            symbols.push_back({ node, minArity, maxArity });
+            frequencies.push_back(freq);
+            maxArity_ = std::max(maxArity_, maxArity);
         }
 
-        if (candidates.empty()) {
-            // arity requirements unreasonable
-            throw std::runtime_error(fmt::format("PrimitiveSet::SampleRandomSymbol: unable to find suitable symbol with arity between {} and {}\n", minArity, maxArity));
-        }
+        auto const n = maxArity_ + 1;
+        tables_.resize(n * n);
+        for (auto lo = 0UL; lo < n; ++lo) {
+            for (auto hi = lo; hi < n; ++hi) {
+                auto& table = tables_[lo * n + hi];
+                std::vector<double> weights;
+                for (auto i = 0UL; i < symbols.size(); ++i) {
+                    auto const& s = symbols[i];
+                    if (lo > s.MaxArity || hi < s.MinArity) { continue; }
+                    table.Symbols.push_back(s);
+                    weights.push_back(static_cast<double>(frequencies[i]));
+                }
+                if (table.Symbols.empty()) { continue; }
 
-        Operon::Node result { Operon::NodeType::Constant };
+                // vose's alias method: the weights are scaled to an average of one, then each column below one is
+                // filled up with a column above one, which becomes its alias
+                auto const m = weights.size();
+                auto const sum = std::reduce(weights.begin(), weights.end());
+                for (auto& w : weights) { w *= static_cast<double>(m) / sum; }
+                table.Probability.assign(m, 1.0);
+                table.Alias.resize(m);
+                std::iota(table.Alias.begin(), table.Alias.end(), 0U);
 
-        auto c { std::uniform_real_distribution<Operon::Scalar>(0, sum)(random) };
-        auto s { 0UL };
-        for (auto const& [node, freq, min_arity, max_arity] : candidates) {
-            s += freq;
-            if (c < s) {
-                auto amin = std::max(minArity, MinimumArity(node.HashValue));
-                auto amax = std::min(maxArity, MaximumArity(node.HashValue));
-                auto arity = std::uniform_int_distribution<size_t>(amin, amax)(random);
-                result = node;
-                result.Arity = static_cast<uint16_t>(arity);
-                break;
+                std::vector<uint32_t> under;
+                std::vector<uint32_t> over;
+                for (auto i = 0U; i < m; ++i) { (weights[i] < 1 ? under : over).push_back(i); }
+                while (!under.empty() && !over.empty()) {
+                    auto const u = under.back();
+                    under.pop_back();
+                    auto const o = over.back();
+                    table.Probability[u] = weights[u];
+                    table.Alias[u] = o;
+                    weights[o] -= 1 - weights[u];
+                    if (weights[o] < 1) {
+                        over.pop_back();
+                        under.push_back(o);
+                    }
+                }
+                // the remaining columns are full (up to rounding errors)
             }
         }
+    }
 
-        ENSURE(IsEnabled(result.HashValue));
-        ENSURE(Frequency(result.HashValue) > 0);
+    auto SymbolSampler::operator()(Operon::RandomGenerator& random, size_t minArity, size_t maxArity) const -> Node
+    {
+        EXPECT(minArity <= maxArity);
+        // no symbol accepts more arguments than maxArity_
+        maxArity = std::min(maxArity, maxArity_);
+        auto const* table = minArity <= maxArity ? &tables_[minArity * (maxArity_ + 1) + maxArity] : nullptr;
+        if (table == nullptr || table->Symbols.empty()) {
+            throw std::runtime_error(fmt::format("PrimitiveSet::SampleRandomSymbol: unable to find suitable symbol with arity between {} and {}\n", minArity, maxArity));
+        }
+
+        auto const m = table->Symbols.size();
+        auto i = std::uniform_int_distribution<size_t>(0, m - 1)(random);
+        if (std::uniform_real_distribution<double>(0, 1)(random) >= table->Probability[i]) { i = table->Alias[i]; }
 
+        auto const& symbol = table->Symbols[i];
+        Node result = symbol.Node;
+        auto const amin = std::max(minArity, symbol.MinArity);
+        auto const amax = std::min(maxArity, symbol.MaxArity);
+        result.Arity = static_cast<uint16_t>(amin == amax ? amin : std::uniform_int_distribution<size_t>(amin, amax)(random));
         return result;
     }
 } // namespace Operon
@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include "operon/core/serialization.hpp"
+
+#include <algorithm>
+#include <istream>
+#include <ostream>
+
+#include "operon/core/node.hpp"
+
+namespace Operon::Serialization {
+
+namespace {
+    constexpr uint8_t EnabledFlag{1U};
+    constexpr uint8_t OptimizeFlag{2U};
+    constexpr uint8_t LagFlag{4U}; // the flags are followed by the lag of the variable
+    constexpr uint32_t PopulationMagic{0x504F504FU}; // "OPOP"
+    constexpr uint64_t MaxReserve{1U << 20U};
+
+    template<typename T>
+    auto WriteValue(std::ostream& out, T const value) -> void
+    {
+        out.write(reinterpret_cast<char const*>(&value), sizeof(T)); // NOLINT
+    }
+
+    template<typename T>
+    auto ReadValue(std::istream& in) -> T
+    {
+        T value;
+        if (!in.read(reinterpret_cast<char*>(&value), sizeof(T))) { // NOLINT
+            throw std::runtime_error("truncated population stream");
+        }
+        return value;
+    }
+} // namespace
+
+auto Write(std::vector<uint8_t>& bytes, Operon::Tree const& tree) -> void
+{
+    auto const& nodes = tree.Nodes();
+    Write<uint64_t>(bytes, nodes.size());
+    for (auto const& n : nodes) {
+        Write<UnderlyingNodeType>(bytes, static_cast<UnderlyingNodeType>(n.Type));
+        Write<Operon::Hash>(bytes, n.HashValue);
+        Write<Operon::Scalar>(bytes, n.Value);
+        Write<uint16_t>(bytes, n.Arity);
+        Write<uint8_t>(bytes, static_cast<uint8_t>((n.IsEnabled ? EnabledFlag : 0U) | (n.Optimize ? OptimizeFlag : 0U) | (n.Lag != 0 ? LagFlag : 0U)));
+        if (n.Lag != 0) { Write<uint8_t>(bytes, n.Lag); }
+    }
+}
+
+auto ReadTree(Operon::Span<uint8_t const> bytes, std::size_t& offset) -> Operon::Tree
+{
+    Operon::Vector<Node> nodes(Read<uint64_t>(bytes, offset));
+    for (auto& n : nodes) {
+        auto const type = static_cast<NodeType>(Read<UnderlyingNodeType>(bytes, offset));
+        auto const hash = Read<Operon::Hash>(bytes, offset);
+        n = Node(type, hash);
+        n.Value = Read<Operon::Scalar>(bytes, offset);
+        n.Arity = Read<uint16_t>(bytes, offset);
+        auto const flags = Read<uint8_t>(bytes, offset);
+        n.IsEnabled = (flags & EnabledFlag) != 0;
+        n.Optimize = (flags & OptimizeFlag) != 0;
+        if ((flags & LagFlag) != 0) { n.Lag = Read<uint8_t>(bytes, offset); }
+    }
+    Operon::Tree tree(std::move(nodes));
+    tree.UpdateNodes();
+    return tree;
+}
+
+auto Write(std::vector<uint8_t>& bytes, Operon::Individual const& individual) -> void
+{
+    Write<uint64_t>(bytes, individual.Fitness.size());
+    for (auto f : individual.Fitness) { Write<Operon::Scalar>(bytes, f); }
+    Write(bytes, individual.Genotype);
+}
+
+auto ReadIndividual(Operon::Span<uint8_t const> bytes, std::size_t& offset) -> Operon::Individual
+{
+    Operon::Individual individual(Read<uint64_t>(bytes, offset));
+    for (auto& f : individual.Fitness) { f = Read<Operon::Scalar>(bytes, offset); }
+    individual.Genotype = ReadTree(bytes, offset);
+    return individual;
+}
+
+auto WritePopulation(std::ostream& out, Operon::Span<Operon::Individual const> individuals) -> void
+{
+    WriteValue<uint32_t>(out, PopulationMagic);
+    WriteValue<uint32_t>(out, PopulationVersion);
+    WriteValue<uint32_t>(out, sizeof(Operon::Scalar));
+    WriteValue<uint64_t>(out, individuals.size());
+
+    // the buffer is reused, only one individual is encoded in memory at a time
+    std::vector<uint8_t> bytes;
+    for (auto const& ind : individuals) {
+        bytes.clear();
+        Write(bytes, ind);
+        WriteValue<uint64_t>(out, bytes.size());
+        out.write(reinterpret_cast<char const*>(bytes.data()), static_cast<std::streamsize>(bytes.size())); // NOLINT
+    }
+    if (!out) {
+        throw std::runtime_error("failed to write the population stream");
+    }
+}
+
+auto ReadPopulation(std::istream& in) -> Operon::Vector<Operon::Individual>
+{
+    if (auto const magic = ReadValue<uint32_t>(in); magic != PopulationMagic) {
+        throw std::runtime_error("not a population stream");
+    }
+    if (auto const version = ReadValue<uint32_t>(in); version != PopulationVersion) {
+        throw std::runtime_error(fmt::format("unsupported population format version {} (expected {})", version, PopulationVersion));
+    }
+    if (auto const scalar = ReadValue<uint32_t>(in); scalar != sizeof(Operon::Scalar)) {
+        throw std::runtime_error(fmt::format("the population was written with {}-byte scalars (expected {})", scalar, sizeof(Operon::Scalar)));
+    }
+
+    auto const count = ReadValue<uint64_t>(in);
+    Operon::Vector<Operon::Individual> individuals;
+    individuals.reserve(std::min<uint64_t>(count, MaxReserve)); // the count is not trusted before the individuals are read
+    std::vector<uint8_t> bytes;
+    for (auto i = 0UL; i < count; ++i) {
+        bytes.resize(ReadValue<uint64_t>(in));
+        if (!in.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) { // NOLINT
+            throw std::runtime_error("truncated population stream");
+        }
+        std::size_t offset{0};
+        individuals.push_back(ReadIndividual(bytes, offset));
+    }
+    return individuals;
+}
+
+} // namespace Operon::Serialization
@@ -0,0 +1,234 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <numeric>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "operon/core/node.hpp"
+#include "operon/core/node_arena.hpp"
+#include "operon/core/tree.hpp"
+#include "operon/core/types.hpp"
+
+namespace Operon {
+
+namespace {
+    using Scalar = Operon::Scalar;
+
+    // the value of a function of constant arguments, with the semantics of the interpreter (args[0] is the first argument)
+    auto Fold(NodeType type, std::span<Scalar const> args) -> std::optional<Scalar>
+    {
+        auto const x = args.front();
+        auto const rest = args.subspan(1);
+        switch (type) {
+        case NodeType::Add: return std::reduce(args.begin(), args.end(), Scalar{0});
+        case NodeType::Mul: return std::reduce(args.begin(), args.end(), Scalar{1}, std::multiplies{});
+        case NodeType::Sub: return rest.empty() ? -x : x - std::reduce(rest.begin(), rest.end(), Scalar{0});
+        case NodeType::Div: return rest.empty() ? Scalar{1} / x : x / std::reduce(rest.begin(), rest.end(), Scalar{1}, std::multiplies{});
+        case NodeType::Fmin: return std::ranges::min(args);
+        case NodeType::Fmax: return std::ranges::max(args);
+        case NodeType::Aq: return x / std::sqrt(Scalar{1} + args[1] * args[1]);
+        case NodeType::Pow: return std::pow(x, args[1]);
+        case NodeType::Abs: return std::abs(x);
+        case NodeType::Acos: return std::acos(x);
+        case NodeType::Asin: return std::asin(x);
+        case NodeType::Atan: return std::atan(x);
+        case NodeType::Cbrt: return std::cbrt(x);
+        case NodeType::Ceil: return std::ceil(x);
+        case NodeType::Cos: return std::cos(x);
+        case NodeType::Cosh: return std::cosh(x);
+        case NodeType::Exp: return std::exp(x);
+        case NodeType::Floor: return std::floor(x);
+        case NodeType::Log: return std::log(x);
+        case NodeType::Logabs: return std::log(std::abs(x));
+        case NodeType::Log1p: return std::log1p(x);
+        case NodeType::Sin: return std::sin(x);
+        case NodeType::Sinh: return std::sinh(x);
+        case NodeType::Sqrt: return std::sqrt(x);
+        case NodeType::Sqrtabs: return std::sqrt(std::abs(x));
+        case NodeType::Tan: return std::tan(x);
+        case NodeType::Tanh: return std::tanh(x);
+        case NodeType::Square: return x * x;
+        default: return std::nullopt;
+        }
+    }
+
+    // a constant that is not a coefficient (it is never changed by local search)
+    auto IsFixed(Node const& n, Scalar value) -> bool
+    {
+        return n.IsConstant() && !n.Optimize && n.Value == value;
+    }
+} // namespace
+
+// Simplify the tree bottom-up in a single pass over the nodes
+// - functions of constants are folded into a constant (if the result is finite)
+// - the neutral elements of add, mul, sub and div (x + 0, x * 1, x - 0, x / 1) are removed, an add, mul, fmin or fmax
+//   with a single argument (or a sub or div left with its first argument) is replaced by its argument
+// - nested add and mul nodes (with a weight of one) are merged and their constant arguments are combined, a constant
+//   factor is absorbed into the weight of an optimized variable
+// - double negations, abs(abs(x)), abs(-x) and nested floor and ceil are collapsed
+// - the weights of the removed nodes are carried over, so the tree evaluates to the same values (up to rounding)
+// - constants that are optimized are coefficients: they are folded and combined into new coefficients but never
+//   removed as neutral elements
+auto Tree::Simplify() -> Tree&
+{
+    if (Empty()) { return *this; }
+
+    auto const& input = Buffer();
+    auto out = NodeArena::Acquire(input.size());
+    Operon::Vector<Node> scratch;
+    std::vector<std::size_t> roots;
+    std::vector<std::pair<std::size_t, std::size_t>> segments; // [begin, end) in scratch, in argument order
+    std::vector<Scalar> args;
+
+    // the roots of the arguments of a function node with the given arity, the first argument is the last node
+    auto arguments = [&](auto const& nodes, std::size_t end, std::size_t arity) {
+        roots.clear();
+        for (auto j = end - 1; roots.size() < arity; j -= nodes[j].Length + 1UL) {
+            roots.push_back(j);
+        }
+    };
+
+    for (auto const& node : input) {
+        if (node.IsLeaf()) {
+            out.emplace_back(node).Length = 0;
+            continue;
+        }
+
+        auto p = node;
+        arguments(out, out.size(), p.Arity);
+        auto const begin = roots.back() - out[roots.back()].Length;
+
+        // constant folding
+        if (!p.IsDynamic() && std::ranges::all_of(roots, [&](auto j) { return out[j].IsConstant(); })) {
+            args.clear();
+            std::ranges::transform(roots, std::back_inserter(args), [&](auto j) { return out[j].Value; });
+            if (auto v = Fold(p.Type, args); v && std::isfinite(*v * p.Value)) {
+                auto c = Node::Constant(*v * p.Value);
+                c.Optimize = p.Optimize || std::ranges::any_of(roots, [&](auto j) { return out[j].Optimize; });
+                out.resize(begin);
+                out.emplace_back(c).Length = 0;
+                continue;
+            }
+        }
+
+        if (p.Is<NodeType::Add, NodeType::Mul>() || (p.Is<NodeType::Sub, NodeType::Div>() && p.Arity > 1)) {
+            auto const add = p.Is<NodeType::Add>() || p.Is<NodeType::Sub>();
+            auto const neutral = add ? Scalar{0} : Scalar{1};
+            auto const commutative = p.IsCommutative();
+
+            segments.clear();
+            auto segment = [&](std::size_t j) { return std::pair{ j - begin - out[j].Length, j - begin + 1 }; };
+
+            auto changed{false};
+            std::optional<Node> constant;
+            for (auto k = 0UL; k < roots.size(); ++k) {
+                auto const j = roots[k];
+                auto const& c = out[j];
+                if ((commutative || k > 0) && IsFixed(c, neutral)) {
+                    changed = true;
+                } else if (commutative && c.Type == p.Type && c.Value == 1 && !c.Optimize) {
+                    changed = true;
+                    auto const outer = roots;
+                    arguments(out, j, c.Arity);
+                    std::ranges::transform(roots, std::back_inserter(segments), segment);
+                    roots = outer;
+                } else if (commutative && c.IsConstant()) {
+                    if (!constant) { constant = c; continue; }
+                    auto const v = add ? constant->Value + c.Value : constant->Value * c.Value;
+                    if (!std::isfinite(v)) { segments.push_back(segment(j)); continue; }
+                    constant->Value = v;
+                    constant->Optimize = constant->Optimize || c.Optimize;
+                    changed = true;
+                } else {
+                    segments.push_back(segment(j));
+                }
+            }
+
+            // the arguments that are kept are copied to the scratch buffer only if the node changes
+            auto const size = out.size() - begin;
+            if (constant) {
+                // a constant factor is redundant with the weight of an optimized variable (unless it is zero, which would
+                // turn the variable into a constant)
+                auto it = std::ranges::find_if(segments, [&](auto const& s) {
+                    auto const& r = out[begin + s.second - 1];
+                    return r.IsVariable() && r.Optimize;
+                });
+                if (!add && constant->Value != 0 && it != segments.end()) {
+                    out[begin + it->second - 1].Value *= constant->Value;
+                    changed = true;
+                } else if (IsFixed(*constant, neutral)) {
+                    changed = true;
+                } else {
+                    segments.emplace_back(size, size + 1);
+                }
+            }
+
+            if (changed) {
+                scratch.assign(out.begin() + static_cast<int64_t>(begin), out.end());
+                if (constant) {
+                    scratch.push_back(*constant);
+                    scratch.back().Length = 0;
+                }
+                out.resize(begin);
+                for (auto const& [b, e] : segments | std::views::reverse) {
+                    out.insert(out.end(), scratch.begin() + static_cast<int64_t>(b), scratch.begin() + static_cast<int64_t>(e));
+                }
+                if (segments.empty()) {
+                    // every argument was a neutral element
+                    out.emplace_back(Node::Constant(neutral * p.Value)).Length = 0;
+                    out.back().Optimize = p.Optimize;
+                    continue;
+                }
+                p.Arity = static_cast<uint16_t>(segments.size());
+            }
+
+            if (p.Arity == 1 && (commutative || roots.size() > 1)) {
+                auto& c = out.back();
+                c.Value *= p.Value;
+                c.Optimize = c.Optimize || p.Optimize;
+                continue;
+            }
+        } else if (p.Is<NodeType::Fmin, NodeType::Fmax>() && p.Arity == 1) {
+            auto& c = out.back();
+            c.Value *= p.Value;
+            c.Optimize = c.Optimize || p.Optimize;
+            continue;
+        } else if (p.Arity == 1 && !out.back().Optimize) {
+            auto const c = out.back();
+            if (p.Is<NodeType::Sub>() && c.Is<NodeType::Sub>() && c.Arity == 1) {
+                // -(-x) = x
+                out.pop_back();
+                out.back().Value *= c.Value * p.Value;
+                out.back().Optimize = out.back().Optimize || p.Optimize;
+                continue;
+            }
+            if (p.Is<NodeType::Abs>() && (c.Is<NodeType::Abs>() || (c.Is<NodeType::Sub>() && c.Arity == 1))) {
+                // |w * |x|| = |w| * |x| and |w * -x| = |w| * |x|
+                out.pop_back();
+                p.Value *= std::abs(c.Value);
+            } else if (p.Is<NodeType::Floor, NodeType::Ceil>() && c.Is<NodeType::Floor, NodeType::Ceil>() && c.Value == 1) {
+                // the argument is already an integer
+                out.back().Value = p.Value;
+                out.back().Optimize = p.Optimize;
+                continue;
+            }
+        }
+
+        p.Length = static_cast<uint16_t>(out.size() - begin);
+        out.push_back(p);
+    }
+
+    // the nodes are replaced, so a shared buffer is not copied
+    *this = Tree(std::move(out));
+    return UpdateNodes();
+}
+
+} // namespace Operon
@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <algorithm>
+#include <bit>
+#include <mutex>
+#include <utility>
+
+#include "operon/core/contracts.hpp"
+#include "operon/core/subtree_store.hpp"
+
+namespace Operon {
+
+auto SubtreeStore::Find(Node const& node, Operon::Hash hash, Operon::Span<Id const> children) const -> Id
+{
+    auto it = index_.find(hash);
+    if (it == index_.end()) { return None; }
+
+    CompactNode const c{node};
+    for (auto id = it->second; id != None; id = entries_[id].Next) {
+        auto const& e = entries_[id];
+        // the values are compared bitwise, so that the NaN coefficients are interned as well
+        auto const same = e.Node.HashValue == c.HashValue && e.Node.Arity == c.Arity && e.Node.Type == c.Type
+            && e.Node.Lag == c.Lag && std::bit_cast<Operon::Hash>(static_cast<double>(e.Node.Value)) == std::bit_cast<Operon::Hash>(static_cast<double>(c.Value));
+        if (same && std::equal(children.begin(), children.end(), children_.begin() + e.Children)) {
+            return id;
+        }
+    }
+    return None;
+}
+
+auto SubtreeStore::Intern(Tree const& tree) -> Id
+{
+    EXPECT(!tree.Empty());
+    (void) tree.Hash(Operon::HashMode::Strict);
+    auto const& nodes = tree.Nodes();
+
+    std::vector<Id> ids(nodes.size());
+    std::vector<Id> children;
+
+    std::unique_lock lock(mutex_);
+    for (auto i = 0UL; i < nodes.size(); ++i) {
+        auto const& n = nodes[i];
+        children.clear();
+        if (!n.IsLeaf()) {
+            for (auto j : tree.Indices(i)) { children.push_back(ids[j]); }
+        }
+
+        auto const hash = n.CalculatedHashValue;
+        auto id = Find(n, hash, children);
+        if (id == None) {
+            ENSURE(entries_.size() < None);
+            id = static_cast<Id>(entries_.size());
+            auto [it, inserted] = index_.try_emplace(hash, id);
+            auto const next = inserted ? None : std::exchange(it->second, id);
+            entries_.push_back({ CompactNode{n}, hash, n.Length + 1U, static_cast<uint32_t>(children_.size()), next });
+            children_.insert(children_.end(), children.begin(), children.end());
+        }
+        ids[i] = id;
+    }
+    return ids.back();
+}
+
+auto SubtreeStore::Expand(Id id, Operon::Vector<Node>& nodes) const -> void
+{
+    auto const& e = entries_[id];
+    // the first child is the closest to its parent in postfix order
+    for (auto k = e.Node.Arity; k > 0; --k) {
+        Expand(children_[e.Children + k - 1], nodes);
+    }
+    nodes.push_back(e.Node.ToNode());
+    nodes.back().CalculatedHashValue = e.HashValue;
+}
+
+auto SubtreeStore::ToTree(Id id) const -> Tree
+{
+    std::shared_lock lock(mutex_);
+    EXPECT(id < entries_.size());
+    auto nodes = NodeArena::Acquire(entries_[id].Length);
+    Expand(id, nodes);
+    Tree tree(std::move(nodes));
+    tree.UpdateNodes();
+    return tree;
+}
+
+auto SubtreeStore::HashValue(Id id) const -> Operon::Hash
+{
+    std::shared_lock lock(mutex_);
+    EXPECT(id < entries_.size());
+    return entries_[id].HashValue;
+}
+
+auto SubtreeStore::Length(Id id) const -> std::size_t
+{
+    std::shared_lock lock(mutex_);
+    EXPECT(id < entries_.size());
+    return entries_[id].Length;
+}
+
+auto SubtreeStore::Size() const -> std::size_t
+{
+    std::shared_lock lock(mutex_);
+    return entries_.size();
+}
+
+auto SubtreeStore::Clear() -> void
+{
+    std::unique_lock lock(mutex_);
+    entries_.clear();
+    children_.clear();
+    index_.clear();
+}
+
+} // namespace Operon
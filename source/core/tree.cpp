@@ -8,6 +8,7 @@
 #include <functional>
 #include <iterator>
 #include <span>
+#include <utility>
 #include <vector>
 
 #include "operon/core/tree.hpp"
@@ -19,8 +20,9 @@
 namespace Operon {
 auto Tree::UpdateNodes() -> Tree&
 {
-    for (size_t i = 0; i < nodes_.size(); ++i) {
-        auto& s = nodes_[i];
+    auto& nodes = Own();
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        auto& s = nodes[i];
 
         s.Depth = 1;
         s.Length = s.Arity;
@@ -30,7 +32,7 @@ auto Tree::UpdateNodes() -> Tree&
             continue;
         }
 
-        for (auto& p : Tree::Nodes(nodes_, i)) {
+        for (auto& p : Tree::Nodes(nodes, i)) {
             s.Length += p.Length;
             s.Depth = std::max(s.Depth, p.Depth);
             p.Parent = i;
@@ -38,10 +40,10 @@ auto Tree::UpdateNodes() -> Tree&
 
         ++s.Depth;
     }
-    nodes_.back().Level = 1;
+    nodes.back().Level = 1;
 
-    for (auto it = nodes_.rbegin() + 1; it < nodes_.rend(); ++it) {
-        it->Level = static_cast<uint16_t>(nodes_[it->Parent].Level + 1);
+    for (auto it = nodes.rbegin() + 1; it < nodes.rend(); ++it) {
+        it->Level = static_cast<uint16_t>(nodes[it->Parent].Level + 1);
     }
 
     return *this;
@@ -49,9 +51,10 @@ auto Tree::UpdateNodes() -> Tree&
 
 auto Tree::Reduce() -> Tree&
 {
+    auto& nodes = Own();
     bool reduced = false;
-    for (size_t i = 0; i < nodes_.size(); ++i) {
-        auto& s = nodes_[i];
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        auto& s = nodes[i];
         if (s.IsLeaf() || !s.IsCommutative()) {
             continue;
         }
@@ -68,7 +71,7 @@ auto Tree::Reduce() -> Tree&
 
     // if anything was reduced (nodes were disabled), copy remaining enabled nodes
     if (reduced) {
-        std::erase_if(nodes_, [](auto const& n) { return !n.IsEnabled; });
+        std::erase_if(nodes, [](auto const& n) { return !n.IsEnabled; });
     }
     // else, nothing to do
     return this->UpdateNodes();
@@ -79,16 +82,17 @@ auto Tree::Reduce() -> Tree&
 // - this method assumes node hashes are computed, usually it is preceded by a call to tree.Hash()
 auto Tree::Sort() -> Tree&
 {
+    auto& nodes = Own();
     // preallocate memory to reduce fragmentation
-    Operon::Vector<Operon::Node> sorted = nodes_;
+    Operon::Vector<Operon::Node> sorted = nodes;
 
     Operon::Vector<size_t> children;
-    children.reserve(nodes_.size());
+    children.reserve(nodes.size());
 
-    auto start = nodes_.begin();
+    auto start = nodes.begin();
 
-    for (size_t i = 0; i < nodes_.size(); ++i) {
-        auto& s = nodes_[i];
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        auto& s = nodes[i];
 
         if (s.IsLeaf()) {
             continue;
@@ -102,11 +106,11 @@ auto Tree::Sort() -> Tree&
                 std::stable_sort(start + i - size, start + i); // NOLINT
             } else {
                 std::ranges::copy(Indices(i), std::back_inserter(children));
-                std::stable_sort(children.begin(), children.end(), [&](auto a, auto b) { return nodes_[a] < nodes_[b]; }); // sort child indices
+                std::stable_sort(children.begin(), children.end(), [&](auto a, auto b) { return nodes[a] < nodes[b]; }); // sort child indices
 
                 auto pos = sorted.begin() + i - size; // NOLINT
                 for (auto j : children) {
-                    auto& c = nodes_[j];
+                    auto& c = nodes[j];
                     std::copy_n(start + static_cast<int64_t>(j) - c.Length, c.Length + 1, pos);
                     pos += c.Length + 1;
                 }
@@ -114,14 +118,15 @@ auto Tree::Sort() -> Tree&
             }
         }
     }
-    nodes_.swap(sorted);
+    nodes.swap(sorted);
     return this->UpdateNodes();
 }
 
 auto Tree::GetCoefficients() const -> std::vector<Operon::Scalar>
 {
+    auto const& nodes = Buffer();
     std::vector<Operon::Scalar> coefficients;
-    for (auto const& n : nodes_) {
+    for (auto const& n : nodes) {
         if (n.Optimize) {
             coefficients.push_back(n.Value);
         }
@@ -129,59 +134,188 @@ auto Tree::GetCoefficients() const -> std::vector<Operon::Scalar>
     return coefficients;
 }
 
+auto Tree::GetCoefficients(Operon::Span<Operon::Scalar> coefficients) const -> Operon::Span<Operon::Scalar>
+{
+    auto const& nodes = Buffer();
+    size_t idx = 0;
+    for (auto const& n : nodes) {
+        if (n.Optimize) {
+            EXPECT(idx < coefficients.size());
+            coefficients[idx++] = n.Value;
+        }
+    }
+    return coefficients.first(idx);
+}
+
+auto Tree::GetCoefficients(std::vector<Operon::Scalar>& coefficients) const -> Operon::Span<Operon::Scalar>
+{
+    coefficients.resize(static_cast<size_t>(CoefficientsCount()));
+    return GetCoefficients(Operon::Span<Operon::Scalar>{coefficients});
+}
+
 void Tree::SetCoefficients(Operon::Span<Operon::Scalar const> coefficients)
 {
+    auto& nodes = Own();
     size_t idx = 0;
-    for (auto& s : nodes_) {
+    for (auto& s : nodes) {
         if (s.Optimize) { s.Value = coefficients[idx++]; }
     }
 }
 
 auto Tree::Depth() const noexcept -> size_t
 {
-    return Empty() ? 0 : nodes_.back().Depth;
+    auto const& nodes = Buffer();
+    return Empty() ? 0 : nodes.back().Depth;
 }
 
 auto Tree::VisitationLength() const noexcept -> size_t
 {
-    return std::transform_reduce(nodes_.begin(), nodes_.end(), 0UL, std::plus<> {}, [](const auto& node) { return node.Length + 1; });
+    auto const& nodes = Buffer();
+    return std::transform_reduce(nodes.begin(), nodes.end(), 0UL, std::plus<> {}, [](const auto& node) { return node.Length + 1; });
 }
 
+namespace {
+    // computes the hash value of node i from the (already computed) hash values of its children
+    // - the children are found by walking back over the subtree lengths and their hash values are gathered in a
+    //   per-thread buffer, so hashing does not allocate once the buffer has grown to the largest arity
+    // - the children of commutative nodes are ordered with an insertion sort (stable, and arities are small)
+    struct NodeHasher {
+        Tree const& Nodes; // NOLINT
+        Operon::HashMode Mode;
+        Operon::Hasher Hasher;
+
+        struct Buffer {
+            std::vector<std::pair<Operon::Hash, Operon::Hash>> Keys;
+            std::vector<Operon::Hash> Hashes;
+        };
+
+        static auto GetBuffer() -> Buffer& {
+            thread_local Buffer buffer;
+            return buffer;
+        }
+
+        auto operator()(size_t i) const -> void
+        {
+            auto const& n = Nodes[i];
+
+            if (n.IsLeaf()) {
+                n.CalculatedHashValue = n.HashValue;
+                if (n.Lag != 0) {
+                    n.CalculatedHashValue ^= Hasher(&n.Lag, sizeof(n.Lag));
+                }
+                if (Mode == Operon::HashMode::Strict) {
+                    n.CalculatedHashValue += Hasher(std::bit_cast<uint8_t const*>(&n.Value), sizeof(n.Value));
+                }
+                return;
+            }
+
+            // the (HashValue, CalculatedHashValue) keys of the children
+            auto& [keys, hashes] = GetBuffer();
+            keys.resize(n.Arity);
+            for (auto k = 0UL, j = i - 1; k < n.Arity; ++k, j -= Nodes[j].Length + 1UL) {
+                keys[k] = { Nodes[j].HashValue, Nodes[j].CalculatedHashValue };
+            }
+            if (n.IsCommutative()) {
+                for (auto k = 1UL; k < keys.size(); ++k) {
+                    auto const key = keys[k];
+                    auto m = k;
+                    for (; m > 0 && key < keys[m - 1]; --m) { keys[m] = keys[m - 1]; }
+                    keys[m] = key;
+                }
+            }
+
+            hashes.resize(n.Arity + 1UL);
+            std::ranges::transform(keys, hashes.begin(), [](auto const& key) { return key.second; });
+            hashes.back() = n.HashValue;
+            n.CalculatedHashValue = Hasher(std::bit_cast<uint8_t const*>(hashes.data()), sizeof(Operon::Hash) * hashes.size());
+        }
+    };
+} // namespace
+
 auto Tree::Hash(Operon::HashMode mode) const -> Tree const&
 {
-    std::vector<size_t> childIndices;
-    childIndices.reserve(nodes_.size());
+    Detach();
+    auto const& nodes = Buffer();
+    NodeHasher const hash{ *this, mode, {} };
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        hash(i);
+    }
+    return *this;
+}
 
-    std::vector<Operon::Hash> hashes;
-    hashes.reserve(nodes_.size());
+auto Tree::Hash(Operon::HashMode mode, size_t i) const -> Tree const&
+{
+    Detach();
+    auto const& nodes = Buffer();
+    EXPECT(i < nodes.size());
+    NodeHasher const hash{ *this, mode, {} };
+
+    // the subtree rooted at i, then the path from i to the root
+    for (auto j = i - nodes[i].Length; j <= i; ++j) {
+        hash(j);
+    }
+    for (auto j = i; j + 1 < nodes.size();) {
+        j = nodes[j].Parent;
+        hash(j);
+    }
 
-    Operon::Hasher hasher;
+    return *this;
+}
 
-    for (size_t i = 0; i < nodes_.size(); ++i) {
-        auto const& n = nodes_[i];
+auto Tree::UpdateNodes(size_t begin, size_t removed, size_t inserted, size_t parent) -> Tree&
+{
+    auto& nodes = Own();
+    auto const end = begin + inserted;
+    EXPECT(end <= nodes.size());
+    if (inserted == nodes.size()) {
+        // the spliced subtree is the whole tree
+        return UpdateNodes();
+    }
+    EXPECT(end <= parent && parent < nodes.size());
 
-        if (n.IsLeaf()) {
-            n.CalculatedHashValue = n.HashValue;
-            if (mode == Operon::HashMode::Strict) {
-                n.CalculatedHashValue += hasher(std::bit_cast<uint8_t const*>(&n.Value), sizeof(n.Value));
-            }
-            continue;
+    // the spliced nodes: their subtrees are contained in the spliced region
+    for (auto i = begin; i < end; ++i) {
+        auto& s = nodes[i];
+        s.Depth = 1;
+        s.Length = s.Arity;
+        if (s.IsLeaf()) { continue; }
+        for (auto& p : Tree::Nodes(nodes, i)) {
+            s.Length += p.Length;
+            s.Depth = std::max(s.Depth, p.Depth);
+            p.Parent = i;
         }
+        ++s.Depth;
+    }
 
-        std::ranges::copy(Indices(i), std::back_inserter(childIndices));
-
-        auto begin = childIndices.begin();
-        auto end = begin + n.Arity;
+    // the nodes after the spliced region are shifted (the root keeps its parent index of zero)
+    using Signed = std::make_signed_t<size_t>;
+    auto const shift = static_cast<Signed>(inserted) - static_cast<Signed>(removed);
+    if (shift != 0) {
+        for (auto i = end; i + 1 < nodes.size(); ++i) {
+            nodes[i].Parent = static_cast<uint16_t>(static_cast<Signed>(nodes[i].Parent) + shift);
+        }
+    }
 
-        if (n.IsCommutative()) {
-            std::stable_sort(begin, end, [&](auto a, auto b) { return nodes_[a] < nodes_[b]; });
+    // the ancestors of the spliced region and the parent index of their children
+    for (auto i = parent;; i = nodes[i].Parent) {
+        auto& s = nodes[i];
+        s.Depth = 1;
+        s.Length = s.Arity;
+        if (!s.IsLeaf()) {
+            for (auto& p : Tree::Nodes(nodes, i)) {
+                s.Length += p.Length;
+                s.Depth = std::max(s.Depth, p.Depth);
+                p.Parent = static_cast<uint16_t>(i);
+            }
+            ++s.Depth;
         }
-        std::transform(begin, end, std::back_inserter(hashes), [&](auto j) { return nodes_[j].CalculatedHashValue; });
-        hashes.push_back(n.HashValue);
+        if (i + 1 == nodes.size()) { break; }
+    }
 
-        n.CalculatedHashValue = hasher(std::bit_cast<uint8_t*>(hashes.data()), sizeof(Operon::Hash) * hashes.size()); // NOLINT
-        childIndices.clear();
-        hashes.clear();
+    // only the levels of the spliced nodes change
+    for (auto i = end; i > begin; --i) {
+        auto& s = nodes[i - 1];
+        s.Level = static_cast<uint16_t>(nodes[s.Parent].Level + 1);
     }
 
     return *this;
@@ -0,0 +1,259 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include "operon/error_metrics/vectorized.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+
+#include <eve/module/core.hpp>
+#include <eve/wide.hpp>
+
+#include "operon/core/contracts.hpp"
+
+namespace Operon::Vectorized {
+
+namespace {
+    constexpr std::size_t Unroll{4}; // independent accumulators per term
+    constexpr std::size_t FlushBlocks{256}; // unrolled blocks accumulated in registers before flushing to double precision
+
+    template<typename V>
+    auto Abs(V v) {
+        if constexpr (std::is_arithmetic_v<V>) { return std::abs(v); } else { return eve::abs(v); }
+    }
+
+    // broadcasts a double precision value to the type of the operands (scalar or register)
+    template<typename V>
+    auto Broadcast(double v) -> V {
+        if constexpr (std::is_arithmetic_v<V>) { return static_cast<V>(v); } else { return V{static_cast<typename V::value_type>(v)}; }
+    }
+
+    // sums the K terms returned by f over the rows of the data
+    // - f is called with registers loaded from each pointer in data, the remaining rows are passed as doubles
+    template<std::size_t K, typename T, typename F, typename... Ptr>
+    auto Reduce(std::size_t n, F&& f, Ptr... data) -> std::array<double, K>
+    {
+        using W = eve::wide<T>;
+        constexpr auto S { static_cast<std::size_t>(W::size()) };
+        constexpr auto B { S * Unroll };
+
+        std::array<double, K> sum{};
+        std::size_t i{0};
+        while (n - i >= B) {
+            auto const end { i + std::min((n - i) / B, FlushBlocks) * B };
+
+            std::array<std::array<W, K>, Unroll> acc;
+            for (auto& a : acc) { a.fill(W{T{0}}); }
+            for (; i < end; i += B) {
+                for (auto u = 0UL; u < Unroll; ++u) {
+                    auto const terms = std::invoke(f, W{data + i + u * S}...);
+                    for (auto k = 0UL; k < K; ++k) { acc[u][k] += terms[k]; }
+                }
+            }
+
+            std::array<T, S> lanes;
+            for (auto const& a : acc) {
+                for (auto k = 0UL; k < K; ++k) {
+                    eve::store(a[k], lanes.data());
+                    sum[k] = std::accumulate(lanes.begin(), lanes.end(), sum[k]);
+                }
+            }
+        }
+
+        for (; i < n; ++i) {
+            auto const terms = std::invoke(f, static_cast<double>(data[i])...);
+            for (auto k = 0UL; k < K; ++k) { sum[k] += terms[k]; }
+        }
+        return sum;
+    }
+} // namespace
+
+template<typename T>
+auto SumOfSquaredErrors(Operon::Span<T const> x, Operon::Span<T const> y) noexcept -> double
+{
+    EXPECT(x.size() == y.size());
+    auto const [sse] = Reduce<1, T>(x.size(), [](auto a, auto b) { auto const e = a - b; return std::array{e * e}; }, x.data(), y.data());
+    return sse;
+}
+
+template<typename T>
+auto SumOfSquaredErrors(Operon::Span<T const> x, Operon::Span<T const> y, Operon::Span<T const> w) noexcept -> double
+{
+    EXPECT(x.size() == y.size() && x.size() == w.size());
+    auto const [sse] = Reduce<1, T>(x.size(), [](auto a, auto b, auto c) { auto const e = a - b; return std::array{c * e * e}; }, x.data(), y.data(), w.data());
+    return sse;
+}
+
+template<typename T>
+auto MeanSquaredError(Operon::Span<T const> x, Operon::Span<T const> y) noexcept -> double
+{
+    EXPECT(!x.empty());
+    return SumOfSquaredErrors(x, y) / static_cast<double>(x.size());
+}
+
+template<typename T>
+auto MeanSquaredError(Operon::Span<T const> x, Operon::Span<T const> y, Operon::Span<T const> w) noexcept -> double
+{
+    EXPECT(!x.empty());
+    EXPECT(x.size() == y.size() && x.size() == w.size());
+    auto const [sse, sw] = Reduce<2, T>(x.size(), [](auto a, auto b, auto c) { auto const e = a - b; return std::array{c * e * e, c}; }, x.data(), y.data(), w.data());
+    return sse / sw;
+}
+
+template<typename T>
+auto RootMeanSquaredError(Operon::Span<T const> x, Operon::Span<T const> y) noexcept -> double
+{
+    return std::sqrt(MeanSquaredError(x, y));
+}
+
+template<typename T>
+auto RootMeanSquaredError(Operon::Span<T const> x, Operon::Span<T const> y, Operon::Span<T const> w) noexcept -> double
+{
+    return std::sqrt(MeanSquaredError(x, y, w));
+}
+
+template<typename T>
+auto MeanAbsoluteError(Operon::Span<T const> x, Operon::Span<T const> y) noexcept -> double
+{
+    EXPECT(!x.empty());
+    EXPECT(x.size() == y.size());
+    auto const [sae] = Reduce<1, T>(x.size(), [](auto a, auto b) { return std::array{Abs(a - b)}; }, x.data(), y.data());
+    return sae / static_cast<double>(x.size());
+}
+
+template<typename T>
+auto MeanAbsoluteError(Operon::Span<T const> x, Operon::Span<T const> y, Operon::Span<T const> w) noexcept -> double
+{
+    EXPECT(!x.empty());
+    EXPECT(x.size() == y.size() && x.size() == w.size());
+    auto const [sae, sw] = Reduce<2, T>(x.size(), [](auto a, auto b, auto c) { return std::array{c * Abs(a - b), c}; }, x.data(), y.data(), w.data());
+    return sae / sw;
+}
+
+namespace {
+    // sum of squared errors and sum of squared deviations of the target from its mean
+    template<typename T>
+    auto ErrorAndTotalSums(Operon::Span<T const> x, Operon::Span<T const> y) -> std::pair<double, double>
+    {
+        EXPECT(!x.empty());
+        EXPECT(x.size() == y.size());
+        auto const [sy] = Reduce<1, T>(y.size(), [](auto b) { return std::array{b}; }, y.data());
+        auto const my { sy / static_cast<double>(y.size()) };
+        auto const [sse, sst] = Reduce<2, T>(x.size(), [my](auto a, auto b) {
+            auto const e = a - b;
+            auto const d = b - Broadcast<decltype(b)>(my);
+            return std::array{e * e, d * d};
+        }, x.data(), y.data());
+        return {sse, sst};
+    }
+
+    template<typename T>
+    auto ErrorAndTotalSums(Operon::Span<T const> x, Operon::Span<T const> y, Operon::Span<T const> w) -> std::pair<double, double>
+    {
+        EXPECT(!x.empty());
+        EXPECT(x.size() == y.size() && x.size() == w.size());
+        auto const [swy, sw] = Reduce<2, T>(y.size(), [](auto b, auto c) { return std::array{c * b, c}; }, y.data(), w.data());
+        auto const my { swy / sw };
+        auto const [sse, sst] = Reduce<2, T>(x.size(), [my](auto a, auto b, auto c) {
+            auto const e = a - b;
+            auto const d = b - Broadcast<decltype(b)>(my);
+            return std::array{c * e * e, c * d * d};
+        }, x.data(), y.data(), w.data());
+        return {sse, sst};
+    }
+
+    // centered sums of squares and products of x and y
+    template<typename T>
+    auto CenteredSums(Operon::Span<T const> x, Operon::Span<T const> y) -> std::array<double, 3>
+    {
+        EXPECT(!x.empty());
+        EXPECT(x.size() == y.size());
+        auto const n { static_cast<double>(x.size()) };
+        auto const [sx, sy] = Reduce<2, T>(x.size(), [](auto a, auto b) { return std::array{a, b}; }, x.data(), y.data());
+        return Reduce<3, T>(x.size(), [mx = sx / n, my = sy / n](auto a, auto b) {
+            auto const dx = a - Broadcast<decltype(a)>(mx);
+            auto const dy = b - Broadcast<decltype(b)>(my);
+            return std::array{dx * dx, dy * dy, dx * dy};
+        }, x.data(), y.data());
+    }
+
+    template<typename T>
+    auto CenteredSums(Operon::Span<T const> x, Operon::Span<T const> y, Operon::Span<T const> w) -> std::array<double, 3>
+    {
+        EXPECT(!x.empty());
+        EXPECT(x.size() == y.size() && x.size() == w.size());
+        auto const [swx, swy, sw] = Reduce<3, T>(x.size(), [](auto a, auto b, auto c) { return std::array{c * a, c * b, c}; }, x.data(), y.data(), w.data());
+        return Reduce<3, T>(x.size(), [mx = swx / sw, my = swy / sw](auto a, auto b, auto c) {
+            auto const dx = a - Broadcast<decltype(a)>(mx);
+            auto const dy = b - Broadcast<decltype(b)>(my);
+            return std::array{c * dx * dx, c * dy * dy, c * dx * dy};
+        }, x.data(), y.data(), w.data());
+    }
+} // namespace
+
+template<typename T>
+auto NormalizedMeanSquaredError(Operon::Span<T const> x, Operon::Span<T const> y) noexcept -> double
+{
+    auto const [sse, sst] = ErrorAndTotalSums(x, y);
+    return sst > 0 ? sse / sst : 0.0;
+}
+
+template<typename T>
+auto NormalizedMeanSquaredError(Operon::Span<T const> x, Operon::Span<T const> y, Operon::Span<T const> w) noexcept -> double
+{
+    auto const [sse, sst] = ErrorAndTotalSums(x, y, w);
+    return sst > 0 ? sse / sst : 0.0;
+}
+
+template<typename T>
+auto R2Score(Operon::Span<T const> x, Operon::Span<T const> y) noexcept -> double
+{
+    auto const [sse, sst] = ErrorAndTotalSums(x, y);
+    if (sst < std::numeric_limits<double>::epsilon()) { return std::numeric_limits<double>::lowest(); }
+    return 1.0 - sse / sst;
+}
+
+template<typename T>
+auto R2Score(Operon::Span<T const> x, Operon::Span<T const> y, Operon::Span<T const> w) noexcept -> double
+{
+    auto const [sse, sst] = ErrorAndTotalSums(x, y, w);
+    if (sst < std::numeric_limits<double>::epsilon()) { return std::numeric_limits<double>::lowest(); }
+    return 1.0 - sse / sst;
+}
+
+template<typename T>
+auto CorrelationCoefficient(Operon::Span<T const> x, Operon::Span<T const> y) noexcept -> double
+{
+    auto const [sxx, syy, sxy] = CenteredSums(x, y);
+    return sxy / std::sqrt(sxx * syy);
+}
+
+template<typename T>
+auto CorrelationCoefficient(Operon::Span<T const> x, Operon::Span<T const> y, Operon::Span<T const> w) noexcept -> double
+{
+    auto const [sxx, syy, sxy] = CenteredSums(x, y, w);
+    return sxy / std::sqrt(sxx * syy);
+}
+
+#define OPERON_VECTORIZED_METRIC(name) \
+    template auto OPERON_EXPORT name<float>(Operon::Span<float const>, Operon::Span<float const>) noexcept -> double; \
+    template auto OPERON_EXPORT name<float>(Operon::Span<float const>, Operon::Span<float const>, Operon::Span<float const>) noexcept -> double; \
+    template auto OPERON_EXPORT name<double>(Operon::Span<double const>, Operon::Span<double const>) noexcept -> double; \
+    template auto OPERON_EXPORT name<double>(Operon::Span<double const>, Operon::Span<double const>, Operon::Span<double const>) noexcept -> double;
+
+OPERON_VECTORIZED_METRIC(SumOfSquaredErrors)
+OPERON_VECTORIZED_METRIC(MeanSquaredError)
+OPERON_VECTORIZED_METRIC(RootMeanSquaredError)
+OPERON_VECTORIZED_METRIC(NormalizedMeanSquaredError)
+OPERON_VECTORIZED_METRIC(MeanAbsoluteError)
+OPERON_VECTORIZED_METRIC(R2Score)
+OPERON_VECTORIZED_METRIC(CorrelationCoefficient)
+
+#undef OPERON_VECTORIZED_METRIC
+
+} // namespace Operon::Vectorized
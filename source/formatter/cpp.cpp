@@ -0,0 +1,201 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <algorithm>
+#include <fmt/format.h>
+
+#include "operon/core/contracts.hpp"
+#include "operon/core/dataset.hpp"
+#include "operon/formatter/formatter.hpp"
+
+namespace Operon {
+
+namespace {
+    // constants are printed with enough digits to round-trip a double
+    auto FormatValue(Operon::Scalar value) -> std::string
+    {
+        return fmt::format("T({:.17g})", value);
+    }
+
+    constexpr char const* Includes{"#include <algorithm>\n#include <cmath>\n#include <cstddef>\n\n"};
+} // namespace
+
+auto CppFormatter::FormatNode(Tree const& tree, Operon::Vector<Operon::Hash> const& inputs, size_t i, std::string& current) -> void
+{
+    auto const& s = tree[i];
+    auto out = std::back_inserter(current);
+
+    if (s.IsConstant()) {
+        fmt::format_to(out, "{}", FormatValue(s.Value));
+        return;
+    }
+    if (s.IsVariable()) {
+        auto it = std::find(inputs.begin(), inputs.end(), s.HashValue);
+        ENSURE(it != inputs.end());
+        if (s.Lag == 0) {
+            fmt::format_to(out, "({} * x{}[i])", FormatValue(s.Value), std::distance(inputs.begin(), it));
+        } else {
+            fmt::format_to(out, "({} * x{}[i - {}])", FormatValue(s.Value), std::distance(inputs.begin(), it), s.Lag);
+        }
+        return;
+    }
+
+    if (s.Value != 1) {
+        fmt::format_to(out, "({} * ", FormatValue(s.Value));
+    }
+
+    auto const formatArgs = [&](std::string_view sep) {
+        size_t count = 0;
+        for (auto j : tree.Indices(i)) {
+            FormatNode(tree, inputs, j, current);
+            if (++count < s.Arity) { fmt::format_to(out, "{}", sep); }
+        }
+    };
+
+    switch (s.Type) {
+    case NodeType::Add:
+    case NodeType::Mul: {
+        fmt::format_to(out, "(");
+        formatArgs(s.Type == NodeType::Add ? " + " : " * ");
+        fmt::format_to(out, ")");
+        break;
+    }
+    case NodeType::Sub:
+    case NodeType::Div: {
+        // a - (b + c + ...) and a / (b * c * ...) are the same as a - b - c - ... and a / b / c / ...
+        // - with a single argument they are a negation -a and an inversion 1 / a
+        if (s.Arity == 1) {
+            fmt::format_to(out, "{}", s.Type == NodeType::Sub ? "(-" : "(T(1) / ");
+            FormatNode(tree, inputs, i - 1, current);
+            fmt::format_to(out, ")");
+        } else {
+            fmt::format_to(out, "(");
+            formatArgs(s.Type == NodeType::Sub ? " - " : " / ");
+            fmt::format_to(out, ")");
+        }
+        break;
+    }
+    case NodeType::Fmin:
+    case NodeType::Fmax: {
+        fmt::format_to(out, "std::{}<T>({{", s.Type == NodeType::Fmin ? "min" : "max");
+        formatArgs(", ");
+        fmt::format_to(out, "}})");
+        break;
+    }
+    case NodeType::Aq: {
+        // aq(a, b) = a / sqrt(1 + b^2)
+        auto j = i - 1;
+        auto k = j - tree[j].Length - 1;
+        fmt::format_to(out, "(");
+        FormatNode(tree, inputs, j, current);
+        fmt::format_to(out, " / std::sqrt(T(1) + std::pow(");
+        FormatNode(tree, inputs, k, current);
+        fmt::format_to(out, ", T(2))))");
+        break;
+    }
+    case NodeType::Pow: {
+        fmt::format_to(out, "std::pow(");
+        formatArgs(", ");
+        fmt::format_to(out, ")");
+        break;
+    }
+    case NodeType::Square: {
+        fmt::format_to(out, "std::pow(");
+        FormatNode(tree, inputs, i - 1, current);
+        fmt::format_to(out, ", T(2))");
+        break;
+    }
+    case NodeType::Logabs:
+    case NodeType::Sqrtabs: {
+        fmt::format_to(out, "std::{}(std::abs(", s.Type == NodeType::Logabs ? "log" : "sqrt");
+        FormatNode(tree, inputs, i - 1, current);
+        fmt::format_to(out, "))");
+        break;
+    }
+    case NodeType::Dynamic: {
+        throw std::runtime_error(fmt::format("Node {} (hash {}) cannot be translated to C++ code.\n", s.Name(), s.HashValue));
+    }
+    default: {
+        // the remaining unary functions have the same name as in the standard library
+        fmt::format_to(out, "std::{}(", s.Name());
+        FormatNode(tree, inputs, i - 1, current);
+        fmt::format_to(out, ")");
+    }
+    }
+
+    if (s.Value != 1) {
+        fmt::format_to(out, ")");
+    }
+}
+
+auto CppFormatter::Inputs(Tree const& tree) -> Operon::Vector<Operon::Hash>
+{
+    Operon::Vector<Operon::Hash> inputs;
+    for (auto const& node : tree.Nodes()) {
+        if (node.IsVariable() && std::find(inputs.begin(), inputs.end(), node.HashValue) == inputs.end()) {
+            inputs.push_back(node.HashValue);
+        }
+    }
+    return inputs;
+}
+
+auto CppFormatter::FormatFunction(Tree const& tree, Operon::Map<Operon::Hash, std::string> const& variableNames, std::string const& name, std::string& current) -> void
+{
+    auto const inputs = Inputs(tree);
+    auto out = std::back_inserter(current);
+
+    fmt::format_to(out, "// inputs:\n");
+    for (auto k = 0UL; k < inputs.size(); ++k) {
+        auto it = variableNames.find(inputs[k]);
+        if (it == variableNames.end()) {
+            throw std::runtime_error(fmt::format("A key with hash value {} could not be found in the variable map.\n", inputs[k]));
+        }
+        fmt::format_to(out, "// - x[{}]: {}\n", k, it->second);
+    }
+
+    fmt::format_to(out, "template<typename T>\ninline auto {}(T const* const* x, T* out, std::size_t n) -> void\n{{\n", name);
+    for (auto k = 0UL; k < inputs.size(); ++k) {
+        fmt::format_to(out, "    T const* x{0} = x[{0}];\n", k);
+    }
+    if (inputs.empty()) {
+        fmt::format_to(out, "    static_cast<void>(x);\n");
+    }
+    fmt::format_to(out, "    for (std::size_t i = 0; i < n; ++i) {{\n        out[i] = ");
+    if (tree.Nodes().empty()) {
+        fmt::format_to(out, "T(0)");
+    } else {
+        FormatNode(tree, inputs, tree.Length() - 1, current);
+    }
+    fmt::format_to(out, ";\n    }}\n}}\n");
+}
+
+auto CppFormatter::Format(Tree const& tree, Operon::Map<Operon::Hash, std::string> const& variableNames, std::string const& name) -> std::string
+{
+    std::string result{Includes};
+    FormatFunction(tree, variableNames, name, result);
+    return result;
+}
+
+auto CppFormatter::FormatModule(Operon::Span<Tree const> trees, Operon::Map<Operon::Hash, std::string> const& variableNames, std::string const& name) -> std::string
+{
+    auto const* scalar = sizeof(Operon::Scalar) == sizeof(float) ? "float" : "double";
+    std::string result{Includes};
+    auto out = std::back_inserter(result);
+    for (auto i = 0UL; i < trees.size(); ++i) {
+        auto const function = fmt::format("{}_{}", name, i);
+        FormatFunction(trees[i], variableNames, function, result);
+        fmt::format_to(out, "\nextern \"C\" auto {0}_evaluate({1} const* const* x, {1}* out, std::size_t n) -> void {{ {0}<{1}>(x, out, n); }}\n\n", function, scalar);
+    }
+    return result;
+}
+
+auto CppFormatter::Format(Tree const& tree, Dataset const& dataset, std::string const& name) -> std::string
+{
+    Operon::Map<Operon::Hash, std::string> variableNames;
+    for (auto const& var : dataset.GetVariables()) {
+        variableNames.insert({ var.Hash, var.Name });
+    }
+    return Format(tree, variableNames, name);
+}
+
+} // namespace Operon
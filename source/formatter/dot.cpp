@@ -22,7 +22,7 @@ auto DotFormatter::Format(Tree const& tree, Operon::Map<Operon::Hash, std::strin
         if (s.IsVariable()) {
             auto formatString = fmt::format(fmt::runtime("({{:.{}f}} * {{}})"), decimalPrecision);
             if (auto it = variableNames.find(s.HashValue); it != variableNames.end()) {
-                return fmt::format(fmt::runtime(formatString), s.Value, it->second);
+                return fmt::format(fmt::runtime(formatString), s.Value, detail::VariableName(it->second, s));
             }
             throw std::runtime_error(fmt::format("A key with hash value {} could not be found in the variable map.\n", s.HashValue));
         }
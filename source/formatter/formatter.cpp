@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <fmt/format.h>
+#include <taskflow/taskflow.hpp>
+#include <taskflow/algorithm/for_each.hpp>
+
+#include "operon/core/dataset.hpp"
+#include "operon/core/executor.hpp"
+#include "operon/formatter/formatter.hpp"
+
+namespace Operon::detail {
+
+auto VariableNames(Dataset const& dataset) -> Operon::Map<Operon::Hash, std::string>
+{
+    Operon::Map<Operon::Hash, std::string> variableNames;
+    for (auto const& var : dataset.GetVariables()) {
+        variableNames.insert({ var.Hash, var.Name });
+    }
+    return variableNames;
+}
+
+auto FormatAll(std::size_t n, tf::Executor& executor, std::function<void(std::size_t, fmt::memory_buffer&)> const& format) -> std::vector<std::string>
+{
+    std::vector<std::string> result(n);
+    std::vector<fmt::memory_buffer> buffers(executor.num_workers());
+
+    tf::Taskflow taskflow;
+    taskflow.for_each_index(std::size_t{0}, n, std::size_t{1}, [&](auto i) {
+        auto& buffer = buffers[executor.this_worker_id()];
+        buffer.clear();
+        format(i, buffer);
+        result[i] = fmt::to_string(buffer);
+    });
+    RunTaskflow(executor, taskflow);
+    return result;
+}
+
+} // namespace Operon::detail
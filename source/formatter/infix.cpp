@@ -4,40 +4,43 @@
 #include <fmt/format.h>
 
 #include "operon/core/dataset.hpp"
+#include "operon/core/individual.hpp"
 #include "operon/formatter/formatter.hpp"
 
 namespace Operon {
 
-auto InfixFormatter::FormatNode(Tree const& tree, Operon::Map<Operon::Hash, std::string> const& variableNames, size_t i, std::string& current, int decimalPrecision) -> void
+auto InfixFormatter::FormatNode(Tree const& tree, Operon::Map<Operon::Hash, std::string> const& variableNames, size_t i, fmt::memory_buffer& current, int decimalPrecision) -> void
 {
     const auto& s = tree[i];
+    auto out = std::back_inserter(current);
     if (s.IsConstant()) {
-        auto formatString = fmt::format(fmt::runtime(s.Value < 0 ? "({{:.{}f}})" : "{{:.{}f}}"), decimalPrecision);
-        fmt::format_to(std::back_inserter(current), fmt::runtime(formatString), s.Value);
+        detail::FormatValue(current, s.Value, decimalPrecision);
     } else if (s.IsVariable()) {
-        auto formatString = fmt::format(fmt::runtime(s.Value < 0 ? "(({{:.{}f}}) * {{}})" : "({{:.{}f}} * {{}})"), decimalPrecision);
         if (auto it = variableNames.find(s.HashValue); it != variableNames.end()) {
-            fmt::format_to(std::back_inserter(current), fmt::runtime(formatString), s.Value, it->second);
+            fmt::format_to(out, "(");
+            detail::FormatValue(current, s.Value, decimalPrecision);
+            fmt::format_to(out, " * ");
+            detail::FormatVariable(current, it->second, s);
+            fmt::format_to(out, ")");
         } else {
             throw std::runtime_error(fmt::format("A key with hash value {} could not be found in the variable map.\n", s.HashValue));
         }
     } else {
         if (s.Value != 1) {
-            fmt::format_to(std::back_inserter(current), "(");
-            auto formatString = fmt::format(fmt::runtime(s.Value < 0 ? "({{:.{}f}})" : "{{:.{}f}}"), decimalPrecision);
-            fmt::format_to(std::back_inserter(current), fmt::runtime(formatString), s.Value);
-            fmt::format_to(std::back_inserter(current), " * ");
+            fmt::format_to(out, "(");
+            detail::FormatValue(current, s.Value, decimalPrecision);
+            fmt::format_to(out, " * ");
         }
         if (s.Type < NodeType::Abs) // add, sub, mul, div, aq, fmax, fmin, pow
         {
-            fmt::format_to(std::back_inserter(current), "(");
+            fmt::format_to(out, "(");
             if (s.Arity == 1) {
                 if (s.Type == NodeType::Sub) {
                     // subtraction with a single argument is a negation -x
-                    fmt::format_to(std::back_inserter(current), "-");
+                    fmt::format_to(out, "-");
                 } else if (s.Type == NodeType::Div) {
                     // division with a single argument is an inversion 1/x
-                    fmt::format_to(std::back_inserter(current), "1 / ");
+                    fmt::format_to(out, "1 / ");
                 }
                 FormatNode(tree, variableNames, i-1, current, decimalPrecision);
             } else if (s.Type == NodeType::Pow) {
@@ -45,93 +48,103 @@ auto InfixFormatter::FormatNode(Tree const& tree, Operon::Map<Operon::Hash, std:
                 auto j = i - 1;
                 auto k = j - tree[j].Length - 1;
                 FormatNode(tree, variableNames, j, current, decimalPrecision);
-                fmt::format_to(std::back_inserter(current), " ^ ");
+                fmt::format_to(out, " ^ ");
                 FormatNode(tree, variableNames, k, current, decimalPrecision);
             } else if (s.Type == NodeType::Aq) {
                 // format aq(a,b) as a / (1 + b^2)
                 auto j = i - 1;
                 auto k = j - tree[j].Length - 1;
                 FormatNode(tree, variableNames, j, current, decimalPrecision);
-                fmt::format_to(std::back_inserter(current), " / (sqrt(1 + ");
+                fmt::format_to(out, " / (sqrt(1 + ");
                 FormatNode(tree, variableNames, k, current, decimalPrecision);
-                fmt::format_to(std::back_inserter(current), " ^ 2))");
+                fmt::format_to(out, " ^ 2))");
             } else if (s.Type == NodeType::Fmin) {
                 auto j = i - 1;
                 auto k = j - tree[j].Length - 1;
-                fmt::format_to(std::back_inserter(current), "min(");
+                fmt::format_to(out, "min(");
                 FormatNode(tree, variableNames, j, current, decimalPrecision);
-                fmt::format_to(std::back_inserter(current), ", ");
+                fmt::format_to(out, ", ");
                 FormatNode(tree, variableNames, k, current, decimalPrecision);
-                fmt::format_to(std::back_inserter(current), ")");
+                fmt::format_to(out, ")");
             } else if (s.Type == NodeType::Fmax) {
                 auto j = i - 1;
                 auto k = j - tree[j].Length - 1;
-                fmt::format_to(std::back_inserter(current), "max(");
+                fmt::format_to(out, "max(");
                 FormatNode(tree, variableNames, j, current, decimalPrecision);
-                fmt::format_to(std::back_inserter(current), ", ");
+                fmt::format_to(out, ", ");
                 FormatNode(tree, variableNames, k, current, decimalPrecision);
-                fmt::format_to(std::back_inserter(current), ")");
+                fmt::format_to(out, ")");
             } else {
                 size_t count = 0;
                 for (auto j : tree.Indices(i)) {
                     FormatNode(tree, variableNames, j, current, decimalPrecision);
                     if (++count < s.Arity) {
-                        fmt::format_to(std::back_inserter(current), " {} ", s.Name());
+                        fmt::format_to(out, " {} ", s.Name());
                     }
                 }
             }
-            fmt::format_to(std::back_inserter(current), ")");
+            fmt::format_to(out, ")");
         } else { // unary operators abs, asin, ... log, exp, sin, etc.
             if (s.Type == NodeType::Square) {
                 // format square(a) as a ^ 2
-                fmt::format_to(std::back_inserter(current), "(");
+                fmt::format_to(out, "(");
                 FormatNode(tree, variableNames, i - 1, current, decimalPrecision);
-                fmt::format_to(std::back_inserter(current), " ^ 2)");
+                fmt::format_to(out, " ^ 2)");
             } else if (s.Type == NodeType::Logabs) {
                 // format logabs(a) as log(abs(a))
-                fmt::format_to(std::back_inserter(current), "log(abs(");
+                fmt::format_to(out, "log(abs(");
                 FormatNode(tree, variableNames, i - 1, current, decimalPrecision);
-                fmt::format_to(std::back_inserter(current), "))");
+                fmt::format_to(out, "))");
             } else if (s.Type == NodeType::Log1p) {
                 // format log1p(a) as log(a+1)
-                fmt::format_to(std::back_inserter(current), "log(");
+                fmt::format_to(out, "log(");
                 FormatNode(tree, variableNames, i - 1, current, decimalPrecision);
-                fmt::format_to(std::back_inserter(current), "+1)");
+                fmt::format_to(out, "+1)");
             } else if (s.Type == NodeType::Sqrtabs) {
                 // format sqrtabs(a) as sqrt(abs(a))
-                fmt::format_to(std::back_inserter(current), "sqrt(abs(");
+                fmt::format_to(out, "sqrt(abs(");
                 FormatNode(tree, variableNames, i - 1, current, decimalPrecision);
-                fmt::format_to(std::back_inserter(current), "))");
+                fmt::format_to(out, "))");
             } else {
-                fmt::format_to(std::back_inserter(current), "{}", s.Name());
-                fmt::format_to(std::back_inserter(current), "(");
+                fmt::format_to(out, "{}", s.Name());
+                fmt::format_to(out, "(");
                 FormatNode(tree, variableNames, i - 1, current, decimalPrecision);
-                fmt::format_to(std::back_inserter(current), ")");
+                fmt::format_to(out, ")");
             }
         }
         if (s.Value != 1) {
-            fmt::format_to(std::back_inserter(current), ")");
+            fmt::format_to(out, ")");
         }
     }
 }
 
 
+auto InfixFormatter::Format(Tree const& tree, Operon::Map<Operon::Hash, std::string> const& variableNames, fmt::memory_buffer& buffer, int decimalPrecision) -> void
+{
+    if (tree.Nodes().empty()) { return; }
+    FormatNode(tree, variableNames, tree.Length() - 1, buffer, decimalPrecision);
+}
 
 auto InfixFormatter::Format(Tree const& tree, Operon::Map<Operon::Hash, std::string> const& variableNames, int decimalPrecision) -> std::string
 {
-    if (tree.Nodes().empty()) { return std::string{}; }
-    std::string result;
-    FormatNode(tree, variableNames, tree.Length() - 1, result, decimalPrecision);
-    return { result.begin(), result.end() };
+    fmt::memory_buffer buffer;
+    Format(tree, variableNames, buffer, decimalPrecision);
+    return fmt::to_string(buffer);
 }
 
 auto InfixFormatter::Format(Tree const& tree, Dataset const& dataset, int decimalPrecision) -> std::string
 {
-    Operon::Map<Operon::Hash, std::string> variableNames;
-    for (auto const& var : dataset.GetVariables()) {
-        variableNames.insert({ var.Hash, var.Name });
-    }
-    return Format(tree, variableNames, decimalPrecision);
+    return Format(tree, detail::VariableNames(dataset), decimalPrecision);
+}
+
+auto InfixFormatter::Format(Operon::Span<Tree const> trees, Operon::Map<Operon::Hash, std::string> const& variableNames, tf::Executor& executor, int decimalPrecision) -> std::vector<std::string>
+{
+    return detail::FormatAll(trees.size(), executor, [&](auto i, auto& buffer) { Format(trees[i], variableNames, buffer, decimalPrecision); });
+}
+
+auto InfixFormatter::Format(Operon::Span<Individual const> individuals, Operon::Map<Operon::Hash, std::string> const& variableNames, tf::Executor& executor, int decimalPrecision) -> std::vector<std::string>
+{
+    return detail::FormatAll(individuals.size(), executor, [&](auto i, auto& buffer) { Format(individuals[i].Genotype, variableNames, buffer, decimalPrecision); });
 }
 
 } // namespace Operon
\ No newline at end of file
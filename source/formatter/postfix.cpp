@@ -4,57 +4,72 @@
 #include <fmt/format.h>
 
 #include "operon/core/dataset.hpp"
+#include "operon/core/individual.hpp"
 #include "operon/formatter/formatter.hpp"
 
 namespace Operon {
 
-auto PostfixFormatter::FormatNode(Tree const& tree, Operon::Map<Operon::Hash, std::string> const& variableNames, size_t i, std::string& current, int decimalPrecision) -> void
+auto PostfixFormatter::FormatNode(Tree const& tree, Operon::Map<Operon::Hash, std::string> const& variableNames, size_t i, fmt::memory_buffer& current, int decimalPrecision) -> void
 {
     auto const& s = tree[i];
+    auto out = std::back_inserter(current);
 
     switch(s.Type) {
         case NodeType::Constant: {
-            auto formatString = fmt::format(fmt::runtime(s.Value < 0 ? "({{:.{}f}})" : "{{:.{}f}}"), decimalPrecision);
-            fmt::format_to(std::back_inserter(current), fmt::runtime(formatString), s.Value);
+            detail::FormatValue(current, s.Value, decimalPrecision);
             break;
         }
         case NodeType::Variable: {
-            auto formatString = fmt::format(fmt::runtime(s.Value < 0 ? "(({{:.{}f}}) * {{}})" : "({{:.{}f}} * {{}})"), decimalPrecision);
             if (auto it = variableNames.find(s.HashValue); it != variableNames.end()) {
-                fmt::format_to(std::back_inserter(current), fmt::runtime(formatString), s.Value, it->second);
+                fmt::format_to(out, "(");
+                detail::FormatValue(current, s.Value, decimalPrecision);
+                fmt::format_to(out, " * ");
+                detail::FormatVariable(current, it->second, s);
+                fmt::format_to(out, ")");
             } else {
                 throw std::runtime_error(fmt::format("A variable with hash value {} could not be found in the dataset.\n", s.HashValue));
             }
             break;
         }
         default: {
-            fmt::format_to(std::back_inserter(current), fmt::runtime(s.Name()));
+            current.append(s.Name());
         }
     }
 }
 
 auto PostfixFormatter::Format(Tree const& tree, Dataset const& dataset, int decimalPrecision) -> std::string
 {
-    Operon::Map<Operon::Hash, std::string> variableNames;
-    for (auto const& var : dataset.GetVariables()) {
-        variableNames.insert({ var.Hash, var.Name });
-    }
-    return Format(tree, variableNames, decimalPrecision);
+    return Format(tree, detail::VariableNames(dataset), decimalPrecision);
 }
 
-auto PostfixFormatter::Format(Tree const& tree, Operon::Map<Operon::Hash, std::string> const& variableNames, int decimalPrecision) -> std::string
+auto PostfixFormatter::Format(Tree const& tree, Operon::Map<Operon::Hash, std::string> const& variableNames, fmt::memory_buffer& buffer, int decimalPrecision) -> void
 {
-    std::string result;
     for (auto i = 0UL; i < tree.Length(); ++i) {
         if (static_cast<int>(i) == tree[i].Parent - tree[tree[i].Parent].Length) {
-            fmt::format_to(std::back_inserter(result), "(");
+            buffer.push_back('(');
         }
-        FormatNode(tree, variableNames, i, result, decimalPrecision);
+        FormatNode(tree, variableNames, i, buffer, decimalPrecision);
         if (!tree[i].IsLeaf()) {
-            fmt::format_to(std::back_inserter(result), ")");
+            buffer.push_back(')');
         }
-        fmt::format_to(std::back_inserter(result), " ");
+        buffer.push_back(' ');
     }
-    return { result.begin(), result.end() };
+}
+
+auto PostfixFormatter::Format(Tree const& tree, Operon::Map<Operon::Hash, std::string> const& variableNames, int decimalPrecision) -> std::string
+{
+    fmt::memory_buffer buffer;
+    Format(tree, variableNames, buffer, decimalPrecision);
+    return fmt::to_string(buffer);
+}
+
+auto PostfixFormatter::Format(Operon::Span<Tree const> trees, Operon::Map<Operon::Hash, std::string> const& variableNames, tf::Executor& executor, int decimalPrecision) -> std::vector<std::string>
+{
+    return detail::FormatAll(trees.size(), executor, [&](auto i, auto& buffer) { Format(trees[i], variableNames, buffer, decimalPrecision); });
+}
+
+auto PostfixFormatter::Format(Operon::Span<Individual const> individuals, Operon::Map<Operon::Hash, std::string> const& variableNames, tf::Executor& executor, int decimalPrecision) -> std::vector<std::string>
+{
+    return detail::FormatAll(individuals.size(), executor, [&](auto i, auto& buffer) { Format(individuals[i].Genotype, variableNames, buffer, decimalPrecision); });
 }
 } // namespace Operon
@@ -27,7 +27,7 @@ auto TreeFormatter::FormatNode(Tree const& tree, Operon::Map<Operon::Hash, std::
         auto formatString = fmt::format(fmt::runtime(s.Value < 0 ? "({{:.{}f}}) * {{}}" : "{{:.{}f}} * {{}}"), decimalPrecision);
 
         if (auto it = variableNames.find(s.HashValue); it != variableNames.end()) {
-            fmt::format_to(std::back_inserter(current), fmt::runtime(formatString), s.Value, it->second);
+            fmt::format_to(std::back_inserter(current), fmt::runtime(formatString), s.Value, detail::VariableName(it->second, s));
         } else {
             throw std::runtime_error(fmt::format("A variable with hash value {} could not be found in the dataset.\n", s.HashValue));
         }
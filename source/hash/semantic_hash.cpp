@@ -0,0 +1,42 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include "operon/hash/semantic_hash.hpp"
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "operon/core/contracts.hpp"
+#include "operon/hash/hash.hpp"
+
+namespace Operon {
+
+auto SemanticHash(Operon::Span<Operon::Scalar const> values, int bits) -> Operon::Hash
+{
+    constexpr auto mantissa{std::numeric_limits<double>::digits - 1};
+    EXPECT(bits >= 0 && bits <= mantissa);
+
+    auto const shift = static_cast<uint64_t>(mantissa - bits);
+    auto const mask = ~((uint64_t{1} << shift) - 1);
+    auto const half = shift == 0 ? uint64_t{0} : uint64_t{1} << (shift - 1);
+
+    std::vector<uint64_t> rounded(values.size());
+    for (auto i = 0UL; i < values.size(); ++i) {
+        auto const v = static_cast<double>(values[i]);
+        if (std::isnan(v)) {
+            rounded[i] = std::bit_cast<uint64_t>(std::numeric_limits<double>::quiet_NaN());
+        } else if (v == 0 || std::isinf(v)) {
+            rounded[i] = std::bit_cast<uint64_t>(v == 0 ? 0.0 : v);
+        } else {
+            // round to nearest on the bit pattern, a carry into the exponent is the correct rounding
+            rounded[i] = (std::bit_cast<uint64_t>(v) + half) & mask;
+        }
+    }
+    auto const h = Operon::Hasher{}(std::bit_cast<uint8_t const*>(rounded.data()), rounded.size() * sizeof(uint64_t));
+    return h == 0 ? 1 : h;
+}
+
+} // namespace Operon
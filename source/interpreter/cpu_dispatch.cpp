@@ -0,0 +1,195 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include "operon/interpreter/cpu_dispatch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#ifndef OPERON_DISPATCH_BUILD_DIR
+#define OPERON_DISPATCH_BUILD_DIR ""
+#endif
+
+#ifndef OPERON_DISPATCH_INSTALL_DIR
+#define OPERON_DISPATCH_INSTALL_DIR ""
+#endif
+
+#ifndef OPERON_DISPATCH_MODULE_SUFFIX
+#define OPERON_DISPATCH_MODULE_SUFFIX ".so"
+#endif
+
+namespace Operon {
+
+namespace {
+    constexpr std::array Names { "baseline", "x86-64-v2", "x86-64-v3", "x86-64-v4" };
+    constexpr std::array Targets { DispatchTarget::Baseline, DispatchTarget::X86_64_V2, DispatchTarget::X86_64_V3, DispatchTarget::X86_64_V4 };
+
+#if defined(_WIN32)
+    constexpr char PathSeparator{';'};
+#else
+    constexpr char PathSeparator{':'};
+#endif
+
+    using AbiFunction = std::uint64_t (*)();
+    using MakeMapFunction = void (*)(DefaultDispatch::Map*);
+
+    auto OpenLibrary(std::string const& path) -> void* {
+#if defined(_WIN32)
+        return static_cast<void*>(LoadLibraryA(path.c_str()));
+#else
+        return dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+#endif
+    }
+
+    auto GetSymbol(void* handle, char const* name) -> void* {
+#if defined(_WIN32)
+        return reinterpret_cast<void*>(GetProcAddress(static_cast<HMODULE>(handle), name)); // NOLINT
+#else
+        return dlsym(handle, name);
+#endif
+    }
+
+    // the module name for target: operon_dispatch_x86_64_v3.so
+    auto ModuleName(DispatchTarget target) -> std::string {
+        std::string name{DispatchTargetName(target)};
+        std::ranges::replace(name, '-', '_');
+        return fmt::format("operon_dispatch_{}{}", name, OPERON_DISPATCH_MODULE_SUFFIX);
+    }
+
+    auto SearchPath() -> std::vector<std::string> {
+        std::string path;
+        if (auto const* env = std::getenv("OPERON_DISPATCH_PATH"); env != nullptr) { // NOLINT(concurrency-mt-unsafe)
+            path = fmt::format("{}{}", env, PathSeparator);
+        }
+        path += fmt::format("{}{}{}", OPERON_DISPATCH_BUILD_DIR, PathSeparator, OPERON_DISPATCH_INSTALL_DIR);
+
+        std::vector<std::string> dirs;
+        for (auto i = 0UL; i < path.size();) {
+            auto j = std::min(path.find(PathSeparator, i), path.size());
+            if (j > i) { dirs.emplace_back(path.substr(i, j - i)); }
+            i = j + 1;
+        }
+        return dirs;
+    }
+
+    // returns the table factory of a module, or nullptr if the module cannot be loaded or is incompatible
+    // - the handle is never closed, since the callables of the tables live in the module
+    auto OpenModule(std::string const& path) -> MakeMapFunction {
+        auto* handle = OpenLibrary(path);
+        if (handle == nullptr) { return nullptr; }
+        auto abi = reinterpret_cast<AbiFunction>(GetSymbol(handle, "OperonDispatchAbi"));  // NOLINT
+        auto make = reinterpret_cast<MakeMapFunction>(GetSymbol(handle, "OperonMakeDispatchMap")); // NOLINT
+        return abi != nullptr && make != nullptr && abi() == detail::DispatchAbi() ? make : nullptr;
+    }
+
+    // loads the module of a target (once) and returns its table factory, or nullptr if no compatible module was found
+    auto LoadModule(DispatchTarget target) -> MakeMapFunction {
+        static std::mutex mutex;
+        static std::array<std::optional<MakeMapFunction>, Targets.size()> modules;
+
+        std::scoped_lock lock(mutex);
+        auto& module = modules[static_cast<int>(target)];
+        if (module) { return *module; }
+
+        module = nullptr;
+        for (auto const& dir : SearchPath()) {
+            if (auto make = OpenModule(fmt::format("{}/{}", dir, ModuleName(target))); make != nullptr) {
+                module = make;
+                break;
+            }
+        }
+        return *module;
+    }
+
+    auto MakeTable(MakeMapFunction make) -> DefaultDispatch {
+        DefaultDispatch::Map map;
+        make(&map);
+        return DefaultDispatch{std::move(map)};
+    }
+} // namespace
+
+auto DispatchTargetName(DispatchTarget target) -> std::string_view {
+    return Names[static_cast<int>(target)];
+}
+
+auto ParseDispatchTarget(std::string_view name) -> std::optional<DispatchTarget> {
+    if (auto it = std::ranges::find(Names, name); it != Names.end()) {
+        return Targets[std::distance(Names.begin(), it)];
+    }
+    return std::nullopt;
+}
+
+auto CpuSupports(DispatchTarget target) -> bool {
+    if (target == DispatchTarget::Baseline) { return true; }
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    // feature levels as defined by the x86-64 psABI
+    auto const v2 = __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt") && __builtin_cpu_supports("ssse3");
+    auto const v3 = v2 && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("bmi2");
+    auto const v4 = v3 && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+                       && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl");
+    switch (target) {
+    case DispatchTarget::X86_64_V2: return v2;
+    case DispatchTarget::X86_64_V3: return v3;
+    case DispatchTarget::X86_64_V4: return v4;
+    default: return false;
+    }
+#else
+    return false;
+#endif
+}
+
+auto AvailableDispatchTargets() -> std::vector<DispatchTarget> {
+    std::vector<DispatchTarget> targets;
+    for (auto target : Targets) {
+        if (target == DispatchTarget::Baseline || (CpuSupports(target) && LoadModule(target) != nullptr)) {
+            targets.push_back(target);
+        }
+    }
+    return targets;
+}
+
+auto BestDispatchTarget() -> DispatchTarget {
+    return AvailableDispatchTargets().back();
+}
+
+auto MakeDispatchTable(DispatchTarget target) -> DefaultDispatch {
+    if (target == DispatchTarget::Baseline) {
+        return DefaultDispatch{};
+    }
+    if (!CpuSupports(target)) {
+        throw std::runtime_error(fmt::format("dispatch target {} is not supported by this cpu\n", DispatchTargetName(target)));
+    }
+    auto make = LoadModule(target);
+    if (make == nullptr) {
+        throw std::runtime_error(fmt::format("could not load a compatible module {} for dispatch target {}\n", ModuleName(target), DispatchTargetName(target)));
+    }
+    return MakeTable(make);
+}
+
+auto MakeDispatchTable() -> DefaultDispatch {
+    return MakeDispatchTable(BestDispatchTarget());
+}
+
+auto LoadDispatchTable(std::string const& path) -> DefaultDispatch {
+    auto make = OpenModule(path);
+    if (make == nullptr) {
+        throw std::runtime_error(fmt::format("could not load a compatible dispatch module from {}\n", path));
+    }
+    return MakeTable(make);
+}
+
+} // namespace Operon
@@ -0,0 +1,28 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+// the primitives of the default dispatch table compiled for one instruction set target (see cpu_dispatch.hpp)
+// - this file is built once per target into a separate module, with the target flags and hidden visibility,
+//   so that the templates instantiated here never replace the baseline instantiations of the library
+// - only the two functions below are exported
+
+#include "operon/interpreter/cpu_dispatch.hpp"
+#include "operon/interpreter/dispatch_table.hpp"
+
+#if defined(_WIN32)
+#define OPERON_DISPATCH_MODULE_EXPORT __declspec(dllexport)
+#else
+#define OPERON_DISPATCH_MODULE_EXPORT __attribute__((visibility("default")))
+#endif
+
+extern "C" {
+    OPERON_DISPATCH_MODULE_EXPORT auto OperonDispatchAbi() -> std::uint64_t
+    {
+        return Operon::detail::DispatchAbi();
+    }
+
+    OPERON_DISPATCH_MODULE_EXPORT auto OperonMakeDispatchMap(Operon::DefaultDispatch::Map* map) -> void
+    {
+        *map = Operon::DefaultDispatch{}.GetMap();
+    }
+}
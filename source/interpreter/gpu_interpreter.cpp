@@ -0,0 +1,236 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include "operon/interpreter/gpu_interpreter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <fmt/format.h>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "operon/core/contracts.hpp"
+#include "gpu_kernels.hpp"
+
+namespace Operon {
+
+static_assert(std::is_same_v<Gpu::Real, Operon::Scalar>);
+static_assert(Gpu::Op::Aq == std::countr_zero(static_cast<std::uint32_t>(NodeType::Aq)));
+static_assert(Gpu::Op::Square == std::countr_zero(static_cast<std::uint32_t>(NodeType::Square)));
+static_assert(Gpu::Op::Variable == std::countr_zero(static_cast<std::uint32_t>(NodeType::Variable)));
+
+namespace {
+    auto Check(cudaError_t status, char const* what) -> void {
+        if (status != cudaSuccess) {
+            throw std::runtime_error(fmt::format("{}: {}\n", what, cudaGetErrorString(status)));
+        }
+    }
+
+    // appends the code of the tree, with the coefficients taken from coeff (if not empty)
+    auto Compile(GpuDataset const& dataset, Operon::Tree const& tree, Operon::Span<Operon::Scalar const> coeff, std::vector<Gpu::Instruction>& code) -> void {
+        std::uint32_t depth{0};
+        std::uint32_t maxDepth{0};
+        std::int32_t k{0};
+        for (auto const& n : tree.Nodes()) {
+            if (n.Type == NodeType::Dynamic) {
+                throw std::runtime_error("GpuInterpreter: dynamic nodes cannot be evaluated on the device\n");
+            }
+            if (n.Lag != 0) {
+                throw std::runtime_error("GpuInterpreter: lagged variables cannot be evaluated on the device\n");
+            }
+            if (n.Arity > Gpu::MaxArity) {
+                throw std::runtime_error(fmt::format("GpuInterpreter: node {} has {} arguments (at most {} are supported)\n", n.Name(), n.Arity, Gpu::MaxArity));
+            }
+            depth = depth - n.Arity + 1;
+            maxDepth = std::max(maxDepth, depth);
+
+            auto const value = (!coeff.empty() && n.Optimize) ? coeff[k] : n.Value;
+            code.push_back({
+                .Type        = static_cast<std::uint32_t>(NodeTypes::GetIndex(n.Type)),
+                .Arity       = n.Arity,
+                .Column      = n.IsVariable() ? static_cast<std::int32_t>(dataset.Column(n.HashValue)) : -1,
+                .Coefficient = n.Optimize ? k++ : -1,
+                .Value       = value
+            });
+        }
+        if (maxDepth > Gpu::MaxStack) {
+            throw std::runtime_error(fmt::format("GpuInterpreter: the tree needs a stack of depth {} (at most {} is supported)\n", maxDepth, Gpu::MaxStack));
+        }
+    }
+} // namespace
+
+namespace detail {
+    DeviceBuffer::DeviceBuffer(DeviceBuffer&& other) noexcept
+        : ptr_(std::exchange(other.ptr_, nullptr))
+        , size_(std::exchange(other.size_, 0))
+    {
+    }
+
+    auto DeviceBuffer::operator=(DeviceBuffer&& other) noexcept -> DeviceBuffer& {
+        if (this != &other) {
+            cudaFree(ptr_);
+            ptr_ = std::exchange(other.ptr_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    DeviceBuffer::~DeviceBuffer() {
+        cudaFree(ptr_);
+    }
+
+    auto DeviceBuffer::Reserve(std::size_t bytes) -> void {
+        if (bytes <= size_) { return; }
+        Check(cudaFree(ptr_), "cudaFree");
+        ptr_ = nullptr;
+        size_ = 0;
+        Check(cudaMalloc(&ptr_, bytes), "cudaMalloc");
+        size_ = bytes;
+    }
+
+    auto DeviceBuffer::Upload(void const* src, std::size_t bytes) -> void {
+        Reserve(bytes);
+        Check(cudaMemcpy(ptr_, src, bytes, cudaMemcpyHostToDevice), "cudaMemcpy");
+    }
+
+    auto DeviceBuffer::Download(void* dst, std::size_t bytes) const -> void {
+        EXPECT(bytes <= size_);
+        Check(cudaMemcpy(dst, ptr_, bytes, cudaMemcpyDeviceToHost), "cudaMemcpy");
+    }
+} // namespace detail
+
+GpuDataset::GpuDataset(Operon::Dataset const& dataset)
+    : dataset_(dataset)
+    , rows_(dataset.Rows<std::size_t>())
+    , values_(std::max(dataset.Rows<std::size_t>() * dataset.Cols<std::size_t>(), std::size_t{1}) * sizeof(Operon::Scalar))
+{
+    // the device holds a copy of the values anyway, so the transforms of the variables are applied to the copy
+    std::vector<Operon::Scalar> transformed;
+    for (auto const& v : dataset.GetVariables()) {
+        auto values = dataset.GetValues(v.Hash);
+        if (v.Scale != 1 || v.Offset != 0) {
+            transformed.resize(values.size());
+            std::ranges::transform(values, transformed.begin(), [&](auto x) { return x * v.Scale + v.Offset; });
+            values = transformed;
+        }
+        Check(cudaMemcpy(values_.Data<Operon::Scalar>() + v.Index * rows_, values.data(), rows_ * sizeof(Operon::Scalar), cudaMemcpyHostToDevice), "cudaMemcpy");
+    }
+}
+
+auto GpuDataset::Column(Operon::Hash hash) const -> std::size_t {
+    auto const v = dataset_.get().GetVariable(hash);
+    if (!v) {
+        throw std::runtime_error(fmt::format("GpuDataset: a variable with hash value {} could not be found in the dataset.\n", hash));
+    }
+    return static_cast<std::size_t>(v->Index);
+}
+
+GpuInterpreter::GpuInterpreter(GpuDataset const& dataset, Operon::Tree const& tree)
+    : dataset_(dataset)
+    , tree_(tree)
+{
+}
+
+auto GpuInterpreter::Upload(Operon::Span<T const> coeff) const -> void {
+    std::vector<Gpu::Instruction> code;
+    code.reserve(tree_.get().Length() + 1);
+    Compile(dataset_.get(), tree_.get(), coeff, code);
+    // the offsets of the single tree are stored after the code (see EvaluateTrees)
+    std::array<std::uint32_t, 2> const offsets{ 0, static_cast<std::uint32_t>(code.size()) };
+    auto const bytes = code.size() * sizeof(Gpu::Instruction);
+    std::vector<std::byte> host(bytes + sizeof(offsets));
+    std::memcpy(host.data(), code.data(), bytes);
+    std::memcpy(host.data() + bytes, offsets.data(), sizeof(offsets));
+    code_.Upload(host.data(), host.size());
+}
+
+auto GpuInterpreter::Evaluate(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> result) const -> void {
+    EXPECT(result.size() >= range.Size());
+    EXPECT(range.End() <= dataset_.get().Rows());
+    auto const n = range.Size();
+    auto const length = tree_.get().Length();
+    Upload(coeff);
+    output_.Reserve(n * sizeof(T));
+
+    auto const* code = code_.Data<Gpu::Instruction const>();
+    auto const* offsets = reinterpret_cast<std::uint32_t const*>(code + length); // NOLINT
+    Check(Gpu::EvaluateTrees(code, offsets, 1, dataset_.get().Values(0), dataset_.get().Rows(), range.Start(), n, output_.Data<T>(), nullptr), "EvaluateTrees");
+    output_.Download(result.data(), n * sizeof(T));
+}
+
+auto GpuInterpreter::Evaluate(Operon::Span<T const> coeff, Operon::Range range) const -> std::vector<T> {
+    std::vector<T> result(range.Size());
+    Evaluate(coeff, range, result);
+    return result;
+}
+
+auto GpuInterpreter::JacRev(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> result, Operon::Span<T> jacobian) const -> void {
+    auto const n = range.Size();
+    auto const nc = static_cast<std::size_t>(tree_.get().CoefficientsCount());
+    EXPECT(jacobian.size() >= n * nc);
+    EXPECT(range.End() <= dataset_.get().Rows());
+    auto const copyResult = result.size() == n;
+
+    // without coefficients there is no jacobian, only the output
+    if (nc == 0) {
+        if (copyResult) { Evaluate(coeff, range, result); }
+        return;
+    }
+
+    Upload(coeff);
+    output_.Reserve(n * sizeof(T));
+    jacobian_.Reserve(n * nc * sizeof(T));
+    Check(Gpu::EvaluateJacobian(code_.Data<Gpu::Instruction const>(), static_cast<std::uint32_t>(tree_.get().Length()), static_cast<std::uint32_t>(nc),
+        dataset_.get().Values(0), dataset_.get().Rows(), range.Start(), n, copyResult ? output_.Data<T>() : nullptr, jacobian_.Data<T>(), nullptr), "EvaluateJacobian");
+
+    // both are column-major with one column per coefficient
+    jacobian_.Download(jacobian.data(), n * nc * sizeof(T));
+    if (copyResult) { output_.Download(result.data(), n * sizeof(T)); }
+}
+
+auto GpuInterpreter::JacFwd(Operon::Span<T const> coeff, Operon::Range range) const -> Eigen::Array<T, -1, -1> {
+    Eigen::Array<T, -1, -1> jacobian(static_cast<Eigen::Index>(range.Size()), static_cast<Eigen::Index>(tree_.get().CoefficientsCount()));
+    JacRev(coeff, range, {}, { jacobian.data(), static_cast<std::size_t>(jacobian.size()) });
+    return jacobian;
+}
+
+auto EvaluateErrorStatistics(GpuDataset const& dataset, Operon::Span<std::reference_wrapper<Operon::Tree const> const> trees,
+    Operon::Range range, Operon::Hash target) -> std::vector<ErrorAccumulator>
+{
+    EXPECT(range.End() <= dataset.Rows());
+    std::vector<ErrorAccumulator> stats(trees.size());
+    if (trees.empty() || range.Size() == 0) { return stats; }
+
+    std::vector<Gpu::Instruction> code;
+    std::vector<std::uint32_t> offsets{0};
+    for (auto const& tree : trees) {
+        Compile(dataset, tree.get(), {}, code);
+        offsets.push_back(static_cast<std::uint32_t>(code.size()));
+    }
+
+    auto const n = range.Size();
+    auto const nt = static_cast<std::uint32_t>(trees.size());
+    detail::DeviceBuffer deviceCode;
+    detail::DeviceBuffer deviceOffsets;
+    detail::DeviceBuffer output(n * nt * sizeof(Operon::Scalar));
+    detail::DeviceBuffer state(nt * std::tuple_size_v<ErrorAccumulator::State> * sizeof(double));
+    deviceCode.Upload(code.data(), code.size() * sizeof(Gpu::Instruction));
+    deviceOffsets.Upload(offsets.data(), offsets.size() * sizeof(std::uint32_t));
+
+    auto const* y = dataset.Values(dataset.Column(target)) + range.Start();
+    Check(Gpu::EvaluateTrees(deviceCode.Data<Gpu::Instruction const>(), deviceOffsets.Data<std::uint32_t const>(), nt,
+        dataset.Values(0), dataset.Rows(), range.Start(), n, output.Data<Operon::Scalar>(), nullptr), "EvaluateTrees");
+    Check(Gpu::ErrorStatistics(output.Data<Operon::Scalar const>(), nt, y, n, state.Data<double>(), nullptr), "ErrorStatistics");
+
+    std::vector<ErrorAccumulator::State> states(nt);
+    state.Download(states.data(), states.size() * sizeof(ErrorAccumulator::State));
+    std::ranges::transform(states, stats.begin(), &ErrorAccumulator::FromState);
+    return stats;
+}
+
+} // namespace Operon
@@ -0,0 +1,254 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include "gpu_kernels.hpp"
+
+#include <cuda_runtime.h>
+
+namespace Operon::Gpu {
+
+namespace {
+    using T = Real;
+
+    // a value and its tangent with respect to one coefficient
+    struct Dual {
+        T V;
+        T D;
+    };
+
+    __device__ inline auto Sign(T x) -> T { return x > T{0} ? T{1} : (x < T{0} ? T{-1} : T{0}); }
+
+    // f * d, where a zero tangent (the argument does not depend on the coefficient) stays zero even if f is not finite
+    __device__ inline auto Chain(T f, T d) -> T { return d == T{0} ? T{0} : f * d; }
+
+    // applies the primitive to the arguments, same semantics as the default dispatch table
+    // - the tangent is only computed when D is true
+    template<bool D>
+    __device__ auto Apply(std::uint32_t op, std::uint32_t arity, Dual const* a) -> Dual
+    {
+        Dual r{a[0].V, D ? a[0].D : T{0}};
+        auto const u = a[0].V;
+        auto const du = a[0].D;
+
+        switch (op) {
+        case Op::Add: {
+            for (auto k = 1U; k < arity; ++k) {
+                r.V += a[k].V;
+                if constexpr (D) { r.D += a[k].D; }
+            }
+            break;
+        }
+        case Op::Sub: {
+            if (arity == 1) { return {-u, -r.D}; }
+            for (auto k = 1U; k < arity; ++k) {
+                r.V -= a[k].V;
+                if constexpr (D) { r.D -= a[k].D; }
+            }
+            break;
+        }
+        case Op::Mul: {
+            for (auto k = 1U; k < arity; ++k) {
+                if constexpr (D) { r.D = Chain(a[k].V, r.D) + Chain(r.V, a[k].D); }
+                r.V *= a[k].V;
+            }
+            break;
+        }
+        case Op::Div: {
+            if (arity == 1) {
+                r.V = T{1} / u;
+                if constexpr (D) { r.D = Chain(-r.V * r.V, du); }
+                break;
+            }
+            // a / (b * c * ...)
+            Dual p{a[1].V, D ? a[1].D : T{0}};
+            for (auto k = 2U; k < arity; ++k) {
+                if constexpr (D) { p.D = Chain(a[k].V, p.D) + Chain(p.V, a[k].D); }
+                p.V *= a[k].V;
+            }
+            r.V = u / p.V;
+            if constexpr (D) { r.D = Chain(T{1} / p.V, du) - Chain(r.V / p.V, p.D); }
+            break;
+        }
+        case Op::Fmin: {
+            for (auto k = 1U; k < arity; ++k) {
+                if (a[k].V < r.V) { r = a[k]; }
+            }
+            break;
+        }
+        case Op::Fmax: {
+            for (auto k = 1U; k < arity; ++k) {
+                if (r.V < a[k].V) { r = a[k]; }
+            }
+            break;
+        }
+        case Op::Aq: {
+            auto const b = a[1].V;
+            auto const s = sqrt(T{1} + b * b);
+            r.V = u / s;
+            if constexpr (D) { r.D = Chain(T{1} / s, du) - Chain(u * b / (s * s * s), a[1].D); }
+            break;
+        }
+        case Op::Pow: {
+            auto const b = a[1].V;
+            r.V = pow(u, b);
+            if constexpr (D) { r.D = Chain(b * pow(u, b - T{1}), du) + Chain(r.V * log(u), a[1].D); }
+            break;
+        }
+        case Op::Abs: { r.V = fabs(u); if constexpr (D) { r.D = Chain(Sign(u), du); } break; }
+        case Op::Acos: { r.V = acos(u); if constexpr (D) { r.D = Chain(-T{1} / sqrt(T{1} - u * u), du); } break; }
+        case Op::Asin: { r.V = asin(u); if constexpr (D) { r.D = Chain(T{1} / sqrt(T{1} - u * u), du); } break; }
+        case Op::Atan: { r.V = atan(u); if constexpr (D) { r.D = Chain(T{1} / (T{1} + u * u), du); } break; }
+        case Op::Cbrt: { r.V = cbrt(u); if constexpr (D) { r.D = Chain(T{1} / (T{3} * r.V * r.V), du); } break; }
+        case Op::Ceil: { r.V = ceil(u); r.D = T{0}; break; }
+        case Op::Cos: { r.V = cos(u); if constexpr (D) { r.D = Chain(-sin(u), du); } break; }
+        case Op::Cosh: { r.V = cosh(u); if constexpr (D) { r.D = Chain(sinh(u), du); } break; }
+        case Op::Exp: { r.V = exp(u); if constexpr (D) { r.D = Chain(r.V, du); } break; }
+        case Op::Floor: { r.V = floor(u); r.D = T{0}; break; }
+        case Op::Log: { r.V = log(u); if constexpr (D) { r.D = Chain(T{1} / u, du); } break; }
+        case Op::Logabs: { r.V = log(fabs(u)); if constexpr (D) { r.D = Chain(T{1} / u, du); } break; }
+        case Op::Log1p: { r.V = log1p(u); if constexpr (D) { r.D = Chain(T{1} / (T{1} + u), du); } break; }
+        case Op::Sin: { r.V = sin(u); if constexpr (D) { r.D = Chain(cos(u), du); } break; }
+        case Op::Sinh: { r.V = sinh(u); if constexpr (D) { r.D = Chain(cosh(u), du); } break; }
+        case Op::Sqrt: { r.V = sqrt(u); if constexpr (D) { r.D = Chain(T{1} / (T{2} * r.V), du); } break; }
+        case Op::Sqrtabs: { r.V = sqrt(fabs(u)); if constexpr (D) { r.D = Chain(Sign(u) / (T{2} * r.V), du); } break; }
+        case Op::Tan: { r.V = tan(u); if constexpr (D) { r.D = Chain(T{1} + r.V * r.V, du); } break; }
+        case Op::Tanh: { r.V = tanh(u); if constexpr (D) { r.D = Chain(T{1} - r.V * r.V, du); } break; }
+        case Op::Square: { r.V = u * u; if constexpr (D) { r.D = Chain(T{2} * u, du); } break; }
+        default: { r.V = nan(""); break; }
+        }
+        return r;
+    }
+
+    // evaluates one row of a tree, the tangent is taken with respect to coefficient k (when D is true)
+    template<bool D>
+    __device__ auto EvaluateRow(Instruction const* code, std::uint32_t length, T const* data, std::size_t stride, std::size_t row, std::int32_t k) -> Dual
+    {
+        Dual stack[MaxStack]; // NOLINT
+        Dual args[MaxArity]; // NOLINT
+        std::uint32_t top{0};
+
+        for (auto i = 0U; i < length; ++i) {
+            auto const& ins = code[i];
+            auto const seed = D && ins.Coefficient == k;
+            Dual r{};
+            if (ins.Type == Op::Constant) {
+                r = {ins.Value, seed ? T{1} : T{0}};
+            } else if (ins.Type == Op::Variable) {
+                auto const x = data[static_cast<std::size_t>(ins.Column) * stride + row];
+                r = {ins.Value * x, seed ? x : T{0}};
+            } else {
+                // the first argument (the last child in postfix order) is on top of the stack
+                for (auto j = 0U; j < ins.Arity; ++j) { args[j] = stack[--top]; }
+                auto const f = Apply<D>(ins.Type, ins.Arity, args);
+                r = {ins.Value * f.V, D ? Chain(ins.Value, f.D) + (seed ? f.V : T{0}) : T{0}};
+            }
+            stack[top++] = r;
+        }
+        return stack[0];
+    }
+
+    __global__ void EvaluateTreesKernel(Instruction const* code, std::uint32_t const* offsets, T const* data, std::size_t stride, std::size_t start, std::size_t n, T* out)
+    {
+        auto const i = static_cast<std::size_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+        if (i >= n) { return; }
+        auto const t = blockIdx.y;
+        auto const b = offsets[t];
+        out[t * n + i] = EvaluateRow<false>(code + b, offsets[t + 1] - b, data, stride, start + i, -1).V;
+    }
+
+    __global__ void EvaluateJacobianKernel(Instruction const* code, std::uint32_t length, T const* data, std::size_t stride, std::size_t start, std::size_t n, T* out, T* jac)
+    {
+        auto const i = static_cast<std::size_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+        if (i >= n) { return; }
+        auto const k = blockIdx.y;
+        auto const r = EvaluateRow<true>(code, length, data, stride, start + i, static_cast<std::int32_t>(k));
+        jac[k * n + i] = r.D;
+        if (out != nullptr && k == 0) { out[i] = r.V; }
+    }
+
+    // sum of the values of the threads of the block, returned to all the threads
+    __device__ auto BlockSum(double v, double* shared) -> double
+    {
+        shared[threadIdx.x] = v;
+        __syncthreads();
+        for (auto s = BlockSize / 2; s > 0; s /= 2) {
+            if (threadIdx.x < s) { shared[threadIdx.x] += shared[threadIdx.x + s]; }
+            __syncthreads();
+        }
+        auto const sum = shared[0];
+        __syncthreads();
+        return sum;
+    }
+
+    // one block per tree, two passes over the values (means, then centered sums) like ErrorAccumulator
+    __global__ void ErrorStatisticsKernel(T const* out, T const* target, std::size_t n, double* state)
+    {
+        __shared__ double shared[BlockSize]; // NOLINT
+        auto const* x = out + blockIdx.x * n;
+
+        double sx{0};
+        double sy{0};
+        for (auto i = static_cast<std::size_t>(threadIdx.x); i < n; i += BlockSize) {
+            sx += x[i];
+            sy += target[i];
+        }
+        auto const m = static_cast<double>(n);
+        auto const mx = BlockSum(sx, shared) / m;
+        auto const my = BlockSum(sy, shared) / m;
+
+        double sxx{0};
+        double syy{0};
+        double sxy{0};
+        double sse{0};
+        double sae{0};
+        for (auto i = static_cast<std::size_t>(threadIdx.x); i < n; i += BlockSize) {
+            auto const dx = static_cast<double>(x[i]) - mx;
+            auto const dy = static_cast<double>(target[i]) - my;
+            auto const e = static_cast<double>(x[i]) - static_cast<double>(target[i]);
+            sxx += dx * dx;
+            syy += dy * dy;
+            sxy += dx * dy;
+            sse += e * e;
+            sae += fabs(e);
+        }
+        sxx = BlockSum(sxx, shared);
+        syy = BlockSum(syy, shared);
+        sxy = BlockSum(sxy, shared);
+        sse = BlockSum(sse, shared);
+        sae = BlockSum(sae, shared);
+
+        if (threadIdx.x == 0) {
+            auto* s = state + blockIdx.x * 8;
+            s[0] = m; s[1] = mx; s[2] = my;
+            s[3] = sxx; s[4] = syy; s[5] = sxy;
+            s[6] = sse; s[7] = sae;
+        }
+    }
+
+    auto Blocks(std::size_t n) -> unsigned { return static_cast<unsigned>((n + BlockSize - 1) / BlockSize); }
+} // namespace
+
+auto EvaluateTrees(Instruction const* code, std::uint32_t const* offsets, std::uint32_t trees,
+    Real const* data, std::size_t stride, std::size_t start, std::size_t n, Real* out, cudaStream_t stream) -> cudaError_t
+{
+    if (n == 0 || trees == 0) { return cudaSuccess; }
+    EvaluateTreesKernel<<<dim3(Blocks(n), trees), BlockSize, 0, stream>>>(code, offsets, data, stride, start, n, out);
+    return cudaGetLastError();
+}
+
+auto EvaluateJacobian(Instruction const* code, std::uint32_t length, std::uint32_t coefficients,
+    Real const* data, std::size_t stride, std::size_t start, std::size_t n, Real* out, Real* jac, cudaStream_t stream) -> cudaError_t
+{
+    if (n == 0 || coefficients == 0) { return cudaSuccess; }
+    EvaluateJacobianKernel<<<dim3(Blocks(n), coefficients), BlockSize, 0, stream>>>(code, length, data, stride, start, n, out, jac);
+    return cudaGetLastError();
+}
+
+auto ErrorStatistics(Real const* out, std::uint32_t trees, Real const* target, std::size_t n, double* state, cudaStream_t stream) -> cudaError_t
+{
+    if (n == 0 || trees == 0) { return cudaSuccess; }
+    ErrorStatisticsKernel<<<trees, BlockSize, 0, stream>>>(out, target, n, state);
+    return cudaGetLastError();
+}
+
+} // namespace Operon::Gpu
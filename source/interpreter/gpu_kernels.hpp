@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_INTERPRETER_GPU_KERNELS_HPP
+#define OPERON_INTERPRETER_GPU_KERNELS_HPP
+
+// interface between the host code (compiled by the c++ compiler) and the kernels (compiled by nvcc)
+// - only plain types are used here, so that the kernels do not have to include the operon headers
+
+#include <cstddef>
+#include <cstdint>
+
+#include <cuda_runtime_api.h>
+
+namespace Operon::Gpu {
+
+#if defined(USE_SINGLE_PRECISION)
+using Real = float;
+#else
+using Real = double;
+#endif
+
+// the node types, numbered like NodeTypes::GetIndex
+namespace Op {
+    enum : std::uint32_t {
+        Add, Mul, Sub, Div, Fmin, Fmax, Aq, Pow,
+        Abs, Acos, Asin, Atan, Cbrt, Ceil, Cos, Cosh, Exp, Floor, Log, Logabs, Log1p, Sin, Sinh, Sqrt, Sqrtabs, Tan, Tanh, Square,
+        Dynamic, Constant, Variable
+    };
+} // namespace Op
+
+// one node of a tree in postfix order
+struct Instruction {
+    std::uint32_t Type;
+    std::uint32_t Arity;
+    std::int32_t Column;      // dataset column of a variable, -1 otherwise
+    std::int32_t Coefficient; // index of the coefficient of the node, -1 if the node is not optimized
+    Real Value;
+};
+
+// the trees are evaluated with a stack in local memory
+constexpr std::uint32_t MaxStack{64};
+constexpr std::uint32_t MaxArity{8};
+constexpr std::uint32_t BlockSize{256};
+
+// all the pointers below are device pointers
+// - data is the column-major matrix of the dataset, with stride rows per column
+// - the trees are concatenated in code, tree t spans code[offsets[t]:offsets[t+1]]
+
+// out[t * n + i] = output of tree t for row start + i
+auto EvaluateTrees(Instruction const* code, std::uint32_t const* offsets, std::uint32_t trees,
+    Real const* data, std::size_t stride, std::size_t start, std::size_t n, Real* out, cudaStream_t stream) -> cudaError_t;
+
+// forward mode jacobian of a single tree, jac[k * n + i] = derivative of row start + i with respect to coefficient k
+// - out receives the output of the tree, unless it is null
+auto EvaluateJacobian(Instruction const* code, std::uint32_t length, std::uint32_t coefficients,
+    Real const* data, std::size_t stride, std::size_t start, std::size_t n, Real* out, Real* jac, cudaStream_t stream) -> cudaError_t;
+
+// error statistics of the outputs of each tree against the target, in the layout of ErrorAccumulator::State
+// - state[t * 8 + j] = { n, mean x, mean y, sxx, syy, sxy, sse, sae }[j]
+auto ErrorStatistics(Real const* out, std::uint32_t trees, Real const* target, std::size_t n, double* state, cudaStream_t stream) -> cudaError_t;
+
+} // namespace Operon::Gpu
+
+#endif
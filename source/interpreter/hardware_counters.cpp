@@ -0,0 +1,248 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include "operon/interpreter/hardware_counters.hpp"
+
+#include <algorithm>
+#include <fmt/format.h>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#if defined(HAVE_HARDWARE_COUNTERS)
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Operon {
+
+namespace {
+    // the counters of all the threads that sampled a kernel, they are kept until the end of the program
+    // because the counts of a thread are collected after the thread has finished
+    struct Registry {
+        std::mutex Mutex;
+        std::vector<std::unique_ptr<KernelSampler::Counters>> Counters;
+        std::atomic<bool> Enabled{false};
+    };
+
+    auto GetRegistry() -> Registry&
+    {
+        static Registry registry;
+        return registry;
+    }
+
+#if defined(HAVE_HARDWARE_COUNTERS)
+    constexpr std::array<uint64_t, HardwareEventCount> EventConfig {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+
+    auto OpenEvent(uint64_t config) -> int
+    {
+        perf_event_attr attr{};
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        // counts the calling thread on any cpu
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0)); // NOLINT
+    }
+
+    // reads a counter from its mapped page (see perf_event_open(2)), or with a system call if the kernel does
+    // not allow reading the counters in user space
+    auto ReadEvent(int fd, void const* page) noexcept -> uint64_t
+    {
+#if defined(__x86_64__)
+        if (page != nullptr) {
+            auto const volatile* pc = static_cast<perf_event_mmap_page const volatile*>(page);
+            uint32_t seq{};
+            uint64_t count{};
+            bool valid{};
+            do {
+                seq = pc->lock;
+                std::atomic_signal_fence(std::memory_order_seq_cst);
+                auto const index = pc->index;
+                count = static_cast<uint64_t>(pc->offset);
+                valid = pc->cap_user_rdpmc != 0 && index != 0;
+                if (valid) {
+                    uint32_t lo{};
+                    uint32_t hi{};
+                    asm volatile("rdpmc" : "=a"(lo), "=d"(hi) : "c"(index - 1)); // NOLINT
+                    auto const width = pc->pmc_width;
+                    auto pmc = static_cast<int64_t>((static_cast<uint64_t>(hi) << 32U) | lo); // NOLINT
+                    pmc <<= 64 - width; // NOLINT
+                    pmc >>= 64 - width; // NOLINT: sign extension
+                    count += static_cast<uint64_t>(pmc);
+                }
+                std::atomic_signal_fence(std::memory_order_seq_cst);
+            } while (pc->lock != seq);
+            if (valid) { return count; }
+        }
+#else
+        (void)page;
+#endif
+        uint64_t value{0};
+        if (read(fd, &value, sizeof(value)) != static_cast<ssize_t>(sizeof(value))) { return 0; }
+        return value;
+    }
+#endif
+} // namespace
+
+auto HardwareEventName(HardwareEvent event) -> std::string_view
+{
+    constexpr std::array<std::string_view, HardwareEventCount> names { "cycles", "instructions", "cache_misses", "branch_misses" };
+    return names.at(static_cast<std::size_t>(event));
+}
+
+auto KernelProfile::Name(std::size_t kernel) -> std::string_view
+{
+    if (kernel == Jacobian) { return "jacobian"; }
+    if (kernel == ErrorMetric) { return "error metric"; }
+    auto const type = static_cast<NodeType>(1U << kernel);
+    return Node(type).Name();
+}
+
+KernelSampler::Counters::Counters()
+{
+    fds_.fill(-1);
+#if defined(HAVE_HARDWARE_COUNTERS)
+    auto const pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    for (auto i = 0UL; i < HardwareEventCount; ++i) {
+        fds_[i] = OpenEvent(EventConfig[i]);
+        if (fds_[i] < 0) {
+            auto const error = errno;
+            Close();
+            throw std::runtime_error(fmt::format("cannot open the {} counter: {}", HardwareEventName(static_cast<HardwareEvent>(i)), std::strerror(error))); // NOLINT(concurrency-mt-unsafe)
+        }
+        auto* page = mmap(nullptr, pageSize, PROT_READ, MAP_SHARED, fds_[i], 0);
+        pages_[i] = page == MAP_FAILED ? nullptr : page; // NOLINT
+    }
+#else
+    throw std::runtime_error("the hardware counters are not supported by this build (see USE_HARDWARE_COUNTERS)");
+#endif
+}
+
+KernelSampler::Counters::~Counters()
+{
+    Close();
+}
+
+auto KernelSampler::Counters::Close() noexcept -> void
+{
+#if defined(HAVE_HARDWARE_COUNTERS)
+    auto const pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    for (auto i = 0UL; i < HardwareEventCount; ++i) {
+        if (pages_[i] != nullptr) { munmap(pages_[i], pageSize); }
+        if (fds_[i] >= 0) { close(fds_[i]); }
+        pages_[i] = nullptr;
+        fds_[i] = -1;
+    }
+#endif
+}
+
+auto KernelSampler::Counters::Read() const noexcept -> CounterValues
+{
+    CounterValues values{};
+#if defined(HAVE_HARDWARE_COUNTERS)
+    for (auto i = 0UL; i < HardwareEventCount; ++i) {
+        values[i] = ReadEvent(fds_[i], pages_[i]);
+    }
+#endif
+    return values;
+}
+
+auto KernelSampler::Counters::Add(std::size_t kernel, std::size_t rows, CounterValues const& begin) noexcept -> void
+{
+    auto const end = Read();
+    // only the owning thread writes the slots, the atomics make it safe to collect them while it is running
+    auto& slot = slots_[kernel];
+    slot.Calls.store(slot.Calls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    slot.Rows.store(slot.Rows.load(std::memory_order_relaxed) + rows, std::memory_order_relaxed);
+    for (auto i = 0UL; i < HardwareEventCount; ++i) {
+        auto& v = slot.Values[i];
+        v.store(v.load(std::memory_order_relaxed) + (end[i] - begin[i]), std::memory_order_relaxed);
+    }
+}
+
+auto KernelSampler::Supported() -> bool
+{
+#if defined(HAVE_HARDWARE_COUNTERS)
+    try {
+        Counters counters;
+        return true;
+    } catch (std::runtime_error const&) {
+        return false;
+    }
+#else
+    return false;
+#endif
+}
+
+auto KernelSampler::Enable() -> void { GetRegistry().Enabled = true; }
+auto KernelSampler::Disable() -> void { GetRegistry().Enabled = false; }
+auto KernelSampler::Enabled() noexcept -> bool { return GetRegistry().Enabled.load(std::memory_order_relaxed); }
+
+#if defined(HAVE_HARDWARE_COUNTERS)
+auto KernelSampler::Local() noexcept -> Counters*
+{
+    auto& registry = GetRegistry();
+    if (!registry.Enabled.load(std::memory_order_relaxed)) { return nullptr; }
+
+    // a thread whose counters cannot be opened is not sampled
+    thread_local Counters* local{nullptr};
+    thread_local bool failed{false};
+    if (local == nullptr && !failed) {
+        try {
+            auto counters = std::make_unique<Counters>();
+            std::scoped_lock lock(registry.Mutex);
+            local = registry.Counters.emplace_back(std::move(counters)).get();
+        } catch (...) {
+            failed = true;
+        }
+    }
+    return local;
+}
+#endif
+
+auto KernelSampler::Collect() -> KernelProfile
+{
+    KernelProfile profile;
+    auto& registry = GetRegistry();
+    std::scoped_lock lock(registry.Mutex);
+    for (auto const& counters : registry.Counters) {
+        for (auto k = 0UL; k < KernelProfile::Size; ++k) {
+            auto const& slot = counters->slots_[k];
+            auto& kernel = profile.Kernels[k];
+            kernel.Calls += slot.Calls.load(std::memory_order_relaxed);
+            kernel.Rows += slot.Rows.load(std::memory_order_relaxed);
+            for (auto i = 0UL; i < HardwareEventCount; ++i) {
+                kernel.Values[i] += slot.Values[i].load(std::memory_order_relaxed);
+            }
+        }
+    }
+    return profile;
+}
+
+auto KernelSampler::Reset() -> void
+{
+    // the slots are only reset between runs, a running thread would overwrite the reset with its own (stale) sum
+    auto& registry = GetRegistry();
+    std::scoped_lock lock(registry.Mutex);
+    for (auto const& counters : registry.Counters) {
+        for (auto& slot : counters->slots_) {
+            slot.Calls = 0;
+            slot.Rows = 0;
+            for (auto& v : slot.Values) { v = 0; }
+        }
+    }
+}
+
+} // namespace Operon
@@ -1,41 +1,110 @@
 // SPDX-License-Identifier: MIT
 // SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
 
+#include <thread>
+
 #include <taskflow/taskflow.hpp>
 #include <taskflow/algorithm/for_each.hpp>   // for taskflow.for_each_index
+#include "operon/core/executor.hpp"
 #include "operon/interpreter/interpreter.hpp"
 
 namespace Operon {
-    auto EvaluateTrees(std::vector<Operon::Tree> const& trees, Operon::Dataset const& dataset, Operon::Range range, size_t nthread) -> std::vector<std::vector<Operon::Scalar>> {
-        if (nthread == 0) { nthread = std::thread::hardware_concurrency(); }
-        tf::Executor executor(nthread);
+    namespace {
+        // number of trees evaluated together by one task (see EvaluateTiled)
+        constexpr std::size_t TileSize{16};
+    } // namespace
+
+    auto EvaluateTrees(tf::Executor& executor, DefaultDispatch const& dtable, std::vector<Operon::Tree> const& trees, Operon::Dataset const& dataset, Operon::Range range) -> std::vector<std::vector<Operon::Scalar>> {
         tf::Taskflow taskflow;
         std::vector<std::vector<Operon::Scalar>> result(trees.size());
-        Operon::DefaultDispatch dtable;
-        using INT = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
 
-        taskflow.for_each_index(size_t{0}, size_t{trees.size()}, size_t{1}, [&](size_t i) {
-            result[i].resize(range.Size());
-            Operon::Span<Operon::Scalar> s{result[i].data(), result[i].size()};
-            INT{dtable, dataset, trees[i]}.Evaluate({}, range, s);
+        taskflow.for_each_index(size_t{0}, size_t{trees.size()}, TileSize, [&](size_t i) {
+            auto const n = std::min(TileSize, trees.size() - i);
+            std::vector<std::reference_wrapper<Operon::Tree const>> tile(trees.begin() + i, trees.begin() + i + n);
+            std::vector<Operon::Scalar> buf(n * range.Size());
+            Operon::EvaluateTiled<Operon::Scalar>(dtable, dataset, tile, range, {buf.data(), buf.size()});
+            for (auto j = 0UL; j < n; ++j) {
+                auto const* ptr = buf.data() + j * range.Size();
+                result[i + j].assign(ptr, ptr + range.Size());
+            }
         });
-        executor.run(taskflow);
-        executor.wait_for_all();
+        RunTaskflow(executor, taskflow);
         return result;
     }
 
+    auto EvaluateTrees(tf::Executor& executor, DefaultDispatch const& dtable, std::vector<Operon::Tree> const& trees, Operon::Dataset const& dataset, Operon::Range range, std::span<Operon::Scalar> result) -> void {
+        tf::Taskflow taskflow;
+
+        taskflow.for_each_index(size_t{0}, size_t{trees.size()}, TileSize, [&](size_t i) {
+            auto const n = std::min(TileSize, trees.size() - i);
+            std::vector<std::reference_wrapper<Operon::Tree const>> tile(trees.begin() + i, trees.begin() + i + n);
+            Operon::EvaluateTiled<Operon::Scalar>(dtable, dataset, tile, range, result.subspan(i * range.Size(), n * range.Size()));
+        });
+        RunTaskflow(executor, taskflow);
+    }
+
+    auto EvaluateTrees(std::vector<Operon::Tree> const& trees, Operon::Dataset const& dataset, Operon::Range range, size_t nthread) -> std::vector<std::vector<Operon::Scalar>> {
+        tf::Executor executor(nthread == 0 ? std::thread::hardware_concurrency() : nthread);
+        return EvaluateTrees(executor, SharedDispatchTable(), trees, dataset, range);
+    }
+
     auto EvaluateTrees(std::vector<Operon::Tree> const& trees, Operon::Dataset const& dataset, Operon::Range range, std::span<Operon::Scalar> result, size_t nthread) -> void {
-        if (nthread == 0) { nthread = std::thread::hardware_concurrency(); }
-        tf::Executor executor(nthread);
+        tf::Executor executor(nthread == 0 ? std::thread::hardware_concurrency() : nthread);
+        EvaluateTrees(executor, SharedDispatchTable(), trees, dataset, range, result);
+    }
+
+    auto ForEachRowChunk(tf::Executor& executor, Operon::Range range, std::size_t rowChunk, std::function<void(Operon::Range)> const& func) -> void {
+        // keep the chunks aligned to the interpreter batch size
+        constexpr auto S { Interpreter<Operon::Scalar, DefaultDispatch>::BatchSize };
+        auto const chunk { std::max(S, (rowChunk + S - 1) / S * S) };
+        if (range.Size() <= chunk) {
+            func(range);
+            return;
+        }
+
         tf::Taskflow taskflow;
-        Operon::DefaultDispatch dtable;
-        using INT = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+        taskflow.for_each_index(range.Start(), range.End(), chunk, [&](size_t i) {
+            func(Operon::Range{i, std::min(i + chunk, range.End())});
+        });
+        RunTaskflow(executor, taskflow);
+    }
 
-        taskflow.for_each_index(size_t{0}, size_t{trees.size()}, size_t{1}, [&](size_t i) {
-            auto res = result.subspan(i * range.Size(), range.Size());
-            INT{dtable, dataset, trees[i]}.Evaluate({}, range, res);
+    auto EvaluateRows(tf::Executor& executor, DefaultDispatch const& dtable, Operon::Tree const& tree, Operon::Dataset const& dataset, Operon::Span<Operon::Scalar const> coeff, Operon::Range range, Operon::Span<Operon::Scalar> result, std::size_t rowChunk) -> void {
+        EXPECT(result.size() == range.Size());
+        ForEachRowChunk(executor, range, rowChunk, [&](Operon::Range rg) {
+            Interpreter<Operon::Scalar, DefaultDispatch> const interpreter{dtable, dataset, tree};
+            interpreter.Evaluate(coeff, rg, result.subspan(rg.Start() - range.Start(), rg.Size()));
         });
-        executor.run(taskflow);
-        executor.wait_for_all();
+    }
+
+    auto JacRevRows(tf::Executor& executor, DefaultDispatch const& dtable, Operon::Tree const& tree, Operon::Dataset const& dataset, Operon::Span<Operon::Scalar const> coeff, Operon::Range range, Operon::Span<Operon::Scalar> jacobian, std::size_t rowChunk) -> void {
+        auto const nr { static_cast<int64_t>(range.Size()) };
+        auto const nc { static_cast<int64_t>(coeff.size()) };
+        EXPECT(std::ssize(jacobian) == nr * nc);
+        Eigen::Map<Eigen::Array<Operon::Scalar, -1, -1>> jac(jacobian.data(), nr, nc);
+
+        ForEachRowChunk(executor, range, rowChunk, [&](Operon::Range rg) {
+            Interpreter<Operon::Scalar, DefaultDispatch> const interpreter{dtable, dataset, tree};
+            // the jacobian is column-major, so each chunk is computed separately and copied into its row block
+            auto const block = interpreter.JacRev(coeff, rg);
+            jac.middleRows(static_cast<int64_t>(rg.Start() - range.Start()), block.rows()) = block;
+        });
+    }
+
+    ScoringSession::ScoringSession(std::size_t nthread)
+        : executor_(std::make_unique<tf::Executor>(nthread == 0 ? std::thread::hardware_concurrency() : nthread))
+    {
+    }
+
+    ScoringSession::ScoringSession(ScoringSession&&) noexcept = default;
+    auto ScoringSession::operator=(ScoringSession&&) noexcept -> ScoringSession& = default;
+    ScoringSession::~ScoringSession() = default;
+
+    auto ScoringSession::Evaluate(std::vector<Operon::Tree> const& trees, Operon::Dataset const& dataset, Operon::Range range) const -> std::vector<std::vector<Operon::Scalar>> {
+        return EvaluateTrees(*executor_, dtable_, trees, dataset, range);
+    }
+
+    auto ScoringSession::Evaluate(std::vector<Operon::Tree> const& trees, Operon::Dataset const& dataset, Operon::Range range, std::span<Operon::Scalar> result) const -> void {
+        EvaluateTrees(*executor_, dtable_, trees, dataset, range, result);
     }
 } // namespace Operon
@@ -0,0 +1,255 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <stdexcept>
+#include <vector>
+#include <fmt/core.h>
+
+#include "operon/interpreter/interval.hpp"
+
+namespace Operon {
+
+namespace {
+    using T = Operon::Scalar;
+
+    constexpr auto Undefined() -> Interval { return { std::numeric_limits<T>::quiet_NaN(), std::numeric_limits<T>::quiet_NaN() }; }
+
+    auto Hull(auto... values) -> Interval { return { std::min({values...}), std::max({values...}) }; }
+
+    // applies a function that is monotonically increasing (or decreasing) over the interval
+    auto Increasing(Interval a, auto&& f) -> Interval { return { static_cast<T>(f(a.Lower)), static_cast<T>(f(a.Upper)) }; }
+    auto Decreasing(Interval a, auto&& f) -> Interval { return { static_cast<T>(f(a.Upper)), static_cast<T>(f(a.Lower)) }; }
+
+    auto Add(Interval a, Interval b) -> Interval { return { a.Lower + b.Lower, a.Upper + b.Upper }; }
+    auto Sub(Interval a, Interval b) -> Interval { return { a.Lower - b.Upper, a.Upper - b.Lower }; }
+    auto Neg(Interval a) -> Interval { return { -a.Upper, -a.Lower }; }
+
+    auto Mul(Interval a, Interval b) -> Interval
+    {
+        return Hull(a.Lower * b.Lower, a.Lower * b.Upper, a.Upper * b.Lower, a.Upper * b.Upper);
+    }
+
+    auto Inv(Interval a) -> Interval
+    {
+        if (a.Contains(T{0})) { return Undefined(); }
+        return { T{1} / a.Upper, T{1} / a.Lower };
+    }
+
+    // the smallest and largest absolute values
+    auto Abs(Interval a) -> Interval
+    {
+        if (a.Contains(T{0})) { return { T{0}, std::max(-a.Lower, a.Upper) }; }
+        return a.Lower > 0 ? a : Neg(a);
+    }
+
+    // true if offset + k * period lies within the interval for some integer k
+    auto ContainsPeriodic(Interval a, double offset, double period) -> bool
+    {
+        auto const k = std::ceil((a.Lower - offset) / period);
+        return offset + k * period <= a.Upper;
+    }
+
+    auto Sin(Interval a, double shift) -> Interval
+    {
+        constexpr auto pi = std::numbers::pi;
+        if (a.Upper - a.Lower >= 2 * pi) { return { T{-1}, T{1} }; }
+        auto r = Hull(static_cast<T>(std::sin(a.Lower + shift)), static_cast<T>(std::sin(a.Upper + shift)));
+        Interval const b{ static_cast<T>(a.Lower + shift), static_cast<T>(a.Upper + shift) };
+        if (ContainsPeriodic(b, pi / 2, 2 * pi)) { r.Upper = T{1}; }
+        if (ContainsPeriodic(b, -pi / 2, 2 * pi)) { r.Lower = T{-1}; }
+        return r;
+    }
+
+    auto Tan(Interval a) -> Interval
+    {
+        constexpr auto pi = std::numbers::pi;
+        if (a.Upper - a.Lower >= pi || ContainsPeriodic(a, pi / 2, pi)) { return Undefined(); }
+        return Increasing(a, [](auto x) { return std::tan(x); });
+    }
+
+    // x^y is only defined for a negative base if the exponent is an integer
+    // - only the constant exponents are exact, the computed ones can be off by a rounding error
+    auto Pow(Interval a, Interval b, bool constant) -> Interval
+    {
+        if (constant && std::trunc(b.Lower) == b.Lower) {
+            auto const n = b.Lower;
+            if (n < 0 && a.Contains(T{0})) { return Undefined(); }
+            auto r = Hull(std::pow(a.Lower, n), std::pow(a.Upper, n));
+            if (std::fmod(n, T{2}) == 0 && a.Contains(T{0})) { r.Lower = T{0}; }
+            return r;
+        }
+        if (a.Lower <= 0) { return Undefined(); }
+        // exp(y log x) is monotonic in each argument, the extremes are at the corners
+        return Hull(std::pow(a.Lower, b.Lower), std::pow(a.Lower, b.Upper), std::pow(a.Upper, b.Lower), std::pow(a.Upper, b.Upper));
+    }
+
+    auto Apply(Operon::Vector<Operon::Node> const& nodes, std::size_t i, std::vector<Interval> const& values, auto const& children) -> Interval // NOLINT(readability-function-cognitive-complexity)
+    {
+        auto const& n = nodes[i];
+        auto const& a = values[children.front()];
+        auto fold = [&](auto&& op) {
+            auto r = values[children[1]];
+            for (auto k = 2UL; k < children.size(); ++k) { r = op(r, values[children[k]]); }
+            return r;
+        };
+
+        switch (n.Type) {
+        case NodeType::Add: {
+            return children.size() == 1 ? a : Add(a, fold(Add));
+        }
+        case NodeType::Sub: {
+            return children.size() == 1 ? Neg(a) : Sub(a, fold(Add));
+        }
+        case NodeType::Mul: {
+            return children.size() == 1 ? a : Mul(a, fold(Mul));
+        }
+        case NodeType::Div: {
+            return children.size() == 1 ? Inv(a) : Mul(a, Inv(fold(Mul)));
+        }
+        case NodeType::Fmin: {
+            auto r = a;
+            for (auto c : children) { r = { std::min(r.Lower, values[c].Lower), std::min(r.Upper, values[c].Upper) }; }
+            return r;
+        }
+        case NodeType::Fmax: {
+            auto r = a;
+            for (auto c : children) { r = { std::max(r.Lower, values[c].Lower), std::max(r.Upper, values[c].Upper) }; }
+            return r;
+        }
+        case NodeType::Aq: {
+            auto const b = Abs(values[children[1]]);
+            auto const d = Increasing(b, [](auto x) { return std::sqrt(T{1} + x * x); });
+            return d.Finite() ? Mul(a, Inv(d)) : Undefined();
+        }
+        case NodeType::Pow: {
+            return Pow(a, values[children[1]], nodes[children[1]].IsConstant());
+        }
+        case NodeType::Abs: {
+            return Abs(a);
+        }
+        case NodeType::Acos: {
+            if (a.Lower < -1 || a.Upper > 1) { return Undefined(); }
+            return Decreasing(a, [](auto x) { return std::acos(x); });
+        }
+        case NodeType::Asin: {
+            if (a.Lower < -1 || a.Upper > 1) { return Undefined(); }
+            return Increasing(a, [](auto x) { return std::asin(x); });
+        }
+        case NodeType::Atan: {
+            return Increasing(a, [](auto x) { return std::atan(x); });
+        }
+        case NodeType::Cbrt: {
+            return Increasing(a, [](auto x) { return std::cbrt(x); });
+        }
+        case NodeType::Ceil: {
+            return Increasing(a, [](auto x) { return std::ceil(x); });
+        }
+        case NodeType::Cos: {
+            return Sin(a, std::numbers::pi / 2);
+        }
+        case NodeType::Cosh: {
+            return Increasing(Abs(a), [](auto x) { return std::cosh(x); });
+        }
+        case NodeType::Exp: {
+            return Increasing(a, [](auto x) { return std::exp(x); });
+        }
+        case NodeType::Floor: {
+            return Increasing(a, [](auto x) { return std::floor(x); });
+        }
+        case NodeType::Log: {
+            if (a.Lower <= 0) { return Undefined(); }
+            return Increasing(a, [](auto x) { return std::log(x); });
+        }
+        case NodeType::Logabs: {
+            if (a.Contains(T{0})) { return Undefined(); }
+            return Increasing(Abs(a), [](auto x) { return std::log(x); });
+        }
+        case NodeType::Log1p: {
+            if (a.Lower <= -1) { return Undefined(); }
+            return Increasing(a, [](auto x) { return std::log1p(x); });
+        }
+        case NodeType::Sin: {
+            return Sin(a, 0.0);
+        }
+        case NodeType::Sinh: {
+            return Increasing(a, [](auto x) { return std::sinh(x); });
+        }
+        case NodeType::Sqrt: {
+            if (a.Lower < 0) { return Undefined(); }
+            return Increasing(a, [](auto x) { return std::sqrt(x); });
+        }
+        case NodeType::Sqrtabs: {
+            return Increasing(Abs(a), [](auto x) { return std::sqrt(x); });
+        }
+        case NodeType::Tan: {
+            return Tan(a);
+        }
+        case NodeType::Tanh: {
+            return Increasing(a, [](auto x) { return std::tanh(x); });
+        }
+        case NodeType::Square: {
+            return Increasing(Abs(a), [](auto x) { return x * x; });
+        }
+        default: {
+            throw std::runtime_error(fmt::format("missing interval evaluation for node {}\n", n.Name()));
+        }
+        }
+    }
+} // namespace
+
+auto ComputeVariableBounds(Operon::Dataset const& dataset, Operon::Range range, std::size_t maxLag) -> VariableBounds
+{
+    auto const start = range.Start() - std::min(maxLag, range.Start());
+    VariableBounds bounds;
+    for (auto const& v : dataset.GetVariables()) {
+        auto const values = dataset.GetValues(v.Hash).subspan(start, range.End() - start);
+        Interval b{ std::numeric_limits<T>::max(), std::numeric_limits<T>::lowest() };
+        for (auto x : values) {
+            if (std::isnan(x)) { continue; }
+            b = { std::min(b.Lower, x), std::max(b.Upper, x) };
+        }
+        if (b.Lower > b.Upper) {
+            bounds[v.Hash] = Undefined();
+            continue;
+        }
+        // the bounds of the values read by the interpreters (see Dataset::SetTransform)
+        bounds[v.Hash] = Hull(b.Lower * v.Scale + v.Offset, b.Upper * v.Scale + v.Offset);
+    }
+    return bounds;
+}
+
+auto EvaluateInterval(Operon::Tree const& tree, VariableBounds const& bounds) -> Interval
+{
+    auto const& nodes = tree.Nodes();
+    std::vector<Interval> values(nodes.size());
+    std::vector<std::size_t> children;
+
+    for (auto i = 0UL; i < nodes.size(); ++i) {
+        auto const& n = nodes[i];
+        Interval const w{ n.Value, n.Value };
+
+        if (n.IsConstant()) {
+            values[i] = w;
+        } else if (n.IsVariable()) {
+            auto it = bounds.find(n.HashValue);
+            if (it == bounds.end()) {
+                throw std::runtime_error(fmt::format("the variable with hash value {} has no bounds\n", n.HashValue));
+            }
+            values[i] = Mul(w, it->second);
+        } else {
+            children.clear();
+            for (auto j : Operon::Tree::Indices(nodes, i)) { children.push_back(j); }
+            values[i] = Apply(nodes, i, values, children);
+            if (values[i].Finite() && n.Value != T{1}) { values[i] = Mul(w, values[i]); }
+        }
+
+        if (!values[i].Finite()) { return values[i]; }
+    }
+    return values.back();
+}
+
+} // namespace Operon
@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include "operon/interpreter/jit.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#if !defined(_WIN32)
+#include <dlfcn.h>
+#endif
+
+#include "operon/core/contracts.hpp"
+#include "operon/formatter/formatter.hpp"
+
+#ifndef OPERON_JIT_COMPILER
+#define OPERON_JIT_COMPILER "c++"
+#endif
+
+namespace Operon {
+
+namespace {
+    constexpr char const* DefaultFlags{"-O3 -march=native -fno-math-errno"};
+    constexpr char const* EntryPoint{"OperonJitEvaluate"};
+
+    auto GetEnv(char const* name, std::string const& value) -> std::string {
+        if (!value.empty()) { return value; }
+        auto const* env = std::getenv(name); // NOLINT(concurrency-mt-unsafe)
+        return env != nullptr ? std::string{env} : std::string{};
+    }
+
+    auto ReadFile(std::filesystem::path const& path) -> std::string {
+        std::ifstream in(path);
+        std::stringstream ss;
+        ss << in.rdbuf();
+        return ss.str();
+    }
+
+    // the source of the module: the function template generated by the formatter, instantiated for Operon::Scalar
+    auto ModuleSource(Operon::Tree const& tree, Operon::Vector<Operon::Hash> const& inputs) -> std::string {
+        Operon::Map<Operon::Hash, std::string> names;
+        for (auto h : inputs) { names.insert({ h, fmt::format("{}", h) }); }
+        auto const* scalar = sizeof(Operon::Scalar) == sizeof(float) ? "float" : "double";
+        return fmt::format("{}\nextern \"C\" auto {}({} const* const* x, {}* out, std::size_t n) -> void {{ model<{}>(x, out, n); }}\n",
+            CppFormatter::Format(tree, names, "model"), EntryPoint, scalar, scalar, scalar);
+    }
+} // namespace
+
+auto JitModel::ModuleDeleter::operator()(void* handle) const -> void
+{
+#if !defined(_WIN32)
+    dlclose(handle);
+#endif
+}
+
+JitModel::JitModel(Operon::Tree const& tree, JitOptions const& options)
+    : inputs_(CppFormatter::Inputs(tree))
+    , lag_(std::ranges::max(tree.Nodes(), {}, &Node::Lag).Lag)
+{
+#if defined(_WIN32)
+    throw std::runtime_error("JitModel: loading modules at runtime is not supported on this platform\n");
+#else
+    auto const source = ModuleSource(tree, inputs_);
+
+    auto compiler = GetEnv("OPERON_JIT_CXX", options.Compiler);
+    if (compiler.empty()) { compiler = OPERON_JIT_COMPILER; }
+    auto flags = GetEnv("OPERON_JIT_FLAGS", options.Flags);
+    if (flags.empty()) { flags = DefaultFlags; }
+
+    // each model is built in its own temporary directory, which is removed once the module is loaded
+    auto pattern = (std::filesystem::temp_directory_path() / "operon_jit_XXXXXX").string();
+    if (mkdtemp(pattern.data()) == nullptr) {
+        throw std::runtime_error(fmt::format("JitModel: could not create a temporary directory in {}\n", std::filesystem::temp_directory_path().string()));
+    }
+    std::filesystem::path const dir{pattern};
+    auto const src = dir / "model.cpp";
+    auto const lib = dir / "model.so";
+    auto const log = dir / "model.log";
+    std::ofstream(src) << source;
+
+    auto const cmd = fmt::format("\"{}\" -std=c++17 {} -shared -fPIC -o \"{}\" \"{}\" > \"{}\" 2>&1", compiler, flags, lib.string(), src.string(), log.string());
+    auto const status = std::system(cmd.c_str()); // NOLINT(concurrency-mt-unsafe)
+    if (status != 0) {
+        auto const msg = ReadFile(log);
+        std::filesystem::remove_all(dir);
+        throw std::runtime_error(fmt::format("JitModel: compilation failed ({}):\n{}\n", cmd, msg));
+    }
+
+    module_.reset(dlopen(lib.c_str(), RTLD_NOW | RTLD_LOCAL));
+    std::filesystem::remove_all(dir);
+    if (!module_) {
+        throw std::runtime_error(fmt::format("JitModel: could not load the compiled module: {}\n", dlerror())); // NOLINT(concurrency-mt-unsafe)
+    }
+    function_ = reinterpret_cast<Function>(dlsym(module_.get(), EntryPoint)); // NOLINT
+    if (function_ == nullptr) {
+        throw std::runtime_error(fmt::format("JitModel: the compiled module does not export {}\n", EntryPoint));
+    }
+#endif
+}
+
+auto JitModel::Evaluate(Operon::Dataset const& dataset, Operon::Range range, Operon::Span<Operon::Scalar> result) const -> void
+{
+    EXPECT(result.size() >= range.Size());
+    EXPECT(range.End() <= dataset.Rows<std::size_t>());
+    Operon::Vector<Operon::Scalar const*> columns;
+    columns.reserve(inputs_.size());
+    // the compiled code reads the columns directly, the transformed variables are copied (with the rows of the lags)
+    std::vector<std::vector<Operon::Scalar>> transformed;
+    for (auto h : inputs_) {
+        auto const v = dataset.GetVariable(h);
+        if (!v) {
+            throw std::runtime_error(fmt::format("JitModel: a variable with hash value {} could not be found in the dataset.\n", h));
+        }
+        auto const lagged = dataset.GetValues(h, range, lag_);
+        Operon::Span<Operon::Scalar const> values{ lagged.data(), range.Size() + lag_ };
+        if (v->Scale == 1 && v->Offset == 0) {
+            columns.push_back(values.data() + lag_);
+            continue;
+        }
+        auto& t = transformed.emplace_back(values.size());
+        std::ranges::transform(values, t.begin(), [&](auto x) { return x * v->Scale + v->Offset; });
+        columns.push_back(t.data() + lag_);
+    }
+    function_(columns.data(), result.data(), range.Size());
+}
+
+auto JitModel::Evaluate(Operon::Dataset const& dataset, Operon::Range range) const -> std::vector<Operon::Scalar>
+{
+    std::vector<Operon::Scalar> result(range.Size());
+    Evaluate(dataset, range, result);
+    return result;
+}
+
+} // namespace Operon
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <algorithm>
+#include <exception>
+#include <fmt/core.h>
+#include <stdexcept>
+#include <utility>
+
+#include "operon/operators/async_evaluator.hpp"
+
+namespace Operon {
+
+struct AsyncEvaluator::Pending {
+    std::vector<Operon::Individual> Individuals;
+    std::promise<BatchResult> Promise;
+    std::shared_future<BatchResult> Result{Promise.get_future().share()};
+    bool Submitted{false};
+};
+
+namespace {
+    auto CheckResult(AsyncEvaluator::BatchResult const& result, std::size_t count) -> void
+    {
+        if (result.size() != count) {
+            throw std::runtime_error(fmt::format("the batch function returned {} fitness values for {} individuals", result.size(), count));
+        }
+    }
+} // namespace
+
+AsyncEvaluator::AsyncEvaluator(Problem& problem, BatchFunction func, std::size_t batchSize, std::chrono::microseconds maxDelay)
+    : EvaluatorBase(problem)
+    , func_(std::move(func))
+    , batchSize_(batchSize)
+    , maxDelay_(maxDelay)
+{
+    if (!func_) { throw std::invalid_argument("the asynchronous evaluator needs a batch function"); }
+    if (batchSize_ == 0) { throw std::invalid_argument("the batch size must be at least one"); }
+}
+
+auto AsyncEvaluator::Submit(std::unique_lock<std::mutex>& lock) const -> void
+{
+    auto batch = std::exchange(pending_, nullptr);
+    batch->Submitted = true;
+    lock.unlock();
+    submitted_.notify_all();
+
+    ++batches_;
+    try {
+        auto result = func_(batch->Individuals).get();
+        CheckResult(result, batch->Individuals.size());
+        batch->Promise.set_value(std::move(result));
+    } catch (...) {
+        batch->Promise.set_exception(std::current_exception());
+    }
+}
+
+auto AsyncEvaluator::operator()(Operon::RandomGenerator& /*rng*/, Individual& ind, Operon::Span<Operon::Scalar> /*buf*/) const -> typename EvaluatorBase::ReturnType
+{
+    ++CallCount;
+    ++ResidualEvaluations;
+
+    std::unique_lock lock(mutex_);
+    if (!pending_) {
+        pending_ = std::make_shared<Pending>();
+        pending_->Individuals.reserve(batchSize_);
+    }
+    auto batch = pending_;
+    auto const index = batch->Individuals.size();
+    batch->Individuals.push_back(ind);
+
+    // the batch is still pending after the delay if no other worker filled it or timed out first
+    if (batch->Individuals.size() >= batchSize_ || !submitted_.wait_for(lock, maxDelay_, [&]() { return batch->Submitted; })) {
+        Submit(lock);
+    } else {
+        lock.unlock();
+    }
+    return batch->Result.get()[index];
+}
+
+auto AsyncEvaluator::Evaluate(Operon::RandomGenerator& /*rng*/, Operon::Span<Individual> individuals, Operon::Vector<Operon::Scalar>& /*buf*/) const -> void
+{
+    CallCount += individuals.size();
+    ResidualEvaluations += individuals.size();
+
+    // every submitted batch is waited for before an error is reported, the batch function may still read the individuals
+    std::exception_ptr error;
+    std::vector<std::future<BatchResult>> futures;
+    for (auto i = 0UL; i < individuals.size(); i += batchSize_) {
+        try {
+            futures.push_back(func_(individuals.subspan(i, std::min(batchSize_, individuals.size() - i))));
+        } catch (...) {
+            error = std::current_exception();
+            break;
+        }
+        ++batches_;
+    }
+
+    for (auto k = 0UL; k < futures.size(); ++k) {
+        auto const i = k * batchSize_;
+        auto const n = std::min(batchSize_, individuals.size() - i);
+        try {
+            auto result = futures[k].get();
+            CheckResult(result, n);
+            for (auto j = 0UL; j < n; ++j) { individuals[i + j].Fitness = std::move(result[j]); }
+        } catch (...) {
+            if (!error) { error = std::current_exception(); }
+        }
+    }
+    if (error) { std::rethrow_exception(error); }
+}
+
+} // namespace Operon
@@ -6,9 +6,11 @@
 #include <random>
 #include <span>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include "operon/operators/creator.hpp"
+#include "operon/core/contracts.hpp"
 #include "operon/core/pset.hpp"
 #include "operon/core/tree.hpp"
 #include "operon/core/node.hpp"
@@ -16,85 +18,110 @@
 #include "operon/random/random.hpp"
 
 namespace Operon {
-auto BalancedTreeCreator::operator()(Operon::RandomGenerator& random, size_t targetLen, size_t /*args*/, size_t /*args*/) const -> Tree
-{
-    auto const& pset = GetPrimitiveSet();
-    auto [minFunctionArity, maxFunctionArity] = pset.FunctionArityLimits();
-
-    auto const& variables = GetVariables();
-    auto init = [&](Node& node) {
-        if (node.IsLeaf()) {
-            if (node.IsVariable()) {
-                node.HashValue = *Random::Sample(random, variables.begin(), variables.end());
-                node.CalculatedHashValue = node.HashValue;
+namespace {
+    using U = std::tuple<Node, size_t, size_t>;
+
+    // builds the postfix nodes of a tree into postfix
+    // - tuples is a buffer reused between the trees
+    auto CreateBalanced(Operon::RandomGenerator& random, PrimitiveSet const& pset, Operon::Span<Operon::Hash const> variables, uint8_t maxLag,
+        double irregularityBias, size_t targetLen, std::vector<U>& tuples, Operon::Vector<Node>& postfix) -> void
+    {
+        auto [minFunctionArity, maxFunctionArity] = pset.FunctionArityLimits();
+
+        auto init = [&](Node& node) {
+            if (node.IsLeaf()) {
+                if (node.IsVariable()) {
+                    node.HashValue = *Random::Sample(random, variables.begin(), variables.end());
+                    node.CalculatedHashValue = node.HashValue;
+                    node.Lag = CreatorBase::SampleLag(random, maxLag);
+                }
+                node.Value = 1;
             }
-            node.Value = 1;
-        }
-    };
+        };
 
-    // length one can be achieved with a single leaf
-    // otherwise the minimum achievable length is minFunctionArity+1
-    if (targetLen > 1 && targetLen < minFunctionArity + 1) {
-        targetLen = minFunctionArity + 1;
-    }
+        // length one can be achieved with a single leaf
+        // otherwise the minimum achievable length is minFunctionArity+1
+        if (targetLen > 1 && targetLen < minFunctionArity + 1) {
+            targetLen = minFunctionArity + 1;
+        }
 
-    using U = std::tuple<Node, size_t, size_t>;
+        tuples.clear();
+        tuples.reserve(targetLen);
 
-    std::vector<U> tuples;
-    tuples.reserve(targetLen);
+        auto maxArity = std::min(maxFunctionArity, targetLen - 1);
+        auto minArity = std::min(minFunctionArity, maxArity); // -1 because we start with a root
 
-    auto maxArity = std::min(maxFunctionArity, targetLen - 1);
-    auto minArity = std::min(minFunctionArity, maxArity); // -1 because we start with a root
+        auto root = pset.SampleRandomSymbol(random, minArity, maxArity);
+        init(root);
 
-    auto root = pset.SampleRandomSymbol(random, minArity, maxArity);
-    init(root);
+        if (root.IsLeaf()) {
+            postfix.assign(1, root);
+            return;
+        }
 
-    if (root.IsLeaf()) {
-        return Tree({ root }).UpdateNodes();
-    }
+        tuples.emplace_back(root, 1, 1);
 
-    tuples.emplace_back(root, 1, 1);
+        size_t openSlots = root.Arity;
 
-    size_t openSlots = root.Arity;
+        std::bernoulli_distribution sampleIrregular(irregularityBias);
 
-    std::bernoulli_distribution sampleIrregular(irregularityBias_);
+        for (size_t i = 0; i < tuples.size(); ++i) {
+            auto [node, nodeDepth, childIndex] = tuples[i];
+            auto childDepth = nodeDepth + 1;
+            std::get<2>(tuples[i]) = tuples.size();
+            for (int j = 0; j < node.Arity; ++j) {
+                maxArity = openSlots - tuples.size() > 1 && sampleIrregular(random)
+                    ? 0
+                    : std::min(maxFunctionArity, targetLen - openSlots - 1);
 
-    for (size_t i = 0; i < tuples.size(); ++i) {
-        auto [node, nodeDepth, childIndex] = tuples[i];
-        auto childDepth = nodeDepth + 1;
-        std::get<2>(tuples[i]) = tuples.size();
-        for (int j = 0; j < node.Arity; ++j) {
-            maxArity = openSlots - tuples.size() > 1 && sampleIrregular(random)
-                ? 0
-                : std::min(maxFunctionArity, targetLen - openSlots - 1);
+                // fall back to a leaf node if the desired arity is not achievable with the current primitive set
+                if (maxArity < minFunctionArity) {
+                    minArity = maxArity = 0;
+                }
 
-            // fall back to a leaf node if the desired arity is not achievable with the current primitive set
-            if (maxArity < minFunctionArity) {
-                minArity = maxArity = 0;
+                auto child = pset.SampleRandomSymbol(random, minArity, maxArity);
+                init(child);
+                tuples.emplace_back(child, childDepth, 0);
+                openSlots += child.Arity;
             }
-
-            auto child = pset.SampleRandomSymbol(random, minArity, maxArity);
-            init(child);
-            tuples.emplace_back(child, childDepth, 0);
-            openSlots += child.Arity;
         }
-    }
 
-    Operon::Vector<Node> postfix(tuples.size());
-    auto idx = tuples.size();
+        postfix.resize(tuples.size());
+        auto idx = tuples.size();
 
-    auto add = [&](const U& t, auto&& ref) {
-        auto [node, _, nodeChildIndex] = t;
-        postfix[--idx] = node;
-        if (node.IsLeaf()) {
-            return;
-        }
-        for (size_t i = nodeChildIndex; i < nodeChildIndex + node.Arity; ++i) {
-            ref(tuples[i], ref);
-        }
-    };
-    add(tuples.front(), add);
-    auto tree = Tree(postfix).UpdateNodes();
+        auto add = [&](const U& t, auto&& ref) {
+            auto [node, _, nodeChildIndex] = t;
+            postfix[--idx] = node;
+            if (node.IsLeaf()) {
+                return;
+            }
+            for (size_t i = nodeChildIndex; i < nodeChildIndex + node.Arity; ++i) {
+                ref(tuples[i], ref);
+            }
+        };
+        add(tuples.front(), add);
+    }
+} // namespace
+
+auto BalancedTreeCreator::operator()(Operon::RandomGenerator& random, size_t targetLen, size_t /*args*/, size_t /*args*/) const -> Tree
+{
+    auto const& pset = GetPrimitiveSet();
+    std::vector<U> tuples;
+    Operon::Vector<Node> postfix;
+    CreateBalanced(random, pset, GetVariables(), GetMaxLag(), irregularityBias_, targetLen, tuples, postfix);
+    auto tree = Tree(std::move(postfix)).UpdateNodes();
     return tree;
 }
+
+auto BalancedTreeCreator::Create(Operon::Span<Operon::RandomGenerator> rngs, Operon::Span<size_t const> lengths, size_t /*args*/, size_t /*args*/, Operon::Span<Tree> trees) const -> void
+{
+    EXPECT(rngs.size() >= trees.size());
+    EXPECT(lengths.size() >= trees.size());
+    auto const& pset = GetPrimitiveSet();
+    std::vector<U> tuples;
+    for (auto i = 0UL; i < trees.size(); ++i) {
+        CreateBalanced(rngs[i], pset, GetVariables(), GetMaxLag(), irregularityBias_, lengths[i], tuples, trees[i].Nodes());
+        trees[i].UpdateNodes();
+    }
+}
 } // namespace Operon
@@ -0,0 +1,17 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include "operon/operators/creator.hpp"
+#include "operon/core/contracts.hpp"
+#include "operon/core/tree.hpp"
+
+namespace Operon {
+auto CreatorBase::Create(Operon::Span<Operon::RandomGenerator> rngs, Operon::Span<size_t const> lengths, size_t minDepth, size_t maxDepth, Operon::Span<Tree> trees) const -> void
+{
+    EXPECT(rngs.size() >= trees.size());
+    EXPECT(lengths.size() >= trees.size());
+    for (auto i = 0UL; i < trees.size(); ++i) {
+        trees[i] = (*this)(rngs[i], lengths[i], minDepth, maxDepth);
+    }
+}
+} // namespace Operon
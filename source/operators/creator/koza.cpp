@@ -2,11 +2,15 @@
 // SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
 
 #include <cstddef>
+#include <cstdint>
 #include <algorithm>
 #include <random>
 #include <span>
+#include <utility>
+#include <vector>
 
 #include "operon/operators/creator.hpp"
+#include "operon/core/node_arena.hpp"
 #include "operon/core/pset.hpp"
 #include "operon/core/tree.hpp"
 #include "operon/core/contracts.hpp"
@@ -15,63 +19,108 @@
 #include "operon/random/random.hpp"
 
 namespace Operon {
-auto GrowTreeCreator::operator()(Operon::RandomGenerator& random, size_t /*args*/, size_t minDepth, size_t maxDepth) const -> Tree
-{
-    minDepth = std::max(size_t{1}, minDepth);
-    EXPECT(minDepth <= maxDepth);
-    auto const& pset = GetPrimitiveSet();
-
-    auto const& t = pset.FunctionArityLimits();
-
-    size_t minFunctionArity = std::get<0>(t);
-    size_t maxFunctionArity = std::get<1>(t);
-
-    auto const& variables = GetVariables();
-    auto init = [&](Node& node) {
-        if (node.IsLeaf()) {
-            if (node.IsVariable()) {
-                node.HashValue = *Operon::Random::Sample(random, variables.begin(), variables.end());
-                node.CalculatedHashValue = node.HashValue;
-            }
-            node.Value = 1;
-        }
+namespace {
+    // the buffers reused between the trees
+    struct Buffers {
+        Operon::Vector<Node> Nodes;                      // prefix order
+        std::vector<std::pair<size_t, size_t>> Open;     // the function nodes being expanded: {prefix index, missing children}
     };
 
-    Operon::Vector<Node> nodes;
-    size_t minArity = minFunctionArity;
-    size_t maxArity = maxFunctionArity;
-
-    std::uniform_int_distribution<size_t> dist(minDepth, maxDepth);
-    auto actualDepthLimit = dist(random);
-
-    auto const grow = [&](size_t depth, auto&& ref) {
-        auto minDepthReached = depth >= minDepth;
+    // builds the postfix nodes of a tree into postfix, without recursion
+    // - the nodes are sampled in prefix order and their Length, Depth, Level and Parent are filled in as their subtrees
+    //   are closed, the reversed prefix sequence is the postfix sequence of the tree (with the children mirrored), so
+    //   the result does not need Tree::UpdateNodes
+    auto CreateGrow(Operon::RandomGenerator& random, PrimitiveSet const& pset, Operon::Span<Operon::Hash const> variables, uint8_t maxLag,
+        size_t minDepth, size_t maxDepth, Buffers& buffers, Operon::Vector<Node>& postfix) -> void
+    {
+        minDepth = std::max(size_t{1}, minDepth);
+        EXPECT(minDepth <= maxDepth);
+
+        auto [minFunctionArity, maxFunctionArity] = pset.FunctionArityLimits();
+
+        auto init = [&](Node& node) {
+            if (node.IsLeaf()) {
+                if (node.IsVariable()) {
+                    node.HashValue = *Operon::Random::Sample(random, variables.begin(), variables.end());
+                    node.CalculatedHashValue = node.HashValue;
+                    node.Lag = CreatorBase::SampleLag(random, maxLag);
+                }
+                node.Value = 1;
+            }
+        };
 
-        minArity = 0;
-        maxArity = 0;
+        auto actualDepthLimit = std::uniform_int_distribution<size_t>(minDepth, maxDepth)(random);
 
-        if (depth < actualDepthLimit) {
-            minArity = minDepthReached ? 0 : minFunctionArity;
-            maxArity = maxFunctionArity;
-        }
+        auto& nodes = buffers.Nodes;
+        auto& open = buffers.Open;
+        nodes.clear();
+        open.clear();
 
-        auto node = pset.SampleRandomSymbol(random, minArity, maxArity);
-        init(node);
+        do {
+            auto const parent = open.empty() ? size_t{0} : open.back().first;
+            auto const depth = open.empty() ? size_t{1} : nodes[parent].Level + 1UL;
 
-        nodes.push_back(node);
+            size_t minArity = 0;
+            size_t maxArity = 0;
+            if (depth < actualDepthLimit) {
+                minArity = depth >= minDepth ? 0 : minFunctionArity;
+                maxArity = maxFunctionArity;
+            }
 
-        if (node.IsLeaf()) {
-            return;
-        }
+            auto node = pset.SampleRandomSymbol(random, minArity, maxArity);
+            init(node);
+            node.Length = 0;
+            node.Depth = 1;
+            node.Level = static_cast<uint16_t>(depth);
+            node.Parent = static_cast<uint16_t>(parent);
+            nodes.push_back(node);
+
+            if (!node.IsLeaf()) {
+                open.emplace_back(nodes.size() - 1, node.Arity);
+                continue;
+            }
 
-        for (size_t i = 0; i < node.Arity; ++i) {
-            ref(depth + 1, ref);
+            // close the function nodes whose last child was completed
+            auto child = nodes.size() - 1;
+            while (!open.empty()) {
+                auto& [p, missing] = open.back();
+                auto& s = nodes[p];
+                s.Depth = std::max(s.Depth, static_cast<uint16_t>(nodes[child].Depth + 1));
+                if (--missing > 0) { break; }
+                s.Length = static_cast<uint16_t>(nodes.size() - p - 1);
+                child = p;
+                open.pop_back();
+            }
+        } while (!open.empty());
+
+        // prefix index i becomes postfix index n - 1 - i (the root keeps its parent index of zero)
+        auto const n = nodes.size();
+        postfix.resize(n);
+        postfix[n - 1] = nodes.front();
+        for (auto i = 1UL; i < n; ++i) {
+            auto& node = postfix[n - 1 - i];
+            node = nodes[i];
+            node.Parent = static_cast<uint16_t>(n - 1 - node.Parent);
         }
-    };
+    }
+} // namespace
 
-    grow(1, grow);
+auto GrowTreeCreator::operator()(Operon::RandomGenerator& random, size_t /*args*/, size_t minDepth, size_t maxDepth) const -> Tree
+{
+    thread_local Buffers buffers;
+    auto postfix = NodeArena::Acquire(0);
+    CreateGrow(random, GetPrimitiveSet(), GetVariables(), GetMaxLag(), minDepth, maxDepth, buffers, postfix);
+    return Tree(std::move(postfix));
+}
 
-    std::reverse(nodes.begin(), nodes.end());
-    return Tree(nodes).UpdateNodes();
+auto GrowTreeCreator::Create(Operon::Span<Operon::RandomGenerator> rngs, Operon::Span<size_t const> lengths, size_t minDepth, size_t maxDepth, Operon::Span<Tree> trees) const -> void
+{
+    EXPECT(rngs.size() >= trees.size());
+    EXPECT(lengths.size() >= trees.size());
+    auto const& pset = GetPrimitiveSet();
+    Buffers buffers;
+    for (auto i = 0UL; i < trees.size(); ++i) {
+        CreateGrow(rngs[i], pset, GetVariables(), GetMaxLag(), minDepth, maxDepth, buffers, trees[i].Nodes());
+    }
 }
 } // namespace Operon
@@ -15,134 +15,195 @@
 #include "operon/core/tree.hpp"
 #include "operon/core/contracts.hpp"
 #include "operon/core/node.hpp"
+#include "operon/core/node_arena.hpp"
 #include "operon/core/types.hpp"
 #include "operon/random/random.hpp"
 
 namespace Operon {
-auto ProbabilisticTreeCreator::operator()(Operon::RandomGenerator& random, size_t targetLen, size_t /*args*/, size_t /*args*/) const -> Tree
-{
-    EXPECT(targetLen > 0);
-    auto const& variables = GetVariables();
-
-    auto init = [&](Node& node) {
-        if (node.IsLeaf()) {
-            if (node.IsVariable()) {
-                node.HashValue = *Random::Sample(random, variables.begin(), variables.end());
-                node.CalculatedHashValue = node.HashValue;
-            }
-            node.Value = 1;
-        }
+namespace {
+    // a node whose subtree is being written: its breadth index, its postfix index and its next child
+    struct Frame {
+        size_t Index;
+        size_t Position;
+        size_t Next;
     };
 
-    const auto& pset = GetPrimitiveSet();
-    auto [minFunctionArity, maxFunctionArity] = pset.FunctionArityLimits();
-
-    // length one can be achieved with a single leaf
-    // otherwise the minimum achievable length is minFunctionArity+1
-    if (targetLen > 1 && targetLen < minFunctionArity + 1) {
-        targetLen = minFunctionArity + 1;
-    }
-
-    Operon::Vector<Node> nodes;
-    nodes.reserve(targetLen);
-
-    auto maxArity = std::min(maxFunctionArity, targetLen - 1);
-    auto minArity = std::min(minFunctionArity, maxArity);
-
-    auto root = pset.SampleRandomSymbol(random, minArity, maxArity);
-    init(root);
-
-    if (root.IsLeaf()) {
-        return Tree({ root }).UpdateNodes();
-    }
-
-    root.Depth = 1;
-    nodes.push_back(root);
+    // the buffers reused between the trees
+    struct Buffers {
+        Operon::Vector<Node> Nodes;
+        std::deque<size_t> Queue;
+        std::vector<size_t> ChildIndices;
+        std::vector<Frame> Open;
+    };
 
-    std::deque<size_t> q;
-    for (size_t i = 0; i < root.Arity; ++i) {
-        auto d = root.Depth + 1U;
-        q.push_back(d);
-    }
+    // builds the postfix nodes of a tree into postfix
+    auto CreateProbabilistic(Operon::RandomGenerator& random, PrimitiveSet const& pset, Operon::Span<Operon::Hash const> variables, uint8_t maxLag,
+        double irregularityBias, size_t targetLen, Buffers& buffers, Operon::Vector<Node>& postfix) -> void
+    {
+        EXPECT(targetLen > 0);
+
+        auto init = [&](Node& node) {
+            if (node.IsLeaf()) {
+                if (node.IsVariable()) {
+                    node.HashValue = *Random::Sample(random, variables.begin(), variables.end());
+                    node.CalculatedHashValue = node.HashValue;
+                    node.Lag = CreatorBase::SampleLag(random, maxLag);
+                }
+                node.Value = 1;
+            }
+        };
 
-    // emulate a random dequeue operation
-    auto randomDequeue = [&]() {
-        EXPECT(!q.empty());
-        auto j = std::uniform_int_distribution<size_t>(0, q.size() - 1)(random);
-        std::swap(q[j], q.front());
-        auto t = q.front();
-        q.pop_front();
-        return t;
-    };
+        auto [minFunctionArity, maxFunctionArity] = pset.FunctionArityLimits();
 
-    root.Parent = 0;
+        // length one can be achieved with a single leaf
+        // otherwise the minimum achievable length is minFunctionArity+1
+        if (targetLen > 1 && targetLen < minFunctionArity + 1) {
+            targetLen = minFunctionArity + 1;
+        }
 
-    std::bernoulli_distribution sampleIrregular(irregularityBias_);
+        auto& nodes = buffers.Nodes;
+        nodes.clear();
+        nodes.reserve(targetLen);
 
-    while (!q.empty()) {
-        auto childDepth = randomDequeue();
+        auto maxArity = std::min(maxFunctionArity, targetLen - 1);
+        auto minArity = std::min(minFunctionArity, maxArity);
 
-        maxArity = q.size() > 1 && sampleIrregular(random)
-            ? 0
-            : std::min(maxFunctionArity, targetLen - q.size() - nodes.size() - 1);
+        auto root = pset.SampleRandomSymbol(random, minArity, maxArity);
+        init(root);
 
-        // certain lengths cannot be generated using available symbols
-        // in this case we push the target length towards an achievable value
-        if (maxArity > 0 && maxArity < minFunctionArity) {
-            EXPECT(targetLen > 0);
-            EXPECT(targetLen == 1 || targetLen >= minFunctionArity + 1);
-            targetLen -= minFunctionArity - maxArity;
-            maxArity = std::min(maxFunctionArity, targetLen - q.size() - nodes.size() - 1);
+        if (root.IsLeaf()) {
+            root.Level = 1;
+            postfix.assign(1, root);
+            return;
         }
-        minArity = std::min(minFunctionArity, maxArity);
 
-        auto node = pset.SampleRandomSymbol(random, minArity, maxArity);
+        root.Depth = 1;
+        nodes.push_back(root);
 
-        init(node);
-        node.Depth = static_cast<uint16_t>(childDepth);
-
-        for (size_t i = 0; i < node.Arity; ++i) {
-            q.push_back(childDepth + 1);
+        auto& q = buffers.Queue;
+        q.clear();
+        for (size_t i = 0; i < root.Arity; ++i) {
+            auto d = root.Depth + 1U;
+            q.push_back(d);
         }
 
-        nodes.push_back(node);
-    }
+        // emulate a random dequeue operation
+        auto randomDequeue = [&]() {
+            EXPECT(!q.empty());
+            auto j = std::uniform_int_distribution<size_t>(0, q.size() - 1)(random);
+            std::swap(q[j], q.front());
+            auto t = q.front();
+            q.pop_front();
+            return t;
+        };
+
+        root.Parent = 0;
+
+        std::bernoulli_distribution sampleIrregular(irregularityBias);
+
+        while (!q.empty()) {
+            auto childDepth = randomDequeue();
+
+            maxArity = q.size() > 1 && sampleIrregular(random)
+                ? 0
+                : std::min(maxFunctionArity, targetLen - q.size() - nodes.size() - 1);
+
+            // certain lengths cannot be generated using available symbols
+            // in this case we push the target length towards an achievable value
+            if (maxArity > 0 && maxArity < minFunctionArity) {
+                EXPECT(targetLen > 0);
+                EXPECT(targetLen == 1 || targetLen >= minFunctionArity + 1);
+                targetLen -= minFunctionArity - maxArity;
+                maxArity = std::min(maxFunctionArity, targetLen - q.size() - nodes.size() - 1);
+            }
+            minArity = std::min(minFunctionArity, maxArity);
 
-    std::sort(nodes.begin(), nodes.end(), [](const auto& lhs, const auto& rhs) { return lhs.Depth < rhs.Depth; });
-    std::vector<size_t> childIndices(nodes.size());
+            auto node = pset.SampleRandomSymbol(random, minArity, maxArity);
 
-    size_t c = 1;
-    for (size_t i = 0; i < nodes.size(); ++i) {
-        auto& node = nodes[i];
+            init(node);
+            node.Depth = static_cast<uint16_t>(childDepth);
 
-        if (node.IsLeaf()) {
-            continue;
-        }
+            for (size_t i = 0; i < node.Arity; ++i) {
+                q.push_back(childDepth + 1);
+            }
 
-        childIndices[i] = c;
-        c += nodes[i].Arity;
-    }
+            nodes.push_back(node);
+        }
 
-    Operon::Vector<Node> postfix(nodes.size());
-    size_t idx = nodes.size();
+        std::sort(nodes.begin(), nodes.end(), [](const auto& lhs, const auto& rhs) { return lhs.Depth < rhs.Depth; });
+        auto& childIndices = buffers.ChildIndices;
+        childIndices.assign(nodes.size(), 0);
 
-    const auto add = [&](size_t i, auto&& ref) {
-        const auto& node = nodes[i];
+        size_t c = 1;
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            auto& node = nodes[i];
 
-        postfix[--idx] = node;
+            if (node.IsLeaf()) {
+                continue;
+            }
 
-        if (node.IsLeaf()) {
-            return;
+            childIndices[i] = c;
+            c += nodes[i].Arity;
         }
 
-        for (size_t j = 0; j < node.Arity; ++j) {
-            ref(childIndices[i] + j, ref);
+        // the breadth sequence is written from the back in prefix order, which gives the postfix sequence (with the
+        // children mirrored), the Length, Depth, Level and Parent of each node are filled in when its subtree is closed
+        auto const n = nodes.size();
+        postfix.resize(n);
+        size_t idx = n;
+
+        auto emit = [&](size_t i, size_t parent, size_t level) {
+            auto& node = postfix[--idx];
+            node = nodes[i];
+            node.Length = 0;
+            node.Depth = 1;
+            node.Level = static_cast<uint16_t>(level);
+            node.Parent = static_cast<uint16_t>(parent);
+            return idx;
+        };
+
+        auto& open = buffers.Open;
+        open.clear();
+        open.push_back({ 0, emit(0, 0, 1), 0 });
+
+        while (!open.empty()) {
+            auto [i, pos, next] = open.back();
+            auto const& node = postfix[pos];
+
+            if (next == node.Arity) {
+                // the subtree of the node occupies [idx, pos]
+                postfix[pos].Length = static_cast<uint16_t>(pos - idx);
+                open.pop_back();
+                if (!open.empty()) {
+                    auto& p = postfix[open.back().Position];
+                    p.Depth = std::max(p.Depth, static_cast<uint16_t>(node.Depth + 1));
+                }
+                continue;
+            }
+
+            ++open.back().Next;
+            auto const c = childIndices[i] + next;
+            open.push_back({ c, emit(c, pos, node.Level + 1UL), 0 });
         }
-    };
+    }
+} // namespace
 
-    add(0, add);
+auto ProbabilisticTreeCreator::operator()(Operon::RandomGenerator& random, size_t targetLen, size_t /*args*/, size_t /*args*/) const -> Tree
+{
+    thread_local Buffers buffers;
+    auto postfix = NodeArena::Acquire(targetLen);
+    CreateProbabilistic(random, GetPrimitiveSet(), GetVariables(), GetMaxLag(), irregularityBias_, targetLen, buffers, postfix);
+    return Tree(std::move(postfix));
+}
 
-    auto tree = Tree(postfix).UpdateNodes();
-    return tree;
+auto ProbabilisticTreeCreator::Create(Operon::Span<Operon::RandomGenerator> rngs, Operon::Span<size_t const> lengths, size_t /*args*/, size_t /*args*/, Operon::Span<Tree> trees) const -> void
+{
+    EXPECT(rngs.size() >= trees.size());
+    EXPECT(lengths.size() >= trees.size());
+    auto const& pset = GetPrimitiveSet();
+    Buffers buffers;
+    for (auto i = 0UL; i < trees.size(); ++i) {
+        CreateProbabilistic(rngs[i], pset, GetVariables(), GetMaxLag(), irregularityBias_, lengths[i], buffers, trees[i].Nodes());
+    }
 }
 } // namespace Operon
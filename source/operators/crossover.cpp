@@ -2,7 +2,9 @@
 // SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
 
 #include <fmt/core.h>
+#include <optional>
 #include <random>
+#include <utility>
 
 #include "operon/core/contracts.hpp"
 #include "operon/operators/crossover.hpp"
@@ -57,6 +59,56 @@ static auto SelectRandomBranch(Operon::RandomGenerator& random, Tree const& tree
 
 }
 
+SwapLocationIndex::SwapLocationIndex(Tree const& tree)
+    : length_(tree.Length())
+    , depth_(tree.Depth())
+{
+    auto const& nodes = tree.Nodes();
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        auto const& n = nodes[i];
+        if (n.IsLeaf()) {
+            leaves_.push_back(static_cast<uint32_t>(i));
+        } else {
+            functions_.push_back({ static_cast<uint16_t>(n.Length + 1U), n.Depth, static_cast<uint32_t>(i) });
+        }
+    }
+    std::ranges::stable_sort(functions_, std::less{}, &Entry::Length);
+}
+
+auto SwapLocationIndex::Sample(Operon::RandomGenerator& random, double internalProb, Limits length, Limits depth) const -> size_t
+{
+    if (length_ == 1) {
+        return 0;
+    }
+
+    // the function nodes with an admissible length form a contiguous range
+    auto lo = std::ranges::lower_bound(functions_, length.first, std::less{}, &Entry::Length);
+    auto hi = std::ranges::upper_bound(lo, functions_.end(), length.second, std::less{}, &Entry::Length);
+    auto const n = static_cast<size_t>(std::distance(lo, hi));
+
+    // rejection sampling on the depth, the depth limit rarely excludes many candidates
+    std::optional<size_t> function;
+    constexpr auto maxAttempts{8};
+    for (auto k = 0; n > 0 && k < maxAttempts && !function; ++k) {
+        auto const& e = *(lo + static_cast<int64_t>(Operon::Random::Uniform(random, size_t{0}, n - 1)));
+        if (!NotIn(depth, e.Depth)) { function = e.Index; }
+    }
+    if (n > 0 && !function) {
+        auto admissible = [&](auto const& e) { return !NotIn(depth, e.Depth); };
+        if (auto const m = static_cast<size_t>(std::count_if(lo, hi, admissible)); m > 0) {
+            auto k = Operon::Random::Uniform(random, size_t{0}, m - 1);
+            function = std::find_if(lo, hi, [&](auto const& e) { return admissible(e) && k-- == 0; })->Index;
+        }
+    }
+
+    // every leaf has length and depth one
+    auto const leaves = NotIn(length, 1) || NotIn(depth, 1) ? size_t{0} : leaves_.size();
+    if (function && (std::bernoulli_distribution(internalProb)(random) || leaves == 0)) {
+        return *function;
+    }
+    return leaves > 0 ? *Operon::Random::Sample(random, leaves_.begin(), leaves_.end()) : 0;
+}
+
 auto SubtreeCrossover::FindCompatibleSwapLocations(Operon::RandomGenerator& random, Tree const& lhs, Tree const& rhs) const -> std::pair<size_t, size_t>
 {
     using Signed = std::make_signed<size_t>::type;
@@ -76,17 +128,40 @@ auto SubtreeCrossover::FindCompatibleSwapLocations(Operon::RandomGenerator& rand
     return std::make_pair(i, j);
 }
 
+auto SubtreeCrossover::FindCompatibleSwapLocations(Operon::RandomGenerator& random, Tree const& lhs, Tree const& rhs, SwapLocationIndex const& lhsIndex, SwapLocationIndex const& rhsIndex) const -> std::pair<size_t, size_t>
+{
+    EXPECT(lhsIndex.Length() == lhs.Length() && rhsIndex.Length() == rhs.Length());
+    using Signed = std::make_signed<size_t>::type;
+    auto diff = static_cast<Signed>(lhs.Length() - maxLength_ + 1);
+
+    auto i = lhsIndex.Sample(random, internalProbability_, Limits{std::max(diff, Signed{1}), lhs.Length()}, Limits{size_t{1}, lhs.Depth()});
+    auto maxBranchDepth = std::max(static_cast<Signed>(maxDepth_ - lhs[i].Level), Signed{1});
+    auto partialTreeLength = (lhs.Length() - (lhs[i].Length + 1));
+    auto maxBranchLength = std::max(static_cast<Signed>(maxLength_ - partialTreeLength), Signed{1});
+
+    auto j = rhsIndex.Sample(random, internalProbability_, Limits{1UL, maxBranchLength}, Limits{1UL, maxBranchDepth});
+    return std::make_pair(i, j);
+}
+
 auto SubtreeCrossover::operator()(Operon::RandomGenerator& random, const Tree& lhs, const Tree& rhs) const -> Tree
+{
+    Tree child;
+    Recombine(random, lhs, rhs, child);
+    return child;
+}
+
+auto SubtreeCrossover::Recombine(Operon::RandomGenerator& random, Tree const& lhs, Tree const& rhs, Tree& child) const -> void
 {
     auto [i, j] = FindCompatibleSwapLocations(random, lhs, rhs);
-    auto child = Cross(lhs, rhs, i, j);
+    if (std::as_const(child).Nodes().capacity() == 0) {
+        child.Nodes() = NodeArena::Acquire(rhs[j].Length - lhs[i].Length + lhs.Length());
+    }
+    Cross(lhs, rhs, i, j, child);
 
     auto maxDepth{std::max(maxDepth_, lhs.Depth())};
     auto maxLength{std::max(maxLength_, lhs.Length())};
 
     ENSURE(child.Depth() <= maxDepth);
     ENSURE(child.Length() <= maxLength);
-
-    return child;
 }
 } // namespace Operon
@@ -0,0 +1,177 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <cmath>
+#include <fmt/core.h>
+#include <future>
+#include <stdexcept>
+
+#include "operon/core/serialization.hpp"
+#include "operon/interpreter/interpreter.hpp"
+#include "operon/operators/distributed_evaluator.hpp"
+
+namespace Operon {
+
+namespace {
+    auto ReadStatistics(Operon::Span<uint8_t const> response, std::size_t count) -> std::vector<ErrorAccumulator>
+    {
+        std::size_t offset{0};
+        auto const n = Serialization::Read<uint64_t>(response, offset);
+        if (n != count) {
+            throw std::runtime_error(fmt::format("the response contains {} statistics instead of {}", n, count));
+        }
+        std::vector<ErrorAccumulator> stats;
+        stats.reserve(n);
+        for (auto i = 0UL; i < n; ++i) {
+            stats.push_back(ErrorAccumulator::FromState(Serialization::Read<ErrorAccumulator::State>(response, offset)));
+        }
+        return stats;
+    }
+} // namespace
+
+EvaluationWorker::EvaluationWorker(DefaultDispatch const& dtable, Dataset const& shard, std::string const& target, Range range)
+    : dtable_(dtable)
+    , shard_(shard)
+    , target_(shard.GetValues(target).subspan(range.Start(), range.Size()))
+    , range_(range)
+{
+}
+
+auto EvaluationWorker::Process(Operon::Span<uint8_t const> request) const -> std::vector<uint8_t>
+{
+    std::size_t offset{0};
+    auto const count = Serialization::Read<uint64_t>(request, offset);
+
+    std::vector<uint8_t> response;
+    Serialization::Write<uint64_t>(response, count);
+    for (auto i = 0UL; i < count; ++i) {
+        auto const tree = Serialization::ReadTree(request, offset);
+        auto const coeff = tree.GetCoefficients();
+        Interpreter<Operon::Scalar, DefaultDispatch> const interpreter{dtable_.get(), shard_.get(), tree};
+
+        // the values are streamed into the statistics, the shard predictions are never stored
+        ErrorAccumulator stats;
+        interpreter.ForEachBatch(coeff, range_, [&](auto row, Operon::Span<Operon::Scalar const> values) {
+            stats(values, target_.subspan(row, values.size()));
+        });
+        Serialization::Write(response, stats.GetState());
+    }
+    return response;
+}
+
+#if defined(HAVE_MPI)
+namespace {
+    constexpr int ShutdownTag{0};
+} // namespace
+
+MpiEvaluationNode::MpiEvaluationNode(MPI_Comm comm, int rank)
+    : comm_(comm)
+    , rank_(rank)
+{
+    int provided{0};
+    MPI_Query_thread(&provided);
+    if (provided < MPI_THREAD_MULTIPLE) {
+        throw std::runtime_error("the distributed evaluator requires MPI to be initialized with MPI_THREAD_MULTIPLE");
+    }
+    int* maxTag{nullptr};
+    int flag{0};
+    MPI_Comm_get_attr(comm_, MPI_TAG_UB, static_cast<void*>(&maxTag), &flag);
+    maxTag_ = flag != 0 ? *maxTag : 32767; // NOLINT (the smallest upper bound allowed by the standard)
+}
+
+auto MpiEvaluationNode::Evaluate(std::vector<uint8_t> const& request) const -> std::vector<uint8_t>
+{
+    // tags cycle through [1, maxTag], zero is reserved for the shutdown message
+    auto const tag = 1 + (tag_.fetch_add(1) % maxTag_);
+    MPI_Send(request.data(), static_cast<int>(request.size()), MPI_BYTE, rank_, tag, comm_);
+
+    MPI_Status status;
+    MPI_Probe(rank_, tag, comm_, &status);
+    int count{0};
+    MPI_Get_count(&status, MPI_BYTE, &count);
+    std::vector<uint8_t> response(static_cast<std::size_t>(count));
+    MPI_Recv(response.data(), count, MPI_BYTE, rank_, tag, comm_, MPI_STATUS_IGNORE);
+    return response;
+}
+
+auto MpiEvaluationNode::Shutdown() const -> void
+{
+    MPI_Send(nullptr, 0, MPI_BYTE, rank_, ShutdownTag, comm_);
+}
+
+auto ServeEvaluations(MPI_Comm comm, EvaluationWorker const& worker, int master) -> void
+{
+    for (;;) {
+        MPI_Status status;
+        MPI_Probe(master, MPI_ANY_TAG, comm, &status);
+        int count{0};
+        MPI_Get_count(&status, MPI_BYTE, &count);
+        std::vector<uint8_t> request(static_cast<std::size_t>(count));
+        MPI_Recv(request.data(), count, MPI_BYTE, master, status.MPI_TAG, comm, MPI_STATUS_IGNORE);
+        if (status.MPI_TAG == ShutdownTag) { return; }
+
+        auto const response = worker.Process(request);
+        MPI_Send(response.data(), static_cast<int>(response.size()), MPI_BYTE, master, status.MPI_TAG, comm);
+    }
+}
+#endif
+
+DistributedEvaluator::DistributedEvaluator(Problem& problem, std::vector<std::reference_wrapper<EvaluationNode const>> nodes, ErrorMetric error, bool linearScaling)
+    : EvaluatorBase(problem)
+    , nodes_(std::move(nodes))
+    , error_(error)
+    , scaling_(linearScaling)
+{
+    if (nodes_.empty()) {
+        throw std::invalid_argument("the distributed evaluator needs at least one node");
+    }
+    if (!error_.SupportsStatistics(scaling_)) {
+        throw std::invalid_argument("the error metric cannot be computed from the error statistics of the shards");
+    }
+}
+
+auto DistributedEvaluator::Statistics(Operon::Span<Individual const> individuals) const -> std::vector<ErrorAccumulator>
+{
+    std::vector<uint8_t> request;
+    Serialization::Write<uint64_t>(request, individuals.size());
+    for (auto const& ind : individuals) {
+        Serialization::Write(request, ind.Genotype);
+    }
+
+    // the request is sent to all the nodes at once, the statistics are merged in node order
+    std::vector<std::future<std::vector<uint8_t>>> responses;
+    responses.reserve(nodes_.size());
+    for (auto const& node : nodes_) {
+        responses.push_back(std::async(std::launch::async, [&node, &request]() { return node.get().Evaluate(request); }));
+    }
+
+    std::vector<ErrorAccumulator> stats(individuals.size());
+    for (auto& response : responses) {
+        auto const partial = ReadStatistics(response.get(), individuals.size());
+        for (auto i = 0UL; i < stats.size(); ++i) {
+            stats[i].Merge(partial[i]);
+        }
+    }
+    return stats;
+}
+
+auto DistributedEvaluator::operator()(Operon::RandomGenerator& /*rng*/, Individual& ind, Operon::Span<Operon::Scalar> /*buf*/) const -> typename EvaluatorBase::ReturnType
+{
+    ++CallCount;
+    ++ResidualEvaluations;
+    auto const fit = static_cast<Operon::Scalar>(error_(Statistics({ &ind, 1 }).front(), scaling_));
+    return { std::isfinite(fit) ? fit : EvaluatorBase::ErrMax };
+}
+
+auto DistributedEvaluator::Evaluate(Operon::RandomGenerator& /*rng*/, Operon::Span<Individual> individuals, Operon::Vector<Operon::Scalar>& /*buf*/) const -> void
+{
+    CallCount += individuals.size();
+    ResidualEvaluations += individuals.size();
+    auto const stats = Statistics(individuals);
+    for (auto i = 0UL; i < individuals.size(); ++i) {
+        auto const fit = static_cast<Operon::Scalar>(error_(stats[i], scaling_));
+        individuals[i].Fitness = { std::isfinite(fit) ? fit : EvaluatorBase::ErrMax };
+    }
+}
+
+} // namespace Operon
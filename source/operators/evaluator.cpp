@@ -1,9 +1,13 @@
 // SPDX-License-Identifier: MIT
 // SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
 
-#include "operon/core/distance.hpp"
+#include "operon/core/executor.hpp"
+#include "operon/core/fingerprint.hpp"
 #include "operon/formatter/formatter.hpp"
+#include "operon/hash/semantic_hash.hpp"
+#include "operon/interpreter/dag_interpreter.hpp"
 #include "operon/interpreter/dispatch_table.hpp"
+#include "operon/interpreter/hardware_counters.hpp"
 #include "operon/interpreter/interpreter.hpp"
 #include "operon/operators/evaluator.hpp"
 #include "operon/optimizer/likelihood/gaussian_likelihood.hpp"
@@ -12,7 +16,13 @@
 
 #include <operon/operon_export.hpp>
 #include <taskflow/taskflow.hpp>
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <chrono>
+#include <mutex>
+#include <numeric>
+#include <tuple>
 #include <type_traits>
 
 namespace Operon {
@@ -29,6 +39,154 @@ namespace Operon {
         return {a, b};
     }
 
+    // weighted least squares
+    template<typename T>
+    auto FitLeastSquaresImpl(Operon::Span<T const> estimated, Operon::Span<T const> target, Operon::Span<T const> weights) -> std::pair<double, double>
+    requires std::is_arithmetic_v<T>
+    {
+        auto stats = vstat::bivariate::accumulate<T>(std::cbegin(estimated), std::cend(estimated), std::cbegin(target), std::cbegin(weights));
+        auto a = stats.covariance / stats.variance_x; // scale
+        if (!std::isfinite(a)) {
+            a = 1;
+        }
+        auto b = stats.mean_y - a * stats.mean_x; // offset
+        return {a, b};
+    }
+
+    // with the target centered, the covariance is the mean of x * (y - mean_y), so it is accumulated in the same pass as
+    // the variance of x (shifted by the first value for numerical stability)
+    template<typename T>
+    auto FitLeastSquaresImpl(Operon::Span<T const> estimated, Operon::Span<T const> target, TargetStatistics const& stats) -> std::pair<double, double>
+    requires std::is_arithmetic_v<T>
+    {
+        EXPECT(estimated.size() == target.size());
+        if (estimated.empty()) { return {1, stats.Mean}; }
+        auto const shift { static_cast<double>(estimated.front()) };
+        double sx{0};
+        double sxx{0};
+        double sxy{0};
+        for (auto i = 0UL; i < estimated.size(); ++i) {
+            auto const dx { static_cast<double>(estimated[i]) - shift };
+            sx += dx;
+            sxx += dx * dx;
+            sxy += dx * (static_cast<double>(target[i]) - stats.Mean);
+        }
+        auto const n { static_cast<double>(estimated.size()) };
+        auto a = sxy / (sxx - sx * sx / n); // scale
+        if (!std::isfinite(a)) {
+            a = 1;
+        }
+        auto b = stats.Mean - a * (shift + sx / n); // offset
+        return {a, b};
+    }
+
+    TargetStatistics::TargetStatistics(Operon::Span<Operon::Scalar const> values)
+        : Values(values)
+    {
+        auto const stats = vstat::univariate::accumulate<Operon::Scalar>(values.begin(), values.end());
+        Mean = stats.mean;
+        Variance = stats.variance;
+        SumSquares = stats.ssr;
+    }
+
+    namespace {
+        // the coefficients of the tree in a scratch buffer of the calling thread, so that the evaluations do not allocate
+        // - the values are valid until the next call on the same thread, they must not be read by other workers
+        auto ScratchCoefficients(Operon::Tree const& tree) -> Operon::Span<Operon::Scalar const>
+        {
+            thread_local std::vector<Operon::Scalar> coefficients;
+            return tree.GetCoefficients(coefficients);
+        }
+
+        // the values of all the nodes of the tree in a scratch buffer of the calling thread (see ScratchCoefficients)
+        auto ScratchValues(Operon::Tree const& tree) -> Operon::Span<Operon::Scalar const>
+        {
+            thread_local std::vector<Operon::Scalar> values;
+            auto const& nodes = tree.Nodes();
+            values.resize(nodes.size());
+            std::ranges::transform(nodes, values.begin(), [](auto const& n) { return n.Value; });
+            return values;
+        }
+    } // namespace
+
+    // keeps the streamed predictions on the case rows (see Evaluator::SetCaseSample)
+    // - rows are the case rows in increasing order and order their positions in the sample
+    // - the stream starts at row first of the training range, the case rows before it are left as they are
+    // - the batches of a stream are consecutive, so each batch only looks at the next case rows
+    class CaseValues {
+    public:
+        CaseValues(Operon::Span<std::size_t const> rows, Operon::Span<std::size_t const> order, Operon::Span<Operon::Scalar> values, std::size_t first = 0)
+            : rows_(rows), order_(order), values_(values), first_(first)
+            , next_(static_cast<std::size_t>(std::distance(rows.begin(), std::ranges::lower_bound(rows, first))))
+        {
+        }
+
+        template<typename T>
+        auto operator()(std::size_t row, Operon::Span<T const> values) -> void
+        {
+            auto const start { first_ + row };
+            for (; next_ < rows_.size() && rows_[next_] < start + values.size(); ++next_) {
+                values_[order_[next_]] = static_cast<Operon::Scalar>(values[rows_[next_] - start]);
+            }
+        }
+
+    private:
+        Operon::Span<std::size_t const> rows_;
+        Operon::Span<std::size_t const> order_;
+        Operon::Span<Operon::Scalar> values_;
+        std::size_t first_;
+        std::size_t next_;
+    };
+
+    // streams the output of a tree over a range into the error statistics, one batch at a time
+    // - target contains the target values over the same range
+    // - the evaluation stops as soon as stop(stats) returns true
+    // - with abort, it also stops after the first batch with a NaN or infinite value, the statistics (and therefore
+    //   the error) are then not finite either
+    // - T is the precision of the interpreter, the statistics are always accumulated in double precision
+    // - the predictions on the case rows are kept in cases (if not null)
+    template<typename T, typename DTable, typename F>
+    auto StreamErrorStatistics(DTable const& dtable, bool abort, Operon::Dataset const& dataset, Operon::Tree const& tree, Operon::Range range, Operon::Span<Operon::Scalar const> target, F&& stop, CaseValues* cases) -> ErrorAccumulator
+    {
+        auto const coeff = ScratchCoefficients(tree);
+        Operon::Span<T const> parameters;
+        if constexpr (std::is_same_v<T, Operon::Scalar>) {
+            parameters = coeff;
+        } else {
+            thread_local std::vector<T> converted;
+            converted.assign(coeff.begin(), coeff.end());
+            parameters = converted;
+        }
+
+        Interpreter<T, DTable> const interpreter{dtable, dataset, tree};
+        ErrorAccumulator stats;
+        interpreter.ForEachBatch(parameters, range, [&](auto row, Operon::Span<T const> values) {
+            stats(values, target.subspan(row, values.size()));
+            if (cases != nullptr) { (*cases)(static_cast<std::size_t>(row), values); }
+            return (!abort || AllFinite(values)) && !stop(stats);
+        });
+        return stats;
+    }
+
+    // selects the precision of the interpreter at runtime
+    // - the single precision primitives come from a default dispatch table shared by all the evaluators
+    template<typename F>
+    auto StreamErrorStatistics(DefaultDispatch const& dtable, bool singlePrecision, bool abort, Operon::Dataset const& dataset, Operon::Tree const& tree, Operon::Range range, Operon::Span<Operon::Scalar const> target, F&& stop, CaseValues* cases = nullptr) -> ErrorAccumulator
+    {
+        if constexpr (!std::is_same_v<Operon::Scalar, float>) {
+            if (singlePrecision) {
+                static DispatchTable<float> const table;
+                return StreamErrorStatistics<float>(table, abort, dataset, tree, range, target, std::forward<F>(stop), cases);
+            }
+        }
+        return StreamErrorStatistics<Operon::Scalar>(dtable, abort, dataset, tree, range, target, std::forward<F>(stop), cases);
+    }
+
+    auto AccumulateErrorStatistics(DefaultDispatch const& dtable, bool singlePrecision, bool abort, Operon::Dataset const& dataset, Operon::Tree const& tree, Operon::Range range, Operon::Span<Operon::Scalar const> target, CaseValues* cases = nullptr) -> ErrorAccumulator
+    {
+        return StreamErrorStatistics(dtable, singlePrecision, abort, dataset, tree, range, target, [](auto const& /*stats*/) { return false; }, cases);
+    }
+
     auto FitLeastSquares(Operon::Span<float const> estimated, Operon::Span<float const> target) noexcept -> std::pair<double, double> {
         return FitLeastSquaresImpl<float>(estimated, target);
     }
@@ -37,6 +195,234 @@ namespace Operon {
         return FitLeastSquaresImpl<double>(estimated, target);
     }
 
+    auto FitLeastSquares(Operon::Span<float const> estimated, Operon::Span<float const> target, TargetStatistics const& stats) noexcept -> std::pair<double, double> {
+        return FitLeastSquaresImpl<float>(estimated, target, stats);
+    }
+
+    auto FitLeastSquares(Operon::Span<double const> estimated, Operon::Span<double const> target, TargetStatistics const& stats) noexcept -> std::pair<double, double> {
+        return FitLeastSquaresImpl<double>(estimated, target, stats);
+    }
+
+    template<> auto OPERON_EXPORT
+    Evaluator<DefaultDispatch>::CacheKey(Individual const& ind) const -> Operon::Hash
+    {
+        // the cache key combines the strict tree hash and the coefficients with a fingerprint of the data the tree is evaluated on
+        // - the semantic hash is not used: it only tells that the outputs agree on a sample of the rows
+        // - the coefficients are hashed in the order of the nodes, since the strict hash adds up the leaf coefficients
+        //   and does not depend on the order of the children of a commutative node
+        // - the case sample is part of the key since the entries hold the case errors
+        auto const& problem = GetProblem();
+        auto const trainingRange = problem.TrainingRange();
+        auto const values = ScratchValues(ind.Genotype);
+        std::array<Operon::Hash, 8> const fingerprint {
+            ind.Genotype.Hash(Operon::HashMode::Strict).HashValue(),
+            Operon::Hasher{}(std::bit_cast<uint8_t const*>(values.data()), values.size() * sizeof(Operon::Scalar)),
+            problem.TargetVariable().Hash,
+            weights_.value_or(0),
+            trainingRange.Start(),
+            trainingRange.End(),
+            std::bit_cast<std::uintptr_t>(problem.GetDataset().Values().data()),
+            caseHash_
+        };
+        return Operon::Hasher{}(std::bit_cast<uint8_t const*>(fingerprint.data()), sizeof(fingerprint));
+    }
+
+    template<> auto OPERON_EXPORT
+    Evaluator<DefaultDispatch>::FindCached(Operon::Hash key, Individual& ind, typename EvaluatorBase::ReturnType& fitness) const -> bool
+    {
+        // an entry inserted without the statistics does not count when they are recorded now
+        FitnessCache::Entry entry;
+        if (!cache_.Find(key, entry) || (record_ && !entry.Recorded)) { return false; }
+        fitness = std::move(entry.Fitness);
+        if (record_) { ind.Statistics = entry.Statistics; }
+        ind.CaseErrors = std::move(entry.CaseErrors);
+        return true;
+    }
+
+    template<> auto OPERON_EXPORT
+    Evaluator<DefaultDispatch>::InsertCached(Operon::Hash key, Individual const& ind, typename EvaluatorBase::ReturnType const& fitness) const -> void
+    {
+        if (!cache_.Enabled()) { return; }
+        cache_.Insert(key, FitnessCache::Entry{
+            .Fitness = fitness,
+            .Recorded = record_,
+            .Statistics = record_ ? ind.Statistics : std::nullopt,
+            .CaseErrors = ind.CaseErrors
+        });
+    }
+
+    template<> auto OPERON_EXPORT
+    Evaluator<DefaultDispatch>::ComputeSemanticHash(Individual& ind) const -> void
+    {
+        if (!semantic_) { ind.Semantic = 0; return; }
+        auto const& tree = ind.Genotype;
+        auto const values = TInterpreter{GetDispatchTable(), *semantic_, tree}.Evaluate(ScratchCoefficients(tree), Operon::Range{0, semantic_->Rows<std::size_t>()});
+        ind.Semantic = Operon::SemanticHash(values);
+    }
+
+    template<> auto OPERON_EXPORT
+    Evaluator<DefaultDispatch>::Prepare(Operon::Span<Individual const> /*pop*/) const -> void
+    {
+        // the evaluations before the first call (or on other ranges) compute the target statistics themselves
+        auto const& problem = GetProblem();
+        auto const target = problem.TargetValues(problem.TrainingRange());
+        if (!target_.Matches(target)) {
+            target_ = TargetStatistics{target};
+        }
+        if (bounds_ && problem.TrainingRange().Bounds() != boundsRange_.Bounds()) {
+            boundsRange_ = problem.TrainingRange();
+            bounds_ = ComputeVariableBounds(problem.GetDataset(), boundsRange_, boundsLag_);
+        }
+    }
+
+    template<> auto OPERON_EXPORT
+    Evaluator<DefaultDispatch>::ComputeFitness(Operon::Span<Operon::Scalar> estimated, Operon::Span<Operon::Scalar const> target, Operon::Span<Operon::Scalar const> weights) const -> Operon::Scalar
+    {
+        ENSURE(estimated.size() >= target.size());
+        ENSURE(weights.empty() || weights.size() == target.size());
+        KernelSample sample(KernelSampler::Local(), KernelProfile::ErrorMetric, target.size());
+        if (scaling_) {
+            auto [a, b] = !weights.empty() ? FitLeastSquaresImpl<Operon::Scalar>(estimated.subspan(0, target.size()), target, weights)
+                : target_.Matches(target) ? FitLeastSquaresImpl<Operon::Scalar>(estimated.subspan(0, target.size()), target, target_)
+                : FitLeastSquaresImpl<Operon::Scalar>(estimated, target);
+            std::transform(estimated.begin(), estimated.end(), estimated.begin(), [a=a,b=b](auto x) { return a * x + b; });
+        }
+        auto fit = static_cast<Operon::Scalar>(weights.empty() ? error_(estimated, target) : error_(estimated.subspan(0, target.size()), target, weights));
+        if (!std::isfinite(fit)) {
+            fit = EvaluatorBase::ErrMax;
+        }
+        return fit;
+    }
+
+    template<> auto OPERON_EXPORT
+    Evaluator<DefaultDispatch>::CaptureCaseErrors(Individual& ind, Operon::Span<Operon::Scalar const> estimated, Operon::Span<Operon::Scalar const> target, bool scaled) const -> void
+    {
+        EXPECT(estimated.size() >= target.size());
+        double a{1};
+        double b{0};
+        if (scaling_ && !scaled) {
+            std::tie(a, b) = target_.Matches(target) ? FitLeastSquaresImpl<Operon::Scalar>(estimated.subspan(0, target.size()), target, target_)
+                : FitLeastSquaresImpl<Operon::Scalar>(estimated.subspan(0, target.size()), target);
+        }
+        auto& errors = ind.CaseErrors;
+        errors.resize(caseRows_.size());
+        for (auto i = 0UL; i < caseRows_.size(); ++i) {
+            auto const r = caseRows_[i];
+            EXPECT(r < target.size());
+            auto const e = a * static_cast<double>(estimated[r]) + b - static_cast<double>(target[r]);
+            errors[i] = static_cast<Operon::Scalar>(std::abs(e));
+        }
+        if (!std::ranges::all_of(errors, [](auto e) { return std::isfinite(e); })) { errors.clear(); }
+    }
+
+    template<> auto OPERON_EXPORT
+    Evaluator<DefaultDispatch>::CaptureCaseErrors(Individual& ind, Operon::Span<Operon::Scalar const> sampled, Operon::Span<Operon::Scalar const> target, ErrorAccumulator const& stats) const -> void
+    {
+        EXPECT(sampled.size() == caseRows_.size());
+        auto const [a, b] = scaling_ ? stats.LinearScaling() : std::pair{1.0, 0.0};
+        auto& errors = ind.CaseErrors;
+        errors.resize(caseRows_.size());
+        for (auto i = 0UL; i < caseRows_.size(); ++i) {
+            auto const r = caseRows_[i];
+            EXPECT(r < target.size());
+            auto const e = a * static_cast<double>(sampled[i]) + b - static_cast<double>(target[r]);
+            errors[i] = static_cast<Operon::Scalar>(std::abs(e));
+        }
+        if (!std::ranges::all_of(errors, [](auto e) { return std::isfinite(e); })) { errors.clear(); }
+    }
+
+    template<> auto OPERON_EXPORT
+    Evaluator<DefaultDispatch>::SetCaseSample(std::vector<std::size_t> rows) -> void
+    {
+        caseRows_ = std::move(rows);
+        caseOrder_.resize(caseRows_.size());
+        std::iota(caseOrder_.begin(), caseOrder_.end(), 0UL);
+        std::ranges::stable_sort(caseOrder_, std::less{}, [&](auto i) { return caseRows_[i]; });
+        caseSorted_.resize(caseRows_.size());
+        std::ranges::transform(caseOrder_, caseSorted_.begin(), [&](auto i) { return caseRows_[i]; });
+        caseHash_ = caseRows_.empty() ? 0 : Operon::Hasher{}(std::bit_cast<uint8_t const*>(caseRows_.data()), caseRows_.size() * sizeof(std::size_t));
+    }
+
+    template<> auto OPERON_EXPORT
+    Evaluator<DefaultDispatch>::ComputeFitnessRows(Operon::Tree const& tree, Operon::Span<Operon::Scalar> estimated, ErrorAccumulator& stats) const -> Operon::Scalar
+    {
+        // each chunk of rows is evaluated and summarized by one worker, the partial statistics are merged in row order
+        // - if estimated is empty, the output of each chunk is streamed into its statistics instead of being stored
+        // - unlike ComputeFitness, the estimated values are not scaled in place
+        auto const& problem = GetProblem();
+        auto const& dataset = problem.GetDataset();
+        auto const range = problem.TrainingRange();
+        auto const target = dataset.GetValues(problem.TargetVariable()).subspan(range.Start(), range.Size());
+        auto const coeff = tree.GetCoefficients(); // a copy, the chunks are evaluated by other workers
+
+        std::mutex mutex;
+        std::vector<std::pair<std::size_t, ErrorAccumulator>> partials;
+        bool finite{true};
+        ForEachRowChunk(*executor_, range, rowChunk_, [&](Operon::Range rg) {
+            auto const offset { rg.Start() - range.Start() };
+
+            ErrorAccumulator acc;
+            auto ok{true};
+            if (estimated.empty()) {
+                acc = AccumulateErrorStatistics(GetDispatchTable(), singlePrecision_, abort_, dataset, tree, rg, target.subspan(offset, rg.Size()));
+            } else {
+                TInterpreter const interpreter{GetDispatchTable(), dataset, tree};
+                auto values = estimated.subspan(offset, rg.Size());
+                if (abort_) {
+                    ok = interpreter.EvaluateFinite(coeff, rg, values);
+                } else {
+                    interpreter.Evaluate(coeff, rg, values);
+                }
+                acc(Operon::Span<Operon::Scalar const>{values}, target.subspan(offset, rg.Size()));
+            }
+            std::scoped_lock lock(mutex);
+            partials.emplace_back(offset, acc);
+            finite = finite && ok;
+        });
+
+        // the rows after a non-finite batch were not evaluated
+        if (!finite) { return EvaluatorBase::ErrMax; }
+
+        std::ranges::sort(partials, std::less{}, &std::pair<std::size_t, ErrorAccumulator>::first);
+        for (auto const& [offset, acc] : partials) { stats.Merge(acc); }
+
+        if (!SupportsStatistics()) {
+            return ComputeFitness(estimated, target);
+        }
+        return ComputeFitness(stats);
+    }
+
+    template<> auto OPERON_EXPORT
+    Evaluator<DefaultDispatch>::IncrementalFitness(Individual& ind, Operon::Range range, Operon::Span<Operon::Scalar const> target) const -> Operon::Scalar
+    {
+        auto const& problem = GetProblem();
+        std::array<Operon::Hash, 4> const fingerprint {
+            ind.Genotype.Hash(Operon::HashMode::Strict).HashValue(),
+            problem.TargetVariable().Hash,
+            range.Start(),
+            caseHash_
+        };
+        auto const key = Operon::Hasher{}(std::bit_cast<uint8_t const*>(fingerprint.data()), sizeof(fingerprint));
+
+        // the statistics of the rows evaluated before are merged with the ones of the remaining rows
+        // - so are the predictions on the case rows
+        ErrorStatisticsCache::Entry entry;
+        if (!statistics_.Find(key, entry) || entry.End <= range.Start() || entry.End > range.End()) {
+            entry = { range.Start(), ErrorAccumulator{}, Operon::Vector<Operon::Scalar>(caseRows_.size()) };
+        }
+        if (entry.End < range.End()) {
+            ++ResidualEvaluations;
+            Operon::Range const rows{entry.End, range.End()};
+            CaseValues cases{caseSorted_, caseOrder_, entry.Cases, rows.Start() - range.Start()};
+            entry.Statistics.Merge(AccumulateErrorStatistics(GetDispatchTable(), singlePrecision_, abort_, problem.GetDataset(), ind.Genotype, rows, target.subspan(rows.Start() - range.Start()), caseRows_.empty() ? nullptr : &cases));
+            entry.End = range.End();
+            statistics_.Insert(key, entry);
+        }
+        Record(ind, entry.Statistics);
+        if (!caseRows_.empty() && entry.Statistics.Count() == static_cast<double>(range.Size())) { CaptureCaseErrors(ind, entry.Cases, target, entry.Statistics); }
+        return ComputeFitness(entry.Statistics);
+    }
+
     template<> auto OPERON_EXPORT
     Evaluator<DefaultDispatch>::operator()(Operon::RandomGenerator& /*rng*/, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> typename EvaluatorBase::ReturnType
     {
@@ -48,58 +434,325 @@ namespace Operon {
         auto targetValues = dataset.GetValues(problem.TargetVariable()).subspan(trainingRange.Start(), trainingRange.Size());
 
         auto& tree = ind.Genotype;
-        auto const& dtable = GetDispatchTable();
-        TInterpreter const interpreter{dtable, dataset, tree};
+        if (record_) { ind.Statistics.reset(); }
+        ind.CaseErrors.clear();
+        ComputeSemanticHash(ind);
+        if (Rejects(tree)) { return { EvaluatorBase::ErrMax }; }
 
-        auto computeFitness = [&]() {
-            ++ResidualEvaluations;
-            Operon::Vector<Operon::Scalar> estimatedValues;
-            if (buf.size() != trainingRange.Size()) {
-                estimatedValues.resize(trainingRange.Size());
-                buf = { estimatedValues.data(), estimatedValues.size() };
-            }
-            auto coeff = tree.GetCoefficients();
-            interpreter.Evaluate(coeff, trainingRange, buf);
-            if (scaling_) {
-                auto [a, b] = FitLeastSquaresImpl<Operon::Scalar>(buf, targetValues);
-                std::transform(buf.begin(), buf.end(), buf.begin(), [a=a,b=b](auto x) { return a * x + b; });
-            }
-            ENSURE(buf.size() >= targetValues.size());
-            return error_(buf, targetValues);
+        // the predictions are not cached, they are computed whenever the caller asks for them
+        Operon::Hash key{0};
+        if (cache_.Enabled()) {
+            key = CacheKey(ind);
+            if (typename EvaluatorBase::ReturnType fit; (streaming_ || buf.empty()) && FindCached(key, ind, fit)) {
+                ++CacheHits;
+                return fit;
+            }
+            ++CacheMisses;
+        }
+
+        if (Incremental(buf)) {
+            typename EvaluatorBase::ReturnType result{ IncrementalFitness(ind, trainingRange, targetValues) };
+            InsertCached(key, ind, result);
+            return result;
+        }
+
+        auto const& dtable = GetDispatchTable();
+        // calls f with the interpreter of the buffered paths (see SetBatchSizeTuner)
+        auto interpret = [&](auto&& f) {
+            if (tuner_ == nullptr) { f(TInterpreter{dtable, dataset, tree}); return; }
+            tuner_->Visit(tree.Length(), [&]<typename Table>(Table const& table) { f(Operon::Interpreter<Operon::Scalar, Table>{table, dataset, tree}); });
         };
 
-        auto fit = static_cast<Operon::Scalar>(computeFitness());
-        if (!std::isfinite(fit)) {
-            fit = EvaluatorBase::ErrMax;
+        ++ResidualEvaluations;
+
+        // the output is streamed into the error statistics when the predictions are not needed
+        // - the row-parallel evaluation takes the case errors from the buffer
+        auto const stream = (streaming_ || buf.empty()) && SupportsStatistics() && subtreeCacheCapacity_ == 0 && (caseRows_.empty() || !RowParallel());
+
+        Operon::Vector<Operon::Scalar> estimatedValues;
+        if (!stream && buf.size() != trainingRange.Size()) {
+            estimatedValues.resize(trainingRange.Size());
+            buf = { estimatedValues.data(), estimatedValues.size() };
+        }
+
+        typename EvaluatorBase::ReturnType result;
+        if (RowParallel()) {
+            ErrorAccumulator stats;
+            result = { ComputeFitnessRows(tree, stream ? Operon::Span<Operon::Scalar>{} : buf, stats) };
+            Record(ind, stats);
+            if (!caseRows_.empty() && stats.Count() == static_cast<double>(trainingRange.Size())) { CaptureCaseErrors(ind, buf, targetValues, /*scaled=*/false); }
+        } else if (stream) {
+            Operon::Vector<Operon::Scalar> sampled(caseRows_.size());
+            CaseValues cases{caseSorted_, caseOrder_, sampled};
+            auto const stats = AccumulateErrorStatistics(dtable, singlePrecision_, abort_, dataset, tree, trainingRange, targetValues, caseRows_.empty() ? nullptr : &cases);
+            Record(ind, stats);
+            result = { ComputeFitness(stats) };
+            if (!caseRows_.empty() && stats.Count() == static_cast<double>(trainingRange.Size())) { CaptureCaseErrors(ind, sampled, targetValues, stats); }
+        } else if (Fused()) {
+            // the statistics are accumulated batch by batch while the predictions are copied to the buffer
+            // - with abort the statistics of a non-finite batch are not finite and neither is the error
+            ErrorAccumulator stats;
+            interpret([&](auto const& interpreter) {
+                interpreter.Evaluate(ScratchCoefficients(tree), trainingRange, buf, [&](auto row, Operon::Span<Operon::Scalar const> values) {
+                    stats(values, targetValues.subspan(static_cast<std::size_t>(row), values.size()));
+                    return !abort_ || AllFinite(values);
+                });
+            });
+            Record(ind, stats);
+            result = { ComputeFitness(stats) };
+            if (!caseRows_.empty() && stats.Count() == static_cast<double>(trainingRange.Size())) { CaptureCaseErrors(ind, buf, targetValues, /*scaled=*/false); }
+        } else {
+            auto finite{true};
+            interpret([&](auto const& interpreter) {
+                if (subtreeCacheCapacity_ > 0) {
+                    thread_local SubtreeValueCache<Operon::Scalar> subtreeCache;
+                    if (subtreeCache.Capacity() != subtreeCacheCapacity_) {
+                        subtreeCache.SetCapacity(subtreeCacheCapacity_);
+                    }
+                    interpreter.Evaluate({}, trainingRange, buf, subtreeCache);
+                } else if (abort_) {
+                    finite = interpreter.EvaluateFinite(ScratchCoefficients(tree), trainingRange, buf);
+                } else {
+                    interpreter.Evaluate(ScratchCoefficients(tree), trainingRange, buf);
+                }
+            });
+            // before the buffer is scaled in place
+            if (record_ && finite) {
+                ErrorAccumulator stats;
+                stats(Operon::Span<Operon::Scalar const>{buf.data(), targetValues.size()}, targetValues);
+                Record(ind, stats);
+            }
+            result = { finite ? ComputeFitness(buf, targetValues, WeightValues(trainingRange)) : EvaluatorBase::ErrMax };
+            // the buffer is now scaled
+            if (!caseRows_.empty() && finite) { CaptureCaseErrors(ind, buf, targetValues, /*scaled=*/true); }
+        }
+
+        InsertCached(key, ind, result);
+        return result;
+    }
+
+    template<> auto OPERON_EXPORT
+    Evaluator<DefaultDispatch>::EvaluateBounded(Operon::RandomGenerator& rng, Individual& ind, Operon::Span<Operon::Scalar> buf, Operon::Span<Operon::Scalar const> bound) const -> typename EvaluatorBase::ReturnType
+    {
+        if (bound.empty() || !error_.SupportsBound(scaling_) || weights_ || RowParallel() || subtreeCacheCapacity_ > 0 || Incremental(buf)) {
+            return (*this)(rng, ind, buf);
+        }
+
+        ++CallCount;
+        auto const& problem = GetProblem();
+        auto const& dataset = problem.GetDataset();
+        auto const trainingRange = problem.TrainingRange();
+        auto const targetValues = dataset.GetValues(problem.TargetVariable()).subspan(trainingRange.Start(), trainingRange.Size());
+        auto const& tree = ind.Genotype;
+        if (record_) { ind.Statistics.reset(); }
+        ind.CaseErrors.clear();
+        ComputeSemanticHash(ind);
+        if (Rejects(tree)) { return { EvaluatorBase::ErrMax }; }
+
+        // the buffer is not written by the bounded evaluation
+        Operon::Hash key{0};
+        if (cache_.Enabled()) {
+            key = CacheKey(ind);
+            if (typename EvaluatorBase::ReturnType fit; FindCached(key, ind, fit)) {
+                ++CacheHits;
+                return fit;
+            }
+            ++CacheMisses;
+        }
+
+        ++ResidualEvaluations;
+        auto const n { static_cast<double>(trainingRange.Size()) };
+        auto const limit { static_cast<double>(bound.front()) };
+
+        bool terminated{false};
+        Operon::Vector<Operon::Scalar> sampled(caseRows_.size());
+        CaseValues cases{caseSorted_, caseOrder_, sampled};
+        auto const stats = StreamErrorStatistics(GetDispatchTable(), singlePrecision_, abort_, dataset, tree, trainingRange, targetValues, [&](ErrorAccumulator const& partial) {
+            terminated = error_.LowerBound(partial, n, scaling_) > limit;
+            return terminated;
+        }, caseRows_.empty() ? nullptr : &cases);
+
+        if (terminated) {
+            return { static_cast<Operon::Scalar>(error_.LowerBound(stats, n, scaling_)) };
+        }
+        Record(ind, stats);
+        if (!caseRows_.empty() && stats.Count() == n) { CaptureCaseErrors(ind, sampled, targetValues, stats); }
+        typename EvaluatorBase::ReturnType result{ ComputeFitness(stats) };
+        InsertCached(key, ind, result);
+        return result;
+    }
+
+    template<> auto OPERON_EXPORT
+    Evaluator<DefaultDispatch>::EvaluateSubset(Operon::RandomGenerator& /*rng*/, Individual& ind, Operon::Span<Operon::Scalar> /*buf*/, Operon::Range range) const -> typename EvaluatorBase::ReturnType
+    {
+        ++CallCount;
+        auto const& problem = GetProblem();
+        auto const& dataset = problem.GetDataset();
+        auto const targetValues = dataset.GetValues(problem.TargetVariable()).subspan(range.Start(), range.Size());
+        auto const& tree = ind.Genotype;
+        if (Rejects(tree)) { return { EvaluatorBase::ErrMax }; }
+        ++ResidualEvaluations;
+
+        if (SupportsStatistics()) {
+            return { ComputeFitness(AccumulateErrorStatistics(GetDispatchTable(), singlePrecision_, abort_, dataset, tree, range, targetValues)) };
+        }
+        auto const coeff = ScratchCoefficients(tree);
+        TInterpreter const interpreter{GetDispatchTable(), dataset, tree};
+        Operon::Vector<Operon::Scalar> estimatedValues(range.Size());
+        if (!abort_) {
+            interpreter.Evaluate(coeff, range, estimatedValues);
+        } else if (!interpreter.EvaluateFinite(coeff, range, estimatedValues)) {
+            return { EvaluatorBase::ErrMax };
+        }
+        return { ComputeFitness(estimatedValues, targetValues, WeightValues(range)) };
+    }
+
+    template<> auto OPERON_EXPORT
+    Evaluator<DefaultDispatch>::Evaluate(Operon::RandomGenerator& rng, Operon::Span<Individual> individuals, Operon::Vector<Operon::Scalar>& buf) const -> void
+    {
+        // row-parallel evaluation already keeps all the workers busy, evaluate the individuals one by one
+        // (as well as with the streamed incremental statistics, which are kept per individual)
+        if (RowParallel() || (Incremental() && streaming_)) {
+            EvaluatorBase::Evaluate(rng, individuals, buf);
+            return;
+        }
+
+        auto const& problem = GetProblem();
+        auto const& dataset = problem.GetDataset();
+
+        auto trainingRange = problem.TrainingRange();
+        auto targetValues = problem.TargetValues(trainingRange);
+        auto const sz = trainingRange.Size();
+
+        // collect the trees that are not already in the cache
+        std::vector<std::reference_wrapper<Operon::Tree const>> trees;
+        std::vector<Operon::Hash> keys;
+        std::vector<std::size_t> indices;
+        trees.reserve(individuals.size());
+        for (auto i = 0UL; i < individuals.size(); ++i) {
+            ++CallCount;
+            auto& ind = individuals[i];
+            if (record_) { ind.Statistics.reset(); }
+            ind.CaseErrors.clear();
+            ComputeSemanticHash(ind);
+            if (Rejects(ind.Genotype)) {
+                ind.Fitness = { EvaluatorBase::ErrMax };
+                continue;
+            }
+            Operon::Hash key{0};
+            if (cache_.Enabled()) {
+                key = CacheKey(ind);
+                if (FindCached(key, ind, ind.Fitness)) {
+                    ++CacheHits;
+                    continue;
+                }
+                ++CacheMisses;
+            }
+            trees.emplace_back(ind.Genotype);
+            keys.push_back(key);
+            indices.push_back(i);
+        }
+
+        ResidualEvaluations += trees.size();
+        if (blockRows_ > 0 && SupportsStatistics()) {
+            std::vector<ErrorAccumulator> stats(trees.size());
+            std::vector<Operon::Vector<Operon::Scalar>> sampled(caseRows_.empty() ? 0 : trees.size(), Operon::Vector<Operon::Scalar>(caseRows_.size()));
+            std::vector<CaseValues> cases;
+            cases.reserve(sampled.size());
+            for (auto& values : sampled) { cases.emplace_back(caseSorted_, caseOrder_, values); }
+            Operon::StreamTiled<Operon::Scalar>(GetDispatchTable(), dataset, trees, trainingRange, blockRows_, [&](auto i, auto row, auto values) {
+                stats[i](values, targetValues.subspan(static_cast<std::size_t>(row), values.size()));
+                if (!cases.empty()) { cases[i](static_cast<std::size_t>(row), values); }
+            });
+            for (auto i = 0UL; i < trees.size(); ++i) {
+                auto& ind = individuals[indices[i]];
+                Record(ind, stats[i]);
+                if (!cases.empty()) { CaptureCaseErrors(ind, sampled[i], targetValues, stats[i]); }
+                ind.Fitness = { ComputeFitness(stats[i]) };
+                InsertCached(keys[i], ind, ind.Fitness);
+            }
+            return;
+        }
+
+        if (buf.size() < trees.size() * sz) {
+            buf.resize(trees.size() * sz);
+        }
+        if (sharing_) {
+            Operon::DagInterpreter<Operon::Scalar, DefaultDispatch>{GetDispatchTable(), dataset, trees}.Evaluate(trainingRange, { buf.data(), buf.size() });
+        } else {
+            Operon::EvaluateTiled<Operon::Scalar>(GetDispatchTable(), dataset, trees, trainingRange, { buf.data(), buf.size() });
+        }
+
+        for (auto i = 0UL; i < trees.size(); ++i) {
+            auto& ind = individuals[indices[i]];
+            Operon::Span<Operon::Scalar> values{ buf.data() + i * sz, sz };
+            if (Fused()) {
+                ErrorAccumulator stats;
+                stats(Operon::Span<Operon::Scalar const>{values}, targetValues);
+                Record(ind, stats);
+                ind.Fitness = { ComputeFitness(stats) };
+                if (!caseRows_.empty()) { CaptureCaseErrors(ind, values, targetValues, /*scaled=*/false); }
+            } else {
+                if (record_) {
+                    ErrorAccumulator stats;
+                    stats(Operon::Span<Operon::Scalar const>{values}, targetValues);
+                    Record(ind, stats);
+                }
+                ind.Fitness = { ComputeFitness(values, targetValues, WeightValues(trainingRange)) };
+                // the values are now scaled
+                if (!caseRows_.empty()) { CaptureCaseErrors(ind, values, targetValues, /*scaled=*/true); }
+            }
+            InsertCached(keys[i], ind, ind.Fitness);
         }
-        return typename EvaluatorBase::ReturnType{ fit };
     }
 
     auto DiversityEvaluator::Prepare(Operon::Span<Operon::Individual const> pop) const -> void {
+        auto forEach = [&](std::size_t n, auto&& func) {
+            auto const workers { executor_ == nullptr ? 1UL : executor_->num_workers() };
+            if (workers < 2 || n < 2) {
+                for (auto i = 0UL; i < n; ++i) { func(i); }
+                return;
+            }
+            auto const chunk { (n + workers - 1) / workers };
+            tf::Taskflow taskflow;
+            for (auto i = 0UL; i < n; i += chunk) {
+                taskflow.emplace([&func, i, chunk, n]() { for (auto j = i; j < std::min(i + chunk, n); ++j) { func(j); } });
+            }
+            RunTaskflow(*executor_, taskflow);
+        };
+
+        hashes_.resize(pop.size());
+        forEach(pop.size(), [&](auto i) { hashes_[i] = pop[i].Genotype.Hash(hashmode_).HashValue(); });
+
+        std::swap(divmap_, previous_);
         divmap_.clear();
-        for (auto const& individual : pop) {
-            auto const& tree = individual.Genotype;
-            auto const& nodes = tree.Nodes();
-            (void) tree.Hash(hashmode_);
-            std::vector<Operon::Hash> hash(nodes.size());;
-            std::transform(nodes.begin(), nodes.end(), hash.begin(), [](auto const& n) { return n.CalculatedHashValue; });
-            std::stable_sort(hash.begin(), hash.end());
-            divmap_[tree.HashValue()] = std::move(hash);
+        missing_.clear();
+        for (auto i = 0UL; i < pop.size(); ++i) {
+            auto const h = hashes_[i];
+            if (divmap_.contains(h)) { continue; }
+            auto it = previous_.find(h);
+            if (it != previous_.end()) {
+                divmap_.emplace(h, it->second);
+            } else {
+                missing_.emplace_back(i, divmap_.size());
+                divmap_.emplace(h, Fingerprint{});
+            }
         }
+        // the values are stored contiguously in insertion order, no insertions happen while they are written
+        forEach(missing_.size(), [&](auto i) {
+            auto const [j, k] = missing_[i];
+            (divmap_.begin() + static_cast<std::ptrdiff_t>(k))->second = Fingerprint(pop[j].Genotype);
+        });
     }
 
     auto
     DiversityEvaluator::operator()(Operon::RandomGenerator& random, Individual& ind, Operon::Span<Operon::Scalar>  /*buf*/) const -> typename EvaluatorBase::ReturnType
     {
         (void)ind.Genotype.Hash(hashmode_);
-        std::vector<Operon::Hash> lhs(ind.Genotype.Length());
-        auto const& nodes = ind.Genotype.Nodes();
-        std::transform(nodes.begin(), nodes.end(), lhs.begin(), [](auto const& n) { return n.CalculatedHashValue; });
-        std::stable_sort(lhs.begin(), lhs.end());
+        Fingerprint const lhs(ind.Genotype);
         auto const& values = divmap_.values();
 
         Operon::Scalar distance{0};
-        std::vector<double> distances(sampleSize_);
         for (auto i = 0UL; i < sampleSize_; ++i) {
             auto const& rhs = Operon::Random::Sample(random, values.begin(), values.end())->second;
             distance += static_cast<Operon::Scalar>(Operon::Distance::Jaccard(lhs, rhs));
@@ -107,6 +760,47 @@ namespace Operon {
         return EvaluatorBase::ReturnType { -distance / static_cast<Operon::Scalar>(sampleSize_) };
     }
 
+    auto ProgressiveEvaluator::Prepare(Operon::Span<Individual const> pop) const -> void
+    {
+        evaluator_.get().Prepare(pop);
+        if (pop.empty() || ObjectiveCount() != 1) { return; }
+
+        std::vector<Operon::Scalar> fitness(pop.size());
+        std::ranges::transform(pop, fitness.begin(), [](auto const& ind) { return ind[0]; });
+        auto const k = static_cast<std::size_t>(std::clamp(quantile_, 0.0, 1.0) * static_cast<double>(fitness.size() - 1));
+        std::nth_element(fitness.begin(), fitness.begin() + static_cast<std::ptrdiff_t>(k), fitness.end());
+        threshold_ = fitness[k];
+    }
+
+    auto ProgressiveEvaluator::CountRows(std::size_t rows) const -> void
+    {
+        // convert evaluated rows into (whole) residual evaluations without losing the remainder
+        auto const n { std::max(GetProblem().TrainingRange().Size(), std::size_t{1}) };
+        auto const old { rows_.fetch_add(rows) };
+        ResidualEvaluations += (old + rows) / n - old / n;
+    }
+
+    auto
+    ProgressiveEvaluator::operator()(Operon::RandomGenerator& rng, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> typename EvaluatorBase::ReturnType
+    {
+        ++CallCount;
+        auto const& evaluator = evaluator_.get();
+        auto const range = GetProblem().TrainingRange();
+        auto const n { range.Size() };
+        auto const m { std::max(static_cast<std::size_t>(sampleRatio_ * static_cast<double>(n)), std::size_t{1}) };
+
+        if (m < n && ObjectiveCount() == 1) {
+            auto const s = std::uniform_int_distribution<std::size_t>{0UL, n - m}(rng);
+            auto fit = evaluator.EvaluateSubset(rng, ind, buf, Operon::Range{range.Start() + s, range.Start() + s + m});
+            CountRows(m);
+            if (fit.front() > threshold_) { return fit; }
+            ++Promotions;
+        }
+
+        CountRows(n);
+        return evaluator(rng, ind, buf);
+    }
+
     auto
     AggregateEvaluator::operator()(Operon::RandomGenerator& rng, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> typename EvaluatorBase::ReturnType
     {
@@ -145,23 +839,207 @@ namespace Operon {
         }
     }
 
+    template<> auto OPERON_EXPORT
+    MultiTargetEvaluator<DefaultDispatch>::Accumulate(Operon::Tree const& tree, Operon::Span<Operon::Scalar> buf) const -> std::vector<ErrorAccumulator>
+    {
+        // the batches of the output are accumulated into the statistics of every target (buf is filled unless empty)
+        auto const& problem = GetProblem();
+        auto const& dataset = problem.GetDataset();
+        auto const range = problem.TrainingRange();
+        std::vector<Operon::Span<Operon::Scalar const>> targets;
+        targets.reserve(targets_.size());
+        for (auto t : targets_) { targets.push_back(dataset.GetValues(t).subspan(range.Start(), range.Size())); }
+
+        std::vector<ErrorAccumulator> stats(targets_.size());
+        auto accumulate = [&](auto row, Operon::Span<Operon::Scalar const> values) {
+            for (auto k = 0UL; k < targets.size(); ++k) {
+                stats[k](values, targets[k].subspan(static_cast<std::size_t>(row), values.size()));
+            }
+        };
+        TInterpreter const interpreter{GetDispatchTable(), dataset, tree};
+        if (buf.empty()) {
+            interpreter.ForEachBatch(ScratchCoefficients(tree), range, accumulate);
+        } else {
+            interpreter.Evaluate(ScratchCoefficients(tree), range, buf, accumulate);
+        }
+        return stats;
+    }
+
+    template<> auto OPERON_EXPORT
+    MultiTargetEvaluator<DefaultDispatch>::operator()(Operon::RandomGenerator& /*rng*/, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> typename EvaluatorBase::ReturnType
+    {
+        ++CallCount;
+        ++ResidualEvaluations;
+        auto const& problem = GetProblem();
+        auto const range = problem.TrainingRange();
+
+        // the predictions are only needed for the metrics that cannot be computed from the statistics
+        auto const stream = error_.SupportsStatistics(scaling_);
+        Operon::Vector<Operon::Scalar> estimatedValues;
+        if (stream) {
+            buf = {};
+        } else if (buf.size() != range.Size()) {
+            estimatedValues.resize(range.Size());
+            buf = { estimatedValues.data(), estimatedValues.size() };
+        }
+        auto const stats = Accumulate(ind.Genotype, buf);
+
+        typename EvaluatorBase::ReturnType fit(targets_.size());
+        Operon::Vector<Operon::Scalar> scaled;
+        for (auto k = 0UL; k < targets_.size(); ++k) {
+            double f{0};
+            if (stream) {
+                f = error_(stats[k], scaling_);
+            } else {
+                auto const target = problem.GetDataset().GetValues(targets_[k]).subspan(range.Start(), range.Size());
+                auto const [a, b] = stats[k].LinearScaling();
+                scaled.resize(buf.size());
+                std::ranges::transform(buf, scaled.begin(), [a=a, b=b](auto x) { return static_cast<Operon::Scalar>(a * x + b); });
+                f = error_(scaled, target);
+            }
+            fit[k] = std::isfinite(f) ? static_cast<Operon::Scalar>(f) : EvaluatorBase::ErrMax;
+        }
+        return fit;
+    }
+
+    template<> auto OPERON_EXPORT
+    MultiTargetEvaluator<DefaultDispatch>::Scaling(Individual const& ind) const -> std::vector<std::pair<double, double>>
+    {
+        auto const stats = Accumulate(ind.Genotype, {});
+        std::vector<std::pair<double, double>> scaling;
+        scaling.reserve(stats.size());
+        for (auto const& s : stats) { scaling.push_back(s.LinearScaling()); }
+        return scaling;
+    }
+
+    template<> auto OPERON_EXPORT
+    CrossValidationEvaluator<DefaultDispatch>::FoldErrors(Operon::Tree const& tree) const -> std::vector<double>
+    {
+        auto const& problem = GetProblem();
+        auto const& dataset = problem.GetDataset();
+        auto const target = dataset.GetValues(problem.TargetVariable());
+
+        // the rows spanned by the folds are evaluated in one pass, each batch is split between the folds it overlaps
+        auto const lo = std::ranges::min(folds_, std::less{}, &Operon::Range::Start).Start();
+        auto const hi = std::ranges::max(folds_, std::less{}, &Operon::Range::End).End();
+        std::vector<ErrorAccumulator> stats(folds_.size());
+        TInterpreter const interpreter{GetDispatchTable(), dataset, tree};
+        interpreter.ForEachBatch(ScratchCoefficients(tree), Operon::Range{lo, hi}, [&](auto row, Operon::Span<Operon::Scalar const> values) {
+            auto const start = lo + static_cast<std::size_t>(row);
+            auto const end = start + values.size();
+            for (auto k = 0UL; k < folds_.size(); ++k) {
+                auto const a = std::max(start, folds_[k].Start());
+                auto const b = std::min(end, folds_[k].End());
+                if (a < b) { stats[k](values.subspan(a - start, b - a), target.subspan(a, b - a)); }
+            }
+        });
+
+        std::vector<double> errors(folds_.size());
+        for (auto k = 0UL; k < folds_.size(); ++k) {
+            if (!scaling_) {
+                errors[k] = error_(stats[k], /*scaled=*/false);
+                continue;
+            }
+            // the scaling parameters are fit on the other folds
+            ErrorAccumulator rest;
+            for (auto j = 0UL; j < folds_.size(); ++j) {
+                if (j != k) { rest.Merge(stats[j]); }
+            }
+            auto const [a, b] = rest.LinearScaling();
+            errors[k] = error_(stats[k].Scaled(a, b), /*scaled=*/false);
+        }
+        return errors;
+    }
+
+    template<> auto OPERON_EXPORT
+    CrossValidationEvaluator<DefaultDispatch>::operator()(Operon::RandomGenerator& /*rng*/, Individual& ind, Operon::Span<Operon::Scalar> /*buf*/) const -> typename EvaluatorBase::ReturnType
+    {
+        ++CallCount;
+        ++ResidualEvaluations;
+        auto const errors = FoldErrors(ind.Genotype);
+        auto const k = static_cast<double>(errors.size());
+        auto const mean = std::reduce(errors.begin(), errors.end()) / k;
+        auto const variance = std::transform_reduce(errors.begin(), errors.end(), 0.0, std::plus{}, [&](auto e) { return (e - mean) * (e - mean); }) / (k - 1);
+
+        auto finite = [](double v) { return std::isfinite(v) ? static_cast<Operon::Scalar>(v) : EvaluatorBase::ErrMax; };
+        return { finite(mean), finite(variance) };
+    }
+
+    template<> auto OPERON_EXPORT
+    Evaluator<DefaultDispatch>::Predict(Individual const& ind, Operon::Span<Operon::Scalar> buf) const -> void
+    {
+        auto const& problem = GetProblem();
+        auto const range = problem.TrainingRange();
+        EXPECT(buf.size() == range.Size());
+        ++ResidualEvaluations;
+        TInterpreter const interpreter{GetDispatchTable(), problem.GetDataset(), ind.Genotype};
+        interpreter.Evaluate(ScratchCoefficients(ind.Genotype), range, buf);
+    }
+
+    template<> auto OPERON_EXPORT
+    Evaluator<DefaultDispatch>::EvaluatePredictions(Operon::RandomGenerator& /*rng*/, Individual& ind, Operon::Span<Operon::Scalar const> predictions) const -> typename EvaluatorBase::ReturnType
+    {
+        ++CallCount;
+        auto const range = GetProblem().TrainingRange();
+        auto const targetValues = GetProblem().TargetValues(range);
+        EXPECT(predictions.size() == range.Size());
+        ComputeSemanticHash(ind);
+        if (record_) { ind.Statistics.reset(); }
+        ind.CaseErrors.clear();
+
+        typename EvaluatorBase::ReturnType result;
+        if (SupportsStatistics()) {
+            ErrorAccumulator stats;
+            stats(predictions, targetValues);
+            Record(ind, stats);
+            result = { ComputeFitness(stats) };
+            if (!caseRows_.empty()) { CaptureCaseErrors(ind, predictions, targetValues, /*scaled=*/false); }
+        } else {
+            // ComputeFitness scales the estimated values in place
+            Operon::Vector<Operon::Scalar> estimatedValues(predictions.begin(), predictions.end());
+            result = { ComputeFitness(estimatedValues, targetValues, WeightValues(range)) };
+            if (!caseRows_.empty()) { CaptureCaseErrors(ind, estimatedValues, targetValues, /*scaled=*/true); }
+        }
+        if (cache_.Enabled()) { InsertCached(CacheKey(ind), ind, result); }
+        return result;
+    }
+
+    namespace {
+        auto Bic(Operon::Tree const& tree, Operon::Scalar n, Operon::Scalar mse) -> typename EvaluatorBase::ReturnType {
+            auto p = static_cast<Operon::Scalar>(std::ranges::count_if(tree.Nodes(), &Operon::Node::Optimize));
+            auto bic = n * std::log(mse) + p * std::log(n);
+            if (!std::isfinite(bic)) { bic = EvaluatorBase::ErrMax; }
+            return typename EvaluatorBase::ReturnType { static_cast<Operon::Scalar>(bic) };
+        }
+
+        auto Aic(Operon::Scalar n, Operon::Scalar mse) -> typename EvaluatorBase::ReturnType {
+            auto aik = n/2 * (std::log(Operon::Math::Tau) + std::log(mse) + 1);
+            if (!std::isfinite(aik)) { aik = EvaluatorBase::ErrMax; }
+            return typename EvaluatorBase::ReturnType { static_cast<Operon::Scalar>(aik) };
+        }
+    } // namespace
+
     template<> auto OPERON_EXPORT
     BayesianInformationCriterionEvaluator<DefaultDispatch>::operator()(Operon::RandomGenerator& rng, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> typename EvaluatorBase::ReturnType {
-        auto const& tree = ind.Genotype;
-        auto p = static_cast<Operon::Scalar>(std::ranges::count_if(tree.Nodes(), &Operon::Node::Optimize));
         auto n = static_cast<Operon::Scalar>(Evaluator::GetProblem().TrainingRange().Size());
-        auto mse = Evaluator::operator()(rng, ind, buf).front();
-        auto bic = n * std::log(mse) + p * std::log(n);
-        if (!std::isfinite(bic)) { bic = EvaluatorBase::ErrMax; }
-        return typename EvaluatorBase::ReturnType { static_cast<Operon::Scalar>(bic) };
+        return Bic(ind.Genotype, n, Evaluator::operator()(rng, ind, buf).front());
+    }
+
+    template<> auto OPERON_EXPORT
+    BayesianInformationCriterionEvaluator<DefaultDispatch>::EvaluatePredictions(Operon::RandomGenerator& rng, Individual& ind, Operon::Span<Operon::Scalar const> predictions) const -> typename EvaluatorBase::ReturnType {
+        auto n = static_cast<Operon::Scalar>(Evaluator::GetProblem().TrainingRange().Size());
+        return Bic(ind.Genotype, n, Evaluator::EvaluatePredictions(rng, ind, predictions).front());
     }
 
     template<> auto OPERON_EXPORT
     AkaikeInformationCriterionEvaluator<DefaultDispatch>::operator()(Operon::RandomGenerator& rng, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> typename EvaluatorBase::ReturnType {
-        auto mse = Evaluator::operator()(rng, ind, buf).front();
         auto n = static_cast<Operon::Scalar>(Evaluator::GetProblem().TrainingRange().Size());
-        auto aik = n/2 * (std::log(Operon::Math::Tau) + std::log(mse) + 1);
-        if (!std::isfinite(aik)) { aik = EvaluatorBase::ErrMax; }
-        return typename EvaluatorBase::ReturnType { static_cast<Operon::Scalar>(aik) };
+        return Aic(n, Evaluator::operator()(rng, ind, buf).front());
+    }
+
+    template<> auto OPERON_EXPORT
+    AkaikeInformationCriterionEvaluator<DefaultDispatch>::EvaluatePredictions(Operon::RandomGenerator& rng, Individual& ind, Operon::Span<Operon::Scalar const> predictions) const -> typename EvaluatorBase::ReturnType {
+        auto n = static_cast<Operon::Scalar>(Evaluator::GetProblem().TrainingRange().Size());
+        return Aic(n, Evaluator::EvaluatePredictions(rng, ind, predictions).front());
     }
 } // namespace Operon
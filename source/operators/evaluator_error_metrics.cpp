@@ -1,29 +1,33 @@
 #include "operon/operators/evaluator.hpp"
 #include "operon/error_metrics/error_metrics.hpp"
+#include "operon/error_metrics/vectorized.hpp"
+
+#include <cmath>
+#include <limits>
 
 namespace Operon {
     auto ErrorMetric::operator()(Operon::Span<Operon::Scalar const> x, Operon::Span<Operon::Scalar const> y) const -> double {
         switch (type_) {
-        case ErrorType::SSE: return SumOfSquaredErrors(x, y);
-        case ErrorType::MSE: return MeanSquaredError(x, y);
-        case ErrorType::NMSE: return NormalizedMeanSquaredError(x, y);
-        case ErrorType::RMSE: return RootMeanSquaredError(x, y);
-        case ErrorType::MAE: return MeanAbsoluteError(x, y);
-        case ErrorType::R2: return -R2Score(x, y);
-        case ErrorType::C2: return -SquaredCorrelation(x, y);
+        case ErrorType::SSE: return Vectorized::SumOfSquaredErrors(x, y);
+        case ErrorType::MSE: return Vectorized::MeanSquaredError(x, y);
+        case ErrorType::NMSE: return Vectorized::NormalizedMeanSquaredError(x, y);
+        case ErrorType::RMSE: return Vectorized::RootMeanSquaredError(x, y);
+        case ErrorType::MAE: return Vectorized::MeanAbsoluteError(x, y);
+        case ErrorType::R2: return -Vectorized::R2Score(x, y);
+        case ErrorType::C2: return -Vectorized::SquaredCorrelation(x, y);
         default: { throw std::runtime_error("unknown error type"); }
         }
     }
 
     auto ErrorMetric::operator()(Operon::Span<Operon::Scalar const> x, Operon::Span<Operon::Scalar const> y, Operon::Span<Operon::Scalar const> w) const -> double {
         switch (type_) {
-        case ErrorType::SSE: return SumOfSquaredErrors(x, y, w);
-        case ErrorType::MSE: return MeanSquaredError(x, y, w);
-        case ErrorType::NMSE: return NormalizedMeanSquaredError(x, y, w);
-        case ErrorType::RMSE: return RootMeanSquaredError(x, y, w);
-        case ErrorType::MAE: return MeanAbsoluteError(x, y, w);
-        case ErrorType::R2: return -R2Score(x, y, w);
-        case ErrorType::C2: return -SquaredCorrelation(x, y, w);
+        case ErrorType::SSE: return Vectorized::SumOfSquaredErrors(x, y, w);
+        case ErrorType::MSE: return Vectorized::MeanSquaredError(x, y, w);
+        case ErrorType::NMSE: return Vectorized::NormalizedMeanSquaredError(x, y, w);
+        case ErrorType::RMSE: return Vectorized::RootMeanSquaredError(x, y, w);
+        case ErrorType::MAE: return Vectorized::MeanAbsoluteError(x, y, w);
+        case ErrorType::R2: return -Vectorized::R2Score(x, y, w);
+        case ErrorType::C2: return -Vectorized::SquaredCorrelation(x, y, w);
         default: { throw std::runtime_error("unknown error type"); }
         }
     }
@@ -53,4 +57,44 @@ namespace Operon {
         default: { throw std::runtime_error("unknown error type"); }
         }
     }
+
+    auto ErrorMetric::operator()(ErrorAccumulator const& stats, bool scaled) const -> double {
+        auto const n { stats.Count() };
+        auto const sse { scaled ? stats.ScaledSumOfSquaredErrors() : stats.SumOfSquaredErrors() };
+        auto const sst { stats.SumSquaresY() };
+
+        switch (type_) {
+        case ErrorType::SSE: return sse;
+        case ErrorType::MSE: return sse / n;
+        case ErrorType::NMSE: return sst > 0 ? sse / sst : 0.0;
+        case ErrorType::RMSE: return std::sqrt(sse / n);
+        case ErrorType::MAE: {
+            if (scaled) { throw std::runtime_error("the scaled mean absolute error cannot be computed from statistics"); }
+            return stats.SumOfAbsoluteErrors() / n;
+        }
+        case ErrorType::R2: {
+            if (sst < std::numeric_limits<double>::epsilon()) { return -std::numeric_limits<double>::lowest(); }
+            return -(1.0 - sse / sst);
+        }
+        case ErrorType::C2: {
+            auto const sxy { stats.SumProducts() };
+            return -(sxy * sxy / (stats.SumSquaresX() * sst));
+        }
+        default: { throw std::runtime_error("unknown error type"); }
+        }
+    }
+
+    auto ErrorMetric::LowerBound(ErrorAccumulator const& partial, double n, bool scaled) const -> double {
+        auto const sse { scaled ? partial.ScaledSumOfSquaredErrors() : partial.SumOfSquaredErrors() };
+        switch (type_) {
+        case ErrorType::SSE: return sse;
+        case ErrorType::MSE: return sse / n;
+        case ErrorType::RMSE: return std::sqrt(sse / n);
+        case ErrorType::MAE: {
+            if (!scaled) { return partial.SumOfAbsoluteErrors() / n; }
+            [[fallthrough]];
+        }
+        default: { throw std::runtime_error("the error metric does not support lower bounds"); }
+        }
+    }
 }  // namespace Operon
\ No newline at end of file
@@ -9,4 +9,10 @@ namespace Operon {
         auto res = OffspringGeneratorBase::Generate(random, pCrossover, pMutation, pLocal, buf);
         return res.Child;
     }
+
+    auto BasicOffspringGenerator::GenerateInto(Operon::RandomGenerator& random, double pCrossover, double pMutation, double pLocal, Operon::Span<Operon::Scalar> buf, Individual& slot) const -> bool
+    {
+        RecombinationResult res;
+        return OffspringGeneratorBase::Generate(random, pCrossover, pMutation, pLocal, buf, res, slot);
+    }
 } // namespace Operon
@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#ifndef OPERON_OPERATORS_GENERATOR_BROOD_HPP
+#define OPERON_OPERATORS_GENERATOR_BROOD_HPP
+
+// the brood shared by BroodOffspringGenerator and PolygenicOffspringGenerator
+
+#include <algorithm>
+#include <functional>
+#include <taskflow/taskflow.hpp>
+#include <vector>
+
+#include "operon/core/executor.hpp"
+#include "operon/operators/generator.hpp"
+#include "operon/operators/non_dominated_sorter.hpp"
+
+namespace Operon::detail {
+
+// fills the brood with make(random, buf, child)
+// - each member has its own generator seeded from the given one, so the brood does not depend on the executor
+// - with an executor the members are generated in parallel, without the buffer (the evaluator then streams or allocates)
+inline auto GenerateBrood(tf::Executor* executor, Operon::RandomGenerator& random, Operon::Span<Operon::Scalar> buf, std::vector<Individual>& offspring,
+    std::function<void(Operon::RandomGenerator&, Operon::Span<Operon::Scalar>, Individual&)> const& make) -> void
+{
+    std::vector<Operon::RandomGenerator::result_type> seeds(offspring.size());
+    std::ranges::generate(seeds, std::ref(random));
+
+    if (executor == nullptr || offspring.size() < 2) {
+        for (auto i = 0UL; i < offspring.size(); ++i) {
+            Operon::RandomGenerator rng(seeds[i]);
+            make(rng, buf, offspring[i]);
+        }
+        return;
+    }
+
+    tf::Taskflow taskflow;
+    for (auto i = 0UL; i < offspring.size(); ++i) {
+        taskflow.emplace([&, i]() {
+            Operon::RandomGenerator rng(seeds[i]);
+            make(rng, {}, offspring[i]);
+        });
+    }
+    RunTaskflow(*executor, taskflow);
+}
+
+// the best child: the first objective decides for single-objective problems, otherwise the best
+// child in the first front
+inline auto BestOfBrood(std::vector<Individual>& offspring) -> Individual&
+{
+    SingleObjectiveComparison comp{0};
+    if (offspring.front().Size() > 1) {
+        std::stable_sort(offspring.begin(), offspring.end(), LexicographicalComparison{});
+        auto fronts = RankIntersectSorter{}(offspring);
+        auto best = *std::min_element(fronts[0].begin(), fronts[0].end(), [&](auto i, auto j) { return comp(offspring[i], offspring[j]); });
+        return offspring[best];
+    }
+    return *std::min_element(offspring.begin(), offspring.end(), comp);
+}
+
+} // namespace Operon::detail
+
+#endif
@@ -6,21 +6,30 @@
 
 namespace Operon {
 
+    auto OffspringSelectionGenerator::ComparisonFitness(RecombinationResult const& res) const -> Operon::Vector<Operon::Scalar>
+    {
+        if (!res.Parent2) { return res.Parent1->Fitness; }
+        Operon::Vector<Operon::Scalar> q(res.Parent1->Size());
+        for (size_t i = 0; i < q.size(); ++i) {
+            auto f1 = (*res.Parent1)[i];
+            auto f2 = (*res.Parent2)[i];
+            q[i] = std::max(f1, f2) - static_cast<Operon::Scalar>(comparisonFactor_) * std::abs(f1 - f2);
+        }
+        return q;
+    }
+
+    auto OffspringSelectionGenerator::FitnessBound(RecombinationResult const& res) const -> Operon::Vector<Operon::Scalar>
+    {
+        // a bound is only meaningful for a single objective, where the child is rejected if its fitness exceeds it
+        if (!earlyTermination_ || res.Parent1->Size() != 1) { return {}; }
+        return ComparisonFitness(res);
+    }
+
     auto OffspringSelectionGenerator::operator()(Operon::RandomGenerator& random, double pCrossover, double pMutation, double pLocal, Operon::Span<Operon::Scalar> buf) const -> std::optional<Individual>
     {
         auto res = OffspringGeneratorBase::Generate(random, pCrossover, pMutation, pLocal, buf);
-        bool accept{false};
-        if (res.Parent2) {
-            Individual q(res.Child->Size());
-            for (size_t i = 0; i < q.Size(); ++i) {
-                auto f1 = (*res.Parent1)[i];
-                auto f2 = (*res.Parent2)[i];
-                q[i] = std::max(f1, f2) - static_cast<Operon::Scalar>(comparisonFactor_) * std::abs(f1 - f2);
-                accept = Operon::ParetoDominance{}(res.Child->Fitness, q.Fitness) != Dominance::Right;
-            }
-        } else {
-            accept = Operon::ParetoDominance{}(res.Child->Fitness, res.Parent1->Fitness) != Dominance::Right;
-        }
+        auto const q = ComparisonFitness(res);
+        auto const accept = Operon::ParetoDominance{}(res.Child->Fitness, q) != Dominance::Right;
         return accept ? res.Child : std::nullopt;
     }
 
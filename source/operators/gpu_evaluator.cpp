@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include "operon/operators/gpu_evaluator.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace Operon {
+
+GpuEvaluator::GpuEvaluator(Problem& problem, GpuDataset const& dataset, ErrorMetric error, bool linearScaling)
+    : EvaluatorBase(problem)
+    , dataset_(dataset)
+    , error_(error)
+    , scaling_(linearScaling)
+{
+    if (dataset.Rows() != problem.GetDataset().Rows<std::size_t>()) {
+        throw std::invalid_argument("the device dataset and the dataset of the problem have a different number of rows");
+    }
+    if (!error_.SupportsStatistics(scaling_)) {
+        throw std::invalid_argument("the error metric cannot be computed from the error statistics");
+    }
+}
+
+auto GpuEvaluator::Statistics(Operon::Span<Individual const> individuals) const -> std::vector<ErrorAccumulator>
+{
+    std::vector<std::reference_wrapper<Operon::Tree const>> trees;
+    trees.reserve(individuals.size());
+    for (auto const& ind : individuals) {
+        trees.emplace_back(ind.Genotype);
+    }
+    auto const& problem = GetProblem();
+    return EvaluateErrorStatistics(dataset_.get(), trees, problem.TrainingRange(), problem.TargetVariable().Hash);
+}
+
+auto GpuEvaluator::operator()(Operon::RandomGenerator& /*rng*/, Individual& ind, Operon::Span<Operon::Scalar> /*buf*/) const -> typename EvaluatorBase::ReturnType
+{
+    ++CallCount;
+    ++ResidualEvaluations;
+    auto const fit = static_cast<Operon::Scalar>(error_(Statistics({ &ind, 1 }).front(), scaling_));
+    return { std::isfinite(fit) ? fit : EvaluatorBase::ErrMax };
+}
+
+auto GpuEvaluator::Evaluate(Operon::RandomGenerator& /*rng*/, Operon::Span<Individual> individuals, Operon::Vector<Operon::Scalar>& /*buf*/) const -> void
+{
+    CallCount += individuals.size();
+    ResidualEvaluations += individuals.size();
+    auto const stats = Statistics(individuals);
+    for (auto i = 0UL; i < individuals.size(); ++i) {
+        auto const fit = static_cast<Operon::Scalar>(error_(stats[i], scaling_));
+        individuals[i].Fitness = { std::isfinite(fit) ? fit : EvaluatorBase::ErrMax };
+    }
+}
+
+} // namespace Operon
@@ -3,8 +3,16 @@
 
 #include "operon/operators//local_search.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+#include "operon/core/individual.hpp"
 #include "operon/core/tree.hpp"
 #include "operon/optimizer/optimizer.hpp"
+#include "operon/optimizer/solver_state_cache.hpp"
 
 namespace Operon {
 
@@ -12,7 +20,8 @@ auto CoefficientOptimizer::operator()(Operon::RandomGenerator& rng, Operon::Tree
     OptimizerSummary summary;
     auto const& optimizer = optimizer_.get();
     if (optimizer.Iterations() > 0) {
-        summary = optimizer.Optimize(rng, tree);
+        auto const* cache = Cache();
+        summary = cache != nullptr && tree.CoefficientsCount() > 0 ? OptimizeWarm(rng, tree, *cache) : Optimize(rng, tree);
 
         if (std::bernoulli_distribution(lamarckianProbability_)(rng) && summary.Success) {
             tree.SetCoefficients(summary.FinalParameters);
@@ -20,4 +29,111 @@ auto CoefficientOptimizer::operator()(Operon::RandomGenerator& rng, Operon::Tree
     }
     return summary;
 }
+
+auto CoefficientOptimizer::operator()(Operon::RandomGenerator& rng, Operon::Span<Operon::Individual> individuals) const -> OptimizerSummary {
+    std::vector<std::size_t> order(individuals.size());
+    std::iota(order.begin(), order.end(), 0UL);
+    std::vector<Operon::Hash> keys(individuals.size());
+    if (Cache() != nullptr) {
+        std::ranges::transform(individuals, keys.begin(), [](auto const& ind) { return SolverStateCache::Key(ind.Genotype); });
+    }
+    std::ranges::stable_sort(order, std::greater{}, [&](auto i) { return std::pair{ individuals[i].Genotype.Length(), keys[i] }; });
+
+    OptimizerSummary total;
+    for (auto i : order) {
+        auto const summary = (*this)(rng, individuals[i].Genotype);
+        total.FunctionEvaluations += summary.FunctionEvaluations;
+        total.JacobianEvaluations += summary.JacobianEvaluations;
+        total.SavedJacobianEvaluations += summary.SavedJacobianEvaluations;
+    }
+    return total;
+}
+
+auto CoefficientOptimizer::Cache() const -> SolverStateCache const* {
+    auto const* cache = optimizer_.get().StateCache();
+    return structureWarmStart_ && cache != nullptr && cache->Enabled() ? cache : nullptr;
+}
+
+auto CoefficientOptimizer::Optimize(Operon::RandomGenerator& rng, Operon::Tree const& tree) const -> OptimizerSummary {
+    return adaptiveStep_ > 0 ? OptimizeAdaptive(rng, tree) : optimizer_.get().Optimize(rng, tree);
+}
+
+auto CoefficientOptimizer::OptimizeWarm(Operon::RandomGenerator& rng, Operon::Tree const& tree, SolverStateCache const& cache) const -> OptimizerSummary {
+    auto const key = SolverStateCache::Key(tree);
+    auto const state = cache.Find(key);
+    auto const known = state.has_value() && state->Coefficients.size() == tree.CoefficientsCount();
+
+    if (known && state->Converged) {
+        OptimizerSummary summary;
+        summary.InitialParameters = tree.GetCoefficients();
+        summary.FinalParameters = state->Coefficients;
+        summary.InitialCost = summary.FinalCost = static_cast<Operon::Scalar>(state->Cost);
+        summary.Success = true;
+        summary.SavedJacobianEvaluations = static_cast<int>(optimizer_.get().Iterations());
+        return summary;
+    }
+
+    auto start = tree;
+    if (known) { start.SetCoefficients(state->Coefficients); }
+    auto summary = Optimize(rng, start);
+
+    // an unsuccessful optimization leaves the initial coefficients as the best ones
+    auto const cost = summary.Success ? summary.FinalCost : summary.InitialCost;
+    auto const coefficients = summary.Success ? summary.FinalParameters : summary.InitialParameters;
+    if (!std::isfinite(cost)) { return summary; }
+
+    auto const reduction = (summary.InitialCost - cost) / std::max(std::abs(summary.InitialCost), std::numeric_limits<Operon::Scalar>::min());
+    cache.Update(key, [&](auto& s) {
+        if (s.Coefficients.size() != coefficients.size() || cost < s.Cost) {
+            s.Coefficients = coefficients;
+            s.Cost = cost;
+        }
+        s.Converged = known && reduction < adaptiveTolerance_ && s.Cost >= cost;
+    });
+
+    if (known) {
+        summary.InitialParameters = tree.GetCoefficients();
+        summary.FinalParameters = coefficients;
+        summary.FinalCost = cost;
+        summary.Success = true;
+    }
+    return summary;
+}
+
+auto CoefficientOptimizer::OptimizeAdaptive(Operon::RandomGenerator& rng, Operon::Tree const& tree) const -> OptimizerSummary {
+    auto const& optimizer = optimizer_.get();
+    auto const budget = optimizer.Iterations();
+
+    OptimizerSummary total;
+    total.InitialParameters = tree.GetCoefficients();
+    total.FinalParameters = total.InitialParameters;
+
+    // each round starts from the coefficients found by the previous one
+    auto current = tree;
+    auto used{0UL};
+    auto step{adaptiveStep_};
+    for (auto round = 0; used < budget; ++round) {
+        auto const n = std::min(step, budget - used);
+        auto const summary = optimizer.Optimize(rng, current, n);
+        used += n;
+
+        if (round == 0) { total.InitialCost = total.FinalCost = summary.InitialCost; }
+        total.Iterations += summary.Iterations;
+        total.FunctionEvaluations += summary.FunctionEvaluations;
+        total.JacobianEvaluations += summary.JacobianEvaluations;
+        if (!summary.Success) { break; }
+
+        total.FinalParameters = summary.FinalParameters;
+        total.FinalCost = summary.FinalCost;
+        current.SetCoefficients(summary.FinalParameters);
+
+        auto const reduction = (summary.InitialCost - summary.FinalCost) / std::max(std::abs(summary.InitialCost), std::numeric_limits<Operon::Scalar>::min());
+        if (reduction < adaptiveTolerance_ || summary.Iterations < static_cast<int>(n)) { break; }
+        if (reduction > 10 * adaptiveTolerance_) { step *= 2; } // NOLINT
+    }
+
+    total.SavedJacobianEvaluations = static_cast<int>(budget - used);
+    total.Success = detail::CheckSuccess(total.InitialCost, total.FinalCost);
+    return total;
+}
 } // namespace Operon
\ No newline at end of file
@@ -9,12 +9,49 @@
 #include <numeric>
 #include <random>
 #include <type_traits>
+#include <utility>
 
 #include "operon/operators/creator.hpp"
 #include "operon/operators/initializer.hpp"
 
 namespace Operon {
 
+namespace {
+    // replaces the nodes [begin, begin + removed) of the tree with the inserted nodes
+    // - the nodes of a tree that is not shared are spliced in place: the nodes after the replaced ones are moved once
+    // - the nodes of a shared tree are copied into a new buffer (the other copies keep the original nodes)
+    // - the metadata of the nodes is not updated (see Tree::UpdateNodes)
+    auto SpliceNodes(Tree& tree, size_t begin, size_t removed, Operon::Span<Node const> inserted) -> void
+    {
+        using Signed = std::make_signed_t<size_t>;
+        auto const size = tree.Length();
+        EXPECT(begin + removed <= size);
+        auto const newSize = size - removed + inserted.size();
+
+        if (tree.Shared()) {
+            auto const& nodes = std::as_const(tree).Nodes();
+            auto mutated = NodeArena::Acquire(newSize);
+            std::copy(nodes.begin(), nodes.begin() + static_cast<Signed>(begin), std::back_inserter(mutated));
+            std::copy(inserted.begin(), inserted.end(), std::back_inserter(mutated));
+            std::copy(nodes.begin() + static_cast<Signed>(begin + removed), nodes.end(), std::back_inserter(mutated));
+            tree = Tree(std::move(mutated));
+            return;
+        }
+
+        auto& nodes = tree.Nodes();
+        auto const tail = static_cast<Signed>(begin + removed);
+        auto const head = static_cast<Signed>(begin + inserted.size());
+        if (newSize > size) {
+            nodes.resize(newSize);
+            std::copy_backward(nodes.begin() + tail, nodes.begin() + static_cast<Signed>(size), nodes.end());
+        } else if (newSize < size) {
+            std::copy(nodes.begin() + tail, nodes.end(), nodes.begin() + head);
+            nodes.resize(newSize);
+        }
+        std::copy(inserted.begin(), inserted.end(), nodes.begin() + static_cast<Signed>(begin));
+    }
+} // namespace
+
 auto DiscretePointMutation::operator()(Operon::RandomGenerator& random, Tree tree) const -> Tree
 {
     auto& nodes = tree.Nodes();
@@ -84,7 +121,8 @@ auto ChangeFunctionMutation::operator()(Operon::RandomGenerator& random, Tree tr
 
 auto ReplaceSubtreeMutation::operator()(Operon::RandomGenerator& random, Tree tree) const -> Tree
 {
-    auto& nodes = tree.Nodes();
+    // the nodes are only read until the splice, a shared tree is copied once with the new subtree (see SpliceNodes)
+    auto const& nodes = std::as_const(tree).Nodes();
 
     auto i = std::uniform_int_distribution<size_t>(0, nodes.size() - 1)(random);
 
@@ -106,20 +144,18 @@ auto ReplaceSubtreeMutation::operator()(Operon::RandomGenerator& random, Tree tr
     auto subtree = creator_(random, static_cast<size_t>(newLen), 1, maxDepth);
     coefficientInitializer_(random, subtree);
 
-    Operon::Vector<Node> mutated;
-    mutated.reserve(nodes.size() - oldLen + static_cast<size_t>(newLen));
-
-    using Signed = std::make_signed_t<size_t>;
-    std::copy(nodes.begin(), nodes.begin() + static_cast<Signed>(i - nodes[i].Length), std::back_inserter(mutated));
-    std::copy(subtree.Nodes().begin(), subtree.Nodes().end(), std::back_inserter(mutated));
-    std::copy(nodes.begin() + static_cast<Signed>(i + 1), nodes.end(), std::back_inserter(mutated));
-
-    return Tree(mutated).UpdateNodes();
+    auto const begin = i - nodes[i].Length;
+    auto const inserted = subtree.Length();
+    auto const parent = static_cast<size_t>(static_cast<Signed>(nodes[i].Parent) + static_cast<Signed>(inserted) - static_cast<Signed>(oldLen));
+    SpliceNodes(tree, begin, oldLen, std::as_const(subtree).Nodes());
+    tree.UpdateNodes(begin, oldLen, inserted, parent);
+    return tree;
 }
 
 auto RemoveSubtreeMutation::operator()(Operon::RandomGenerator& random, Tree tree) const -> Tree
 {
-    auto& nodes = tree.Nodes();
+    // the nodes are only read until the removal, a shared tree is copied once without the removed nodes
+    auto const& nodes = std::as_const(tree).Nodes();
 
     if (nodes.size() == 1) {
         return tree; // nothing to remove
@@ -128,9 +164,12 @@ auto RemoveSubtreeMutation::operator()(Operon::RandomGenerator& random, Tree tre
     auto it = Operon::Random::Sample(random, nodes.begin(), nodes.end() - 1); // -1 because we don't want to remove the tree root
     auto const& p = nodes[it->Parent];
     if (p.Arity > pset_.MinimumArity(p.HashValue)) {
-        nodes[it->Parent].Arity--;
-        nodes.erase(it - it->Length, it + 1);
-        tree.UpdateNodes();
+        auto const removed = it->Length + 1UL;
+        auto const begin = static_cast<size_t>(std::distance(nodes.begin(), it)) - it->Length;
+        auto const parent = it->Parent - removed;
+        SpliceNodes(tree, begin, removed, {});
+        tree[parent].Arity--;
+        tree.UpdateNodes(begin, removed, 0, parent);
     }
     return tree;
 }
@@ -142,7 +181,7 @@ auto InsertSubtreeMutation::operator()(Operon::RandomGenerator& random, Tree tre
         return tree;
     }
 
-    auto& nodes = tree.Nodes();
+    auto const& nodes = std::as_const(tree).Nodes();
     auto const& creator = creator_.get();
     auto const& pset = creator.GetPrimitiveSet();
 
@@ -175,19 +214,13 @@ auto InsertSubtreeMutation::operator()(Operon::RandomGenerator& random, Tree tre
     auto subtree = creator_(random, newLen, 1, availableDepth);
     coefficientInitializer_(random, subtree);
 
-    Operon::Vector<Node> mutated;
-    mutated.reserve(nodes.size() + newLen);
-
-    // increase parent arity
-    nodes[i].Arity++;
-
-    using Signed = std::make_signed_t<size_t>;
-    // copy nodes
-    std::copy(nodes.begin(), nodes.begin() + static_cast<Signed>(i - nodes[i].Length), std::back_inserter(mutated));
-    std::copy(subtree.Nodes().begin(), subtree.Nodes().end(), std::back_inserter(mutated));
-    std::copy(nodes.begin() + static_cast<Signed>(i - nodes[i].Length), nodes.end(), std::back_inserter(mutated));
-
-    return Tree(mutated).UpdateNodes();
+    // the subtree becomes the first child of node i (the copy of a shared parent is modified, not the input tree)
+    auto const begin = i - nodes[i].Length;
+    auto const inserted = subtree.Length();
+    SpliceNodes(tree, begin, 0, std::as_const(subtree).Nodes());
+    tree[i + inserted].Arity++;
+    tree.UpdateNodes(begin, 0, inserted, i + inserted);
+    return tree;
 }
 
 auto ShuffleSubtreesMutation::operator()(Operon::RandomGenerator& random, Tree tree) const -> Tree
@@ -0,0 +1,28 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <algorithm>
+#include <taskflow/taskflow.hpp>
+
+#include "operon/core/executor.hpp"
+#include "operon/operators/non_dominated_sorter.hpp"
+
+namespace Operon {
+
+auto NondominatedSorterBase::ForEachChunk(std::size_t n, std::function<void(std::size_t, std::size_t)> const& func) const -> void
+{
+    auto const workers { executor_ == nullptr ? 1UL : workers_ == 0 ? executor_->num_workers() : std::min(workers_, executor_->num_workers()) };
+    if (workers < 2 || n < 2) {
+        func(0, n);
+        return;
+    }
+
+    auto const chunk { (n + workers - 1) / workers };
+    tf::Taskflow taskflow;
+    for (auto i = 0UL; i < n; i += chunk) {
+        taskflow.emplace([&func, i, chunk, n]() { func(i, std::min(i + chunk, n)); });
+    }
+    RunTaskflow(*executor_, taskflow);
+}
+
+} // namespace Operon
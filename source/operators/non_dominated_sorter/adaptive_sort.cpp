@@ -0,0 +1,119 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include "operon/operators/non_dominated_sorter.hpp"
+#include "operon/core/individual.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace Operon {
+
+namespace {
+    // the order of the candidates, the fixed rule refers to it
+    enum Candidate : std::size_t { RS, RO, MNDS, ENSBS, ENSSS, BI, TRI };
+    constexpr std::size_t Candidates{BI}; // the sweep sorters are not calibrated
+
+    constexpr std::size_t TieSample{1024};
+} // namespace
+
+AdaptiveSorter::AdaptiveSorter(std::size_t calibrationLimit)
+    : limit_(calibrationLimit)
+{
+    sorters_.push_back(std::make_unique<RankIntersectSorter>());
+    sorters_.push_back(std::make_unique<RankOrdinalSorter>());
+    sorters_.push_back(std::make_unique<MergeSorter>());
+    sorters_.push_back(std::make_unique<EfficientBinarySorter>());
+    sorters_.push_back(std::make_unique<EfficientSequentialSorter>());
+    sorters_.push_back(std::make_unique<BiObjectiveSorter>());
+    sorters_.push_back(std::make_unique<TriObjectiveSorter>());
+}
+
+auto AdaptiveSorter::TieRatio(Operon::Span<Operon::Individual const> pop) -> double
+{
+    if (pop.size() < 2) { return 0; }
+    // the population is usually sorted lexicographically, so the sample is strided
+    auto const k = std::min(pop.size(), TieSample);
+    auto const stride = pop.size() / k;
+    auto const m = pop.front().Size();
+    std::vector<Operon::Scalar> values(k);
+    auto ties{0.0};
+    for (auto j = 0UL; j < m; ++j) {
+        for (auto i = 0UL; i < k; ++i) { values[i] = pop[i * stride][j]; }
+        std::ranges::sort(values);
+        auto const distinct = std::distance(values.begin(), std::unique(values.begin(), values.end()));
+        ties += 1.0 - (static_cast<double>(distinct) / static_cast<double>(k));
+    }
+    return ties / static_cast<double>(m);
+}
+
+auto AdaptiveSorter::Shape(Operon::Span<Operon::Individual const> pop) -> std::uint64_t
+{
+    constexpr auto tenths{10.0};
+    auto const size = static_cast<std::uint64_t>(std::bit_width(pop.size()));
+    auto const m = static_cast<std::uint64_t>(pop.empty() ? 0 : pop.front().Size());
+    auto const ties = static_cast<std::uint64_t>(std::lround(TieRatio(pop) * tenths));
+    return (size << 48U) | (m << 8U) | ties; // NOLINT
+}
+
+auto AdaptiveSorter::Rule(Operon::Span<Operon::Individual const> pop) const -> std::size_t
+{
+    auto const m = pop.empty() ? 0UL : pop.front().Size();
+    if (m == 2) { return BI; }
+    if (m == 3) { return TRI; }
+    return RS;
+}
+
+auto AdaptiveSorter::Choice(Operon::Span<Operon::Individual const> pop) const -> NondominatedSorterBase const&
+{
+    auto const shape = Shape(pop);
+    std::scoped_lock lock(mutex_);
+    auto it = choice_.find(shape);
+    return *sorters_[it == choice_.end() ? Rule(pop) : it->second];
+}
+
+auto AdaptiveSorter::Sort(Operon::Span<Operon::Individual const> pop, Operon::Scalar eps) const -> NondominatedSorterBase::Result
+{
+    for (auto const& s : sorters_) {
+        if (s->Executor() != Executor() || s->Workers() != Workers()) { s->SetExecutor(Executor(), Workers()); }
+    }
+    if (pop.size() > limit_ || pop.empty() || pop.front().Size() <= 3) { return sorters_[Rule(pop)]->Sort(pop, eps); }
+
+    auto const shape = Shape(pop);
+    auto const known = [&]() -> std::optional<std::size_t> {
+        std::scoped_lock lock(mutex_);
+        auto it = choice_.find(shape);
+        return it == choice_.end() ? std::nullopt : std::optional{it->second};
+    }();
+    if (known) { return sorters_[*known]->Sort(pop, eps); }
+
+    // calibration: all the candidates give the same fronts, the result of the fastest one is returned
+    NondominatedSorterBase::Result fronts;
+    auto best{std::numeric_limits<double>::max()};
+    auto choice{Rule(pop)};
+    for (auto i = 0UL; i < Candidates; ++i) {
+        auto const t0 = std::chrono::steady_clock::now();
+        auto result = sorters_[i]->Sort(pop, eps);
+        auto const t1 = std::chrono::steady_clock::now();
+        auto const elapsed = std::chrono::duration<double>(t1 - t0).count();
+        if (elapsed < best) {
+            best = elapsed;
+            choice = i;
+            fronts = std::move(result);
+        }
+    }
+    {
+        std::scoped_lock lock(mutex_);
+        choice_[shape] = choice;
+    }
+    return fronts;
+}
+
+} // namespace Operon
@@ -1,8 +1,10 @@
 // SPDX-License-Identifier: MIT
 // SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
 
+#include <algorithm>
 #include <numeric>
 #include "operon/operators/non_dominated_sorter.hpp"
+#include "operon/core/fitness_matrix.hpp"
 #include "operon/core/individual.hpp"
 #include <Eigen/Core>
 
@@ -10,14 +12,15 @@ namespace Operon {
     using Vec = Eigen::Matrix<int64_t, -1, 1, Eigen::ColMajor>;
     using Mat = Eigen::Matrix<int64_t, -1, -1, Eigen::ColMajor>;
 
-    inline auto ComputeComparisonMatrix(Operon::Span<Operon::Individual const> pop, Mat const& idx, Eigen::Index colIdx) noexcept
+    inline auto ComputeComparisonMatrix(FitnessMatrix const& fitness, Mat const& idx, Eigen::Index colIdx) noexcept
     {
-        auto const n = static_cast<Eigen::Index>(pop.size());
+        auto const n = static_cast<Eigen::Index>(fitness.Rows());
+        auto const values = fitness.Objective(colIdx);
         Mat c = Mat::Zero(n, n);
         Mat::ConstColXpr b = idx.col(colIdx);
         c.row(b(0)).fill(1); // NOLINT
         for (auto i = 1; i < n; ++i) {
-            if (pop[b(i)][colIdx] == pop[b(i-1)][colIdx]) {
+            if (values[b(i)] == values[b(i-1)]) {
                 c.row(b(i)) = c.row(b(i-1));
             } else {
                 for (auto j = i; j < n; ++j) {
@@ -28,19 +31,19 @@ namespace Operon {
         return c;
     }
 
-    inline auto ComparisonMatrixSum(Operon::Span<Operon::Individual const> pop, Mat const& idx) noexcept {
-        Mat d = ComputeComparisonMatrix(pop, idx, 0);
+    inline auto ComparisonMatrixSum(FitnessMatrix const& fitness, Mat const& idx) noexcept {
+        Mat d = ComputeComparisonMatrix(fitness, idx, 0);
         for (int i = 1; i < idx.cols(); ++i) {
-            d.noalias() += ComputeComparisonMatrix(pop, idx, i);
+            d.noalias() += ComputeComparisonMatrix(fitness, idx, i);
         }
         return d;
     }
 
-    inline auto ComputeDegreeMatrix(Operon::Span<Operon::Individual const> pop, Mat const& idx) noexcept
+    inline auto ComputeDegreeMatrix(FitnessMatrix const& fitness, Mat const& idx) noexcept
     {
-        auto const n = static_cast<Eigen::Index>(pop.size());
-        auto const m = static_cast<Eigen::Index>(pop.front().Fitness.size());
-        Mat d = ComparisonMatrixSum(pop, idx);
+        auto const n = static_cast<Eigen::Index>(fitness.Rows());
+        auto const m = static_cast<Eigen::Index>(fitness.Cols());
+        Mat d = ComparisonMatrixSum(fitness, idx);
         for (auto i = 0; i < n; ++i) {
             for (auto j = i; j < n; ++j) {
                 if (d(i, j) == m && d(j, i) == m) {
@@ -58,26 +61,61 @@ namespace Operon {
         auto const m = static_cast<Eigen::Index>(pop.front().Fitness.size());
 
         Operon::Less cmp;
+        FitnessMatrix const fitness(pop);
         Mat idx = Vec::LinSpaced(n, 0, n-1).replicate(1, m);
         for (auto i = 0; i < m; ++i) {
             auto *data = idx.col(i).data();
-            std::sort(data, data + n, [&](auto a, auto b) { return cmp(pop[a][i], pop[b][i], eps); });
+            auto const values = fitness.Objective(i);
+            std::sort(data, data + n, [&](auto a, auto b) { return cmp(values[a], values[b], eps); });
+        }
+        Mat d;
+        if (Executor() == nullptr) {
+            d = ComputeDegreeMatrix(fitness, idx);
+        } else {
+            // the sorted comparison matrices depend on the previous row, so in parallel each column of the degree matrix
+            // is computed directly from the same sorted order: in ComputeComparisonMatrix c(i, j) is one if the run of
+            // equal values j belongs to in the sorted order does not start before the one of i
+            Mat r(n, m);
+            for (auto k = 0; k < m; ++k) {
+                auto const b = idx.col(k);
+                auto const values = fitness.Objective(k);
+                r(b(0), k) = 0;
+                for (auto i = 1; i < n; ++i) {
+                    r(b(i), k) = values[b(i)] == values[b(i-1)] ? r(b(i-1), k) : i;
+                }
+            }
+            d.resize(n, n);
+            ForEachChunk(static_cast<std::size_t>(n), [&](auto begin, auto end) {
+                Vec ab(n);
+                Vec ba(n);
+                for (auto j = static_cast<Eigen::Index>(begin); j < static_cast<Eigen::Index>(end); ++j) {
+                    ab.setZero();
+                    ba.setZero();
+                    for (auto k = 0; k < m; ++k) {
+                        ab += (r.col(k).array() <= r(j, k)).cast<int64_t>().matrix();
+                        ba += (r.col(k).array() >= r(j, k)).cast<int64_t>().matrix();
+                    }
+                    d.col(j) = (ab.array() == m && ba.array() == m).select(0, ab);
+                }
+            });
         }
-        Mat d = ComputeDegreeMatrix(pop, idx);
         auto count = 0L; // number of assigned solutions
         std::vector<std::vector<size_t>> fronts;
         std::vector<size_t> tmp(n);
         std::iota(tmp.begin(), tmp.end(), 0UL);
 
         std::vector<size_t> remaining;
+        std::vector<uint8_t> nondominated(n);
         while (count < n) {
-            std::vector<size_t> front;
-            for (auto i : tmp) {
-                if (std::all_of(tmp.begin(), tmp.end(), [&](auto j) { return d(j, i) < m; })) {
-                    front.push_back(i);
-                } else {
-                    remaining.push_back(i);
+            ForEachChunk(tmp.size(), [&](auto begin, auto end) {
+                for (auto k = begin; k < end; ++k) {
+                    auto const i = tmp[k];
+                    nondominated[k] = static_cast<uint8_t>(std::all_of(tmp.begin(), tmp.end(), [&](auto j) { return d(j, i) < m; }));
                 }
+            });
+            std::vector<size_t> front;
+            for (auto k = 0UL; k < tmp.size(); ++k) {
+                (nondominated[k] != 0 ? front : remaining).push_back(tmp[k]);
             }
             tmp.swap(remaining);
             remaining.clear();
@@ -2,6 +2,7 @@
 // SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
 
 #include "operon/operators/non_dominated_sorter.hpp"
+#include "operon/core/comparison.hpp"
 #include "operon/core/individual.hpp"
 
 #include <ranges>
@@ -13,15 +14,22 @@ namespace Operon {
     inline auto EfficientSortImpl(Operon::Span<Operon::Individual const> pop, Operon::Scalar /*unused*/) -> NondominatedSorterBase::Result
     {
         auto const m = static_cast<int>(std::ssize(pop[0].Fitness));
+        constexpr auto kernel{static_cast<int>(detail::DominanceKernelSize)};
 
         // check if individual i is dominated by any individual in the front f
         auto dominated = [&](auto const& f, size_t i) {
             return std::ranges::any_of(std::views::reverse(f), [&](size_t j) {
                 auto const& a = pop[j].Fitness;
                 auto const& b = pop[i].Fitness;
-                return m == 2
-                    ? std::ranges::all_of(std::ranges::iota_view{0, m}, [&](auto k) { return a[k] <= b[k]; })
-                    : eve::algo::all_of(eve::views::zip(a, b), [](auto t) { auto [x, y] = t; return x <= y; });
+                // a weakly dominates b (the short-circuit is faster for two objectives, see detail::Dominance otherwise)
+                if (m == 2) {
+                    return std::ranges::all_of(std::ranges::iota_view{0, m}, [&](auto k) { return a[k] <= b[k]; });
+                }
+                if (m <= kernel) {
+                    auto const d = Operon::ParetoDominance{}(a, b);
+                    return d == Dominance::Left || d == Dominance::Equal;
+                }
+                return eve::algo::all_of(eve::views::zip(a, b), [](auto t) { auto [x, y] = t; return x <= y; });
             });
         };
 
@@ -8,6 +8,7 @@
 #include <eve/module/algo.hpp>
 
 #include "operon/operators/non_dominated_sorter.hpp"
+#include "operon/core/comparison.hpp"
 #include "operon/core/individual.hpp"
 
 namespace Operon {
@@ -15,6 +16,7 @@ namespace Operon {
     HierarchicalSorter::Sort(Operon::Span<Operon::Individual const> pop, Operon::Scalar /*unused*/) const -> NondominatedSorterBase::Result
     {
         auto const m = static_cast<int>(std::ssize(pop[0].Fitness));
+        constexpr auto kernel{static_cast<int>(detail::DominanceKernelSize)};
 
         std::deque<size_t> q(pop.size());
         std::iota(q.begin(), q.end(), 0UL);
@@ -24,9 +26,15 @@ namespace Operon {
         std::vector<std::vector<size_t>> fronts;
 
         auto dominates = [&](auto const& a, auto const& b) {
-            return m == 2
-                ? std::ranges::all_of(std::ranges::iota_view{0, m}, [&](auto k) { return a[k] <= b[k]; })
-                : eve::algo::all_of(eve::views::zip(a, b), [](auto t) { auto [x, y] = t; return x <= y; });
+            // a weakly dominates b (the short-circuit is faster for two objectives, see detail::Dominance otherwise)
+            if (m == 2) {
+                return std::ranges::all_of(std::ranges::iota_view{0, m}, [&](auto k) { return a[k] <= b[k]; });
+            }
+            if (m <= kernel) {
+                auto const d = Operon::ParetoDominance{}(a, b);
+                return d == Dominance::Left || d == Dominance::Equal;
+            }
+            return eve::algo::all_of(eve::views::zip(a, b), [](auto t) { auto [x, y] = t; return x <= y; });
         };
 
         cppsort::merge_sorter sorter;
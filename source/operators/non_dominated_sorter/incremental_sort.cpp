@@ -0,0 +1,60 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include "operon/operators/non_dominated_sorter.hpp"
+#include "operon/core/comparison.hpp"
+#include "operon/core/individual.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <ranges>
+
+namespace Operon {
+
+    auto IncrementalSorter::Insert(Operon::Span<Operon::Individual const> pop, NondominatedSorterBase::Result& fronts, Operon::Span<size_t const> indices, Operon::Scalar eps) const -> void
+    {
+        Operon::ParetoDominance dom;
+        auto dominates = [&](size_t i, size_t j) { return dom(pop[i].Fitness, pop[j].Fitness, eps) == Dominance::Left; };
+
+        // check if individual i is dominated by any individual in the front f
+        auto dominated = [&](auto const& f, size_t i) {
+            return std::ranges::any_of(std::views::reverse(f), [&](size_t j) { return dominates(j, i); });
+        };
+
+        std::vector<size_t> moving;
+        std::vector<size_t> demoted;
+        for (auto i : indices) {
+            // an individual dominated by some front is also dominated by all the fronts before it
+            auto const it = std::partition_point(fronts.begin(), fronts.end(), [&](auto const& f) { return dominated(f, i); });
+            auto k = static_cast<size_t>(std::distance(fronts.begin(), it));
+
+            moving.assign(1, i);
+            for (; !moving.empty(); ++k) {
+                if (k == fronts.size()) {
+                    fronts.push_back(moving);
+                    break;
+                }
+                // the members of front k dominated by the incoming individuals move to front k + 1
+                auto& front = fronts[k];
+                demoted.clear();
+                std::erase_if(front, [&](size_t j) {
+                    auto const d = std::ranges::any_of(moving, [&](size_t m) { return dominates(m, j); });
+                    if (d) { demoted.push_back(j); }
+                    return d;
+                });
+                front.insert(front.end(), moving.begin(), moving.end());
+                std::swap(moving, demoted);
+            }
+        }
+    }
+
+    auto IncrementalSorter::Sort(Operon::Span<Operon::Individual const> pop, Operon::Scalar eps) const -> NondominatedSorterBase::Result
+    {
+        // for a lexicographically sorted population an individual never dominates the ones before it, so nothing cascades
+        std::vector<size_t> indices(pop.size());
+        std::iota(indices.begin(), indices.end(), size_t{0});
+        NondominatedSorterBase::Result fronts;
+        Insert(pop, fronts, indices, eps);
+        return fronts;
+    }
+} // namespace Operon
@@ -4,6 +4,7 @@
 #include <cpp-sort/sorters/merge_sorter.h>
 #include <cstdint>
 #include <algorithm>
+#include <atomic>
 #include <iterator>
 #include <optional>
 #include <type_traits>
@@ -17,6 +18,7 @@
 #include <utility>
 #include <vector>
 
+#include "operon/core/fitness_matrix.hpp"
 #include "operon/core/individual.hpp"
 #include "operon/core/types.hpp"
 #include "operon/operators/non_dominated_sorter.hpp"
@@ -99,11 +101,15 @@ auto RankIntersectSorter::Sort(Operon::Span<Operon::Individual const> pop, Opero
     using Bitset = std::unique_ptr<uint64_t[]>; // NOLINT
     std::vector<std::tuple<Bitset, int, int>> bitsets(n);
 
+    // the objective values are read column by column
+    FitnessMatrix const fitness(pop);
+
     // we first sort by the second objective
     cppsort::merge_sorter sorter;
     std::vector<detail::Item> items(n);
+    auto const second = fitness.Objective(1);
     for (auto i = 0; i < n; ++i) {
-        items[i] = { i, pop[i][1] };
+        items[i] = { i, second[i] };
     }
     sorter(items);
 
@@ -144,42 +150,53 @@ auto RankIntersectSorter::Sort(Operon::Span<Operon::Individual const> pop, Opero
     std::vector<int> rank(n, 0);
 
     for (auto obj = 2; obj < m; ++obj) {
-        for (auto& [i, v] : items) { v = pop[i][obj]; }
+        auto const values = fitness.Objective(obj);
+        for (auto& [i, v] : items) { v = values[i]; }
         sorter(items);
 
-        std::fill_n(mask.get(), nb, ONES); // reset q bitset to all ones
-        mask[nb-1] >>= ub; // zero unused region
-
-        auto done = 0;
         auto first = items.front().Index;
         auto last = items.back().Index;
-
         std::get<1>(bitsets[last]) = std::get<2>(bitsets[last])+1;
-        mask[first / DIGITS] &= ~(1UL << static_cast<uint>(first % DIGITS));
-
-        auto mmin = static_cast<int>(first / DIGITS);
-        auto mmax = static_cast<int>(first / DIGITS);
-
-        // [items.begin()+1, items.end()-1] must be a valid range
-        for (auto [i, _] : std::span{items.begin()+1, items.end()-1}) {
-            auto [q, r] = std::div(i, DIGITS);
-            mask[q] &= ~(1UL << static_cast<uint>(r)); // reset bit i
-            mmin = std::min(q, mmin);
-            mmax = std::max(q, mmax);
-
-            auto& [bits, lo, hi] = bitsets[i];
-            if (lo > hi) { ++done; continue; }
-
-            auto a = std::max(mmin, lo + q);
-            auto b = std::min(mmax, hi + q);
-            if (b < a) { continue; }
-
-            std::span<uint64_t> pb(bits.get() + a-q, b-a+1);
-            std::span<uint64_t const> pm(mask.get() + a, b-a+1);
-            std::ranges::transform(pb, pm, std::begin(pb), std::bit_and{});
-            while (lo <= hi && (bits[lo] == ZEROS)) { ++lo; }
-            while (lo <= hi && (bits[hi] == ZEROS)) { --hi; }
-        }
+
+        // the items in [items.begin()+1, items.end()-1] are split into chunks, each chunk starts
+        // from the mask of the items before it (the bitsets of different items are independent)
+        std::atomic_int done{0};
+        ForEachChunk(static_cast<std::size_t>(std::max(n-2, 0)), [&](std::size_t begin, std::size_t end) {
+            auto qmask = detail::MakeUnique<uint64_t[]>(nb, ONES); // NOLINT
+            qmask[nb-1] >>= ub; // zero unused region
+            qmask[first / DIGITS] &= ~(1UL << static_cast<uint>(first % DIGITS));
+
+            auto mmin = static_cast<int>(first / DIGITS);
+            auto mmax = static_cast<int>(first / DIGITS);
+            for (auto [i, _] : std::span{items.begin()+1, items.begin()+1+static_cast<std::ptrdiff_t>(begin)}) {
+                auto [q, r] = std::div(i, DIGITS);
+                qmask[q] &= ~(1UL << static_cast<uint>(r));
+                mmin = std::min(q, mmin);
+                mmax = std::max(q, mmax);
+            }
+
+            auto chunkDone = 0;
+            for (auto [i, _] : std::span{items.begin()+1+static_cast<std::ptrdiff_t>(begin), items.begin()+1+static_cast<std::ptrdiff_t>(end)}) {
+                auto [q, r] = std::div(i, DIGITS);
+                qmask[q] &= ~(1UL << static_cast<uint>(r)); // reset bit i
+                mmin = std::min(q, mmin);
+                mmax = std::max(q, mmax);
+
+                auto& [bits, lo, hi] = bitsets[i];
+                if (lo > hi) { ++chunkDone; continue; }
+
+                auto a = std::max(mmin, lo + q);
+                auto b = std::min(mmax, hi + q);
+                if (b < a) { continue; }
+
+                std::span<uint64_t> pb(bits.get() + a-q, b-a+1);
+                std::span<uint64_t const> pm(qmask.get() + a, b-a+1);
+                std::ranges::transform(pb, pm, std::begin(pb), std::bit_and{});
+                while (lo <= hi && (bits[lo] == ZEROS)) { ++lo; }
+                while (lo <= hi && (bits[hi] == ZEROS)) { --hi; }
+            }
+            done += chunkDone;
+        });
         if (done == n) { break; }
     }
 
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: MIT
 // SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
 
+#include "operon/core/fitness_matrix.hpp"
 #include "operon/core/individual.hpp"
 #include "operon/operators/non_dominated_sorter.hpp"
 #include <cpp-sort/sorters/merge_sorter.h>
@@ -29,10 +30,10 @@ auto RankOrdinalSorter::Sort(Operon::Span<Operon::Individual const> pop, Operon:
     p.col(0) = Vec::LinSpaced(n, 0, n - 1);
     r(0, p.col(0)) = Vec::LinSpaced(n, 0, n - 1);
 
-    std::vector<Operon::Scalar> buf(n); // buffer to store fitness values to avoid pointer indirections during sorting
+    FitnessMatrix const fitness(pop); // contiguous fitness values to avoid pointer indirections during sorting
     cppsort::merge_sorter sorter;
     for (auto i = 1; i < m; ++i) {
-        std::transform(pop.begin(), pop.end(), buf.begin(), [i](auto const& ind) { return ind[i]; });
+        auto const buf = fitness.Objective(i);
         p.col(i) = p.col(i - 1); // this is a critical part of the approach
         sorter(p.col(i), [&](auto j) { return buf[j]; });
         r(i, p.col(i)) = Vec::LinSpaced(n, 0, n - 1);
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include "operon/operators/non_dominated_sorter.hpp"
+#include "operon/core/contracts.hpp"
+#include "operon/core/individual.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <numeric>
+#include <vector>
+
+namespace Operon {
+
+namespace {
+    // the positions of the individuals in lexicographical order (NSGA2 passes a sorted population)
+    // - an individual can only be dominated by the ones before it
+    // - equal individuals are adjacent, they do not dominate each other and share a front
+    auto LexicographicalOrder(Operon::Span<Operon::Individual const> pop) -> std::vector<size_t>
+    {
+        std::vector<size_t> idx(pop.size());
+        std::iota(idx.begin(), idx.end(), size_t{0});
+        auto less = [&](auto a, auto b) { return std::ranges::lexicographical_compare(pop[a].Fitness, pop[b].Fitness); };
+        if (!std::ranges::is_sorted(idx, less)) { std::ranges::stable_sort(idx, less); }
+        return idx;
+    }
+
+    // the sweep relies on the exact order of the objectives, with eps > 0 the population is sorted by dominance degree
+    auto EpsilonSort(Operon::Span<Operon::Individual const> pop, Operon::Scalar eps, NondominatedSorterBase const& parent) -> NondominatedSorterBase::Result
+    {
+        DominanceDegreeSorter sorter;
+        sorter.SetExecutor(parent.Executor(), parent.Workers());
+        return sorter(pop, eps);
+    }
+} // namespace
+
+auto BiObjectiveSorter::Sort(Operon::Span<Operon::Individual const> pop, Operon::Scalar eps) const -> NondominatedSorterBase::Result
+{
+    if (pop.empty()) { return {}; }
+    EXPECT(pop.front().Size() == 2);
+    if (eps > 0) { return EpsilonSort(pop, eps, *this); }
+
+    // the individuals before i have a smaller or equal first objective, so front f dominates i if its smallest second
+    // objective is smaller or equal (these values increase with the rank and are found with a binary search)
+    auto const idx = LexicographicalOrder(pop);
+    NondominatedSorterBase::Result fronts;
+    std::vector<Operon::Scalar> last;
+    auto r{0UL};
+    for (auto k = 0UL; k < idx.size(); ++k) {
+        auto const i = idx[k];
+        auto const y = pop[i][1];
+        if (k == 0 || pop[i].Fitness != pop[idx[k - 1]].Fitness) {
+            r = static_cast<size_t>(std::distance(last.begin(), std::ranges::upper_bound(last, y)));
+        }
+        if (r == fronts.size()) {
+            fronts.emplace_back();
+            last.push_back(y);
+        }
+        last[r] = y;
+        fronts[r].push_back(i);
+    }
+    return fronts;
+}
+
+auto TriObjectiveSorter::Sort(Operon::Span<Operon::Individual const> pop, Operon::Scalar eps) const -> NondominatedSorterBase::Result
+{
+    if (pop.empty()) { return {}; }
+    EXPECT(pop.front().Size() == 3);
+    if (eps > 0) { return EpsilonSort(pop, eps, *this); }
+
+    // each front keeps the staircase of its members in the last two objectives: a map from the second objective to the
+    // smallest third objective, which decreases with the key
+    // - front f dominates i if the entry with the largest key not above the second objective of i has a smaller or
+    //   equal third objective
+    // - an individual dominated by front f is also dominated by the fronts before it, so the fronts are searched with
+    //   a binary search
+    using Stair = std::map<Operon::Scalar, Operon::Scalar>;
+    auto dominated = [](Stair const& stair, Operon::Scalar y, Operon::Scalar z) {
+        auto it = stair.upper_bound(y);
+        return it != stair.begin() && std::prev(it)->second <= z;
+    };
+
+    auto const idx = LexicographicalOrder(pop);
+    NondominatedSorterBase::Result fronts;
+    std::vector<Stair> stairs;
+    auto r{0UL};
+    for (auto k = 0UL; k < idx.size(); ++k) {
+        auto const i = idx[k];
+        auto const y = pop[i][1];
+        auto const z = pop[i][2];
+        if (k > 0 && pop[i].Fitness == pop[idx[k - 1]].Fitness) {
+            fronts[r].push_back(i);
+            continue;
+        }
+        auto it = std::partition_point(stairs.begin(), stairs.end(), [&](auto const& s) { return dominated(s, y, z); });
+        r = static_cast<size_t>(std::distance(stairs.begin(), it));
+        if (r == fronts.size()) {
+            fronts.emplace_back();
+            stairs.emplace_back();
+        }
+        // the entries with a larger second objective and a larger third objective are dominated by i
+        auto& stair = stairs[r];
+        auto s = stair.lower_bound(y);
+        while (s != stair.end() && s->second >= z) { s = stair.erase(s); }
+        stair.emplace_hint(s, y, z);
+        fronts[r].push_back(i);
+    }
+    return fronts;
+}
+
+} // namespace Operon
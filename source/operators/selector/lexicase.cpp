@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <vector>
+
+#include "operon/operators/selector.hpp"
+#include "operon/core/contracts.hpp"
+#include "operon/core/individual.hpp"
+#include "operon/core/types.hpp"
+#include "operon/random/random.hpp"
+
+namespace Operon {
+
+namespace {
+    // median of the values (which are reordered)
+    auto Median(std::span<Operon::Scalar> values) -> Operon::Scalar
+    {
+        EXPECT(!values.empty());
+        auto const mid = values.begin() + static_cast<std::ptrdiff_t>(values.size() / 2);
+        std::nth_element(values.begin(), mid, values.end());
+        auto m = *mid;
+        if (values.size() % 2 == 0) {
+            m = (m + *std::max_element(values.begin(), mid)) / 2;
+        }
+        return m;
+    }
+} // namespace
+
+auto LexicaseSelector::SampleCases(Operon::RandomGenerator& random, size_t rows, size_t n) -> std::vector<size_t>
+{
+    std::vector<size_t> all(rows);
+    std::iota(all.begin(), all.end(), 0UL);
+    std::vector<size_t> cases;
+    cases.reserve(std::min(n, rows));
+    std::sample(all.begin(), all.end(), std::back_inserter(cases), n, random); // keeps the order
+    return cases;
+}
+
+void LexicaseSelector::Prepare(Operon::Span<Individual const> pop) const
+{
+    SelectorBase::Prepare(pop);
+    EXPECT(!pop.empty());
+    auto const n = pop.size();
+
+    auto const captured = std::ranges::max(pop, {}, [](auto const& ind) { return ind.CaseErrors.size(); }).CaseErrors.size();
+    cases_ = caseCount_ > 0 ? std::min(caseCount_, captured) : captured;
+    errors_.resize(n * cases_);
+    epsilon_.resize(cases_);
+    if (cases_ == 0) { return; }
+
+    // the cases of this generation, a partial Fisher-Yates shuffle of the captured ones
+    std::vector<size_t> cases(captured);
+    std::iota(cases.begin(), cases.end(), 0UL);
+    for (auto i = 0UL; i < cases_; ++i) {
+        std::swap(cases[i], cases[i + Random::Bounded(random_, captured - i)]);
+    }
+
+    std::vector<Operon::Scalar> deviations(n);
+    for (auto c = 0UL; c < cases_; ++c) {
+        auto column = std::span{errors_}.subspan(c * n, n);
+        for (auto i = 0UL; i < n; ++i) {
+            auto const& e = pop[i].CaseErrors;
+            column[i] = e.size() == captured ? e[cases[c]] : std::numeric_limits<Operon::Scalar>::max();
+        }
+
+        // the median absolute deviation over the individuals with errors
+        auto const valid = std::ranges::copy_if(column, deviations.begin(), [](auto e) { return e < std::numeric_limits<Operon::Scalar>::max(); }).out;
+        auto const k = static_cast<size_t>(std::distance(deviations.begin(), valid));
+        if (k == 0) { epsilon_[c] = 0; continue; }
+        auto const values = std::span{deviations}.first(k);
+        auto const median = Median(values);
+        std::ranges::transform(values, values.begin(), [median](auto e) { return std::abs(e - median); });
+        epsilon_[c] = Median(values);
+    }
+}
+
+auto LexicaseSelector::operator()(Operon::RandomGenerator& random) const -> size_t
+{
+    auto const n = Population().size();
+    EXPECT(n > 0);
+    if (cases_ == 0) { return Random::Bounded(random, n); }
+
+    thread_local std::vector<size_t> candidates;
+    thread_local std::vector<size_t> order;
+    candidates.resize(n);
+    std::iota(candidates.begin(), candidates.end(), 0UL);
+    order.resize(cases_);
+    std::iota(order.begin(), order.end(), 0UL);
+
+    auto remaining = n;
+    for (auto i = 0UL; i < cases_ && remaining > 1; ++i) {
+        // the next case in a random order (the shuffle stops with the selection)
+        std::swap(order[i], order[i + Random::Bounded(random, cases_ - i)]);
+        auto const c = order[i];
+        auto const* column = errors_.data() + (c * n);
+
+        auto best = std::numeric_limits<Operon::Scalar>::max();
+        for (auto j = 0UL; j < remaining; ++j) {
+            best = std::min(best, column[candidates[j]]);
+        }
+        auto const threshold = best + epsilon_[c];
+
+        // the candidates within the threshold are moved to the front, without a branch
+        auto kept = 0UL;
+        for (auto j = 0UL; j < remaining; ++j) {
+            auto const k = candidates[j];
+            candidates[kept] = k;
+            kept += static_cast<size_t>(column[k] <= threshold);
+        }
+        remaining = kept;
+    }
+    return candidates[Random::Bounded(random, remaining)];
+}
+} // namespace Operon
@@ -2,13 +2,12 @@
 // SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
 
 #include <cstddef>
+#include <iterator>
 #include <numeric>
 #include <algorithm>
-#include <functional>
-#include <limits>
 #include <random>
+#include <ranges>
 #include <span>
-#include <utility>
 #include <vector>
 
 #include "operon/operators/selector.hpp"
@@ -19,8 +18,13 @@ namespace Operon {
 
 auto ProportionalSelector::operator()(Operon::RandomGenerator& random) const -> size_t
 {
-    std::uniform_real_distribution<Operon::Scalar> uniformReal(0, fitness_.back().first - std::numeric_limits<Operon::Scalar>::epsilon());
-    return std::lower_bound(fitness_.begin(), fitness_.end(), std::make_pair(uniformReal(random), size_t{0}), std::less {})->second;
+    auto const total = cdf_.back();
+    // all the individuals have the same fitness
+    if (!(total > 0)) { return std::uniform_int_distribution<size_t>(0, cdf_.size() - 1)(random); }
+    auto const u = std::uniform_real_distribution<Operon::Scalar>(0, total)(random);
+    auto const it = std::ranges::upper_bound(cdf_, u);
+    // the generated value can be rounded up to the total
+    return std::min(static_cast<size_t>(std::distance(cdf_.begin(), it)), cdf_.size() - 1);
 }
 
 void ProportionalSelector::Prepare(const Operon::Span<const Individual> pop) const
@@ -31,24 +35,12 @@ void ProportionalSelector::Prepare(const Operon::Span<const Individual> pop) con
 
 void ProportionalSelector::Prepare() const
 {
-    fitness_.clear();
-    fitness_.reserve(Population().size());
-
-    const size_t populationSize = Population().size();
     auto population = Population();
+    cdf_.resize(population.size());
 
-    Operon::Scalar vmin = Population().front()[idx_];
-    Operon::Scalar vmax = vmin;
-
-    for (size_t i = 0; i < populationSize; ++i) {
-        auto f = population[i][idx_];
-        fitness_.emplace_back( f, i );
-        vmin = std::min(vmin, f);
-        vmax = std::max(vmax, f);
-    }
-    auto prepare = [=](auto p) { return std::make_pair(vmax - p.first, p.second); };
-    std::transform(fitness_.begin(), fitness_.end(), fitness_.begin(), prepare);
-    std::sort(fitness_.begin(), fitness_.end());
-    std::inclusive_scan(fitness_.begin(), fitness_.end(), fitness_.begin(), [](auto lhs, auto rhs) { return std::make_pair(lhs.first + rhs.first, rhs.second); });
+    auto const value = [&](auto const& ind) { return ind[idx_]; };
+    auto const vmax = std::ranges::max(population | std::views::transform(value));
+    std::ranges::transform(population, cdf_.begin(), [&](auto const& ind) { return vmax - value(ind); });
+    std::inclusive_scan(cdf_.begin(), cdf_.end(), cdf_.begin());
 }
 }  // namespace Operon
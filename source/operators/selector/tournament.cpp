@@ -4,46 +4,128 @@
 #include <cstddef>
 #include <numeric>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <random>
 #include <span>
 #include <vector>
 
 #include "operon/operators/selector.hpp"
+#include "operon/core/contracts.hpp"
+#include "operon/core/fitness_matrix.hpp"
 #include "operon/core/individual.hpp"
 #include "operon/core/types.hpp"
+#include "operon/random/random.hpp"
 
 namespace Operon {
 
 auto TournamentSelector::operator()(Operon::RandomGenerator& random) const -> size_t
 {
     auto population = Population();
-    std::uniform_int_distribution<size_t> uniformInt(0, population.size() - 1);
+    auto uniformInt = [n = population.size()](auto& rng) { return Random::Bounded(rng, n); };
     auto best = uniformInt(random);
     auto tournamentSize = GetTournamentSize();
 
     for (size_t i = 1; i < tournamentSize; ++i) {
         auto curr = uniformInt(random);
-        if (this->Compare(population[curr], population[best])) {
+        if (this->Compare(curr, best)) {
             best = curr;
         }
     }
     return best;
 }
 
+void BatchTournamentSelector::Prepare(Operon::Span<Individual const> pop) const
+{
+    SelectorBase::Prepare(pop);
+    EXPECT(!pop.empty());
+    winners_.resize(batchSize_ > 0 ? batchSize_ : 2 * pop.size());
+    Play();
+    cursor_.store(0, std::memory_order_relaxed);
+}
+
+auto BatchTournamentSelector::operator()(Operon::RandomGenerator& /*random*/) const -> size_t
+{
+    EXPECT(!winners_.empty());
+    auto const size = winners_.size();
+    for (;;) {
+        if (auto const i = cursor_.fetch_add(1, std::memory_order_relaxed); i < size) {
+            return std::atomic_ref(winners_[i]).load(std::memory_order_relaxed);
+        }
+        // the batch is used up, the first caller to get the lock plays the next one and the others take from it
+        std::scoped_lock lock(mutex_);
+        if (cursor_.load(std::memory_order_relaxed) >= size) {
+            Play();
+            cursor_.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void BatchTournamentSelector::Play() const
+{
+    auto const n = Population().size();
+    auto const tournamentSize = std::max(GetTournamentSize(), size_t{1});
+    auto uniformInt = [n](auto& rng) { return Random::Bounded(rng, n); };
+    // the winners are stored atomically: a caller that claimed a winner of the previous batch may still be reading it
+    auto store = [&](size_t i, size_t winner) { std::atomic_ref(winners_[i]).store(winner, std::memory_order_relaxed); };
+
+    if (Order().GetOrder() != FitnessComparison::Order::SingleObjective) {
+        for (auto w = 0UL; w < winners_.size(); ++w) {
+            auto best = uniformInt(random_);
+            for (size_t i = 1; i < tournamentSize; ++i) {
+                auto curr = uniformInt(random_);
+                if (Compare(curr, best)) { best = curr; }
+            }
+            store(w, best);
+        }
+        return;
+    }
+
+    // the tournaments of a block are played together, one round (contestant) at a time
+    // - the contestants of a round are drawn in bulk (see RomuTrioX)
+    constexpr auto block { 64UL };
+    auto const values = Fitness().Objective(Order().GetObjectiveIndex());
+    std::array<uint64_t, block> best{};
+    std::array<Operon::Scalar, block> bestValue{};
+    std::array<uint64_t, block> curr{};
+
+    for (auto b = 0UL; b < winners_.size(); b += block) {
+        auto const k = std::min(block, winners_.size() - b);
+        auto const contestants = std::span(curr).first(k);
+        random_.Fill(std::span(best).first(k), n);
+        for (auto j = 0UL; j < k; ++j) { bestValue[j] = values[best[j]]; }
+        for (size_t i = 1; i < tournamentSize; ++i) {
+            random_.Fill(contestants, n);
+            for (auto j = 0UL; j < k; ++j) {
+                auto const v = values[curr[j]];
+                // a contestant only wins if it is strictly better, like in TournamentSelector
+                // - the outcome is unpredictable, so the winner is chosen with a mask instead of a branch
+                auto const mask = uint64_t{0} - static_cast<uint64_t>(v < bestValue[j]);
+                best[j] = (curr[j] & mask) | (best[j] & ~mask);
+                bestValue[j] = std::min(bestValue[j], v);
+            }
+        }
+        for (auto j = 0UL; j < k; ++j) { store(b + j, best[j]); }
+    }
+}
+
 auto RankTournamentSelector::operator()(Operon::RandomGenerator& random) const -> size_t
 {
     auto population = Population();
-    std::uniform_int_distribution<size_t> uniformInt(0, population.size() - 1);
+    auto uniformInt = [n = population.size()](auto& rng) { return Random::Bounded(rng, n); };
     auto best = uniformInt(random);
     auto tournamentSize = GetTournamentSize();
 
+    // the tournament is decided by the position in the sorted population (lower is better)
     for (size_t i = 1; i < tournamentSize; ++i) {
         auto curr = uniformInt(random);
-        if (best < curr) {
+        if (curr < best) {
             best = curr;
         }
     }
-    return best;
+    return indices_[best];
 }
 
 void RankTournamentSelector::Prepare(const Operon::Span<const Individual> pop) const
@@ -51,6 +133,17 @@ void RankTournamentSelector::Prepare(const Operon::Span<const Individual> pop) c
     SelectorBase::Prepare(pop);
     indices_.resize(pop.size());
     std::iota(indices_.begin(), indices_.end(), 0);
-    std::sort(indices_.begin(), indices_.end(), [&](auto i, auto j) { return Compare(pop[i], pop[j]); });
+
+    // after a KeepBestReinserter (or the sorting of NSGA2) the population is usually sorted already,
+    // the check is linear and the stable sort of a sorted range is the identity
+    if (Order().GetOrder() == FitnessComparison::Order::SingleObjective) {
+        auto const values = Fitness().Objective(Order().GetObjectiveIndex());
+        if (std::ranges::is_sorted(values)) { return; }
+        std::ranges::stable_sort(indices_, [&](auto i, auto j) { return values[i] < values[j]; });
+        return;
+    }
+    auto const compare = [&](auto i, auto j) { return Compare(i, j); };
+    if (std::ranges::is_sorted(indices_, compare)) { return; }
+    std::ranges::stable_sort(indices_, compare);
 }
 } // namespace Operon
@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include "operon/operators/throughput.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+
+namespace Operon {
+
+namespace {
+    auto Rate(uint64_t now, uint64_t before, double seconds) -> double
+    {
+        return seconds > 0 && now > before ? static_cast<double>(now - before) / seconds : 0.0;
+    }
+
+    auto Metric(std::ostream& os, std::string_view name, std::string_view type, std::string_view help, auto value) -> void
+    {
+        // the samples of a counter are suffixed with _total
+        auto const suffix = type == "counter" ? "_total" : "";
+        fmt::print(os, "# TYPE operon_{0} {1}\n# HELP operon_{0} {2}\noperon_{0}{3} {4}\n", name, type, help, suffix, value);
+    }
+} // namespace
+
+ThroughputMonitor::ThroughputMonitor(EvaluatorBase const& evaluator)
+    : evaluator_(evaluator)
+{
+    Reset();
+}
+
+auto ThroughputMonitor::Read() const -> ThroughputSnapshot
+{
+    auto const& evaluator = evaluator_.get();
+    auto const stats = evaluator.Stats();
+    ThroughputSnapshot s;
+    s.ResidualEvaluations = stats.Residual;
+    s.JacobianEvaluations = stats.Jacobian;
+    s.CallCount = stats.Calls;
+    s.CacheHits = stats.CacheHits;
+    s.CacheMisses = stats.CacheMisses;
+    s.Budget = evaluator.Budget();
+    s.Rows = evaluator.GetProblem().TrainingRange().Size();
+    return s;
+}
+
+auto ThroughputMonitor::Reset() -> void
+{
+    start_ = time_ = Clock::now();
+    last_ = Read();
+}
+
+auto ThroughputMonitor::Sample(std::size_t generation) -> ThroughputSnapshot const&
+{
+    auto const now = Clock::now();
+    auto s = Read();
+    s.Generation = generation;
+    s.Elapsed = std::chrono::duration<double>(now - start_).count();
+    s.Interval = std::chrono::duration<double>(now - time_).count();
+
+    auto const rows = static_cast<double>(s.Rows);
+    s.EvaluationsPerSecond = Rate(s.Evaluations(), last_.Evaluations(), s.Interval);
+    s.RowsPerSecond = rows * Rate(s.ResidualEvaluations, last_.ResidualEvaluations, s.Interval);
+    s.JacobianRowsPerSecond = rows * Rate(s.JacobianEvaluations, last_.JacobianEvaluations, s.Interval);
+
+    auto const hits = s.CacheHits - std::min(s.CacheHits, last_.CacheHits);
+    auto const lookups = hits + s.CacheMisses - std::min(s.CacheMisses, last_.CacheMisses);
+    s.CacheHitRate = lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+
+    time_ = now;
+    last_ = s;
+    return last_;
+}
+
+auto WriteOpenMetrics(std::ostream& os, ThroughputSnapshot const& s) -> void
+{
+    Metric(os, "generation", "gauge", "Generation of the snapshot.", s.Generation);
+    Metric(os, "elapsed_seconds", "gauge", "Seconds since the start of the monitoring.", s.Elapsed);
+    Metric(os, "residual_evaluations", "counter", "Residual evaluations.", s.ResidualEvaluations);
+    Metric(os, "jacobian_evaluations", "counter", "Jacobian evaluations.", s.JacobianEvaluations);
+    Metric(os, "evaluator_calls", "counter", "Calls of the evaluator.", s.CallCount);
+    Metric(os, "cache_hits", "counter", "Fitness cache hits.", s.CacheHits);
+    Metric(os, "cache_misses", "counter", "Fitness cache misses.", s.CacheMisses);
+    Metric(os, "evaluation_budget", "gauge", "Evaluation budget of the run.", s.Budget);
+    Metric(os, "evaluation_budget_used_ratio", "gauge", "Fraction of the evaluation budget spent.", s.BudgetUsed());
+    Metric(os, "evaluations_per_second", "gauge", "Evaluations per second since the previous snapshot.", s.EvaluationsPerSecond);
+    Metric(os, "rows_per_second", "gauge", "Rows evaluated per second since the previous snapshot.", s.RowsPerSecond);
+    Metric(os, "jacobian_rows_per_second", "gauge", "Jacobian rows evaluated per second since the previous snapshot.", s.JacobianRowsPerSecond);
+    Metric(os, "cache_hit_ratio", "gauge", "Fraction of the cache lookups that hit since the previous snapshot.", s.CacheHitRate);
+    os << "# EOF\n";
+}
+
+auto WriteOpenMetrics(std::string const& path, ThroughputSnapshot const& snapshot) -> void
+{
+    auto const tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out) { throw std::runtime_error(fmt::format("cannot open {} for writing", tmp)); }
+        WriteOpenMetrics(out, snapshot);
+        out.flush();
+        if (!out) { throw std::runtime_error(fmt::format("cannot write {}", tmp)); }
+    }
+    std::filesystem::rename(tmp, path);
+}
+
+} // namespace Operon
@@ -10,6 +10,7 @@
 #include <pratt-parser/parser.hpp>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "operon/hash/hash.hpp"
@@ -84,7 +85,10 @@ namespace detail {
             auto const& lhs = left.value();
             auto& rhs = right.value();
 
-            rhs.reserve(lhs.size() + rhs.size() + 1);
+            // grow geometrically, an exact reserve reallocates at every step of a long chain (a + b + c + ...)
+            if (auto const size = lhs.size() + rhs.size() + 1; size > rhs.capacity()) {
+                rhs.reserve(std::max(size, 2 * rhs.capacity()));
+            }
             std::copy(lhs.begin(), lhs.end(), std::back_inserter(rhs));
 
             ENSURE(tok.kind() == TokenKind::dynamic);
@@ -99,8 +103,8 @@ namespace detail {
         }
     };
 
-    static auto DefaultTokens() {
-        return Operon::Map<std::string, Token, Operon::Hasher, std::equal_to<>>{
+    static auto MakeTokens() {
+        return TokenMap{
             // NOLINTBEGIN
             { "+", Token(TokenKind::dynamic, "add", static_cast<size_t>(NodeType::Add), 10, pratt::associativity::left) },
             { "-", Token(TokenKind::dynamic, "sub", static_cast<size_t>(NodeType::Sub), 10, pratt::associativity::left) },
@@ -134,20 +138,44 @@ namespace detail {
         };
     }
 
-    using Parser = pratt::parser<Nud, Led, Conv, TokenMap, VariableMap>;
+    template<typename Variables>
+    auto ParseTree(std::string const& infix, TokenMap const& tokens, Variables const& vars, bool reduce) -> Tree
+    {
+        Tree tree{pratt::parser<Nud, Led, Conv, TokenMap, Variables>(infix, tokens, vars).parse()};
+        tree.UpdateNodes();
+        if (reduce) { tree.Reduce(); }
+        return tree;
+    }
 } // namespace detail
 
+auto InfixParser::DefaultTokens() -> detail::TokenMap const&
+{
+    static detail::TokenMap const tokens = detail::MakeTokens();
+    return tokens;
+}
+
 auto InfixParser::Parse(std::string const& infix, detail::VariableMap const& vars, detail::TokenMap const& toks, bool reduce) -> Tree
 {
-    auto nodes = detail::Parser(infix, toks, vars).parse();
-    auto tree = Tree(nodes).UpdateNodes();
-    return reduce ? tree.Reduce() : tree;
+    return detail::ParseTree(infix, toks, vars, reduce);
 }
 
 auto InfixParser::Parse(std::string const& infix, detail::VariableMap const& vars, bool reduce) -> Tree
 {
-    auto tokens = detail::DefaultTokens();
-    return Parse(infix, vars, tokens, reduce);
+    return Parse(infix, vars, DefaultTokens(), reduce);
+}
+
+InfixParser::InfixParser(detail::VariableMap const& vars, detail::TokenMap tokens)
+    : tokens_(std::move(tokens))
+{
+    vars_.reserve(vars.size());
+    for (auto const& [name, hash] : vars) {
+        vars_.insert({ name, hash });
+    }
+}
+
+auto InfixParser::operator()(std::string const& infix, bool reduce) const -> Tree
+{
+    return detail::ParseTree(infix, tokens_, vars_, reduce);
 }
 
 } // namespace Operon
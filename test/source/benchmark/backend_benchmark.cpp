@@ -0,0 +1,230 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+// compares the math backends side by side (see BUILD_BACKEND_BENCHMARK in test/CMakeLists.txt)
+// - each backend is a module containing the default dispatch table compiled with that backend
+// - reports the time per row of each primitive (forward and derivative) and of random trees of increasing length
+// - the primitives of several backends can be mixed in one table, eg. fast=fast_v2:exp,tanh;vdt:log;eve:sin (the other
+//   primitives are those of the library)
+// - the accuracy of each table is written next to the timings (output.json.accuracy.csv): the largest and the mean
+//   relative error of each primitive and of the trees, with respect to stl (the library if it is not loaded)
+// - usage: operon_backend_benchmark [output.json] [rows] [mix...]
+
+#define ANKERL_NANOBENCH_IMPLEMENT
+#include "../thirdparty/nanobench.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <fmt/core.h>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "operon/core/dataset.hpp"
+#include "operon/core/pset.hpp"
+#include "operon/core/tree.hpp"
+#include "operon/interpreter/cpu_dispatch.hpp"
+#include "operon/interpreter/interpreter.hpp"
+#include "operon/operators/creator.hpp"
+
+namespace nb = ankerl::nanobench;
+
+namespace {
+    using TInterpreter = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+
+    // positive inputs, so that the domain of log, sqrt and pow is respected
+    auto MakeDataset(Operon::RandomGenerator& rng, std::size_t rows, std::size_t cols) -> Operon::Dataset {
+        std::uniform_real_distribution<Operon::Scalar> dist(Operon::Scalar{0.01}, Operon::Scalar{2});
+        Eigen::Matrix<Operon::Scalar, -1, -1> data(rows, cols);
+        for (auto& v : data.reshaped()) { v = dist(rng); }
+        return Operon::Dataset(data);
+    }
+
+    auto LoadBackends() -> std::vector<std::pair<std::string, Operon::DefaultDispatch>> {
+        std::vector<std::pair<std::string, Operon::DefaultDispatch>> backends;
+        backends.emplace_back("library", Operon::DefaultDispatch{});
+
+        std::istringstream names{OPERON_BENCHMARK_BACKENDS};
+        for (std::string name; std::getline(names, name, ',');) {
+            auto const path = fmt::format("{}/operon_backend_{}{}", OPERON_BENCHMARK_BACKEND_DIR, name, OPERON_BENCHMARK_MODULE_SUFFIX);
+            try {
+                backends.emplace_back(name, Operon::LoadDispatchTable(path));
+            } catch (std::exception const& e) {
+                fmt::print(stderr, "skipping backend {}: {}\n", name, e.what());
+            }
+        }
+        return backends;
+    }
+
+    auto ParseNodeType(std::string const& name) -> Operon::NodeType {
+        for (auto i = 0UL; i < Operon::NodeTypes::Count; ++i) {
+            auto const type = static_cast<Operon::NodeType>(1U << i);
+            if (Operon::Node{type}.Name() == name) { return type; }
+        }
+        throw std::invalid_argument(fmt::format("unknown primitive {}\n", name));
+    }
+
+    // name=backend:primitive,primitive;backend:primitive..., starting from the library table
+    auto MakeMix(std::string const& spec, std::vector<std::pair<std::string, Operon::DefaultDispatch>> const& backends) -> std::pair<std::string, Operon::DefaultDispatch> {
+        auto const eq = spec.find('=');
+        if (eq == std::string::npos) { throw std::invalid_argument(fmt::format("expected name=backend:primitives in {}\n", spec)); }
+        auto dtable = backends.front().second;
+        std::istringstream parts{spec.substr(eq + 1)};
+        for (std::string part; std::getline(parts, part, ';');) {
+            auto const colon = part.find(':');
+            auto const name = part.substr(0, colon);
+            auto it = std::ranges::find_if(backends, [&](auto const& b) { return b.first == name; });
+            if (colon == std::string::npos || it == backends.end()) { throw std::invalid_argument(fmt::format("backend {} is not loaded\n", name)); }
+            Operon::NodeType types{};
+            std::istringstream primitives{part.substr(colon + 1)};
+            for (std::string p; std::getline(primitives, p, ',');) { types |= ParseNodeType(p); }
+            dtable.CopyPrimitives(it->second, types);
+        }
+        return { spec.substr(0, eq), std::move(dtable) };
+    }
+
+    // largest and mean relative error of the values with respect to the reference
+    struct Accuracy {
+        double Max{0};
+        double Mean{0};
+    };
+
+    auto Compare(Operon::Span<Operon::Scalar const> values, Operon::Span<Operon::Scalar const> reference, Accuracy& acc, std::size_t& count) -> void {
+        for (auto i = 0UL; i < values.size(); ++i) {
+            auto const x = static_cast<double>(values[i]);
+            auto const r = static_cast<double>(reference[i]);
+            if (!std::isfinite(r)) { continue; }
+            auto const e = std::isfinite(x) ? std::abs(x - r) / std::max(1.0, std::abs(r)) : 1.0;
+            acc.Max = std::max(acc.Max, e);
+            acc.Mean += (e - acc.Mean) / static_cast<double>(++count);
+        }
+    }
+
+    // some backends do not implement every primitive (see the missing specialization error of Func and Diff)
+    template<typename F>
+    auto Run(nb::Bench& bench, std::string const& name, std::size_t batch, F&& f) -> void {
+        try {
+            f();
+            bench.batch(batch).run(name, std::forward<F>(f));
+        } catch (std::exception const& e) {
+            fmt::print(stderr, "skipping {}: {}\n", name, e.what());
+        }
+    }
+} // namespace
+
+auto main(int argc, char** argv) -> int
+{
+    std::string const output{ argc > 1 ? argv[1] : "backend_benchmark.json" }; // NOLINT
+    auto const rows{ argc > 2 ? std::stoul(argv[2]) : 10'000UL }; // NOLINT
+    constexpr auto cols{10UL};
+    constexpr auto treeCount{100UL};
+
+    Operon::RandomGenerator rng{1234};
+    auto const ds = MakeDataset(rng, rows, cols);
+    auto const inputs = ds.VariableHashes();
+    Operon::Range const range{0, rows};
+
+    // the same trees are used for all the backends
+    Operon::PrimitiveSet pset{ Operon::PrimitiveSet::Arithmetic | Operon::NodeType::Exp | Operon::NodeType::Log | Operon::NodeType::Sin
+                             | Operon::NodeType::Cos | Operon::NodeType::Sqrt | Operon::NodeType::Tanh };
+    Operon::BalancedTreeCreator creator{pset, inputs};
+    std::vector<std::pair<std::size_t, std::vector<Operon::Tree>>> shapes;
+    for (auto length : { 10UL, 25UL, 50UL }) {
+        std::vector<Operon::Tree> trees(treeCount);
+        std::ranges::generate(trees, [&]() { return creator(rng, length, 1, 1000); }); // NOLINT
+        shapes.emplace_back(length, std::move(trees));
+    }
+
+    auto backends = LoadBackends();
+    for (auto i = 3; i < argc; ++i) {
+        try {
+            backends.push_back(MakeMix(argv[i], backends)); // NOLINT
+        } catch (std::exception const& e) {
+            fmt::print(stderr, "skipping mix {}: {}\n", argv[i], e.what()); // NOLINT
+        }
+    }
+    auto ref = std::ranges::find_if(backends, [](auto const& b) { return b.first == "stl"; });
+    auto const& reference = ref == backends.end() ? backends.front().second : ref->second;
+
+    nb::Bench bench;
+    bench.title("math backends").unit("row").warmup(3).relative(false);
+
+    std::ofstream accuracy{output + ".accuracy.csv"};
+    accuracy << "backend,benchmark,max_rel_error,mean_rel_error\n";
+    // the error of the forward pass and of the derivative, nothing is written if the primitive is missing
+    auto measure = [&](std::string const& name, std::string const& what, Operon::DefaultDispatch const& dtable, auto const& trees) {
+        Accuracy fwd;
+        Accuracy jac;
+        std::size_t nf{0};
+        std::size_t nj{0};
+        try {
+            for (auto const& tree : trees) {
+                auto const coeff = tree.GetCoefficients();
+                TInterpreter const a{dtable, ds, tree};
+                TInterpreter const b{reference, ds, tree};
+                Compare(a.Evaluate(coeff, range), b.Evaluate(coeff, range), fwd, nf);
+                auto const ja = a.JacRev(coeff, range);
+                auto const jb = b.JacRev(coeff, range);
+                Compare({ja.data(), static_cast<std::size_t>(ja.size())}, {jb.data(), static_cast<std::size_t>(jb.size())}, jac, nj);
+            }
+        } catch (std::exception const& /*unused*/) {
+            return;
+        }
+        accuracy << fmt::format("{},{};forward,{},{}\n{},{};derivative,{},{}\n", name, what, fwd.Max, fwd.Mean, name, what, jac.Max, jac.Mean);
+    };
+
+    std::vector<Operon::Scalar> out(rows);
+    for (auto const& [backend, dtable] : backends) {
+        for (auto i = 0UL; i < Operon::NodeTypes::Count - 3; ++i) {
+            Operon::Node const f{static_cast<Operon::NodeType>(1U << i)};
+            Operon::Vector<Operon::Node> nodes;
+            for (auto j = 0UL; j < f.Arity; ++j) { nodes.emplace_back(Operon::NodeType::Variable, inputs[j]); }
+            nodes.push_back(f);
+            Operon::Tree tree{nodes};
+            tree.UpdateNodes();
+
+            auto const coeff = tree.GetCoefficients();
+            std::vector<Operon::Scalar> jac(rows * coeff.size());
+            TInterpreter const interpreter{dtable, ds, tree};
+
+            Run(bench, fmt::format("{};{};forward", backend, f.Name()), rows, [&]() {
+                interpreter.Evaluate(coeff, range, out);
+                nb::doNotOptimizeAway(out.front());
+            });
+            Run(bench, fmt::format("{};{};derivative", backend, f.Name()), rows, [&]() {
+                interpreter.JacRev(coeff, range, jac);
+                nb::doNotOptimizeAway(jac.front());
+            });
+            measure(backend, f.Name(), dtable, std::array{tree});
+        }
+
+        for (auto const& [length, trees] : shapes) {
+            Run(bench, fmt::format("{};trees-{};forward", backend, length), rows * trees.size(), [&]() {
+                for (auto const& tree : trees) {
+                    TInterpreter{dtable, ds, tree}.Evaluate(tree.GetCoefficients(), range, out);
+                }
+                nb::doNotOptimizeAway(out.front());
+            });
+            Run(bench, fmt::format("{};trees-{};derivative", backend, length), rows * trees.size(), [&]() {
+                for (auto const& tree : trees) {
+                    auto const coeff = tree.GetCoefficients();
+                    auto const jac = TInterpreter{dtable, ds, tree}.JacRev(coeff, range);
+                    nb::doNotOptimizeAway(jac.data());
+                }
+            });
+            measure(backend, fmt::format("trees-{}", length), dtable, trees);
+        }
+    }
+
+    std::ofstream file{output};
+    nb::render(nb::templates::json(), bench, file);
+    fmt::print("results written to {} (accuracy in {}.accuracy.csv)\n", output, output);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+// the default dispatch table compiled with one math backend, loaded by the backend benchmark (see LoadDispatchTable)
+// - the backend is given by OPERON_BENCHMARK_MATH_* and overrides the one the library was built with
+// - the module is built with hidden visibility, so its instantiations never mix with those of the library
+
+#undef OPERON_MATH_ARMA
+#undef OPERON_MATH_BLAZE
+#undef OPERON_MATH_EIGEN
+#undef OPERON_MATH_EVE
+#undef OPERON_MATH_FASTOR
+#undef OPERON_MATH_FAST_V1
+#undef OPERON_MATH_FAST_V2
+#undef OPERON_MATH_FAST_V3
+#undef OPERON_MATH_STL
+#undef OPERON_MATH_VDT
+#undef OPERON_MATH_XTENSOR
+
+#if defined(OPERON_BENCHMARK_MATH_ARMA)
+#define OPERON_MATH_ARMA
+#elif defined(OPERON_BENCHMARK_MATH_BLAZE)
+#define OPERON_MATH_BLAZE
+#elif defined(OPERON_BENCHMARK_MATH_EIGEN)
+#define OPERON_MATH_EIGEN
+#elif defined(OPERON_BENCHMARK_MATH_EVE)
+#define OPERON_MATH_EVE
+#elif defined(OPERON_BENCHMARK_MATH_FASTOR)
+#define OPERON_MATH_FASTOR
+#elif defined(OPERON_BENCHMARK_MATH_FAST_V1)
+#define OPERON_MATH_FAST_V1
+#elif defined(OPERON_BENCHMARK_MATH_FAST_V2)
+#define OPERON_MATH_FAST_V2
+#elif defined(OPERON_BENCHMARK_MATH_FAST_V3)
+#define OPERON_MATH_FAST_V3
+#elif defined(OPERON_BENCHMARK_MATH_STL)
+#define OPERON_MATH_STL
+#elif defined(OPERON_BENCHMARK_MATH_VDT)
+#define OPERON_MATH_VDT
+#else
+#error "no benchmark backend selected"
+#endif
+
+#include "operon/interpreter/cpu_dispatch.hpp"
+#include "operon/interpreter/dispatch_table.hpp"
+
+#if defined(_WIN32)
+#define OPERON_BENCHMARK_MODULE_EXPORT __declspec(dllexport)
+#else
+#define OPERON_BENCHMARK_MODULE_EXPORT __attribute__((visibility("default")))
+#endif
+
+extern "C" {
+    OPERON_BENCHMARK_MODULE_EXPORT auto OperonDispatchAbi() -> std::uint64_t
+    {
+        return Operon::detail::DispatchAbi();
+    }
+
+    OPERON_BENCHMARK_MODULE_EXPORT auto OperonMakeDispatchMap(Operon::DefaultDispatch::Map* map) -> void
+    {
+        *map = Operon::DefaultDispatch{}.GetMap();
+    }
+}
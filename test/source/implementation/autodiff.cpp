@@ -196,6 +196,206 @@ TEST_CASE("reverse mode" * dt::test_suite("[autodiff]")) {
         fmt::print("values: {}\n", vals);
     }
 
+    SUBCASE("few coefficients") {
+        // the nodes without coefficients in their subtree are skipped by the trace, the result must not change
+        Operon::Dataset::Matrix m(10, 2); // NOLINT
+        m.setRandom();
+        Operon::Dataset data(m);
+        data.SetVariableNames({"x", "y"});
+        Operon::Map<std::string, Operon::Hash> vars;
+        for (auto const& v : data.GetVariables()) { vars.insert({ v.Name, v.Hash }); }
+
+        auto tree = InfixParser::Parse("sin(x * y) + cos(x + y) * exp(y) + (x * x) / (1 + y * y)", vars);
+        Operon::Range rows(0, data.Rows<std::size_t>());
+        Operon::Interpreter<Operon::Scalar, decltype(dtable)> interpreter{dtable, data, tree};
+        Eigen::Array<Operon::Scalar, -1, -1> full = interpreter.JacRev(tree.GetCoefficients(), rows);
+
+        // keep only the first and the last coefficient
+        std::vector<Operon::Node*> leaves;
+        for (auto& n : tree.Nodes()) {
+            if (n.Optimize) { leaves.push_back(&n); }
+        }
+        REQUIRE(leaves.size() > 2);
+        std::vector<Eigen::Index> const keep{ 0, std::ssize(leaves) - 1 };
+        for (auto i = 1UL; i + 1 < leaves.size(); ++i) { leaves[i]->Optimize = false; }
+
+        auto coeff = tree.GetCoefficients();
+        Eigen::Array<Operon::Scalar, -1, -1> rev = interpreter.JacRev(coeff, rows);
+        Eigen::Array<Operon::Scalar, -1, -1> fwd = interpreter.JacFwd(coeff, rows);
+        REQUIRE(rev.cols() == 2);
+        for (auto k = 0UL; k < keep.size(); ++k) {
+            CHECK(rev.col(static_cast<Eigen::Index>(k)).isApprox(full.col(keep[k])));
+        }
+        CHECK(fwd.isApprox(rev));
+    }
+
+    SUBCASE("forward mode") {
+        // all the tangents are propagated in one walk, the result must match reverse mode
+        Operon::PrimitiveSet pset(Operon::PrimitiveSet::Arithmetic | NodeType::Exp | NodeType::Sin | NodeType::Cos | NodeType::Constant);
+        constexpr auto count{1000};
+        constexpr auto length{20};
+        for (auto const& tree : generateTrees(pset, count, length)) {
+            auto const parameters = tree.GetCoefficients();
+            Operon::Interpreter<Operon::Scalar, decltype(dtable)> interpreter{dtable, ds, tree};
+            Eigen::Array<Operon::Scalar, -1, -1> jrev = interpreter.JacRev(parameters, range);
+            Eigen::Array<Operon::Scalar, -1, -1> jfwd = interpreter.JacFwd(parameters, range);
+            if (!std::isfinite(jrev.sum())) { continue; }
+            CHECK(jfwd.isApprox(jrev, 1e-4));
+
+            // the output computed along with the jacobian
+            std::vector<Operon::Scalar> out(range.Size());
+            Eigen::Array<Operon::Scalar, -1, -1> jac(range.Size(), parameters.size());
+            interpreter.JacRev(parameters, range, out, { jac.data(), static_cast<std::size_t>(jac.size()) });
+            auto const est = interpreter.Evaluate(parameters, range);
+            using Vec = Eigen::Array<Operon::Scalar, -1, 1>;
+            CHECK(Eigen::Map<Vec const>(out.data(), std::ssize(out)).isApprox(Eigen::Map<Vec const>(est.data(), std::ssize(est)), 1e-5));
+            CHECK((jac == jrev).all());
+        }
+    }
+
+    SUBCASE("vector-jacobian products") {
+        // the gradient of the squared error computed batch by batch must match the product with the full jacobian
+        using Vec = Eigen::Array<Operon::Scalar, -1, 1>;
+        Operon::PrimitiveSet pset(Operon::PrimitiveSet::Arithmetic | NodeType::Exp | NodeType::Sin | NodeType::Cos | NodeType::Constant);
+        Operon::Dataset::Matrix m(1000, 2); // NOLINT
+        m.setRandom();
+        Operon::Dataset data(m);
+        data.SetVariableNames({"x", "y"});
+        Operon::Range const rows(0, data.Rows<std::size_t>());
+        auto const y = data.GetValues("y");
+        auto adjoint = [&](int64_t row, Operon::Span<Operon::Scalar const> values, Operon::Span<Operon::Scalar> a) {
+            Operon::Scalar loss{0};
+            for (auto i = 0UL; i < values.size(); ++i) {
+                a[i] = values[i] - y[row + i];
+                loss += a[i] * a[i];
+            }
+            return loss;
+        };
+
+        for (auto const& tree : generateTrees(pset, 1000, 20)) {
+            auto const parameters = tree.GetCoefficients();
+            Operon::Interpreter<Operon::Scalar, decltype(dtable)> interpreter{dtable, data, tree};
+            Vec g0(std::ssize(parameters));
+            Vec g1(std::ssize(parameters));
+            auto const f0 = interpreter.InterpreterBase<Operon::Scalar>::Vjp(parameters, rows, adjoint, { g0.data(), parameters.size() });
+            auto const f1 = interpreter.Vjp(parameters, rows, adjoint, { g1.data(), parameters.size() });
+            if (!std::isfinite(f0) || !std::isfinite(g0.sum())) { continue; }
+            CHECK(f1 == doctest::Approx(f0).epsilon(1e-4));
+            CHECK(g1.isApprox(g0, 1e-4));
+
+            // the products with given vectors
+            Eigen::Array<Operon::Scalar, -1, -1> const jac = interpreter.JacRev(parameters, rows);
+            Vec const v = Vec::Random(jac.rows());
+            Vec const u = Vec::Random(jac.cols());
+            Vec vjp(jac.cols());
+            Vec jvp(jac.rows());
+            interpreter.Vjp(parameters, rows, { v.data(), static_cast<std::size_t>(v.size()) }, { vjp.data(), static_cast<std::size_t>(vjp.size()) });
+            interpreter.Jvp(parameters, rows, { u.data(), static_cast<std::size_t>(u.size()) }, { jvp.data(), static_cast<std::size_t>(jvp.size()) });
+            CHECK(vjp.matrix().isApprox(jac.matrix().transpose() * v.matrix(), 1e-3));
+            CHECK(jvp.matrix().isApprox(jac.matrix() * u.matrix(), 1e-3));
+        }
+    }
+
+    SUBCASE("hessian-vector products") {
+        using Vec = Eigen::Array<Operon::Scalar, -1, 1>;
+        Operon::Dataset::Matrix m(100, 2); // NOLINT
+        m.setRandom();
+        Operon::Dataset data(m);
+        data.SetVariableNames({"x", "y"});
+        Operon::Range const rows(0, data.Rows<std::size_t>());
+        Vec const w = Vec::Random(static_cast<Eigen::Index>(rows.Size()));
+        Operon::Span<Operon::Scalar const> weights{ w.data(), rows.Size() };
+
+        // f = c2 * x * exp(c1 * y)
+        auto variable = [&](auto const& name, Operon::Scalar value) {
+            auto n = Node(NodeType::Variable);
+            n.HashValue = data.GetVariable(name)->Hash;
+            n.Value = value;
+            return n;
+        };
+        Operon::Tree tree({ variable("y", 1.3), Node(NodeType::Exp), variable("x", 0.7), Node(NodeType::Mul) }); // NOLINT
+        tree.UpdateNodes();
+        auto const coeff = tree.GetCoefficients();
+        REQUIRE(coeff.size() == 2);
+        Operon::Interpreter<Operon::Scalar, decltype(dtable)> interpreter{dtable, data, tree};
+        Vec const v = Vec::Random(2);
+        Vec hv(2);
+        interpreter.Hvp(coeff, rows, weights, { v.data(), 2 }, { hv.data(), 2 });
+
+        auto const x = data.GetValues("x");
+        auto const y = data.GetValues("y");
+        Vec expected = Vec::Zero(2);
+        for (auto r = 0UL; r < rows.Size(); ++r) {
+            auto const e = std::exp(coeff[0] * y[r]);
+            auto const h11 = coeff[1] * x[r] * y[r] * y[r] * e;
+            auto const h12 = x[r] * y[r] * e;
+            expected[0] += w[r] * (h11 * v[0] + h12 * v[1]);
+            expected[1] += w[r] * h12 * v[0];
+        }
+        CHECK(hv.isApprox(expected, 1e-4));
+
+        // the hessian assembled from the products with the unit vectors is symmetric
+        Operon::PrimitiveSet pset(Operon::PrimitiveSet::Arithmetic | NodeType::Exp | NodeType::Sin | NodeType::Cos | NodeType::Tanh | NodeType::Constant);
+        for (auto const& t : generateTrees(pset, 200, 20)) { // NOLINT
+            auto const parameters = t.GetCoefficients();
+            auto const nc = std::ssize(parameters);
+            Operon::Interpreter<Operon::Scalar, decltype(dtable)> in{dtable, data, t};
+            Eigen::Array<Operon::Scalar, -1, -1> hessian(nc, nc);
+            Vec e(nc);
+            for (auto k = 0L; k < nc; ++k) {
+                e.setZero();
+                e[k] = 1;
+                in.Hvp(parameters, rows, weights, { e.data(), parameters.size() }, { hessian.col(k).data(), parameters.size() });
+            }
+            if (!hessian.isFinite().all()) { continue; }
+            auto const scale = std::max(Operon::Scalar{1}, hessian.abs().maxCoeff());
+            CHECK(((hessian - hessian.transpose()).abs() <= 1e-3 * scale).all());
+        }
+
+        // the analytic products match the central differences of the weighted gradient (the base implementation used
+        // by the other interpreters), with and without weights
+        // - in single precision the differences are only close for a moderate curvature (no exp or div), in double
+        //   precision they check the analytic products tightly
+        Operon::PrimitiveSet smooth(NodeType::Add | NodeType::Sub | NodeType::Mul | NodeType::Sin | NodeType::Cos | NodeType::Tanh | NodeType::Constant);
+        Operon::BalancedTreeCreator btc(smooth, data.VariableHashes());
+        Operon::DispatchTable<double> dtableDouble;
+        std::bernoulli_distribution bernoulli(0.5); // NOLINT
+        std::uniform_real_distribution<Operon::Scalar> uniform(-1, 1);
+        auto close = [](auto const& a, auto const& b, auto tolerance) {
+            auto const scale = std::max(1.0, static_cast<double>(a.abs().maxCoeff()));
+            return ((a.template cast<double>() - b.template cast<double>()).abs() <= tolerance * scale).all();
+        };
+        for (auto i = 0; i < 200; ++i) { // NOLINT
+            auto t = btc(rng, 20, 1, 1000); // NOLINT
+            for (auto& node : t.Nodes()) {
+                node.Optimize = bernoulli(rng) || node.IsLeaf();
+                if (node.IsLeaf()) { node.Value = uniform(rng); }
+            }
+            auto const parameters = t.GetCoefficients();
+            auto const nc = std::ssize(parameters);
+            Vec d(nc);
+            std::ranges::generate(d, [&]() { return uniform(rng); });
+            Operon::Span<Operon::Scalar const> direction{ d.data(), parameters.size() };
+
+            Operon::Interpreter<Operon::Scalar, decltype(dtable)> in{dtable, data, t};
+            Operon::Interpreter<double, decltype(dtableDouble)> ind{dtableDouble, data, t};
+            std::vector<double> const pd(parameters.begin(), parameters.end());
+            std::vector<double> const dd(d.begin(), d.end());
+            for (auto const wr : { weights, Operon::Span<Operon::Scalar const>{} }) {
+                Vec analytic(nc);
+                Vec numeric(nc);
+                in.Hvp(parameters, rows, wr, direction, { analytic.data(), parameters.size() });
+                in.Operon::InterpreterBase<Operon::Scalar>::Hvp(parameters, rows, wr, direction, { numeric.data(), parameters.size() });
+                CHECK(close(analytic, numeric, 1e-2));
+
+                std::vector<double> const wd(wr.begin(), wr.end());
+                Eigen::Array<double, -1, 1> reference(nc);
+                ind.Operon::InterpreterBase<double>::Hvp(pd, rows, wd, dd, { reference.data(), parameters.size() });
+                CHECK(close(analytic, reference, 1e-4));
+            }
+        }
+    }
+
     SUBCASE("random trees") {
         using Operon::NodeType;
         // Operon::PrimitiveSet pset(Operon::PrimitiveSet::Arithmetic |
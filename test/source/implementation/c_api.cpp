@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <cmath>
+#include <cstdint>
+#include <doctest/doctest.h>
+#include <string>
+#include <vector>
+
+#include "operon/capi/operon_c.h"
+
+namespace Operon::Test {
+
+TEST_CASE("C interface" * doctest::test_suite("[implementation]"))
+{
+    REQUIRE(operon_scalar_size() == sizeof(operon_scalar));
+
+    // two columns, column-major
+    constexpr size_t rows{5};
+    std::vector<operon_scalar> data{ 1, 2, 3, 4, 5, 0.5, 1.5, 2.5, 3.5, 4.5 };
+    operon_dataset* ds{nullptr};
+    REQUIRE(operon_dataset_create(data.data(), rows, 2, &ds) == OPERON_OK);
+
+    // 2 * x2 + sin(x1), in postfix order
+    std::vector<uint32_t> types{ OPERON_NODE_VARIABLE, OPERON_NODE_VARIABLE, OPERON_NODE_SIN, OPERON_NODE_ADD };
+    std::vector<operon_scalar> values{ 2, 1, 1, 1 };
+    std::vector<int64_t> columns{ 1, 0, -1, -1 };
+    operon_tree* tree{nullptr};
+    REQUIRE(operon_tree_create(types.size(), types.data(), nullptr, values.data(), columns.data(), &tree) == OPERON_OK);
+    CHECK(operon_tree_coefficient_count(tree) == 2);
+
+    SUBCASE("Evaluate into the caller buffer")
+    {
+        std::vector<operon_scalar> result(3);
+        REQUIRE(operon_evaluate(tree, ds, 1, 4, nullptr, result.data()) == OPERON_OK);
+        for (auto i = 0UL; i < result.size(); ++i) {
+            auto const expected = 2 * data[rows + i + 1] + std::sin(data[i + 1]);
+            CHECK(result[i] == doctest::Approx(expected));
+        }
+
+        // other coefficients, the tree is unchanged
+        std::vector<operon_scalar> coeff{ 3, 2 };
+        REQUIRE(operon_evaluate(tree, ds, 1, 4, coeff.data(), result.data()) == OPERON_OK);
+        CHECK(result[0] == doctest::Approx(3 * data[rows + 1] + std::sin(2 * data[1])));
+        REQUIRE(operon_evaluate(tree, ds, 1, 4, nullptr, result.data()) == OPERON_OK);
+        CHECK(result[0] == doctest::Approx(2 * data[rows + 1] + std::sin(data[1])));
+    }
+
+    SUBCASE("Batch")
+    {
+        std::vector<uint32_t> constant{ OPERON_NODE_CONSTANT };
+        std::vector<operon_scalar> value{ 7 };
+        operon_tree* other{nullptr};
+        REQUIRE(operon_tree_create(1, constant.data(), nullptr, value.data(), nullptr, &other) == OPERON_OK);
+
+        std::vector<operon_tree const*> trees{ tree, other };
+        std::vector<operon_scalar> result(trees.size() * rows);
+        REQUIRE(operon_evaluate_batch(trees.data(), trees.size(), ds, 0, rows, result.data()) == OPERON_OK);
+        CHECK(result[0] == doctest::Approx(2 * data[rows] + std::sin(data[0])));
+        for (auto i = 0UL; i < rows; ++i) {
+            CHECK(result[rows + i] == doctest::Approx(7));
+        }
+        operon_tree_destroy(other);
+    }
+
+    SUBCASE("Errors")
+    {
+        std::vector<operon_scalar> result(rows);
+        CHECK(operon_evaluate(tree, ds, 2, rows + 1, nullptr, result.data()) == OPERON_INVALID_ARGUMENT);
+        CHECK(!std::string(operon_last_error()).empty());
+
+        // a missing child
+        std::vector<uint32_t> broken{ OPERON_NODE_VARIABLE, OPERON_NODE_ADD };
+        operon_tree* bad{nullptr};
+        CHECK(operon_tree_create(broken.size(), broken.data(), nullptr, nullptr, columns.data(), &bad) == OPERON_INVALID_TREE);
+        CHECK(bad == nullptr);
+
+        // two roots
+        std::vector<uint32_t> forest{ OPERON_NODE_CONSTANT, OPERON_NODE_CONSTANT };
+        CHECK(operon_tree_create(forest.size(), forest.data(), nullptr, nullptr, nullptr, &bad) == OPERON_INVALID_TREE);
+
+        // fmin and fmax are binary
+        std::vector<uint32_t> minimum{ OPERON_NODE_CONSTANT, OPERON_NODE_CONSTANT, OPERON_NODE_CONSTANT, OPERON_NODE_FMIN };
+        std::vector<uint16_t> arities{ 0, 0, 0, 3 };
+        CHECK(operon_tree_create(minimum.size(), minimum.data(), arities.data(), nullptr, nullptr, &bad) == OPERON_INVALID_TREE);
+        std::vector<uint32_t> maximum{ OPERON_NODE_CONSTANT, OPERON_NODE_CONSTANT, OPERON_NODE_FMAX };
+        std::vector<uint16_t> binary{ 0, 0, 2 };
+        REQUIRE(operon_tree_create(maximum.size(), maximum.data(), binary.data(), nullptr, nullptr, &bad) == OPERON_OK);
+        operon_tree_destroy(bad);
+
+        // a column that is not in the dataset
+        std::vector<int64_t> far{ 2 };
+        REQUIRE(operon_tree_create(1, types.data(), nullptr, nullptr, far.data(), &bad) == OPERON_OK);
+        CHECK(operon_evaluate(bad, ds, 0, rows, nullptr, result.data()) == OPERON_INVALID_ARGUMENT);
+        operon_tree_destroy(bad);
+
+        CHECK(operon_evaluate(tree, ds, 0, rows, nullptr, result.data()) == OPERON_OK);
+        CHECK(std::string(operon_last_error()).empty());
+    }
+
+    operon_tree_destroy(tree);
+    operon_dataset_destroy(ds);
+}
+
+} // namespace Operon::Test
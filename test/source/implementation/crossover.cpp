@@ -52,6 +52,69 @@ TEST_CASE("Crossover")
         fmt::print("child\n{}\n", TreeFormatter::Format(child, ds, 2));
     }
 
+    SUBCASE("Recombine into an existing child")
+    {
+        constexpr size_t maxDepth{1000};
+        constexpr size_t maxLength{100};
+        Operon::SubtreeCrossover cx(0.9, maxDepth, maxLength); // NOLINT
+        Operon::RandomGenerator rng1(1234);
+        Operon::RandomGenerator rng2(1234);
+        Tree child;
+        for (auto i = 0; i < 100; ++i) { // NOLINT
+            auto p1 = btc(random, 20, 1, maxDepth); // NOLINT
+            auto p2 = btc(random, 20, 1, maxDepth); // NOLINT
+            auto expected = cx(rng1, p1, p2);
+            cx.Recombine(rng2, p1, p2, child);
+            REQUIRE(child.Length() == expected.Length());
+            CHECK(std::ranges::equal(child.Nodes(), expected.Nodes(), [](auto const& a, auto const& b) {
+                return a.HashValue == b.HashValue && a.Length == b.Length && a.Depth == b.Depth;
+            }));
+        }
+    }
+
+    SUBCASE("Incremental node update")
+    {
+        constexpr size_t maxDepth{1000};
+        auto same = [](Tree const& a, Tree const& b) {
+            return std::ranges::equal(a.Nodes(), b.Nodes(), [](auto const& x, auto const& y) {
+                return x.Length == y.Length && x.Depth == y.Depth && x.Level == y.Level && x.Parent == y.Parent && x.CalculatedHashValue == y.CalculatedHashValue;
+            });
+        };
+        for (auto k = 0; k < 100; ++k) { // NOLINT
+            auto p1 = btc(random, 30, 1, maxDepth); // NOLINT
+            auto p2 = btc(random, 30, 1, maxDepth); // NOLINT
+            (void) p1.Hash(Operon::HashMode::Strict);
+            (void) p2.Hash(Operon::HashMode::Strict);
+            auto i = std::uniform_int_distribution<size_t>(0, p1.Length() - 1)(random);
+            auto j = std::uniform_int_distribution<size_t>(0, p2.Length() - 1)(random);
+
+            auto child = SubtreeCrossover::Cross(p1, p2, i, j);
+            (void) child.Hash(Operon::HashMode::Strict, i - p1[i].Length + p2[j].Length);
+            auto expected = child;
+            (void) expected.UpdateNodes().Hash(Operon::HashMode::Strict);
+            CHECK(same(child, expected));
+        }
+    }
+
+    SUBCASE("Swap location index")
+    {
+        constexpr size_t maxDepth{1000};
+        constexpr size_t maxLength{30};
+        Operon::SubtreeCrossover cx(0.9, maxDepth, maxLength); // NOLINT
+        for (auto k = 0; k < 100; ++k) { // NOLINT
+            auto p1 = btc(random, 40, 1, maxDepth); // NOLINT
+            auto p2 = btc(random, 40, 1, maxDepth); // NOLINT
+            SwapLocationIndex const i1{p1};
+            SwapLocationIndex const i2{p2};
+            auto [i, j] = cx.FindCompatibleSwapLocations(random, p1, p2, i1, i2);
+            REQUIRE(i < p1.Length());
+            REQUIRE(j < p2.Length());
+            // the child respects the length limit whenever the parent does
+            auto child = SubtreeCrossover::Cross(p1, p2, i, j);
+            CHECK(child.Length() <= std::max(maxLength, p1.Length()));
+        }
+    }
+
     SUBCASE("Distribution of swap locations")
     {
         Operon::RandomGenerator rng(std::random_device{}());
@@ -2,18 +2,35 @@
 // SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <filesystem>
+#include <fstream>
 #include <doctest/doctest.h>
 #include <fmt/core.h>
+#include <taskflow/taskflow.hpp>
 #include <iterator>
+#include <ranges>
+#include <string>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "../operon_test.hpp"
+#include "operon/core/affinity.hpp"
+#include "operon/core/compact_tree.hpp"
+#include "operon/core/dataset.hpp"
+#include "operon/core/executor.hpp"
 #include "operon/core/individual.hpp"
+#include "operon/core/node_arena.hpp"
 #include "operon/core/node.hpp"
+#include "operon/core/pool.hpp"
+#include "operon/core/problem.hpp"
+#include "operon/core/sharded_map.hpp"
+#include "operon/core/subtree_store.hpp"
 #include "operon/core/tree.hpp"
 #include "operon/core/types.hpp"
+#include "operon/operators/crossover.hpp"
 
 namespace dt = doctest;
 
@@ -80,4 +97,403 @@ namespace Operon::Test {
 
         CHECK(sizeof(Node) <= size_t { 64 });
     }
+
+    TEST_CASE("Compact tree" * dt::test_suite("[detail]"))
+    {
+        CHECK(std::is_trivially_copyable_v<Operon::CompactNode>);
+        CHECK(sizeof(CompactNode) < sizeof(Node));
+        fmt::print("sizeof(CompactNode) {:>2}\n", sizeof(CompactNode));
+
+        Tree lhs{ Node::Constant(1), Node::Constant(2), Node(NodeType::Add), Node(NodeType::Sin), Node::Constant(3), Node(NodeType::Mul) };
+        Tree rhs{ Node::Constant(4), Node(NodeType::Exp), Node::Constant(5), Node(NodeType::Div) };
+        lhs.UpdateNodes();
+        rhs.UpdateNodes();
+
+        auto same = [](Tree const& a, Tree const& b) {
+            return std::ranges::equal(a.Nodes(), b.Nodes(), [](auto const& x, auto const& y) {
+                return x.Type == y.Type && x.Value == y.Value && x.Arity == y.Arity && x.Length == y.Length
+                    && x.Depth == y.Depth && x.Level == y.Level && x.Parent == y.Parent && x.Optimize == y.Optimize;
+            });
+        };
+
+        CompactTree const left{lhs};
+        CompactTree const right{rhs};
+        CHECK(same(left.ToTree(), lhs));
+        for (auto i = 0UL; i < lhs.Length(); ++i) {
+            CHECK(left.SubtreeLength(i) == lhs[i].Length);
+            for (auto j = 0UL; j < rhs.Length(); ++j) {
+                CHECK(same(SubtreeCrossover::Cross(left, right, i, j).ToTree(), SubtreeCrossover::Cross(lhs, rhs, i, j)));
+            }
+        }
+    }
+
+    TEST_CASE("Subtree store" * dt::test_suite("[detail]"))
+    {
+        Tree lhs{ Node::Constant(1), Node::Constant(2), Node(NodeType::Add), Node(NodeType::Sin), Node::Constant(3), Node(NodeType::Mul) };
+        Tree rhs{ Node::Constant(4), Node(NodeType::Exp), Node::Constant(1), Node::Constant(2), Node(NodeType::Add), Node(NodeType::Sin), Node(NodeType::Div) };
+        lhs.UpdateNodes();
+        rhs.UpdateNodes();
+
+        SubtreeStore store;
+        auto const a = store.Intern(lhs);
+        auto const b = store.Intern(rhs);
+        CHECK(store.Intern(Tree{lhs}) == a);
+        CHECK(a != b);
+
+        // the constants 1 and 2 and the subtree sin(1 + 2) are stored once
+        CHECK(store.Size() == lhs.Length() + rhs.Length() - 4);
+        CHECK(store.Length(b) == rhs.Length());
+
+        auto const tree = store.ToTree(b);
+        CHECK(std::ranges::equal(tree.Nodes(), rhs.Nodes(), [](auto const& x, auto const& y) {
+            return x.HashValue == y.HashValue && x.Value == y.Value && x.Arity == y.Arity && x.Length == y.Length && x.Parent == y.Parent;
+        }));
+        CHECK(tree.HashValue() == rhs.Hash(Operon::HashMode::Strict).HashValue());
+        CHECK(store.HashValue(b) == rhs.HashValue());
+
+        // the coefficients are part of the identity
+        auto other = lhs;
+        other[0].Value = 7;
+        CHECK(store.Intern(other) != a);
+
+        store.Clear();
+        CHECK(store.Size() == 0);
+    }
+
+    TEST_CASE("Node arena" * dt::test_suite("[detail]"))
+    {
+        NodeArena::Clear();
+        Tree const tree{ Node::Constant(1), Node::Constant(2), Node(NodeType::Add) };
+
+        Node const* data{nullptr};
+        {
+            auto copy = tree;
+            data = copy.Nodes().data(); // the copy takes its own buffer when it is modified
+            CHECK(NodeArena::Count() == 0);
+        }
+        // the buffer of the destroyed copy is reused by the next modified copy
+        CHECK(NodeArena::Count() == 1);
+        auto copy = tree;
+        CHECK(NodeArena::Count() == 1);
+        CHECK(copy.Nodes().data() == data);
+        CHECK(NodeArena::Count() == 0);
+        CHECK(std::ranges::equal(copy.Nodes(), tree.Nodes()));
+    }
+
+    TEST_CASE("Copy-on-write" * dt::test_suite("[detail]"))
+    {
+        Tree const tree{ Node::Constant(1), Node::Constant(2), Node(NodeType::Add) };
+        CHECK(!tree.Shared());
+
+        // a copy shares the nodes until it is modified
+        auto copy = tree;
+        CHECK(tree.Shared());
+        CHECK(copy.Shared());
+        CHECK(std::as_const(copy).Nodes().data() == tree.Nodes().data());
+
+        copy[0].Value = 3;
+        CHECK(!tree.Shared());
+        CHECK(!copy.Shared());
+        CHECK(tree[0].Value == 1);
+        CHECK(copy[0].Value == 3);
+
+        // hashing stores the hash values in the nodes, so it does not change the hash values of the other copies
+        auto other = tree;
+        (void) tree.Hash(Operon::HashMode::Strict);
+        auto const strict = tree.HashValue();
+        (void) other.Hash(Operon::HashMode::Relaxed);
+        CHECK(tree.HashValue() == strict);
+        CHECK(other.HashValue() != strict);
+        CHECK(!other.Shared());
+
+        // the last copy keeps the nodes alive
+        Tree moved;
+        {
+            auto temporary = tree;
+            moved = std::move(temporary);
+        }
+        CHECK(moved.Shared());
+        CHECK(std::ranges::equal(moved.Nodes(), tree.Nodes(), [](auto const& a, auto const& b) { return a.Value == b.Value; }));
+    }
+
+    TEST_CASE("Coefficients into a buffer" * dt::test_suite("[detail]"))
+    {
+        Tree tree{ Node::Constant(2), Node(NodeType::Variable, 1), Node(NodeType::Add) };
+        tree[1].Value = 3;
+        auto const expected = tree.GetCoefficients();
+
+        // the vector keeps its capacity between the trees
+        std::vector<Operon::Scalar> buffer;
+        buffer.reserve(8);
+        auto const* data = buffer.data();
+        auto values = tree.GetCoefficients(buffer);
+        CHECK(std::ranges::equal(values, expected));
+        CHECK(buffer.size() == expected.size());
+        CHECK(buffer.data() == data);
+
+        std::vector<Operon::Scalar> large(8, -1);
+        values = tree.GetCoefficients(Operon::Span<Operon::Scalar>{large});
+        CHECK(values.size() == expected.size());
+        CHECK(values.data() == large.data());
+        CHECK(std::ranges::equal(values, expected));
+        CHECK(large[expected.size()] == -1);
+
+        Tree fixed{ Node::Constant(1) };
+        fixed[0].Optimize = false;
+        CHECK(std::as_const(fixed).GetCoefficients(buffer).empty());
+        CHECK(buffer.empty());
+    }
+
+    TEST_CASE("Binary dataset" * dt::test_suite("[detail]"))
+    {
+        Dataset::Matrix values(100, 3);
+        values.setRandom();
+        Dataset ds(values);
+        ds.SetVariableNames({ "x1", "x2", "y" });
+
+        Util::TemporaryFile const file{".bin"};
+        auto const path = file.Path();
+        ds.WriteBinary(path);
+        CHECK(Dataset::IsBinary(path));
+
+        auto const bin = Dataset::ReadBinary(path);
+        CHECK(bin.IsView());
+        CHECK(!ds.IsMapped());
+        CHECK(bin == ds);
+        CHECK(bin.VariableNames() == ds.VariableNames());
+        CHECK(std::ranges::equal(bin.GetValues("y"), ds.GetValues("y")));
+
+        // a copy of the view shares the mapping, which outlives the original
+        Dataset copy = bin;
+        CHECK(copy.IsView());
+        CHECK(copy.GetValues("x1").data() == bin.GetValues("x1").data());
+
+        // a projection owns a copy of the selected columns
+        auto const proj = Dataset::ReadBinary(path, { "y", "x1" });
+        CHECK(!proj.IsView());
+        CHECK(proj.VariableNames() == std::vector<std::string>{ "x1", "y" });
+        CHECK(std::ranges::equal(proj.GetValues("y"), ds.GetValues("y")));
+        CHECK(proj == ds.Select(std::vector{ ds.GetVariable("x1")->Hash, ds.GetVariable("y")->Hash }));
+
+        std::filesystem::remove(path);
+        CHECK(!Dataset::IsBinary(path));
+    }
+
+    TEST_CASE("Shared dataset" * dt::test_suite("[detail]"))
+    {
+        Dataset::Matrix values(100, 3);
+        values.setRandom();
+        Dataset ds(values);
+        ds.SetVariableNames({ "x1", "x2", "y" });
+        auto const* data = ds.GetValues("x1").data();
+
+        ds.Share();
+        CHECK(ds.IsView());
+        CHECK(ds.GetValues("x1").data() == data); // the values are moved, not copied
+        CHECK(std::ranges::equal(ds.GetValues("y"), values.col(2)));
+        CHECK_THROWS(ds.Normalize(0, Range{0, 10}));
+
+        // the problems share the values, which outlive the original dataset
+        std::vector<Problem> problems;
+        {
+            auto const shared = std::move(ds);
+            problems.emplace_back(shared, Range{0, 50}, Range{50, 100});
+            problems.emplace_back(shared, Range{50, 100}, Range{0, 50});
+        }
+        problems[1].SetTarget("x2");
+        for (auto const& p : problems) {
+            CHECK(p.GetDataset().IsView());
+            CHECK(p.GetDataset().GetValues("x1").data() == data);
+        }
+        CHECK(std::ranges::equal(problems[1].TargetValues(), values.col(1)));
+    }
+
+    TEST_CASE("Paging hints on a shared dataset" * dt::test_suite("[detail]"))
+    {
+        // columns spanning many pages, so that whole pages would be released
+        Dataset::Matrix values(1'000'000, 2); // NOLINT
+        values.setRandom();
+        Dataset ds(values);
+        ds.Share();
+        CHECK(ds.IsView());
+        CHECK(!ds.IsMapped());
+
+        // the shared values are in memory, they are not released (zero-filled) like the pages of a mapped file
+        ds.Prefetch(Range{0, ds.Rows<std::size_t>()});
+        ds.Evict(Range{0, ds.Rows<std::size_t>()});
+        CHECK(std::ranges::equal(ds.GetValues(0L), values.col(0)));
+        CHECK(std::ranges::equal(ds.GetValues(1L), values.col(1)));
+    }
+
+    TEST_CASE("Parallel csv loader" * dt::test_suite("[detail]"))
+    {
+        // large enough to be split in several chunks of at least 1 MiB (see Csv::MinChunkSize)
+        auto constexpr rows{400'000};
+        Util::TemporaryFile const file{".csv"};
+        auto const path = file.Path();
+        {
+            std::ofstream f(path);
+            f << "x1,\"x2\",y\r\n";
+            for (auto i = 0; i < rows; ++i) {
+                f << fmt::format("{},{},{}\n", 0.5 * i, -i, i % 7);
+                if (i % 1000 == 0) { f << "\n"; } // blank lines are skipped
+            }
+        }
+        REQUIRE(std::filesystem::file_size(path) > 4UL << 20UL);
+
+        auto const ds = Dataset::LoadCsv(path, { .HasHeader = true, .Columns = {}, .Threads = 4 });
+        CHECK(ds.Rows() == rows);
+        CHECK(ds.VariableNames() == std::vector<std::string>{ "x1", "x2", "y" });
+
+        // the rows of every chunk are in place, including those around the chunk boundaries
+        auto const x1 = ds.GetValues("x1");
+        auto const x2 = ds.GetValues("x2");
+        auto const y = ds.GetValues("y");
+        auto ok{true};
+        for (auto i = 0; i < rows; ++i) {
+            ok &= x1[i] == static_cast<Operon::Scalar>(0.5 * i) && x2[i] == static_cast<Operon::Scalar>(-i) && y[i] == static_cast<Operon::Scalar>(i % 7);
+        }
+        CHECK(ok);
+
+        // the same values with a single chunk
+        auto const serial = Dataset::LoadCsv(path, { .HasHeader = true, .Columns = {}, .Threads = 1 });
+        CHECK(serial == ds);
+
+        // only the selected columns are loaded
+        auto const sel = Dataset::LoadCsv(path, { .HasHeader = true, .Columns = { "y", "x1" }, .Threads = 4 });
+        CHECK(sel.Cols() == 2);
+        CHECK(sel.VariableNames() == std::vector<std::string>{ "x1", "y" });
+        CHECK(std::ranges::equal(sel.GetValues("y"), y));
+        CHECK_THROWS(Dataset::LoadCsv(path, { .HasHeader = true, .Columns = { "x3" }, .Threads = 1 }));
+    }
+
+    TEST_CASE("Parallel dataset preprocessing" * dt::test_suite("[detail]"))
+    {
+        // more rows than a block, so that the columns are split
+        Dataset::Matrix values(100'000, 4); // NOLINT
+        values.setRandom();
+        tf::Executor executor(4);
+        std::vector<std::size_t> const columns{ 0, 1, 3 };
+        Range const range{ 100, 90'000 }; // NOLINT
+
+        Dataset serial(values);
+        Dataset parallel(values);
+        Operon::RandomGenerator r1{1};
+        Operon::RandomGenerator r2{1};
+        serial.Shuffle(r1);
+        parallel.Shuffle(r2, executor);
+        CHECK((serial.Values() == parallel.Values()).all());
+
+        for (auto c : columns) { serial.Standardize(c, range); }
+        parallel.Standardize(columns, range, /*inPlace=*/true, executor);
+        CHECK((serial.Values() == parallel.Values()).all());
+
+        for (auto c : columns) { serial.Normalize(c, range); }
+        parallel.Normalize(columns, range, executor);
+        CHECK((serial.Values() == parallel.Values()).all());
+
+        // the permutation only reorders the rows
+        Operon::RandomGenerator r3{2};
+        auto const indices = parallel.RandomPermutation(r3);
+        auto const copy = parallel.Values().eval();
+        parallel.PermuteRows(indices, executor);
+        CHECK(parallel.Values().row(indices[7]).isApprox(copy.row(7))); // NOLINT
+    }
+
+    TEST_CASE("Worker affinity" * dt::test_suite("[detail]"))
+    {
+        std::vector<std::vector<int>> const topology{ { 0, 1, 2 }, { 4, 5 } };
+        CHECK(AssignCores(AffinityPolicy::None, 4, topology).empty());
+        CHECK(AssignCores(AffinityPolicy::Compact, 6, topology) == std::vector<int>{ 0, 1, 2, 4, 5, 0 });
+        CHECK(AssignCores(AffinityPolicy::Scatter, 6, topology) == std::vector<int>{ 0, 4, 1, 5, 2, 0 });
+        CHECK(AssignCores(AffinityPolicy::Compact, 2, {}).empty());
+
+        // the pinned workers run the tasks like any others
+        auto const cores = AssignCores(AffinityPolicy::Compact, 2, CoreTopology());
+        auto executor = MakeExecutor(2, cores);
+        std::atomic<int> count{0};
+        tf::Taskflow taskflow;
+        taskflow.for_each_index(0, 100, 1, [&](int) { ++count; }); // NOLINT
+        executor->run(taskflow).wait();
+        CHECK(count == 100);
+    }
+
+    TEST_CASE("Run or corun a taskflow" * dt::test_suite("[detail]"))
+    {
+        tf::Executor executor(2);
+        std::atomic<int> count{0};
+
+        // from outside the executor
+        tf::Taskflow outer;
+        outer.for_each_index(0, 10, 1, [&](int) { ++count; }); // NOLINT
+        RunTaskflow(executor, outer);
+        CHECK(count == 10);
+
+        // from inside every worker at once, a blocking wait would leave no worker to run the inner tasks
+        count = 0;
+        tf::Taskflow nested;
+        for (auto i = 0; i < 4; ++i) {
+            nested.emplace([&]() {
+                tf::Taskflow inner;
+                inner.for_each_index(0, 10, 1, [&](int) { ++count; }); // NOLINT
+                RunTaskflow(executor, inner);
+            });
+        }
+        RunTaskflow(executor, nested);
+        CHECK(count == 40);
+    }
+
+    TEST_CASE("Pooled buffers across a corun" * dt::test_suite("[detail]"))
+    {
+        // each task writes its index into its buffer and coruns an inner taskflow, during which the worker can run
+        // the other tasks of the outer taskflow: a per-worker buffer would be overwritten by them
+        tf::Executor executor(2);
+        ObjectPool<std::vector<int>> pool;
+        std::atomic<int> overwritten{0};
+        std::atomic<int> count{0};
+        tf::Taskflow outer;
+        outer.for_each_index(0, 64, 1, [&](int i) { // NOLINT
+            auto lease = pool.Acquire();
+            lease->assign(100, i); // NOLINT
+            tf::Taskflow inner;
+            inner.for_each_index(0, 10, 1, [&](int) { ++count; }); // NOLINT
+            RunTaskflow(executor, inner);
+            if (std::ranges::any_of(*lease, [&](auto v) { return v != i; })) { ++overwritten; }
+        });
+        RunTaskflow(executor, outer);
+        CHECK(count == 640);
+        CHECK(overwritten == 0);
+
+        // every buffer is back in the pool, with its storage
+        auto buffers{0};
+        pool.ForEach([&](auto const& buf) { ++buffers; CHECK(buf.size() == 100); });
+        CHECK(buffers > 0);
+        CHECK(buffers <= 64);
+    }
+
+    TEST_CASE("Sharded map" * dt::test_suite("[detail]"))
+    {
+        constexpr auto n { 10'000UL };
+
+        // an unbounded map keeps every entry
+        ShardedSet set;
+        set.Reserve(n);
+        for (auto i = 0UL; i < n; ++i) { CHECK(set.TryInsert(i)); }
+        CHECK(!set.TryInsert(0));
+        CHECK(set.Size() == n);
+        CHECK(std::ranges::all_of(std::views::iota(0UL, n), [&](auto i) { return set.Contains(i); }));
+        set.Clear();
+        CHECK(set.Size() == 0);
+
+        // a bounded map flushes a full shard
+        ShardedMap<int> map { 64, 4 }; // NOLINT
+        for (auto i = 0UL; i < n; ++i) { map.Insert(i, static_cast<int>(i)); }
+        CHECK(map.Size() <= 64);
+        int value{0};
+        CHECK(map.Find(n - 1, value));
+        CHECK(value == static_cast<int>(n - 1));
+        map.Insert(n - 1, 1);
+        CHECK(map.Find(n - 1, value));
+        CHECK(value == 1);
+    }
 } // namespace Operon::Test
@@ -0,0 +1,519 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <algorithm>
+#include <cmath>
+#include <doctest/doctest.h>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <taskflow/core/executor.hpp>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../operon_test.hpp"
+#include "operon/algorithms/gp.hpp"
+#include "operon/algorithms/nsga2.hpp"
+#include "operon/algorithms/task_trace.hpp"
+#include "operon/algorithms/worker_limit.hpp"
+#include "operon/core/dataset.hpp"
+#include "operon/core/memory.hpp"
+#include "operon/core/problem.hpp"
+#include "operon/core/pset.hpp"
+#include "operon/interpreter/interpreter.hpp"
+#include "operon/operators/creator.hpp"
+#include "operon/operators/crossover.hpp"
+#include "operon/operators/evaluator.hpp"
+#include "operon/operators/generator.hpp"
+#include "operon/operators/initializer.hpp"
+#include "operon/operators/local_search.hpp"
+#include "operon/operators/mutation.hpp"
+#include "operon/operators/non_dominated_sorter.hpp"
+#include "operon/operators/reinserter.hpp"
+#include "operon/operators/selector.hpp"
+#include "operon/optimizer/optimizer.hpp"
+#include "operon/random/random.hpp"
+
+namespace Operon::Test {
+
+TEST_CASE("Philox" * doctest::test_suite("[implementation]"))
+{
+    // known answer of the reference implementation (Random123)
+    auto const [a, b] = Random::Philox(0, 0, 0);
+    CHECK(a == UINT64_C(0xca00a0459843d731));
+    CHECK(b == UINT64_C(0x66c24222c9a845b5));
+}
+
+TEST_CASE("Deterministic runs" * doctest::test_suite("[implementation]"))
+{
+    Util::SyntheticGpSetup setup;
+    Operon::OffspringSelectionGenerator generator { setup.Evaluator, setup.Crossover, setup.Mutator, setup.Selector, setup.Selector };
+    setup.Config.Deterministic = true;
+
+    // the fitness values of the final population for a number of threads
+    auto run = [&](size_t threads, size_t limit = 0) {
+        setup.Evaluator.Reset();
+        Operon::GeneticProgrammingAlgorithm gp { setup.Problem, setup.Config, setup.TreeInitializer, setup.CoeffInitializer, generator, setup.Reinserter };
+        if (limit > 0) { gp.SetWorkerLimit([limit](size_t) { return limit; }); }
+        tf::Executor executor(threads);
+        Operon::RandomGenerator random { setup.Config.Seed };
+        gp.Run(executor, random);
+        std::vector<Operon::Scalar> fitness;
+        for (auto const& ind : gp.Parents()) { fitness.push_back(ind[0]); }
+        return fitness;
+    };
+
+    auto const expected = run(1);
+    CHECK(run(4) == expected);
+    CHECK(run(2) == expected);
+
+    // the active workers of a limited run take the offspring slots in turn
+    CHECK(run(4, 1) == expected);
+    CHECK(run(4, 3) == expected);
+
+    // the order in which the groups and the slots are handed out does not change the result
+    setup.Config.CostScheduling = false;
+    CHECK(run(4) == expected);
+    setup.Config.CostScheduling = true;
+
+    // the pooled generation depends on the timing of the workers, a deterministic run does not use it
+    setup.Config.PooledGeneration = true;
+    CHECK(run(4) == expected);
+
+    // every run resets the unique initializer, so that it does not reject the trees of the previous run
+    Operon::UniqueTreeInitializer uniqueInitializer { setup.TreeInitializer };
+    auto runUnique = [&]() {
+        setup.Evaluator.Reset();
+        Operon::GeneticProgrammingAlgorithm gp { setup.Problem, setup.Config, uniqueInitializer, setup.CoeffInitializer, generator, setup.Reinserter };
+        tf::Executor executor(1);
+        Operon::RandomGenerator random { setup.Config.Seed };
+        gp.Run(executor, random);
+        return std::pair{uniqueInitializer.Size(), uniqueInitializer.Rejected()};
+    };
+    auto const unique = runUnique();
+    CHECK(unique.first > 0);
+    CHECK(runUnique() == unique);
+}
+
+TEST_CASE("Pooled generation" * doctest::test_suite("[implementation]"))
+{
+    Util::SyntheticGpSetup setup;
+    Operon::BasicOffspringGenerator generator { setup.Evaluator, setup.Crossover, setup.ChangeFunction, setup.Selector, setup.Selector };
+    setup.Config.PooledGeneration = true;
+
+    // whichever worker produces a child, every generation fills each offspring slot but the one of the elite once,
+    // the workers beyond the limit do not take part
+    auto run = [&](size_t threads, size_t limit) {
+        setup.Evaluator.Reset();
+        tf::Executor executor(threads);
+        Operon::TaskTrace trace { executor };
+        Operon::GeneticProgrammingAlgorithm gp { setup.Problem, setup.Config, setup.TreeInitializer, setup.CoeffInitializer, generator, setup.Reinserter };
+        gp.SetTaskTrace(&trace);
+        if (limit > 0) { gp.SetWorkerLimit([limit](size_t) { return limit; }); }
+        Operon::RandomGenerator random { setup.Config.Seed };
+        gp.Run(executor, random);
+        CHECK(gp.Generation() == setup.Config.Generations);
+
+        auto const& loads = trace.Loads();
+        REQUIRE(loads.size() == setup.Config.Generations + 1);
+        for (auto g = 1UL; g < loads.size(); ++g) {
+            auto const offspring = std::transform_reduce(loads[g].begin(), loads[g].end(), size_t{0}, std::plus{}, [](auto const& l) { return l.Offspring; });
+            auto const producers = std::ranges::count_if(loads[g], [](auto const& l) { return l.Offspring > 0; });
+            CHECK(offspring == setup.Config.PoolSize - 1);
+            CHECK(producers <= static_cast<std::ptrdiff_t>(limit > 0 ? limit : threads));
+        }
+        CHECK(std::ranges::all_of(gp.Parents(), [](auto const& ind) { return std::isfinite(ind[0]); }));
+        // the children produced once the pool is full are evaluated and dropped
+        CHECK(setup.Evaluator.TotalEvaluations() >= setup.Config.PopulationSize + (setup.Config.Generations * (setup.Config.PoolSize - 1)));
+    };
+
+    run(1, 0);
+    run(4, 0);
+    run(4, 2);
+}
+
+TEST_CASE("Worker load" * doctest::test_suite("[implementation]"))
+{
+    // the busiest worker over the mean busy time
+    std::vector<Operon::WorkerLoad> loads(2);
+    loads[0].Busy = 1;
+    loads[1].Busy = 3;
+    CHECK(Operon::TaskTrace::Imbalance(loads) == doctest::Approx(1.5));
+    CHECK(Operon::TaskTrace::Imbalance({}) == 1);
+
+    Util::SyntheticGpSetup setup;
+    Operon::BasicOffspringGenerator generator { setup.Evaluator, setup.Crossover, setup.ChangeFunction, setup.Selector, setup.Selector };
+
+    // the initial population and every generation are marked, each offspring slot but the one of the elite is
+    // counted once for the worker that generated it
+    constexpr auto threads { 4UL };
+    tf::Executor executor(threads);
+    Operon::TaskTrace trace { executor };
+    Operon::GeneticProgrammingAlgorithm gp { setup.Problem, setup.Config, setup.TreeInitializer, setup.CoeffInitializer, generator, setup.Reinserter };
+    gp.SetTaskTrace(&trace);
+    Operon::RandomGenerator random { setup.Config.Seed };
+    gp.Run(executor, random);
+
+    auto const& generations = trace.Loads();
+    REQUIRE(generations.size() == setup.Config.Generations + 1);
+    for (auto g = 0UL; g < generations.size(); ++g) {
+        auto const& load = generations[g];
+        REQUIRE(load.size() == threads);
+        auto const offspring = std::transform_reduce(load.begin(), load.end(), size_t{0}, std::plus{}, [](auto const& l) { return l.Offspring; });
+        auto const tasks = std::transform_reduce(load.begin(), load.end(), size_t{0}, std::plus{}, [](auto const& l) { return l.Tasks; });
+        CHECK(offspring == (g == 0 ? 0 : setup.Config.PoolSize - 1));
+        CHECK(tasks > 0);
+        CHECK(std::ranges::all_of(load, [](auto const& l) { return l.Busy >= 0 && l.Idle >= 0; }));
+        CHECK(Operon::TaskTrace::Imbalance(load) >= 1);
+        CHECK(Operon::TaskTrace::Imbalance(load) <= static_cast<double>(threads));
+    }
+    CHECK(trace.Size() > 0);
+
+    // a header and one line per generation and worker
+    std::ostringstream out;
+    trace.WriteWorkerLoad(out);
+    auto const csv = out.str();
+    CHECK(csv.starts_with("generation,worker,busy,idle,tasks,offspring\n"));
+    CHECK(std::ranges::count(csv, '\n') == static_cast<std::ptrdiff_t>(1 + (generations.size() * threads)));
+
+    trace.Clear();
+    CHECK(trace.Size() == 0);
+    CHECK(trace.Loads().empty());
+}
+
+TEST_CASE("Pipelined NSGA2" * doctest::test_suite("[implementation]"))
+{
+    Util::SyntheticGpSetup setup;
+    Operon::LengthEvaluator lengthEvaluator { setup.Problem, setup.MaxLength };
+    Operon::MultiEvaluator evaluator { setup.Problem };
+    evaluator.Add(setup.Evaluator);
+    evaluator.Add(lengthEvaluator);
+
+    Operon::CrowdedComparison cc;
+    Operon::TournamentSelector selector { cc };
+    Operon::BasicOffspringGenerator generator { evaluator, setup.Crossover, setup.Mutator, selector, selector };
+    Operon::KeepBestReinserter reinserter { cc };
+    Operon::RankIntersectSorter sorter;
+
+    setup.Config.Deterministic = true;
+    setup.Config.PipelinedSorting = true;
+
+    // the fitness values of the final population and the number of generations
+    auto run = [&](size_t threads, size_t limit = 0) {
+        evaluator.Reset();
+        Operon::NSGA2 nsga2 { setup.Problem, setup.Config, setup.TreeInitializer, setup.CoeffInitializer, generator, reinserter, sorter };
+        if (limit > 0) { nsga2.SetWorkerLimit([limit](size_t) { return limit; }); }
+        tf::Executor executor(threads);
+        Operon::RandomGenerator random { setup.Config.Seed };
+        nsga2.Run(executor, random);
+        CHECK(nsga2.Generation() == setup.Config.Generations);
+        CHECK(!nsga2.Best().empty());
+        std::vector<Operon::Scalar> fitness;
+        for (auto const& ind : nsga2.Parents()) { fitness.insert(fitness.end(), ind.Fitness.begin(), ind.Fitness.end()); }
+        return fitness;
+    };
+
+    // the offspring generated ahead use the streams of their own generation
+    auto const expected = run(1);
+    CHECK(run(4) == expected);
+    CHECK(run(2) == expected);
+
+    // the active workers of a limited run take the offspring slots in turn and split the sort between them
+    CHECK(run(4, 1) == expected);
+    CHECK(run(4, 2) == expected);
+}
+
+TEST_CASE("Parallel broods" * doctest::test_suite("[implementation]"))
+{
+    Util::SyntheticGpSetup setup;
+    setup.Evaluator.SetStreaming(true); // the parallel members are evaluated without the buffer
+    Operon::BroodOffspringGenerator brood { setup.Evaluator, setup.Crossover, setup.ChangeVariable, setup.Selector, setup.Selector };
+    Operon::PolygenicOffspringGenerator polygenic { setup.Evaluator, setup.Crossover, setup.ChangeVariable, setup.Selector, setup.Selector };
+
+    setup.Config.Generations = 3;
+    setup.Config.PopulationSize = 50;
+    setup.Config.PoolSize = 50;
+    setup.Config.Deterministic = true;
+
+    // the members of the broods are generated by the workers of the executor running the algorithm: a worker that
+    // waits for them runs the members of other broods, each call keeps its own brood
+    auto run = [&](auto& generator, size_t threads, bool parallel) {
+        setup.Evaluator.Reset();
+        tf::Executor executor(threads);
+        generator.SetExecutor(parallel ? &executor : nullptr);
+        Operon::GeneticProgrammingAlgorithm gp { setup.Problem, setup.Config, setup.TreeInitializer, setup.CoeffInitializer, generator, setup.Reinserter };
+        Operon::RandomGenerator random { setup.Config.Seed };
+        gp.Run(executor, random);
+        generator.SetExecutor(nullptr);
+        std::vector<Operon::Scalar> fitness;
+        for (auto const& ind : gp.Parents()) { fitness.push_back(ind[0]); }
+        return fitness;
+    };
+
+    auto const expectedBrood = run(brood, 1, false);
+    CHECK(run(brood, 4, true) == expectedBrood);
+    CHECK(run(brood, 2, true) == expectedBrood);
+
+    auto const expectedPolygenic = run(polygenic, 1, false);
+    CHECK(run(polygenic, 4, true) == expectedPolygenic);
+
+    // called from a thread that is not a worker (eg. a loop of the user), the generator runs the brood on the executor
+    // and waits for it, the children are those of the serial brood
+    std::vector<Operon::Individual> pop(setup.Config.PopulationSize);
+    for (auto& ind : pop) {
+        ind.Genotype = setup.TreeInitializer(setup.Random);
+        ind.Fitness = setup.Evaluator(setup.Random, ind, {});
+    }
+    constexpr auto samples { 20 };
+    auto generate = [&](auto& generator, tf::Executor* executor) {
+        generator.SetExecutor(executor);
+        generator.Prepare(pop);
+        setup.Evaluator.Reset();
+        Operon::RandomGenerator random { setup.Config.Seed };
+        std::vector<Operon::Scalar> fitness;
+        for (auto i = 0; i < samples; ++i) {
+            auto child = generator(random, 1.0, 1.0, 0.0, {});
+            REQUIRE(child);
+            fitness.push_back((*child)[0]);
+        }
+        generator.SetExecutor(nullptr);
+        return std::pair{fitness, setup.Evaluator.TotalEvaluations()};
+    };
+    tf::Executor executor(4);
+    auto const serialBrood = generate(brood, nullptr);
+    CHECK(generate(brood, &executor) == serialBrood);
+    CHECK(serialBrood.second > 0);
+    CHECK(generate(polygenic, &executor) == generate(polygenic, nullptr));
+}
+
+TEST_CASE("Batched local search" * doctest::test_suite("[implementation]"))
+{
+    Util::SyntheticGpSetup setup;
+    Operon::LevenbergMarquardtOptimizer<Operon::DefaultDispatch, Operon::OptimizerType::Tiny> optimizer { setup.Table, setup.Problem };
+    optimizer.SetIterations(5);
+    Operon::CoefficientOptimizer localSearch { optimizer };
+    Operon::BasicOffspringGenerator generator { setup.Evaluator, setup.Crossover, setup.ChangeVariable, setup.Selector, setup.Selector, &localSearch };
+
+    setup.Config.Generations = 3;
+    setup.Config.PopulationSize = 50;
+    setup.Config.PoolSize = 50;
+    setup.Config.Deterministic = true;
+    setup.Config.BatchedLocalSearch = true;
+    setup.Config.LocalSearchProbability = 1.0;
+
+    Operon::GeneticProgrammingAlgorithm gp { setup.Problem, setup.Config, setup.TreeInitializer, setup.CoeffInitializer, generator, setup.Reinserter };
+    tf::Executor executor(4);
+    Operon::RandomGenerator random { setup.Config.Seed };
+    gp.Run(executor, random);
+
+    // the offspring are evaluated once, after their optimization (the elite is kept in the first slot)
+    auto const generations = gp.Generation();
+    CHECK(generations > 0);
+    CHECK(setup.Evaluator.CallCount.load() == setup.Config.PopulationSize + (generations * (setup.Config.PoolSize - 1)));
+
+    // the fitness of the individuals is the one of their optimized coefficients
+    for (auto ind : gp.Parents()) {
+        auto const fitness = ind[0];
+        CHECK(setup.Evaluator(setup.Random, ind, {})[0] == doctest::Approx(fitness));
+    }
+
+    // the active workers of a limited run take the groups of the local search in turn, the result is the same
+    auto fitness = [](auto const& algorithm) {
+        std::vector<Operon::Scalar> values;
+        for (auto const& ind : algorithm.Parents()) { values.push_back(ind[0]); }
+        return values;
+    };
+    auto const expected = fitness(gp);
+    for (auto limit : { 1UL, 3UL }) {
+        Operon::GeneticProgrammingAlgorithm limited { setup.Problem, setup.Config, setup.TreeInitializer, setup.CoeffInitializer, generator, setup.Reinserter };
+        limited.SetWorkerLimit([limit](size_t) { return limit; });
+        Operon::RandomGenerator r { setup.Config.Seed };
+        limited.Run(executor, r);
+        CHECK(fitness(limited) == expected);
+    }
+}
+
+TEST_CASE("Continued run" * doctest::test_suite("[implementation]"))
+{
+    // the first half of the rows, the second half is appended before the run is continued
+    constexpr auto nrows { 200 };
+    Util::SyntheticGpSetup setup { { .Rows = nrows, .DatasetRows = nrows / 2 } };
+    setup.Evaluator.SetIncrementalStatistics(10'000);
+    setup.Evaluator.SetStreaming(true);
+    Operon::BasicOffspringGenerator generator { setup.Evaluator, setup.Crossover, setup.ChangeVariable, setup.Selector, setup.Selector };
+
+    setup.Config.Generations = 3;
+    setup.Config.PopulationSize = 50;
+    setup.Config.PoolSize = 50;
+    setup.Config.Deterministic = true;
+
+    Operon::GeneticProgrammingAlgorithm gp { setup.Problem, setup.Config, setup.TreeInitializer, setup.CoeffInitializer, generator, setup.Reinserter };
+    tf::Executor executor(4);
+    Operon::RandomGenerator random { setup.Config.Seed };
+    gp.Run(executor, random);
+    REQUIRE(gp.Generation() > 0);
+    std::vector<Operon::Individual> const before(gp.Parents().begin(), gp.Parents().end());
+
+    (void) setup.Problem.AppendRows(Operon::Dataset::Matrix { setup.Data.bottomRows(nrows - (nrows / 2)).matrix() });
+    REQUIRE(setup.Problem.TrainingRange().Size() == static_cast<std::size_t>(nrows));
+    gp.Continue();
+    gp.Run(executor, random);
+    CHECK(gp.Generation() > 0);
+
+    // the evaluator keeps the statistics of the parents of the first run, which are only evaluated on the new rows
+    // - the residual evaluations on the new rows merge them, so a full evaluation gives the same fitness
+    Operon::Dataset const whole { Operon::Dataset::Matrix { setup.Data.matrix() } };
+    Operon::Problem reference { whole, { 0UL, whole.Rows<std::size_t>() }, { 0UL, 1UL } };
+    Operon::Evaluator<decltype(setup.Table)> fresh { reference, setup.Table };
+    for (auto ind : before) {
+        auto const incremental = setup.Evaluator(setup.Random, ind, {});
+        CHECK(incremental[0] == doctest::Approx(fresh(setup.Random, ind, {})[0]).epsilon(1e-4));
+    }
+    for (auto ind : gp.Parents()) {
+        auto const fitness = ind[0];
+        CHECK(fitness == doctest::Approx(fresh(setup.Random, ind, {})[0]).epsilon(1e-4));
+    }
+
+    // once their statistics cover all the rows, the parents are not evaluated again
+    auto const residual = setup.Evaluator.ResidualEvaluations.load();
+    for (auto ind : before) { (void) setup.Evaluator(setup.Random, ind, {}); }
+    CHECK(setup.Evaluator.ResidualEvaluations.load() == residual);
+}
+
+TEST_CASE("Concurrent runs" * doctest::test_suite("[implementation]"))
+{
+    Util::SyntheticGpSetup setup;
+    setup.Config.Deterministic = true;
+
+    // a run with its own operators (like each run of operon_gp --runs), the fitness values of the final population
+    auto run = [&](size_t i, size_t threads) {
+        Operon::UniformTreeInitializer treeInitializer { setup.Creator };
+        treeInitializer.ParameterizeDistribution(2, setup.MaxLength);
+        treeInitializer.SetMaxDepth(setup.MaxDepth);
+        Operon::UniqueTreeInitializer uniqueInitializer { treeInitializer };
+        Operon::Evaluator<decltype(setup.Table)> evaluator { setup.Problem, setup.Table };
+        Operon::TournamentSelector selector { Operon::SingleObjectiveComparison { 0 } };
+        Operon::BasicOffspringGenerator generator { evaluator, setup.Crossover, setup.ChangeFunction, selector, selector };
+        Operon::KeepBestReinserter reinserter { Operon::SingleObjectiveComparison { 0 } };
+        Operon::GeneticProgrammingAlgorithm gp { setup.Problem, setup.Config, uniqueInitializer, setup.CoeffInitializer, generator, reinserter };
+        tf::Executor executor(threads);
+        Operon::RandomGenerator random { setup.Config.Seed + i };
+        gp.Run(executor, random);
+        std::vector<Operon::Scalar> fitness;
+        for (auto const& ind : gp.Parents()) { fitness.push_back(ind[0]); }
+        return fitness;
+    };
+
+    // the runs on their own threads and executors give the results of the runs one after the other
+    constexpr auto runs { 4UL };
+    std::vector<std::vector<Operon::Scalar>> expected;
+    for (auto i = 0UL; i < runs; ++i) { expected.push_back(run(i, 1)); }
+    CHECK(expected.front() != expected.back());
+
+    std::vector<std::vector<Operon::Scalar>> concurrent(runs);
+    std::vector<std::thread> threads;
+    for (auto i = 0UL; i < runs; ++i) {
+        threads.emplace_back([&, i]() { concurrent[i] = run(i, 2); });
+    }
+    for (auto& t : threads) { t.join(); }
+    CHECK(concurrent == expected);
+}
+
+TEST_CASE("Shared worker limit" * doctest::test_suite("[implementation]"))
+{
+#if defined(__unix__) || defined(__APPLE__)
+    // the copies of a load average limit (one per run) do not give the same cores to two runs
+    constexpr auto cores { 4UL };
+    Operon::LoadAverageLimit const limit { cores };
+    Operon::LoadAverageLimit first { limit };
+    Operon::LoadAverageLimit second { limit };
+    auto const a = first(cores);
+    auto const b = second(cores);
+    CHECK(a >= 1);
+    CHECK(a <= cores);
+    CHECK(b >= 1);
+    CHECK(b <= std::max(cores - a, 1UL));
+#endif
+}
+
+TEST_CASE("Memory accounting" * doctest::test_suite("[implementation]"))
+{
+    SUBCASE("plan") {
+        constexpr auto rows { 100'000UL };
+        constexpr auto coefficients { 20UL };
+        Operon::MemoryRequirements const requirements { .Fixed = 1UL << 20U, .Workers = 4, .Rows = rows, .Coefficients = coefficients, .GroupSize = 16 };
+        auto const column = rows * sizeof(Operon::Scalar);
+        auto const full = requirements.Fixed + (requirements.Workers * (column + column + Operon::FullJacobianBytes(rows, coefficients)));
+
+        // a large limit keeps the preferred choices
+        auto plan = Operon::PlanMemory(requirements, std::numeric_limits<std::size_t>::max());
+        CHECK(plan.Fits);
+        CHECK(plan.GroupSize == 16);
+        CHECK(!plan.BlockedJacobian);
+
+        // the group size is reduced first
+        plan = Operon::PlanMemory(requirements, full);
+        CHECK(plan.Fits);
+        CHECK(plan.GroupSize == 1);
+        CHECK(!plan.BlockedJacobian);
+        CHECK(plan.Bytes == full);
+
+        // then the jacobian is blocked, with the largest block that fits
+        plan = Operon::PlanMemory(requirements, full - 1);
+        CHECK(plan.Fits);
+        CHECK(plan.GroupSize == 1);
+        CHECK(plan.BlockedJacobian);
+        CHECK(plan.BlockSize == requirements.BlockSize);
+        CHECK(plan.Bytes < full);
+
+        // a limit below the fixed memory returns the smallest choices
+        plan = Operon::PlanMemory(requirements, requirements.Fixed);
+        CHECK(!plan.Fits);
+        CHECK(plan.BlockSize == Operon::MinJacobianBlockSize);
+    }
+
+    SUBCASE("run") {
+        constexpr auto nrows { 200 };
+        Util::SyntheticGpSetup setup { { .Rows = nrows } };
+        Operon::LevenbergMarquardtOptimizer<Operon::DefaultDispatch, Operon::OptimizerType::NormalEquations> optimizer { setup.Table, setup.Problem };
+        optimizer.SetIterations(2);
+        Operon::CoefficientOptimizer localSearch { optimizer };
+        Operon::BasicOffspringGenerator generator { setup.Evaluator, setup.Crossover, setup.ChangeVariable, setup.Selector, setup.Selector, &localSearch };
+
+        setup.Config.Generations = 2;
+        setup.Config.PopulationSize = 50;
+        setup.Config.PoolSize = 50;
+
+        Operon::GeneticProgrammingAlgorithm gp { setup.Problem, setup.Config, setup.TreeInitializer, setup.CoeffInitializer, generator, setup.Reinserter };
+        CHECK(gp.GetMemoryUsage().Buffers == 0);
+        tf::Executor executor(2);
+        Operon::RandomGenerator random { setup.Config.Seed };
+        gp.Run(executor, random);
+
+        auto const usage = gp.GetMemoryUsage();
+        CHECK(usage.Dataset == nrows * 3 * sizeof(Operon::Scalar));
+        CHECK(usage.Population >= (setup.Config.PopulationSize + setup.Config.PoolSize) * sizeof(Operon::Individual));
+        CHECK(usage.Buffers >= nrows * sizeof(Operon::Scalar));
+        CHECK(usage.Jacobian > 0);
+        CHECK(usage.Total() == usage.Dataset + usage.Population + usage.Buffers + usage.Jacobian);
+
+        // the copies of a tree share its nodes, which are counted once
+        std::vector<Operon::Individual> copies(10, gp.Individuals().front());
+        auto const& first = std::as_const(copies.front());
+        auto const nodes = first.Genotype.Nodes().capacity() * sizeof(Operon::Node);
+        auto const fitness = first.Fitness.capacity() * sizeof(Operon::Scalar);
+        CHECK(Operon::GeneticProgrammingAlgorithm::PopulationBytes(copies) == copies.size() * (sizeof(Operon::Individual) + fitness) + nodes);
+        copies.back().Genotype.Nodes().front().Value += 1; // a private copy of the nodes
+        CHECK(Operon::GeneticProgrammingAlgorithm::PopulationBytes(copies) > copies.size() * (sizeof(Operon::Individual) + fitness) + nodes);
+
+        // the blocked optimizer only holds one block of the jacobian
+        optimizer.SetBlockSize(nrows / 4);
+        CHECK(optimizer.WorkingMemory(setup.MaxLength) == Operon::BlockedJacobianBytes(nrows / 4, setup.MaxLength));
+        CHECK(optimizer.WorkingMemory(setup.MaxLength) < Operon::FullJacobianBytes(nrows, setup.MaxLength));
+    }
+}
+
+} // namespace Operon::Test
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: MIT
 // SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
 
+#include <cmath>
 #include <doctest/doctest.h>
 #include <fmt/ranges.h>
 
@@ -54,4 +55,72 @@ namespace Operon::Test {
         DT dt4(std::move(map));
         check(dt4, "exp(log(10))", std::exp(std::log(10.f)));
     }
+
+    TEST_CASE("built-in lookup" * dt::test_suite("dispatch_table")) {
+        using DT = Operon::DispatchTable<Operon::Scalar>;
+        DT dt;
+
+        // the built-in types are resolved to the same callables as through the map
+        for (auto type : { NodeType::Add, NodeType::Mul, NodeType::Exp, NodeType::Sqrt }) {
+            Node const node(type);
+            CHECK(dt.TryGetFunctionPtr<Operon::Scalar>(node) == dt.TryGetFunctionPtr<Operon::Scalar>(node.HashValue));
+            CHECK(dt.TryGetDerivativePtr<Operon::Scalar>(node) == dt.TryGetDerivativePtr<Operon::Scalar>(node.HashValue));
+        }
+        CHECK(dt.TryGetFunctionPtr<Operon::Scalar>(Node(NodeType::Dynamic)) == nullptr);
+
+        // dynamic nodes go through the map
+        auto& map = dt.GetMap();
+        Node const dyn(NodeType::Dynamic, Operon::Hash{1234}); // NOLINT
+        map[dyn.HashValue] = map.find(Node(NodeType::Add).HashValue)->second;
+        CHECK(dt.TryGetFunctionPtr<Operon::Scalar>(dyn) == dt.TryGetFunctionPtr<Operon::Scalar>(dyn.HashValue));
+        CHECK(dt.TryGetFunctionPtr<Operon::Scalar>(dyn) != nullptr);
+
+        // the index follows the map after elements are erased
+        map.erase(Node(NodeType::Add).HashValue);
+        CHECK(dt.TryGetFunctionPtr<Operon::Scalar>(Node(NodeType::Add)) == nullptr);
+        CHECK(dt.TryGetFunctionPtr<Operon::Scalar>(Node(NodeType::Mul)) == dt.TryGetFunctionPtr<Operon::Scalar>(Node(NodeType::Mul).HashValue));
+    }
+
+    TEST_CASE("dynamic primitives" * dt::test_suite("dispatch_table")) {
+        using DT = Operon::DispatchTable<Operon::Scalar>;
+        using TInterpreter = Operon::Interpreter<Operon::Scalar, DT>;
+
+        auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+        auto const range = Range{0, ds.Rows<std::size_t>()};
+        auto const x1 = ds.GetVariable("X1")->Hash;
+        auto const x2 = ds.GetVariable("X2")->Hash;
+
+        // f(a, b) = a * exp(b), compared with the same expression made of built-in primitives
+        constexpr Operon::Hash hash{1234};
+        DT dt;
+        dt.RegisterPrimitive(hash,
+            [](auto result, auto args) {
+                for (auto i = 0UL; i < result.size(); ++i) { result[i] = args[0][i] * std::exp(args[1][i]); }
+            },
+            [](auto result, auto args, auto k, auto partial) {
+                for (auto i = 0UL; i < result.size(); ++i) { partial[i] = k == 0 ? std::exp(args[1][i]) : result[i]; }
+            });
+
+        Node dyn(NodeType::Dynamic, hash);
+        dyn.Arity = 2;
+        Tree dynamic{ Node(NodeType::Variable, x2), Node(NodeType::Variable, x1), dyn };
+        Tree builtin{ Node(NodeType::Variable, x2), Node(NodeType::Exp), Node(NodeType::Variable, x1), Node(NodeType::Mul) };
+        dynamic.UpdateNodes();
+        builtin.UpdateNodes();
+
+        Operon::Vector<Operon::Scalar> coeff{ 0.5, 2.0 }; // NOLINT
+        auto close = [](auto const& a, auto const& b) {
+            return std::ranges::equal(a, b, [](auto x, auto y) { return std::abs(x - y) <= 1e-5 * std::max(Operon::Scalar{1}, std::abs(y)); });
+        };
+        CHECK(close(TInterpreter{dt, ds, dynamic}.Evaluate(coeff, range), TInterpreter{dt, ds, builtin}.Evaluate(coeff, range)));
+        CHECK(close(TInterpreter{dt, ds, dynamic}.JacRev(coeff, range).reshaped(), TInterpreter{dt, ds, builtin}.JacRev(coeff, range).reshaped()));
+
+        // without a derivative the tree can be evaluated but not differentiated
+        DT nodiff;
+        nodiff.RegisterPrimitive(hash, [](auto result, auto args) {
+            for (auto i = 0UL; i < result.size(); ++i) { result[i] = args[0][i] * std::exp(args[1][i]); }
+        });
+        CHECK(close(TInterpreter{nodiff, ds, dynamic}.Evaluate(coeff, range), TInterpreter{dt, ds, dynamic}.Evaluate(coeff, range)));
+        CHECK_THROWS_AS(TInterpreter{nodiff, ds, dynamic}.JacRev(coeff, range), std::runtime_error);
+    }
 } // namespace Operon::Test
@@ -4,14 +4,17 @@
 #include <algorithm>
 #include <doctest/doctest.h>
 #include <Eigen/Core>
+#include <taskflow/taskflow.hpp>
 
 #include "operon/analyzers/diversity.hpp"
+#include "operon/analyzers/population_statistics.hpp"
 #include "operon/core/dataset.hpp"
 #include "operon/core/problem.hpp"
 #include "operon/core/pset.hpp"
 #include "operon/core/tree.hpp"
 #include "operon/operators/creator.hpp"
 #include "operon/operators/initializer.hpp"
+#include "operon/random/random.hpp"
 
 namespace Operon::Test {
 
@@ -52,6 +55,68 @@ TEST_CASE("diversity")
 
     PopulationDiversityAnalyzer<Tree> diversityAnalyzer;
     diversityAnalyzer.Prepare(trees);
+
+    SUBCASE("approximate")
+    {
+        Operon::Span<Tree> sample{trees.data(), 300};
+        Operon::RandomGenerator unused{0};
+        PopulationDiversityAnalyzer<Tree> exact;
+        exact.Prepare(sample);
+        ApproximateDiversityAnalyzer<Tree> approximate;
+        approximate.Prepare(sample);
+        CHECK(std::abs(exact(unused) - approximate(unused)) < 0.02);
+
+        // copies of a tree are their nearest neighbours
+        std::vector<Tree> copies(sample.begin(), sample.begin() + 10);
+        copies.insert(copies.end(), sample.begin(), sample.begin() + 10);
+        approximate.Prepare(copies);
+        auto const nearest = approximate.NearestNeighbourDistances();
+        CHECK(std::ranges::all_of(nearest, [](auto d) { return d == 0; }));
+    }
+}
+
+TEST_CASE("Population statistics" * doctest::test_suite("[implementation]"))
+{
+    PrimitiveSet grammar;
+    grammar.SetConfig(PrimitiveSet::Arithmetic);
+    Operon::RandomGenerator rd(1234);
+
+    Eigen::Matrix<Operon::Scalar, -1, -1> values(1, 2);
+    values << 1, 1; // don't care
+    Dataset ds(values);
+    BalancedTreeCreator btc(grammar, ds.VariableHashes());
+
+    constexpr size_t nInds = 5000; // several blocks
+    std::vector<Individual> pop(nInds);
+    for (auto i = 0UL; i < nInds; ++i) {
+        pop[i].Genotype = btc(rd, 1 + (i % 50), 1, 100);
+        pop[i][0] = static_cast<Operon::Scalar>(Operon::Random::Uniform(rd, 0.0, 1.0));
+    }
+    pop[1234][0] = -1; // the best one
+    pop[4321][0] = -1; // a tie, the first one is kept
+
+    tf::Executor executor(4);
+    auto const serial = ComputePopulationStatistics(pop, 0);
+    auto const parallel = ComputePopulationStatistics(pop, 0, executor);
+
+    CHECK(serial.Best == 1234);
+    CHECK(parallel.Best == 1234);
+    CHECK(serial.Fitness.Min == -1);
+    CHECK(serial.Fitness.Count == nInds);
+    CHECK(parallel.Fitness.Mean == serial.Fitness.Mean);
+    CHECK(parallel.Length.Variance == serial.Length.Variance);
+
+    double length{0};
+    double complexity{0};
+    std::size_t maxDepth{0};
+    for (auto const& ind : pop) {
+        length += static_cast<double>(ind.Genotype.Length());
+        complexity += static_cast<double>(ind.Genotype.VisitationLength());
+        maxDepth = std::max(maxDepth, ind.Genotype.Depth());
+    }
+    CHECK(serial.Length.Mean == doctest::Approx(length / nInds));
+    CHECK(serial.Complexity.Mean == doctest::Approx(complexity / nInds));
+    CHECK(serial.Depth.Max == static_cast<double>(maxDepth));
 }
 
 } // namespace Operon::Test
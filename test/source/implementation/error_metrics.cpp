@@ -6,7 +6,10 @@
 
 #include <fmt/ranges.h>
 
+#include "operon/error_metrics/error_accumulator.hpp"
 #include "operon/error_metrics/error_metrics.hpp"
+#include "operon/error_metrics/vectorized.hpp"
+#include "operon/operators/evaluator.hpp"
 
 namespace dt = doctest;
 
@@ -124,4 +127,87 @@ namespace Operon::Test {
         }
     }
 
+    TEST_CASE("streaming error statistics" * dt::test_suite("[implementation]"))
+    {
+        auto const n{1000UL};
+        std::vector<Operon::Scalar> x(n);
+        std::vector<Operon::Scalar> y(n);
+
+        Operon::RandomGenerator rng{1234}; // NOLINT
+        std::uniform_real_distribution<Operon::Scalar> ureal(0, 1);
+        for (auto i = 0UL; i < n; ++i) {
+            x[i] = ureal(rng);
+            y[i] = 2 * x[i] + ureal(rng); // NOLINT
+        }
+
+        // accumulate blocks of uneven size and merge them
+        ErrorAccumulator stats;
+        for (auto i = 0UL; i < n; i += 77) { // NOLINT
+            auto const m = std::min(77UL, n - i); // NOLINT
+            ErrorAccumulator block;
+            block(Operon::Span<Operon::Scalar const>{x.data() + i, m}, Operon::Span<Operon::Scalar const>{y.data() + i, m});
+            stats.Merge(block);
+        }
+        CHECK(stats.Count() == doctest::Approx(n));
+
+        auto [a, b] = FitLeastSquares(Operon::Span<Operon::Scalar const>{x}, Operon::Span<Operon::Scalar const>{y});
+        auto [sa, sb] = stats.LinearScaling();
+        CHECK(sa == doctest::Approx(a).epsilon(1e-4));
+        CHECK(sb == doctest::Approx(b).epsilon(1e-4));
+
+        // single-pass scaling with the target statistics precomputed
+        Operon::TargetStatistics const target{Operon::Span<Operon::Scalar const>{y}};
+        CHECK(target.Matches(Operon::Span<Operon::Scalar const>{y}));
+        auto [ta, tb] = FitLeastSquares(Operon::Span<Operon::Scalar const>{x}, Operon::Span<Operon::Scalar const>{y}, target);
+        CHECK(ta == doctest::Approx(a).epsilon(1e-6));
+        CHECK(tb == doctest::Approx(b).epsilon(1e-6));
+
+        std::vector<Operon::Scalar> z(n);
+        std::ranges::transform(x, z.begin(), [&](auto v) { return static_cast<Operon::Scalar>(a * v + b); });
+
+        for (auto t : { ErrorType::SSE, ErrorType::MSE, ErrorType::NMSE, ErrorType::RMSE, ErrorType::MAE, ErrorType::R2, ErrorType::C2 }) {
+            ErrorMetric metric{t};
+            CHECK(metric(stats) == doctest::Approx(metric(x, y)).epsilon(1e-4));
+            if (metric.SupportsStatistics(/*scaled=*/true)) {
+                CHECK(metric(stats, /*scaled=*/true) == doctest::Approx(metric(z, y)).epsilon(1e-3));
+            }
+        }
+    }
+
+    TEST_CASE_TEMPLATE("vectorized error metrics", T, float, double)
+    {
+        // the size is not a multiple of the register width, so the scalar tail is exercised as well
+        auto const n{10007UL};
+        std::vector<T> x(n);
+        std::vector<T> y(n);
+        std::vector<T> w(n);
+
+        Operon::RandomGenerator rng{1234}; // NOLINT
+        std::uniform_real_distribution<T> ureal(0, 1);
+        for (auto i = 0UL; i < n; ++i) {
+            x[i] = ureal(rng);
+            y[i] = x[i] + ureal(rng);
+            w[i] = ureal(rng);
+        }
+
+        using std::cbegin;
+        using std::cend;
+        using S = Operon::Span<T const>;
+        auto constexpr eps{1e-4};
+
+        CHECK(Vectorized::SumOfSquaredErrors(S{x}, S{y}) == doctest::Approx(SumOfSquaredErrors(cbegin(x), cend(x), cbegin(y))).epsilon(eps));
+        CHECK(Vectorized::MeanSquaredError(S{x}, S{y}) == doctest::Approx(MeanSquaredError(cbegin(x), cend(x), cbegin(y))).epsilon(eps));
+        CHECK(Vectorized::NormalizedMeanSquaredError(S{x}, S{y}) == doctest::Approx(NormalizedMeanSquaredError(cbegin(x), cend(x), cbegin(y))).epsilon(eps));
+        CHECK(Vectorized::MeanAbsoluteError(S{x}, S{y}) == doctest::Approx(MeanAbsoluteError(cbegin(x), cend(x), cbegin(y))).epsilon(eps));
+        CHECK(Vectorized::R2Score(S{x}, S{y}) == doctest::Approx(R2Score(cbegin(x), cend(x), cbegin(y))).epsilon(eps));
+        CHECK(Vectorized::CorrelationCoefficient(S{x}, S{y}) == doctest::Approx(CorrelationCoefficient(cbegin(x), cend(x), cbegin(y))).epsilon(eps));
+
+        CHECK(Vectorized::SumOfSquaredErrors(S{x}, S{y}, S{w}) == doctest::Approx(SumOfSquaredErrors(cbegin(x), cend(x), cbegin(y), cbegin(w))).epsilon(eps));
+        CHECK(Vectorized::MeanSquaredError(S{x}, S{y}, S{w}) == doctest::Approx(MeanSquaredError(cbegin(x), cend(x), cbegin(y), cbegin(w))).epsilon(eps));
+        CHECK(Vectorized::NormalizedMeanSquaredError(S{x}, S{y}, S{w}) == doctest::Approx(NormalizedMeanSquaredError(cbegin(x), cend(x), cbegin(y), cbegin(w))).epsilon(eps));
+        CHECK(Vectorized::MeanAbsoluteError(S{x}, S{y}, S{w}) == doctest::Approx(MeanAbsoluteError(cbegin(x), cend(x), cbegin(y), cbegin(w))).epsilon(eps));
+        CHECK(Vectorized::R2Score(S{x}, S{y}, S{w}) == doctest::Approx(R2Score(cbegin(x), cend(x), cbegin(y), cbegin(w))).epsilon(eps));
+        CHECK(Vectorized::CorrelationCoefficient(S{x}, S{y}, S{w}) == doctest::Approx(CorrelationCoefficient(cbegin(x), cend(x), cbegin(y), cbegin(w))).epsilon(eps));
+    }
+
 } // namespace Operon::Test
@@ -2,19 +2,45 @@
 // SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
 //
 #include "../operon_test.hpp"
+#include "operon/algorithms/solution_archive.hpp"
+#include "operon/core/coreset.hpp"
 #include "operon/core/dataset.hpp"
+#include "operon/core/dataset_codes.hpp"
+#include "operon/core/dataset_tiles.hpp"
 #include "operon/core/types.hpp"
 #include "operon/error_metrics/mean_squared_error.hpp"
 #include "operon/formatter/formatter.hpp"
+#include "operon/interpreter/approximate_dispatch.hpp"
+#include "operon/interpreter/batch_tuning.hpp"
+#include "operon/interpreter/cost_model.hpp"
+#include "operon/interpreter/cpu_dispatch.hpp"
+#include "operon/interpreter/dag_interpreter.hpp"
 #include "operon/interpreter/interpreter.hpp"
+#include "operon/interpreter/interval.hpp"
+#include "operon/interpreter/gpu_interpreter.hpp"
+#include "operon/interpreter/jit.hpp"
+#include "operon/operators/async_evaluator.hpp"
 #include "operon/operators/creator.hpp"
+#include "operon/operators/distributed_evaluator.hpp"
 #include "operon/operators/evaluator.hpp"
+#include "operon/operators/gpu_evaluator.hpp"
+#include "operon/operators/local_search.hpp"
+#include "operon/operators/throughput.hpp"
 #include "operon/optimizer/likelihood/gaussian_likelihood.hpp"
 #include "operon/optimizer/likelihood/poisson_likelihood.hpp"
+#include "operon/optimizer/gpu_optimizer.hpp"
 #include "operon/optimizer/optimizer.hpp"
 #include "operon/optimizer/solvers/sgd.hpp"
 #include "operon/parser/infix.hpp"
 #include <doctest/doctest.h>
+#include <filesystem>
+#include <future>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <taskflow/taskflow.hpp>
+#include <thread>
 #include <utility>
 
 namespace Operon::Test {
@@ -230,7 +256,2091 @@ TEST_CASE("Batch evaluation")
     }
 
     Operon::EvaluateTrees(trees, ds, range, {result.data(), result.size()});
-    Operon::EvaluateTrees(trees, ds, range);
+    auto values = Operon::EvaluateTrees(trees, ds, range);
+
+    // the tiled evaluation must match the per-tree evaluation
+    for (auto i = 0; i < n; ++i) {
+        auto expected = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>::Evaluate(trees[i], ds, range);
+        CHECK(std::ranges::equal(expected, values[i]));
+        CHECK(std::ranges::equal(expected, std::span{result}.subspan(i * range.Size(), range.Size())));
+    }
+
+    // repeated scoring calls reuse the same thread pool
+    Operon::ScoringSession session{2};
+    for (auto k = 0; k < 3; ++k) {
+        CHECK(session.Evaluate(trees, ds, range) == values);
+    }
+
+    // the convenience methods share one dispatch table, created on first use
+    CHECK(&Operon::SharedDispatchTable() == &Operon::SharedDispatchTable<Operon::DefaultDispatch>());
+    CHECK(Operon::SharedDispatchTable().Contains(Node(NodeType::Add).HashValue));
+}
+
+TEST_CASE("Subexpression sharing")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, ds.VariableHashes()};
+
+    Operon::RandomGenerator rng{0};
+    auto constexpr n{10};
+
+    std::vector<Operon::Tree> trees;
+    for (auto i = 0; i < n; ++i) {
+        trees.push_back(creator(rng, 20, 1, 10));
+    }
+    // add some duplicates and trees sharing a subtree
+    trees.push_back(trees.front());
+    auto t = trees[1];
+    t.Nodes().push_back(Operon::Node(Operon::NodeType::Exp));
+    t.UpdateNodes();
+    trees.push_back(t);
+
+    std::vector<std::reference_wrapper<Operon::Tree const>> refs(trees.begin(), trees.end());
+    Operon::DefaultDispatch dtable;
+    Operon::DagInterpreter<Operon::Scalar, Operon::DefaultDispatch> dag{dtable, ds, refs};
+    CHECK(dag.VertexCount() < dag.NodeCount());
+
+    auto values = dag.Evaluate(range);
+    for (auto i = 0UL; i < trees.size(); ++i) {
+        auto expected = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>::Evaluate(trees[i], ds, range);
+        auto actual = std::span{values}.subspan(i * range.Size(), range.Size());
+        CHECK(std::ranges::equal(expected, actual, [](auto a, auto b) { return (std::isnan(a) && std::isnan(b)) || a == b || std::abs(a - b) <= 1e-5 * std::abs(b); }));
+    }
+}
+
+TEST_CASE("Subtree value cache")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, ds.VariableHashes()};
+    Operon::RandomGenerator rng{0};
+    Operon::DefaultDispatch dtable;
+    using TInterpreter = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+
+    auto eq = [](auto const& a, auto const& b) { return std::ranges::equal(a, b, [](auto x, auto y) { return (std::isnan(x) && std::isnan(y)) || x == y || std::abs(x - y) <= 1e-5 * std::abs(y); }); };
+
+    Operon::SubtreeValueCache<Operon::Scalar> cache{ 100 * range.Size(), /*minLength=*/2 };
+    auto parent = creator(rng, 30, 1, 10);
+    std::vector<Operon::Scalar> result(range.Size());
+    TInterpreter{dtable, ds, parent}.Evaluate({}, range, result, cache);
+    CHECK(cache.Size() > 0);
+    CHECK(eq(result, TInterpreter::Evaluate(parent, ds, range)));
+
+    // change the first leaf, the other subtrees should be taken from the cache
+    auto child = parent;
+    child[0].Value += 1;
+    TInterpreter{dtable, ds, child}.Evaluate({}, range, result, cache);
+    CHECK(eq(result, TInterpreter::Evaluate(child, ds, range)));
+}
+
+TEST_CASE("Fitness cache")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::Problem problem{ds, range, range};
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, problem.GetInputs()};
+
+    Operon::RandomGenerator rng{0};
+    Operon::DefaultDispatch dtable;
+    Operon::Evaluator<Operon::DefaultDispatch> evaluator{problem, dtable};
+    evaluator.SetCacheCapacity(1'000);
+
+    Operon::Individual ind;
+    ind.Genotype = creator(rng, 20, 1, 10);
+
+    auto f1 = evaluator(rng, ind, {});
+    auto f2 = evaluator(rng, ind, {});
+    CHECK(f1 == f2);
+    CHECK(evaluator.ResidualEvaluations == 1);
+    CHECK(evaluator.CacheHits == 1);
+    CHECK(evaluator.CacheMisses == 1);
+
+    // a different coefficient value must produce a cache miss
+    auto coeff = ind.Genotype.GetCoefficients();
+    coeff.front() += 1;
+    ind.Genotype.SetCoefficients(coeff);
+    (void) evaluator(rng, ind, {});
+    CHECK(evaluator.ResidualEvaluations == 2);
+    CHECK(evaluator.CacheMisses == 2);
+}
+
+TEST_CASE("Parallel diversity preparation")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::Problem problem{ds, range, range};
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, problem.GetInputs()};
+    Operon::RandomGenerator rng{0};
+
+    std::vector<Operon::Individual> pop(200);
+    for (auto& ind : pop) { ind.Genotype = creator(rng, 20, 1, 10); }
+
+    Operon::DiversityEvaluator serial{problem};
+    serial.Prepare(pop);
+
+    // prepared from inside a worker of the executor, as in the GP loop
+    tf::Executor executor(4);
+    Operon::DiversityEvaluator parallel{problem};
+    parallel.SetExecutor(&executor);
+    tf::Taskflow taskflow;
+    taskflow.emplace([&]() { parallel.Prepare(pop); });
+    executor.run(taskflow).wait();
+
+    for (auto i = 0; i < 10; ++i) {
+        Operon::RandomGenerator r1{static_cast<uint64_t>(i)};
+        Operon::RandomGenerator r2{static_cast<uint64_t>(i)};
+        CHECK(serial(r1, pop[i], {}) == parallel(r2, pop[i], {}));
+    }
+
+    // prepared again with half of the trees, the fingerprints of the others are reused
+    std::vector<Operon::Individual> next(pop.begin(), pop.begin() + 100);
+    for (auto i = 0; i < 100; ++i) { next.emplace_back().Genotype = creator(rng, 20, 1, 10); }
+    serial.Prepare(next);
+    parallel.Prepare(next);
+    Operon::RandomGenerator r1{1};
+    Operon::RandomGenerator r2{1};
+    CHECK(serial(r1, next.back(), {}) == parallel(r2, next.back(), {}));
+}
+
+TEST_CASE("Incremental statistics")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto const rows = ds.Rows();
+    auto const half = rows / 2;
+
+    // the first half of the rows, the second half arrives later
+    Dataset head{Dataset::Matrix{ds.Values().topRows(half)}};
+    head.SetVariableNames(ds.VariableNames());
+    Operon::Problem problem{head, Range{0, static_cast<std::size_t>(half)}, Range{0, static_cast<std::size_t>(half)}};
+    Operon::Problem reference{ds, Range{0, static_cast<std::size_t>(rows)}, Range{0, static_cast<std::size_t>(rows)}};
+
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, problem.GetInputs()};
+    Operon::RandomGenerator rng{0};
+    Operon::DefaultDispatch dtable;
+
+    Operon::Evaluator<Operon::DefaultDispatch> evaluator{problem, dtable};
+    evaluator.SetIncrementalStatistics(1'000);
+    Operon::Evaluator<Operon::DefaultDispatch> full{reference, dtable};
+
+    std::vector<Operon::Individual> individuals(10);
+    for (auto& ind : individuals) {
+        ind.Genotype = creator(rng, 20, 1, 10);
+        (void) evaluator(rng, ind, {});
+    }
+    CHECK(evaluator.ResidualEvaluations == individuals.size());
+
+    auto const appended = problem.AppendRows(ds.Values().bottomRows(rows - half));
+    CHECK(appended.Start() == static_cast<std::size_t>(half));
+    CHECK(problem.TrainingRange().End() == static_cast<std::size_t>(rows));
+    CHECK(problem.GetDataset().Values().isApprox(ds.Values()));
+
+    // the trees evaluated before are only evaluated on the new rows
+    for (auto& ind : individuals) {
+        auto const f = evaluator(rng, ind, {});
+        auto const g = full(rng, ind, {});
+        CHECK(f.front() == doctest::Approx(g.front()).epsilon(1e-4));
+    }
+    CHECK(evaluator.ResidualEvaluations == 2 * individuals.size());
+
+    // the statistics already cover the whole training range
+    (void) evaluator(rng, individuals.front(), {});
+    CHECK(evaluator.ResidualEvaluations == 2 * individuals.size());
+
+    // the predictions asked for are written to the buffer, the tree is then evaluated over all the rows
+    auto& ind = individuals.front();
+    Operon::Vector<Operon::Scalar> buf(problem.TrainingRange().Size());
+    Operon::Vector<Operon::Scalar> expected(buf.size());
+    auto const f = evaluator(rng, ind, buf);
+    CHECK(evaluator.ResidualEvaluations == 2 * individuals.size() + 1);
+    CHECK(f.front() == doctest::Approx(full(rng, ind, expected).front()).epsilon(1e-4));
+    CHECK(std::ranges::equal(buf, expected, [](auto a, auto b) { return a == doctest::Approx(b).epsilon(1e-4); }));
+
+    // unless the error is streamed, which leaves the buffer untouched
+    evaluator.SetStreaming(true);
+    std::ranges::fill(buf, Operon::Scalar{0});
+    (void) evaluator(rng, ind, buf);
+    CHECK(evaluator.ResidualEvaluations == 2 * individuals.size() + 1);
+    CHECK(std::ranges::all_of(buf, [](auto v) { return v == 0; }));
+
+    // the tiles and codes of the dataset before the new rows are not read anymore (the tape checks their rows)
+    {
+        using TInterpreter = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+        Operon::DatasetTiles const tiles{head, TInterpreter::BatchSize};
+        Operon::DatasetCodes const codes{head};
+        auto const coeff = ind.Genotype.GetCoefficients();
+        auto const range = problem.TrainingRange();
+        TInterpreter tiled{dtable, problem.GetDataset(), ind.Genotype};
+        tiled.SetTiles(&tiles);
+        tiled.SetCodes(&codes);
+        auto const plain = TInterpreter{dtable, problem.GetDataset(), ind.Genotype}.Evaluate(coeff, range);
+        CHECK(tiled.Evaluate(coeff, range) == plain);
+    }
+
+    // a view cannot grow
+    problem.GetDataset().Share();
+    CHECK_THROWS(problem.AppendRows(ds.Values().bottomRows(1)));
+}
+
+TEST_CASE("Recorded error statistics")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+    Operon::Problem problem{ds, range, range};
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, problem.GetInputs()};
+
+    Operon::RandomGenerator rng{0};
+    Operon::DefaultDispatch dtable;
+    Operon::Evaluator<Operon::DefaultDispatch> evaluator{problem, dtable, Operon::MSE{}, /*linearScaling=*/true};
+    evaluator.SetRecordStatistics(true);
+
+    Operon::Individual ind;
+    ind.Genotype = creator(rng, 20, 1, 10);
+    Operon::Vector<Operon::Scalar> buf(range.Size());
+
+    // the buffered and the streaming evaluations record the same statistics
+    auto const fit = evaluator(rng, ind, buf).front();
+    REQUIRE(ind.Statistics.has_value());
+    auto const buffered = *ind.Statistics;
+    auto const predictions = buf;
+    (void) evaluator(rng, ind, {});
+    REQUIRE(ind.Statistics.has_value());
+    CHECK(ind.Statistics->Count() == static_cast<double>(range.Size()));
+    CHECK(ind.Statistics->SumProducts() == doctest::Approx(buffered.SumProducts()));
+    CHECK(Operon::MSE{}(*ind.Statistics, /*scaled=*/true) == doctest::Approx(fit).epsilon(1e-4));
+
+    // the other metrics are computed from the statistics without evaluating the tree again
+    auto const evaluations = evaluator.ResidualEvaluations.load();
+    for (auto const& metric : std::vector<Operon::ErrorMetric>{ Operon::SSE{}, Operon::NMSE{}, Operon::RMSE{}, Operon::R2{}, Operon::C2{} }) {
+        for (auto scaled : { false, true }) {
+            Operon::Evaluator<Operon::DefaultDispatch> other{problem, dtable, metric, scaled};
+            CHECK(metric(*ind.Statistics, scaled) == doctest::Approx(other(rng, ind, buf).front()).epsilon(1e-4));
+        }
+    }
+    CHECK(evaluator.ResidualEvaluations == evaluations);
+
+    // the fitness cache hits get the statistics of the cached evaluation
+    evaluator.SetCacheCapacity(100);
+    (void) evaluator(rng, ind, {});
+    ind.Statistics.reset();
+    auto const hits = evaluator.CacheHits.load();
+    (void) evaluator(rng, ind, {});
+    CHECK(evaluator.CacheHits == hits + 1);
+    REQUIRE(ind.Statistics.has_value());
+    CHECK(ind.Statistics->SumProducts() == doctest::Approx(buffered.SumProducts()));
+
+    // the predictions are not cached: with a buffer the tree is evaluated again and the buffer filled
+    std::ranges::fill(buf, Operon::Scalar{0});
+    auto const misses = evaluator.CacheMisses.load();
+    (void) evaluator(rng, ind, buf);
+    CHECK(evaluator.CacheMisses == misses + 1);
+    CHECK(std::ranges::equal(buf, predictions));
+}
+
+TEST_CASE("Case errors")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+    Operon::Problem problem{ds, range, range};
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, problem.GetInputs()};
+
+    Operon::RandomGenerator rng{0};
+    Operon::DefaultDispatch dtable;
+    std::vector<std::size_t> const sample{ 250, 3, 499, 17, 128, 0, 64, 300 }; // NOLINT, not sorted
+
+    Operon::Individual ind;
+    ind.Genotype = creator(rng, 20, 1, 10); // NOLINT
+    Operon::Vector<Operon::Scalar> buf(range.Size());
+
+    // the errors taken from the predictions buffer are the reference
+    auto evaluator = [&]() {
+        auto e = std::make_unique<Operon::Evaluator<Operon::DefaultDispatch>>(problem, dtable, Operon::MSE{}, /*linearScaling=*/true);
+        e->SetCaseSample(sample);
+        return e;
+    };
+    auto buffered = evaluator();
+    (void) (*buffered)(rng, ind, buf);
+    auto const expected = ind.CaseErrors;
+    REQUIRE(expected.size() == sample.size());
+
+    auto check = [&](std::string const& name) {
+        INFO(name);
+        REQUIRE(ind.CaseErrors.size() == expected.size());
+        for (auto i = 0UL; i < expected.size(); ++i) {
+            CHECK(ind.CaseErrors[i] == doctest::Approx(expected[i]).epsilon(1e-3));
+        }
+    };
+
+    auto streamed = evaluator();
+    ind.CaseErrors.clear();
+    (void) (*streamed)(rng, ind, {});
+    check("streaming");
+
+    ind.CaseErrors.clear();
+    (void) streamed->EvaluateBounded(rng, ind, {}, std::vector<Operon::Scalar>{std::numeric_limits<Operon::Scalar>::max()});
+    check("bounded");
+
+    auto incremental = evaluator();
+    incremental->SetIncrementalStatistics(100); // NOLINT
+    ind.CaseErrors.clear();
+    (void) (*incremental)(rng, ind, {});
+    check("incremental");
+
+    auto tiled = evaluator();
+    tiled->SetBlockRows(128); // NOLINT
+    std::vector<Operon::Individual> group(3, ind);
+    for (auto& g : group) { g.CaseErrors.clear(); }
+    Operon::Vector<Operon::Scalar> tile;
+    tiled->Evaluate(rng, group, tile);
+    ind = group.back();
+    check("tiled");
+
+    // the cache hits get the errors of the cached evaluation
+    auto cached = evaluator();
+    cached->SetCacheCapacity(100); // NOLINT
+    (void) (*cached)(rng, ind, {});
+    ind.CaseErrors.clear();
+    (void) (*cached)(rng, ind, {});
+    CHECK(cached->CacheHits == 1);
+    check("cached");
+}
+
+TEST_CASE("Semantic hashing")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+    Operon::Problem problem{ds, range, range};
+
+    Operon::Map<std::string, Operon::Hash> variables;
+    for (auto&& v : ds.GetVariables()) {
+        variables.insert({v.Name, v.Hash});
+    }
+    auto individual = [&](std::string const& expr) {
+        Operon::Individual ind;
+        ind.Genotype = Operon::InfixParser::Parse(expr, variables);
+        return ind;
+    };
+
+    Operon::RandomGenerator rng{0};
+    Operon::DefaultDispatch dtable;
+    Operon::Evaluator<Operon::DefaultDispatch> evaluator{problem, dtable};
+    evaluator.SetCacheCapacity(1'000);
+    evaluator.SetSemanticHashing(64);
+    CHECK(evaluator.SemanticRows() == 64);
+
+    auto a = individual("X1 + X1");
+    auto b = individual("2 * X1");
+    auto c = individual("X1 + X2");
+    auto fa = evaluator(rng, a, {});
+    auto fb = evaluator(rng, b, {});
+    auto fc = evaluator(rng, c, {});
+    CHECK(a.Semantic != 0);
+    CHECK(a.Semantic == b.Semantic);
+    CHECK(a.Semantic != c.Semantic);
+
+    // the equivalent tree is evaluated on its own, the cache is keyed on the tree and its coefficients
+    CHECK(fa == fb);
+    CHECK(evaluator.CacheHits == 0);
+    CHECK(evaluator.ResidualEvaluations == 3);
+    CHECK(evaluator(rng, a, {}) == fa);
+    CHECK(evaluator.CacheHits == 1);
+
+    // the same structure with other coefficients is a different entry
+    auto d = individual("X1 + X2");
+    d.Genotype.Nodes().front().Value = 2;
+    auto const fd = evaluator(rng, d, {});
+    CHECK(evaluator.CacheHits == 1);
+    CHECK(evaluator.ResidualEvaluations == 4);
+    CHECK(fd != fc);
+
+    // an equivalent solution only enters the archive if it dominates the archived one
+    SolutionArchive archive;
+    a.Fitness = { fa[0], 3 };
+    b.Fitness = { fa[0] + 1e-6F, 2 };
+    CHECK(archive.Insert(a));
+    CHECK(!archive.Insert(b));
+    b.Fitness = { fa[0], 2 };
+    CHECK(archive.Insert(b));
+    CHECK(archive.Size() == 1);
+}
+
+TEST_CASE("Throughput metrics")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, 100 };
+
+    Operon::Problem problem{ds, range, range};
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, problem.GetInputs()};
+
+    Operon::RandomGenerator rng{0};
+    Operon::DefaultDispatch dtable;
+    Operon::Evaluator<Operon::DefaultDispatch> evaluator{problem, dtable};
+    evaluator.SetCacheCapacity(1'000);
+
+    SUBCASE("sharded counters") {
+        constexpr auto threads{8};
+        constexpr auto increments{10'000};
+        std::vector<std::thread> workers;
+        for (auto i = 0; i < threads; ++i) {
+            workers.emplace_back([&]() { for (auto j = 0; j < increments; ++j) { ++evaluator.CallCount; } });
+        }
+        for (auto& w : workers) { w.join(); }
+        CHECK(evaluator.CallCount == threads * increments);
+        evaluator.Reset();
+        CHECK(evaluator.CallCount == 0);
+    }
+
+    SUBCASE("approximate budget") {
+        evaluator.SetBudget(100);
+        evaluator.ResidualEvaluations = 99;
+        CHECK_FALSE(evaluator.BudgetExhaustedApprox());
+        // close to the budget every check is exact
+        ++evaluator.ResidualEvaluations;
+        CHECK(evaluator.BudgetExhaustedApprox());
+        evaluator.Reset();
+        CHECK_FALSE(evaluator.BudgetExhaustedApprox());
+    }
+
+    SUBCASE("snapshot") {
+        Operon::ThroughputMonitor monitor{evaluator};
+        Operon::Individual ind;
+        ind.Genotype = creator(rng, 20, 1, 10);
+        (void) evaluator(rng, ind, {});
+        (void) evaluator(rng, ind, {});
+
+        auto const& s = monitor.Sample(1);
+        CHECK(s.ResidualEvaluations == 1);
+        CHECK(s.Rows == range.Size());
+        CHECK(s.CacheHitRate == doctest::Approx(0.5));
+        CHECK(s.RowsPerSecond == doctest::Approx(s.EvaluationsPerSecond * static_cast<double>(range.Size())));
+
+        std::ostringstream os;
+        Operon::WriteOpenMetrics(os, s);
+        CHECK(os.str().find("operon_residual_evaluations_total 1\n") != std::string::npos);
+        CHECK(os.str().ends_with("# EOF\n"));
+
+        // the rates are relative to the previous snapshot
+        CHECK(monitor.Sample(2).CacheHitRate == 0.0);
+    }
+}
+
+TEST_CASE("Tape reuse")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, ds.VariableHashes()};
+    Operon::RandomGenerator rng{0};
+    Operon::DefaultDispatch dtable;
+    using TInterpreter = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+
+    auto eq = [](auto const& a, auto const& b) { return std::ranges::equal(a, b, [](auto x, auto y) { return (std::isnan(x) && std::isnan(y)) || x == y; }); };
+
+    auto t1 = creator(rng, 20, 1, 10);
+    auto t2 = creator(rng, 20, 1, 10);
+    TInterpreter i1{dtable, ds, t1};
+    TInterpreter i2{dtable, ds, t2};
+
+    // the tape compiled by i1 is reused with different coefficients
+    auto coeff = t1.GetCoefficients();
+    auto r1 = i1.Evaluate(coeff, range);
+    std::ranges::transform(coeff, coeff.begin(), [](auto c) { return c + 1; });
+    auto r2 = i1.Evaluate(coeff, range);
+    CHECK(eq(r2, TInterpreter::Evaluate(t1, ds, range, coeff)));
+
+    // interleaving interpreters that share the same workspace forces a recompilation
+    CHECK(eq(i2.Evaluate(t2.GetCoefficients(), range), TInterpreter::Evaluate(t2, ds, range)));
+    CHECK(eq(i1.Evaluate(t1.GetCoefficients(), range), r1));
+
+    // a different range also forces a recompilation
+    Range sub { 10, 100 };
+    CHECK(eq(i1.Evaluate(t1.GetCoefficients(), sub), TInterpreter::Evaluate(t1, ds, sub)));
+}
+
+TEST_CASE("CPU dispatch")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    for (auto target : { DispatchTarget::Baseline, DispatchTarget::X86_64_V2, DispatchTarget::X86_64_V3, DispatchTarget::X86_64_V4 }) {
+        CHECK(Operon::ParseDispatchTarget(Operon::DispatchTargetName(target)) == target);
+    }
+    CHECK(!Operon::ParseDispatchTarget("pentium"));
+
+    auto targets = Operon::AvailableDispatchTargets();
+    REQUIRE(!targets.empty());
+    CHECK(targets.front() == DispatchTarget::Baseline);
+
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, ds.VariableHashes()};
+    Operon::RandomGenerator rng{0};
+    Operon::DefaultDispatch baseline;
+    using TInterpreter = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+
+    // every available target computes the same values (up to rounding)
+    for (auto target : targets) {
+        auto dtable = Operon::MakeDispatchTable(target);
+        for (auto i = 0; i < 10; ++i) {
+            auto tree = creator(rng, 20, 1, 10);
+            auto coeff = tree.GetCoefficients();
+            auto r1 = TInterpreter{baseline, ds, tree}.Evaluate(coeff, range);
+            auto r2 = TInterpreter{dtable, ds, tree}.Evaluate(coeff, range);
+            CHECK(std::ranges::equal(r1, r2, [](auto x, auto y) { return (!std::isfinite(x) && !std::isfinite(y)) || std::abs(x - y) <= 1e-5 * std::max(Operon::Scalar{1}, std::abs(x)); }));
+        }
+    }
+}
+
+TEST_CASE("JIT evaluation")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic | NodeType::Aq | NodeType::Exp | NodeType::Sin | NodeType::Square};
+    Operon::BalancedTreeCreator creator{pset, ds.VariableHashes()};
+    Operon::RandomGenerator rng{0};
+    using TInterpreter = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+
+    for (auto i = 0; i < 5; ++i) {
+        auto tree = creator(rng, 20, 1, 10);
+        Operon::JitModel model{tree};
+        for (auto r : { range, Range{10, 100} }) {
+            auto r1 = TInterpreter::Evaluate(tree, ds, r);
+            auto r2 = model.Evaluate(ds, r);
+            CHECK(std::ranges::equal(r1, r2, [](auto x, auto y) { return (!std::isfinite(x) && !std::isfinite(y)) || std::abs(x - y) <= 1e-4 * std::max(Operon::Scalar{1}, std::abs(x)); }));
+        }
+    }
+
+    // compilation errors are reported
+    CHECK_THROWS_AS(Operon::JitModel(creator(rng, 10, 1, 10), { .Compiler = "false", .Flags = {} }), std::runtime_error);
+}
+
+TEST_CASE("Approximate primitives")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::Map<std::string, Operon::Hash> vars;
+    for (auto const& v : ds.GetVariables()) { vars[v.Name] = v.Hash; }
+    using TInterpreter = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+
+    Operon::DefaultDispatch exact;
+    auto approx = exact;
+    CHECK_THROWS(Operon::ApproximatePrimitives(approx, 3));
+    Operon::ApproximatePrimitives(approx, 2);
+
+    for (auto const* expr : { "exp(X1)", "sin(X2) * cos(X3)", "tanh(X4) + sqrt(abs(X5))" }) {
+        auto tree = InfixParser::Parse(expr, vars);
+        auto coeff = tree.GetCoefficients();
+        auto r1 = TInterpreter{exact, ds, tree}.Evaluate(coeff, range);
+        auto r2 = TInterpreter{approx, ds, tree}.Evaluate(coeff, range);
+        CHECK(std::ranges::equal(r1, r2, [](auto x, auto y) { return std::abs(x - y) <= 1e-2 * std::max(Operon::Scalar{1}, std::abs(x)); }));
+    }
+
+    // the copy is independent of the original table
+    auto tree = InfixParser::Parse("exp(X1)", vars);
+    auto coeff = tree.GetCoefficients();
+    CHECK(TInterpreter{exact, ds, tree}.Evaluate(coeff, range) == TInterpreter::Evaluate(tree, ds, range));
+
+    // only the primitives in the mask are approximated, or copied from another table
+    auto const other = InfixParser::Parse("sin(X2) + log(abs(X3))", vars);
+    auto const otherCoeff = other.GetCoefficients();
+    auto partial = exact;
+    Operon::ApproximatePrimitives(partial, 2, NodeType::Exp | NodeType::Tanh);
+    auto mixed = exact;
+    mixed.CopyPrimitives(approx, NodeType::Exp);
+    for (auto const* dtable : { &partial, &mixed }) {
+        CHECK(TInterpreter{*dtable, ds, tree}.Evaluate(coeff, range) == TInterpreter{approx, ds, tree}.Evaluate(coeff, range));
+        CHECK(TInterpreter{*dtable, ds, other}.Evaluate(otherCoeff, range) == TInterpreter{exact, ds, other}.Evaluate(otherCoeff, range));
+        CHECK(TInterpreter{*dtable, ds, tree}.JacRev(coeff, range).isApprox(TInterpreter{approx, ds, tree}.JacRev(coeff, range)));
+    }
+}
+
+TEST_CASE("Fused kernels")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::Map<std::string, Operon::Hash> vars;
+    for (auto const& v : ds.GetVariables()) { vars[v.Name] = v.Hash; }
+
+    Operon::DefaultDispatch dtable;
+    using TInterpreter = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+
+    auto close = [](auto const& a, auto const& b) {
+        return std::ranges::equal(a, b, [](auto x, auto y) { return x == y || std::abs(x - y) <= 1e-5 * std::max(Operon::Scalar{1}, std::abs(y)); });
+    };
+
+    // the dag interpreter does not use the fused kernels
+    for (auto const* expr : { "X1 + X2 + X3", "X1 * X2 + X3", "X3 + X1 * X2", "exp(X1) * X2", "exp(X1 * X2 + X3 + X4)" }) {
+        auto tree = InfixParser::Parse(expr, vars);
+        for (auto& n : tree.Nodes()) { if (n.IsLeaf()) { n.Value *= 1.5; } } // NOLINT
+        auto const expected = Operon::DagInterpreter<Operon::Scalar, Operon::DefaultDispatch>(dtable, ds, std::array{std::cref(tree)}).Evaluate(range);
+        CHECK(close(TInterpreter{dtable, ds, tree}.Evaluate(tree.GetCoefficients(), range), expected));
+    }
+}
+
+TEST_CASE("Constant subtree folding")
+{
+    // the reference replaces every constant by a column of ones weighted by the constant, so that nothing is folded
+    Operon::RandomGenerator rng{0};
+    Operon::Dataset::Matrix values(1000, 4); // NOLINT
+    std::uniform_real_distribution<Operon::Scalar> uniform(-2, 2);
+    std::ranges::generate(values.reshaped(), [&]() { return uniform(rng); });
+    values.col(3).setOnes();
+    Operon::Dataset ds(values);
+    auto inputs = ds.VariableHashes();
+    auto const one = inputs.back();
+    inputs.pop_back();
+
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic | NodeType::Exp | NodeType::Sin | NodeType::Tanh | NodeType::Square};
+    Operon::BalancedTreeCreator creator{pset, inputs};
+    Operon::DefaultDispatch dtable;
+    using TInterpreter = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+
+    auto close = [](auto const& a, auto const& b) {
+        return std::ranges::equal(a, b, [](auto x, auto y) { return (std::isnan(x) && std::isnan(y)) || x == y || std::abs(x - y) <= 1e-4 * std::max(Operon::Scalar{1}, std::abs(y)); });
+    };
+    auto flat = [](auto const& jac) { return std::span{jac.data(), static_cast<std::size_t>(jac.size())}; };
+
+    for (auto i = 0; i < 100; ++i) { // NOLINT
+        auto tree = creator(rng, 30, 1, 10); // NOLINT
+        // half of the variables become constants, half of which are coefficients
+        for (auto& n : tree.Nodes()) {
+            if (!n.IsVariable() || rng() % 2 == 0) { continue; }
+            auto const optimize = rng() % 2 == 0;
+            n = Node::Constant(uniform(rng));
+            n.Optimize = optimize;
+        }
+        tree.UpdateNodes();
+
+        auto reference = tree;
+        for (auto& n : reference.Nodes()) {
+            if (!n.IsConstant()) { continue; }
+            auto const [value, optimize] = std::pair{n.Value, n.Optimize};
+            n = Node(NodeType::Variable, one);
+            n.Value = value;
+            n.Optimize = optimize;
+        }
+
+        auto const coeff = tree.GetCoefficients();
+        TInterpreter interpreter{dtable, ds, tree};
+        TInterpreter expected{dtable, ds, reference};
+        CHECK(close(interpreter.Evaluate(coeff, range), expected.Evaluate(coeff, range)));
+        CHECK(close(flat(interpreter.JacRev(coeff, range)), flat(expected.JacRev(coeff, range))));
+    }
+}
+
+TEST_CASE("Compact primal layout")
+{
+    // the jacobian pass uses one primal column per node, its output is the reference
+    Operon::RandomGenerator rng{0};
+    Operon::Dataset::Matrix values(1000, 4); // NOLINT
+    std::uniform_real_distribution<Operon::Scalar> uniform(-2, 2);
+    std::ranges::generate(values.reshaped(), [&]() { return uniform(rng); });
+    Operon::Dataset ds(values);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic | NodeType::Exp | NodeType::Sin | NodeType::Tanh | NodeType::Square};
+    pset.SetMinMaxArity(Node(NodeType::Add), 1, 7); // NOLINT
+    pset.SetMinMaxArity(Node(NodeType::Mul), 1, 5); // NOLINT
+    Operon::BalancedTreeCreator creator{pset, ds.VariableHashes()};
+    Operon::DefaultDispatch dtable;
+    using TInterpreter = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+
+    auto close = [](auto const& a, auto const& b) {
+        return std::ranges::equal(a, b, [](auto x, auto y) { return (std::isnan(x) && std::isnan(y)) || x == y || std::abs(x - y) <= 1e-4 * std::max(Operon::Scalar{1}, std::abs(y)); });
+    };
+
+    std::size_t nodes{0};
+    std::size_t columns{0};
+    for (auto i = 0; i < 100; ++i) { // NOLINT
+        auto tree = creator(rng, 1 + rng() % 100, 1, 20); // NOLINT
+        // some of the variables become constants, so that some subtrees are folded
+        for (auto& n : tree.Nodes()) {
+            if (!n.IsVariable() || rng() % 3 != 0) { continue; }
+            n = Node::Constant(uniform(rng));
+        }
+        tree.UpdateNodes();
+
+        auto const coeff = tree.GetCoefficients();
+        TInterpreter interpreter{dtable, ds, tree};
+        std::vector<Operon::Scalar> expected(range.Size());
+        Eigen::Array<Operon::Scalar, -1, -1> jacobian(range.Size(), coeff.size());
+        interpreter.JacRev(coeff, range, expected, { jacobian.data(), static_cast<std::size_t>(jacobian.size()) });
+
+        CHECK(close(interpreter.Evaluate(coeff, range), expected));
+        std::vector<Operon::Scalar> streamed;
+        interpreter.ForEachBatch(coeff, range, [&](auto /*row*/, auto batch) { streamed.insert(streamed.end(), batch.begin(), batch.end()); });
+        CHECK(close(streamed, expected));
+
+        auto const& tape = interpreter.GetWorkspace().CompiledTape;
+        CHECK(tape.Columns() > 0);
+        CHECK(tape.Columns() <= tree.Length());
+        nodes += tree.Length();
+        columns += tape.Columns();
+    }
+    CHECK(2 * columns < nodes);
+}
+
+TEST_CASE("Invariant subtree cache")
+{
+    Operon::RandomGenerator rng{0};
+    Operon::Dataset::Matrix values(1000, 4); // NOLINT
+    std::uniform_real_distribution<Operon::Scalar> uniform(-2, 2);
+    std::ranges::generate(values.reshaped(), [&]() { return uniform(rng); });
+    Operon::Dataset ds(values);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic | NodeType::Exp | NodeType::Sin | NodeType::Tanh};
+    Operon::BalancedTreeCreator creator{pset, ds.VariableHashes()};
+    Operon::DefaultDispatch dtable;
+    using TInterpreter = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+
+    // the reference interpreter does not cache
+    TInterpreter::Workspace cached;
+    TInterpreter::Workspace uncached;
+    uncached.CompiledTape.SetCacheCapacity(0);
+
+    auto close = [](auto const& a, auto const& b) {
+        return std::ranges::equal(a, b, [](auto x, auto y) { return (std::isnan(x) && std::isnan(y)) || x == y || std::abs(x - y) <= 1e-4 * std::max(Operon::Scalar{1}, std::abs(y)); });
+    };
+
+    auto cachedTrees{0};
+    for (auto i = 0; i < 50; ++i) { // NOLINT
+        auto tree = creator(rng, 1 + rng() % 50, 1, 10); // NOLINT
+        // only some of the coefficients are optimized
+        for (auto& n : tree.Nodes()) { n.Optimize = n.IsLeaf() && rng() % 4 == 0; }
+        auto coeff = tree.GetCoefficients();
+
+        TInterpreter a{dtable, ds, tree, cached};
+        TInterpreter b{dtable, ds, tree, uncached};
+        for (auto k = 0; k < 3; ++k) {
+            std::ranges::transform(coeff, coeff.begin(), [&](auto c) { return c + uniform(rng); });
+            auto const x = a.Evaluate(coeff, range);
+            auto const y = b.Evaluate(coeff, range);
+            CHECK(close(x, y));
+            auto const jx = a.JacRev(coeff, range);
+            auto const jy = b.JacRev(coeff, range);
+            CHECK(close(std::span(jx.data(), jx.size()), std::span(jy.data(), jy.size())));
+        }
+        cachedTrees += static_cast<int>(cached.CompiledTape.Caching());
+        CHECK(!uncached.CompiledTape.Caching());
+    }
+    CHECK(cachedTrees > 0);
+}
+
+TEST_CASE("Multi-range evaluation")
+{
+    Operon::RandomGenerator rng{0};
+    Operon::Dataset::Matrix values(1000, 4); // NOLINT
+    std::uniform_real_distribution<Operon::Scalar> uniform(-2, 2);
+    std::ranges::generate(values.reshaped(), [&]() { return uniform(rng); });
+    Operon::Dataset ds(values);
+
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic | NodeType::Exp | NodeType::Sin};
+    Operon::BalancedTreeCreator creator{pset, ds.VariableHashes()};
+    Operon::DefaultDispatch dtable;
+    using TInterpreter = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+
+    // non-contiguous, unaligned and overlapping ranges
+    std::array const ranges{ Range{0, 700}, Range{700, 1000}, Range{250, 261}, Range{690, 710} }; // NOLINT
+    auto equal = [](auto const& a, auto const& b) {
+        return std::ranges::equal(a, b, [](auto x, auto y) { return (std::isnan(x) && std::isnan(y)) || x == y; });
+    };
+
+    for (auto i = 0; i < 20; ++i) { // NOLINT
+        auto tree = creator(rng, 1 + rng() % 50, 1, 10); // NOLINT
+        auto const coeff = tree.GetCoefficients();
+        TInterpreter interpreter{dtable, ds, tree};
+        auto const estimated = interpreter.Evaluate(coeff, ranges);
+        REQUIRE(estimated.size() == ranges.size());
+        for (auto k = 0UL; k < ranges.size(); ++k) {
+            CHECK(equal(estimated[k], TInterpreter{dtable, ds, tree}.Evaluate(coeff, ranges[k])));
+        }
+    }
+}
+
+TEST_CASE("Interval check")
+{
+    Operon::RandomGenerator rng{0};
+    Operon::Dataset::Matrix values(1000, 4); // NOLINT
+    std::uniform_real_distribution<Operon::Scalar> uniform(-2, 2);
+    std::ranges::generate(values.reshaped(), [&]() { return uniform(rng); });
+    Operon::Dataset ds(values);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+    auto const bounds = Operon::ComputeVariableBounds(ds, range);
+
+    // the outputs of the finite trees lie within their interval
+    // - random coefficients keep the intervals away from the boundaries of the domains, where the rounding errors of
+    //   the interpreter can produce values outside of the interval
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic | NodeType::Exp | NodeType::Log | NodeType::Sqrt | NodeType::Sin | NodeType::Tanh | NodeType::Aq};
+    Operon::BalancedTreeCreator creator{pset, ds.VariableHashes()};
+    Operon::DefaultDispatch dtable;
+    auto rejected{0};
+    for (auto i = 0; i < 200; ++i) { // NOLINT
+        auto tree = creator(rng, 1 + rng() % 20, 1, 10); // NOLINT
+        auto coeff = tree.GetCoefficients();
+        std::ranges::generate(coeff, [&]() { return uniform(rng); });
+        tree.SetCoefficients(coeff);
+        auto const interval = Operon::EvaluateInterval(tree, bounds);
+        if (!interval.Finite()) { ++rejected; continue; }
+        auto const estimated = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>::Evaluate(tree, ds, range);
+        auto const tol = Operon::Scalar{1e-3} * std::max({Operon::Scalar{1}, std::abs(interval.Lower), std::abs(interval.Upper)}); // NOLINT
+        CHECK(std::ranges::all_of(estimated, [&](auto v) { return std::isfinite(v) && v >= interval.Lower - tol && v <= interval.Upper + tol; }));
+    }
+    CHECK(rejected > 0);
+
+    // log(x) is undefined for the negative inputs, the tree is rejected without being evaluated
+    auto x = Node(NodeType::Variable);
+    x.HashValue = ds.VariableHashes().front();
+    Operon::Individual ind;
+    ind.Genotype = Operon::Tree({ x, Node(NodeType::Log) }).UpdateNodes();
+
+    Operon::Problem problem{ds, range, range};
+    Operon::Evaluator<Operon::DefaultDispatch> evaluator{problem, dtable};
+    evaluator.SetIntervalCheck(true);
+    CHECK(evaluator.Rejects(ind.Genotype));
+    CHECK(evaluator(rng, ind, {}).front() == Operon::EvaluatorBase::ErrMax);
+    CHECK(evaluator.ResidualEvaluations == 0);
+
+    ind.Genotype = Operon::Tree({ x, Node(NodeType::Exp) }).UpdateNodes();
+    CHECK_FALSE(evaluator.Rejects(ind.Genotype));
+    (void) evaluator(rng, ind, {});
+    CHECK(evaluator.ResidualEvaluations == 1);
+
+    // the bounds follow the training range: log(x) is accepted on positive inputs, and rejected again once rows
+    // with a negative input are appended (see Evaluator::Prepare)
+    Operon::Dataset::Matrix positive = values.array().abs() + Operon::Scalar{1};
+    Operon::Problem growing{Operon::Dataset{positive}, range, range};
+    Operon::Evaluator<Operon::DefaultDispatch> checked{growing, dtable};
+    checked.SetIntervalCheck(true);
+    ind.Genotype = Operon::Tree({ x, Node(NodeType::Log) }).UpdateNodes();
+    CHECK_FALSE(checked.Rejects(ind.Genotype));
+    (void) growing.AppendRows(values.topRows(10)); // NOLINT
+    checked.Prepare({});
+    CHECK(checked.Rejects(ind.Genotype));
+}
+
+TEST_CASE("Non-finite abort")
+{
+    Operon::RandomGenerator rng{0};
+    Operon::Dataset::Matrix values(1000, 4); // NOLINT
+    std::uniform_real_distribution<Operon::Scalar> uniform(-2, 2);
+    std::ranges::generate(values.reshaped(), [&]() { return uniform(rng); });
+    // log(x) is only undefined at row 500, exp(x) is always finite
+    values.col(0) = values.col(0).abs() + Operon::Scalar{0.1}; // NOLINT
+    values(500, 0) = -1; // NOLINT
+    Operon::Dataset ds(values);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    auto x = Node(NodeType::Variable);
+    x.HashValue = ds.VariableHashes().front();
+
+    Operon::DefaultDispatch dtable;
+    using TInterpreter = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+    std::vector<Operon::Scalar> result(range.Size(), Operon::Scalar{0});
+
+    Operon::Individual ind;
+    ind.Genotype = Operon::Tree({ x, Node(NodeType::Exp) }).UpdateNodes();
+    auto const coeff = ind.Genotype.GetCoefficients();
+    CHECK(TInterpreter{dtable, ds, ind.Genotype}.EvaluateFinite(coeff, range, result));
+    CHECK(result == TInterpreter{dtable, ds, ind.Genotype}.Evaluate(coeff, range));
+
+    Operon::Problem problem{ds, range, range};
+    Operon::Evaluator<Operon::DefaultDispatch> evaluator{problem, dtable};
+    auto const fit = evaluator(rng, ind, result);
+    evaluator.SetNonFiniteAbort(true);
+    CHECK(evaluator(rng, ind, result) == fit);
+
+    // the evaluation stops at the batch containing the negative input
+    ind.Genotype = Operon::Tree({ x, Node(NodeType::Log) }).UpdateNodes();
+    std::ranges::fill(result, Operon::Scalar{0});
+    CHECK_FALSE(TInterpreter{dtable, ds, ind.Genotype}.EvaluateFinite(ind.Genotype.GetCoefficients(), range, result));
+    CHECK(result.back() == Operon::Scalar{0});
+    CHECK(evaluator(rng, ind, result).front() == Operon::EvaluatorBase::ErrMax);
+    CHECK(evaluator(rng, ind, {}).front() == Operon::EvaluatorBase::ErrMax);
+}
+
+TEST_CASE("Batch size tuning")
+{
+    Operon::RandomGenerator rng{0};
+    Operon::Dataset::Matrix values(1000, 4); // NOLINT
+    std::uniform_real_distribution<Operon::Scalar> uniform(-2, 2);
+    std::ranges::generate(values.reshaped(), [&]() { return uniform(rng); });
+    Operon::Dataset ds(values);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic | NodeType::Exp | NodeType::Sin};
+    Operon::BalancedTreeCreator creator{pset, ds.VariableHashes()};
+    std::vector<Tree> trees;
+    for (auto i = 0; i < 50; ++i) { trees.push_back(creator(rng, 1 + rng() % 200, 1, 30)); } // NOLINT
+
+    Operon::DefaultDispatch dtable;
+    using TInterpreter = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+    auto close = [](auto const& a, auto const& b) {
+        return std::ranges::equal(a, b, [](auto x, auto y) { return (std::isnan(x) && std::isnan(y)) || x == y || std::abs(x - y) <= 1e-4 * std::max(Operon::Scalar{1}, std::abs(y)); });
+    };
+
+    SUBCASE("batch size") {
+        // the passes do not depend on the batch size, including the last partial batch
+        Operon::BatchDispatch<Operon::Scalar, 48> small; // NOLINT
+        Operon::BatchDispatch<Operon::Scalar, 512> large; // NOLINT
+        using TSmall = Operon::Interpreter<Operon::Scalar, Operon::BatchDispatch<Operon::Scalar, 48>>;
+        using TLarge = Operon::Interpreter<Operon::Scalar, Operon::BatchDispatch<Operon::Scalar, 512>>;
+        for (auto const& tree : trees) {
+            auto const coeff = tree.GetCoefficients();
+            auto const values = TInterpreter{dtable, ds, tree}.Evaluate(coeff, range);
+            auto const jacobian = TInterpreter{dtable, ds, tree}.JacRev(coeff, range);
+            CHECK(close(TSmall{small, ds, tree}.Evaluate(coeff, range), values));
+            CHECK(close(TSmall{small, ds, tree}.JacRev(coeff, range).reshaped(), jacobian.reshaped()));
+            CHECK(close(TLarge{large, ds, tree}.Evaluate(coeff, range), values));
+            CHECK(close(TLarge{large, ds, tree}.JacRev(coeff, range).reshaped(), jacobian.reshaped()));
+        }
+    }
+
+    SUBCASE("tuning") {
+        Operon::DefaultBatchSizeTuner tuner;
+        CHECK(tuner.BatchSize(1) == Dispatch::DefaultBatchSize<Operon::Scalar>);
+        CHECK_THROWS_AS(tuner.Tune(trees, ds, range, /*repeats=*/0), std::invalid_argument);
+        tuner.Tune(trees, ds, range, /*repeats=*/1);
+        for (auto const& tree : trees) {
+            CHECK(std::ranges::find(tuner.Candidates, tuner.BatchSize(tree.Length())) != tuner.Candidates.end());
+            CHECK(close(tuner.Evaluate(tree, ds, range), TInterpreter::Evaluate(tree, ds, range)));
+            std::size_t visited{0};
+            tuner.Visit(tree.Length(), [&]<typename Table>(Table const& /*unused*/) { visited = Table::template BatchSize<Operon::Scalar>; });
+            CHECK(visited == tuner.BatchSize(tree.Length()));
+        }
+
+        // the buffered paths of the evaluator use the tuned tables, the fitness is the same up to rounding
+        Operon::Problem problem{ds, range, range};
+        Operon::Evaluator<Operon::DefaultDispatch> evaluator{problem, dtable};
+        Operon::Evaluator<Operon::DefaultDispatch> tuned{problem, dtable};
+        tuned.SetBatchSizeTuner(&tuner);
+        CHECK(tuned.GetBatchSizeTuner() == &tuner);
+        std::vector<Operon::Scalar> buf(range.Size());
+        for (auto fused : { false, true }) {
+            evaluator.SetFusedScaling(fused);
+            tuned.SetFusedScaling(fused);
+            for (auto const& tree : trees) {
+                Operon::Individual ind;
+                ind.Genotype = tree;
+                auto const expected = evaluator(rng, ind, buf).front();
+                auto const values = buf;
+                auto const fit = tuned(rng, ind, buf).front();
+                CHECK((fit == expected || (!std::isfinite(fit) && !std::isfinite(expected)) || std::abs(fit - expected) <= 1e-3 * std::max(Operon::Scalar{1}, std::abs(expected))));
+                CHECK(close(buf, values));
+            }
+        }
+    }
+}
+
+TEST_CASE("Evaluation cost model")
+{
+    Operon::DefaultDispatch dtable;
+    Tree tree{ Node(NodeType::Variable, 1), Node(NodeType::Exp), Node::Constant(2), Node(NodeType::Variable, 2), Node(NodeType::Variable, 3), Node(NodeType::Add) };
+    tree.Nodes().back().Arity = 4; // NOLINT
+    tree.UpdateNodes();
+
+    // uncalibrated, the cost is the length with the n-ary nodes expanded
+    EvaluationCostModel model;
+    CHECK(model(tree) == doctest::Approx(8));
+
+    model.SetCost(NodeType::Variable, 1);
+    model.SetCost(NodeType::Constant, 0.5);
+    model.SetCost(NodeType::Exp, 10);
+    model.SetCost(NodeType::Add, 2);
+    CHECK(model(tree) == doctest::Approx(3 + 0.5 + 10 + 3 * 2));
+
+    auto const calibrated = EvaluationCostModel::Calibrate(dtable, NodeType::Add | NodeType::Exp | NodeType::Pow, 256, 2);
+    for (auto type : { NodeType::Add, NodeType::Exp, NodeType::Pow, NodeType::Variable, NodeType::Constant }) {
+        CHECK(std::isfinite(calibrated.Cost(type)));
+        CHECK(calibrated.Cost(type) >= 0);
+    }
+    CHECK(calibrated.Cost(NodeType::Sin) == 1); // not calibrated
+    CHECK_THROWS(EvaluationCostModel::Calibrate(dtable, NodeType::Add, 0));
+
+    // the trees over the cost limit get the worst fitness in all the objectives
+    Operon::RandomGenerator rng{0};
+    auto ds = Util::RandomDataset(rng, 100, 4);
+    Operon::Problem problem{ds, Range{0, 100}, Range{0, 100}};
+    Operon::Evaluator<Operon::DefaultDispatch> error{problem, dtable};
+    CostEvaluator cost{problem, model};
+    cost.SetCostLimit(20);
+    Operon::MultiEvaluator evaluator{problem};
+    evaluator.Add(error);
+    evaluator.Add(cost);
+
+    auto const x = problem.GetInputs().front();
+    Individual cheap; cheap.Genotype = Tree{ Node(NodeType::Variable, x), Node(NodeType::Exp) }.UpdateNodes();
+    Individual expensive; expensive.Genotype = Tree{ Node(NodeType::Variable, x), Node(NodeType::Exp), Node(NodeType::Exp), Node(NodeType::Exp) }.UpdateNodes();
+    std::vector<Operon::Scalar> buf(100);
+    CHECK_FALSE(evaluator.Rejects(cheap.Genotype));
+    CHECK(evaluator.Rejects(expensive.Genotype));
+    auto const f1 = evaluator(rng, cheap, buf);
+    auto const f2 = evaluator(rng, expensive, buf);
+    REQUIRE(f1.size() == 2);
+    CHECK(f1[0] < EvaluatorBase::ErrMax);
+    CHECK(f1[1] == doctest::Approx(11));
+    CHECK(f2 == EvaluatorBase::ReturnType(2, EvaluatorBase::ErrMax));
+
+    // the counters of the multi evaluator add up those of its evaluators
+    auto const stats = evaluator.Stats();
+    CHECK(stats.Residual == evaluator.ResidualEvaluations.load() + error.Stats().Residual + cost.Stats().Residual);
+    CHECK(stats.Calls == evaluator.CallCount.load() + error.Stats().Calls + cost.Stats().Calls);
+    CHECK(stats.Residual > 0);
+}
+
+TEST_CASE("Tiled dataset layout")
+{
+    Operon::RandomGenerator rng{0};
+    Operon::Dataset::Matrix values(1000, 30); // NOLINT
+    std::uniform_real_distribution<Operon::Scalar> uniform(-2, 2);
+    std::ranges::generate(values.reshaped(), [&]() { return uniform(rng); });
+    Operon::Dataset ds(values);
+
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic | NodeType::Exp};
+    Operon::BalancedTreeCreator creator{pset, ds.VariableHashes()};
+    Operon::DefaultDispatch dtable;
+    using TInterpreter = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+    constexpr auto S{ TInterpreter::BatchSize };
+
+    Operon::DatasetTiles const tiles(ds, S);
+    CHECK(tiles.Tiles() == (ds.Rows<std::size_t>() + S - 1) / S);
+    auto const x = ds.GetVariables().front().Hash;
+    CHECK(std::equal(tiles.Values(x, 1), tiles.Values(x, 1) + S, ds.GetValues(x).begin() + S));
+
+    auto eq = [](auto const& a, auto const& b) { return std::ranges::equal(a, b, [](auto x, auto y) { return (std::isnan(x) && std::isnan(y)) || x == y; }); };
+
+    // the tiles are not used for a range that does not start at a tile boundary
+    for (auto [range, used] : { std::pair{Range{0, 1000}, true}, std::pair{Range{S, 1000}, true}, std::pair{Range{5, 900}, false} }) { // NOLINT
+        for (auto i = 0; i < 20; ++i) { // NOLINT
+            auto const tree = creator(rng, 1 + rng() % 100, 1, 20); // NOLINT
+            auto const coeff = tree.GetCoefficients();
+            TInterpreter plain{dtable, ds, tree};
+            auto const expected = plain.Evaluate(coeff, range);
+            auto const jacobian = plain.JacRev(coeff, range);
+
+            TInterpreter tiled{dtable, ds, tree};
+            tiled.SetTiles(&tiles);
+            CHECK(eq(tiled.Evaluate(coeff, range), expected));
+            CHECK(eq(tiled.JacRev(coeff, range).reshaped(), jacobian.reshaped()));
+
+            auto const& tape = tiled.GetWorkspace().CompiledTape;
+            for (auto j = 0UL; j < tree.Length(); ++j) {
+                if (tree[j].IsVariable()) { CHECK((tape[j].Tile != nullptr) == used); }
+            }
+        }
+    }
+}
+
+TEST_CASE("Dictionary-encoded variables")
+{
+    // categorical columns with 8 and 16 bit codes, and a continuous one which is not worth encoding
+    Operon::RandomGenerator rng{0};
+    Operon::Dataset::Matrix values(1000, 4); // NOLINT
+    std::uniform_int_distribution<int> small(0, 9);
+    std::uniform_int_distribution<int> large(0, 299);
+    std::uniform_real_distribution<Operon::Scalar> uniform(-2, 2);
+    for (auto i = 0; i < values.rows(); ++i) {
+        values(i, 0) = static_cast<Operon::Scalar>(small(rng));
+        values(i, 1) = static_cast<Operon::Scalar>(large(rng)) / 10;
+        values(i, 2) = static_cast<Operon::Scalar>(small(rng)) - Operon::Scalar{4.5}; // NOLINT
+        values(i, 3) = uniform(rng);
+    }
+    Operon::Dataset ds(values);
+    std::vector<Operon::Hash> hashes;
+    for (auto const* name : { "X1", "X2", "X3", "X4" }) { hashes.push_back(ds.GetVariable(name)->Hash); }
+
+    Operon::DatasetCodes const codes(ds);
+    CHECK(codes.Size() == 3);
+    CHECK(codes.Values(hashes[0]).Width == 1);
+    CHECK(codes.Values(hashes[1]).Width == 2);
+    CHECK(codes.Values(hashes[3]).Empty());
+    CHECK(codes.Cardinality(hashes[0]) <= 10);
+    CHECK(codes.Values(hashes[0]).Linear);
+    CHECK(codes.Values(hashes[2]).Linear);
+    CHECK_FALSE(codes.Values(hashes[1]).Linear); // tenths are not exact multiples of a step
+
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic | NodeType::Exp};
+    Operon::BalancedTreeCreator creator{pset, hashes};
+    Operon::DefaultDispatch dtable;
+    using TInterpreter = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+
+    // the codes are lossless and the decoded batches go through the same kernels as the columns
+    auto eq = [](auto const& a, auto const& b) {
+        return std::ranges::equal(a, b, [](auto x, auto y) { return (std::isnan(x) && std::isnan(y)) || x == y; });
+    };
+
+    for (auto range : { Range{0, 1000}, Range{5, 900} }) { // NOLINT
+        for (auto i = 0; i < 20; ++i) { // NOLINT
+            auto const tree = creator(rng, 1 + rng() % 50, 1, 20); // NOLINT
+            auto const coeff = tree.GetCoefficients();
+            TInterpreter plain{dtable, ds, tree};
+            TInterpreter encoded{dtable, ds, tree};
+            encoded.SetCodes(&codes);
+            CHECK(eq(encoded.Evaluate(coeff, range), plain.Evaluate(coeff, range)));
+            CHECK(eq(encoded.JacRev(coeff, range).reshaped(), plain.JacRev(coeff, range).reshaped()));
+
+            // the integer codes are converted by their nodes, the nodes of a gathered variable share its decoded column
+            auto const& tape = encoded.GetWorkspace().CompiledTape;
+            for (auto j = 0UL; j < tree.Length(); ++j) {
+                if (!tree[j].IsVariable()) { continue; }
+                auto const h = tree[j].HashValue;
+                CHECK(tape[j].Encoded.Empty() == (h == hashes[1] || h == hashes[3]));
+                CHECK((tape[j].Decoded >= 0) == (h == hashes[1]));
+                for (auto k = 0UL; k < j; ++k) {
+                    if (tree[k].IsVariable() && tree[k].HashValue == tree[j].HashValue && tree[k].Lag == tree[j].Lag) { CHECK(tape[k].Decoded == tape[j].Decoded); }
+                }
+            }
+        }
+    }
+
+    // the codes kept by the dataset are used by default, shared by its copies and dropped when the values change
+    auto copy = ds;
+    CHECK(copy.Encode(Operon::DatasetCodes::MaxCardinality) == 3);
+    CHECK(ds.Codes() == nullptr);
+    auto const shared = copy;
+    CHECK(shared.Codes() == copy.Codes());
+    CHECK(copy.Codes()->Cardinality(hashes[0]) == codes.Cardinality(hashes[0]));
+    CHECK(copy.Encode(10) == 2); // NOLINT
+    CHECK(copy.Codes()->Values(hashes[1]).Empty());
+
+    auto const tree = creator(rng, 30, 1, 20); // NOLINT
+    auto const coeff = tree.GetCoefficients();
+    TInterpreter fromDataset{dtable, copy, tree};
+    CHECK(eq(fromDataset.Evaluate(coeff, Range{0, 1000}), TInterpreter{dtable, ds, tree}.Evaluate(coeff, Range{0, 1000}))); // NOLINT
+
+    copy.Shuffle(rng);
+    CHECK(copy.Codes() == nullptr);
+    CHECK(copy.Encode(0) == 0);
+    CHECK_THROWS_AS(copy.Encode(Operon::DatasetCodes::MaxCardinality + 1), std::invalid_argument);
+}
+
+TEST_CASE("Half-precision variables")
+{
+    Operon::RandomGenerator rng{0};
+    Operon::Dataset::Matrix values(1000, 3); // NOLINT
+    std::uniform_real_distribution<Operon::Scalar> uniform(-2, 2);
+    std::uniform_int_distribution<int> small(0, 9);
+    for (auto i = 0; i < values.rows(); ++i) {
+        values(i, 0) = uniform(rng);
+        values(i, 1) = uniform(rng) * 100; // NOLINT
+        values(i, 2) = static_cast<Operon::Scalar>(small(rng));
+    }
+    Operon::Dataset ds(values);
+    std::vector<Operon::Hash> hashes;
+    for (auto const* name : { "X1", "X2", "X3" }) { hashes.push_back(ds.GetVariable(name)->Hash); }
+
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic | NodeType::Exp};
+    Operon::BalancedTreeCreator creator{pset, hashes};
+    Operon::DefaultDispatch dtable;
+    using TInterpreter = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+
+    auto close = [](auto const& a, auto const& b) {
+        return std::ranges::equal(a, b, [](auto x, auto y) { return (std::isnan(x) && std::isnan(y)) || x == y || std::abs(x - y) <= 1e-4 * std::max(Operon::Scalar{1}, std::abs(y)); });
+    };
+
+    for (auto encoding : { Operon::ValueEncoding::Half, Operon::ValueEncoding::BFloat16 }) {
+        // the narrowed values are exact in the rounded dataset, the categorical column stays dictionary-encoded
+        Operon::DatasetCodes codes(ds);
+        codes.Narrow(ds, Operon::Span<Operon::Hash const>{hashes.data(), 2}, encoding);
+        CHECK(codes.Encoding(hashes[0]) == encoding);
+        CHECK(codes.Encoding(hashes[1]) == encoding);
+        CHECK(codes.Encoding(hashes[2]) == Operon::ValueEncoding::Dictionary);
+        CHECK(codes.Cardinality(hashes[0]) == 0);
+
+        auto rounded = values;
+        for (auto j = 0; j < 2; ++j) {
+            for (auto& v : rounded.col(j)) {
+                auto const f = static_cast<float>(v);
+                v = encoding == Operon::ValueEncoding::Half
+                    ? Operon::detail::HalfToFloat(Operon::detail::FloatToHalf(f))
+                    : Operon::detail::BFloat16ToFloat(Operon::detail::FloatToBFloat16(f));
+            }
+        }
+        Operon::Dataset narrow(rounded);
+        // half rounds to 11 significant bits and bfloat16 to 8
+        auto const eps = encoding == Operon::ValueEncoding::Half ? 0x1p-11 : 0x1p-8;
+        CHECK(std::ranges::equal(narrow.GetValues(hashes[1]), ds.GetValues(hashes[1]), [&](auto x, auto y) { return std::abs(x - y) <= eps * std::abs(y); }));
+
+        for (auto range : { Range{0, 1000}, Range{5, 900} }) { // NOLINT
+            for (auto i = 0; i < 20; ++i) { // NOLINT
+                auto const tree = creator(rng, 1 + rng() % 50, 1, 20); // NOLINT
+                auto const coeff = tree.GetCoefficients();
+                TInterpreter plain{dtable, narrow, tree};
+                TInterpreter encoded{dtable, ds, tree};
+                encoded.SetCodes(&codes);
+                CHECK(close(encoded.Evaluate(coeff, range), plain.Evaluate(coeff, range)));
+                CHECK(close(encoded.JacRev(coeff, range).reshaped(), plain.JacRev(coeff, range).reshaped()));
+            }
+        }
+    }
+
+    Operon::DatasetCodes codes(ds);
+    CHECK_THROWS_AS(codes.Narrow(ds, hashes, Operon::ValueEncoding::Dictionary), std::invalid_argument);
+    std::vector<Operon::Hash> unknown{ 42 }; // NOLINT
+    CHECK_THROWS_AS(codes.Narrow(ds, unknown, Operon::ValueEncoding::Half), std::invalid_argument);
+}
+
+TEST_CASE("Shape-grouped evaluation")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, ds.VariableHashes()};
+    Operon::RandomGenerator rng{0};
+    Operon::DefaultDispatch dtable;
+    using TInterpreter = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+
+    // a few shapes with different coefficients, and some trees too large to be packed
+    std::uniform_real_distribution<Operon::Scalar> dist(-2, 2);
+    std::vector<Operon::Tree> trees;
+    for (auto i = 0; i < 20; ++i) {
+        auto const tree = creator(rng, 7, 1, 10);
+        for (auto j = 0; j < 10; ++j) {
+            auto& t = trees.emplace_back(tree);
+            for (auto& n : t.Nodes()) { if (n.Optimize) { n.Value = dist(rng); } }
+        }
+    }
+    for (auto i = 0; i < 5; ++i) { trees.push_back(creator(rng, 30, 1, 10)); }
+    std::ranges::shuffle(trees, rng);
+    std::vector<std::reference_wrapper<Operon::Tree const>> refs(trees.begin(), trees.end());
+
+    auto close = [](auto const& a, auto const& b) {
+        return std::ranges::equal(a, b, [](auto x, auto y) { return (std::isnan(x) && std::isnan(y)) || x == y || std::abs(x - y) <= 1e-5 * std::abs(y); });
+    };
+
+    // the short ranges are packed, the long one is evaluated one tree at a time
+    for (auto range : { Range{0, 1}, Range{10, 26}, Range{0, ds.Rows<std::size_t>()} }) {
+        std::vector<Operon::Scalar> result(trees.size() * range.Size());
+        Operon::EvaluateByShape<Operon::Scalar>(dtable, ds, refs, range, result);
+        for (auto i = 0UL; i < trees.size(); ++i) {
+            auto const expected = TInterpreter{dtable, ds, trees[i]}.Evaluate({}, range);
+            CHECK(close(std::span{result}.subspan(i * range.Size(), range.Size()), expected));
+        }
+    }
+}
+
+TEST_CASE("Lagged variables")
+{
+    // the reference reads a materialized copy of the first column shifted by the lag
+    constexpr auto lag{3};
+    Operon::RandomGenerator rng{0};
+    Operon::Dataset::Matrix values(300, 3); // NOLINT
+    std::uniform_real_distribution<Operon::Scalar> uniform(-2, 2);
+    std::ranges::generate(values.reshaped(), [&]() { return uniform(rng); });
+    values.col(2).tail(values.rows() - lag) = values.col(0).head(values.rows() - lag);
+    Operon::Dataset ds(values);
+    auto const inputs = ds.VariableHashes();
+
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, {inputs[0], inputs[1]}};
+    Operon::DefaultDispatch dtable;
+    using TInterpreter = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+    Range const range{lag, ds.Rows<std::size_t>()};
+
+    for (auto i = 0; i < 100; ++i) {
+        auto lagged = creator(rng, 20, 1, 10); // NOLINT
+        auto shifted = lagged;
+        for (auto j = 0UL; j < lagged.Length(); ++j) {
+            auto& n = lagged.Nodes()[j];
+            if (n.IsVariable() && n.HashValue == inputs[0]) {
+                n.Lag = lag;
+                shifted.Nodes()[j].HashValue = shifted.Nodes()[j].CalculatedHashValue = inputs[2];
+            }
+        }
+        CHECK(TInterpreter{dtable, ds, lagged}.Evaluate({}, range) == TInterpreter{dtable, ds, shifted}.Evaluate({}, range));
+    }
+
+    Operon::Node x{NodeType::Variable, inputs[0]};
+    auto a = Operon::Tree{x}.UpdateNodes();
+    x.Lag = 1;
+    auto b = Operon::Tree{x}.UpdateNodes();
+    CHECK(a.Hash(Operon::HashMode::Strict).HashValue() != b.Hash(Operon::HashMode::Strict).HashValue());
+
+    // the rows before the range must exist
+    x.Lag = lag + 1;
+    auto c = Operon::Tree{x}.UpdateNodes();
+    CHECK_THROWS(TInterpreter{dtable, ds, c}.Evaluate({}, range));
+}
+
+TEST_CASE("Lazy standardization")
+{
+    // the reference standardizes the values in place
+    Operon::RandomGenerator rng{0};
+    Operon::Dataset::Matrix values(300, 3); // NOLINT
+    std::uniform_real_distribution<Operon::Scalar> uniform(-2, 5);
+    std::ranges::generate(values.reshaped(), [&]() { return uniform(rng); });
+    Operon::Dataset lazy(values);
+    Operon::Dataset eager(values);
+    Range const range{0, lazy.Rows<std::size_t>()};
+    for (auto i = 0UL; i < 3; ++i) {
+        lazy.Standardize(i, range, /*inPlace=*/false);
+        eager.Standardize(i, range);
+    }
+    CHECK(lazy.Values().isApprox(values));
+
+    // no division, whose poles amplify the rounding errors beyond any tolerance
+    Operon::PrimitiveSet pset{NodeType::Constant | NodeType::Variable | NodeType::Add | NodeType::Sub | NodeType::Mul | NodeType::Exp};
+    Operon::BalancedTreeCreator creator{pset, lazy.VariableHashes()};
+    Operon::DefaultDispatch dtable;
+    using TInterpreter = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+
+    // relative to the largest value, since the sums cancel the rounding errors of the transformed variables
+    auto close = [](auto const& a, auto const& b) {
+        auto const m = std::ranges::max(b, {}, [](auto y) { return std::isfinite(y) ? std::abs(y) : Operon::Scalar{0}; });
+        auto const s = std::max(Operon::Scalar{1}, std::abs(m));
+        return std::ranges::equal(a, b, [s](auto x, auto y) { return (!std::isfinite(x) && !std::isfinite(y)) || std::abs(x - y) <= 1e-4 * s; });
+    };
+
+    for (auto i = 0; i < 100; ++i) {
+        auto const tree = creator(rng, 20, 1, 10); // NOLINT
+        auto const coeff = tree.GetCoefficients();
+        CHECK(close(TInterpreter{dtable, lazy, tree}.Evaluate(coeff, range), TInterpreter{dtable, eager, tree}.Evaluate(coeff, range)));
+        auto const a = TInterpreter{dtable, lazy, tree}.JacRev(coeff, range);
+        auto const b = TInterpreter{dtable, eager, tree}.JacRev(coeff, range);
+        CHECK(close(a.reshaped(), b.reshaped()));
+    }
+
+    auto const bounds = Operon::ComputeVariableBounds(lazy, range);
+    for (auto const& [hash, b] : Operon::ComputeVariableBounds(eager, range)) {
+        CHECK(std::abs(bounds.at(hash).Lower - b.Lower) < 1e-4);
+        CHECK(std::abs(bounds.at(hash).Upper - b.Upper) < 1e-4);
+    }
+}
+
+TEST_CASE("Tree simplification")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::Map<std::string, Operon::Hash> vars;
+    for (auto const& v : ds.GetVariables()) { vars[v.Name] = v.Hash; }
+
+    Operon::DefaultDispatch dtable;
+    using TInterpreter = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+    auto evaluate = [&](Tree const& tree) { return TInterpreter{dtable, ds, tree}.Evaluate({}, range); };
+
+    auto close = [](auto const& a, auto const& b) {
+        return std::ranges::equal(a, b, [](auto x, auto y) { return (std::isnan(x) && std::isnan(y)) || x == y || std::abs(x - y) <= 1e-4 * std::max(Operon::Scalar{1}, std::abs(y)); });
+    };
+
+    SUBCASE("rules")
+    {
+        auto x = [&](auto const& name) { return Node(NodeType::Variable, vars[name]); };
+        auto fixed = [](double v) { auto n = Node::Constant(v); n.Optimize = false; return n; };
+        auto unary = [](NodeType type) { Node n(type); n.Arity = 1; return n; };
+        Node const add(NodeType::Add);
+        Node const mul(NodeType::Mul);
+
+        // the trees are in postfix order and the first argument of a function is the node before it
+        std::vector<std::pair<Tree, std::size_t>> cases {
+            { Tree{ fixed(0), fixed(1), x("X1"), mul, add }, 1 },                                   // x * 1 + 0
+            { Tree{ fixed(0), x("X1"), Node(NodeType::Sub) }, 1 },                                  // x - 0
+            { Tree{ fixed(1), x("X1"), Node(NodeType::Div) }, 1 },                                  // x / 1
+            { Tree{ Node::Constant(2), Node::Constant(3), mul, x("X1"), add }, 3 },                 // x + 2 * 3
+            { Tree{ Node::Constant(2), Node(NodeType::Exp), x("X1"), mul }, 1 },                    // x * exp(2)
+            { Tree{ x("X1"), x("X2"), add, x("X3"), x("X4"), add, add }, 5 },                       // (x1 + x2) + (x3 + x4)
+            { Tree{ x("X1"), unary(NodeType::Sub), unary(NodeType::Sub) }, 1 },                     // -(-x)
+            { Tree{ x("X1"), Node(NodeType::Abs), Node(NodeType::Abs) }, 2 },                       // abs(abs(x))
+            { Tree{ x("X1"), Node(NodeType::Ceil), Node(NodeType::Floor) }, 2 },                    // floor(ceil(x))
+            { Tree{ fixed(0), x("X1"), mul }, 3 },                                                  // x * 0 is not folded
+            { Tree{ Node::Constant(0), x("X1"), add }, 3 },                                         // a coefficient is kept
+        };
+
+        for (auto& [tree, length] : cases) {
+            tree.UpdateNodes();
+            auto simplified = tree;
+            simplified.Simplify();
+            CHECK(simplified.Length() == length);
+            CHECK(close(evaluate(simplified), evaluate(tree)));
+        }
+    }
+
+    SUBCASE("random trees")
+    {
+        Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic | NodeType::Abs | NodeType::Square | NodeType::Fmin | NodeType::Fmax};
+        Operon::BalancedTreeCreator creator{pset, ds.VariableHashes()};
+        Operon::RandomGenerator rng{0};
+        std::uniform_int_distribution<std::size_t> length(1, 50);
+
+        auto constexpr n{1000};
+        std::size_t before{0};
+        std::size_t after{0};
+        for (auto i = 0; i < n; ++i) {
+            auto tree = creator(rng, length(rng), 1, 10);
+            // some of the constants are fixed neutral elements
+            for (auto& node : tree.Nodes()) {
+                if (!node.IsConstant()) { continue; }
+                if (auto k = rng() % 4; k < 2) { node.Value = static_cast<Operon::Scalar>(k); node.Optimize = false; }
+            }
+            auto simplified = tree;
+            simplified.Simplify();
+            CHECK(simplified.Length() <= tree.Length());
+            CHECK(simplified.GetCoefficients().size() <= tree.GetCoefficients().size());
+            CHECK(close(evaluate(simplified), evaluate(tree)));
+            before += tree.Length();
+            after += simplified.Length();
+        }
+        fmt::print("simplification: {} -> {} nodes\n", before, after);
+        CHECK(after < before);
+    }
+}
+
+TEST_CASE("Row-parallel evaluation")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::Problem problem{ds, range, range};
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, problem.GetInputs()};
+    Operon::RandomGenerator rng{0};
+    Operon::DefaultDispatch dtable;
+    using TInterpreter = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+
+    tf::Executor executor(4);
+    auto constexpr rowChunk{100};
+    auto tree = creator(rng, 20, 1, 10);
+    auto coeff = tree.GetCoefficients();
+
+    auto close = [](auto const& a, auto const& b) {
+        return std::ranges::equal(a, b, [](auto x, auto y) { return (std::isnan(x) && std::isnan(y)) || x == y || std::abs(x - y) <= 1e-5 * std::abs(y); });
+    };
+
+    std::vector<Operon::Scalar> values(range.Size());
+    Operon::EvaluateRows(executor, dtable, tree, ds, coeff, range, values, rowChunk);
+    CHECK(close(values, TInterpreter{dtable, ds, tree}.Evaluate(coeff, range)));
+
+    Eigen::Array<Operon::Scalar, -1, -1> jac(range.Size(), coeff.size());
+    Operon::JacRevRows(executor, dtable, tree, ds, coeff, range, {jac.data(), static_cast<std::size_t>(jac.size())}, rowChunk);
+    Eigen::Array<Operon::Scalar, -1, -1> expected = TInterpreter{dtable, ds, tree}.JacRev(coeff, range);
+    CHECK(close(std::span{jac.data(), static_cast<std::size_t>(jac.size())}, std::span{expected.data(), static_cast<std::size_t>(expected.size())}));
+
+    // the fitness reduced from per-chunk statistics matches the serial fitness
+    Operon::Evaluator<Operon::DefaultDispatch> evaluator{problem, dtable};
+    Operon::Individual ind;
+    ind.Genotype = tree;
+    auto const f1 = evaluator(rng, ind, values);
+    evaluator.SetRowParallelism(&executor, rowChunk);
+    auto const f2 = evaluator(rng, ind, values);
+    CHECK(f2.front() == doctest::Approx(f1.front()).epsilon(1e-4));
+}
+
+TEST_CASE("Streaming fitness evaluation")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::Problem problem{ds, range, range};
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, problem.GetInputs()};
+    Operon::RandomGenerator rng{0};
+    Operon::DefaultDispatch dtable;
+
+    std::vector<Operon::Scalar> buf(range.Size());
+    for (auto scaling : { false, true }) {
+        for (auto metric : { ErrorType::MSE, ErrorType::R2, ErrorType::C2 }) {
+            Operon::Evaluator<Operon::DefaultDispatch> evaluator{problem, dtable, ErrorMetric{metric}, scaling};
+            for (auto i = 0; i < 10; ++i) {
+                Operon::Individual ind;
+                ind.Genotype = creator(rng, 20, 1, 10);
+                auto const f1 = evaluator(rng, ind, buf);
+                auto const f2 = evaluator(rng, ind, {});
+                CHECK(f2.front() == doctest::Approx(f1.front()).epsilon(1e-3));
+            }
+        }
+    }
+}
+
+TEST_CASE("Description length")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, 1000 }; // NOLINT
+
+    Operon::Problem problem{ds, range, range};
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, problem.GetInputs()};
+    Operon::RandomGenerator rng{0};
+    Operon::DefaultDispatch dtable;
+
+    using Likelihood = Operon::GaussianLikelihood<Operon::Scalar>;
+    using TInterpreter = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+    Operon::MinimumDescriptionLengthEvaluator<Operon::DefaultDispatch, Likelihood> evaluator{problem, dtable};
+    auto const target = problem.TargetValues(range);
+
+    std::vector<Operon::Scalar> rowSigma(range.Size());
+    std::uniform_real_distribution<Operon::Scalar> uniform(0.5, 2); // NOLINT
+    std::ranges::generate(rowSigma, [&]() { return uniform(rng); });
+
+    for (auto const& sigma : { std::vector<Operon::Scalar>{1}, rowSigma }) {
+        for (auto i = 0; i < 10; ++i) {
+            Operon::Individual ind;
+            ind.Genotype = creator(rng, 20, 1, 10);
+            auto const coeff = ind.Genotype.GetCoefficients();
+            TInterpreter const interpreter{dtable, problem.GetDataset(), ind.Genotype};
+
+            // the fisher matrix and the likelihood accumulated batch by batch match those of the whole range
+            auto const estimated = interpreter.Evaluate(coeff, range);
+            Eigen::Matrix<Operon::Scalar, -1, -1> const jacobian = interpreter.JacRev(coeff, range);
+            auto const fisher = Likelihood::ComputeFisherMatrix(estimated, { jacobian.data(), static_cast<std::size_t>(jacobian.size()) }, sigma);
+            auto const likelihood = Likelihood::ComputeLikelihood(estimated, target, sigma);
+
+            Likelihood::Matrix streamed = Likelihood::Matrix::Zero(std::ssize(coeff), std::ssize(coeff));
+            auto streamedLikelihood{0.0};
+            interpreter.ForEachJacobianBatch(coeff, range, [&](int64_t row, auto values, auto block) {
+                auto const r = static_cast<std::size_t>(row);
+                auto const s = sigma.size() == 1 ? Operon::Span<Operon::Scalar const>{sigma} : Operon::Span<Operon::Scalar const>{sigma}.subspan(r, values.size());
+                if (!block.empty()) { streamed += Likelihood::ComputeFisherMatrix(values, block, s); }
+                streamedLikelihood += Likelihood::ComputeLikelihood(values, target.subspan(r, values.size()), s);
+            });
+            CHECK(streamed.isApprox(fisher, 1e-4));
+            CHECK(streamedLikelihood == doctest::Approx(likelihood).epsilon(1e-4));
+
+            // the evaluator writes the predictions to the buffer, they do not change the description length
+            evaluator.SetSigma(sigma);
+            std::vector<Operon::Scalar> buf(range.Size());
+            auto const f1 = evaluator(rng, ind, buf);
+            auto const f2 = evaluator(rng, ind, {});
+            CHECK(f1.front() == f2.front());
+            CHECK(std::ranges::equal(buf, estimated, [](auto a, auto b) { return a == doctest::Approx(b).epsilon(1e-5); }));
+        }
+    }
+}
+
+TEST_CASE("Likelihood kernels")
+{
+    // the batched likelihood sums match a scalar reference in double precision
+    // - the sizes cover a partial last batch, a single batch and less than one batch
+    using Kernels = Operon::detail::LikelihoodKernels<Operon::Scalar>;
+    constexpr auto batch = Operon::Backend::BatchSize<Operon::Scalar>;
+
+    Operon::RandomGenerator rng{1234}; // NOLINT
+    std::uniform_real_distribution<Operon::Scalar> positive(0.5, 2); // NOLINT
+    std::uniform_real_distribution<Operon::Scalar> logValue(-1, 1); // NOLINT
+    std::poisson_distribution<int> poisson(2); // NOLINT
+
+    auto const t = std::sqrt(Operon::Math::Tau);
+    for (auto n : { 1UL, batch - 1, batch, batch + 1, 1000UL + 3 }) { // NOLINT
+        std::vector<Operon::Scalar> x(n);
+        std::vector<Operon::Scalar> z(n);
+        std::vector<Operon::Scalar> y(n);
+        std::vector<Operon::Scalar> s(n);
+        std::vector<Operon::Scalar> w(n);
+        for (auto i = 0UL; i < n; ++i) {
+            x[i] = positive(rng);
+            z[i] = logValue(rng);
+            y[i] = static_cast<Operon::Scalar>(poisson(rng));
+            s[i] = positive(rng);
+            w[i] = positive(rng);
+        }
+
+        auto gaussian{0.0};
+        for (auto i = 0UL; i < n; ++i) {
+            auto const p = (static_cast<double>(x[i]) - y[i]) / s[i];
+            gaussian += std::log(s[i] * t) + 0.5 * p * p; // NOLINT
+        }
+        CHECK(Operon::GaussianLikelihood<Operon::Scalar>::ComputeLikelihood(x, y, s) == doctest::Approx(gaussian).epsilon(1e-4));
+
+        auto sumLog{0.0};
+        for (auto v : s) { sumLog += std::log(static_cast<double>(v)); }
+        CHECK(Kernels::SumLog(s) == doctest::Approx(sumLog).epsilon(1e-4));
+
+        using S = Operon::Span<Operon::Scalar const>;
+        std::vector<Operon::Scalar> const scalar{w.front()};
+        for (auto const weights : { S{}, S{scalar}, S{w} }) {
+            auto weight = [&](auto i) { return weights.empty() ? 1.0 : static_cast<double>(weights.size() == 1 ? weights[0] : weights[i]); };
+            auto poissonLog{0.0};
+            auto poissonId{0.0};
+            for (auto i = 0UL; i < n; ++i) {
+                auto const a = weight(i) * z[i];
+                auto const b = weight(i) * x[i];
+                auto const f = std::lgamma(static_cast<double>(y[i]) + 1);
+                poissonLog += std::exp(a) - (y[i] * a) + f;
+                poissonId += b - (y[i] * std::log(b)) + f;
+            }
+            CHECK(Operon::PoissonLikelihood<Operon::Scalar, true>::ComputeLikelihood(z, y, weights) == doctest::Approx(poissonLog).epsilon(1e-4));
+            CHECK(Operon::PoissonLikelihood<Operon::Scalar, false>::ComputeLikelihood(x, y, weights) == doctest::Approx(poissonId).epsilon(1e-4));
+        }
+        std::vector<Operon::Scalar> const mismatched(n + 1, 1);
+        CHECK_THROWS(Operon::PoissonLikelihood<Operon::Scalar>::ComputeLikelihood(x, y, mismatched));
+    }
+}
+
+TEST_CASE("Fused linear scaling")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::Problem problem{ds, range, range};
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, problem.GetInputs()};
+    Operon::RandomGenerator rng{0};
+    Operon::DefaultDispatch dtable;
+
+    std::vector<Operon::Scalar> buf(range.Size());
+    for (auto metric : { ErrorType::MSE, ErrorType::NMSE, ErrorType::R2 }) {
+        Operon::Evaluator<Operon::DefaultDispatch> evaluator{problem, dtable, ErrorMetric{metric}, /*linearScaling=*/true};
+        Operon::Evaluator<Operon::DefaultDispatch> fused{problem, dtable, ErrorMetric{metric}, /*linearScaling=*/true};
+        fused.SetFusedScaling(true);
+        for (auto i = 0; i < 10; ++i) {
+            Operon::Individual ind;
+            ind.Genotype = creator(rng, 20, 1, 10);
+            auto const f1 = evaluator(rng, ind, buf);
+            auto const f2 = fused(rng, ind, buf);
+            CHECK(f2.front() == doctest::Approx(f1.front()).epsilon(1e-3));
+
+            // the buffer holds the unscaled predictions
+            auto const values = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>::Evaluate(ind.Genotype, ds, range);
+            CHECK(std::ranges::equal(values, buf));
+        }
+    }
+}
+
+TEST_CASE("Multi-target evaluation")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::Problem problem{ds, range, range};
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, problem.GetInputs()};
+    Operon::RandomGenerator rng{0};
+    Operon::DefaultDispatch dtable;
+
+    // the same trees evaluated against each target separately
+    Operon::Problem other{ds, range, range};
+    other.SetTarget("X1");
+    std::vector<Operon::Hash> targets{ ds.GetVariable("Y")->Hash, ds.GetVariable("X1")->Hash };
+
+    std::vector<Operon::Scalar> buf(range.Size());
+    for (auto scaling : { false, true }) {
+        for (auto metric : { ErrorType::MSE, ErrorType::R2, ErrorType::MAE }) {
+            Operon::MultiTargetEvaluator<Operon::DefaultDispatch> evaluator{problem, dtable, targets, ErrorMetric{metric}, scaling};
+            Operon::Evaluator<Operon::DefaultDispatch> first{problem, dtable, ErrorMetric{metric}, scaling};
+            Operon::Evaluator<Operon::DefaultDispatch> second{other, dtable, ErrorMetric{metric}, scaling};
+            CHECK(evaluator.ObjectiveCount() == 2);
+            for (auto i = 0; i < 10; ++i) {
+                Operon::Individual ind(2);
+                ind.Genotype = creator(rng, 20, 1, 10);
+                auto const f = evaluator(rng, ind, buf);
+                REQUIRE(f.size() == 2);
+                CHECK(f[0] == doctest::Approx(first(rng, ind, buf).front()).epsilon(1e-3));
+                CHECK(f[1] == doctest::Approx(second(rng, ind, buf).front()).epsilon(1e-3));
+                CHECK(evaluator(rng, ind, {}) == f);
+            }
+        }
+    }
+    CHECK_THROWS_AS((Operon::MultiTargetEvaluator<Operon::DefaultDispatch>{problem, dtable, {}}), std::invalid_argument);
+}
+
+TEST_CASE("Shared predictions")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::Problem problem{ds, range, range};
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, problem.GetInputs()};
+    Operon::RandomGenerator rng{0};
+    Operon::DefaultDispatch dtable;
+
+    Operon::Evaluator<Operon::DefaultDispatch> mse{problem, dtable, MSE{}, /*linearScaling=*/true};
+    Operon::Evaluator<Operon::DefaultDispatch> mae{problem, dtable, MAE{}, /*linearScaling=*/true};
+    Operon::GaussianLikelihoodEvaluator<Operon::DefaultDispatch> likelihood{problem, dtable};
+    Operon::LengthEvaluator length{problem};
+
+    Operon::MultiEvaluator evaluator{problem};
+    evaluator.Add(mse);
+    evaluator.Add(length);
+    evaluator.Add(mae);
+    evaluator.Add(likelihood);
+    CHECK(evaluator.ObjectiveCount() == 4);
+
+    std::vector<Operon::Scalar> buf(range.Size());
+    constexpr auto n{10};
+    for (auto i = 0; i < n; ++i) {
+        Operon::Individual ind(4);
+        ind.Genotype = creator(rng, 20, 1, 10);
+        auto const f = evaluator(rng, ind, buf);
+        REQUIRE(f.size() == 4);
+        CHECK(f[0] == doctest::Approx(mse(rng, ind, buf).front()).epsilon(1e-3));
+        CHECK(f[1] == length(rng, ind, buf).front());
+        CHECK(f[2] == doctest::Approx(mae(rng, ind, buf).front()).epsilon(1e-3));
+        CHECK(f[3] == doctest::Approx(likelihood(rng, ind, buf).front()).epsilon(1e-3));
+    }
+    // the trees were interpreted once per call of the multi-evaluator (and once more by each separate call above)
+    auto const residuals = mse.ResidualEvaluations.load() + mae.ResidualEvaluations.load() + likelihood.ResidualEvaluations.load();
+    CHECK(residuals == n + 3 * n);
+}
+
+TEST_CASE("Cross-validation evaluation")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::Problem problem{ds, range, range};
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, problem.GetInputs()};
+    Operon::RandomGenerator rng{0};
+    Operon::DefaultDispatch dtable;
+
+    using CrossValidation = Operon::CrossValidationEvaluator<Operon::DefaultDispatch>;
+    auto const folds = CrossValidation::KFold(range, 5);
+    REQUIRE(folds.size() == 5);
+    CHECK(folds.front().Start() == range.Start());
+    CHECK(folds.back().End() == range.End());
+
+    CrossValidation unscaled{problem, dtable, folds, MSE{}, /*linearScaling=*/false};
+    CrossValidation scaled{problem, dtable, folds, MSE{}, /*linearScaling=*/true};
+    Operon::Evaluator<Operon::DefaultDispatch> mse{problem, dtable, MSE{}, /*linearScaling=*/false};
+    auto const target = problem.TargetValues(range);
+
+    std::vector<Operon::Scalar> buf(range.Size());
+    for (auto i = 0; i < 10; ++i) {
+        Operon::Individual ind(2);
+        ind.Genotype = creator(rng, 20, 1, 10);
+
+        // without scaling the fold errors are the errors on the subsets
+        auto const errors = unscaled.FoldErrors(ind.Genotype);
+        for (auto k = 0UL; k < folds.size(); ++k) {
+            CHECK(errors[k] == doctest::Approx(mse.EvaluateSubset(rng, ind, buf, folds[k]).front()).epsilon(1e-3));
+        }
+        auto const f = unscaled(rng, ind, buf);
+        REQUIRE(f.size() == 2);
+        CHECK(f[0] == doctest::Approx(std::reduce(errors.begin(), errors.end()) / 5).epsilon(1e-3));
+
+        // with scaling the parameters of each fold are fit on the other folds
+        auto const values = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>::Evaluate(ind.Genotype, ds, range);
+        auto const scaledErrors = scaled.FoldErrors(ind.Genotype);
+        for (auto k = 0UL; k < folds.size(); ++k) {
+            std::vector<Operon::Scalar> x;
+            std::vector<Operon::Scalar> y;
+            for (auto j = 0UL; j < folds.size(); ++j) {
+                if (j == k) { continue; }
+                x.insert(x.end(), values.begin() + folds[j].Start(), values.begin() + folds[j].End());
+                y.insert(y.end(), target.begin() + folds[j].Start(), target.begin() + folds[j].End());
+            }
+            auto const [a, b] = Operon::FitLeastSquares(x, y);
+            std::vector<Operon::Scalar> z(folds[k].Size());
+            std::transform(values.begin() + folds[k].Start(), values.begin() + folds[k].End(), z.begin(), [&](auto v) { return a * v + b; });
+            CHECK(scaledErrors[k] == doctest::Approx(MSE{}(z, target.subspan(folds[k].Start(), folds[k].Size()))).epsilon(1e-3));
+        }
+    }
+
+    CHECK_THROWS_AS((CrossValidation{problem, dtable, { range }}), std::invalid_argument);
+    CHECK_THROWS_AS((CrossValidation{problem, dtable, folds, MAE{}, /*linearScaling=*/true}), std::invalid_argument);
+}
+
+TEST_CASE("Weighted fitness evaluation")
+{
+    // zero weights on the second half of the rows amount to evaluating the first half only
+    auto const n{200UL};
+    Operon::RandomGenerator rng{0};
+    std::uniform_real_distribution<Operon::Scalar> ureal(-1, 1);
+    std::vector<std::vector<Operon::Scalar>> columns(4, std::vector<Operon::Scalar>(n));
+    for (auto i = 0UL; i < n; ++i) {
+        columns[0][i] = ureal(rng);
+        columns[1][i] = ureal(rng);
+        columns[2][i] = columns[0][i] * columns[1][i] + ureal(rng);
+        columns[3][i] = i < n / 2 ? 1 : 0;
+    }
+    Dataset ds({"x1", "x2", "y", "w"}, columns);
+    auto range = Range { 0, n };
+
+    Operon::Problem problem{ds, range, range};
+    problem.SetTarget(std::string{"y"});
+    problem.SetInputs(std::vector<std::string>{"x1", "x2"});
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, problem.GetInputs()};
+    Operon::DefaultDispatch dtable;
+
+    for (auto scaling : { false, true }) {
+        Operon::Evaluator<Operon::DefaultDispatch> evaluator{problem, dtable, ErrorMetric{ErrorType::MSE}, scaling};
+        Operon::Evaluator<Operon::DefaultDispatch> weighted{problem, dtable, ErrorMetric{ErrorType::MSE}, scaling};
+        weighted.SetWeights(ds.GetVariable("w")->Hash);
+        std::vector<Operon::Scalar> buf(n);
+        for (auto i = 0; i < 10; ++i) {
+            Operon::Individual ind;
+            ind.Genotype = creator(rng, 20, 1, 10);
+            auto const f1 = evaluator.EvaluateSubset(rng, ind, buf, Range{0, n / 2});
+            auto const f2 = weighted(rng, ind, buf);
+            auto const f3 = weighted(rng, ind, {});
+            CHECK(f2.front() == doctest::Approx(f1.front()).epsilon(1e-4));
+            CHECK(f3.front() == doctest::Approx(f1.front()).epsilon(1e-4));
+        }
+    }
+    CHECK_THROWS(Operon::Evaluator<Operon::DefaultDispatch>{problem, dtable}.SetWeights(Operon::Hash{0}));
+}
+
+TEST_CASE("Coreset row reduction")
+{
+    // the weighted error on the coreset estimates the error on the whole training range
+    auto const n{4000UL};
+    auto const training = Range { 0, 3000 };
+    auto const test = Range { 3000, n };
+    Operon::RandomGenerator rng{0};
+    std::uniform_real_distribution<Operon::Scalar> ureal(-1, 1);
+    std::normal_distribution<Operon::Scalar> noise(0, Operon::Scalar{0.1});
+    std::vector<std::vector<Operon::Scalar>> columns(3, std::vector<Operon::Scalar>(n));
+    for (auto i = 0UL; i < n; ++i) {
+        columns[0][i] = ureal(rng);
+        columns[1][i] = ureal(rng);
+        columns[2][i] = columns[0][i] * columns[1][i] + noise(rng);
+    }
+    Dataset ds({"x1", "x2", "y"}, columns);
+    Operon::Problem problem{ds, training, test};
+    problem.SetTarget(std::string{"y"});
+    problem.SetInputs(std::vector<std::string>{"x1", "x2"});
+
+    Operon::Map<std::string, Operon::Hash> vars;
+    for (auto const& v : ds.GetVariables()) { vars[v.Name] = v.Hash; }
+    Operon::Individual ind;
+    ind.Genotype = InfixParser::Parse("x1 * x2 + 0.05", vars);
+
+    Operon::DefaultDispatch dtable;
+    Operon::Evaluator<Operon::DefaultDispatch> full{problem, dtable, ErrorMetric{ErrorType::MSE}, /*linearScaling=*/false};
+    auto const error = full(rng, ind, {}).front();
+
+    constexpr auto size{300UL};
+    for (auto method : { CoresetMethod::Stratified, CoresetMethod::KMeans, CoresetMethod::Leverage }) {
+        auto const coreset = SelectCoreset(problem, size, method, rng);
+        REQUIRE(coreset.Rows.size() == coreset.Weights.size());
+        CHECK(coreset.Rows.size() <= size);
+        CHECK(std::ranges::is_sorted(coreset.Rows));
+        CHECK(std::ranges::adjacent_find(coreset.Rows) == coreset.Rows.end());
+        CHECK(coreset.Rows.back() < training.End());
+        auto const total = std::reduce(coreset.Weights.begin(), coreset.Weights.end(), 0.0);
+        if (method == CoresetMethod::Stratified) {
+            CHECK(coreset.Rows.size() == size);
+            CHECK(total == doctest::Approx(training.Size()));
+        } else {
+            CHECK(total == doctest::Approx(training.Size()).epsilon(0.3));
+        }
+
+        auto reduced = ReduceProblem(problem, coreset);
+        CHECK(reduced.TrainingRange().Bounds() == std::pair{0UL, coreset.Rows.size()});
+        CHECK(reduced.TestRange().Size() == test.Size());
+        CHECK(reduced.GetInputs().size() == 2);
+        CHECK(std::ranges::equal(reduced.TargetValues(reduced.TestRange()), problem.TargetValues(test)));
+        auto const w = reduced.GetDataset().GetVariable("coreset_weight");
+        REQUIRE(w.has_value());
+        CHECK(std::ranges::equal(reduced.GetDataset().GetValues(w->Hash).first(coreset.Rows.size()), coreset.Weights));
+
+        Operon::Evaluator<Operon::DefaultDispatch> weighted{reduced, dtable, ErrorMetric{ErrorType::MSE}, /*linearScaling=*/false};
+        weighted.SetWeights(w->Hash);
+        CHECK(weighted(rng, ind, {}).front() == doctest::Approx(error).epsilon(0.3));
+    }
+    CHECK_THROWS(SelectCoreset(problem, 0, CoresetMethod::Stratified, rng));
+
+    // a coreset at least as large as the training range keeps all the rows
+    auto const all = SelectCoreset(problem, training.Size(), CoresetMethod::KMeans, rng);
+    CHECK(all.Rows.size() == training.Size());
+    CHECK(std::ranges::all_of(all.Weights, [](auto v) { return v == 1; }));
+
+    // the weight column is added once
+    auto reduced = ReduceProblem(problem, all);
+    CHECK_THROWS(reduced.GetDataset().AddVariable("coreset_weight", reduced.TargetValues()));
+}
+
+TEST_CASE("Weighted coefficient optimization")
+{
+    // integer weights amount to repeating the rows, the coefficients fitted on the weighted rows are those fitted on
+    // the repeated rows
+    auto const n{60UL};
+    Operon::RandomGenerator rng{0};
+    std::uniform_real_distribution<Operon::Scalar> ureal(-1, 1);
+    std::uniform_int_distribution<int> uniform(0, 3);
+    std::vector<std::vector<Operon::Scalar>> columns(4, std::vector<Operon::Scalar>(n));
+    std::vector<std::vector<Operon::Scalar>> repeated(3);
+    for (auto i = 0UL; i < n; ++i) {
+        columns[0][i] = ureal(rng);
+        columns[1][i] = ureal(rng);
+        columns[2][i] = std::exp(columns[0][i]) + 2 * columns[1][i] + ureal(rng) / 2; // NOLINT
+        columns[3][i] = static_cast<Operon::Scalar>(uniform(rng));
+        for (auto k = 0; k < static_cast<int>(columns[3][i]); ++k) {
+            for (auto j = 0UL; j < repeated.size(); ++j) { repeated[j].push_back(columns[j][i]); }
+        }
+    }
+    Dataset ds({"x1", "x2", "y", "w"}, columns);
+    Dataset dr({"x1", "x2", "y"}, repeated);
+    Operon::Problem problem{ds, Range{0, n}, Range{0, n}};
+    problem.SetTarget(std::string{"y"});
+    Operon::Problem duplicated{dr, Range{0, dr.Rows()}, Range{0, dr.Rows()}};
+    duplicated.SetTarget(std::string{"y"});
+
+    // the variables keep their hashes across the two datasets
+    Operon::Map<std::string, Operon::Hash> vars;
+    for (auto const& v : ds.GetVariables()) { vars[v.Name] = v.Hash; }
+    REQUIRE(dr.GetVariable("x1")->Hash == vars["x1"]);
+    auto const tree = InfixParser::Parse("exp(0.5 * x1) + 0.1 * x2 + 1", vars);
+
+    using DTable = DispatchTable<Operon::Scalar>;
+    DTable dtable;
+    auto check = [&](OptimizerBase const& weighted, OptimizerBase const& reference) {
+        weighted.SetIterations(10); // NOLINT
+        reference.SetIterations(10); // NOLINT
+        weighted.SetWeights(ds.GetVariable("w")->Hash);
+        auto const s0 = weighted.Optimize(rng, tree);
+        auto const s1 = reference.Optimize(rng, tree);
+        CHECK(s0.InitialCost == doctest::Approx(s1.InitialCost).epsilon(1e-4));
+        CHECK(s0.FinalCost == doctest::Approx(s1.FinalCost).epsilon(1e-3));
+        REQUIRE(s0.FinalParameters.size() == s1.FinalParameters.size());
+        for (auto i = 0UL; i < s0.FinalParameters.size(); ++i) {
+            CHECK(s0.FinalParameters[i] == doctest::Approx(s1.FinalParameters[i]).epsilon(1e-3));
+        }
+
+        // without weights the fit differs
+        weighted.SetWeights(std::nullopt);
+        CHECK(weighted.Optimize(rng, tree).InitialCost != doctest::Approx(s1.InitialCost).epsilon(1e-4));
+    };
+
+    check(LevenbergMarquardtOptimizer<DTable, OptimizerType::Tiny>{dtable, problem}, LevenbergMarquardtOptimizer<DTable, OptimizerType::Tiny>{dtable, duplicated});
+    check(LevenbergMarquardtOptimizer<DTable, OptimizerType::Eigen>{dtable, problem}, LevenbergMarquardtOptimizer<DTable, OptimizerType::Eigen>{dtable, duplicated});
+    check(LevenbergMarquardtOptimizer<DTable, OptimizerType::VariableProjection>{dtable, problem}, LevenbergMarquardtOptimizer<DTable, OptimizerType::VariableProjection>{dtable, duplicated});
+
+    // the blocks of the normal equations do not line up with the repeated rows
+    LevenbergMarquardtOptimizer<DTable, OptimizerType::NormalEquations> blocked{dtable, problem};
+    blocked.SetBlockSize(16); // NOLINT
+    check(blocked, LevenbergMarquardtOptimizer<DTable, OptimizerType::NormalEquations>{dtable, duplicated});
+
+    CHECK_THROWS(LevenbergMarquardtOptimizer<DTable, OptimizerType::Tiny>{dtable, problem}.SetWeights(Operon::Hash{0}));
+}
+
+TEST_CASE("Out-of-core fitness evaluation")
+{
+    // the evaluation streams over a memory-mapped dataset
+    Util::TemporaryFile const file{".bin"};
+    auto const path = file.Path();
+    Dataset("./data/Poly-10.csv", /*hasHeader=*/true).WriteBinary(path);
+    auto ds = Dataset::ReadBinary(path);
+    CHECK(ds.IsView());
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::Problem problem{ds, range, range};
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, problem.GetInputs()};
+    Operon::RandomGenerator rng{0};
+    Operon::DefaultDispatch dtable;
+
+    std::vector<Operon::Individual> individuals(10);
+    for (auto& ind : individuals) { ind.Genotype = creator(rng, 20, 1, 10); }
+    auto streamed = individuals;
+
+    Operon::Evaluator<Operon::DefaultDispatch> evaluator{problem, dtable, ErrorMetric{ErrorType::MSE}, /*linearScaling=*/true};
+    Operon::Vector<Operon::Scalar> buf;
+    evaluator.Evaluate(rng, individuals, buf);
+    evaluator.SetBlockRows(100); // NOLINT
+    evaluator.Evaluate(rng, streamed, buf);
+    for (auto i = 0UL; i < individuals.size(); ++i) {
+        CHECK(streamed[i][0] == doctest::Approx(individuals[i][0]).epsilon(1e-3));
+    }
+}
+
+TEST_CASE("Single precision evaluation")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::Problem problem{ds, range, range};
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, problem.GetInputs()};
+    Operon::RandomGenerator rng{0};
+    Operon::DefaultDispatch dtable;
+
+    for (auto scaling : { false, true }) {
+        Operon::Evaluator<Operon::DefaultDispatch> evaluator{problem, dtable, Operon::R2{}, scaling};
+        for (auto i = 0; i < 10; ++i) {
+            Operon::Individual ind;
+            ind.Genotype = creator(rng, 20, 1, 10);
+            evaluator.SetSinglePrecision(false);
+            auto const f1 = evaluator(rng, ind, {});
+            evaluator.SetSinglePrecision(true);
+            auto const f2 = evaluator(rng, ind, {});
+            CHECK(f2.front() == doctest::Approx(f1.front()).epsilon(1e-2));
+        }
+    }
+}
+
+TEST_CASE("Bounded fitness evaluation")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::Problem problem{ds, range, range};
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, problem.GetInputs()};
+    Operon::RandomGenerator rng{0};
+    Operon::DefaultDispatch dtable;
+
+    for (auto scaling : { false, true }) {
+        Operon::Evaluator<Operon::DefaultDispatch> evaluator{problem, dtable, Operon::MSE{}, scaling};
+        for (auto i = 0; i < 10; ++i) {
+            Operon::Individual ind;
+            ind.Genotype = creator(rng, 20, 1, 10);
+            auto const f = evaluator(rng, ind, {}).front();
+
+            // a loose bound does not change the result
+            std::array<Operon::Scalar, 1> loose { std::numeric_limits<Operon::Scalar>::max() };
+            CHECK(evaluator.EvaluateBounded(rng, ind, {}, loose).front() == doctest::Approx(f).epsilon(1e-4));
+
+            // a tight bound results in a lower bound of the fitness which exceeds the bound
+            std::array<Operon::Scalar, 1> tight { f / 2 };
+            auto const g = evaluator.EvaluateBounded(rng, ind, {}, tight).front();
+            CHECK(g > tight.front());
+            CHECK(g <= f * (1 + 1e-4));
+        }
+    }
+}
+
+TEST_CASE("Progressive evaluation")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::Problem problem{ds, range, range};
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, problem.GetInputs()};
+    Operon::RandomGenerator rng{0};
+    Operon::DefaultDispatch dtable;
+
+    Operon::Evaluator<Operon::DefaultDispatch> evaluator{problem, dtable};
+    Operon::ProgressiveEvaluator progressive{evaluator, /*sampleRatio=*/0.1, /*quantile=*/0.2};
+
+    auto constexpr n{50};
+    std::vector<Operon::Individual> pop(n);
+    for (auto& ind : pop) {
+        ind.Genotype = creator(rng, 20, 1, 10);
+        ind.Fitness = progressive(rng, ind, {});
+        // without a reference population every individual is fully evaluated
+        CHECK(ind.Fitness == evaluator(rng, ind, {}));
+    }
+    CHECK(progressive.Promotions == n);
+    CHECK(progressive.ResidualEvaluations >= n);
+
+    progressive.Prepare(pop);
+    progressive.Reset();
+    for (auto i = 0; i < n; ++i) {
+        Operon::Individual ind;
+        ind.Genotype = creator(rng, 20, 1, 10);
+        (void) progressive(rng, ind, {});
+    }
+    // only the competitive individuals are evaluated on the whole range
+    CHECK(progressive.ResidualEvaluations < n);
 }
 
 TEST_CASE("parameter optimization")
@@ -327,6 +2437,120 @@ TEST_CASE("parameter optimization")
         testOptimizer(optimizer, "eigen solver");
     }
 
+    SUBCASE("normal equations")
+    {
+        LevenbergMarquardtOptimizer<DTable, OptimizerType::NormalEquations> optimizer { dtable, problem };
+        optimizer.SetBlockSize(100); // NOLINT
+        testOptimizer(optimizer, "normal equations solver");
+
+        // same problem as the tiny solver, which materializes the jacobian
+        LevenbergMarquardtOptimizer<DTable, OptimizerType::Tiny> tiny { dtable, problem };
+        auto const s0 = tiny.Optimize(rng, tree);
+        auto const s1 = optimizer.Optimize(rng, tree);
+        CHECK(s1.InitialCost == doctest::Approx(s0.InitialCost).epsilon(1e-3));
+        CHECK(s1.FinalCost <= s1.InitialCost);
+    }
+
+    SUBCASE("variable projection")
+    {
+        // the weights of X4 and X5 are linear, the weight of X1 (inside the exponential) and the weights of the product are not
+        auto separable = InfixParser::Parse("exp(X1) + X2 * X3 + X4 - X5", vars);
+        for (auto& node : separable.Nodes()) {
+            if (node.IsVariable()) { node.Value = static_cast<Operon::Scalar>(0.1); } // NOLINT
+        }
+        separable.UpdateNodes();
+        auto const linear = VariableProjectionCostFunction<>::LinearCoefficients(separable);
+        CHECK(std::ranges::count(linear, true) == 2);
+
+        LevenbergMarquardtOptimizer<DTable, OptimizerType::VariableProjection> optimizer { dtable, problem };
+        auto const s0 = optimizer.Optimize(rng, separable);
+        fmt::print("variable projection: {} iterations, initial cost: {}, final cost: {}\n", s0.Iterations, s0.InitialCost, s0.FinalCost);
+        CHECK(s0.FinalParameters.size() == s0.InitialParameters.size());
+        CHECK(s0.FinalCost <= s0.InitialCost);
+
+        // without linear coefficients it is the tiny solver
+        LevenbergMarquardtOptimizer<DTable, OptimizerType::Tiny> tiny { dtable, problem };
+        CHECK(optimizer.Optimize(rng, tree).FinalCost == doctest::Approx(tiny.Optimize(rng, tree).FinalCost));
+    }
+
+    SUBCASE("warm start")
+    {
+        SolverStateCache cache{1000}; // NOLINT
+        LevenbergMarquardtOptimizer<DTable, OptimizerType::NormalEquations> optimizer { dtable, problem };
+        optimizer.SetStateCache(&cache);
+
+        // the tiny solver does not report its trust region
+        LevenbergMarquardtOptimizer<DTable, OptimizerType::Tiny> tiny { dtable, problem };
+        tiny.SetStateCache(&cache);
+        (void) tiny.Optimize(rng, tree);
+        CHECK(cache.Size() == 0);
+        CHECK_FALSE(tiny.WarmStartsTrustRegion());
+        CHECK_FALSE(LevenbergMarquardtOptimizer<DTable, OptimizerType::Eigen>{dtable, problem}.WarmStartsTrustRegion());
+        CHECK(optimizer.WarmStartsTrustRegion());
+
+        auto const s0 = optimizer.Optimize(rng, tree);
+        CHECK(cache.Size() == 1);
+        auto const state = cache.Find(SolverStateCache::Key(tree));
+        REQUIRE(state.has_value());
+        CHECK(state->TrustRegionRadius > 0);
+
+        // a child with the same structure and the optimized coefficients starts from the cached trust region
+        auto child = tree;
+        child.SetCoefficients(s0.FinalParameters);
+        CHECK(SolverStateCache::Key(child) == SolverStateCache::Key(tree));
+        auto const s1 = optimizer.Optimize(rng, child);
+        fmt::print("cold start: {} iterations, warm start: {} iterations\n", s0.Iterations, s1.Iterations);
+        CHECK(s1.FinalCost <= s1.InitialCost);
+        CHECK(s1.InitialCost <= s0.InitialCost);
+    }
+
+    SUBCASE("adaptive iterations")
+    {
+        LevenbergMarquardtOptimizer<DTable, OptimizerType::Tiny> optimizer { dtable, problem };
+        optimizer.SetIterations(50); // NOLINT
+        CoefficientOptimizer local { optimizer };
+        local.SetAdaptiveIterations(2, CoefficientOptimizer::DefaultAdaptiveTolerance);
+
+        auto copy = tree;
+        auto const summary = local(rng, copy);
+        fmt::print("iterations: {}, saved: {}, initial cost: {}, final cost: {}\n", summary.Iterations, summary.SavedJacobianEvaluations, summary.InitialCost, summary.FinalCost);
+        CHECK(summary.FinalCost <= summary.InitialCost);
+        CHECK(summary.SavedJacobianEvaluations >= 0);
+        CHECK(summary.SavedJacobianEvaluations < 50);
+    }
+
+    SUBCASE("structure warm start")
+    {
+        SolverStateCache cache{1000}; // NOLINT
+        LevenbergMarquardtOptimizer<DTable, OptimizerType::Tiny> optimizer { dtable, problem };
+        optimizer.SetIterations(50); // NOLINT
+        optimizer.SetStateCache(&cache);
+        CoefficientOptimizer local { optimizer };
+        local.SetStructureWarmStart(true);
+
+        auto first = tree;
+        auto const s0 = local(rng, first);
+        auto const state = cache.Find(SolverStateCache::Key(tree));
+        REQUIRE(state.has_value());
+        CHECK(state->Coefficients == first.GetCoefficients());
+
+        // a tree with the same structure starts from the cached coefficients instead of its own
+        auto second = tree;
+        auto const s1 = local(rng, second);
+        CHECK(s1.InitialCost <= s0.FinalCost);
+        CHECK(s1.FinalCost <= s0.FinalCost);
+
+        // until the structure has converged and is no longer optimized
+        auto s2 = s1;
+        for (auto i = 0; i < 10 && s2.Iterations > 0; ++i) { // NOLINT
+            auto copy = tree;
+            s2 = local(rng, copy);
+        }
+        CHECK(s2.Iterations == 0);
+        CHECK(s2.SavedJacobianEvaluations == 50);
+        CHECK(s2.FinalParameters == cache.Find(SolverStateCache::Key(tree))->Coefficients);
+    }
+
     SUBCASE("ceres")
     {
         LevenbergMarquardtOptimizer<DTable, OptimizerType::Ceres> optimizer { dtable, problem };
@@ -353,6 +2577,33 @@ TEST_CASE("parameter optimization")
         }
     }
 
+    SUBCASE("sgd / parallel minibatch")
+    {
+        // the parallel gradient over the whole training range must match the serial likelihood
+        auto const coeff = tree.GetCoefficients();
+        Eigen::Map<Eigen::Array<Operon::Scalar, -1, 1> const> x(coeff.data(), std::ssize(coeff));
+        Eigen::Array<Operon::Scalar, -1, 1> g0(x.size());
+        Eigen::Array<Operon::Scalar, -1, 1> g1(x.size());
+
+        GaussianLikelihood<Operon::Scalar> serial { rng, interpreter, target, range };
+        tf::Executor executor(4);
+        MinibatchGradient<DTable> parallel { rng, dtable, ds, tree, target, range };
+        parallel.SetExecutor(&executor);
+        parallel.SetRowChunk(batchSize);
+
+        auto const f0 = serial(x, g0);
+        auto const f1 = parallel(x, g1);
+        CHECK(f1 == doctest::Approx(f0).epsilon(1e-3));
+        CHECK(g1.matrix().isApprox(g0.matrix(), Operon::Scalar{1e-3}));
+
+        for (auto const& rule : rules) {
+            SGDOptimizer<DTable, GaussianLikelihood<Operon::Scalar>> optimizer { dtable, problem, *rule };
+            optimizer.SetBatchSize(4 * batchSize);
+            optimizer.SetExecutor(&executor, batchSize);
+            testOptimizer(optimizer, fmt::format("sgd / parallel minibatch / {}", rule->Name()));
+        }
+    }
+
     SUBCASE("sgd / poisson")
     {
         for (auto const& rule : rules) {
@@ -360,5 +2611,246 @@ TEST_CASE("parameter optimization")
             testOptimizer(optimizer, fmt::format("sgd / poisson / {}", rule->Name()));
         }
     }
+
+    SUBCASE("batch schedules")
+    {
+        // a stratified batch draws one block of rows from each part of the training range
+        BatchSampler stratified { rng, range, 4 * batchSize, { .Sampling = BatchSampling::Stratified, .BlockSize = batchSize } };
+        auto const ranges = stratified.Next();
+        CHECK(ranges.size() == 4);
+        CHECK(std::ranges::is_sorted(ranges, std::less{}, &Range::Start));
+        CHECK(stratified.RowsSampled() == 4 * batchSize);
+
+        // the shuffled blocks of an epoch cover the training range (the batch size divides the number of rows)
+        constexpr auto epochBatch { nrow / 25 };
+        BatchSampler shuffled { rng, range, epochBatch, { .Sampling = BatchSampling::Shuffled, .BlockSize = batchSize } };
+        std::vector<int> hits(range.Size());
+        for (auto i = 0UL; i < range.Size() / epochBatch; ++i) {
+            for (auto const& r : shuffled.Next()) {
+                for (auto j = r.Start(); j < r.End(); ++j) { ++hits[j - range.Start()]; }
+            }
+        }
+        CHECK(std::ranges::all_of(hits, [](auto h) { return h == 1; }));
+
+        // the batch size grows geometrically
+        BatchSampler growing { rng, range, batchSize, { .Growth = 2 } };
+        (void)growing.Next();
+        CHECK(growing.BatchSize() == std::min(2UL * batchSize, range.Size()));
+
+        for (auto const& rule : rules) {
+            SGDOptimizer<DTable, GaussianLikelihood<Operon::Scalar>> optimizer { dtable, problem, *rule };
+            optimizer.SetBatchSize(batchSize);
+            optimizer.SetBatchSchedule({ .Sampling = BatchSampling::Stratified, .BlockSize = batchSize / 4, .NormTest = 1 });
+            testOptimizer(optimizer, fmt::format("sgd / stratified adaptive / {}", rule->Name()));
+        }
+    }
+}
+TEST_CASE("Variable projection")
+{
+    Operon::RandomGenerator rng{0};
+    constexpr auto nrow{500};
+    auto range = Range { 0, nrow };
+
+    // a separable model y = exp(0.7 * x1) + 2 * x2 - 0.5 * x3
+    Eigen::Array<Operon::Scalar, -1, -1> data(nrow, 4);
+    for (auto i = 0; i < 3; ++i) {
+        auto col = data.col(i);
+        std::generate(col.begin(), col.end(), [&](){ return Operon::Random::Uniform(rng, -1.0F, +1.0F); });
+    }
+    data.col(3) = (data.col(0) * Operon::Scalar{0.7}).exp() + (data.col(1) * Operon::Scalar{2}) - (data.col(2) * Operon::Scalar{0.5}); // NOLINT
+
+    Operon::Dataset ds(data);
+    Operon::Map<std::string, Operon::Hash> vars;
+    for (auto const& v : ds.GetVariables()) { vars[v.Name] = v.Hash; }
+    Operon::Problem problem{ds, range, range};
+
+    auto tree = InfixParser::Parse("exp(X1) + X2 - X3", vars);
+    for (auto& node : tree.Nodes()) {
+        if (node.IsVariable()) { node.Value = static_cast<Operon::Scalar>(0.1); } // NOLINT
+    }
+    tree.UpdateNodes();
+    CHECK(std::ranges::count(VariableProjectionCostFunction<>::LinearCoefficients(tree), true) == 2);
+
+    using DTable = DispatchTable<Operon::Scalar>;
+    DTable dtable;
+    LevenbergMarquardtOptimizer<DTable, OptimizerType::VariableProjection> optimizer{dtable, problem};
+    auto const summary = optimizer.Optimize(rng, tree, 20); // NOLINT
+
+    // the model is recovered, with one nonlinear coefficient left to the solver
+    CHECK(summary.Success);
+    CHECK(summary.FinalCost < 1e-6 * summary.InitialCost);
+    auto fitted = tree;
+    fitted.SetCoefficients(summary.FinalParameters);
+    auto const predicted = Operon::Interpreter<Operon::Scalar, DTable>::Evaluate(fitted, ds, range);
+    auto const target = problem.TargetValues(range);
+    for (auto i = 0UL; i < predicted.size(); ++i) {
+        CHECK(predicted[i] == doctest::Approx(target[i]).epsilon(1e-3));
+    }
+
+    // every evaluation of the cost computes a jacobian of the tree (the basis), the solver asks for at least one more
+    CHECK(summary.Iterations > 0);
+    CHECK(summary.FunctionEvaluations > summary.Iterations);
+    CHECK(summary.JacobianEvaluations >= summary.FunctionEvaluations);
+
+    // the tiny solver on all the coefficients does not get closer in the same number of iterations
+    LevenbergMarquardtOptimizer<DTable, OptimizerType::Tiny> tiny{dtable, problem};
+    auto const reference = tiny.Optimize(rng, tree, 20); // NOLINT
+    CHECK(reference.InitialCost == doctest::Approx(summary.InitialCost));
+    CHECK(summary.FinalCost <= reference.FinalCost + 1e-6);
+}
+
+TEST_CASE("Asynchronous batch evaluation")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::Problem problem{ds, range, range};
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, problem.GetInputs()};
+    Operon::RandomGenerator rng{0};
+
+    // the external system returns the length of the trees, evaluated on another thread
+    auto lengths = [](Operon::Span<Operon::Individual const> batch) {
+        return std::async(std::launch::async, [batch]() {
+            Operon::AsyncEvaluator::BatchResult result;
+            for (auto const& ind : batch) { result.push_back({ static_cast<Operon::Scalar>(ind.Genotype.Length()) }); }
+            return result;
+        });
+    };
+
+    constexpr auto batchSize{16UL};
+    constexpr auto count{100UL};
+    Operon::AsyncEvaluator evaluator{problem, lengths, batchSize};
+    Operon::Vector<Operon::Individual> individuals(count);
+    for (auto& ind : individuals) { ind.Genotype = creator(rng, 20, 1, 10); }
+    Operon::Vector<Operon::Scalar> buf;
+
+    SUBCASE("group") {
+        evaluator.Evaluate(rng, individuals, buf);
+        CHECK(evaluator.Batches() == (count + batchSize - 1) / batchSize);
+        for (auto const& ind : individuals) { CHECK(ind[0] == static_cast<Operon::Scalar>(ind.Genotype.Length())); }
+        CHECK(evaluator.TotalEvaluations() == count);
+    }
+
+    SUBCASE("coalesced") {
+        // the single evaluations of concurrent workers share batches
+        constexpr auto workers{8UL};
+        std::vector<std::thread> threads;
+        for (auto w = 0UL; w < workers; ++w) {
+            threads.emplace_back([&, w]() {
+                Operon::RandomGenerator r{w};
+                for (auto i = w; i < count; i += workers) { individuals[i].Fitness = evaluator(r, individuals[i], {}); }
+            });
+        }
+        for (auto& t : threads) { t.join(); }
+        CHECK(evaluator.Batches() <= count);
+        for (auto const& ind : individuals) { CHECK(ind[0] == static_cast<Operon::Scalar>(ind.Genotype.Length())); }
+    }
+
+    SUBCASE("errors") {
+        Operon::AsyncEvaluator truncated{problem, [](Operon::Span<Operon::Individual const> batch) {
+            std::promise<Operon::AsyncEvaluator::BatchResult> promise;
+            promise.set_value(Operon::AsyncEvaluator::BatchResult(batch.size() - 1));
+            return promise.get_future();
+        }, batchSize};
+        CHECK_THROWS(truncated.Evaluate(rng, individuals, buf));
+        CHECK_THROWS(truncated(rng, individuals.front(), {}));
+        CHECK_THROWS(Operon::AsyncEvaluator{problem, lengths, 0});
+    }
+}
+
+TEST_CASE("Distributed fitness evaluation")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::Problem problem{ds, range, range};
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, problem.GetInputs()};
+    Operon::RandomGenerator rng{0};
+    Operon::DefaultDispatch dtable;
+
+    // two shards of unequal size over the same data
+    auto const& target = problem.TargetVariable().Name;
+    auto const mid = range.Size() / 3;
+    Operon::EvaluationWorker w1{dtable, problem.GetDataset(), target, Range{0, mid}};
+    Operon::EvaluationWorker w2{dtable, problem.GetDataset(), target, Range{mid, range.Size()}};
+    Operon::LocalEvaluationNode n1{w1};
+    Operon::LocalEvaluationNode n2{w2};
+
+    Operon::Vector<Operon::Scalar> buf(range.Size());
+    for (auto scaling : { false, true }) {
+        Operon::Evaluator<Operon::DefaultDispatch> evaluator{problem, dtable, Operon::MSE{}, scaling};
+        Operon::DistributedEvaluator distributed{problem, {n1, n2}, Operon::MSE{}, scaling};
+
+        Operon::Vector<Operon::Individual> individuals(10); // NOLINT
+        for (auto& ind : individuals) { ind.Genotype = creator(rng, 20, 1, 10); }
+        distributed.Evaluate(rng, individuals, buf);
+
+        for (auto& ind : individuals) {
+            auto const f = evaluator(rng, ind, buf);
+            CHECK(ind[0] == doctest::Approx(f.front()).epsilon(1e-3));
+        }
+    }
+
+    CHECK_THROWS(Operon::DistributedEvaluator{problem, {n1, n2}, Operon::MAE{}, /*linearScaling=*/true});
+}
+
+#if defined(HAVE_CUDA)
+TEST_CASE("GPU evaluation")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::Problem problem{ds, range, range};
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic | NodeType::Exp | NodeType::Sin | NodeType::Square};
+    Operon::BalancedTreeCreator creator{pset, problem.GetInputs()};
+    Operon::RandomGenerator rng{0};
+    Operon::DefaultDispatch dtable;
+    Operon::GpuDataset gpuDataset{problem.GetDataset()};
+    using TInterpreter = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+
+    auto close = [](auto x, auto y) { return (!std::isfinite(x) && !std::isfinite(y)) || std::abs(x - y) <= 1e-3 * std::max(Operon::Scalar{1}, std::abs(x)); };
+
+    SUBCASE("outputs and jacobian") {
+        for (auto i = 0; i < 5; ++i) {
+            auto tree = creator(rng, 20, 1, 10);
+            auto coeff = tree.GetCoefficients();
+            TInterpreter cpu{dtable, ds, tree};
+            Operon::GpuInterpreter gpu{gpuDataset, tree};
+            for (auto r : { range, Range{10, 100} }) {
+                CHECK(std::ranges::equal(cpu.Evaluate(coeff, r), gpu.Evaluate(coeff, r), close));
+                auto j1 = cpu.JacRev(coeff, r);
+                auto j2 = gpu.JacRev(coeff, r);
+                CHECK(std::equal(j1.data(), j1.data() + j1.size(), j2.data(), close));
+            }
+        }
+    }
+
+    SUBCASE("fitness") {
+        Operon::Vector<Operon::Scalar> buf(range.Size());
+        for (auto scaling : { false, true }) {
+            Operon::Evaluator<Operon::DefaultDispatch> evaluator{problem, dtable, Operon::MSE{}, scaling};
+            Operon::GpuEvaluator gpu{problem, gpuDataset, Operon::MSE{}, scaling};
+
+            Operon::Vector<Operon::Individual> individuals(10); // NOLINT
+            for (auto& ind : individuals) { ind.Genotype = creator(rng, 20, 1, 10); }
+            gpu.Evaluate(rng, individuals, buf);
+
+            for (auto& ind : individuals) {
+                auto const f = evaluator(rng, ind, buf);
+                CHECK(ind[0] == doctest::Approx(f.front()).epsilon(1e-3));
+            }
+        }
+        CHECK_THROWS(Operon::GpuEvaluator{problem, gpuDataset, Operon::MAE{}, /*linearScaling=*/true});
+    }
+
+    SUBCASE("local search") {
+        Operon::GpuLevenbergMarquardtOptimizer optimizer{gpuDataset, problem};
+        auto tree = creator(rng, 20, 1, 10);
+        auto summary = optimizer.Optimize(rng, tree);
+        CHECK(summary.FinalCost <= summary.InitialCost);
+    }
 }
+#endif
 } // namespace Operon::Test
@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <doctest/doctest.h>
+#include <random>
+#include <vector>
+
+#include "../operon_test.hpp"
+#include "operon/core/dataset.hpp"
+#include "operon/core/problem.hpp"
+#include "operon/core/pset.hpp"
+#include "operon/operators/creator.hpp"
+#include "operon/operators/crossover.hpp"
+#include "operon/operators/evaluator.hpp"
+#include "operon/operators/generator.hpp"
+#include "operon/operators/initializer.hpp"
+#include "operon/operators/mutation.hpp"
+#include "operon/operators/selector.hpp"
+
+namespace Operon::Test {
+
+TEST_CASE("Surrogate screening" * doctest::test_suite("[implementation]"))
+{
+    Util::SyntheticGpSetup setup;
+    auto& evaluator = setup.Evaluator;
+    Operon::OffspringSelectionGenerator generator { evaluator, setup.Crossover, setup.ChangeFunction, setup.Selector, setup.Selector };
+    generator.ComparisonFactor(0);
+
+    std::vector<Operon::Individual> pop(100);
+    for (auto& ind : pop) {
+        ind.Genotype = setup.TreeInitializer(setup.Random);
+        ind.Fitness = evaluator(setup.Random, ind, {});
+    }
+    generator.Prepare(pop);
+
+    // the accepted children, generated from the same seed
+    constexpr auto samples { 1000 };
+    auto generate = [&]() {
+        Operon::RandomGenerator random { 42 };
+        std::vector<Operon::Scalar> accepted;
+        for (auto i = 0; i < samples; ++i) {
+            if (auto child = generator(random, 1.0, 0.5, 0.0, {}); child) { accepted.push_back((*child)[0]); }
+        }
+        return accepted;
+    };
+
+    evaluator.Reset();
+    auto const expected = generate();
+    auto const evaluations = evaluator.TotalEvaluations();
+
+    SUBCASE("exact surrogate")
+    {
+        // the surrogate predicts the true fitness, so it discards exactly the children that would be rejected
+        Operon::Evaluator<decltype(setup.Table)> surrogate { setup.Problem, setup.Table };
+        generator.SetSurrogate(&surrogate, 0.0);
+        evaluator.Reset();
+        CHECK(generate() == expected);
+        CHECK(generator.ScreenedChildren() == samples);
+        CHECK(generator.DiscardedChildren() == samples - expected.size());
+        CHECK(evaluator.TotalEvaluations() < evaluations);
+    }
+
+    SUBCASE("sample surrogate")
+    {
+        auto sampleProblem = setup.Problem;
+        sampleProblem.SetTrainingRange(Operon::Range { 0, 20 });
+        Operon::Evaluator<decltype(setup.Table)> surrogate { sampleProblem, setup.Table };
+        generator.SetSurrogate(&surrogate);
+        evaluator.Reset();
+        (void) generate();
+        CHECK(generator.ScreenedChildren() == samples);
+        CHECK(generator.DiscardedChildren() > 0);
+        CHECK(evaluator.TotalEvaluations() < evaluations);
+    }
+}
+
+TEST_CASE("Duplicate rejection" * doctest::test_suite("[implementation]"))
+{
+    Util::SyntheticGpSetup setup;
+    auto& evaluator = setup.Evaluator;
+    Operon::BasicOffspringGenerator generator { evaluator, setup.Crossover, setup.ChangeFunction, setup.Selector, setup.Selector };
+
+    // the crossover of two copies of the same leaf is a copy of the leaf
+    auto leaf = Node(NodeType::Variable);
+    leaf.HashValue = setup.Problem.GetInputs().front();
+    std::vector<Operon::Individual> pop(10); // NOLINT
+    for (auto& ind : pop) {
+        ind.Genotype = Operon::Tree({ leaf }).UpdateNodes();
+        ind.Fitness = evaluator(setup.Random, ind, {});
+    }
+
+    constexpr auto retries { 2UL };
+    constexpr auto samples { 10UL };
+    generator.SetDuplicateRejection(true, retries);
+    generator.Prepare(pop);
+    evaluator.Reset();
+    for (auto i = 0UL; i < samples; ++i) {
+        auto child = generator(setup.Random, 1.0, 0.0, 0.0, {});
+        REQUIRE(child);
+        CHECK(child->Fitness == pop.front().Fitness);
+    }
+    CHECK(generator.RejectedDuplicates() == samples * (retries + 1));
+    CHECK(evaluator.TotalEvaluations() == 0);
+
+    // without the rejection every child is evaluated
+    generator.SetDuplicateRejection(false);
+    (void) generator(setup.Random, 1.0, 0.0, 0.0, {});
+    CHECK(evaluator.TotalEvaluations() == 1);
+}
+
+} // namespace Operon::Test
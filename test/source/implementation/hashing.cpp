@@ -5,10 +5,12 @@
 #include <unordered_set>
 #include <vstat/vstat.hpp>
 #include <fmt/core.h>
+#include <taskflow/taskflow.hpp>
 
 #include "operon/core/tree.hpp"
 #include "operon/core/dataset.hpp"
 #include "operon/core/distance.hpp"
+#include "operon/core/fingerprint.hpp"
 #include "operon/core/operator.hpp"
 #include "operon/formatter/formatter.hpp"
 #include "operon/core/pset.hpp"
@@ -115,6 +117,84 @@ TEST_CASE("Hash-based distance") {
     }
 }
 
+TEST_CASE("Fingerprint distance") {
+    Operon::RandomGenerator rd(1234);
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+
+    PrimitiveSet grammar;
+    grammar.SetConfig(PrimitiveSet::Arithmetic);
+    auto btc = BalancedTreeCreator { grammar, ds.VariableHashes() };
+    std::uniform_int_distribution<size_t> sizeDistribution(1, 100);
+
+    constexpr size_t n{200};
+    std::vector<Fingerprint> fingerprints;
+    std::vector<Operon::Vector<Operon::Hash>> treeHashes;
+    for (auto i = 0UL; i < n; ++i) {
+        auto tree = btc(rd, sizeDistribution(rd), 1, 1000);
+        (void) tree.Hash(Operon::HashMode::Strict);
+        fingerprints.emplace_back(tree);
+        Operon::Vector<Operon::Hash> hh(tree.Length());
+        std::transform(tree.Nodes().begin(), tree.Nodes().end(), hh.begin(), [](auto& node) { return node.CalculatedHashValue; });
+        std::sort(hh.begin(), hh.end());
+        hh.erase(std::unique(hh.begin(), hh.end()), hh.end()); // the fingerprint is a set
+        treeHashes.push_back(hh);
+    }
+
+    vstat::univariate_accumulator<double> acc;
+    for (size_t i = 0; i < n - 1; ++i) {
+        CHECK(Operon::Distance::Jaccard(fingerprints[i], fingerprints[i]) == 0);
+        for (size_t j = i + 1; j < n; ++j) {
+            acc(std::abs(Operon::Distance::Jaccard(fingerprints[i], fingerprints[j]) - Operon::Distance::Jaccard(treeHashes[i], treeHashes[j])));
+        }
+    }
+    vstat::univariate_statistics stats(acc);
+    CHECK(stats.mean < 0.05); // colliding bits make the trees look closer
+}
+
+TEST_CASE("Batched distances") {
+    Operon::RandomGenerator rd(1234);
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+
+    PrimitiveSet grammar;
+    grammar.SetConfig(PrimitiveSet::Arithmetic);
+    auto btc = BalancedTreeCreator { grammar, ds.VariableHashes() };
+    std::uniform_int_distribution<size_t> sizeDistribution(1, 100);
+
+    constexpr size_t n{200};
+    std::vector<Fingerprint> fingerprints;
+    std::vector<Operon::Vector<Operon::Hash>> treeHashes;
+    for (auto i = 0UL; i < n; ++i) {
+        auto tree = btc(rd, sizeDistribution(rd), 1, 1000);
+        (void) tree.Hash(Operon::HashMode::Strict);
+        fingerprints.emplace_back(tree);
+        Operon::Vector<Operon::Hash> hh(tree.Length());
+        std::transform(tree.Nodes().begin(), tree.Nodes().end(), hh.begin(), [](auto& node) { return node.CalculatedHashValue; });
+        std::sort(hh.begin(), hh.end());
+        treeHashes.push_back(hh);
+    }
+    treeHashes[3] = treeHashes[7]; // a duplicate
+
+    // the batched distances are the ones of the pairs
+    std::vector<double> row(n);
+    Operon::Distance::Jaccard(treeHashes[3], treeHashes, row);
+    for (auto i = 0UL; i < n; ++i) { CHECK(row[i] == Operon::Distance::Jaccard(treeHashes[3], treeHashes[i])); }
+    CHECK(row[7] == 0);
+    Operon::Distance::SorensenDice(treeHashes[3], treeHashes, row);
+    for (auto i = 0UL; i < n; ++i) { CHECK(row[i] == Operon::Distance::SorensenDice(treeHashes[3], treeHashes[i])); }
+    Operon::Distance::Jaccard(fingerprints[0], fingerprints, row);
+    for (auto i = 0UL; i < n; ++i) { CHECK(row[i] == Operon::Distance::Jaccard(fingerprints[0], fingerprints[i])); }
+
+    tf::Executor executor(4);
+    std::vector<double> matrix(n * (n - 1) / 2);
+    Operon::Distance::Jaccard(treeHashes, matrix, executor);
+    for (auto i = 0UL; i < n - 1; ++i) {
+        for (auto j = i + 1; j < n; ++j) {
+            CHECK(matrix[Operon::Distance::PairIndex(i, j, n)] == Operon::Distance::Jaccard(treeHashes[i], treeHashes[j]));
+        }
+    }
+    CHECK(Operon::Distance::PairIndex(n - 2, n - 1, n) == matrix.size() - 1);
+}
+
 TEST_CASE("Hash collisions") {
     size_t n = 100000;
     size_t maxLength = 200;
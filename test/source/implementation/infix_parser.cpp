@@ -2,6 +2,7 @@
 // SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
 
 #include <doctest/doctest.h>
+#include <taskflow/taskflow.hpp>
 
 #include "operon/hash/hash.hpp"
 #include "operon/interpreter/interpreter.hpp"
@@ -193,6 +194,24 @@ TEST_SUITE("[implementation]")
         fmt::print("{}\n", Operon::PostfixFormatter::Format(tree, vars_names));
     }
 
+    TEST_CASE("Parser instance")
+    {
+        Operon::Dataset ds("./data/Poly-10.csv", true);
+        Operon::Map<std::string, Operon::Hash> vars;
+        for (auto const& v : ds.GetVariables()) {
+            vars.insert({ v.Name, v.Hash });
+        }
+        InfixParser const parser{vars};
+
+        for (auto const* expr : { "X1 + X2 * X3", "sin(X1) / (1 + X2 ^ 2)", "1 + 2 + 3 + 4 + 5 + X1 + X2 + X3", "exp(-X4) - log(abs(X5))" }) {
+            auto t1 = InfixParser::Parse(expr, vars);
+            auto t2 = parser(expr);
+            CHECK(t1.Hash(Operon::HashMode::Strict).HashValue() == t2.Hash(Operon::HashMode::Strict).HashValue());
+            CHECK(t1.Length() == t2.Length());
+        }
+        CHECK_THROWS(parser("X1 + Y"));
+    }
+
     TEST_CASE("Formatter")
     {
         SUBCASE("Analytical quotient")
@@ -219,6 +238,66 @@ TEST_SUITE("[implementation]")
             fmt::print("{} = {}\n", InfixFormatter::Format(t1, map, 3), v1);
             fmt::print("{} = {}\n", InfixFormatter::Format(t2, map, 3), v2);
         }
+
+        SUBCASE("C++ code")
+        {
+            Operon::Map<std::string, Operon::Hash> vars{{"X1", 1}, {"X2", 2}};
+            Operon::Map<Operon::Hash, std::string> names{{1, "X1"}, {2, "X2"}};
+            auto tree = InfixParser::Parse("sin(X2) + 2 * log(abs(X1 - X2))", vars);
+            auto code = CppFormatter::Format(tree, names, "f");
+            fmt::print("{}\n", code);
+
+            CHECK(code.find("inline auto f(T const* const* x, T* out, std::size_t n) -> void") != std::string::npos);
+            CHECK(code.find("std::sin(") != std::string::npos);
+            CHECK(code.find("std::log(std::abs(") != std::string::npos);
+            CHECK(code.find("x[0]: X") != std::string::npos);
+            CHECK(code.find("x[1]: X") != std::string::npos);
+            CHECK(code.find("x[2]") == std::string::npos);
+
+            std::vector<Tree> const trees{ tree, InfixParser::Parse("X1 * X1", vars) };
+            auto module = CppFormatter::FormatModule(trees, names);
+            CHECK(module.find("inline auto model_0(") != std::string::npos);
+            CHECK(module.find("inline auto model_1(") != std::string::npos);
+            CHECK(module.find("extern \"C\" auto model_1_evaluate(") != std::string::npos);
+            CHECK(module.find("#include <cmath>") == module.rfind("#include <cmath>"));
+
+            tree.Nodes().back().Type = NodeType::Dynamic;
+            CHECK_THROWS_AS(CppFormatter::Format(tree, names), std::runtime_error);
+        }
+
+        SUBCASE("Buffers and bulk formatting")
+        {
+            Operon::Map<std::string, Operon::Hash> vars{{"X1", 1}, {"X2", 2}};
+            Operon::Map<Operon::Hash, std::string> names{{1, "X1"}, {2, "X2"}};
+            std::vector<Tree> trees;
+            for (auto const* infix : { "sin(X2) + 2 * log(abs(X1 - X2))", "-3.5 * X1 / (X2 ^ 2)", "exp(X1) - 1" }) {
+                trees.push_back(InfixParser::Parse(infix, vars));
+            }
+
+            fmt::memory_buffer buffer;
+            for (auto const& tree : trees) {
+                buffer.clear();
+                InfixFormatter::Format(tree, names, buffer, 4);
+                CHECK(fmt::to_string(buffer) == InfixFormatter::Format(tree, names, 4));
+            }
+
+            tf::Executor executor(2);
+            auto const infix = InfixFormatter::Format(trees, names, executor, 4);
+            auto const postfix = PostfixFormatter::Format(trees, names, executor, 4);
+            REQUIRE(infix.size() == trees.size());
+            REQUIRE(postfix.size() == trees.size());
+            for (auto i = 0UL; i < trees.size(); ++i) {
+                CHECK(infix[i] == InfixFormatter::Format(trees[i], names, 4));
+                CHECK(postfix[i] == PostfixFormatter::Format(trees[i], names, 4));
+            }
+
+            // from inside a worker of the same executor, eg. from a report task
+            std::vector<std::string> nested;
+            tf::Taskflow taskflow;
+            taskflow.emplace([&]() { nested = InfixFormatter::Format(trees, names, executor, 4); });
+            executor.run(taskflow).wait();
+            CHECK(nested == infix);
+        }
     }
 }
 
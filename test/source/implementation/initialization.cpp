@@ -14,6 +14,24 @@
 
 namespace Operon::Test {
 
+namespace {
+    // the creators fill in the node metadata themselves, it must match a full update
+    auto CheckNodeMetadata(Tree const& tree) -> void
+    {
+        auto updated = Tree(tree.Nodes()).UpdateNodes();
+        auto const& nodes = tree.Nodes();
+        REQUIRE(nodes.size() == updated.Length());
+        for (auto i = 0UL; i < nodes.size(); ++i) {
+            auto const& a = nodes[i];
+            auto const& b = updated[i];
+            CHECK(a.Length == b.Length);
+            CHECK(a.Depth == b.Depth);
+            CHECK(a.Level == b.Level);
+            CHECK(a.Parent == b.Parent);
+        }
+    }
+} // namespace
+
 TEST_CASE("Sample nodes from grammar")
 {
     PrimitiveSet grammar;
@@ -55,6 +73,43 @@ TEST_CASE("Sample nodes from grammar")
     REQUIRE(chi <= criticalValue);
 }
 
+TEST_CASE("Sample nodes with the alias method")
+{
+    PrimitiveSet grammar;
+    grammar.SetConfig(PrimitiveSet::Arithmetic | NodeType::Exp | NodeType::Log);
+    grammar.SetFrequency(Node(NodeType::Add), 4);
+    grammar.Disable(Node(NodeType::Div).HashValue);
+    Operon::RandomGenerator rd(1234);
+
+    for (auto [minArity, maxArity] : { std::pair{0UL, 0UL}, std::pair{1UL, 2UL}, std::pair{0UL, 100UL} }) {
+        // the frequencies of the enabled symbols with a matching arity
+        std::vector<double> expected(NodeTypes::Count, 0);
+        for (auto const& [k, v] : grammar.Primitives()) {
+            auto const& [node, freq, amin, amax] = v;
+            if (!node.IsEnabled || minArity > amax || maxArity < amin) { continue; }
+            expected[NodeTypes::GetIndex(node.Type)] = static_cast<double>(freq);
+        }
+        auto const sum = std::reduce(expected.begin(), expected.end());
+
+        std::vector<double> observed(NodeTypes::Count, 0);
+        const size_t nTrials = 100'000;
+        for (auto i = 0U; i < nTrials; ++i) {
+            auto node = grammar.SampleRandomSymbol(rd, minArity, maxArity);
+            REQUIRE(node.Arity >= minArity);
+            REQUIRE(node.Arity <= maxArity);
+            ++observed[NodeTypes::GetIndex(node.Type)];
+        }
+        for (auto i = 0U; i < observed.size(); ++i) {
+            CHECK(std::abs(observed[i] / nTrials - expected[i] / sum) < 0.01);
+        }
+    }
+    CHECK_THROWS(grammar.SampleRandomSymbol(rd, 3, 3));
+
+    // the tables are rebuilt when the primitive set changes
+    grammar.SetConfig(NodeType::Constant);
+    CHECK(grammar.SampleRandomSymbol(rd, 0, 2).Type == NodeType::Constant);
+}
+
 auto GenerateTrees(Operon::RandomGenerator& random, Operon::CreatorBase& creator, std::vector<size_t> lengths, size_t maxDepth) -> std::vector<Tree>
 {
     std::vector<Tree> trees;
@@ -141,6 +196,25 @@ TEST_CASE("GROW")
         fmt::print("{}\n", TreeFormatter::Format(tree, ds));
     }
 
+    SUBCASE("Node metadata")
+    {
+        for (auto i = 0; i < 1000; ++i) {
+            CheckNodeMetadata(gtc(random, 0, 1, maxDepth));
+        }
+
+        std::vector<Operon::RandomGenerator> rngs;
+        rngs.reserve(100);
+        for (auto i = 0; i < 100; ++i) {
+            rngs.emplace_back(random());
+        }
+        std::vector<Tree> trees(rngs.size());
+        gtc.Create(rngs, lengths, 1, maxDepth, trees);
+        for (auto const& tree : trees) {
+            CHECK(tree.Depth() <= maxDepth);
+            CheckNodeMetadata(tree);
+        }
+    }
+
     SUBCASE("Symbol frequencies")
     {
         std::generate(lengths.begin(), lengths.end(), [&]() { return sizeDistribution(random); });
@@ -255,6 +329,18 @@ TEST_CASE("BTC")
         fmt::print("{}\n", TreeFormatter::Format(tree, ds));
     }
 
+    SUBCASE("Batch creation")
+    {
+        std::generate(lengths.begin(), lengths.end(), [&]() { return sizeDistribution(random); });
+        std::vector<Operon::RandomGenerator> rngs;
+        for (auto i = 0UL; i < n; ++i) { rngs.emplace_back(random()); }
+        std::vector<Tree> trees(n);
+        btc.Create(rngs, lengths, 1, maxDepth, trees);
+        for (auto i = 0UL; i < n; ++i) {
+            CHECK(trees[i].Length() == lengths[i]);
+        }
+    }
+
     SUBCASE("Symbol frequencies")
     {
         std::generate(lengths.begin(), lengths.end(), [&]() { return sizeDistribution(random); });
@@ -358,6 +444,25 @@ TEST_CASE("PTC2")
         fmt::print("{}\n", TreeFormatter::Format(tree, ds));
     }
 
+    SUBCASE("Node metadata")
+    {
+        for (auto i = 0; i < 1000; ++i) {
+            CheckNodeMetadata(ptc(random, sizeDistribution(random), 1, maxDepth));
+        }
+
+        std::generate(lengths.begin(), lengths.end(), [&]() { return sizeDistribution(random); });
+        std::vector<Operon::RandomGenerator> rngs;
+        rngs.reserve(100);
+        for (auto i = 0; i < 100; ++i) {
+            rngs.emplace_back(random());
+        }
+        std::vector<Tree> trees(rngs.size());
+        ptc.Create(rngs, lengths, 1, maxDepth, trees);
+        for (auto const& tree : trees) {
+            CheckNodeMetadata(tree);
+        }
+    }
+
     SUBCASE("Symbol frequencies")
     {
         std::generate(lengths.begin(), lengths.end(), [&]() { return sizeDistribution(random); });
@@ -430,4 +535,45 @@ TEST_CASE("PTC2")
         }
     }
 }
+
+TEST_CASE("Unique initialization")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto inputs = ds.VariableHashes();
+    std::erase(inputs, ds.GetVariable("Y")->Hash);
+
+    PrimitiveSet grammar;
+    grammar.SetConfig(PrimitiveSet::Arithmetic);
+    BalancedTreeCreator btc { grammar, inputs };
+
+    // small trees, so that the plain initializer produces many duplicates
+    UniformTreeInitializer treeInit(btc);
+    treeInit.ParameterizeDistribution(1, 3);
+    treeInit.SetMaxDepth(3);
+    UniqueTreeInitializer uniqueInit(treeInit);
+
+    size_t const n = 100;
+    std::vector<Operon::RandomGenerator> rngs;
+    for (auto i = 0UL; i < n; ++i) { rngs.emplace_back(i); }
+    std::vector<Tree> trees(n);
+
+    auto distinct = [](auto const& trees) {
+        Operon::Set<Operon::Hash> hashes;
+        for (auto const& t : trees) { hashes.insert(t.Hash(Operon::HashMode::Relaxed).HashValue()); }
+        return hashes.size();
+    };
+
+    treeInit.Initialize(rngs, trees);
+    auto const plain = distinct(trees);
+    CHECK(plain < n);
+
+    uniqueInit.Initialize(rngs, trees);
+    CHECK(distinct(trees) > plain);
+    CHECK(uniqueInit.Rejected() > 0);
+    CHECK(uniqueInit.Size() == distinct(trees));
+
+    uniqueInit.Reset();
+    CHECK(uniqueInit.Size() == 0);
+    CHECK(uniqueInit.Rejected() == 0);
+}
 } // namespace Operon::Test
@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <doctest/doctest.h>
+#include <fmt/core.h>
+#include <sstream>
+
+#include "operon/algorithms/checkpoint.hpp"
+#include "operon/algorithms/island_model.hpp"
+#include "operon/core/dataset.hpp"
+#include "operon/core/pset.hpp"
+#include "operon/core/serialization.hpp"
+#include "operon/operators/creator.hpp"
+#include "operon/operators/initializer.hpp"
+
+namespace Operon::Test {
+TEST_CASE("Migrant encoding")
+{
+    auto ds = Dataset("../data/Poly-10.csv", true);
+    auto inputs = ds.VariableHashes();
+    std::erase(inputs, ds.GetVariable("Y")->Hash);
+
+    PrimitiveSet grammar;
+    grammar.SetConfig(PrimitiveSet::Arithmetic | NodeType::Log | NodeType::Exp);
+    BalancedTreeCreator btc { grammar, inputs, /* bias= */ 0.0 };
+    UniformCoefficientInitializer cfi;
+
+    Operon::RandomGenerator random(1234);
+    Operon::Vector<Individual> individuals(10, Individual(2)); // NOLINT
+    for (auto& ind : individuals) {
+        ind.Genotype = btc(random, 20, 1, 100); // NOLINT
+        cfi(random, ind.Genotype);
+        ind[0] = std::uniform_real_distribution<Operon::Scalar>{0, 1}(random);
+        ind[1] = static_cast<Operon::Scalar>(ind.Genotype.Length());
+    }
+
+    auto const bytes = MigrantCodec::Encode(individuals);
+    auto const decoded = MigrantCodec::Decode(bytes);
+    fmt::print("{} individuals encoded in {} bytes\n", individuals.size(), bytes.size());
+
+    REQUIRE(decoded.size() == individuals.size());
+    for (auto i = 0UL; i < individuals.size(); ++i) {
+        CHECK(decoded[i].Fitness == individuals[i].Fitness);
+        CHECK(decoded[i].Genotype.Hash(Operon::HashMode::Strict).HashValue() == individuals[i].Genotype.Hash(Operon::HashMode::Strict).HashValue());
+        CHECK(decoded[i].Genotype.GetCoefficients() == individuals[i].Genotype.GetCoefficients());
+    }
+
+    SUBCASE("truncated message")
+    {
+        std::vector<uint8_t> truncated(bytes.begin(), bytes.begin() + static_cast<std::ptrdiff_t>(bytes.size() / 2));
+        CHECK_THROWS(MigrantCodec::Decode(truncated));
+    }
+
+    SUBCASE("local channel")
+    {
+        LocalMigrationChannel channel(3);
+        channel.Send(1, bytes);
+        channel.Send(1, bytes);
+        CHECK(channel.Receive(0).empty());
+        CHECK(channel.Receive(1).size() == 2);
+        CHECK(channel.Receive(1).empty());
+    }
+
+    SUBCASE("population stream")
+    {
+        std::stringstream stream;
+        Serialization::WritePopulation(stream, individuals);
+        auto const population = Serialization::ReadPopulation(stream);
+        REQUIRE(population.size() == individuals.size());
+        for (auto i = 0UL; i < individuals.size(); ++i) {
+            CHECK(population[i].Fitness == individuals[i].Fitness);
+            CHECK(population[i].Genotype.Hash(Operon::HashMode::Strict).HashValue() == individuals[i].Genotype.Hash(Operon::HashMode::Strict).HashValue());
+        }
+
+        auto const contents = stream.str();
+        std::stringstream truncated(contents.substr(0, contents.size() / 2));
+        CHECK_THROWS_AS(Serialization::ReadPopulation(truncated), std::runtime_error);
+
+        auto corrupted = contents;
+        corrupted[4] = 42; // NOLINT: version
+        std::stringstream wrongVersion(corrupted);
+        CHECK_THROWS_AS(Serialization::ReadPopulation(wrongVersion), std::runtime_error);
+    }
+
+    SUBCASE("checkpoint")
+    {
+        AlgorithmState state;
+        state.Generation = 42; // NOLINT
+        state.Elapsed = 1.5;   // NOLINT
+        state.Random = random.get_state();
+        state.Rngs = { Operon::RandomGenerator(1).get_state(), Operon::RandomGenerator(2).get_state() };
+        state.Counters = { 1, 2, 3, 4 };
+        state.Parents = individuals;
+
+        std::stringstream stream;
+        WriteCheckpoint(stream, state);
+        auto const restored = ReadCheckpoint(stream);
+        CHECK(restored.Generation == state.Generation);
+        CHECK(restored.Elapsed == state.Elapsed);
+        CHECK(restored.Random == state.Random);
+        CHECK(restored.Rngs == state.Rngs);
+        CHECK(restored.Counters == state.Counters);
+        REQUIRE(restored.Parents.size() == individuals.size());
+        CHECK(restored.Parents.front().Genotype.Hash(Operon::HashMode::Strict).HashValue() == individuals.front().Genotype.Hash(Operon::HashMode::Strict).HashValue());
+
+        // the generator continues where the saved one stopped
+        Operon::RandomGenerator resumed(0);
+        resumed.set_state(restored.Random);
+        CHECK(resumed() == random());
+
+        auto const contents = stream.str();
+        std::stringstream truncated(contents.substr(0, contents.size() - 1));
+        CHECK_THROWS_AS(ReadCheckpoint(truncated), std::runtime_error);
+    }
+}
+} // namespace Operon::Test
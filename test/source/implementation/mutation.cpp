@@ -1,7 +1,11 @@
 // SPDX-License-Identifier: MIT
 // SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
 
+#include <algorithm>
 #include <doctest/doctest.h>
+#include <initializer_list>
+#include <utility>
+#include <vector>
 #include <fmt/core.h>
 
 #include "operon/core/dataset.hpp"
@@ -48,4 +52,52 @@ TEST_CASE("InsertSubtreeMutation")
     fmt::print("{}\n", TreeFormatter::Format(child, ds));
 }
 
+TEST_CASE("Subtree mutations splice the nodes")
+{
+    PrimitiveSet grammar;
+    grammar.SetConfig(PrimitiveSet::Arithmetic | NodeType::Log | NodeType::Exp);
+
+    std::vector<Operon::Hash> inputs{ 1, 2, 3 };
+    BalancedTreeCreator btc { grammar, inputs, /* bias= */ 0.0 };
+    UniformCoefficientInitializer cfi;
+    Operon::RandomGenerator random(1234);
+
+    constexpr auto maxDepth{1000};
+    constexpr auto maxLength{100};
+
+    InsertSubtreeMutation insert(btc, cfi, maxDepth, maxLength);
+    ReplaceSubtreeMutation replace(btc, cfi, maxDepth, maxLength);
+    RemoveSubtreeMutation remove(grammar);
+
+    // the metadata of the mutated nodes must match a full update
+    auto check = [](Tree const& tree) {
+        auto updated = Tree(tree.Nodes()).UpdateNodes();
+        for (auto i = 0UL; i < tree.Length(); ++i) {
+            auto const& a = tree[i];
+            auto const& b = std::as_const(updated)[i];
+            CHECK(a.Length == b.Length);
+            CHECK(a.Depth == b.Depth);
+            CHECK(a.Level == b.Level);
+            CHECK(a.Parent == b.Parent);
+        }
+    };
+
+    for (auto i = 0; i < 1000; ++i) {
+        auto parent = btc(random, std::uniform_int_distribution<size_t>(1, maxLength / 2)(random), 1, maxDepth);
+        auto const original = std::as_const(parent).Nodes();
+
+        // a copy of the parent shares its nodes, the mutation must not modify them
+        for (MutatorBase const* mut : std::initializer_list<MutatorBase const*>{ &insert, &replace, &remove }) {
+            auto child = (*mut)(random, parent);
+            check(child);
+            auto const& nodes = std::as_const(parent).Nodes();
+            CHECK(std::equal(original.begin(), original.end(), nodes.begin(), nodes.end(), [](auto const& a, auto const& b) { return a.HashValue == b.HashValue && a.Arity == b.Arity && a.Length == b.Length; }));
+
+            // the child is not shared, it is spliced in place
+            auto grandchild = (*mut)(random, std::move(child));
+            check(grandchild);
+        }
+    }
+}
+
 }
@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <numeric>
 #include <ranges>
 #include <doctest/doctest.h>
 #include <random>
@@ -12,6 +13,7 @@
 #include <fmt/ranges.h>
 
 #include "operon/algorithms/nsga2.hpp"
+#include "operon/algorithms/solution_archive.hpp"
 #include "operon/core/dataset.hpp"
 #include "operon/core/pset.hpp"
 #include "operon/hash/hash.hpp"
@@ -115,6 +117,166 @@ TEST_CASE("non-dominated sort" * doctest::test_suite("[implementation]"))
         return true;
     };
 
+    SUBCASE("parallel sort") {
+        std::uniform_real_distribution<Operon::Scalar> dist(0, 1);
+        tf::Executor executor(4); // NOLINT
+        RankIntersectSorter rs;
+        DominanceDegreeSorter dds;
+        for (auto m : { 2, 3, 5 }) {
+            auto pop = initializePop(rd, dist, 2000, m); // NOLINT
+            for (NondominatedSorterBase const& sorter : std::initializer_list<std::reference_wrapper<NondominatedSorterBase const>>{ rs, dds }) {
+                sorter.SetExecutor(nullptr);
+                auto expected = sorter(pop);
+                sorter.SetExecutor(&executor);
+                auto fronts = sorter(pop);
+                for (auto& f : fronts) { std::ranges::sort(f); }
+                for (auto& f : expected) { std::ranges::sort(f); }
+                CHECK(fronts == expected);
+            }
+        }
+
+        // the parallel dominance degree matrix compares the values like the serial one, also with ties and a tolerance
+        std::uniform_int_distribution<int> discrete(0, 20); // NOLINT
+        for (auto m : { 2, 3 }) {
+            for (auto ties : { false, true }) {
+                auto pop = initializePop(rd, dist, 1000, m); // NOLINT
+                if (ties) {
+                    for (auto& ind : pop) {
+                        for (auto& f : ind.Fitness) { f = static_cast<Operon::Scalar>(discrete(rd)); }
+                    }
+                }
+                for (auto eps : { Operon::Scalar{0}, ties ? Operon::Scalar{1} : Operon::Scalar{0.05} }) { // NOLINT
+                    dds.SetExecutor(nullptr);
+                    auto expected = dds(pop, eps);
+                    dds.SetExecutor(&executor);
+                    auto fronts = dds(pop, eps);
+                    for (auto& f : fronts) { std::ranges::sort(f); }
+                    for (auto& f : expected) { std::ranges::sort(f); }
+                    CHECK(fronts == expected);
+                }
+            }
+        }
+    }
+
+    SUBCASE("incremental insert") {
+        std::uniform_real_distribution<Operon::Scalar> dist(0, 1);
+        for (auto m : { 2, 3, 5 }) {
+            auto pop = initializePop(rd, dist, 1000, m); // NOLINT
+            // sort a random half of the population, then insert the other half in random order
+            std::vector<size_t> indices(pop.size());
+            std::iota(indices.begin(), indices.end(), size_t{0});
+            std::shuffle(indices.begin(), indices.end(), rd);
+            auto const half = indices.size() / 2;
+            std::vector<size_t> known(indices.begin(), indices.begin() + static_cast<std::ptrdiff_t>(half));
+            std::ranges::sort(known);
+            std::vector<Individual> subset;
+            for (auto i : known) { subset.push_back(pop[i]); }
+
+            RankIntersectSorter rs;
+            IncrementalSorter inc;
+            auto fronts = rs(subset);
+            for (auto& f : fronts) {
+                for (auto& i : f) { i = known[i]; }
+            }
+            inc.Insert(pop, fronts, Operon::Span<size_t const>{indices}.subspan(half), 0);
+
+            auto expected = rs(pop);
+            for (auto& f : fronts) { std::ranges::sort(f); }
+            for (auto& f : expected) { std::ranges::sort(f); }
+            CHECK(fronts == expected);
+        }
+    }
+
+    SUBCASE("adaptive sort") {
+        // a continuous error and a discrete length, like the objectives of a GP run
+        std::uniform_real_distribution<Operon::Scalar> dist(0, 1);
+        std::uniform_int_distribution<int> length(1, 50); // NOLINT
+        for (auto m : { 2, 3, 4 }) {
+            auto pop = initializePop(rd, dist, 2000, m); // NOLINT
+            for (auto& ind : pop) { ind[1] = static_cast<Operon::Scalar>(length(rd)); }
+            CHECK(AdaptiveSorter::TieRatio(pop) > 0);
+
+            RankIntersectSorter rs;
+            AdaptiveSorter as;
+            auto expected = rs(pop);
+            for (auto& f : expected) { std::ranges::sort(f); }
+            // the first call calibrates, the second one uses the chosen sorter
+            for (auto i = 0; i < 2; ++i) {
+                auto fronts = as(pop);
+                for (auto& f : fronts) { std::ranges::sort(f); }
+                CHECK(fronts == expected);
+            }
+        }
+
+        // concurrent calls, calibrating the same shapes at once
+        {
+            AdaptiveSorter as;
+            RankIntersectSorter rs;
+            std::vector<std::vector<Individual>> pops;
+            std::vector<RankIntersectSorter::Result> expected;
+            for (auto i = 0; i < 8; ++i) { // NOLINT
+                auto& p = pops.emplace_back(initializePop(rd, dist, 500, 4)); // NOLINT
+                auto& e = expected.emplace_back(rs(p));
+                for (auto& f : e) { std::ranges::sort(f); }
+            }
+            std::vector<RankIntersectSorter::Result> results(pops.size());
+            std::vector<std::thread> threads;
+            for (auto i = 0UL; i < pops.size(); ++i) {
+                threads.emplace_back([&, i]() {
+                    for (auto k = 0; k < 3; ++k) { results[i] = as(pops[i]); }
+                });
+            }
+            for (auto& t : threads) { t.join(); }
+            for (auto i = 0UL; i < pops.size(); ++i) {
+                for (auto& f : results[i]) { std::ranges::sort(f); }
+                CHECK(results[i] == expected[i]);
+            }
+        }
+
+        // without calibration the fixed rule is used
+        AdaptiveSorter as(0);
+        auto pop = initializePop(rd, dist, 100, 2); // NOLINT
+        CHECK(dynamic_cast<BiObjectiveSorter const*>(&as.Choice(pop)) != nullptr);
+        pop = initializePop(rd, dist, 100, 3); // NOLINT
+        CHECK(dynamic_cast<TriObjectiveSorter const*>(&as.Choice(pop)) != nullptr);
+        pop = initializePop(rd, dist, 100, 4); // NOLINT
+        CHECK(dynamic_cast<RankIntersectSorter const*>(&as.Choice(pop)) != nullptr);
+        CHECK(AdaptiveSorter::TieRatio(pop) == 0);
+    }
+
+    SUBCASE("sweep sort") {
+        // continuous and discrete objectives (with ties and duplicates)
+        std::uniform_real_distribution<Operon::Scalar> dist(0, 1);
+        std::uniform_int_distribution<int> discrete(0, 20); // NOLINT
+        RankIntersectSorter rs;
+        BiObjectiveSorter bi;
+        TriObjectiveSorter tri;
+        for (auto m : { 2, 3 }) {
+            for (auto ties : { false, true }) {
+                auto pop = initializePop(rd, dist, 2000, m); // NOLINT
+                if (ties) {
+                    for (auto& ind : pop) {
+                        for (auto& f : ind.Fitness) { f = static_cast<Operon::Scalar>(discrete(rd)); }
+                    }
+                }
+                auto expected = rs(pop);
+                auto fronts = m == 2 ? bi(pop) : tri(pop);
+                for (auto& f : fronts) { std::ranges::sort(f); }
+                for (auto& f : expected) { std::ranges::sort(f); }
+                CHECK(fronts == expected);
+
+                // with a tolerance the fronts are those of the eps-dominance
+                Operon::Scalar const eps = ties ? 1 : 0.05; // NOLINT
+                auto expectedEps = DominanceDegreeSorter{}(pop, eps);
+                auto frontsEps = m == 2 ? bi(pop, eps) : tri(pop, eps);
+                for (auto& f : frontsEps) { std::ranges::sort(f); }
+                for (auto& f : expectedEps) { std::ranges::sort(f); }
+                CHECK(frontsEps == expectedEps);
+                CHECK(frontsEps != fronts);
+            }
+        }
+    }
+
     SUBCASE("compare sorters") {
         std::array ns { 100 ,1000, 10000,50000, 100000 };
         std::array ms { 2, 3, 4, 5, 6, 7, 8, 9, 10, 13, 17, 20, 23, 40 };
@@ -126,8 +288,9 @@ TEST_CASE("non-dominated sort" * doctest::test_suite("[implementation]"))
         Operon::DeductiveSorter ds;
         Operon::EfficientBinarySorter ebs;
         Operon::EfficientSequentialSorter ess;
-        std::vector<std::reference_wrapper<NondominatedSorterBase const>> sorters{ ro, mnds, bos, hnds, ds, ebs, ess };
-        std::vector<std::string> names{ "ro", "ms", "bos", "hs", "ds", "ebs", "ess" };
+        Operon::IncrementalSorter inc;
+        std::vector<std::reference_wrapper<NondominatedSorterBase const>> sorters{ ro, mnds, bos, hnds, ds, ebs, ess, inc };
+        std::vector<std::string> names{ "ro", "ms", "bos", "hs", "ds", "ebs", "ess", "inc" };
         fmt::print("rs -- ");
         for (auto i = 0; i < std::ssize(sorters); ++i) {
             auto const& sorter = sorters[i].get();
@@ -523,4 +686,118 @@ TEST_CASE("nsga2_pareto_fronts_test")
     }
 }
 
+TEST_CASE("solution archive" * doctest::test_suite("[implementation]"))
+{
+    Operon::RandomGenerator rd(1234);
+    std::uniform_real_distribution<Operon::Scalar> dist(0, 1);
+    Operon::ParetoDominance dom;
+
+    for (auto m : { 2UL, 3UL }) {
+        std::vector<Individual> pop(1000); // NOLINT
+        for (auto& ind : pop) {
+            ind.Fitness.resize(m);
+            for (auto& f : ind.Fitness) { f = dist(rd); }
+        }
+
+        // concurrent insertion, single and batched
+        SolutionArchive archive;
+        std::vector<std::thread> threads;
+        auto const t{4UL};
+        for (auto i = 0UL; i < t; ++i) {
+            threads.emplace_back([&, i]() {
+                for (auto j = i; j < pop.size(); j += t) {
+                    if (j % 2 == 0) { archive.Insert(pop[j]); } else { archive.Insert(Operon::Span<Individual const>{ &pop[j], 1 }); }
+                }
+            });
+        }
+        for (auto& th : threads) { th.join(); }
+
+        auto nondominated = std::ranges::count_if(pop, [&](auto const& y) {
+            return std::ranges::none_of(pop, [&](auto const& x) { return dom(x.Fitness, y.Fitness) == Dominance::Left; });
+        });
+        CHECK(std::ssize(archive.Solutions()) == nondominated);
+        for (auto const& y : archive.Solutions()) {
+            CHECK(std::ranges::none_of(pop, [&](auto const& x) { return dom(x.Fitness, y.Fitness) == Dominance::Left; }));
+        }
+        CHECK(std::ranges::is_sorted(archive.Solutions(), [](auto const& a, auto const& b) { return std::ranges::lexicographical_compare(a.Fitness, b.Fitness); }));
+    }
+}
+
+TEST_CASE("solution archive with epsilon boxes" * doctest::test_suite("[implementation]"))
+{
+    Operon::RandomGenerator rd(1234);
+    std::uniform_real_distribution<Operon::Scalar> dist(0, 1);
+    constexpr Operon::Scalar eps{0.05};
+
+    auto box = [&](auto const& ind) {
+        std::vector<Operon::Scalar> b;
+        for (auto f : ind.Fitness) { b.push_back(std::floor(f / eps)); }
+        return b;
+    };
+    // every coordinate of the box of a is smaller or equal
+    auto covers = [&](auto const& a, auto const& b) {
+        auto const x = box(a);
+        auto const y = box(b);
+        return std::ranges::equal(x, y, std::less_equal{});
+    };
+
+    for (auto m : { 2UL, 3UL }) {
+        // points around the simplex, so that the front spans many boxes
+        std::vector<Individual> pop(5000); // NOLINT
+        for (auto& ind : pop) {
+            ind.Fitness.resize(m);
+            for (auto& f : ind.Fitness) { f = dist(rd); }
+            auto const sum = std::reduce(ind.Fitness.begin(), ind.Fitness.end());
+            for (auto& f : ind.Fitness) { f = (f / sum) + (dist(rd) / 10); } // NOLINT
+        }
+
+        SolutionArchive archive;
+        archive.SetEpsilon(eps);
+        CHECK(archive.GetEpsilon() == eps);
+        for (auto const& ind : pop) { archive.Insert(ind); }
+
+        // filtering an unbounded archive gives the same solutions
+        SolutionArchive unbounded;
+        unbounded.Insert(pop);
+        auto const all = unbounded.Size();
+        unbounded.SetEpsilon(eps);
+
+        auto const solutions = archive.Solutions();
+        CHECK(solutions.size() < all);
+        CHECK(unbounded.Size() == solutions.size());
+        if (m == 2) { CHECK(solutions.size() <= static_cast<size_t>(2 / eps)); }
+
+        // the boxes of the archive do not dominate each other and are sorted
+        for (auto i = 0UL; i < solutions.size(); ++i) {
+            for (auto j = 0UL; j < solutions.size(); ++j) {
+                if (i != j) { CHECK(!covers(solutions[i], solutions[j])); }
+            }
+        }
+        CHECK(std::ranges::is_sorted(solutions, [&](auto const& a, auto const& b) { return std::ranges::lexicographical_compare(box(a), box(b)); }));
+
+        // every individual is in the box of a solution or in a box dominated by one
+        for (auto const& y : pop) {
+            CHECK(std::ranges::any_of(solutions, [&](auto const& x) { return covers(x, y); }));
+        }
+    }
+}
+
+TEST_CASE("pareto dominance kernel" * doctest::test_suite("[implementation]"))
+{
+    // the kernels for contiguous fitness vectors give the same result as the iterator version (with ties)
+    Operon::RandomGenerator rd(1234);
+    std::uniform_int_distribution<int> dist(0, 3);
+    Operon::ParetoDominance dom;
+    for (auto m = 1UL; m <= 20; ++m) { // NOLINT
+        for (auto eps : { Operon::Scalar{0}, Operon::Scalar{0.3} }) {
+            for (auto i = 0; i < 1000; ++i) { // NOLINT
+                Operon::Vector<Operon::Scalar> a(m);
+                Operon::Vector<Operon::Scalar> b(m);
+                for (auto& v : a) { v = static_cast<Operon::Scalar>(dist(rd)) / 2; }
+                for (auto& v : b) { v = static_cast<Operon::Scalar>(dist(rd)) / 2; }
+                CHECK(dom(a, b, eps) == dom(a.begin(), a.end(), b.begin(), b.end(), eps));
+            }
+        }
+    }
+}
 } // namespace Operon::Test
@@ -0,0 +1,181 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <doctest/doctest.h>
+#include <limits>
+#include <random>
+#include <taskflow/core/executor.hpp>
+#include <vector>
+
+#include "../operon_test.hpp"
+#include "operon/algorithms/nsga2.hpp"
+#include "operon/algorithms/pareto_indicators.hpp"
+#include "operon/algorithms/solution_archive.hpp"
+#include "operon/core/dataset.hpp"
+#include "operon/core/individual.hpp"
+#include "operon/core/problem.hpp"
+#include "operon/core/pset.hpp"
+#include "operon/operators/creator.hpp"
+#include "operon/operators/crossover.hpp"
+#include "operon/operators/evaluator.hpp"
+#include "operon/operators/generator.hpp"
+#include "operon/operators/initializer.hpp"
+#include "operon/operators/mutation.hpp"
+#include "operon/operators/non_dominated_sorter.hpp"
+#include "operon/operators/reinserter.hpp"
+#include "operon/operators/selector.hpp"
+
+namespace dt = doctest;
+
+namespace Operon::Test {
+
+namespace {
+    // the volume of the cells of the grid given by the coordinates of the points that are dominated by a point
+    auto GridHypervolume(std::vector<Individual> const& front, std::vector<Operon::Scalar> const& ref) -> double
+    {
+        auto const m = ref.size();
+        std::vector<std::vector<double>> grid(m);
+        for (auto d = 0UL; d < m; ++d) {
+            for (auto const& ind : front) { if (ind[d] < ref[d]) { grid[d].push_back(ind[d]); } }
+            grid[d].push_back(ref[d]);
+            std::ranges::sort(grid[d]);
+            grid[d].erase(std::unique(grid[d].begin(), grid[d].end()), grid[d].end());
+            if (grid[d].size() < 2) { return 0; }
+        }
+        std::vector<std::size_t> cell(m, 0);
+        auto hv{0.0};
+        for (auto d = 0UL; d < m;) {
+            auto dominated = std::ranges::any_of(front, [&](auto const& ind) {
+                for (auto k = 0UL; k < m; ++k) { if (!(ind[k] <= grid[k][cell[k]])) { return false; } }
+                return true;
+            });
+            if (dominated) {
+                auto v{1.0};
+                for (auto k = 0UL; k < m; ++k) { v *= grid[k][cell[k] + 1] - grid[k][cell[k]]; }
+                hv += v;
+            }
+            for (d = 0; d < m; ++d) {
+                if (++cell[d] + 1 < grid[d].size()) { break; }
+                cell[d] = 0;
+            }
+        }
+        return hv;
+    }
+} // namespace
+
+TEST_CASE("hypervolume" * dt::test_suite("[implementation]"))
+{
+    SUBCASE("two objectives") {
+        std::vector<Individual> front(3, Individual(2));
+        front[0].Fitness = {0, 2};
+        front[1].Fitness = {1, 1};
+        front[2].Fitness = {2, 0};
+        CHECK(Hypervolume(front, std::vector<Operon::Scalar>{3, 3}) == doctest::Approx(6));
+        // a point outside of the reference box does not contribute
+        front[2].Fitness = {4, 0};
+        CHECK(Hypervolume(front, std::vector<Operon::Scalar>{3, 3}) == doctest::Approx(5));
+    }
+
+    SUBCASE("random fronts") {
+        Operon::RandomGenerator rng{1234}; // NOLINT
+        constexpr auto steps{10};
+        for (auto m = 2UL; m <= 5; ++m) {
+            for (auto t = 0; t < 20; ++t) { // NOLINT
+                std::vector<Individual> front(1 + rng() % 8, Individual(m)); // NOLINT
+                for (auto& ind : front) {
+                    for (auto& f : ind.Fitness) { f = static_cast<Operon::Scalar>(rng() % steps) / steps; }
+                }
+                std::vector<Operon::Scalar> ref(m, Operon::Scalar{0.95}); // NOLINT
+                CHECK(Hypervolume(front, ref) == doctest::Approx(GridHypervolume(front, ref)));
+            }
+        }
+    }
+}
+
+TEST_CASE("pareto indicators" * dt::test_suite("[implementation]"))
+{
+    std::vector<Individual> front(2, Individual(2));
+    front[0].Fitness = {0, 1};
+    front[1].Fitness = {1, 0};
+    std::vector<ParetoIndicators::Point> reference{{0, 1}, {1, 0}, {0.5, 0.5}}; // NOLINT
+
+    CHECK(InvertedGenerationalDistance(front, reference) == doctest::Approx(std::sqrt(0.5) / 3));
+
+    ParetoIndicators indicators({2, 2}, reference);
+    indicators.SetStagnation(2, 1e-3); // NOLINT
+    CHECK(indicators.Update(front));
+    CHECK(indicators.Hypervolume() == doctest::Approx(3));
+    CHECK(indicators.InvertedGenerationalDistance() == doctest::Approx(std::sqrt(0.5) / 3));
+
+    // the same front does not change the indicators and the run converges after the window
+    CHECK_FALSE(indicators.Update(front));
+    CHECK_FALSE(indicators.Converged());
+    CHECK_FALSE(indicators.Update(front));
+    CHECK(indicators.Converged());
+
+    front.push_back(Individual(2));
+    front.back().Fitness = {0.5, 0.5}; // NOLINT
+    CHECK(indicators.Update(front));
+    CHECK(indicators.Hypervolume() == doctest::Approx(3.25));
+    CHECK(indicators.InvertedGenerationalDistance() == doctest::Approx(0));
+    CHECK_FALSE(indicators.Converged());
+
+    // the same front given by its positions in a population or by an archive does not change the indicators
+    std::vector<Individual> population(front.rbegin(), front.rend());
+    population.push_back(Individual(2));
+    population.back().Fitness = {2, 2}; // NOLINT
+    std::vector<std::size_t> const indices{0, 1, 2};
+    CHECK_FALSE(indicators.Update(population, indices));
+    SolutionArchive archive;
+    archive.Insert(population);
+    CHECK(archive.Size() == front.size());
+    CHECK_FALSE(indicators.Update(archive));
+    CHECK(indicators.History().size() == 6);
+    CHECK(indicators.Hypervolume() == doctest::Approx(3.25));
+}
+
+TEST_CASE("NSGA2 indicators" * dt::test_suite("[implementation]"))
+{
+    Util::SyntheticGpSetup setup;
+    Operon::LengthEvaluator lengthEvaluator { setup.Problem, setup.MaxLength };
+    Operon::MultiEvaluator evaluator { setup.Problem };
+    evaluator.Add(setup.Evaluator);
+    evaluator.Add(lengthEvaluator);
+
+    Operon::CrowdedComparison cc;
+    Operon::TournamentSelector selector { cc };
+    Operon::BasicOffspringGenerator generator { evaluator, setup.Crossover, setup.ChangeFunction, selector, selector };
+    Operon::KeepBestReinserter reinserter { cc };
+    Operon::RankIntersectSorter sorter;
+    setup.Config.Deterministic = true;
+
+    auto run = [&](ParetoIndicators& indicators) {
+        evaluator.Reset();
+        Operon::NSGA2 nsga2 { setup.Problem, setup.Config, setup.TreeInitializer, setup.CoeffInitializer, generator, reinserter, sorter };
+        nsga2.SetIndicators(&indicators);
+        tf::Executor executor(2);
+        Operon::RandomGenerator random { setup.Config.Seed };
+        nsga2.Run(executor, random);
+        // the indicators are those of the last best front
+        CHECK(indicators.Hypervolume() == doctest::Approx(Operon::Hypervolume(nsga2.Best(), indicators.Reference())));
+        return nsga2.Generation();
+    };
+
+    // the indicators are updated with the first front and after every generation
+    ParetoIndicators::Point const reference{1e3, setup.MaxLength + 1}; // NOLINT
+    ParetoIndicators indicators{reference};
+    CHECK(run(indicators) == setup.Config.Generations);
+    CHECK(indicators.History().size() == setup.Config.Generations + 1);
+    CHECK(indicators.Hypervolume() > 0);
+
+    // a converged front stops the run, here as soon as there are two updates
+    ParetoIndicators converging{reference};
+    converging.SetStagnation(1, std::numeric_limits<double>::max());
+    CHECK(run(converging) == 1);
+    CHECK(converging.History().size() == 2);
+}
+
+} // namespace Operon::Test
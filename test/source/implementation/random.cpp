@@ -2,10 +2,16 @@
 // SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
 
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <doctest/doctest.h>
 #include <fmt/core.h>
+#include <functional>
+#include <numeric>
 #include <random>
+#include <span>
+#include <utility>
 #include <vector>
 
 #include "operon/random/random.hpp"
@@ -51,4 +57,67 @@ TEST_CASE("random sampling" * dt::test_suite("[implementation]"))
     }
 }
 
+TEST_CASE("batched random numbers" * dt::test_suite("[implementation]"))
+{
+    constexpr size_t samples = 1'000'000;
+    constexpr uint64_t n = 10;
+
+    SUBCASE("bounded integers") {
+        Operon::Random::RomuTrio rng(1234);
+        std::vector<size_t> counts(n, 0);
+        for (size_t i = 0; i < samples; ++i) { counts[Operon::Random::Bounded(rng, n)]++; }
+        for (auto c : counts) { CHECK(std::abs(static_cast<double>(c) / samples - 1.0 / n) < 0.005); } // NOLINT
+        CHECK(Operon::Random::Bounded(rng, 1) == 0);
+        CHECK(Operon::Random::Uniform(rng, -3, -3) == -3);
+    }
+
+    SUBCASE("lanes") {
+        // the bulk fill continues the stream of the single values
+        Operon::Random::RomuTrioX<4> a(42);
+        Operon::Random::RomuTrioX<4> b(42);
+        std::vector<uint64_t> u(19);
+        std::vector<uint64_t> v(19);
+        for (auto& x : u) { x = a(); }
+        b.Fill(std::span(v).first(3));
+        b.Fill(std::span(v).subspan(3));
+        CHECK(u == v);
+
+        std::vector<uint64_t> w(samples);
+        a.Fill(w, n);
+        std::vector<size_t> counts(n, 0);
+        for (auto x : w) { counts[x]++; }
+        for (auto c : counts) { CHECK(std::abs(static_cast<double>(c) / samples - 1.0 / n) < 0.005); } // NOLINT
+    }
+
+    SUBCASE("real distributions") {
+        auto moments = [](auto const& x) {
+            auto const m = std::reduce(x.begin(), x.end(), 0.0) / static_cast<double>(x.size());
+            auto const v = std::transform_reduce(x.begin(), x.end(), 0.0, std::plus{}, [m](auto y) { return (y - m) * (y - m); }) / static_cast<double>(x.size());
+            return std::pair{m, v};
+        };
+
+        Operon::Random::RomuTrio rng(1234);
+        std::vector<float> u(samples + 1); // odd, the last pair of the normal fill is split
+        Operon::Random::FillUniform(rng, std::span{u}, -2.F, 3.F);
+        CHECK(std::all_of(u.begin(), u.end(), [](auto x) { return x >= -2.F && x < 3.F; }));
+        auto [um, uv] = moments(u);
+        CHECK(std::abs(um - 0.5) < 0.01); // NOLINT
+        CHECK(std::abs(uv - 25.0 / 12) < 0.01); // NOLINT
+
+        Operon::Random::RomuTrioX<8> x(42);
+        std::vector<double> z(samples + 1);
+        Operon::Random::FillNormal(x, std::span{z}, 1.0, 2.0);
+        auto [zm, zv] = moments(z);
+        CHECK(std::abs(zm - 1.0) < 0.01); // NOLINT
+        CHECK(std::abs(zv - 4.0) < 0.02); // NOLINT
+        CHECK(std::all_of(z.begin(), z.end(), [](auto y) { return std::isfinite(y); }));
+
+        // other distributions are drawn value by value
+        std::vector<int> dice(samples);
+        std::uniform_int_distribution<int> die(1, 6);
+        Operon::Random::Draw(rng, die, std::span{dice});
+        CHECK(std::all_of(dice.begin(), dice.end(), [](auto d) { return d >= 1 && d <= 6; }));
+    }
+}
+
 } // namespace
@@ -1,95 +1,366 @@
 // SPDX-License-Identifier: MIT
 // SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
-//
+
 #include <algorithm>
-#include <catch2/catch.hpp>
+#include <cmath>
+#include <functional>
+#include <numeric>
+#include <doctest/doctest.h>
+#include <random>
+#include <thread>
+#include <vector>
 
-#include "operon/core/dataset.hpp"
-#include "operon/formatter/formatter.hpp"
-#include "operon/core/grammar.hpp"
-#include "operon/core/stats.hpp"
-#include "operon/operators/creator.hpp"
-#include "operon/operators/selection.hpp"
+#include "operon/core/fitness_matrix.hpp"
+#include "operon/core/individual.hpp"
+#include "operon/core/permutation.hpp"
+#include "operon/operators/reinserter.hpp"
+#include "operon/operators/selector.hpp"
 
 namespace Operon::Test {
-TEST_CASE("Selection Distribution")
+
+namespace {
+    auto RandomPopulation(Operon::RandomGenerator& rng, size_t n) -> std::vector<Individual>
+    {
+        std::uniform_int_distribution<int> dist(0, 30); // NOLINT
+        std::vector<Individual> pop(n, Individual(2));
+        for (auto i = 0UL; i < n; ++i) {
+            for (auto& f : pop[i].Fitness) { f = static_cast<Operon::Scalar>(dist(rng)); }
+            pop[i].Distance = static_cast<Operon::Scalar>(i); // used to identify the individuals
+        }
+        return pop;
+    }
+} // namespace
+
+TEST_CASE("Selection Distribution" * doctest::test_suite("[implementation]"))
 {
-    size_t nTrees = 1'000;
-    size_t maxLength = 100;
-    size_t maxDepth = 12;
+    // the share of the selections that go to the best tenth of the population, against its expected value
+    constexpr auto n{1'000UL};
+    constexpr auto samples{100 * n};
+    constexpr auto best{n / 10};
+
+    auto random = Operon::RandomGenerator(1234);
+    std::vector<Individual> individuals(n, Individual(1));
+    std::uniform_real_distribution<Operon::Scalar> uniform(0.0, 1.0);
+    for (auto& ind : individuals) { ind[0] = uniform(random); }
+
+    // the positions of the individuals from the best to the worst
+    std::vector<size_t> rank(n);
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0UL);
+    std::ranges::stable_sort(order, [&](auto i, auto j) { return individuals[i][0] < individuals[j][0]; });
+    for (auto i = 0UL; i < n; ++i) { rank[order[i]] = i; }
+
+    auto share = [&](SelectorBase& selector) {
+        selector.Prepare(individuals);
+        auto count{0UL};
+        for (auto i = 0UL; i < samples; ++i) { count += static_cast<size_t>(rank[selector(random)] < best); }
+        return static_cast<double>(count) / samples;
+    };
 
-    auto random = Operon::Random(1234);
-    auto ds = Dataset("../data/Poly-10.csv", true);
+    SingleObjectiveComparison comp{0};
+    constexpr auto tolerance{0.01};
 
-    auto target = "Y";
-    auto variables = ds.GetVariables();
-    std::vector<Variable> inputs;
-    std::copy_if(variables.begin(), variables.end(), std::back_inserter(inputs), [&](const auto& v) { return v.Name != target; });
+    // the winner of a tournament of size k is among the best m unless all the contestants are not: 1 - (1 - m/n)^k
+    for (auto k : { 2UL, 3UL }) {
+        auto const expected = 1 - std::pow(1 - static_cast<double>(best) / n, static_cast<double>(k));
 
-    std::uniform_int_distribution<size_t> sizeDistribution(1, maxLength);
+        TournamentSelector tournament{comp};
+        tournament.SetTournamentSize(k);
+        CHECK(share(tournament) == doctest::Approx(expected).epsilon(tolerance));
 
-    std::vector<Individual<1>> individuals(nTrees);
-    PrimitiveSet grammar;
-    auto creator = BalancedTreeCreator { grammar, inputs };
-    for (size_t i = 0; i < nTrees; ++i) {
-        individuals[i].Genotype = creator(random, sizeDistribution(random), maxDepth);
-        individuals[i][0] = std::uniform_real_distribution(0.0, 1.0)(random);
+        RankTournamentSelector ranked{comp};
+        ranked.SetTournamentSize(k);
+        CHECK(share(ranked) == doctest::Approx(expected).epsilon(tolerance));
     }
 
-    using Ind = Individual<1>;
-    constexpr gsl::index Idx = 0;
+    // an individual is selected in proportion to vmax - f
+    ProportionalSelector proportional{comp};
+    auto const vmax = std::ranges::max(individuals, {}, [](auto const& ind) { return ind[0]; })[0];
+    auto total{0.0};
+    auto top{0.0};
+    for (auto i = 0UL; i < n; ++i) {
+        auto const w = static_cast<double>(vmax - individuals[i][0]);
+        total += w;
+        top += rank[i] < best ? w : 0.0;
+    }
+    CHECK(share(proportional) == doctest::Approx(top / total).epsilon(tolerance));
 
-    ProportionalSelector<Ind, Idx> proportionalSelector;
-    proportionalSelector.Prepare(individuals);
+    RandomSelector uniformSelector;
+    CHECK(share(uniformSelector) == doctest::Approx(static_cast<double>(best) / n).epsilon(tolerance));
+}
 
-    TournamentSelector<Ind, Idx> tournamentSelector(2);
-    tournamentSelector.Prepare(individuals);
+TEST_CASE("Fitness matrix" * doctest::test_suite("[implementation]"))
+{
+    Operon::RandomGenerator rng(1234);
+    auto const pop = RandomPopulation(rng, 100);
+    FitnessMatrix const fitness(pop);
+    REQUIRE(fitness.Rows() == pop.size());
+    REQUIRE(fitness.Cols() == 2);
+    for (auto i = 0UL; i < pop.size(); ++i) {
+        CHECK(fitness.Objective(1)[i] == pop[i][1]);
+    }
 
-    RankTournamentSelector<Ind, Idx> rankedSelector(2);
-    rankedSelector.Prepare(individuals);
+    // the recognized functors give the same order as on the individuals
+    SingleObjectiveComparison single{1};
+    LexicographicalComparison lex;
+    CHECK(FitnessComparison::FromCallback(single).GetOrder() == FitnessComparison::Order::SingleObjective);
+    CHECK(!FitnessComparison::FromCallback([](auto const& a, auto const& b) { return a[0] < b[0]; }));
+    for (auto i = 0UL; i < pop.size(); ++i) {
+        for (auto j = 0UL; j < pop.size(); ++j) {
+            CHECK(FitnessComparison::FromCallback(single)(fitness, i, j) == single(pop[i], pop[j]));
+            CHECK(FitnessComparison::FromCallback(lex)(fitness, i, j) == lex(pop[i], pop[j]));
+        }
+    }
+}
 
-    auto plotHist = [&](SelectorBase<Ind, Idx>& selector)
-    {
-        std::vector<size_t> hist(individuals.size());
+TEST_CASE("Reinsertion with a fitness matrix" * doctest::test_suite("[implementation]"))
+{
+    Operon::RandomGenerator rng(1234);
+    KeepBestReinserter fast{SingleObjectiveComparison{1}};
+    KeepBestReinserter slow{[](auto const& a, auto const& b) { return a[1] < b[1]; }};
 
-        for (size_t i = 0; i < 100 * nTrees; ++i)
-        {
-            hist[selector(random)]++;
+    for (auto t = 0; t < 10; ++t) {
+        auto pop1 = RandomPopulation(rng, 100);
+        auto pool1 = RandomPopulation(rng, 60);
+        auto pop2 = pop1;
+        auto pool2 = pool1;
+        fast(rng, pop1, pool1);
+        slow(rng, pop2, pool2);
+        for (auto i = 0UL; i < pop1.size(); ++i) { CHECK(pop1[i].Distance == pop2[i].Distance); }
+        for (auto i = 0UL; i < pool1.size(); ++i) { CHECK(pool1[i].Distance == pool2[i].Distance); }
+    }
+}
+
+TEST_CASE("Permutation of a population" * doctest::test_suite("[implementation]"))
+{
+    Operon::RandomGenerator rng(1234);
+    for (auto n : { 1UL, 2UL, 10UL, 100UL }) {
+        auto pop = RandomPopulation(rng, n);
+        std::vector<size_t> indices(n);
+        std::iota(indices.begin(), indices.end(), size_t{0});
+        std::ranges::shuffle(indices, rng);
+        ApplyPermutation(Operon::Span<Individual>(pop), Operon::Span<size_t const>(indices));
+        for (auto i = 0UL; i < n; ++i) { CHECK(pop[i].Distance == static_cast<Operon::Scalar>(indices[i])); }
+    }
+}
+
+TEST_CASE("Reinsertion without sorting" * doctest::test_suite("[implementation]"))
+{
+    Operon::RandomGenerator rng(1234);
+    auto const ids = [](auto const& inds) {
+        std::vector<Operon::Scalar> v;
+        for (auto const& ind : inds) { v.push_back(ind.Distance); }
+        std::ranges::sort(v);
+        return v;
+    };
+
+    for (auto const& comp : { ComparisonCallback{SingleObjectiveComparison{1}}, ComparisonCallback{[](auto const& a, auto const& b) { return a[1] < b[1]; }} }) {
+        SelectBestReinserter reinserter{comp};
+        for (auto t = 0; t < 10; ++t) {
+            auto pop = RandomPopulation(rng, 100);
+            auto pool = RandomPopulation(rng, 60);
+            for (auto& ind : pool) { ind.Distance += 100; } // NOLINT
+
+            // the reference: the first |pop| individuals of pop+pool in (stable) sorted order
+            std::vector<Individual> all(pop.begin(), pop.end());
+            all.insert(all.end(), pool.begin(), pool.end());
+            std::ranges::stable_sort(all, comp);
+
+            reinserter(rng, pop, pool);
+            CHECK(ids(pop) == ids(Operon::Span<Individual const>(all).first(pop.size())));
+            CHECK(ids(pool) == ids(Operon::Span<Individual const>(all).subspan(pop.size())));
         }
-        std::sort(hist.begin(), hist.end(), std::greater<>{});
-        for (size_t i = 0; i < nTrees; ++i)
-        {
-            //auto qty = std::string(hist[i], '*');
-            auto qty = hist[i];
-            fmt::print("{:>5}\t{}\n", i, qty / 100.0);
+    }
+}
+
+TEST_CASE("Rank tournament selection" * doctest::test_suite("[implementation]"))
+{
+    Operon::RandomGenerator rng(1234);
+    auto const pop = RandomPopulation(rng, 100);
+    RankTournamentSelector selector{SingleObjectiveComparison{0}};
+    selector.SetTournamentSize(pop.size() * 10);
+    selector.Prepare(pop);
+
+    // with a large tournament the best individual wins
+    auto const best = std::ranges::min_element(pop, SingleObjectiveComparison{0});
+    CHECK(pop[selector(rng)][0] == (*best)[0]);
+
+    // a sorted population is not sorted again, the ranks are the positions
+    auto sorted = pop;
+    std::ranges::stable_sort(sorted, SingleObjectiveComparison{0});
+    selector.Prepare(sorted);
+    CHECK(selector(rng) == 0);
+}
+
+TEST_CASE("Proportional selection" * doctest::test_suite("[implementation]"))
+{
+    Operon::RandomGenerator rng(1234);
+    auto pop = RandomPopulation(rng, 100);
+    ProportionalSelector selector{SingleObjectiveComparison{0}};
+    selector.SetObjIndex(0);
+
+    SUBCASE("frequencies") {
+        selector.Prepare(pop);
+        auto const vmax = std::ranges::max_element(pop, {}, [](auto const& ind) { return ind[0]; })->Fitness[0];
+        auto total { 0.0 };
+        for (auto const& ind : pop) { total += vmax - ind[0]; }
+
+        constexpr auto samples{200'000};
+        std::vector<double> observed(pop.size(), 0.0);
+        for (auto i = 0; i < samples; ++i) { observed[selector(rng)] += 1.0 / samples; }
+        for (auto i = 0UL; i < pop.size(); ++i) {
+            CHECK(std::abs(observed[i] - (vmax - pop[i][0]) / total) < 0.005); // NOLINT
         }
-    };
+    }
 
-    SECTION("Proportional")
-    {
-        plotHist(proportionalSelector);
+    SUBCASE("equal fitness") {
+        for (auto& ind : pop) { ind[0] = 1; }
+        selector.Prepare(pop);
+        CHECK(selector(rng) < pop.size());
     }
+}
 
-    SECTION("Tournament Size 2")
-    {
-        plotHist(tournamentSelector);
+TEST_CASE("Batch tournament selection" * doctest::test_suite("[implementation]"))
+{
+    Operon::RandomGenerator rng(1234);
+    auto const pop = RandomPopulation(rng, 100);
+    auto const best = std::ranges::min_element(pop, SingleObjectiveComparison{0});
+
+    SUBCASE("large tournament") {
+        BatchTournamentSelector selector{SingleObjectiveComparison{0}};
+        selector.SetTournamentSize(pop.size() * 10);
+        selector.Prepare(pop);
+        for (auto i = 0; i < 10; ++i) {
+            CHECK(pop[selector(rng)][0] == (*best)[0]);
+        }
     }
 
-    SECTION("Rank Tournament Size 2")
-    {
-        plotHist(rankedSelector);
+    // the batch tournaments select the individuals with the same frequencies as the tournament selector
+    SUBCASE("selection pressure") {
+        constexpr auto samples{200'000};
+        for (auto const& comp : { ComparisonCallback{SingleObjectiveComparison{0}}, ComparisonCallback{LexicographicalComparison{}} }) {
+            TournamentSelector tournament{comp};
+            tournament.Prepare(pop);
+            // one batch for all the samples, then batches that run out many times
+            for (auto batchSize : { static_cast<size_t>(samples), size_t{100} }) {
+                BatchTournamentSelector batch{comp};
+                batch.SetSeed(rng());
+                batch.SetBatchSize(batchSize);
+                batch.Prepare(pop);
+
+                std::vector<double> expected(pop.size(), 0.0);
+                std::vector<double> observed(pop.size(), 0.0);
+                for (auto i = 0; i < samples; ++i) {
+                    expected[tournament(rng)] += 1.0 / samples;
+                    observed[batch(rng)] += 1.0 / samples;
+                }
+                for (auto i = 0UL; i < pop.size(); ++i) {
+                    CHECK(std::abs(observed[i] - expected[i]) < 0.005); // NOLINT
+                }
+            }
+        }
     }
-    
-    SECTION("Tournament Size 3")
-    {
-        tournamentSelector.TournamentSize(3);
-        plotHist(tournamentSelector);
+
+    // the winners only depend on the seed of the selector, not on the generator of the caller
+    SUBCASE("seed") {
+        auto draw = [&](uint64_t seed, uint64_t callerSeed) {
+            BatchTournamentSelector selector{SingleObjectiveComparison{0}};
+            selector.SetSeed(seed);
+            selector.SetBatchSize(16); // NOLINT
+            selector.Prepare(pop);
+            Operon::RandomGenerator caller(callerSeed);
+            std::vector<size_t> winners(100); // NOLINT
+            std::ranges::generate(winners, [&]() { return selector(caller); });
+            return winners;
+        };
+        CHECK(draw(1, 1) == draw(1, 2));
+        CHECK(draw(1, 1) != draw(2, 1));
     }
 
-    SECTION("Rank Tournament Size 3")
-    {
-        rankedSelector.TournamentSize(3);
-        plotHist(rankedSelector);
+    // the callers of several threads share the batches
+    SUBCASE("concurrent selection") {
+        BatchTournamentSelector selector{SingleObjectiveComparison{0}};
+        selector.SetBatchSize(64); // NOLINT
+        selector.Prepare(pop);
+        constexpr auto threads{4};
+        constexpr auto selections{10'000};
+        std::vector<std::vector<size_t>> counts(threads, std::vector<size_t>(pop.size()));
+        std::vector<std::thread> workers;
+        for (auto t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                Operon::RandomGenerator random(t);
+                for (auto i = 0; i < selections; ++i) { ++counts[t][selector(random)]; }
+            });
+        }
+        for (auto& w : workers) { w.join(); }
+        auto total{0UL};
+        for (auto const& c : counts) { total += std::reduce(c.begin(), c.end()); }
+        CHECK(total == threads * selections);
     }
 }
+
+TEST_CASE("Lexicase selection" * doctest::test_suite("[implementation]"))
+{
+    Operon::RandomGenerator rng(1234);
+    constexpr auto cases{20UL};
+    auto pop = RandomPopulation(rng, 50);
+    std::uniform_real_distribution<Operon::Scalar> dist(1, 10); // NOLINT
+    for (auto& ind : pop) {
+        ind.CaseErrors.resize(cases);
+        for (auto& e : ind.CaseErrors) { e = dist(rng); }
+    }
+    pop[7].CaseErrors.clear(); // not evaluated on the cases
+
+    LexicaseSelector selector;
+    selector.SetSeed(rng());
+
+    SUBCASE("dominant individual") {
+        // the best on every case by more than the tolerance
+        std::fill(pop[3].CaseErrors.begin(), pop[3].CaseErrors.end(), Operon::Scalar{-100});
+        for (auto count : { 0UL, 5UL, 1UL }) {
+            selector.SetCaseCount(count);
+            selector.Prepare(pop);
+            for (auto i = 0; i < 100; ++i) { CHECK(selector(rng) == 3); }
+        }
+    }
+
+    SUBCASE("individuals without errors") {
+        selector.Prepare(pop);
+        for (auto i = 0; i < 1000; ++i) { CHECK(selector(rng) != 7); }
+    }
+
+    SUBCASE("no errors") {
+        for (auto& ind : pop) { ind.CaseErrors.clear(); }
+        selector.Prepare(pop);
+        for (auto i = 0; i < 100; ++i) { CHECK(selector(rng) < pop.size()); }
+    }
+
+    // the cases of a generation are drawn by the generator of the selector
+    SUBCASE("seed") {
+        auto draw = [&](uint64_t seed) {
+            LexicaseSelector lexicase;
+            lexicase.SetSeed(seed);
+            lexicase.SetCaseCount(2);
+            std::vector<size_t> selected;
+            Operon::RandomGenerator caller(1);
+            for (auto generation = 0; generation < 5; ++generation) { // NOLINT
+                lexicase.Prepare(pop);
+                for (auto i = 0; i < 20; ++i) { selected.push_back(lexicase(caller)); } // NOLINT
+            }
+            return selected;
+        };
+        CHECK(draw(1) == draw(1));
+        CHECK(draw(1) != draw(2));
+    }
+
+    SUBCASE("case sample") {
+        auto const sample = LexicaseSelector::SampleCases(rng, 100, cases);
+        CHECK(sample.size() == cases);
+        CHECK(std::ranges::is_sorted(sample));
+        CHECK(std::ranges::adjacent_find(sample) == sample.end());
+        CHECK(sample.back() < 100);
+        CHECK(LexicaseSelector::SampleCases(rng, 10, cases).size() == 10);
+    }
 }
+
+} // namespace Operon::Test
@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <algorithm>
+#include <doctest/doctest.h>
+#include <memory>
+#include <random>
+#include <taskflow/core/executor.hpp>
+#include <vector>
+
+#include "../operon_test.hpp"
+#include "operon/algorithms/successive_halving.hpp"
+#include "operon/core/dataset.hpp"
+#include "operon/core/problem.hpp"
+#include "operon/core/pset.hpp"
+#include "operon/operators/creator.hpp"
+#include "operon/operators/crossover.hpp"
+#include "operon/operators/evaluator.hpp"
+#include "operon/operators/generator.hpp"
+#include "operon/operators/initializer.hpp"
+#include "operon/operators/mutation.hpp"
+#include "operon/operators/reinserter.hpp"
+#include "operon/operators/selector.hpp"
+
+namespace Operon::Test {
+
+TEST_CASE("Successive halving" * doctest::test_suite("[implementation]"))
+{
+    // the stateless operators of the setup are shared by the configurations
+    Util::SyntheticGpSetup setup;
+
+    // the operators with a state belong to the algorithm of each configuration
+    struct Trial {
+        Trial(Operon::Problem& problem, Operon::DefaultDispatch& dtable, Operon::CrossoverBase& crossover, Operon::MutatorBase& mutator)
+            : Evaluator(problem, dtable)
+            , Selector(Operon::SingleObjectiveComparison { 0 })
+            , Generator(Evaluator, crossover, mutator, Selector, Selector)
+            , Reinserter(Operon::SingleObjectiveComparison { 0 })
+        {
+        }
+
+        Operon::Evaluator<Operon::DefaultDispatch> Evaluator;
+        Operon::TournamentSelector Selector;
+        Operon::BasicOffspringGenerator Generator;
+        Operon::KeepBestReinserter Reinserter;
+        std::unique_ptr<Operon::GeneticProgrammingAlgorithm> Algorithm;
+    };
+
+    auto factory = [&](Operon::GeneticAlgorithmConfig const& config) {
+        auto trial = std::make_shared<Trial>(setup.Problem, setup.Table, setup.Crossover, setup.Mutator);
+        trial->Evaluator.SetBudget(config.Evaluations);
+        trial->Algorithm = std::make_unique<Operon::GeneticProgrammingAlgorithm>(setup.Problem, config, setup.TreeInitializer, setup.CoeffInitializer, trial->Generator, trial->Reinserter);
+        return std::shared_ptr<Operon::GeneticProgrammingAlgorithm>(trial, trial->Algorithm.get());
+    };
+
+    Operon::GeneticAlgorithmConfig base {};
+    base.Evaluations = 1'000'000;
+    base.PopulationSize = 50;
+    base.PoolSize = 50;
+    base.Seed = 1234;
+
+    std::vector<Operon::GeneticAlgorithmConfig> configs;
+    for (auto p : { 0.0, 0.25, 0.5, 1.0 }) {
+        configs.push_back(base);
+        configs.back().MutationProbability = p;
+    }
+
+    Operon::SuccessiveHalvingConfig config;
+    config.Generations = 2;
+    config.Reduction = 2;
+    Operon::SuccessiveHalving sweep { config, factory };
+
+    tf::Executor executor(4);
+    Operon::RandomGenerator random { 1234 };
+    auto const results = sweep.Run(executor, random, configs);
+    REQUIRE(results.size() == configs.size());
+
+    // 4 configurations run 2 generations, the best 2 run 2 more, the best one runs 4 more
+    std::vector<size_t> rungs;
+    for (auto const& r : results) {
+        rungs.push_back(r.Rungs);
+        CHECK(r.Generations == (r.Rungs == 1 ? 2 : r.Rungs == 2 ? 4 : 8));
+    }
+    std::ranges::sort(rungs);
+    CHECK(rungs == std::vector<size_t>{ 1, 1, 2, 3 });
+
+    // a survivor continued from its population (the reinserter keeps the best), so its score only improved
+    auto const best = Operon::SuccessiveHalving::Best(results);
+    CHECK(results[best].Rungs == 3);
+    for (auto const& r : results) {
+        CHECK(results[best].Score <= r.Score);
+    }
+}
+
+} // namespace Operon::Test
@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <algorithm>
+#include <doctest/doctest.h>
+#include <random>
+#include <taskflow/core/executor.hpp>
+#include <vector>
+
+#include "../operon_test.hpp"
+#include "operon/algorithms/gp.hpp"
+#include "operon/algorithms/termination.hpp"
+#include "operon/algorithms/validation.hpp"
+#include "operon/core/dataset.hpp"
+#include "operon/core/problem.hpp"
+#include "operon/core/pset.hpp"
+#include "operon/interpreter/interpreter.hpp"
+#include "operon/operators/creator.hpp"
+#include "operon/operators/crossover.hpp"
+#include "operon/operators/evaluator.hpp"
+#include "operon/operators/generator.hpp"
+#include "operon/operators/initializer.hpp"
+#include "operon/operators/mutation.hpp"
+#include "operon/operators/reinserter.hpp"
+#include "operon/operators/selector.hpp"
+
+namespace Operon::Test {
+
+TEST_CASE("Background validation" * doctest::test_suite("[implementation]"))
+{
+    Util::SyntheticGpSetup setup { { .Rows = 300, .TrainingRange = Operon::Range { 0UL, 200UL }, .TestRange = { 200UL, 300UL }, .ValidationRange = { 200UL, 300UL } } };
+    Operon::BasicOffspringGenerator generator { setup.Evaluator, setup.Crossover, setup.Mutator, setup.Selector, setup.Selector };
+    setup.Config.Generations = 1000;
+    setup.Config.Evaluations = 10'000'000;
+
+    // a separate evaluator, so that the validation does not count against the budget
+    Operon::Evaluator<decltype(setup.Table)> validator { setup.Problem, setup.Table };
+    constexpr auto k { 5UL };
+    Operon::ValidationMonitor monitor { validator, k, /*patience=*/1 };
+
+    Operon::GeneticProgrammingAlgorithm gp { setup.Problem, setup.Config, setup.TreeInitializer, setup.CoeffInitializer, generator, setup.Reinserter };
+    gp.SetValidation(&monitor);
+    tf::Executor executor(4);
+    Operon::RandomGenerator random { 1234 };
+    gp.Run(executor, random);
+
+    // the run stops once the best validation fitness does not improve
+    CHECK(monitor.EarlyStop());
+    CHECK(gp.Generation() < setup.Config.Generations);
+    CHECK(monitor.Count() > 0);
+
+    auto archive = monitor.Archive();
+    REQUIRE(!archive.empty());
+    CHECK(archive.size() <= k);
+    CHECK(std::ranges::is_sorted(archive, std::less{}, &Operon::ValidationMonitor::Entry::Fitness));
+    for (auto& e : archive) {
+        auto const f = validator.EvaluateSubset(setup.Random, e.Model, {}, setup.Problem.ValidationRange()).front();
+        CHECK(e.Fitness == doctest::Approx(f));
+        CHECK(e.Generation <= gp.Generation());
+    }
+    CHECK(monitor.Best()->Fitness == archive.front().Fitness);
+
+    Operon::Problem empty { setup.Problem.GetDataset(), { 0UL, 200UL }, { 200UL, 300UL } };
+    Operon::Evaluator<decltype(setup.Table)> other { empty, setup.Table };
+    CHECK_THROWS_AS((Operon::ValidationMonitor { other, k }), std::invalid_argument);
+}
+
+TEST_CASE("Termination criteria" * doctest::test_suite("[implementation]"))
+{
+    Operon::RandomGenerator rng { 1234 };
+    Operon::PrimitiveSet pset { Operon::PrimitiveSet::Arithmetic };
+    std::vector<Operon::Hash> inputs { 1, 2, 3 };
+    Operon::BalancedTreeCreator creator { pset, inputs };
+
+    std::vector<Operon::Individual> pop(20);
+    for (auto& ind : pop) { ind.Genotype = creator(rng, 10, 1, 10); }
+    auto setBest = [&](Operon::Scalar f) {
+        for (auto i = 0UL; i < pop.size(); ++i) { pop[i][0] = f + static_cast<Operon::Scalar>(i); }
+    };
+
+    Operon::GeneticAlgorithmConfig config {};
+    SUBCASE("stagnation") {
+        config.StagnationGenerations = 3;
+        Operon::TerminationCriteria criteria { config };
+        for (auto f : { 5.F, 4.F, 4.F, 4.F }) {
+            setBest(f);
+            criteria.Update(pop);
+            CHECK(!criteria.Terminated());
+        }
+        criteria.Update(pop);
+        CHECK(criteria.Reason() == Operon::TerminationReason::Stagnation);
+        CHECK(criteria.Best() == 4.0);
+
+        criteria.Reset();
+        CHECK(!criteria.Terminated());
+    }
+
+    SUBCASE("target") {
+        config.TargetFitness = 1;
+        Operon::TerminationCriteria criteria { config };
+        setBest(2);
+        criteria.Update(pop);
+        CHECK(!criteria.Terminated());
+        setBest(1);
+        criteria.Update(pop);
+        CHECK(criteria.Reason() == Operon::TerminationReason::Target);
+    }
+
+    SUBCASE("diversity") {
+        config.MinimumDiversity = 0.1;
+        config.DiversityInterval = 1;
+        Operon::TerminationCriteria criteria { config };
+        criteria.Update(pop);
+        CHECK(!criteria.Terminated());
+        CHECK(criteria.Diversity() > 0.1);
+
+        // a population of copies has no diversity
+        for (auto& ind : pop) { ind.Genotype = pop.front().Genotype; }
+        criteria.Update(pop);
+        CHECK(criteria.Reason() == Operon::TerminationReason::Diversity);
+    }
+}
+
+} // namespace Operon::Test
@@ -7,14 +7,30 @@
 #include "thirdparty/elki_stats.hpp"
 #include "thirdparty/nanobench.h"
 
+#include <atomic>
+#include <filesystem>
 #include <fmt/core.h>
 #include <fmt/color.h>
 #include <fmt/ranges.h>
+#include <optional>
+#include <random>
+#include <string>
+#include <system_error>
 
+#include "operon/algorithms/config.hpp"
 #include "operon/core/dataset.hpp"
+#include "operon/core/problem.hpp"
+#include "operon/core/pset.hpp"
 #include "operon/core/tree.hpp"
 #include "operon/interpreter/backend/backend.hpp"
 #include "operon/interpreter/dual.hpp"
+#include "operon/operators/creator.hpp"
+#include "operon/operators/crossover.hpp"
+#include "operon/operators/evaluator.hpp"
+#include "operon/operators/initializer.hpp"
+#include "operon/operators/mutation.hpp"
+#include "operon/operators/reinserter.hpp"
+#include "operon/operators/selector.hpp"
 
 namespace Operon::Test::Util {
     inline auto RandomDataset(Operon::RandomGenerator& rng, int rows, int cols) -> Operon::Dataset {
@@ -264,6 +280,118 @@ namespace Operon::Test::Util {
 
         return std::tuple{std::move(resid), std::move(jacob)};
     }
+
+    // the data of SyntheticGpSetup, the ranges default to all the rows for training and the first row for testing
+    struct SyntheticGpOptions {
+        std::size_t Rows{200}; // NOLINT
+        std::size_t DatasetRows{0}; // only the first rows are in the dataset, the others can be appended (0 = all)
+        std::optional<Operon::Range> TrainingRange;
+        Operon::Range TestRange{0, 1};
+        Operon::Range ValidationRange{0, 0};
+    };
+
+    // the operators of a small single objective gp run on the data x0 * x1 + x0 (arithmetic primitives)
+    // - the members can be changed or replaced by the test, the generator is left to the test
+    // - the operators keep references to the problem and to each other, so the setup cannot be copied or moved
+    struct SyntheticGpSetup {
+        static constexpr std::size_t MaxDepth{10};
+        static constexpr std::size_t MaxLength{30};
+
+        explicit SyntheticGpSetup(SyntheticGpOptions const& options = {})
+            : Data(MakeData(Random, options.Rows))
+            , Problem(MakeProblem(Data, options))
+            , Creator(Problem.GetPrimitiveSet(), Problem.GetInputs())
+            , TreeInitializer(Creator)
+            , Crossover(1.0, MaxDepth, MaxLength)
+            , ChangeVariable(Problem.GetInputs())
+            , ChangeFunction(Problem.GetPrimitiveSet())
+            , Evaluator(Problem, Table)
+            , Selector(Operon::SingleObjectiveComparison{0})
+            , Reinserter(Operon::SingleObjectiveComparison{0})
+        {
+            TreeInitializer.ParameterizeDistribution(2, MaxLength);
+            TreeInitializer.SetMaxDepth(MaxDepth);
+            CoeffInitializer.ParameterizeDistribution(-1.F, +1.F);
+            Mutator.Add(ChangeVariable, 1.0);
+            Mutator.Add(ChangeFunction, 1.0);
+
+            Config.Generations = 5; // NOLINT
+            Config.Evaluations = 1'000'000; // NOLINT
+            Config.PopulationSize = 100; // NOLINT
+            Config.PoolSize = 100; // NOLINT
+            Config.Seed = 1234; // NOLINT
+        }
+
+        SyntheticGpSetup(SyntheticGpSetup const&) = delete;
+        SyntheticGpSetup(SyntheticGpSetup&&) = delete;
+        auto operator=(SyntheticGpSetup const&) -> SyntheticGpSetup& = delete;
+        auto operator=(SyntheticGpSetup&&) -> SyntheticGpSetup& = delete;
+        ~SyntheticGpSetup() = default;
+
+        Operon::RandomGenerator Random{1234}; // NOLINT, left after the data for the test
+        Eigen::Array<Operon::Scalar, -1, -1> Data;
+        Operon::Problem Problem;
+        Operon::BalancedTreeCreator Creator;
+        Operon::UniformTreeInitializer TreeInitializer;
+        Operon::CoefficientInitializer<std::uniform_real_distribution<Operon::Scalar>> CoeffInitializer;
+        Operon::SubtreeCrossover Crossover;
+        Operon::ChangeVariableMutation ChangeVariable;
+        Operon::ChangeFunctionMutation ChangeFunction;
+        Operon::MultiMutation Mutator; // changes a variable or a function with the same probability
+        Operon::DefaultDispatch Table;
+        Operon::Evaluator<Operon::DefaultDispatch> Evaluator;
+        Operon::TournamentSelector Selector;
+        Operon::KeepBestReinserter Reinserter;
+        Operon::GeneticAlgorithmConfig Config{};
+
+    private:
+        static auto MakeData(Operon::RandomGenerator& rng, std::size_t rows) -> Eigen::Array<Operon::Scalar, -1, -1>
+        {
+            std::uniform_real_distribution<Operon::Scalar> uniform(-1, 1);
+            Eigen::Array<Operon::Scalar, -1, -1> data(rows, 3);
+            for (auto i = 0L; i < data.rows(); ++i) {
+                data(i, 0) = uniform(rng);
+                data(i, 1) = uniform(rng);
+                data(i, 2) = data(i, 0) * data(i, 1) + data(i, 0);
+            }
+            return data;
+        }
+
+        static auto MakeProblem(Eigen::Array<Operon::Scalar, -1, -1> const& data, SyntheticGpOptions const& options) -> Operon::Problem
+        {
+            auto const rows = options.DatasetRows == 0 ? data.rows() : static_cast<Eigen::Index>(options.DatasetRows);
+            Operon::Dataset ds { Operon::Dataset::Matrix { data.topRows(rows).matrix() } };
+            Operon::Problem problem { ds, options.TrainingRange.value_or(Operon::Range{ 0UL, ds.Rows<std::size_t>() }), options.TestRange, options.ValidationRange };
+            problem.ConfigurePrimitiveSet(Operon::PrimitiveSet::Arithmetic);
+            return problem;
+        }
+    };
+
+    // a path in the temporary directory that is not used by another test or another run of the tests, the file (if
+    // any) is removed with the object
+    class TemporaryFile {
+    public:
+        explicit TemporaryFile(std::string const& extension) {
+            static std::atomic<int> count{0};
+            std::random_device rd;
+            path_ = std::filesystem::temp_directory_path() / fmt::format("operon-{:08x}{:08x}-{}{}", rd(), rd(), count++, extension);
+        }
+
+        TemporaryFile(TemporaryFile const&) = delete;
+        TemporaryFile(TemporaryFile&&) = delete;
+        auto operator=(TemporaryFile const&) -> TemporaryFile& = delete;
+        auto operator=(TemporaryFile&&) -> TemporaryFile& = delete;
+
+        ~TemporaryFile() {
+            std::error_code ec;
+            std::filesystem::remove(path_, ec);
+        }
+
+        [[nodiscard]] auto Path() const -> std::string { return path_.string(); }
+
+    private:
+        std::filesystem::path path_;
+    };
 } // namespace Operon::Test::Util
 
 #endif
@@ -34,4 +34,15 @@ namespace Operon::Test {
             return creator(rd, dist(rd), 0, maxd);
         });
     }
+
+    TEST_CASE("Symbol sampling" * dt::test_suite("[performance]")) {
+        Operon::PrimitiveSet pset{ Operon::PrimitiveSet::Full };
+        Operon::RandomGenerator rd(1234UL);
+
+        nb::Bench bench;
+        bench.title("symbol sampling").relative(true).minEpochIterations(100'000);
+        bench.run("any arity", [&]() { return pset.SampleRandomSymbol(rd, 0, 2); });
+        bench.run("leaf", [&]() { return pset.SampleRandomSymbol(rd, 0, 0); });
+        bench.run("function", [&]() { return pset.SampleRandomSymbol(rd, 1, 2); });
+    }
 } // namespace Operon::Test
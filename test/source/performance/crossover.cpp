@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <doctest/doctest.h>
+#include <random>
+
+#include "../operon_test.hpp"
+
+#include "operon/core/pset.hpp"
+#include "operon/core/tree.hpp"
+#include "operon/operators/creator.hpp"
+#include "operon/operators/crossover.hpp"
+
+namespace dt = doctest;
+namespace nb = ankerl::nanobench;
+
+namespace Operon::Test {
+    TEST_CASE("Swap locations" * dt::test_suite("[performance]")) {
+        constexpr auto nrow { 10 };
+        constexpr auto ncol { 10 };
+        constexpr auto maxd { 1000 };
+        constexpr auto n { 100 };
+
+        Operon::PrimitiveSet pset{ Operon::PrimitiveSet::Arithmetic };
+
+        Operon::RandomGenerator rd(1234UL);
+        auto ds = Util::RandomDataset(rd, nrow, ncol);
+        BalancedTreeCreator creator{ pset, ds.VariableHashes() };
+
+        nb::Bench bench;
+        bench.relative(true);
+        // large parents and a tight length limit, the case where scanning the trees dominates
+        for (auto length : { 50UL, 200UL, 1000UL }) {
+            std::vector<Tree> trees;
+            std::vector<SwapLocationIndex> indices;
+            for (auto i = 0; i < n; ++i) {
+                trees.push_back(creator(rd, length, 0, maxd));
+                indices.emplace_back(trees.back());
+            }
+            SubtreeCrossover cx{ 0.9, maxd, 50 }; // NOLINT
+            std::uniform_int_distribution<size_t> dist(0, n - 1);
+
+            bench.run(fmt::format("scan;{}", length), [&]() {
+                auto i = dist(rd);
+                auto j = dist(rd);
+                return cx.FindCompatibleSwapLocations(rd, trees[i], trees[j]);
+            });
+            bench.run(fmt::format("index;{}", length), [&]() {
+                auto i = dist(rd);
+                auto j = dist(rd);
+                return cx.FindCompatibleSwapLocations(rd, trees[i], trees[j], indices[i], indices[j]);
+            });
+        }
+    }
+} // namespace Operon::Test
@@ -8,12 +8,14 @@
 #include "operon/core/dataset.hpp"
 #include "operon/formatter/formatter.hpp"
 #include "operon/core/distance.hpp"
+#include "operon/core/fingerprint.hpp"
 #include "operon/core/pset.hpp"
 #include "operon/analyzers/diversity.hpp"
 #include "operon/operators/creator.hpp"
 #include "operon/operators/initializer.hpp"
 
 #include "nanobench.h"
+#include <taskflow/taskflow.hpp>
 
 namespace Operon {
 namespace Test {
@@ -115,6 +117,71 @@ TEST_CASE("Intersection performance")
         });
         fmt::print("d = {}\n", d);
     }
+
+    // the whole distance matrix: pair by pair, row by row (one to many) and distributed over an executor (many to many)
+    SUBCASE("Performance batched") {
+        ankerl::nanobench::Bench b;
+        b.performanceCounters(true).relative(true);
+
+        auto const s = static_cast<double>(totalOps);
+        Operon::Span<Operon::Vector<Operon::Hash> const> hashes{hashesStrict};
+        std::vector<double> matrix(totalOps);
+
+        b.batch(s).run("jaccard pairs", [&]() {
+            for (size_t i = 0; i < hashes.size() - 1; ++i) {
+                for (size_t j = i + 1; j < hashes.size(); ++j) {
+                    matrix[Operon::Distance::PairIndex(i, j, hashes.size())] = Operon::Distance::Jaccard(hashes[i], hashes[j]);
+                }
+            }
+        });
+
+        b.batch(s).run("jaccard one to many", [&]() {
+            for (size_t i = 0; i < hashes.size() - 1; ++i) {
+                auto const offset = Operon::Distance::PairIndex(i, i + 1, hashes.size());
+                Operon::Distance::Jaccard(hashes[i], hashes.subspan(i + 1), Operon::Span<double>{matrix}.subspan(offset, hashes.size() - i - 1));
+            }
+        });
+
+        for (auto threads : { 1UL, 4UL, 16UL }) {
+            tf::Executor executor(threads);
+            b.batch(s).run(fmt::format("jaccard many to many {} threads", threads), [&]() {
+                Operon::Distance::Jaccard(hashes, matrix, executor);
+            });
+        }
+
+        std::vector<Fingerprint> fingerprints;
+        fingerprints.reserve(trees.size());
+        for (auto& tree : trees) { fingerprints.emplace_back(tree.Hash(Operon::HashMode::Strict)); }
+        Operon::Span<Fingerprint const> prints{fingerprints};
+
+        b.batch(s).run("fingerprint one to many", [&]() {
+            for (size_t i = 0; i < prints.size() - 1; ++i) {
+                auto const offset = Operon::Distance::PairIndex(i, i + 1, prints.size());
+                Operon::Distance::Jaccard(prints[i], prints.subspan(i + 1), Operon::Span<double>{matrix}.subspan(offset, prints.size() - i - 1));
+            }
+        });
+    }
+
+    SUBCASE("Performance fingerprint") {
+        ankerl::nanobench::Bench b;
+        b.performanceCounters(true).relative(true);
+
+        std::vector<Fingerprint> fingerprints;
+        fingerprints.reserve(trees.size());
+        for (auto& tree : trees) { fingerprints.emplace_back(tree.Hash(Operon::HashMode::Strict)); }
+
+        double d = 0;
+        b.batch(static_cast<double>(totalOps)).run("fingerprint str[i]ct", [&](){
+            d = 0;
+            for (size_t i = 0; i < fingerprints.size() - 1; ++i) {
+                for (size_t j = i+1; j < fingerprints.size(); ++j) {
+                    d += Operon::Distance::Jaccard(fingerprints[i], fingerprints[j]);
+                }
+            }
+            d /= static_cast<double>(totalOps);
+        });
+        fmt::print("d = {}\n", d);
+    }
 }
 } // namespace Test
 } // namespace Operon
@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <doctest/doctest.h>
+#include <random>
+#include <vector>
+
+#include "../operon_test.hpp"
+#include "operon/error_metrics/error_metrics.hpp"
+#include "operon/error_metrics/vectorized.hpp"
+
+namespace Operon::Test {
+    namespace nb = ankerl::nanobench;
+
+    // compares the iterator-based error metrics (vstat) with the vectorized ones on a typical training range
+    TEST_CASE("error metrics performance" * doctest::test_suite("[performance]"))
+    {
+        auto const n{100'000UL};
+        std::vector<Operon::Scalar> x(n);
+        std::vector<Operon::Scalar> y(n);
+        std::vector<Operon::Scalar> w(n);
+
+        Operon::RandomGenerator rng{1234}; // NOLINT
+        std::uniform_real_distribution<Operon::Scalar> ureal(0, 1);
+        for (auto i = 0UL; i < n; ++i) {
+            x[i] = ureal(rng);
+            y[i] = x[i] + ureal(rng);
+            w[i] = ureal(rng);
+        }
+
+        using S = Operon::Span<Operon::Scalar const>;
+        S const sx{x};
+        S const sy{y};
+        S const sw{w};
+
+        nb::Bench b;
+        b.title("error metrics").relative(true).performanceCounters(true).minEpochIterations(100).batch(n); // NOLINT
+
+        double r{0};
+        b.run("mse (vstat)", [&]() { r += MeanSquaredError(sx, sy); });
+        b.run("mse (vectorized)", [&]() { r += Vectorized::MeanSquaredError(sx, sy); });
+        b.run("weighted mse (vstat)", [&]() { r += MeanSquaredError(sx, sy, sw); });
+        b.run("weighted mse (vectorized)", [&]() { r += Vectorized::MeanSquaredError(sx, sy, sw); });
+        b.run("r2 (vstat)", [&]() { r += R2Score(sx, sy); });
+        b.run("r2 (vectorized)", [&]() { r += Vectorized::R2Score(sx, sy); });
+        b.run("nmse (vstat)", [&]() { r += NormalizedMeanSquaredError(sx, sy); });
+        b.run("nmse (vectorized)", [&]() { r += Vectorized::NormalizedMeanSquaredError(sx, sy); });
+        b.run("correlation (vstat)", [&]() { r += CorrelationCoefficient(sx, sy); });
+        b.run("correlation (vectorized)", [&]() { r += Vectorized::CorrelationCoefficient(sx, sy); });
+        nb::doNotOptimizeAway(r);
+    }
+} // namespace Operon::Test
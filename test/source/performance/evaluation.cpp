@@ -27,6 +27,7 @@
 #include "operon/operators/non_dominated_sorter.hpp"
 #include "operon/operators/reinserter.hpp"
 #include "operon/operators/selector.hpp"
+#include "operon/interpreter/hardware_counters.hpp"
 #include "operon/interpreter/interpreter.hpp"
 
 namespace Operon::Test {
@@ -288,6 +289,59 @@ namespace Operon::Test {
        }
     }
 
+#if defined(HAVE_HARDWARE_COUNTERS)
+    // hardware counters per evaluated row for each primitive (built with USE_HARDWARE_COUNTERS)
+    TEST_CASE("Kernel hardware counters")
+    {
+        if (!KernelSampler::Supported()) {
+            MESSAGE("the hardware counters cannot be opened (see /proc/sys/kernel/perf_event_paranoid)");
+            return;
+        }
+        constexpr size_t n = 1000;
+        constexpr size_t maxLength = 100;
+        constexpr size_t maxDepth = 1000;
+        constexpr size_t nrow = 10000;
+        constexpr size_t ncol = 10;
+
+        Operon::RandomGenerator rd(1234);
+        auto ds = Util::RandomDataset(rd, nrow, ncol);
+        auto inputs = ds.VariableHashes();
+        std::erase(inputs, ds.GetVariable("Y")->Hash);
+        Range range = { 0, nrow };
+
+        PrimitiveSet pset(PrimitiveSet::Arithmetic | NodeType::Exp | NodeType::Log | NodeType::Sin | NodeType::Sqrt | NodeType::Tanh);
+        auto creator = BalancedTreeCreator { pset, inputs };
+        std::uniform_int_distribution<size_t> sizeDistribution(1, maxLength);
+        std::vector<Tree> trees(n);
+        std::generate(trees.begin(), trees.end(), [&]() { return creator(rd, sizeDistribution(rd), 0, maxDepth); });
+
+        DefaultDispatch dtable;
+        std::vector<Operon::Scalar> result(range.Size());
+        Eigen::Array<Operon::Scalar, -1, -1> jacobian;
+
+        KernelSampler::Reset();
+        KernelSampler::Enable();
+        for (auto const& tree : trees) {
+            auto coeff = tree.GetCoefficients();
+            Operon::Interpreter<Operon::Scalar, DefaultDispatch> interpreter{dtable, ds, tree};
+            interpreter.Evaluate(coeff, range, result);
+            jacobian = interpreter.JacRev(coeff, range);
+        }
+        KernelSampler::Disable();
+
+        auto const profile = KernelSampler::Collect();
+        fmt::print("{:>12} {:>10} {:>12} {:>10} {:>12} {:>14} {:>14}\n", "kernel", "calls", "rows", "ipc", "cycles/row", "cache miss/row", "branch miss/row");
+        for (auto k = 0UL; k < KernelProfile::Size; ++k) {
+            auto const& c = profile.Kernels[k];
+            if (c.Calls == 0) { continue; }
+            fmt::print("{:>12} {:>10} {:>12} {:>10.2f} {:>12.2f} {:>14.4f} {:>14.4f}\n", KernelProfile::Name(k), c.Calls, c.Rows, c.Ipc(),
+                c.PerRow(HardwareEvent::Cycles), c.PerRow(HardwareEvent::CacheMisses), c.PerRow(HardwareEvent::BranchMisses));
+        }
+        CHECK(profile.Kernels[NodeTypes::GetIndex(NodeType::Add)].Calls > 0);
+        CHECK(profile.Kernels[KernelProfile::Jacobian].Rows > 0);
+    }
+#endif
+
     TEST_CASE("NSGA2")
     {
         auto ds = Dataset("./data/Friedman-I.csv", /*hasHeader=*/true);
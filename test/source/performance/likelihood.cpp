@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <cmath>
+#include <doctest/doctest.h>
+#include <random>
+#include <vector>
+
+#include "../operon_test.hpp"
+#include "operon/optimizer/likelihood/gaussian_likelihood.hpp"
+#include "operon/optimizer/likelihood/poisson_likelihood.hpp"
+
+namespace Operon::Test {
+    namespace nb = ankerl::nanobench;
+
+    // compares the scalar likelihood loops with the batch kernels of the math backend on a typical training range
+    TEST_CASE("likelihood performance" * doctest::test_suite("[performance]"))
+    {
+        auto const n{100'000UL};
+        std::vector<Operon::Scalar> x(n);
+        std::vector<Operon::Scalar> y(n);
+        std::vector<Operon::Scalar> s(n);
+
+        Operon::RandomGenerator rng{1234}; // NOLINT
+        std::uniform_real_distribution<Operon::Scalar> ureal(0.5, 2); // NOLINT
+        std::poisson_distribution<int> poisson(2); // NOLINT
+        for (auto i = 0UL; i < n; ++i) {
+            x[i] = ureal(rng);
+            y[i] = static_cast<Operon::Scalar>(poisson(rng));
+            s[i] = ureal(rng);
+        }
+
+        using S = Operon::Span<Operon::Scalar const>;
+        S const sx{x};
+        S const sy{y};
+        S const ss{s};
+
+        auto scalarGaussian = [&]() {
+            auto const t = std::sqrt(Operon::Math::Tau);
+            auto sum{0.0};
+            for (auto i = 0UL; i < n; ++i) {
+                auto const p = (x[i] - y[i]) / s[i];
+                sum += std::log(s[i] * t) + 0.5 * p * p; // NOLINT
+            }
+            return sum;
+        };
+
+        auto scalarPoisson = [&]<typename F>(F&& f) {
+            auto sum{0.0};
+            for (auto i = 0UL; i < n; ++i) { sum += f(x[i], y[i]); }
+            return sum;
+        };
+
+        nb::Bench b;
+        b.title("likelihood").relative(true).performanceCounters(true).minEpochIterations(100).batch(n); // NOLINT
+
+        double r{0};
+        b.run("gaussian per-row sigma (scalar)", [&]() { r += scalarGaussian(); });
+        b.run("gaussian per-row sigma (backend)", [&]() { r += GaussianLikelihood<Operon::Scalar>::ComputeLikelihood(sx, sy, ss); });
+        b.run("poisson log input (scalar)", [&]() { r += scalarPoisson(detail::PoissonLog{}); });
+        b.run("poisson log input (backend)", [&]() { r += PoissonLikelihood<Operon::Scalar, true>::ComputeLikelihood(sx, sy, {}); });
+        b.run("poisson (scalar)", [&]() { r += scalarPoisson(detail::Poisson{}); });
+        b.run("poisson (backend)", [&]() { r += PoissonLikelihood<Operon::Scalar, false>::ComputeLikelihood(sx, sy, {}); });
+        nb::doNotOptimizeAway(r);
+    }
+} // namespace Operon::Test
@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <doctest/doctest.h>
+#include <initializer_list>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "../operon_test.hpp"
+
+#include "operon/core/pset.hpp"
+#include "operon/core/tree.hpp"
+#include "operon/operators/creator.hpp"
+#include "operon/operators/initializer.hpp"
+#include "operon/operators/mutation.hpp"
+
+namespace dt = doctest;
+namespace nb = ankerl::nanobench;
+
+namespace Operon::Test {
+    TEST_CASE("Subtree mutations" * dt::test_suite("[performance]")) {
+        constexpr auto nrow { 10 };
+        constexpr auto ncol { 10 };
+        constexpr auto maxd { 1000 };
+        constexpr auto n { 100 };
+
+        Operon::PrimitiveSet pset{ Operon::PrimitiveSet::Arithmetic };
+
+        Operon::RandomGenerator rd(1234UL);
+        auto ds = Util::RandomDataset(rd, nrow, ncol);
+        BalancedTreeCreator creator{ pset, ds.VariableHashes() };
+        UniformCoefficientInitializer cfi;
+
+        nb::Bench bench;
+        bench.relative(true);
+        // the parents are shared with the population, so they are copied once (the previous behaviour of all the
+        // mutations), the children are mutated again in place
+        for (auto length : { 50UL, 200UL, 1000UL }) {
+            std::vector<Tree> trees;
+            for (auto i = 0; i < n; ++i) {
+                trees.push_back(creator(rd, length, 0, maxd));
+            }
+            std::uniform_int_distribution<size_t> dist(0, n - 1);
+
+            InsertSubtreeMutation insert{ creator, cfi, maxd, 2 * length };
+            ReplaceSubtreeMutation replace{ creator, cfi, maxd, length };
+            RemoveSubtreeMutation remove{ pset };
+
+            using Named = std::pair<char const*, MutatorBase const*>;
+            for (auto [name, mut] : std::initializer_list<Named>{ { "insert", &insert }, { "replace", &replace }, { "remove", &remove } }) {
+                bench.run(fmt::format("{};copy;{}", name, length), [&]() {
+                    return (*mut)(rd, trees[dist(rd)]).Length();
+                });
+                bench.run(fmt::format("{};in place;{}", name, length), [&]() {
+                    auto& tree = trees[dist(rd)];
+                    tree = (*mut)(rd, std::move(tree));
+                    return tree.Length();
+                });
+            }
+        }
+    }
+} // namespace Operon::Test
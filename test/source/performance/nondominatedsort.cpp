@@ -1,10 +1,15 @@
 // SPDX-License-Identifier: MIT
 // SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <doctest/doctest.h>
 #include <fstream>
+#include <functional>
 #include <random>
+#include <string>
+#include <utility>
 
 #include "nanobench.h"
 #include "operon/core/dataset.hpp"
@@ -508,6 +513,71 @@ TEST_CASE("non-dominated sort complexity")
     }
 }
 
+// fitness values distributed like the objectives of a GP run: the error decreases with the length (a discrete
+// objective, see LengthEvaluator) and has few significant digits, the other objectives take a few integer values
+// (eg. ShapeEvaluator), the population is sorted and without duplicates like in NSGA2
+auto InitializeGpPop(Operon::RandomGenerator& random, size_t n, size_t m, Operon::Scalar precision) -> std::vector<Individual>
+{
+    constexpr auto maxLength{50};
+    constexpr auto scale{15.0};
+    constexpr auto shapes{10};
+    std::geometric_distribution<int> length(0.08); // NOLINT
+    std::lognormal_distribution<double> noise(0, 0.5); // NOLINT
+    std::uniform_int_distribution<int> shape(0, shapes);
+
+    std::vector<Individual> individuals(n);
+    for (auto& ind : individuals) {
+        ind.Fitness.resize(m);
+        auto const len = 1 + std::min(maxLength - 1, length(random));
+        auto const err = static_cast<Operon::Scalar>(std::exp(-len / scale) * noise(random));
+        ind[0] = std::round(err / precision) * precision;
+        ind[1] = static_cast<Operon::Scalar>(len);
+        for (auto j = 2UL; j < m; ++j) { ind[j] = static_cast<Operon::Scalar>(shape(random)); }
+    }
+    std::ranges::stable_sort(individuals, [](auto const& a, auto const& b) { return std::ranges::lexicographical_compare(a.Fitness, b.Fitness); });
+    auto [first, last] = std::ranges::unique(individuals, [](auto const& a, auto const& b) { return a.Fitness == b.Fitness; });
+    individuals.erase(first, last);
+    return individuals;
+}
+
+TEST_CASE("non-dominated sort gp fitness")
+{
+    Operon::RandomGenerator rd{0};
+    nb::Bench bench;
+
+    Operon::RankIntersectSorter rs;
+    Operon::RankOrdinalSorter ro;
+    Operon::MergeSorter mnds;
+    Operon::BestOrderSorter bos;
+    Operon::EfficientBinarySorter ebs;
+    Operon::EfficientSequentialSorter ess;
+    Operon::AdaptiveSorter as;
+    Operon::BiObjectiveSorter bi;
+    Operon::TriObjectiveSorter tri;
+    std::vector<std::pair<std::string, std::reference_wrapper<NondominatedSorterBase const>>> sorters{
+        {"RS", rs}, {"RO", ro}, {"MNDS", mnds}, {"BOS", bos}, {"ENS-BS", ebs}, {"ENS-SS", ess}, {"AUTO", as}
+    };
+
+    for (auto precision : { 1e-2F, 1e-4F }) {
+        for (auto m : { 2UL, 3UL, 4UL }) {
+            for (auto n : { 1000UL, 5000UL, 10000UL, 20000UL }) {
+                auto pop = InitializeGpPop(rd, n, m, precision);
+                auto const ties = Operon::AdaptiveSorter::TieRatio(pop);
+                auto run = [&](auto const& name, NondominatedSorterBase const& sorter) {
+                    bench.run(fmt::format("{};{};{};{:.2f}", name, pop.size(), m, ties), [&]() {
+                        return sorter(pop).size();
+                    });
+                };
+                for (auto const& [name, sorter] : sorters) { run(name, sorter); }
+                if (m == 2) { run("SWEEP", bi); }
+                if (m == 3) { run("SWEEP", tri); }
+            }
+        }
+    }
+    std::ofstream out("./gp-fitness-benchmark.csv");
+    bench.render(nb::templates::csv(), out);
+}
+
 TEST_CASE("dtlz2")
 {
     std::string path = "./csv";
@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
+
+#include <doctest/doctest.h>
+
+#include <fmt/core.h>
+#include <taskflow/taskflow.hpp>
+#include <taskflow/algorithm/for_each.hpp>
+
+#include "operon/core/dataset.hpp"
+#include "operon/core/pset.hpp"
+#include "operon/formatter/formatter.hpp"
+#include "operon/operators/creator.hpp"
+#include "operon/parser/infix.hpp"
+
+#include "nanobench.h"
+
+namespace Operon::Test {
+
+TEST_CASE("Infix parser performance")
+{
+    constexpr int nTrees = 20'000;
+    constexpr int nNodes = 50;
+
+    Operon::Dataset ds("./data/Poly-10.csv", /*hasHeader=*/true);
+    Operon::PrimitiveSet pset;
+    pset.SetConfig(PrimitiveSet::Arithmetic | NodeType::Exp | NodeType::Log | NodeType::Sin | NodeType::Cos | NodeType::Tan);
+    Operon::RandomGenerator rng(1234);
+    Operon::BalancedTreeCreator btc(pset, ds.VariableHashes());
+
+    Operon::Vector<std::string> expressions;
+    expressions.reserve(nTrees);
+    for (int i = 0; i < nTrees; ++i) {
+        expressions.push_back(InfixFormatter::Format(btc(rng, nNodes, 1, 10), ds, 30)); // NOLINT
+    }
+
+    Operon::Map<std::string, Operon::Hash> vars;
+    for (auto const& v : ds.GetVariables()) {
+        vars.insert({ v.Name, v.Hash });
+    }
+
+    ankerl::nanobench::Bench b;
+    b.title("infix parser").relative(true).performanceCounters(true).minEpochIterations(1).batch(nTrees);
+
+    b.run("static", [&]() {
+        for (auto const& s : expressions) { ankerl::nanobench::doNotOptimizeAway(InfixParser::Parse(s, vars)); }
+    });
+
+    InfixParser const parser{vars};
+    b.run("reused", [&]() {
+        for (auto const& s : expressions) { ankerl::nanobench::doNotOptimizeAway(parser(s)); }
+    });
+
+    tf::Executor executor;
+    std::vector<Operon::Tree> trees(expressions.size());
+    b.run(fmt::format("reused, {} threads", executor.num_workers()), [&]() {
+        tf::Taskflow taskflow;
+        taskflow.for_each_index(std::size_t{0}, expressions.size(), std::size_t{1}, [&](auto i) { trees[i] = parser(expressions[i]); });
+        executor.run(taskflow).wait();
+    });
+}
+
+} // namespace Operon::Test